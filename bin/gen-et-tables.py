@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Generate the FAO-56 lookup tables used by src/modules/weather/EvapotranspirationTables.h
+
+Usage: python3 bin/gen-et-tables.py > src/modules/weather/EvapotranspirationTables.h
+"""
+
+import math
+
+SVP_MIN_C = -10
+SVP_MAX_C = 50
+RA_LAT_MIN = -60
+RA_LAT_MAX = 60
+RA_LAT_STEP = 5
+RA_DOY_COLUMNS = 52  # one column per week
+GSC = 0.0820  # solar constant, MJ m-2 min-1
+
+
+def svp(t):
+    """FAO-56 Eq. 11, kPa"""
+    return 0.6108 * math.exp(17.27 * t / (t + 237.3))
+
+
+def ra(lat, doy):
+    """FAO-56 Eq. 21-25, MJ m-2 day-1"""
+    phi = math.radians(lat)
+    dr = 1 + 0.033 * math.cos(2 * math.pi * doy / 365)
+    decl = 0.409 * math.sin(2 * math.pi * doy / 365 - 1.39)
+    ws = math.acos(max(-1.0, min(1.0, -math.tan(phi) * math.tan(decl))))
+    return (
+        24 * 60 / math.pi * GSC * dr
+        * (ws * math.sin(phi) * math.sin(decl) + math.cos(phi) * math.cos(decl) * math.sin(ws))
+    )
+
+
+def main():
+    print("#pragma once")
+    print("// Generated by bin/gen-et-tables.py - do not edit by hand")
+    print("#include <cstdint>")
+    print("")
+    print("namespace ET {")
+    print("")
+    print("static constexpr int SVP_TABLE_MIN_C = %d;" % SVP_MIN_C)
+    print("static constexpr int SVP_TABLE_MAX_C = %d;" % SVP_MAX_C)
+    print("// Saturation vapour pressure e°(T) in kPa at 1 °C steps (FAO-56 Eq. 11)")
+    print("static constexpr float SVP_TABLE[] = {")
+    vals = ["%.5ff" % svp(t) for t in range(SVP_MIN_C, SVP_MAX_C + 1)]
+    for i in range(0, len(vals), 8):
+        print("    " + ", ".join(vals[i:i + 8]) + ",")
+    print("};")
+    print("")
+    lats = list(range(RA_LAT_MIN, RA_LAT_MAX + 1, RA_LAT_STEP))
+    print("static constexpr int RA_TABLE_LAT_MIN = %d;" % RA_LAT_MIN)
+    print("static constexpr int RA_TABLE_LAT_STEP = %d;" % RA_LAT_STEP)
+    print("static constexpr int RA_TABLE_ROWS = %d;" % len(lats))
+    print("static constexpr int RA_TABLE_COLUMNS = %d;" % RA_DOY_COLUMNS)
+    print("// Extraterrestrial radiation Ra in 0.01 MJ m-2 day-1 (FAO-56 Eq. 21), one row per latitude,")
+    print("// one column per week starting at day 1")
+    print("static constexpr uint16_t RA_TABLE[RA_TABLE_ROWS][RA_TABLE_COLUMNS] = {")
+    for lat in lats:
+        row = [
+            "%d" % round(ra(lat, 1 + c * 365.0 / RA_DOY_COLUMNS) * 100)
+            for c in range(RA_DOY_COLUMNS)
+        ]
+        print("    {" + ", ".join(row) + "}, // %d" % lat)
+    print("};")
+    print("")
+    print("} // namespace ET")
+
+
+if __name__ == "__main__":
+    main()
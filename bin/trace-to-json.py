@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Turn a binary packet trace (Logging: TraceFile in config.yaml) into JSON lines
+
+Usage: python3 bin/trace-to-json.py meshtasticd.trace > trace.jsonl
+
+The format is written by src/mesh/PacketTrace.cpp. Received records carry the encrypted bytes as they came off the
+radio, decoded records carry the encoded Data message. When the meshtastic python package is installed decoded
+payloads are expanded, otherwise they are printed as hex.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x3154504D  # "MPT1"
+FILE_HEADER = struct.Struct("<IHH")
+RECORD_HEADER = struct.Struct("<HBBIIIIIBBBBhhBBBBHH")
+RECORD_RECEIVED = 1
+RECORD_DECODED = 2
+FLAG_WANT_ACK = 1
+FLAG_VIA_MQTT = 2
+FLAG_PKI = 4
+
+try:
+    from google.protobuf.json_format import MessageToDict
+    from meshtastic.protobuf import mesh_pb2, portnums_pb2
+except ImportError:
+    mesh_pb2 = None
+
+
+def decode_data(payload):
+    """Expand an encoded Data message, or fall back to hex"""
+    if mesh_pb2 is None:
+        return {"payload_hex": payload.hex()}
+    data = mesh_pb2.Data()
+    data.ParseFromString(payload)
+    out = MessageToDict(data, preserving_proto_field_name=True)
+    out["type"] = portnums_pb2.PortNum.Name(data.portnum) if data.portnum in portnums_pb2.PortNum.values() else data.portnum
+    if data.portnum == portnums_pb2.TEXT_MESSAGE_APP:
+        out["text"] = data.payload.decode("utf-8", errors="replace")
+    return out
+
+
+def records(f):
+    header = f.read(FILE_HEADER.size)
+    # A trace file is appended to across restarts, so file headers can also appear between records
+    while len(header) == FILE_HEADER.size:
+        magic, record_header_size, _ = FILE_HEADER.unpack(header)
+        if magic != MAGIC or record_header_size != RECORD_HEADER.size:
+            raise ValueError("not a packet trace, or an unsupported version")
+        while True:
+            raw = f.read(RECORD_HEADER.size)
+            if len(raw) < RECORD_HEADER.size:
+                return
+            if struct.unpack_from("<I", raw)[0] == MAGIC:
+                header = raw[: FILE_HEADER.size]
+                f.seek(FILE_HEADER.size - RECORD_HEADER.size, 1)
+                break
+            fields = RECORD_HEADER.unpack(raw)
+            payload = f.read(fields[0] - RECORD_HEADER.size)
+            if len(payload) < fields[-1]:
+                return  # Torn last record
+            yield fields, payload
+
+
+def to_json(fields, payload):
+    (_, kind, flags, time_ms, rx_time, sender, dest, packet_id, channel, hop_limit, hop_start, transport, rssi,
+     snr_quarters, next_hop, relay_node, priority, _, portnum, size) = fields
+    out = {
+        "id": packet_id,
+        "time_ms": time_ms,
+        "timestamp": rx_time,
+        "to": dest,
+        "from": sender,
+        "channel": channel,
+        "want_ack": bool(flags & FLAG_WANT_ACK),
+    }
+    if rssi:
+        out["rssi"] = rssi
+    if snr_quarters:
+        out["snr"] = snr_quarters / 4
+    if hop_start and hop_limit <= hop_start:
+        out["hops_away"] = hop_start - hop_limit
+        out["hop_start"] = hop_start
+    if flags & FLAG_VIA_MQTT:
+        out["via_mqtt"] = True
+    if flags & FLAG_PKI:
+        out["pki_encrypted"] = True
+    for key, value in (("transport", transport), ("next_hop", next_hop), ("relay_node", relay_node), ("priority", priority)):
+        if value:
+            out[key] = value
+    if kind == RECORD_RECEIVED:
+        out["size"] = size
+        out["bytes"] = payload.hex()
+    elif kind == RECORD_DECODED:
+        out["portnum"] = portnum
+        out["decoded"] = decode_data(payload)
+    else:
+        out["record_type"] = kind
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="binary trace file")
+    parser.add_argument("--decoded-only", action="store_true", help="skip records of packets as received")
+    args = parser.parse_args()
+    with open(args.trace, "rb") as f:
+        for fields, payload in records(f):
+            if args.decoded_only and fields[1] != RECORD_DECODED:
+                continue
+            sys.stdout.write(json.dumps(to_json(fields, payload)) + "\n")
+
+
+if __name__ == "__main__":
+    main()
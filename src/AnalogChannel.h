@@ -0,0 +1,109 @@
+#pragma once
+
+#include "modules/sensors/SensorPipeline.h"
+#include <stdint.h>
+
+/**
+ * One analog input sampled on a schedule by AnalogSampler.
+ *
+ * Each sample is a burst of `oversample` conversions averaged together, with the optional power hook wrapped around it
+ * (voltage divider enables and the like). Burst averages go into a short history, then a median over the newest
+ * `medianWindow` of them knocks out spikes (a solenoid switching, a LoRa TX) and an EMA smooths what is left. Callers only
+ * ever see the result of the last sample, so reading a channel never touches the ADC.
+ *
+ * Kept free of Arduino calls so it can be tested on the host.
+ */
+class AnalogChannel
+{
+  public:
+    static const uint8_t HISTORY = 8; // Largest useful medianWindow
+
+    struct Config {
+        const char *name;
+        uint32_t intervalMs;
+        uint8_t oversample;                 // Conversions averaged per sample
+        uint8_t medianWindow;               // Samples in the spike filter, 1 for none
+        float emaAlpha;                     // Weight of the newest median, 1 for no smoothing
+        int32_t (*read)(void *ctx);         // One conversion in ADC counts, negative if it failed
+        void (*power)(void *ctx, bool on);  // Optional, called before and after each burst
+        void *ctx;
+    };
+
+    AnalogChannel() {}
+    explicit AnalogChannel(const Config &_config) : config(_config) {}
+
+    bool due(uint32_t now) const { return !sampled || now - lastSampleMs >= config.intervalMs; }
+
+    uint32_t msUntilDue(uint32_t now) const { return due(now) ? 0 : config.intervalMs - (now - lastSampleMs); }
+
+    /**
+     * Run one burst and fold it into the filter.
+     *
+     * @return false if no conversion in the burst succeeded, the filtered value is then left alone
+     */
+    bool sample(uint32_t now)
+    {
+        sampled = true;
+        lastSampleMs = now;
+        if (!config.read)
+            return false;
+
+        if (config.power)
+            config.power(config.ctx, true);
+        int64_t sum = 0;
+        uint8_t good = 0;
+        uint8_t conversions = config.oversample ? config.oversample : 1;
+        for (uint8_t i = 0; i < conversions; i++) {
+            int32_t raw = config.read(config.ctx);
+            if (raw >= 0) {
+                sum += raw;
+                good++;
+            }
+        }
+        if (config.power)
+            config.power(config.ctx, false);
+        if (!good)
+            return false;
+
+        last = (float)sum / good;
+        history.push(last, now);
+        float median = history.median(config.medianWindow ? config.medianWindow : 1);
+        if (!valid) {
+            value = median;
+            valid = true;
+        } else {
+            value += (median - value) * config.emaAlpha;
+        }
+        samples++;
+        return true;
+    }
+
+    /// True once a sample succeeded
+    bool hasValue() const { return valid; }
+
+    /// Filtered value in ADC counts, 0 until hasValue()
+    float filtered() const { return value; }
+
+    /// Newest burst average, before the median and EMA
+    float latest() const { return last; }
+
+    /// Number of successful samples, for callers that want to notice new data
+    uint32_t getSamples() const { return samples; }
+
+    /// False until the first sample() call, successful or not
+    bool wasSampled() const { return sampled; }
+
+    void setInterval(uint32_t ms) { config.intervalMs = ms; }
+
+    const Config &getConfig() const { return config; }
+
+  private:
+    Config config = {};
+    SensorPipeline::SampleRing<float, HISTORY> history;
+    float value = 0;
+    float last = 0;
+    bool valid = false;
+    bool sampled = false;
+    uint32_t lastSampleMs = 0;
+    uint32_t samples = 0;
+};
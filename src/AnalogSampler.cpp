@@ -0,0 +1,53 @@
+#include "AnalogSampler.h"
+#include "configuration.h"
+
+AnalogSampler *analogSampler;
+
+AnalogSampler::AnalogSampler() : OSThread("AnalogSampler") {}
+
+int8_t AnalogSampler::addChannel(const AnalogChannel::Config &config)
+{
+    if (numChannels >= MAX_CHANNELS) {
+        LOG_ERROR("No analog channel left for %s", config.name);
+        return -1;
+    }
+    channels[numChannels] = AnalogChannel(config);
+    LOG_DEBUG("Analog channel %u: %s every %ums", numChannels, config.name, config.intervalMs);
+    setIntervalFromNow(0);
+    return numChannels++;
+}
+
+float AnalogSampler::read(int8_t id)
+{
+    if (!valid(id))
+        return 0;
+    AnalogChannel &channel = channels[id];
+    if (!channel.wasSampled())
+        channel.sample(millis());
+    return channel.filtered();
+}
+
+void AnalogSampler::setInterval(int8_t id, uint32_t ms)
+{
+    if (valid(id)) {
+        channels[id].setInterval(ms);
+        setIntervalFromNow(0);
+    }
+}
+
+int32_t AnalogSampler::runOnce()
+{
+    uint32_t wait = INT32_MAX; // Idle until addChannel() wakes us
+    for (uint8_t i = 0; i < numChannels; i++) {
+        AnalogChannel &channel = channels[i];
+        uint32_t now = millis();
+        if (channel.due(now)) {
+            if (!channel.sample(now))
+                LOG_DEBUG("Analog channel %s: no valid conversion", channel.getConfig().name);
+        }
+        uint32_t untilDue = channel.msUntilDue(millis());
+        if (untilDue < wait)
+            wait = untilDue;
+    }
+    return wait ? wait : 1;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "AnalogChannel.h"
+#include "concurrency/OSThread.h"
+
+/**
+ * Samples every registered analog input on its own schedule, so nobody reads the ADC in line any more.
+ *
+ * Battery sense used to run BATTERY_SENSE_SAMPLES conversions (plus the divider settle delay) inside whatever called
+ * getBattVoltage(), and every analog sensor added for irrigation would have done the same. Instead, owners register a
+ * channel once with addChannel() and read() hands back the latest filtered value without touching the hardware. Bursts
+ * run here, between other threads, each when its channel's interval is up.
+ *
+ * OSThreads are cooperative, so channels and their filters need no locking.
+ */
+class AnalogSampler : private concurrency::OSThread
+{
+  public:
+    static const uint8_t MAX_CHANNELS = 8;
+
+    AnalogSampler();
+
+    /// @return channel id, or -1 if all channels are taken
+    int8_t addChannel(const AnalogChannel::Config &config);
+
+    /**
+     * Latest filtered value of a channel in ADC counts.
+     *
+     * The very first read of a channel that has never produced a value samples it right away, so callers at boot get a real
+     * reading rather than 0. Every read after that is just a copy.
+     */
+    float read(int8_t id);
+
+    bool hasValue(int8_t id) const { return valid(id) && channels[id].hasValue(); }
+
+    /// Number of successful samples so far, changes whenever read() would return something new
+    uint32_t getSamples(int8_t id) const { return valid(id) ? channels[id].getSamples() : 0; }
+
+    void setInterval(int8_t id, uint32_t ms);
+
+  protected:
+    virtual int32_t runOnce() override;
+
+  private:
+    AnalogChannel channels[MAX_CHANNELS];
+    uint8_t numChannels = 0;
+
+    bool valid(int8_t id) const { return id >= 0 && id < numChannels; }
+};
+
+extern AnalogSampler *analogSampler;
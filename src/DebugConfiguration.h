@@ -31,6 +31,34 @@ extern MemGet memGet;
 #define MESHTASTIC_LOG_LEVEL_TRACE "TRACE"
 #define MESHTASTIC_LOG_LEVEL_HEAP "HEAP"
 
+// Compile time log thresholds. Calls more verbose than the threshold compile to nothing, their arguments are
+// never evaluated.
+#define MESHTASTIC_LOG_THRESHOLD_NONE 0
+#define MESHTASTIC_LOG_THRESHOLD_ERROR 1 // ERROR and CRIT
+#define MESHTASTIC_LOG_THRESHOLD_WARN 2
+#define MESHTASTIC_LOG_THRESHOLD_INFO 3
+#define MESHTASTIC_LOG_THRESHOLD_DEBUG 4
+#define MESHTASTIC_LOG_THRESHOLD_TRACE 5
+
+// Whole firmware, e.g. -DMESHTASTIC_LOG_MAX_LEVEL=MESHTASTIC_LOG_THRESHOLD_INFO in build_flags
+#ifndef MESHTASTIC_LOG_MAX_LEVEL
+#define MESHTASTIC_LOG_MAX_LEVEL MESHTASTIC_LOG_THRESHOLD_TRACE
+#endif
+
+// Router and radio hot path in src/mesh, those files use it as their LOG_MODULE_LEVEL
+#ifndef MESHTASTIC_LOG_MESH_LEVEL
+#define MESHTASTIC_LOG_MESH_LEVEL MESHTASTIC_LOG_MAX_LEVEL
+#endif
+
+// A source file can #define LOG_MODULE_LEVEL before its first #include to get its own threshold
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL MESHTASTIC_LOG_MAX_LEVEL
+#endif
+
+#define LOG_THRESHOLD_ENABLED(threshold) ((threshold) <= LOG_MODULE_LEVEL && (threshold) <= MESHTASTIC_LOG_MAX_LEVEL)
+// e.g. if (LOG_LEVEL_ENABLED(DEBUG)) to skip building a message nobody will see
+#define LOG_LEVEL_ENABLED(level) LOG_THRESHOLD_ENABLED(MESHTASTIC_LOG_THRESHOLD_##level)
+
 #include "SerialConsole.h"
 
 // If defined we will include support for ARM ICE "semihosting" for a virtual
@@ -53,12 +81,17 @@ extern MemGet memGet;
 #define LOG_TRACE(...) SEGGER_RTT_printf(0, __VA_ARGS__)
 #else
 #if defined(DEBUG_PORT) && !defined(DEBUG_MUTE)
-#define LOG_DEBUG(...) DEBUG_PORT.log(MESHTASTIC_LOG_LEVEL_DEBUG, __VA_ARGS__)
-#define LOG_INFO(...) DEBUG_PORT.log(MESHTASTIC_LOG_LEVEL_INFO, __VA_ARGS__)
-#define LOG_WARN(...) DEBUG_PORT.log(MESHTASTIC_LOG_LEVEL_WARN, __VA_ARGS__)
-#define LOG_ERROR(...) DEBUG_PORT.log(MESHTASTIC_LOG_LEVEL_ERROR, __VA_ARGS__)
-#define LOG_CRIT(...) DEBUG_PORT.log(MESHTASTIC_LOG_LEVEL_CRIT, __VA_ARGS__)
-#define LOG_TRACE(...) DEBUG_PORT.log(MESHTASTIC_LOG_LEVEL_TRACE, __VA_ARGS__)
+#define LOG_AT(threshold, level, ...)                                                                                            \
+    do {                                                                                                                         \
+        if (LOG_THRESHOLD_ENABLED(threshold))                                                                                    \
+            DEBUG_PORT.log(level, __VA_ARGS__);                                                                                  \
+    } while (0)
+#define LOG_DEBUG(...) LOG_AT(MESHTASTIC_LOG_THRESHOLD_DEBUG, MESHTASTIC_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(MESHTASTIC_LOG_THRESHOLD_INFO, MESHTASTIC_LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(MESHTASTIC_LOG_THRESHOLD_WARN, MESHTASTIC_LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(MESHTASTIC_LOG_THRESHOLD_ERROR, MESHTASTIC_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_CRIT(...) LOG_AT(MESHTASTIC_LOG_THRESHOLD_ERROR, MESHTASTIC_LOG_LEVEL_CRIT, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_AT(MESHTASTIC_LOG_THRESHOLD_TRACE, MESHTASTIC_LOG_LEVEL_TRACE, __VA_ARGS__)
 #else
 #define LOG_DEBUG(...)
 #define LOG_INFO(...)
@@ -48,6 +48,13 @@ using namespace STM32_LittleFS_Namespace;
 using namespace Adafruit_LittleFS_Namespace;
 #endif
 
+#if defined(ARCH_NRF52) || defined(ARCH_STM32WL)
+// Adafruit style LittleFS already positions FILE_O_WRITE at the end of an existing file
+#define FILE_O_APPEND FILE_O_WRITE
+#elif defined(FSCom)
+#define FILE_O_APPEND "a"
+#endif
+
 void fsInit();
 void fsListFiles();
 bool copyFile(const char *from, const char *to);
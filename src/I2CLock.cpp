@@ -0,0 +1,21 @@
+#include "I2CLock.h"
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_I2C
+#include <Wire.h>
+#endif
+
+static concurrency::Lock *i2cLocks[2];
+
+concurrency::Lock *i2cLock(TwoWire *bus)
+{
+    uint8_t port = 0;
+#if !MESHTASTIC_EXCLUDE_I2C && WIRE_INTERFACES_COUNT == 2
+    if (bus == &Wire1)
+        port = 1;
+#endif
+    // First used from setup() by the bus scan, before any other thread can race us here
+    if (!i2cLocks[port])
+        i2cLocks[port] = new concurrency::Lock();
+    return i2cLocks[port];
+}
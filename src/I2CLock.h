@@ -0,0 +1,19 @@
+#pragma once
+
+#include "concurrency/LockGuard.h"
+#include "configuration.h"
+
+#if !ARCH_PORTDUINO
+class TwoWire;
+#else
+#include <Wire.h>
+#endif
+
+/**
+ * Used to provide mutual exclusion for access to an I2C bus, one lock per port. Usage:
+ * concurrency::LockGuard g(i2cLock(bus));
+ *
+ * Hold it for a whole transaction (write the register address, then read), not for conversion waits, so other devices on
+ * the bus can be serviced in between. A null bus means the default Wire port.
+ */
+concurrency::Lock *i2cLock(TwoWire *bus);
@@ -0,0 +1,409 @@
+#pragma once
+
+#include <atomic>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Bounded multi-producer, single-consumer queue of not yet formatted log messages.
+ *
+ * Logging from the router hot path used to vsnprintf and write to serial/syslog/BLE on the caller's thread. Instead a
+ * producer only copies the format text and the raw argument bytes (strings too, they may live on the stack) into a fixed
+ * slot, and a low priority consumer formats and writes them later.
+ *
+ * Slots are claimed with a compare-and-swap on the enqueue position and published through a per-slot sequence number,
+ * so producers on either core or in different tasks never block each other or the consumer. When the queue is full the
+ * message is dropped and counted.
+ *
+ * The format is copied like the arguments, as callers pass buffers they free or reuse straight after. Conversions the
+ * capture does not understand (%n, long double), or a format and arguments that don't fit in Bytes, make push() return
+ * false so the caller can log synchronously instead.
+ */
+template <size_t Slots, size_t Bytes> class LogQueue
+{
+    static_assert(Slots >= 2 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+  public:
+    struct Record {
+        const char *level;
+        char thread[16]; // ThreadName of the OSThread that logged, empty if none
+        uint32_t millis;
+        uint16_t formatLen; // Of the format at the start of data, NUL included, 0 for a slot the consumer skips
+        uint16_t dataLen;   // The format, then the captured arguments
+        uint8_t data[Bytes];
+
+        const char *formatText() const { return (const char *)data; }
+    };
+
+    LogQueue()
+    {
+        for (size_t i = 0; i < Slots; i++)
+            slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * Capture one message.
+     *
+     * @return false if the format could not be captured and the caller should log it synchronously. A full queue
+     * still returns true, the message is counted by takeDropped().
+     */
+    bool push(const char *level, const char *format, const char *thread, uint32_t millis, va_list arg)
+    {
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[pos & (Slots - 1)];
+            int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                drops.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        Record &r = slot->record;
+        r.level = level;
+        if (thread) {
+            strncpy(r.thread, thread, sizeof(r.thread) - 1);
+            r.thread[sizeof(r.thread) - 1] = '\0';
+        } else {
+            r.thread[0] = '\0';
+        }
+        r.millis = millis;
+        va_list copy;
+        va_copy(copy, arg);
+        size_t formatLen = strlen(format) + 1;
+        bool captured = formatLen <= Bytes;
+        if (captured) {
+            memcpy(r.data, format, formatLen);
+            r.formatLen = r.dataLen = formatLen;
+            captured = capture(r, format, copy);
+        }
+        va_end(copy);
+        if (!captured)
+            r.formatLen = 0; // Claimed slot must still be published, the consumer skips it
+
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return captured;
+    }
+
+    /// Take the oldest message, single consumer only
+    bool pop(Record &out)
+    {
+        while (true) {
+            Slot &slot = slots[dequeuePos & (Slots - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != dequeuePos + 1)
+                return false;
+            bool valid = slot.record.formatLen != 0;
+            if (valid)
+                memcpy(&out, &slot.record, offsetof(Record, data) + slot.record.dataLen);
+            slot.seq.store(dequeuePos + Slots, std::memory_order_release);
+            dequeuePos++;
+            if (valid)
+                return true;
+        }
+    }
+
+    bool empty() const
+    {
+        return slots[dequeuePos & (Slots - 1)].seq.load(std::memory_order_acquire) != dequeuePos + 1;
+    }
+
+    /// Messages lost to a full queue since the last call
+    uint32_t takeDropped() { return drops.exchange(0, std::memory_order_relaxed); }
+
+    /**
+     * Expand a record into text, like vsnprintf would have done at the time of the call.
+     *
+     * @return length of the text written to buf (always NUL terminated, truncated to size - 1)
+     */
+    static size_t format(const Record &r, char *buf, size_t size)
+    {
+        if (!size)
+            return 0;
+        size_t len = 0;
+        const uint8_t *a = r.data + r.formatLen;
+        for (const char *f = r.formatText(); *f && len < size - 1;) {
+            if (*f != '%') {
+                buf[len++] = *f++;
+                continue;
+            }
+            Spec s;
+            if (!parseSpec(f, s)) {
+                buf[len++] = *f++;
+                continue;
+            }
+            f = s.end;
+            if (s.conv == '%') {
+                buf[len++] = '%';
+                continue;
+            }
+            // Rebuild the conversion with * widths replaced by their captured values
+            char spec[24];
+            size_t n = 0;
+            spec[n++] = '%';
+            for (const char *p = s.start + 1; p < s.end && n < sizeof(spec) - 12; p++) {
+                if (*p == '*') {
+                    int v;
+                    memcpy(&v, a, sizeof(v));
+                    a += sizeof(v);
+                    n += snprintf(spec + n, sizeof(spec) - n, "%d", v);
+                } else {
+                    spec[n++] = *p;
+                }
+            }
+            spec[n] = '\0';
+
+            int written = 0;
+            char *out = buf + len;
+            size_t room = size - len;
+            switch (s.kind) {
+            case ARG_INT: {
+                int v;
+                memcpy(&v, a, sizeof(v));
+                written = snprintf(out, room, spec, v);
+                break;
+            }
+            case ARG_LONG: {
+                long v;
+                memcpy(&v, a, sizeof(v));
+                written = snprintf(out, room, spec, v);
+                break;
+            }
+            case ARG_LONG_LONG: {
+                long long v;
+                memcpy(&v, a, sizeof(v));
+                written = snprintf(out, room, spec, v);
+                break;
+            }
+            case ARG_SIZE: {
+                size_t v;
+                memcpy(&v, a, sizeof(v));
+                written = snprintf(out, room, spec, v);
+                break;
+            }
+            case ARG_DOUBLE: {
+                double v;
+                memcpy(&v, a, sizeof(v));
+                written = snprintf(out, room, spec, v);
+                break;
+            }
+            case ARG_POINTER: {
+                void *v;
+                memcpy(&v, a, sizeof(v));
+                written = snprintf(out, room, spec, v);
+                break;
+            }
+            case ARG_STRING:
+                written = snprintf(out, room, spec, (const char *)a);
+                break;
+            }
+            a += argSize(s.kind, a);
+            if (written > 0)
+                len += (size_t)written < room ? (size_t)written : room - 1;
+        }
+        buf[len] = '\0';
+        return len;
+    }
+
+  private:
+    enum ArgKind : uint8_t { ARG_INT, ARG_LONG, ARG_LONG_LONG, ARG_SIZE, ARG_DOUBLE, ARG_POINTER, ARG_STRING };
+
+    struct Spec {
+        const char *start;
+        const char *end; // One past the conversion character
+        char conv;
+        ArgKind kind;
+        uint8_t stars; // Number of * width/precision arguments
+        bool supported;
+    };
+
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        Record record;
+    };
+
+    Slot slots[Slots];
+    std::atomic<uint32_t> enqueuePos{0};
+    uint32_t dequeuePos = 0;
+    std::atomic<uint32_t> drops{0};
+
+    static size_t argSize(ArgKind kind, const uint8_t *a)
+    {
+        switch (kind) {
+        case ARG_LONG:
+            return sizeof(long);
+        case ARG_LONG_LONG:
+            return sizeof(long long);
+        case ARG_SIZE:
+            return sizeof(size_t);
+        case ARG_DOUBLE:
+            return sizeof(double);
+        case ARG_POINTER:
+            return sizeof(void *);
+        case ARG_STRING:
+            return strlen((const char *)a) + 1;
+        default:
+            return sizeof(int);
+        }
+    }
+
+    /// Parse the conversion starting at f (which points at '%')
+    static bool parseSpec(const char *f, Spec &s)
+    {
+        s.start = f++;
+        s.stars = 0;
+        s.supported = true;
+        while (*f && strchr("-+ #0", *f))
+            f++;
+        if (*f == '*') {
+            s.stars++;
+            f++;
+        } else {
+            while (*f >= '0' && *f <= '9')
+                f++;
+        }
+        if (*f == '.') {
+            f++;
+            if (*f == '*') {
+                s.stars++;
+                f++;
+            } else {
+                while (*f >= '0' && *f <= '9')
+                    f++;
+            }
+        }
+        char length = 0;
+        if (*f == 'h') {
+            f += f[1] == 'h' ? 2 : 1;
+        } else if (*f == 'l') {
+            length = f[1] == 'l' ? 'q' : 'l';
+            f += length == 'q' ? 2 : 1;
+        } else if (*f == 'z' || *f == 'j' || *f == 't' || *f == 'L') {
+            length = *f++;
+        }
+        if (!*f)
+            return false;
+        s.conv = *f++;
+        s.end = f;
+
+        switch (s.conv) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            if (length == 'l')
+                s.kind = ARG_LONG;
+            else if (length == 'q' || length == 'j')
+                s.kind = ARG_LONG_LONG;
+            else if (length == 'z' || length == 't')
+                s.kind = ARG_SIZE;
+            else
+                s.kind = ARG_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            s.kind = ARG_DOUBLE;
+            s.supported = length != 'L';
+            break;
+        case 'p':
+            s.kind = ARG_POINTER;
+            break;
+        case 's':
+            s.kind = ARG_STRING;
+            break;
+        case '%':
+            s.kind = ARG_INT;
+            break;
+        default:
+            s.supported = false; // %n and anything unknown
+        }
+        return true;
+    }
+
+    template <typename T> static bool put(Record &r, const T &v)
+    {
+        if (r.dataLen + sizeof(T) > Bytes)
+            return false;
+        memcpy(r.data + r.dataLen, &v, sizeof(T));
+        r.dataLen += sizeof(T);
+        return true;
+    }
+
+    static bool capture(Record &r, const char *format, va_list arg)
+    {
+        for (const char *f = format; *f;) {
+            if (*f != '%') {
+                f++;
+                continue;
+            }
+            Spec s;
+            if (!parseSpec(f, s) || !s.supported)
+                return false;
+            f = s.end;
+            if (s.conv == '%')
+                continue;
+            for (uint8_t i = 0; i < s.stars; i++) {
+                if (!put(r, va_arg(arg, int)))
+                    return false;
+            }
+
+            bool ok = true;
+            switch (s.kind) {
+            case ARG_INT:
+                ok = put(r, va_arg(arg, int));
+                break;
+            case ARG_LONG:
+                ok = put(r, va_arg(arg, long));
+                break;
+            case ARG_LONG_LONG:
+                ok = put(r, va_arg(arg, long long));
+                break;
+            case ARG_SIZE:
+                ok = put(r, va_arg(arg, size_t));
+                break;
+            case ARG_DOUBLE:
+                ok = put(r, va_arg(arg, double));
+                break;
+            case ARG_POINTER:
+                ok = put(r, va_arg(arg, void *));
+                break;
+            case ARG_STRING: {
+                // Copy as much of the string as fits, it may not outlive the call
+                const char *str = va_arg(arg, const char *);
+                if (!str)
+                    str = "(null)";
+                if (r.dataLen >= Bytes)
+                    return false;
+                size_t room = Bytes - r.dataLen - 1;
+                size_t n = strlen(str);
+                if (n > room)
+                    n = room;
+                memcpy(r.data + r.dataLen, str, n);
+                r.data[r.dataLen + n] = '\0';
+                r.dataLen += n + 1;
+                break;
+            }
+            }
+            if (!ok)
+                return false;
+        }
+        return true;
+    }
+};
@@ -11,9 +11,9 @@
  * For more information, see: https://meshtastic.org/
  */
 #include "power.h"
+#include "AnalogSampler.h"
 #include "NodeDB.h"
 #include "PowerFSM.h"
-#include "Throttle.h"
 #include "buzz/buzz.h"
 #include "configuration.h"
 #include "main.h"
@@ -23,6 +23,7 @@
 #if defined(ARCH_PORTDUINO)
 #include "api/WiFiServerAPI.h"
 #include "input/LinuxInputImpl.h"
+#include "mesh/PacketTrace.h"
 #endif
 
 // Working USB detection for powered/charging states on the RAK platform
@@ -309,105 +310,93 @@ class AnalogBatteryLevel : public HasBatteryLevel
 #endif
 
 #ifdef BATTERY_PIN
+        if (batteryChannel < 0)
+            return 0;
         // Override variant or default ADC_MULTIPLIER if we have the override pref
         float operativeAdcMultiplier =
             config.power.adc_multiplier_override > 0 ? config.power.adc_multiplier_override : ADC_MULTIPLIER;
-        // Do not call analogRead() often.
-        const uint32_t min_read_interval = 5000;
-        if (!initial_read_done || !Throttle::isWithinTimespanMs(last_read_time_ms, min_read_interval)) {
-            last_read_time_ms = millis();
-
-            uint32_t raw = 0;
-            float scaled = 0;
-
-            adcEnable();
+        // Sampled and low pass filtered in the background by analogSampler, this never touches the ADC after boot
+        float raw = analogSampler->read(batteryChannel);
+        float scaled;
 #ifdef ARCH_ESP32 // ADC block for espressif platforms
-            raw = espAdcRead();
-            scaled = esp_adc_cal_raw_to_voltage(raw, adc_characs);
-            scaled *= operativeAdcMultiplier;
+        scaled = esp_adc_cal_raw_to_voltage((uint32_t)(raw + 0.5f), adc_characs);
+        scaled *= operativeAdcMultiplier;
 #else // block for all other platforms
-            for (uint32_t i = 0; i < BATTERY_SENSE_SAMPLES; i++) {
-                raw += analogRead(BATTERY_PIN);
-            }
-            raw = raw / BATTERY_SENSE_SAMPLES;
-            scaled = operativeAdcMultiplier * ((1000 * AREF_VOLTAGE) / pow(2, BATTERY_SENSE_RESOLUTION_BITS)) * raw;
-#endif
-            adcDisable();
-
-            if (!initial_read_done) {
-                // Flush the smoothing filter with an ADC reading, if the reading is plausibly correct
-                if (scaled > last_read_value)
-                    last_read_value = scaled;
-                initial_read_done = true;
-            } else {
-                // Already initialized - filter this reading
-                last_read_value += (scaled - last_read_value) * 0.5; // Virtual LPF
-            }
-
-            // LOG_DEBUG("battery gpio %d raw val=%u scaled=%u filtered=%u", BATTERY_PIN, raw, (uint32_t)(scaled), (uint32_t)
-            // (last_read_value));
-        }
-        return last_read_value;
+        scaled = operativeAdcMultiplier * ((1000 * AREF_VOLTAGE) / pow(2, BATTERY_SENSE_RESOLUTION_BITS)) * raw;
+#endif
+        // LOG_DEBUG("battery gpio %d raw val=%u scaled=%u", BATTERY_PIN, (uint32_t)raw, (uint32_t)scaled);
+        // Seeded as the old filter was: never below an empty battery until a burst has succeeded, nor for the first one,
+        // so a failed boot read doesn't show a dead battery
+        if (analogSampler->getSamples(batteryChannel) <= 1 && scaled < emptyVolt)
+            return emptyVolt;
+        return scaled;
 #endif // BATTERY_PIN
         return 0;
     }
 
 #if defined(ARCH_ESP32) && !defined(HAS_PMU) && defined(BATTERY_PIN)
     /**
-     * ESP32 specific function for getting calibrated ADC reads
+     * ESP32 specific function for one raw ADC conversion, negative if it failed
      */
-    uint32_t espAdcRead()
+    static int32_t espAdcRead()
     {
-
-        uint32_t raw = 0;
-        uint8_t raw_c = 0; // raw reading counter
-
 #ifndef BAT_MEASURE_ADC_UNIT // ADC1
-        for (int i = 0; i < BATTERY_SENSE_SAMPLES; i++) {
-            int val_ = adc1_get_raw(adc_channel);
-            if (val_ >= 0) { // save only valid readings
-                raw += val_;
-                raw_c++;
-            }
-            // delayMicroseconds(100);
-        }
+        return adc1_get_raw(adc_channel);
 #else                            // ADC2
 #ifdef CONFIG_IDF_TARGET_ESP32S3 // ESP32S3
         // ADC2 wifi bug workaround not required, breaks compile
         // On ESP32S3, ADC2 can take turns with Wifi (?)
-
-        int32_t adc_buf;
-        esp_err_t read_result;
-
-        // Multiple samples
-        for (int i = 0; i < BATTERY_SENSE_SAMPLES; i++) {
-            adc_buf = 0;
-            read_result = -1;
-
-            read_result = adc2_get_raw(adc_channel, ADC_WIDTH_BIT_12, &adc_buf);
-            if (read_result == ESP_OK) {
-                raw += adc_buf;
-                raw_c++; // Count valid samples
-            } else {
-                LOG_DEBUG("An attempt to sample ADC2 failed");
-            }
+        int32_t adc_buf = 0;
+        if (adc2_get_raw(adc_channel, ADC_WIDTH_BIT_12, &adc_buf) != ESP_OK) {
+            LOG_DEBUG("An attempt to sample ADC2 failed");
+            return -1;
         }
-
+        return adc_buf;
 #else  // Other ESP32
+        // ADC2 wifi bug workaround, see
+        // https://github.com/espressif/arduino-esp32/issues/102
         int32_t adc_buf = 0;
-        for (int i = 0; i < BATTERY_SENSE_SAMPLES; i++) {
-            // ADC2 wifi bug workaround, see
-            // https://github.com/espressif/arduino-esp32/issues/102
-            WRITE_PERI_REG(SENS_SAR_READ_CTRL2_REG, RTC_reg_b);
-            SET_PERI_REG_MASK(SENS_SAR_READ_CTRL2_REG, SENS_SAR2_DATA_INV);
-            adc2_get_raw(adc_channel, ADC_WIDTH_BIT_12, &adc_buf);
-            raw += adc_buf;
-            raw_c++;
-        }
-#endif // BAT_MEASURE_ADC_UNIT
-
+        WRITE_PERI_REG(SENS_SAR_READ_CTRL2_REG, RTC_reg_b);
+        SET_PERI_REG_MASK(SENS_SAR_READ_CTRL2_REG, SENS_SAR2_DATA_INV);
+        adc2_get_raw(adc_channel, ADC_WIDTH_BIT_12, &adc_buf);
+        return adc_buf;
+#endif
 #endif // End BAT_MEASURE_ADC_UNIT
-        return (raw / (raw_c < 1 ? 1 : raw_c));
+    }
+#endif
+
+#ifdef BATTERY_PIN
+    /**
+     * Register the battery divider with analogSampler, once the ADC is configured
+     */
+    void beginSampling()
+    {
+        AnalogChannel::Config channel = {};
+        channel.name = "battery";
+        channel.intervalMs = 5000; // Battery voltage moves slowly, do not keep the divider powered more than needed
+        channel.oversample = BATTERY_SENSE_SAMPLES;
+        channel.medianWindow = 1;
+        channel.emaAlpha = 0.5; // Virtual LPF
+        channel.read = readBatteryPin;
+        channel.power = powerBatteryDivider;
+        batteryChannel = analogSampler->addChannel(channel);
+    }
+
+    static int32_t readBatteryPin(void *)
+    {
+#ifdef ARCH_ESP32
+        return espAdcRead();
+#else
+        return analogRead(BATTERY_PIN);
+#endif
+    }
+
+    static void powerBatteryDivider(void *, bool on)
+    {
+        if (on)
+            adcEnable();
+        else
+            adcDisable();
     }
 #endif
 
@@ -498,12 +487,9 @@ class AnalogBatteryLevel : public HasBatteryLevel
     const uint16_t OCV[NUM_OCV_POINTS] = {OCV_ARRAY};
     const float chargingVolt = (OCV[0] + 10) * NUM_CELLS;
     const float noBatVolt = (OCV[NUM_OCV_POINTS - 1] - 500) * NUM_CELLS;
-    // Start value from minimum voltage for the filter to not start from 0
-    // that could trigger some events.
-    // This value is over-written by the first ADC reading, it the voltage seems reasonable.
-    bool initial_read_done = false;
-    float last_read_value = (OCV[NUM_OCV_POINTS - 1] * NUM_CELLS);
-    uint32_t last_read_time_ms = 0;
+    const float emptyVolt = OCV[NUM_OCV_POINTS - 1] * NUM_CELLS;
+    // analogSampler channel of the battery divider, the first read samples it so the filter never starts from 0
+    int8_t batteryChannel = -1;
 
 #if HAS_TELEMETRY && !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR && defined(HAS_RAKPROT)
 
@@ -661,6 +647,7 @@ bool Power::analogInit()
     analogReadResolution(BATTERY_SENSE_RESOLUTION_BITS);
 #endif
 
+    analogLevel.beginSampling();
     batteryLevel = &analogLevel;
     return true;
 #else
@@ -721,6 +708,7 @@ void Power::reboot()
 #elif defined(ARCH_RP2040)
     rp2040.reboot();
 #elif defined(ARCH_PORTDUINO)
+    packetTrace.end(); // Don't count on atexit handlers running across the restart
     deInitApiServer();
     if (aLinuxInputImpl)
         aLinuxInputImpl->deInit();
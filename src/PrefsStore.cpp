@@ -0,0 +1,138 @@
+#include "PrefsStore.h"
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "Throttle.h"
+#include "configuration.h"
+
+#ifdef FSCom
+
+static const char *const segmentFileNames[2] = {"/prefs/records.0", "/prefs/records.1"};
+
+/// The two segments are plain files, LittleFS takes care of wear leveling the blocks beneath them
+class FSRecordStorage : public RecordStore::Storage
+{
+  public:
+    size_t size(uint8_t segment) override
+    {
+        concurrency::LockGuard g(spiLock);
+        return openReader(segment) ? reader.size() : 0;
+    }
+
+    bool read(uint8_t segment, size_t offset, uint8_t *buf, size_t length) override
+    {
+        // A replay reads a segment 64 bytes at a time, so the file stays open until endReads()
+        concurrency::LockGuard g(spiLock);
+        return openReader(segment) && reader.seek(offset) && reader.read(buf, length) == length;
+    }
+
+    void endReads() override
+    {
+        concurrency::LockGuard g(spiLock);
+        closeReader();
+    }
+
+    bool append(uint8_t segment, const uint8_t *const *pieces, const size_t *lengths, size_t count) override
+    {
+        uint32_t started = micros();
+        bool ok;
+        {
+            concurrency::LockGuard g(spiLock);
+            closeReader();
+            auto f = FSCom.open(segmentFileNames[segment], FILE_O_APPEND);
+            ok = !!f;
+            for (size_t i = 0; ok && i < count; i++)
+                ok = !lengths[i] || f.write(pieces[i], lengths[i]) == lengths[i];
+            if (f)
+                f.close();
+        }
+        uint32_t held = micros() - started;
+        if (held > worstAppendUs)
+            worstAppendUs = held;
+        return ok;
+    }
+
+    bool erase(uint8_t segment) override
+    {
+        concurrency::LockGuard g(spiLock);
+        closeReader();
+        FSCom.mkdir("/prefs");
+        return !FSCom.exists(segmentFileNames[segment]) || FSCom.remove(segmentFileNames[segment]);
+    }
+
+    uint32_t worstAppendUs = 0; // Longest spiLock hold of an append, including the file open and close
+
+  private:
+    File reader;
+    int8_t readerSegment = -1;
+
+    /// Call with spiLock held
+    bool openReader(uint8_t segment)
+    {
+        if (readerSegment == segment)
+            return true;
+        closeReader();
+        reader = FSCom.open(segmentFileNames[segment], FILE_O_READ);
+        if (!reader)
+            return false;
+        readerSegment = segment;
+        return true;
+    }
+
+    /// Call with spiLock held
+    void closeReader()
+    {
+        if (readerSegment >= 0)
+            reader.close();
+        readerSegment = -1;
+    }
+};
+
+static FSRecordStorage *storage;
+static RecordStore *store;
+
+RecordStore *prefsStore()
+{
+    // First used by NodeDB's constructor from setup(), before other threads touch settings
+    if (!store) {
+        storage = new FSRecordStorage();
+        store = new RecordStore(storage);
+        if (store->mount())
+            LOG_INFO("Record store: generation %u, %u of %u bytes live", store->getGeneration(),
+                     (unsigned)store->getLiveBytes(), (unsigned)store->getActiveSize());
+    }
+    return store;
+}
+
+void reportPrefsStoreStats()
+{
+    static const uint32_t STATS_INTERVAL_MS = 24 * 60 * 60 * 1000;
+    static uint32_t statsStartedMs;
+    static uint32_t lastBytes, lastPuts, lastUnchanged, lastCompactions;
+    if (!store)
+        return;
+    if (statsStartedMs && Throttle::isWithinTimespanMs(statsStartedMs, STATS_INTERVAL_MS))
+        return;
+
+    if (statsStartedMs)
+        LOG_INFO("Record store in the last day: %u saves (%u unchanged, skipped), %u bytes written, %u compactions, worst "
+                 "append %u us",
+                 store->getPuts() - lastPuts, store->getUnchanged() - lastUnchanged, store->getBytesWritten() - lastBytes,
+                 store->getCompactions() - lastCompactions, storage->worstAppendUs);
+    statsStartedMs = millis();
+    lastBytes = store->getBytesWritten();
+    lastPuts = store->getPuts();
+    lastUnchanged = store->getUnchanged();
+    lastCompactions = store->getCompactions();
+    storage->worstAppendUs = 0;
+}
+
+#else
+
+RecordStore *prefsStore()
+{
+    return nullptr;
+}
+
+void reportPrefsStoreStats() {}
+
+#endif
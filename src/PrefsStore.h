@@ -0,0 +1,13 @@
+#pragma once
+
+#include "RecordStore.h"
+
+/**
+ * The record store holding the small settings protobufs under /prefs, mounted on first use.
+ *
+ * @return nullptr on targets without a filesystem
+ */
+RecordStore *prefsStore();
+
+/// Log what the store wrote, and its slowest append, once a day
+void reportPrefsStoreStats();
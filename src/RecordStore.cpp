@@ -0,0 +1,311 @@
+#include "RecordStore.h"
+#include <ErriezCRC32.h>
+#include <string.h>
+
+uint32_t RecordStore::recordCrc(const RecordHeader &header, const char *key, const uint8_t *value)
+{
+    uint32_t crc = CRC32_INITIAL;
+    crc = crc32Update((const uint8_t *)&header + sizeof(header.crc), sizeof(header) - sizeof(header.crc), crc);
+    crc = crc32Update(key, header.keyLength, crc);
+    crc = crc32Update(value, header.valueLength, crc);
+    return crc32Final(crc);
+}
+
+bool RecordStore::checkRecord(uint8_t segment, size_t valueOffset, const RecordHeader &header, const char *key)
+{
+    // Values are read in small pieces so checking a record needs no value sized buffer
+    uint32_t crc = CRC32_INITIAL;
+    crc = crc32Update((const uint8_t *)&header + sizeof(header.crc), sizeof(header) - sizeof(header.crc), crc);
+    crc = crc32Update(key, header.keyLength, crc);
+    uint8_t chunk[64];
+    for (size_t done = 0; done < header.valueLength;) {
+        size_t n = header.valueLength - done < sizeof(chunk) ? header.valueLength - done : sizeof(chunk);
+        if (!storage->read(segment, valueOffset + done, chunk, n))
+            return false;
+        crc = crc32Update(chunk, n, crc);
+        done += n;
+    }
+    return crc32Final(crc) == header.crc;
+}
+
+int RecordStore::find(const char *key) const
+{
+    for (uint8_t i = 0; i < numEntries; i++) {
+        if (strcmp(entries[i].key, key) == 0)
+            return i;
+    }
+    return -1;
+}
+
+void RecordStore::clear()
+{
+    numEntries = 0;
+    activeSize = 0;
+    damaged = false;
+}
+
+size_t RecordStore::getLiveBytes() const
+{
+    size_t bytes = sizeof(SegmentHeader);
+    for (uint8_t i = 0; i < numEntries; i++)
+        bytes += sizeof(RecordHeader) + strlen(entries[i].key) + entries[i].length;
+    return bytes;
+}
+
+bool RecordStore::replay(uint8_t segment, uint32_t &outGeneration)
+{
+    numEntries = 0;
+    damaged = false;
+    size_t size = storage->size(segment);
+    SegmentHeader header;
+    if (size < sizeof(header) || !storage->read(segment, 0, (uint8_t *)&header, sizeof(header)) || header.magic != MAGIC ||
+        crc32Buffer(&header, sizeof(header) - sizeof(header.crc)) != header.crc)
+        return false;
+
+    size_t offset = sizeof(header);
+    uint16_t records = 0;
+    char key[MAX_KEY + 1];
+    RecordHeader record;
+    while (offset + sizeof(record) <= size) {
+        if (!storage->read(segment, offset, (uint8_t *)&record, sizeof(record)) || record.keyLength == 0 ||
+            record.keyLength > MAX_KEY || record.valueLength > MAX_VALUE ||
+            offset + sizeof(record) + record.keyLength + record.valueLength > size ||
+            !storage->read(segment, offset + sizeof(record), (uint8_t *)key, record.keyLength) ||
+            !checkRecord(segment, offset + sizeof(record) + record.keyLength, record, key)) {
+            damaged = true;
+            break;
+        }
+        key[record.keyLength] = '\0';
+
+        int i = find(key);
+        if (record.flags & FLAG_REMOVED) {
+            if (i >= 0)
+                entries[i] = entries[--numEntries];
+        } else {
+            if (i < 0 && numEntries < MAX_RECORDS) {
+                i = numEntries++;
+                memcpy(entries[i].key, key, record.keyLength + 1);
+            }
+            if (i >= 0) {
+                entries[i].offset = offset + sizeof(record) + record.keyLength;
+                entries[i].length = record.valueLength;
+                entries[i].crc = record.crc;
+            }
+        }
+        offset += sizeof(record) + record.keyLength + record.valueLength;
+        records++;
+    }
+    if (offset != size)
+        damaged = true; // Also a torn tail too short to hold a record header
+
+    if (records < header.records) {
+        // Compaction into this segment never finished
+        numEntries = 0;
+        return false;
+    }
+    outGeneration = header.generation;
+    activeSize = offset;
+    return true;
+}
+
+bool RecordStore::mount()
+{
+    clear();
+    uint32_t generations[2] = {0, 0};
+    bool valid[2];
+    for (uint8_t segment = 0; segment < 2; segment++)
+        valid[segment] = replay(segment, generations[segment]);
+
+    if (!valid[0] && !valid[1]) {
+        storage->endReads();
+        clear();
+        return false;
+    }
+    // Newest complete segment wins, replay it again since the other one may have been indexed last
+    active = (valid[0] && valid[1]) ? (generations[1] > generations[0]) : valid[1];
+    replay(active, generation);
+    storage->endReads();
+    return true;
+}
+
+int32_t RecordStore::length(const char *key) const
+{
+    int i = find(key);
+    return i < 0 ? -1 : entries[i].length;
+}
+
+bool RecordStore::get(const char *key, uint8_t *buf, size_t size, size_t *outLength)
+{
+    int i = find(key);
+    if (i < 0 || entries[i].length > size)
+        return false;
+    bool ok = storage->read(active, entries[i].offset, buf, entries[i].length);
+    storage->endReads();
+    if (!ok)
+        return false;
+
+    // Check the CRC again, the flash may have changed underneath since mount
+    RecordHeader record = {0, entries[i].length, (uint8_t)strlen(key), 0};
+    if (recordCrc(record, key, buf) != entries[i].crc)
+        return false;
+    if (outLength)
+        *outLength = entries[i].length;
+    return true;
+}
+
+bool RecordStore::writeHeader(uint8_t segment, uint32_t newGeneration, uint16_t records)
+{
+    SegmentHeader header = {MAGIC, newGeneration, records, 0, 0};
+    header.crc = crc32Buffer(&header, sizeof(header) - sizeof(header.crc));
+    const uint8_t *pieces[] = {(const uint8_t *)&header};
+    const size_t lengths[] = {sizeof(header)};
+    if (!storage->erase(segment) || !storage->append(segment, pieces, lengths, 1))
+        return false;
+    bytesWritten += sizeof(header);
+    return true;
+}
+
+bool RecordStore::appendRecord(uint8_t segment, size_t &segmentSize, const char *key, const uint8_t *value, size_t length,
+                               uint8_t flags, uint32_t &crc)
+{
+    RecordHeader record = {0, (uint16_t)length, (uint8_t)strlen(key), flags};
+    record.crc = recordCrc(record, key, value);
+    const uint8_t *pieces[] = {(const uint8_t *)&record, (const uint8_t *)key, value};
+    const size_t lengths[] = {sizeof(record), record.keyLength, length};
+    if (!storage->append(segment, pieces, lengths, 3))
+        return false;
+    size_t written = sizeof(record) + record.keyLength + length;
+    segmentSize += written;
+    bytesWritten += written;
+    crc = record.crc;
+    return true;
+}
+
+bool RecordStore::put(const char *key, const uint8_t *value, size_t length)
+{
+    size_t keyLength = strlen(key);
+    if (keyLength == 0 || keyLength > MAX_KEY || length > MAX_VALUE)
+        return false;
+
+    int i = find(key);
+    RecordHeader record = {0, (uint16_t)length, (uint8_t)keyLength, 0};
+    if (i >= 0 && entries[i].length == length && recordCrc(record, key, value) == entries[i].crc) {
+        unchanged++;
+        return true;
+    }
+    if (i < 0 && numEntries >= MAX_RECORDS)
+        return false;
+
+    // Appending after a torn record would hide everything behind it from the next replay, start a clean segment first
+    if ((damaged || activeSize == 0) && !compact())
+        return false;
+    // compact() may have dropped entries it could not read back
+    i = find(key);
+    if (i < 0 && numEntries >= MAX_RECORDS)
+        return false;
+
+    uint32_t crc;
+    size_t valueOffset = activeSize + sizeof(RecordHeader) + keyLength;
+    if (!appendRecord(active, activeSize, key, value, length, 0, crc)) {
+        damaged = true;
+        return false;
+    }
+    if (i < 0) {
+        i = numEntries++;
+        memcpy(entries[i].key, key, keyLength + 1);
+    }
+    entries[i].offset = valueOffset;
+    entries[i].length = length;
+    entries[i].crc = crc;
+    puts++;
+    compactIfNeeded();
+    return true;
+}
+
+bool RecordStore::remove(const char *key)
+{
+    int i = find(key);
+    if (i < 0)
+        return true;
+    if ((damaged || activeSize == 0) && !compact())
+        return false;
+    i = find(key);
+    if (i < 0)
+        return true;
+
+    uint32_t crc;
+    if (!appendRecord(active, activeSize, key, nullptr, 0, FLAG_REMOVED, crc)) {
+        damaged = true;
+        return false;
+    }
+    entries[i] = entries[--numEntries];
+    return true;
+}
+
+void RecordStore::removePrefix(const char *prefix)
+{
+    size_t prefixLength = strlen(prefix);
+    for (int i = numEntries - 1; i >= 0; i--) {
+        if (i < numEntries && strncmp(entries[i].key, prefix, prefixLength) == 0) {
+            char key[MAX_KEY + 1];
+            memcpy(key, entries[i].key, sizeof(key)); // remove() reshuffles entries
+            remove(key);
+        }
+    }
+}
+
+bool RecordStore::compactIfNeeded()
+{
+    if (damaged)
+        return compact();
+    size_t live = getLiveBytes();
+    if (activeSize < COMPACT_BYTES || activeSize - live < live)
+        return true;
+    return compact();
+}
+
+bool RecordStore::compact()
+{
+    // Only promise the new segment the records that still read back, a value gone bad on flash is dropped rather than
+    // blocking compaction forever
+    uint8_t readable = 0;
+    for (uint8_t i = 0; i < numEntries; i++) {
+        RecordHeader record = {entries[i].crc, entries[i].length, (uint8_t)strlen(entries[i].key), 0};
+        if (checkRecord(active, entries[i].offset, record, entries[i].key))
+            entries[readable++] = entries[i];
+    }
+    storage->endReads();
+    numEntries = readable;
+
+    uint8_t target = active ^ 1;
+    uint32_t newGeneration = generation + 1;
+    if (!writeHeader(target, newGeneration, numEntries))
+        return false;
+
+    size_t targetSize = sizeof(SegmentHeader);
+    uint8_t *value = numEntries ? new uint8_t[MAX_VALUE] : nullptr;
+    bool ok = true;
+    for (uint8_t i = 0; ok && i < numEntries; i++) {
+        Entry &e = entries[i];
+        size_t length;
+        uint32_t crc;
+        size_t valueOffset = targetSize + sizeof(RecordHeader) + strlen(e.key);
+        ok = get(e.key, value, MAX_VALUE, &length) && appendRecord(target, targetSize, e.key, value, length, 0, crc);
+        e.offset = valueOffset; // Only used once active switches below
+    }
+    delete[] value;
+    if (!ok) {
+        // The header promised more records than follow it, so the target does not count and the active segment stays
+        mount();
+        return false;
+    }
+
+    active = target;
+    generation = newGeneration;
+    activeSize = targetSize;
+    damaged = false;
+    compactions++;
+    // The old segment is now superseded by generation, emptying it just gives the space back early
+    storage->erase(target ^ 1);
+    return true;
+}
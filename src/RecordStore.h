@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Small key/value store for settings blobs, kept as an append-only log in two segments.
+ *
+ * Saving a protobuf through SafeFile writes a temp file, reads it all back and renames it over the old one, which on
+ * LittleFS is several metadata commits and block erases per save, all under spiLock. Here a save appends one record
+ * (header, key, value, CRC32) to the active segment and is committed the moment its last byte is on flash. A record whose
+ * CRC does not match ends the replay, so a save torn by a power loss reads back as the previous value.
+ *
+ * Saving a value identical to the stored one writes nothing, which covers most of NodeDB's saveToDisk() calls since it saves
+ * every segment whenever any of them changed.
+ *
+ * Once the active segment passes COMPACT_BYTES and holds more superseded records than live ones, the live records are copied
+ * into the other segment behind a header with the next generation number and the count of records copied. A segment only
+ * counts once that many records follow its header, so power loss during compaction leaves the old segment in charge. The
+ * segments take turns, which spreads the erases between them, and compaction is put off until most of what it would copy is
+ * garbage, so each byte of a live record is rewritten as rarely as possible.
+ *
+ * The store knows nothing about files, Storage maps segments onto whatever is underneath (see PrefsStore.cpp for LittleFS).
+ */
+class RecordStore
+{
+  public:
+    static const size_t MAX_KEY = 31;
+    static const size_t MAX_VALUE = 2048; // Fits DeviceState, the largest of the settings protobufs
+    static const uint8_t MAX_RECORDS = 16;
+    static const size_t COMPACT_BYTES = 16 * 1024;
+
+    /// Two append-only byte areas, segment 0 and 1
+    class Storage
+    {
+      public:
+        virtual ~Storage() {}
+
+        /// Bytes in the segment, 0 if it does not exist
+        virtual size_t size(uint8_t segment) = 0;
+
+        /// May keep the segment open for the reads that follow, until endReads()
+        virtual bool read(uint8_t segment, size_t offset, uint8_t *buf, size_t length) = 0;
+
+        /// Done reading for now, e.g. at the end of a replay
+        virtual void endReads() {}
+
+        /// Append the pieces in order, as one write where the medium allows
+        virtual bool append(uint8_t segment, const uint8_t *const *pieces, const size_t *lengths, size_t count) = 0;
+
+        /// Empty the segment
+        virtual bool erase(uint8_t segment) = 0;
+    };
+
+    explicit RecordStore(Storage *_storage) : storage(_storage) {}
+
+    /**
+     * Find the newest complete segment and index the records in it.
+     *
+     * @return false if nothing valid was found, the store then starts out empty
+     */
+    bool mount();
+
+    /// Forget everything, e.g. after the files underneath were deleted by a factory reset
+    void clear();
+
+    bool has(const char *key) const { return find(key) >= 0; }
+
+    /// Length of the stored value, -1 if there is none
+    int32_t length(const char *key) const;
+
+    /**
+     * Copy a value out.
+     *
+     * @return false if the key is missing, the buffer is too small, or the value no longer matches its CRC
+     */
+    bool get(const char *key, uint8_t *buf, size_t size, size_t *outLength);
+
+    /**
+     * Store a value, atomically replacing any previous one.
+     *
+     * @return true once the value is on flash, or was already stored
+     */
+    bool put(const char *key, const uint8_t *value, size_t length);
+
+    bool remove(const char *key);
+
+    /// Remove every key starting with prefix
+    void removePrefix(const char *prefix);
+
+    /// Copy the live records into the other segment if the active one is big and mostly garbage, or damaged
+    bool compactIfNeeded();
+
+    /// Copy the live records into the other segment now
+    bool compact();
+
+    uint32_t getBytesWritten() const { return bytesWritten; } // Everything appended, compaction included
+    uint32_t getPuts() const { return puts; }
+    uint32_t getUnchanged() const { return unchanged; }
+    uint32_t getCompactions() const { return compactions; }
+    uint32_t getGeneration() const { return generation; }
+    size_t getActiveSize() const { return activeSize; }
+    size_t getLiveBytes() const;
+    uint8_t getActiveSegment() const { return active; }
+
+  private:
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t generation;
+        uint16_t records; // Records copied in by the compaction that started this segment
+        uint16_t reserved;
+        uint32_t crc;
+    };
+
+    enum : uint8_t { FLAG_REMOVED = 1 };
+
+    struct RecordHeader {
+        uint32_t crc; // Over the rest of the header, the key and the value
+        uint16_t valueLength;
+        uint8_t keyLength;
+        uint8_t flags;
+    };
+
+    struct Entry {
+        char key[MAX_KEY + 1];
+        uint32_t offset; // Of the value within the active segment
+        uint16_t length;
+        uint32_t crc; // Of the whole record, to spot unchanged puts
+    };
+
+    static const uint32_t MAGIC = 0x31535452; // "RTS1"
+
+    Storage *storage;
+    Entry entries[MAX_RECORDS];
+    uint8_t numEntries = 0;
+    uint8_t active = 0;
+    uint32_t generation = 0;
+    size_t activeSize = 0; // 0 until the segment header is written
+    bool damaged = false;  // Replay stopped at a bad record, appends would land after it
+
+    uint32_t bytesWritten = 0, puts = 0, unchanged = 0, compactions = 0;
+
+    int find(const char *key) const;
+    bool writeHeader(uint8_t segment, uint32_t newGeneration, uint16_t records);
+    bool appendRecord(uint8_t segment, size_t &segmentSize, const char *key, const uint8_t *value, size_t length,
+                      uint8_t flags, uint32_t &crc);
+
+    /// Index a segment, returning false if its header is bad or fewer records follow than it promises
+    bool replay(uint8_t segment, uint32_t &outGeneration);
+
+    /// Read a value back from flash and check it against its record's CRC
+    bool checkRecord(uint8_t segment, size_t valueOffset, const RecordHeader &header, const char *key);
+
+    static uint32_t recordCrc(const RecordHeader &header, const char *key, const uint8_t *value);
+};
@@ -20,11 +20,54 @@
 #if HAS_NETWORKING
 extern Syslog syslog;
 #endif
+
+#if LOG_QUEUE_SLOTS
+/**
+ * Writes queued log messages from the main loop, a few per run so it never holds up the radio for long.
+ * Its first run also switches logging over to the queue, so everything logged during setup() is written straight away.
+ */
+class LogDrainThread : public concurrency::OSThread
+{
+    RedirectablePrint *owner;
+
+  public:
+    explicit LogDrainThread(RedirectablePrint *_owner) : concurrency::OSThread("LogDrain"), owner(_owner) {}
+
+  protected:
+    virtual int32_t runOnce() override
+    {
+        owner->startQueueing();
+        return owner->drainLog(8) ? 0 : 10;
+    }
+};
+#endif
+
 void RedirectablePrint::rpInit()
 {
 #ifdef HAS_FREE_RTOS
     inDebugPrint = xSemaphoreCreateMutexStatic(&this->_MutexStorageSpace);
 #endif
+#if LOG_QUEUE_SLOTS
+    if (!queue) {
+        queue = new Queue();
+        new LogDrainThread(this);
+    }
+#endif
+}
+
+void RedirectablePrint::startQueueing()
+{
+#if LOG_QUEUE_SLOTS
+    queueing = queue != nullptr;
+#endif
+}
+
+const char *RedirectablePrint::logThreadName()
+{
+    if (writingQueued)
+        return queuedThread[0] ? queuedThread : nullptr;
+    auto thread = concurrency::OSThread::currentThread;
+    return thread ? thread->ThreadName.c_str() : nullptr;
 }
 
 void RedirectablePrint::setDestination(Print *_dest)
@@ -119,7 +162,11 @@ void RedirectablePrint::log_to_serial(const char *logLevel, const char *format,
             Print::write("\u001b[35m", 5);
     }
 
+    // Queued messages are stamped with the time they were logged, not the time they are written
+    uint32_t logMillis = writingQueued ? queuedMillis : millis();
     uint32_t rtc_sec = getValidTime(RTCQuality::RTCQualityDevice, true); // display local time on logfile
+    if (rtc_sec > 0 && writingQueued)
+        rtc_sec -= (millis() - queuedMillis) / 1000;
     if (rtc_sec > 0) {
         long hms = rtc_sec % SEC_PER_DAY;
         // hms += tz.tz_dsttime * SEC_PER_HOUR;
@@ -136,13 +183,13 @@ void RedirectablePrint::log_to_serial(const char *logLevel, const char *format,
         if (color) {
             ::printf("\u001b[0m");
         }
-        ::printf("| %02d:%02d:%02d %u ", hour, min, sec, millis() / 1000);
+        ::printf("| %02d:%02d:%02d %u ", hour, min, sec, logMillis / 1000);
 #else
         printf("%s ", logLevel);
         if (color) {
             printf("\u001b[0m");
         }
-        printf("| %02d:%02d:%02d %u ", hour, min, sec, millis() / 1000);
+        printf("| %02d:%02d:%02d %u ", hour, min, sec, logMillis / 1000);
 #endif
     } else {
 #ifdef ARCH_PORTDUINO
@@ -150,21 +197,19 @@ void RedirectablePrint::log_to_serial(const char *logLevel, const char *format,
         if (color) {
             ::printf("\u001b[0m");
         }
-        ::printf("| ??:??:?? %u ", millis() / 1000);
+        ::printf("| ??:??:?? %u ", logMillis / 1000);
 #else
         printf("%s ", logLevel);
         if (color) {
             printf("\u001b[0m");
         }
-        printf("| ??:??:?? %u ", millis() / 1000);
+        printf("| ??:??:?? %u ", logMillis / 1000);
 #endif
     }
-    auto thread = concurrency::OSThread::currentThread;
-    if (thread) {
+    const char *threadName = logThreadName();
+    if (threadName) {
         print("[");
-        // printf("%p ", thread);
-        // assert(thread->ThreadName.length());
-        print(thread->ThreadName);
+        print(threadName);
         print("] ");
     }
 
@@ -205,9 +250,9 @@ void RedirectablePrint::log_to_syslog(const char *logLevel, const char *format,
         default:
             ll = 0;
         }
-        auto thread = concurrency::OSThread::currentThread;
-        if (thread) {
-            syslog.vlogf(ll, thread->ThreadName.c_str(), format, arg);
+        const char *threadName = logThreadName();
+        if (threadName) {
+            syslog.vlogf(ll, threadName, format, arg);
         } else {
             syslog.vlogf(ll, format, arg);
         }
@@ -237,12 +282,12 @@ void RedirectablePrint::log_to_ble(const char *logLevel, const char *format, va_
                 message = new char[len + 1];
                 vsnprintf(message, len + 1, format, arg);
             }
-            auto thread = concurrency::OSThread::currentThread;
+            const char *threadName = logThreadName();
             meshtastic_LogRecord logRecord = meshtastic_LogRecord_init_zero;
             logRecord.level = getLogLevel(logLevel);
             strcpy(logRecord.message, message);
-            if (thread)
-                strcpy(logRecord.source, thread->ThreadName.c_str());
+            if (threadName)
+                strcpy(logRecord.source, threadName);
             logRecord.time = getValidTime(RTCQuality::RTCQualityDevice, true);
 
             uint8_t *buffer = new uint8_t[meshtastic_LogRecord_size];
@@ -288,46 +333,39 @@ meshtastic_LogRecord_Level RedirectablePrint::getLogLevel(const char *logLevel)
 
 void RedirectablePrint::log(const char *logLevel, const char *format, ...)
 {
-
-    // append \n to format
-    size_t len = strlen(format);
-    char *newFormat = new char[len + 2];
-    strcpy(newFormat, format);
-    newFormat[len] = '\n';
-    newFormat[len + 1] = '\0';
-
 #if ARCH_PORTDUINO
-    // level trace is special, two possible ways to handle it.
-    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0) {
-        if (portduino_config.traceFilename != "") {
-            va_list arg;
-            va_start(arg, format);
-            try {
-                traceFile << va_arg(arg, char *) << std::endl;
-            } catch (const std::ios_base::failure &e) {
-            }
-            va_end(arg);
-        }
-        if (portduino_config.logoutputlevel < level_trace && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0) {
-            delete[] newFormat;
-            return;
-        }
-    }
-    if (portduino_config.logoutputlevel < level_debug && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0) {
-        delete[] newFormat;
+    // The trace file gets binary packet records (see PacketTrace.h), trace messages only go to the console
+    if (portduino_config.logoutputlevel < level_trace && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0)
         return;
-    } else if (portduino_config.logoutputlevel < level_info && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_INFO) == 0) {
-        delete[] newFormat;
+    if (portduino_config.logoutputlevel < level_debug && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0)
         return;
-    } else if (portduino_config.logoutputlevel < level_warn && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_WARN) == 0) {
-        delete[] newFormat;
+    else if (portduino_config.logoutputlevel < level_info && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_INFO) == 0)
+        return;
+    else if (portduino_config.logoutputlevel < level_warn && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_WARN) == 0)
         return;
-    }
 #endif
-    if (moduleConfig.serial.override_console_serial_port && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0) {
-        delete[] newFormat;
+    if (moduleConfig.serial.override_console_serial_port && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0)
         return;
+
+#if LOG_QUEUE_SLOTS
+    // Errors are written right away, after anything queued before them, in case we are about to crash
+    if (queueing && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_ERROR) != 0 && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_CRIT) != 0) {
+        auto thread = concurrency::OSThread::currentThread;
+        va_list arg;
+        va_start(arg, format);
+        bool queued = queue->push(logLevel, format, thread ? thread->ThreadName.c_str() : nullptr, millis(), arg);
+        va_end(arg);
+        if (queued)
+            return;
     }
+#endif
+
+    // append \n to format
+    size_t len = strlen(format);
+    char *newFormat = new char[len + 2];
+    strcpy(newFormat, format);
+    newFormat[len] = '\n';
+    newFormat[len + 1] = '\0';
 
 #ifdef HAS_FREE_RTOS
     if (inDebugPrint != nullptr && xSemaphoreTake(inDebugPrint, portMAX_DELAY) == pdTRUE) {
@@ -335,14 +373,11 @@ void RedirectablePrint::log(const char *logLevel, const char *format, ...)
     if (!inDebugPrint) {
         inDebugPrint = true;
 #endif
+        writeQueued(SIZE_MAX);
 
         va_list arg;
         va_start(arg, format);
-
-        log_to_serial(logLevel, newFormat, arg);
-        log_to_syslog(logLevel, newFormat, arg);
-        log_to_ble(logLevel, newFormat, arg);
-
+        writeToSinks(logLevel, newFormat, arg);
         va_end(arg);
 #ifdef HAS_FREE_RTOS
         xSemaphoreGive(inDebugPrint);
@@ -355,6 +390,82 @@ void RedirectablePrint::log(const char *logLevel, const char *format, ...)
     return;
 }
 
+void RedirectablePrint::writeToSinks(const char *logLevel, const char *format, va_list arg)
+{
+    va_list copy;
+    va_copy(copy, arg);
+    log_to_serial(logLevel, format, copy);
+    va_end(copy);
+    va_copy(copy, arg);
+    log_to_syslog(logLevel, format, copy);
+    va_end(copy);
+    log_to_ble(logLevel, format, arg);
+}
+
+void RedirectablePrint::writeMessage(const char *logLevel, const char *format, ...)
+{
+    va_list arg;
+    va_start(arg, format);
+    writeToSinks(logLevel, format, arg);
+    va_end(arg);
+}
+
+void RedirectablePrint::writeQueued(size_t maxMessages)
+{
+#if LOG_QUEUE_SLOTS
+    if (!queue)
+        return;
+    uint32_t dropped = queue->takeDropped();
+    if (dropped)
+        writeMessage(MESHTASTIC_LOG_LEVEL_WARN, "%u log messages dropped, queue full\n", dropped);
+
+    // Static because they are too big for the stack of whichever thread ends up writing, guarded by inDebugPrint
+    static Queue::Record record;
+#if ENABLE_JSON_LOGGING || ARCH_PORTDUINO
+    static char text[512];
+#else
+    static char text[160];
+#endif
+    for (size_t i = 0; i < maxMessages && queue->pop(record); i++) {
+        size_t len = Queue::format(record, text, sizeof(text) - 1);
+        text[len++] = '\n';
+        text[len] = '\0';
+        queuedThread = record.thread;
+        queuedMillis = record.millis;
+        writingQueued = true;
+        writeMessage(record.level, "%s", text);
+        writingQueued = false;
+    }
+#else
+    (void)maxMessages;
+#endif
+}
+
+bool RedirectablePrint::drainLog(size_t maxMessages)
+{
+#if LOG_QUEUE_SLOTS
+    if (!queue || queue->empty())
+        return false;
+#ifdef HAS_FREE_RTOS
+    if (inDebugPrint != nullptr && xSemaphoreTake(inDebugPrint, portMAX_DELAY) == pdTRUE) {
+#else
+    if (!inDebugPrint) {
+        inDebugPrint = true;
+#endif
+        writeQueued(maxMessages);
+#ifdef HAS_FREE_RTOS
+        xSemaphoreGive(inDebugPrint);
+#else
+        inDebugPrint = false;
+#endif
+    }
+    return !queue->empty();
+#else
+    (void)maxMessages;
+    return false;
+#endif
+}
+
 void RedirectablePrint::hexDump(const char *logLevel, unsigned char *buf, uint16_t len)
 {
     const char alphabet[17] = "0123456789abcdef";
@@ -1,11 +1,17 @@
 #pragma once
 
 #include "../freertosinc.h"
+#include "LogQueue.h"
 #include "mesh/generated/meshtastic/mesh.pb.h"
 #include <Print.h>
 #include <stdarg.h>
 #include <string>
 
+// Messages that may be waiting to be written. 0 writes every message on the caller's thread, as before.
+#ifndef LOG_QUEUE_SLOTS
+#define LOG_QUEUE_SLOTS 32
+#endif
+
 /**
  * A Printable that can be switched to squirt its bytes to a different sink.
  * This class is mostly useful to allow debug printing to be redirected away from Serial
@@ -21,6 +27,23 @@ class RedirectablePrint : public Print
 #else
     volatile bool inDebugPrint = false;
 #endif
+
+#if LOG_QUEUE_SLOTS
+    // Room for the format and its arguments, the longest log lines are written synchronously
+#if ENABLE_JSON_LOGGING || ARCH_PORTDUINO
+    typedef LogQueue<LOG_QUEUE_SLOTS, 512> Queue;
+#else
+    typedef LogQueue<LOG_QUEUE_SLOTS, 160> Queue;
+#endif
+    Queue *queue = nullptr;
+    bool queueing = false; // Set once the drain thread runs, boot messages are written directly
+#endif
+
+    // While writing a queued message, who logged it and when
+    const char *queuedThread = nullptr;
+    uint32_t queuedMillis = 0;
+    bool writingQueued = false;
+
   public:
     explicit RedirectablePrint(Print *_dest) : dest(_dest) {}
 
@@ -48,12 +71,31 @@ class RedirectablePrint : public Print
 
     std::string mt_sprintf(const std::string fmt_str, ...);
 
+    /**
+     * Write up to maxMessages queued log messages to the sinks.
+     *
+     * @return true if more are waiting
+     */
+    bool drainLog(size_t maxMessages);
+
+    /// Start queueing messages instead of writing them on the caller's thread
+    void startQueueing();
+
   protected:
     /// Subclasses can override if they need to change how we format over the serial port
     virtual void log_to_serial(const char *logLevel, const char *format, va_list arg);
     meshtastic_LogRecord_Level getLogLevel(const char *logLevel);
 
+    /// Name of the thread the message being written came from, or nullptr
+    const char *logThreadName();
+
   private:
     void log_to_syslog(const char *logLevel, const char *format, va_list arg);
     void log_to_ble(const char *logLevel, const char *format, va_list arg);
+
+    /// Send one message to serial, syslog and BLE, caller holds inDebugPrint
+    void writeToSinks(const char *logLevel, const char *format, va_list arg);
+    void writeMessage(const char *logLevel, const char *format, ...);
+    /// Format and write queued messages, caller holds inDebugPrint
+    void writeQueued(size_t maxMessages);
 };
\ No newline at end of file
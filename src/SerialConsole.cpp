@@ -5,6 +5,7 @@
 #include "Throttle.h"
 #include "configuration.h"
 #include "time.h"
+#include "modules/gate/GateControlModule.h"
 #include "modules/irrigation/IrrigationModule.h"
 
 extern IrrigationModule *irrigationModule;
@@ -39,7 +40,7 @@ void consoleInit()
     // onReceive does only exist for HardwareSerial not for USB CDC serial
     Port.onReceive([sc]() { sc->rxInt(); });
 #endif
-    DEBUG_PORT.rpInit(); // Simply sets up semaphore
+    DEBUG_PORT.rpInit(); // Sets up the semaphore and the log queue
 }
 
 void consolePrintf(const char *format, ...)
@@ -146,8 +147,8 @@ void SerialConsole::log_to_serial(const char *logLevel, const char *format, va_l
 {
     if (usingProtobufs && config.security.debug_log_api_enabled) {
         meshtastic_LogRecord_Level ll = RedirectablePrint::getLogLevel(logLevel);
-        auto thread = concurrency::OSThread::currentThread;
-        emitLogRecord(ll, thread ? thread->ThreadName.c_str() : "", format, arg);
+        const char *threadName = logThreadName();
+        emitLogRecord(ll, threadName ? threadName : "", format, arg);
     } else
         RedirectablePrint::log_to_serial(logLevel, format, arg);
 }
@@ -191,7 +192,9 @@ void SerialConsole::processTextCommand(const char *cmd)
     trimmedCmd[len] = '\0';
     
     // Process commands
-    if (irrigationModule) {
+    if (gateControlModule && strncmp(trimmedCmd, "gate ", 5) == 0) {
+        gateControlModule->handleConsoleCommand(trimmedCmd + 5);
+    } else if (irrigationModule) {
         irrigationModule->handleConsoleCommand(trimmedCmd);
     } else {
         consolePrintf("Command not recognized: %s\n", trimmedCmd);
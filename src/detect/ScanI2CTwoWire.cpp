@@ -2,6 +2,7 @@
 
 #if !MESHTASTIC_EXCLUDE_I2C
 
+#include "I2CLock.h"
 #include "concurrency/LockGuard.h"
 #if defined(ARCH_PORTDUINO)
 #include "linux/LinuxHardwareI2C.h"
@@ -141,6 +142,8 @@ void ScanI2CTwoWire::scanPort(I2CPort port, uint8_t *address, uint8_t asize)
 #if WIRE_INTERFACES_COUNT == 2
     }
 #endif
+    // Sensors polled by telemetry share the bus, keep them off it while we probe
+    concurrency::LockGuard busGuard(i2cLock(i2cBus));
 
     // We only need to scan 112 addresses, the rest is reserved for special purposes
     // 0x00 General Call
@@ -248,7 +248,7 @@ GPS_RESPONSE GPS::getACK(const char *message, uint32_t waitMillis)
                 } else {
                     bytesRead = 0;
 #ifdef GPS_DEBUG
-                    LOG_DEBUG(debugmsg.c_str());
+                    LOG_DEBUG("%s", debugmsg.c_str());
 #endif
                 }
             }
@@ -356,7 +356,7 @@ GPS_RESPONSE GPS::getACK(uint8_t class_id, uint8_t msg_id, uint32_t waitMillis)
                 if (sCounter == 26) {
 #ifdef GPS_DEBUG
 
-                    LOG_DEBUG(debugmsg.c_str());
+                    LOG_DEBUG("%s", debugmsg.c_str());
 #endif
                     return GNSS_RESPONSE_FRAME_ERRORS;
                 }
@@ -371,7 +371,7 @@ GPS_RESPONSE GPS::getACK(uint8_t class_id, uint8_t msg_id, uint32_t waitMillis)
             } else {
                 if (ack == 3 && b == 0x00) { // UBX-ACK-NAK message
 #ifdef GPS_DEBUG
-                    LOG_DEBUG(debugmsg.c_str());
+                    LOG_DEBUG("%s", debugmsg.c_str());
 #endif
                     LOG_WARN("Got NAK for class %02X message %02X", class_id, msg_id);
                     return GNSS_RESPONSE_NAK; // NAK received
@@ -381,7 +381,7 @@ GPS_RESPONSE GPS::getACK(uint8_t class_id, uint8_t msg_id, uint32_t waitMillis)
         }
     }
 #ifdef GPS_DEBUG
-    LOG_DEBUG(debugmsg.c_str());
+    LOG_DEBUG("%s", debugmsg.c_str());
     LOG_WARN("No response for class %02X message %02X", class_id, msg_id);
 #endif
     return GNSS_RESPONSE_NONE; // No response received within timeout
@@ -1409,7 +1409,7 @@ GnssModel_t GPS::getProbeResponse(unsigned long timeout, const std::vector<ChipI
 
             if (c == ',' || (responseLen >= 2 && response[responseLen - 2] == '\r' && response[responseLen - 1] == '\n')) {
 #ifdef GPS_DEBUG
-                LOG_DEBUG(response);
+                LOG_DEBUG("%s", response);
 #endif
                 // check if we can see our chips
                 for (const auto &chipInfo : responseMap) {
@@ -1428,7 +1428,7 @@ GnssModel_t GPS::getProbeResponse(unsigned long timeout, const std::vector<ChipI
         }
     }
 #ifdef GPS_DEBUG
-    LOG_DEBUG(response);
+    LOG_DEBUG("%s", response);
 #endif
     delete[] response;         // Cleanup before return
     return GNSS_MODEL_UNKNOWN; // Return unknown on timeout
@@ -1501,6 +1501,11 @@ GPS *GPS::createGps()
     gsapdop.begin(reader, NMEA_MSG_GXGSA, 15);
     LOG_DEBUG("Use " NMEA_MSG_GXGSA " for 3DFIX and PDOP");
 #endif
+    // Everything TinyGPS++ reads, the rest is skipped before it gets there
+    new_gps->nmea.want("RMC");
+    new_gps->nmea.want("GGA");
+    new_gps->nmea.want("GSA");
+    new_gps->nmea.watch("TXT"); // For the reboot banner
 
     // Make sure the GPS is awake before performing any init.
     new_gps->up();
@@ -1592,13 +1597,12 @@ bool GPS::lookForLocation()
     // At a minimum, use the fixQuality indicator in GPGGA (FIXME?)
     fixQual = reader.fixQuality();
 
-#ifndef TINYGPS_OPTION_NO_STATISTICS
-    if (reader.failedChecksum() > lastChecksumFailCount) {
-        LOG_WARN("%u new GPS checksum failures, for a total of %u", reader.failedChecksum() - lastChecksumFailCount,
-                 reader.failedChecksum());
-        lastChecksumFailCount = reader.failedChecksum();
+    uint32_t garbled = nmea.getGarbled() + nmea.getOverruns();
+    if (garbled > lastGarbledCount) {
+        LOG_WARN("%u new garbled GPS sentences, for a total of %u (%u complete, %u skipped, %u bytes dropped)",
+                 garbled - lastGarbledCount, garbled, nmea.getSentences(), nmea.getSkipped(), nmea.getDropped());
+        lastGarbledCount = garbled;
     }
-#endif
 
 #ifndef TINYGPS_OPTION_NO_CUSTOM_FIELDS
     fixType = atoi(gsafixtype.value()); // will set to zero if no data
@@ -1730,12 +1734,28 @@ bool GPS::hasLock()
 
 bool GPS::hasFlow()
 {
-    return reader.passedChecksum() > 0;
+    return nmea.getSentences() > 0;
 }
 
+namespace
+{
+/// Where NMEASentenceFilter delivers sentences
+struct GPSReaderSink {
+    TinyGPSPlus &reader;
+    int &rebootsSeen;
+
+    bool encode(char c) { return reader.encode(c); }
+
+    void sentence(const char *s, size_t len)
+    {
+        if (strnstr(s, "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", len))
+            rebootsSeen++;
+    }
+};
+} // namespace
+
 bool GPS::whileActive()
 {
-    unsigned int charsInBuf = 0;
     bool isValid = false;
 #ifdef GPS_DEBUG
     std::string debugmsg = "";
@@ -1747,29 +1767,33 @@ bool GPS::whileActive()
 #ifdef SERIAL_BUFFER_SIZE
     if (_serial_gps->available() >= SERIAL_BUFFER_SIZE - 1) {
         LOG_WARN("GPS Buffer full with %u bytes waiting. Flush to avoid corruption", _serial_gps->available());
+        nmea.countDropped(_serial_gps->available());
         clearBuffer();
+        nmea.reset();
     }
 #endif
-    // First consume any chars that have piled up at the receiver
-    while (_serial_gps->available() > 0) {
-        int c = _serial_gps->read();
-        UBXscratch[charsInBuf] = c;
+    // First consume any chars that have piled up at the receiver, in chunks rather than a byte per call
+    uint8_t chunk[64];
+    int waiting;
+    GPSReaderSink sink = {reader, rebootsSeen};
+    while ((waiting = _serial_gps->available()) > 0) {
+        size_t wanted = std::min((size_t)waiting, sizeof(chunk));
+#ifdef ARCH_ESP32
+        size_t got = _serial_gps->read(chunk, wanted);
+#else
+        size_t got = _serial_gps->readBytes(chunk, wanted);
+#endif
+        if (!got)
+            break;
 #ifdef GPS_DEBUG
-        debugmsg += vformat("%c", (c >= 32 && c <= 126) ? c : '.');
+        for (size_t i = 0; i < got; i++)
+            debugmsg += vformat("%c", (chunk[i] >= 32 && chunk[i] <= 126) ? chunk[i] : '.');
 #endif
-        isValid |= reader.encode(c);
-        if (charsInBuf > sizeof(UBXscratch) - 10 || c == '\r') {
-            if (strnstr((char *)UBXscratch, "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", charsInBuf)) {
-                rebootsSeen++;
-            }
-            charsInBuf = 0;
-        } else {
-            charsInBuf++;
-        }
+        isValid |= nmea.feed(chunk, got, sink);
     }
 #ifdef GPS_DEBUG
     if (debugmsg != "") {
-        LOG_DEBUG(debugmsg.c_str());
+        LOG_DEBUG("%s", debugmsg.c_str());
     }
 #endif
     return isValid;
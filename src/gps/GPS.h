@@ -4,6 +4,7 @@
 
 #include "GPSStatus.h"
 #include "GpioLogic.h"
+#include "NMEASentenceFilter.h"
 #include "Observer.h"
 #include "TinyGPS++.h"
 #include "concurrency/OSThread.h"
@@ -149,8 +150,9 @@ class GPS : private concurrency::OSThread
     GnssModel_t gnssModel = GNSS_MODEL_UNKNOWN;
 
     TinyGPSPlus reader;
-    uint8_t fixQual = 0; // fix quality from GPGGA
-    uint32_t lastChecksumFailCount = 0;
+    NMEASentenceFilter nmea; // Feeds reader with only the sentences it uses
+    uint8_t fixQual = 0;     // fix quality from GPGGA
+    uint32_t lastGarbledCount = 0;
 
 #ifndef TINYGPS_OPTION_NO_CUSTOM_FIELDS
     // (20210908) TinyGps++ can only read the GPGSA "FIX TYPE" field
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Splits the raw GPS byte stream into NMEA sentences and hands only the ones we use to TinyGPSPlus.
+ *
+ * A modern receiver at 10 Hz sends GSV, GLL, VTG and TXT sentences along with the RMC/GGA/GSA we actually read, often more
+ * than half of the bytes on the wire. TinyGPSPlus tokenizes every character it is given, so those used to cost as much as
+ * the useful ones. Here the type is read from the "$GPRMC" header of each sentence. A wanted sentence then streams straight
+ * into the parser as it arrives, which checks its checksum as it always did. Any other is skipped to its end without being
+ * copied or tokenized. Anything outside a sentence (UBX binary replies, line noise) is dropped on the way.
+ *
+ * The Sink needs `bool encode(char)` (the TinyGPSPlus signature) and `void sentence(const char *, size_t)`, which is given
+ * each sentence of a watched type with a good checksum, e.g. to spot receiver reboot banners.
+ */
+class NMEASentenceFilter
+{
+  public:
+    static const size_t MAX_SENTENCE = 96; // NMEA 0183 caps sentences at 82 characters, leave room for proprietary ones
+    static const uint8_t MAX_TYPES = 8;
+
+    /// Pass sentences of this type ("RMC", "GGA"...) from any talker to the sink's encode()
+    void want(const char *type) { addType(type, wanted, numWanted); }
+
+    /// Collect sentences of this type and hand them to the sink's sentence()
+    void watch(const char *type) { addType(type, watched, numWatched); }
+
+    /**
+     * Consume a chunk of received bytes.
+     *
+     * @return true if the sink reported a completed update for any sentence in it, like TinyGPSPlus::encode()
+     */
+    template <typename Sink> bool feed(const uint8_t *data, size_t len, Sink &sink)
+    {
+        bool updated = false;
+        const uint8_t *end = data + len;
+        while (data < end) {
+            if (state == IDLE) {
+                // Between sentences, skip straight to the next start
+                data = (const uint8_t *)memchr(data, '$', end - data);
+                if (!data)
+                    break;
+                data++;
+                start();
+                continue;
+            }
+            if (state == SKIP) {
+                const uint8_t *from = data;
+                while (data < end && *data != '\r' && *data != '\n' && *data != '$')
+                    data++;
+                length += data - from;
+                if (data == end)
+                    break;
+                if (*data++ == '$') {
+                    garbled++; // A new sentence started before the last one ended
+                    start();
+                } else {
+                    if (length > MAX_SENTENCE)
+                        overruns++;
+                    else
+                        skipped++;
+                    state = IDLE;
+                }
+                continue;
+            }
+
+            // The header, then the rest of a wanted or watched sentence: keep it, folding the checksum as we go
+            size_t limit = state == HEADER ? HEADER_LENGTH : MAX_SENTENCE;
+            const uint8_t *from = data;
+            while (data < end && length < limit && *data > '*' && *data != '$') {
+                parity ^= *data;
+                buffer[length++] = (char)*data++;
+            }
+            if (state == PASS) {
+                for (; from < data; from++)
+                    updated |= sink.encode((char)*from);
+            }
+            if (state == HEADER && length == HEADER_LENGTH) {
+                decide(sink);
+                continue;
+            }
+            if (data == end)
+                break;
+            char c = (char)*data++;
+            if (c == '$') {
+                garbled++;
+                start();
+            } else if (c == '\r' || c == '\n') {
+                updated |= finish(sink);
+                state = IDLE;
+            } else if (length >= limit) {
+                // Only a full buffer gets here, a header is decided on above as soon as it is complete
+                overruns++;
+                state = IDLE;
+            } else {
+                if (c == '*') {
+                    star = length;
+                    starParity = parity;
+                } else {
+                    parity ^= (uint8_t)c;
+                }
+                buffer[length++] = c;
+                if (state == PASS)
+                    updated |= sink.encode(c);
+            }
+        }
+        return updated;
+    }
+
+    /// Drop a partly received sentence, e.g. after the receive buffer was flushed
+    void reset() { state = IDLE; }
+
+    /// Bytes thrown away before they reached us, counted with the rest of the statistics
+    void countDropped(size_t bytes) { dropped += bytes; }
+
+    uint32_t getSentences() const { return passed + skipped; } // Complete ones, wanted or not
+    uint32_t getPassed() const { return passed; }               // Wanted, with a good checksum
+    uint32_t getSkipped() const { return skipped; }             // Not wanted, their checksum is not looked at
+    uint32_t getGarbled() const { return garbled; }             // Bad checksum, no checksum, or cut short
+    uint32_t getOverruns() const { return overruns; }
+    uint32_t getDropped() const { return dropped; }
+
+  private:
+    enum State : uint8_t {
+        IDLE,   // Looking for a '$'
+        HEADER, // Reading the talker and type
+        PASS,   // Wanted, each byte goes on to the sink
+        WATCH,  // Watched, kept whole for sentence()
+        SKIP,   // Neither, looking for its end
+    };
+
+    static const size_t HEADER_LENGTH = 6; // "$GPRMC": the '$', two talker characters, then the type
+
+    char buffer[MAX_SENTENCE];
+    size_t length = 0;
+    State state = IDLE;
+    char wanted[MAX_TYPES][3], watched[MAX_TYPES][3];
+    uint8_t numWanted = 0, numWatched = 0;
+    uint8_t parity = 0;     // XOR of everything after the '$' so far
+    size_t star = 0;        // Position of the last '*', 0 if none yet
+    uint8_t starParity = 0; // Value of parity at that point, what the checksum covers
+    uint32_t passed = 0, skipped = 0, garbled = 0, overruns = 0, dropped = 0;
+
+    static void addType(const char *type, char (*types)[3], uint8_t &count)
+    {
+        if (count < MAX_TYPES && strlen(type) == 3)
+            memcpy(types[count++], type, 3);
+    }
+
+    static bool hasType(const char *header, const char (*types)[3], uint8_t count)
+    {
+        for (uint8_t i = 0; i < count; i++) {
+            if (memcmp(header + 3, types[i], 3) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    bool checksumOk() const
+    {
+        if (!star || star != length - 3)
+            return false;
+        int hi = hexValue(buffer[length - 2]), lo = hexValue(buffer[length - 1]);
+        return hi >= 0 && lo >= 0 && starParity == (hi << 4 | lo);
+    }
+
+    void start()
+    {
+        buffer[0] = '$';
+        length = 1;
+        parity = 0;
+        star = 0;
+        state = HEADER;
+    }
+
+    template <typename Sink> void decide(Sink &sink)
+    {
+        if (hasType(buffer, wanted, numWanted)) {
+            state = PASS;
+            for (size_t i = 0; i < HEADER_LENGTH; i++)
+                sink.encode(buffer[i]);
+        } else {
+            state = hasType(buffer, watched, numWatched) ? WATCH : SKIP;
+        }
+    }
+
+    template <typename Sink> bool finish(Sink &sink)
+    {
+        if (state == HEADER) {
+            garbled++; // Ended before it said what it was
+            return false;
+        }
+        bool good = checksumOk();
+        if (!good)
+            garbled++;
+        if (state == WATCH) {
+            if (good) {
+                skipped++;
+                sink.sentence(buffer, length);
+            }
+            return false;
+        }
+        // PASS: the parser has had the rest already, and does its own checksum check
+        if (good)
+            passed++;
+        bool updated = sink.encode('\r');
+        updated |= sink.encode('\n');
+        return updated;
+    }
+};
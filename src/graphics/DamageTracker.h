@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace graphics
+{
+
+/**
+ * Finds the parts of an OLEDDisplay frame buffer that changed since it was last sent to the panel.
+ *
+ * The buffer is page ordered: each byte holds 8 vertically stacked pixels, and a page is one row of such bytes across the
+ * display. The screen is split into tiles TILE_WIDTH columns wide and one page high. diff() compares the new frame with the
+ * copy of what is on the panel a machine word at a time (4 or 8 columns of 8 pixels per compare on 32/64 bit targets) and
+ * marks the tiles that differ, so the caller only has to look at, push and copy back those tiles.
+ *
+ * Tiles can also be invalidated, for when the panel no longer shows what the copy says, e.g. after its power was cut. Those
+ * are reported as forced as well as dirty, and are to be pushed whole, not just where the two buffers differ.
+ */
+class DamageTracker
+{
+  public:
+    static const uint16_t TILE_WIDTH = 32;
+    static const uint16_t MAX_TILES = 32; ///< per page, one bit each, i.e. up to 1024 pixels wide
+
+    void begin(uint16_t _width, uint16_t _height)
+    {
+        width = _width;
+        pages = (_height + 7) / 8;
+        tilesPerPage = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+        if (tilesPerPage > MAX_TILES)
+            tilesPerPage = MAX_TILES;
+        dirty.assign(pages, 0);
+        forced.assign(pages, 0);
+        dirtyCount = 0;
+    }
+
+    /// Mark the tiles touching the given rectangle to be pushed whole on the next frame
+    void invalidate(int16_t x, int16_t y, int16_t w, int16_t h)
+    {
+        if (x < 0) {
+            w += x;
+            x = 0;
+        }
+        if (y < 0) {
+            h += y;
+            y = 0;
+        }
+        if (w <= 0 || h <= 0 || x >= width || y >= pages * 8)
+            return;
+        uint16_t firstTile = x / TILE_WIDTH;
+        uint16_t lastTile = (x + w - 1) / TILE_WIDTH;
+        if (lastTile >= tilesPerPage)
+            lastTile = tilesPerPage - 1;
+        uint16_t lastPage = (y + h - 1) / 8;
+        if (lastPage >= pages)
+            lastPage = pages - 1;
+        for (uint16_t page = y / 8; page <= lastPage; page++) {
+            for (uint16_t tile = firstTile; tile <= lastTile; tile++) {
+                mark(page, tile);
+                forced[page] |= 1UL << tile;
+            }
+        }
+    }
+
+    /// The whole panel has to be resent
+    void invalidateAll() { invalidate(0, 0, width, pages * 8); }
+
+    /**
+     * Compare a frame against what the panel shows and mark the tiles that differ.
+     *
+     * @return number of dirty tiles, including invalidated ones and ones marked by an earlier diff() since clear()
+     */
+    uint32_t diff(const uint8_t *frame, const uint8_t *panel)
+    {
+        for (uint16_t page = 0; page < pages; page++) {
+            size_t pageStart = (size_t)page * width;
+            for (uint16_t tile = 0; tile < tilesPerPage; tile++) {
+                if (isTileDirty(page, tile))
+                    continue;
+                size_t start = pageStart + (size_t)tile * TILE_WIDTH;
+                size_t end = tile + 1 == tilesPerPage ? pageStart + width : start + TILE_WIDTH;
+                if (!sameBytes(frame + start, panel + start, end - start))
+                    mark(page, tile);
+            }
+        }
+        return dirtyCount;
+    }
+
+    /// Bitmask of dirty tiles in a page, bit n is the tile starting at column n * TILE_WIDTH
+    uint32_t pageTiles(uint16_t page) const { return dirty[page]; }
+
+    bool isTileDirty(uint16_t page, uint16_t tile) const { return dirty[page] & (1UL << tile); }
+
+    /// Bitmask of the invalidated tiles in a page, a subset of pageTiles()
+    uint32_t forcedTiles(uint16_t page) const { return forced[page]; }
+
+    bool isDirty() const { return dirtyCount != 0; }
+
+    uint16_t getPages() const { return pages; }
+
+    /// First column and one past the last column of a tile
+    uint16_t tileStart(uint16_t tile) const { return tile * TILE_WIDTH; }
+    uint16_t tileEnd(uint16_t tile) const { return tile + 1 == tilesPerPage ? width : (tile + 1) * TILE_WIDTH; }
+
+    /// Forget all damage, once the dirty tiles have been sent
+    void clear()
+    {
+        if (dirtyCount) {
+            memset(dirty.data(), 0, dirty.size() * sizeof(dirty[0]));
+            memset(forced.data(), 0, forced.size() * sizeof(forced[0]));
+        }
+        dirtyCount = 0;
+    }
+
+    /**
+     * Whether two byte ranges are equal, compared a word at a time.
+     *
+     * memcpy() keeps the word loads legal on targets that trap on unaligned access, the compiler turns it into a single load
+     * where that is allowed.
+     */
+    static bool sameBytes(const uint8_t *a, const uint8_t *b, size_t len)
+    {
+        size_t i = 0;
+        for (; i + sizeof(size_t) <= len; i += sizeof(size_t)) {
+            size_t wa, wb;
+            memcpy(&wa, a + i, sizeof(wa));
+            memcpy(&wb, b + i, sizeof(wb));
+            if (wa != wb)
+                return false;
+        }
+        for (; i < len; i++) {
+            if (a[i] != b[i])
+                return false;
+        }
+        return true;
+    }
+
+  private:
+    std::vector<uint32_t> dirty;  // One bitmask of tiles per page
+    std::vector<uint32_t> forced; // Of those, the invalidated ones
+    uint16_t width = 0;
+    uint16_t pages = 0;
+    uint16_t tilesPerPage = 0;
+    uint32_t dirtyCount = 0;
+
+    void mark(uint16_t page, uint16_t tile)
+    {
+        uint32_t bit = 1UL << tile;
+        if (!(dirty[page] & bit)) {
+            dirty[page] |= bit;
+            dirtyCount++;
+        }
+    }
+};
+
+} // namespace graphics
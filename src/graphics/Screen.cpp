@@ -834,7 +834,7 @@ int32_t Screen::runOnce()
 
     // this must be before the frameState == FIXED check, because we always
     // want to draw at least one FIXED frame before doing forceDisplay
-    ui->update();
+    updateAndMeasure();
 
     // Switch to a low framerate (to save CPU) when we are not in transition
     // but we should only call setTargetFPS when framestate changes, because
@@ -875,6 +875,30 @@ int32_t Screen::runOnce()
     return (1000 / targetFramerate);
 }
 
+void Screen::updateAndMeasure()
+{
+    // OLEDDisplayUi only draws when its frame interval has passed, lastUpdate tells whether it did
+    uint32_t lastUpdate = ui->getUiState()->lastUpdate;
+    uint32_t start = micros();
+    ui->update();
+    if (ui->getUiState()->lastUpdate != lastUpdate) {
+        framesThisSecond++;
+        drawUsThisSecond += micros() - start;
+    }
+
+    uint32_t now = millis();
+    if (now - frameStatsSince >= 1000) {
+        uint32_t elapsedMs = now - frameStatsSince;
+        frameStats.fps = framesThisSecond * 1000 / elapsedMs;
+        frameStats.usPerFrame = framesThisSecond ? drawUsThisSecond / framesThisSecond : 0;
+        uint32_t cpuPercent = drawUsThisSecond / 10 / elapsedMs;
+        frameStats.cpuPercent = cpuPercent > 100 ? 100 : cpuPercent;
+        frameStatsSince = now;
+        framesThisSecond = 0;
+        drawUsThisSecond = 0;
+    }
+}
+
 /* show a message that the SSL cert is being built
  * it is expected that this will be used during the boot phase */
 void Screen::setSSLFrames()
@@ -1423,6 +1447,8 @@ int Screen::handleStatusUpdate(const meshtastic::Status *arg)
     // LOG_DEBUG("Screen got status update %d", arg->getStatusType());
     switch (arg->getStatusType()) {
     case STATUS_TYPE_NODE:
+        // NodeDB points at the node it just changed, if any
+        NodeListRenderer::onNodeChanged(nodeDB->updateGUIforNode);
         if (showingNormalScreen && nodeStatus->getLastNumTotal() != nodeStatus->getNumTotal()) {
             setFrames(FOCUS_PRESERVE); // Regen the list of screen frames (returning to same frame, if possible)
         }
@@ -268,6 +268,14 @@ class Screen : public concurrency::OSThread
 
     void blink();
 
+    /// Drawing cost over the last full second, shown on the System frame
+    struct FrameStats {
+        uint16_t fps = 0;        // Frames rendered and pushed to the panel
+        uint32_t usPerFrame = 0; // Average time per frame
+        uint8_t cpuPercent = 0;  // Share of the second spent drawing
+    };
+    const FrameStats &getFrameStats() const { return frameStats; }
+
     // Draw north
     float estimatedHeading(double lat, double lon);
 
@@ -725,6 +733,14 @@ class Screen : public concurrency::OSThread
     /// Holds state for debug information
     DebugInfo debugInfo;
 
+    FrameStats frameStats;
+    uint32_t frameStatsSince = 0; // millis() the current measurement second started
+    uint16_t framesThisSecond = 0;
+    uint32_t drawUsThisSecond = 0;
+
+    /// Run ui->update() and account for the time it took, if it actually drew a frame
+    void updateAndMeasure();
+
     /// Display device
     OLEDDisplay *dispdev;
 
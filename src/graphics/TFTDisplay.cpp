@@ -1140,99 +1140,82 @@ TFTDisplay::~TFTDisplay()
 // Write the buffer to the display memory
 void TFTDisplay::display(bool fromBlank)
 {
-    if (fromBlank)
+    if (fromBlank) {
         tft->fillScreen(TFT_BLACK);
+        // The panel is black now, diff against that rather than against the last frame
+        memset(buffer_back, 0, displayBufferSize);
+    }
 
     concurrency::LockGuard g(spiLock);
 
-    uint32_t x, y;
-    uint32_t y_byteIndex;
-    uint8_t y_byteMask;
-    uint32_t x_FirstPixelUpdate;
-    uint32_t x_LastPixelUpdate;
-    bool isset, dblbuf_isset;
+    // Step 1: Find the tiles (32 columns by 8 rows) that changed, comparing a machine word of both buffers at a time.
+    // Most frames only change a clock or a counter, everything else is skipped from here on.
+    if (damage.getPages() == 0)
+        damage.begin(displayWidth, displayHeight);
+    if (!damage.diff(buffer, buffer_back))
+        return;
+
     uint16_t colorTftMesh, colorTftBlack;
-    bool somethingChanged = false;
 
     // Store colors byte-reversed so that TFT_eSPI doesn't have to swap bytes in a separate step
     colorTftMesh = (TFT_MESH >> 8) | ((TFT_MESH & 0xFF) << 8);
     colorTftBlack = (TFT_BLACK >> 8) | ((TFT_BLACK & 0xFF) << 8);
 
-    y = 0;
-    while (y < displayHeight) {
-        y_byteIndex = (y / 8) * displayWidth;
-        y_byteMask = (1 << (y & 7));
-
-        // Step 1: Do a quick scan of 8 rows together. This allows fast-forwarding over unchanged screen areas.
-        if (y_byteMask == 1) {
-            if (!fromBlank) {
-                for (x = 0; x < displayWidth; x++) {
-                    if (buffer[x + y_byteIndex] != buffer_back[x + y_byteIndex])
-                        break;
-                }
-            } else {
-                for (x = 0; x < displayWidth; x++) {
-                    if (buffer[x + y_byteIndex] != 0)
-                        break;
-                }
-            }
-            if (x >= displayWidth) {
-                // No changed pixels found in these 8 rows, fast-forward to the next 8
-                y = y + 8;
-                continue;
-            }
-        }
-
-        // Step 2: Scan each of the 8 rows individually. Find the first pixel in each row that needs updating
-        for (x_FirstPixelUpdate = 0; x_FirstPixelUpdate < displayWidth; x_FirstPixelUpdate++) {
-            isset = buffer[x_FirstPixelUpdate + y_byteIndex] & y_byteMask;
-
-            if (!fromBlank) {
-                // get src pixel in the page based ordering the OLED lib uses
-                dblbuf_isset = buffer_back[x_FirstPixelUpdate + y_byteIndex] & y_byteMask;
-                if (isset != dblbuf_isset) {
-                    break;
+    for (uint16_t page = 0; page < damage.getPages(); page++) {
+        uint32_t tiles = damage.pageTiles(page);
+        if (!tiles)
+            continue;
+        uint32_t forced = damage.forcedTiles(page);
+        uint32_t y_byteIndex = page * displayWidth;
+
+        for (uint32_t y = page * 8; y < page * 8 + 8 && y < displayHeight; y++) {
+            uint8_t y_byteMask = (1 << (y & 7));
+            uint32_t x_FirstPixelUpdate = displayWidth;
+            uint32_t x_LastPixelUpdate = 0;
+
+            // Step 2: Find the first and last pixel of this row that need updating, looking only inside dirty tiles.
+            // An invalidated tile goes whole, the panel may not show what the back buffer says.
+            for (uint16_t tile = 0; tile < graphics::DamageTracker::MAX_TILES && (tiles >> tile); tile++) {
+                if (!(tiles & (1UL << tile)))
+                    continue;
+                if (forced & (1UL << tile)) {
+                    if (damage.tileStart(tile) < x_FirstPixelUpdate)
+                        x_FirstPixelUpdate = damage.tileStart(tile);
+                    if (damage.tileEnd(tile) - 1U > x_LastPixelUpdate)
+                        x_LastPixelUpdate = damage.tileEnd(tile) - 1;
+                    continue;
                 }
-            } else if (isset) {
-                break;
-            }
-        }
-
-        // Did we find a pixel that needs updating on this row?
-        if (x_FirstPixelUpdate < displayWidth) {
-
-            // Quickly write out the first changed pixel (saves another array lookup)
-            linePixelBuffer[x_FirstPixelUpdate] = isset ? colorTftMesh : colorTftBlack;
-            x_LastPixelUpdate = x_FirstPixelUpdate;
-
-            // Step 3: copy all remaining pixels in this row into the pixel line buffer,
-            // while also recording the last pixel in the row that needs updating
-            for (x = x_FirstPixelUpdate + 1; x < displayWidth; x++) {
-                isset = buffer[x + y_byteIndex] & y_byteMask;
-                linePixelBuffer[x] = isset ? colorTftMesh : colorTftBlack;
-
-                if (!fromBlank) {
-                    dblbuf_isset = buffer_back[x + y_byteIndex] & y_byteMask;
-                    if (isset != dblbuf_isset) {
+                for (uint32_t x = damage.tileStart(tile); x < damage.tileEnd(tile); x++) {
+                    if ((buffer[x + y_byteIndex] ^ buffer_back[x + y_byteIndex]) & y_byteMask) {
+                        if (x < x_FirstPixelUpdate)
+                            x_FirstPixelUpdate = x;
                         x_LastPixelUpdate = x;
                     }
-                } else if (isset) {
-                    x_LastPixelUpdate = x;
                 }
             }
 
+            // Did we find a pixel that needs updating on this row?
+            if (x_FirstPixelUpdate >= displayWidth)
+                continue;
+
+            // Step 3: Copy the changed span of this row into the pixel line buffer
+            for (uint32_t x = x_FirstPixelUpdate; x <= x_LastPixelUpdate; x++)
+                linePixelBuffer[x] = (buffer[x + y_byteIndex] & y_byteMask) ? colorTftMesh : colorTftBlack;
+
             // Step 4: Send the changed pixels on this line to the screen as a single block transfer.
             // This function accepts pixel data MSB first so it can dump the memory straight out the SPI port.
             tft->pushRect(x_FirstPixelUpdate, y, (x_LastPixelUpdate - x_FirstPixelUpdate + 1), 1,
                           &linePixelBuffer[x_FirstPixelUpdate]);
+        }
 
-            somethingChanged = true;
+        // Copy the dirty tiles of this page to the Back Buffer
+        for (uint16_t tile = 0; tile < graphics::DamageTracker::MAX_TILES && (tiles >> tile); tile++) {
+            if (tiles & (1UL << tile))
+                memcpy(&buffer_back[y_byteIndex + damage.tileStart(tile)], &buffer[y_byteIndex + damage.tileStart(tile)],
+                       damage.tileEnd(tile) - damage.tileStart(tile));
         }
-        y++;
     }
-    // Copy the Buffer to the Back Buffer
-    if (somethingChanged)
-        memcpy(buffer_back, buffer, displayBufferSize);
+    damage.clear();
 }
 
 void TFTDisplay::sdlLoop()
@@ -1297,6 +1280,7 @@ void TFTDisplay::sendCommand(uint8_t com)
 
 #ifdef VTFT_CTRL
         digitalWrite(VTFT_CTRL, LOW);
+        damage.invalidateAll(); // The panel lost its memory with its power, resend all of the next frame
 #endif
 #ifdef UNPHONE
         unphone.backlight(true); // using unPhone library
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "DamageTracker.h"
 #include <GpioLogic.h>
 #include <OLEDDisplay.h>
 
@@ -7,7 +8,6 @@
  * An adapter class that allows using the LovyanGFX library as if it was an OLEDDisplay implementation.
  *
  * Remaining TODO:
- * optimize display() to only draw changed pixels (see other OLED subclasses for examples)
  * Use the fast NRF52 SPI API rather than the slow standard arduino version
  *
  * turn radio back on - currently with both on spi bus is fucked? or are we leaving chip select asserted?
@@ -63,4 +63,7 @@ class TFTDisplay : public OLEDDisplay
     virtual bool connect() override;
 
     uint16_t *linePixelBuffer = nullptr;
+
+    /// Tiles of buffer that differ from buffer_back (what the panel shows), only those are scanned and pushed
+    graphics::DamageTracker damage;
 };
\ No newline at end of file
@@ -662,6 +662,16 @@ void drawSystemScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t x
         nameX = (SCREEN_WIDTH - textWidth) / 2;
         display->drawString(nameX, getTextPositions(display)[line], uptimeStr);
     }
+    if (SCREEN_HEIGHT > 64 && line < 6) { // Drawing cost, to see what the screen takes from the radio and control loop
+        line += 1;
+        const Screen::FrameStats &stats = screen->getFrameStats();
+        char drawStr[32];
+        snprintf(drawStr, sizeof(drawStr), "Draw: %ufps %u.%ums %u%%", stats.fps, stats.usPerFrame / 1000,
+                 (stats.usPerFrame % 1000) / 100, stats.cpuPercent);
+        textWidth = display->getStringWidth(drawStr);
+        nameX = (SCREEN_WIDTH - textWidth) / 2;
+        display->drawString(nameX, getTextPositions(display)[line], drawStr);
+    }
 #endif
 }
 
@@ -0,0 +1,182 @@
+#include "NodeListCache.h"
+#include "gps/GeoCoord.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace graphics
+{
+
+static bool hasValidPosition(const meshtastic_NodeInfoLite &node)
+{
+    return node.has_position && (node.position.latitude_i != 0 || node.position.longitude_i != 0);
+}
+
+NodeListCache::Entry &NodeListCache::find(uint32_t num)
+{
+    size_t first = slotFor(num);
+    Entry *victim = &entries[first];
+    for (size_t i = 0; i < PROBE; i++) {
+        Entry &e = entries[(first + i) & (SLOTS - 1)];
+        if (e.num == num)
+            return e;
+        if (e.lastUsed < victim->lastUsed)
+            victim = &e;
+    }
+    return *victim;
+}
+
+const NodeListCache::Entry &NodeListCache::get(const meshtastic_NodeInfoLite &node, uint32_t secondsSinceSeen)
+{
+    Entry &e = find(node.num);
+    e.lastUsed = ++uses;
+    bool current = e.num == node.num && e.generation == generation;
+    if (current)
+        hits++;
+    else
+        misses++;
+
+    if (!current) {
+        e.num = node.num;
+        e.generation = generation;
+        e.lastHeardMinutes = UINT32_MAX;
+        e.geometryGeneration = 0;
+        formatName(node, e.name, sizeof(e.name));
+    }
+
+    uint32_t minutes = (secondsSinceSeen == 0 || secondsSinceSeen == UINT32_MAX) ? UINT32_MAX - 1 : secondsSinceSeen / 60;
+    if (e.lastHeardMinutes != minutes) {
+        e.lastHeardMinutes = minutes;
+        formatLastHeard(secondsSinceSeen, e.lastHeard, sizeof(e.lastHeard));
+    }
+
+    if (e.geometryGeneration != geometryGeneration || e.latitude_i != node.position.latitude_i ||
+        e.longitude_i != node.position.longitude_i)
+        updateGeometry(e, node);
+    return e;
+}
+
+void NodeListCache::invalidate(uint32_t num)
+{
+    Entry &e = find(num);
+    if (e.num == num)
+        e.generation = 0;
+}
+
+void NodeListCache::setOwnPosition(bool ourPositionValid, int32_t latitude_i, int32_t longitude_i)
+{
+    if (ourPositionValid == ownValid && ourPositionValid) {
+        // Small moves do not change what is shown, a GPS jittering around a fixed gateway should not thrash the cache
+        float moved = GeoCoord::latLongToMeter(ownLatitude_i * 1e-7, ownLongitude_i * 1e-7, latitude_i * 1e-7,
+                                               longitude_i * 1e-7);
+        if (moved <= OWN_MOVE_THRESHOLD_M)
+            return;
+    } else if (ourPositionValid == ownValid) {
+        return;
+    }
+    ownValid = ourPositionValid;
+    ownLatitude_i = latitude_i;
+    ownLongitude_i = longitude_i;
+    geometryGeneration++;
+}
+
+void NodeListCache::setImperial(bool _imperial)
+{
+    if (imperial != _imperial) {
+        imperial = _imperial;
+        geometryGeneration++;
+    }
+}
+
+void NodeListCache::updateGeometry(Entry &e, const meshtastic_NodeInfoLite &node)
+{
+    e.geometryGeneration = geometryGeneration;
+    e.latitude_i = node.position.latitude_i;
+    e.longitude_i = node.position.longitude_i;
+    e.hasGeometry = ownValid && hasValidPosition(node);
+    e.distance[0] = '\0';
+    if (!e.hasGeometry)
+        return;
+
+    double lat1 = ownLatitude_i * 1e-7;
+    double lon1 = ownLongitude_i * 1e-7;
+    double lat2 = node.position.latitude_i * 1e-7;
+    double lon2 = node.position.longitude_i * 1e-7;
+
+    double earthRadiusKm = 6371.0;
+    double dLat = GeoCoord::toRadians(lat2 - lat1);
+    double dLon = GeoCoord::toRadians(lon2 - lon1);
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(GeoCoord::toRadians(lat1)) * cos(GeoCoord::toRadians(lat2)) * sin(dLon / 2) * sin(dLon / 2);
+    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    formatDistance(earthRadiusKm * c, imperial, e.distance, sizeof(e.distance));
+    e.bearing = GeoCoord::bearing(lat1, lon1, lat2, lon2);
+}
+
+void NodeListCache::formatName(const meshtastic_NodeInfoLite &node, char *buf, size_t size)
+{
+    if (node.has_user && node.user.short_name[0] != '\0') {
+        bool valid = true;
+        for (const char *c = node.user.short_name; *c; c++) {
+            if ((uint8_t)*c < 32 || (uint8_t)*c > 126) {
+                valid = false;
+                break;
+            }
+        }
+        if (valid) {
+            strncpy(buf, node.user.short_name, size - 1);
+            buf[size - 1] = '\0';
+            return;
+        }
+    }
+    snprintf(buf, size, "(%04X)", (uint16_t)(node.num & 0xFFFF));
+}
+
+void NodeListCache::formatLastHeard(uint32_t seconds, char *buf, size_t size)
+{
+    if (seconds == 0 || seconds == UINT32_MAX) {
+        snprintf(buf, size, "?");
+        return;
+    }
+    uint32_t minutes = seconds / 60, hours = minutes / 60, days = hours / 24;
+    if (days > 365)
+        snprintf(buf, size, "?");
+    else
+        snprintf(buf, size, "%u%c", (unsigned)(days ? days : hours ? hours : minutes), days ? 'd' : hours ? 'h' : 'm');
+}
+
+void NodeListCache::formatDistance(double distanceKm, bool imperial, char *buf, size_t size)
+{
+    if (imperial) {
+        double miles = distanceKm * 0.621371;
+        if (miles < 0.1) {
+            int feet = (int)(miles * 5280);
+            if (feet < 1000)
+                snprintf(buf, size, "%dft", feet);
+            else
+                snprintf(buf, size, "¼mi"); // 4-char max
+        } else {
+            int roundedMiles = (int)(miles + 0.5);
+            if (roundedMiles < 1000)
+                snprintf(buf, size, "%dmi", roundedMiles);
+            else
+                snprintf(buf, size, "999"); // Max display cap
+        }
+    } else {
+        if (distanceKm < 1.0) {
+            int meters = (int)(distanceKm * 1000);
+            if (meters < 1000)
+                snprintf(buf, size, "%dm", meters);
+            else
+                snprintf(buf, size, "1k");
+        } else {
+            int km = (int)(distanceKm + 0.5);
+            if (km < 1000)
+                snprintf(buf, size, "%dk", km);
+            else
+                snprintf(buf, size, "999");
+        }
+    }
+}
+
+} // namespace graphics
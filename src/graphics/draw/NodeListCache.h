@@ -0,0 +1,92 @@
+#pragma once
+
+#include "mesh/generated/meshtastic/deviceonly.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace graphics
+{
+
+/**
+ * Display strings for the node list screens, kept between frames.
+ *
+ * The list is redrawn every frame (up to 30 times a second while sliding), and every visible row used to rebuild its name,
+ * its last heard text and, in the distance and bearing views, run the great circle math against our own position. With
+ * hundreds of nodes on a TFT that made paging stutter. Rows now look their node up here and only rebuild what is stale:
+ *
+ * - name and geometry when NodeDB reports the node changed (invalidate()), or its position differs from the cached one
+ * - distance and bearing for every node once our own position moved more than OWN_MOVE_THRESHOLD_M, or units changed
+ * - the last heard text when the number of minutes since the node was heard changes
+ *
+ * A node can live in any of PROBE slots after the one its number hashes to, so a lookup is a hash and a few compares. When all
+ * of them are taken the least recently used one is rebuilt.
+ */
+class NodeListCache
+{
+  public:
+    static const unsigned SLOT_BITS = 6;
+    static const size_t SLOTS = 1 << SLOT_BITS; // A couple of pages of rows on the largest screens
+    static const size_t PROBE = 4;
+    static const uint32_t OWN_MOVE_THRESHOLD_M = 20;
+
+    struct Entry {
+        uint32_t num;
+        uint32_t lastUsed;          // NodeListCache::uses at the last get(), for eviction
+        uint32_t generation;        // Matches NodeListCache::generation while name/geometry are current
+        uint32_t geometryGeneration; // Own position and units the distance/bearing were computed for
+        uint32_t lastHeardMinutes;  // Input of lastHeard
+        int32_t latitude_i;         // Node position the distance/bearing were computed for
+        int32_t longitude_i;
+        bool hasGeometry;
+        float bearing; // Radians from our position to the node, only valid with hasGeometry
+        char name[16];
+        char lastHeard[10];
+        char distance[10]; // Empty without hasGeometry
+    };
+
+    /**
+     * Cached strings for a node, rebuilding whatever is stale.
+     *
+     * @param secondsSinceSeen as returned by sinceLastSeen(), passed in so the cache does not depend on the clock
+     * @return valid until the next call
+     */
+    const Entry &get(const meshtastic_NodeInfoLite &node, uint32_t secondsSinceSeen);
+
+    /// NodeDB changed something about this node
+    void invalidate(uint32_t num);
+
+    /// NodeDB changed in a way that can touch any node
+    void invalidateAll() { generation++; }
+
+    /// Call once per frame before get(), ourPositionValid false if we have no fix
+    void setOwnPosition(bool ourPositionValid, int32_t latitude_i, int32_t longitude_i);
+
+    void setImperial(bool _imperial);
+
+    uint32_t getHits() const { return hits; }
+    uint32_t getMisses() const { return misses; }
+
+    /// Fallback "(ABCD)" name if the short name is missing or not printable
+    static void formatName(const meshtastic_NodeInfoLite &node, char *buf, size_t size);
+    static void formatLastHeard(uint32_t secondsSinceSeen, char *buf, size_t size);
+    static void formatDistance(double distanceKm, bool imperial, char *buf, size_t size);
+
+  private:
+    Entry entries[SLOTS] = {};
+    uint32_t generation = 1; // Entries start at 0, so every slot starts out stale
+    uint32_t geometryGeneration = 1;
+    bool ownValid = false;
+    int32_t ownLatitude_i = 0, ownLongitude_i = 0;
+    bool imperial = false;
+    uint32_t hits = 0, misses = 0;
+    uint32_t uses = 0;
+
+    static size_t slotFor(uint32_t num) { return (uint32_t)(num * 2654435761u) >> (32 - SLOT_BITS); } // Fibonacci hash
+
+    /// The slot holding num, or the one to evict for it
+    Entry &find(uint32_t num);
+
+    void updateGeometry(Entry &e, const meshtastic_NodeInfoLite &node);
+};
+
+} // namespace graphics
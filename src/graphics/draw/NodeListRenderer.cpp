@@ -2,9 +2,9 @@
 #if HAS_SCREEN
 #include "CompassRenderer.h"
 #include "NodeDB.h"
+#include "NodeListCache.h"
 #include "NodeListRenderer.h"
 #include "UIRenderer.h"
-#include "gps/GeoCoord.h"
 #include "gps/RTC.h" // for getTime() function
 #include "graphics/ScreenFonts.h"
 #include "graphics/SharedUIDisplay.h"
@@ -49,6 +49,22 @@ void drawScaledXBitmap16x16(int x, int y, int width, int height, const uint8_t *
 static NodeListMode currentMode = MODE_LAST_HEARD;
 static int scrollIndex = 0;
 
+// Names, last heard and distance/bearing strings of recently shown rows
+static NodeListCache nodeListCache;
+
+static const NodeListCache::Entry &cachedEntry(const meshtastic_NodeInfoLite *node)
+{
+    return nodeListCache.get(*node, sinceLastSeen(node));
+}
+
+void onNodeChanged(const meshtastic_NodeInfoLite *node)
+{
+    if (node)
+        nodeListCache.invalidate(node->num);
+    else
+        nodeListCache.invalidateAll();
+}
+
 // =============================
 // Utility Functions
 // =============================
@@ -56,25 +72,7 @@ static int scrollIndex = 0;
 const char *getSafeNodeName(meshtastic_NodeInfoLite *node)
 {
     static char nodeName[16] = "?";
-    if (node->has_user && strlen(node->user.short_name) > 0) {
-        bool valid = true;
-        const char *name = node->user.short_name;
-        for (size_t i = 0; i < strlen(name); i++) {
-            uint8_t c = (uint8_t)name[i];
-            if (c < 32 || c > 126) {
-                valid = false;
-                break;
-            }
-        }
-        if (valid) {
-            strncpy(nodeName, name, sizeof(nodeName) - 1);
-            nodeName[sizeof(nodeName) - 1] = '\0';
-        } else {
-            snprintf(nodeName, sizeof(nodeName), "(%04X)", (uint16_t)(node->num & 0xFFFF));
-        }
-    } else {
-        snprintf(nodeName, sizeof(nodeName), "(%04X)", (uint16_t)(node->num & 0xFFFF));
-    }
+    NodeListCache::formatName(*node, nodeName, sizeof(nodeName));
     return nodeName;
 }
 
@@ -141,22 +139,9 @@ void drawEntryLastHeard(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int
     bool isLeftCol = (x < SCREEN_WIDTH / 2);
     int timeOffset = (isHighResolution) ? (isLeftCol ? 7 : 10) : (isLeftCol ? 3 : 7);
 
-    const char *nodeName = getSafeNodeName(node);
-
-    char timeStr[10];
-    uint32_t seconds = sinceLastSeen(node);
-    if (seconds == 0 || seconds == UINT32_MAX) {
-        snprintf(timeStr, sizeof(timeStr), "?");
-    } else {
-        uint32_t minutes = seconds / 60, hours = minutes / 60, days = hours / 24;
-        snprintf(timeStr, sizeof(timeStr), (days > 365 ? "?" : "%d%c"),
-                 (days    ? days
-                  : hours ? hours
-                          : minutes),
-                 (days    ? 'd'
-                  : hours ? 'h'
-                          : 'm'));
-    }
+    const NodeListCache::Entry &entry = cachedEntry(node);
+    const char *nodeName = entry.name;
+    const char *timeStr = entry.lastHeard;
 
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(FONT_SMALL);
@@ -186,7 +171,7 @@ void drawEntryHopSignal(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int
 
     int barsXOffset = columnWidth - barsOffset;
 
-    const char *nodeName = getSafeNodeName(node);
+    const char *nodeName = cachedEntry(node).name;
 
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(FONT_SMALL);
@@ -230,56 +215,9 @@ void drawNodeDistance(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16
     bool isLeftCol = (x < SCREEN_WIDTH / 2);
     int nameMaxWidth = columnWidth - (isHighResolution ? (isLeftCol ? 25 : 28) : (isLeftCol ? 20 : 22));
 
-    const char *nodeName = getSafeNodeName(node);
-    char distStr[10] = "";
-
-    meshtastic_NodeInfoLite *ourNode = nodeDB->getMeshNode(nodeDB->getNodeNum());
-    if (nodeDB->hasValidPosition(ourNode) && nodeDB->hasValidPosition(node)) {
-        double lat1 = ourNode->position.latitude_i * 1e-7;
-        double lon1 = ourNode->position.longitude_i * 1e-7;
-        double lat2 = node->position.latitude_i * 1e-7;
-        double lon2 = node->position.longitude_i * 1e-7;
-
-        double earthRadiusKm = 6371.0;
-        double dLat = (lat2 - lat1) * DEG_TO_RAD;
-        double dLon = (lon2 - lon1) * DEG_TO_RAD;
-
-        double a =
-            sin(dLat / 2) * sin(dLat / 2) + cos(lat1 * DEG_TO_RAD) * cos(lat2 * DEG_TO_RAD) * sin(dLon / 2) * sin(dLon / 2);
-        double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-        double distanceKm = earthRadiusKm * c;
-
-        if (config.display.units == meshtastic_Config_DisplayConfig_DisplayUnits_IMPERIAL) {
-            double miles = distanceKm * 0.621371;
-            if (miles < 0.1) {
-                int feet = (int)(miles * 5280);
-                if (feet < 1000)
-                    snprintf(distStr, sizeof(distStr), "%dft", feet);
-                else
-                    snprintf(distStr, sizeof(distStr), "¼mi"); // 4-char max
-            } else {
-                int roundedMiles = (int)(miles + 0.5);
-                if (roundedMiles < 1000)
-                    snprintf(distStr, sizeof(distStr), "%dmi", roundedMiles);
-                else
-                    snprintf(distStr, sizeof(distStr), "999"); // Max display cap
-            }
-        } else {
-            if (distanceKm < 1.0) {
-                int meters = (int)(distanceKm * 1000);
-                if (meters < 1000)
-                    snprintf(distStr, sizeof(distStr), "%dm", meters);
-                else
-                    snprintf(distStr, sizeof(distStr), "1k");
-            } else {
-                int km = (int)(distanceKm + 0.5);
-                if (km < 1000)
-                    snprintf(distStr, sizeof(distStr), "%dk", km);
-                else
-                    snprintf(distStr, sizeof(distStr), "999");
-            }
-        }
-    }
+    const NodeListCache::Entry &entry = cachedEntry(node);
+    const char *nodeName = entry.name;
+    const char *distStr = entry.distance;
 
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(FONT_SMALL);
@@ -325,7 +263,7 @@ void drawEntryCompass(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16
     // Adjust max text width depending on column and screen width
     int nameMaxWidth = columnWidth - (isHighResolution ? (isLeftCol ? 25 : 28) : (isLeftCol ? 20 : 22));
 
-    const char *nodeName = getSafeNodeName(node);
+    const char *nodeName = cachedEntry(node).name;
 
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(FONT_SMALL);
@@ -342,7 +280,9 @@ void drawEntryCompass(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16
 void drawCompassArrow(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16_t x, int16_t y, int columnWidth, float myHeading,
                       double userLat, double userLon)
 {
-    if (!nodeDB->hasValidPosition(node))
+    // The cached bearing is from where we were after our last move over OWN_MOVE_THRESHOLD_M, close enough to userLat/userLon
+    const NodeListCache::Entry &entry = cachedEntry(node);
+    if (!entry.hasGeometry)
         return;
 
     bool isLeftCol = (x < SCREEN_WIDTH / 2);
@@ -351,10 +291,7 @@ void drawCompassArrow(OLEDDisplay *display, meshtastic_NodeInfoLite *node, int16
     int centerX = x + columnWidth - arrowXOffset;
     int centerY = y + FONT_HEIGHT_SMALL / 2;
 
-    double nodeLat = node->position.latitude_i * 1e-7;
-    double nodeLon = node->position.longitude_i * 1e-7;
-    float bearing = GeoCoord::bearing(userLat, userLon, nodeLat, nodeLon);
-    float bearingToNode = RAD_TO_DEG * bearing;
+    float bearingToNode = RAD_TO_DEG * entry.bearing;
     float relativeBearing = fmod((bearingToNode - myHeading + 360), 360);
     float angle = relativeBearing * DEG_TO_RAD;
     // Shrink size by 2px
@@ -419,6 +356,12 @@ void drawNodeListScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t
 #else
     int totalColumns = 2;
 #endif
+    meshtastic_NodeInfoLite *ourNode = nodeDB->getMeshNode(nodeDB->getNodeNum());
+    bool ourPositionValid = ourNode && nodeDB->hasValidPosition(ourNode);
+    nodeListCache.setOwnPosition(ourPositionValid, ourPositionValid ? ourNode->position.latitude_i : 0,
+                                 ourPositionValid ? ourNode->position.longitude_i : 0);
+    nodeListCache.setImperial(config.display.units == meshtastic_Config_DisplayConfig_DisplayUnits_IMPERIAL);
+
     int startIndex = scrollIndex * visibleNodeRows * totalColumns;
     if (nodeDB->getMeshNodeByIndex(startIndex)->num == nodeDB->getNodeNum()) {
         startIndex++; // skip own node
@@ -434,10 +377,11 @@ void drawNodeListScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t
     for (int i = startIndex; i < endIndex; ++i) {
         int xPos = x + (col * columnWidth);
         int yPos = y + yOffset;
-        renderer(display, nodeDB->getMeshNodeByIndex(i), xPos, yPos, columnWidth);
+        meshtastic_NodeInfoLite *node = nodeDB->getMeshNodeByIndex(i);
+        renderer(display, node, xPos, yPos, columnWidth);
 
         if (extras) {
-            extras(display, nodeDB->getMeshNodeByIndex(i), xPos, yPos, columnWidth, heading, lat, lon);
+            extras(display, node, xPos, yPos, columnWidth, heading, lat, lon);
         }
 
         lastNodeY = std::max(lastNodeY, yPos + FONT_HEIGHT_SMALL);
@@ -49,6 +49,9 @@ void drawDistanceScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t
 void drawDynamicNodeListScreen(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t x, int16_t y);
 void drawNodeListWithCompasses(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t x, int16_t y);
 
+// Drop cached strings of a node after NodeDB changed it, nullptr if any node may have changed
+void onNodeChanged(const meshtastic_NodeInfoLite *node);
+
 // Utility functions
 const char *getCurrentModeTitle(int screenWidth);
 const char *getSafeNodeName(meshtastic_NodeInfoLite *node);
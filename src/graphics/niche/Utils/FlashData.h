@@ -13,6 +13,7 @@ Avoid bloating everyone's protobuf code for our one-off UI implementations
 
 #include "configuration.h"
 
+#include "PrefsStore.h"
 #include "SPILock.h"
 #include "SafeFile.h"
 
@@ -44,12 +45,15 @@ template <typename T> class FlashData
         return hash;
     }
 
+    // Small enough for the firmware's record store? Kept there by filename, instead of in its own file
+    static bool useStore(const std::string &filename)
+    {
+        return sizeof(T) <= RecordStore::MAX_VALUE && filename.size() <= RecordStore::MAX_KEY && prefsStore();
+    }
+
   public:
     static bool load(T *data, const char *label)
     {
-        // Take firmware's SPI lock
-        concurrency::LockGuard guard(spiLock);
-
         // Set false if we run into issues
         bool okay = true;
 
@@ -57,6 +61,22 @@ template <typename T> class FlashData
         std::string filename = getFilename(label);
 
 #ifdef FSCom
+        // Without a record, the file left by firmware from before the record store is loaded. The next save moves it
+        // across.
+        if (useStore(filename) && prefsStore()->has(filename.c_str())) {
+            LOG_INFO("Loading NicheGraphics data '%s' from the record store", filename.c_str());
+            T flashData;
+            size_t length = 0;
+            if (!prefsStore()->get(filename.c_str(), (uint8_t *)&flashData, sizeof(T), &length) || length != sizeof(T)) {
+                LOG_WARN("'%s' is corrupt. Using default values", filename.c_str());
+                return false;
+            }
+            *data = flashData;
+            return true;
+        }
+
+        // Take firmware's SPI lock
+        concurrency::LockGuard guard(spiLock);
 
         // Check that the file *does* actually exist
         if (!FSCom.exists(filename.c_str())) {
@@ -116,6 +136,14 @@ template <typename T> class FlashData
         std::string filename = getFilename(label);
 
 #ifdef FSCom
+        if (useStore(filename)) {
+            // The store has its own checksum, and skips the write if nothing changed
+            // The file from older firmware stays, for going back to it
+            if (!prefsStore()->put(filename.c_str(), (uint8_t *)data, sizeof(T)))
+                LOG_ERROR("Can't write data!");
+            return;
+        }
+
         spiLock->lock();
         FSCom.mkdir("/NicheGraphics");
         spiLock->unlock();
@@ -146,6 +174,9 @@ template <typename T> class FlashData
 // Erase contents of the NicheGraphics data directory
 inline void clearFlashData()
 {
+    // Before taking the lock, the store takes it for itself
+    if (prefsStore())
+        prefsStore()->removePrefix("/NicheGraphics/");
 
     // Take firmware's SPI lock, in case the files are stored on SD card
     concurrency::LockGuard guard(spiLock);
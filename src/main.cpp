@@ -2,6 +2,7 @@
 #if !GATEMESH_EXCLUDE_GPS
 #include "GPS.h"
 #endif
+#include "AnalogSampler.h"
 #include "MeshRadio.h"
 #include "MeshService.h"
 #include "NodeDB.h"
@@ -571,6 +572,9 @@ void setup()
     digitalWrite(AQ_SET_PIN, HIGH);
 #endif
 
+    // Battery sense and analog sensors register their channels from here on
+    analogSampler = new AnalogSampler();
+
     // Currently only the tbeam has a PMU
     // PMU initialization needs to be placed before i2c scanning
     power = new Power();
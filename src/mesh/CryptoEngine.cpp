@@ -33,6 +33,7 @@ void CryptoEngine::generateKeyPair(uint8_t *pubKey, uint8_t *privKey)
 
     LOG_DEBUG("Generate Curve25519 keypair");
     Curve25519::dh1(public_key, private_key);
+    sharedKeys.clear();
     memcpy(pubKey, public_key, sizeof(public_key));
     memcpy(privKey, private_key, sizeof(private_key));
 }
@@ -54,6 +55,7 @@ bool CryptoEngine::regeneratePublicKey(uint8_t *pubKey, uint8_t *privKey)
         }
         memcpy(private_key, privKey, sizeof(private_key));
         memcpy(public_key, pubKey, sizeof(public_key));
+        sharedKeys.clear();
     } else {
         LOG_WARN("X25519 key generation failed due to blank private key");
         return false;
@@ -65,6 +67,7 @@ void CryptoEngine::clearKeys()
 {
     memset(public_key, 0, sizeof(public_key));
     memset(private_key, 0, sizeof(private_key));
+    sharedKeys.clear();
 }
 
 /**
@@ -92,10 +95,9 @@ bool CryptoEngine::encryptCurve25519(uint32_t toNode, uint32_t fromNode, meshtas
         LOG_DEBUG("Node %d or their public_key not found", toNode);
         return false;
     }
-    if (!crypto->setDHPublicKey(remotePublic.bytes)) {
+    if (!deriveSharedKey(remotePublic.bytes)) {
         return false;
     }
-    crypto->hash(shared_key, 32);
     initNonce(fromNode, packetNum, extraNonceTmp);
 
     // Calculate the shared secret with the destination node and encrypt
@@ -134,10 +136,9 @@ bool CryptoEngine::decryptCurve25519(uint32_t fromNode, meshtastic_UserLite_publ
     }
 
     // Calculate the shared secret with the sending node and decrypt
-    if (!crypto->setDHPublicKey(remotePublic.bytes)) {
+    if (!deriveSharedKey(remotePublic.bytes)) {
         return false;
     }
-    crypto->hash(shared_key, 32);
 
     initNonce(fromNode, packetNum, extraNonce);
     printBytes("Attempt decrypt with nonce: ", nonce, 13);
@@ -148,6 +149,29 @@ bool CryptoEngine::decryptCurve25519(uint32_t fromNode, meshtastic_UserLite_publ
 void CryptoEngine::setDHPrivateKey(uint8_t *_private_key)
 {
     memcpy(private_key, _private_key, 32);
+    sharedKeys.clear();
+}
+
+/**
+ * Derive the key for packets to or from a node, the SHA256 of our Curve25519 shared secret with it.
+ *
+ * The scalar multiplication takes tens of milliseconds on the smaller MCUs, so the result is kept for the last few nodes.
+ *
+ * @param remotePublic The remote node's Curve25519 public key.
+ */
+bool CryptoEngine::deriveSharedKey(const uint8_t *remotePublic)
+{
+    SharedKey *cached = sharedKeys.find(remotePublic, 32);
+    if (cached) {
+        memcpy(shared_key, cached->bytes, sizeof(shared_key));
+        return true;
+    }
+    if (!setDHPublicKey((uint8_t *)remotePublic)) {
+        return false;
+    }
+    hash(shared_key, 32);
+    memcpy(sharedKeys.insert(remotePublic, 32).bytes, shared_key, sizeof(shared_key));
+    return true;
 }
 
 /**
@@ -174,12 +198,19 @@ void CryptoEngine::hash(uint8_t *bytes, size_t numBytes)
 
 void CryptoEngine::aesSetKey(const uint8_t *key_bytes, size_t key_len)
 {
-    delete aes;
     aes = nullptr;
-    if (key_len != 0) {
-        aes = new AESSmall256();
-        aes->setKey(key_bytes, key_len);
+    if (key_len == 0)
+        return;
+    AES256 **cached = aesSchedules.find(key_bytes, key_len);
+    if (cached) {
+        aes = *cached;
+        return;
     }
+    AES256 *&schedule = aesSchedules.insert(key_bytes, key_len);
+    if (!schedule)
+        schedule = new AES256();
+    schedule->setKey(key_bytes, key_len);
+    aes = schedule;
 }
 
 void CryptoEngine::aesEncrypt(uint8_t *in, uint8_t *out)
@@ -204,6 +235,16 @@ bool CryptoEngine::setDHPublicKey(uint8_t *pubKey)
 #endif
 concurrency::Lock *cryptLock;
 
+CryptoEngine::~CryptoEngine()
+{
+    for (size_t i = 0; i < ctrSchedules.size(); i++)
+        delete ctrSchedules.at(i);
+#if !(MESHTASTIC_EXCLUDE_PKI)
+    for (size_t i = 0; i < aesSchedules.size(); i++)
+        delete aesSchedules.at(i);
+#endif
+}
+
 void CryptoEngine::setKey(const CryptoKey &k)
 {
     LOG_DEBUG("Use AES%d key!", k.length * 8);
@@ -236,21 +277,30 @@ void CryptoEngine::decrypt(uint32_t fromNode, uint64_t packetId, size_t numBytes
 // Generic implementation of AES-CTR encryption.
 void CryptoEngine::encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes)
 {
-    delete ctr;
-    ctr = nullptr;
-    if (_key.length == 16)
-        ctr = new CTR<AES128>();
-    else
-        ctr = new CTR<AES256>();
-    ctr->setKey(_key.bytes, _key.length);
-    static uint8_t scratch[MAX_BLOCKSIZE];
-    memcpy(scratch, bytes, numBytes);
-    memset(scratch + numBytes, 0,
-           sizeof(scratch) - numBytes); // Fill rest of buffer with zero (in case cypher looks at it)
+    CTRCommon *ctr;
+    CTRCommon **cached = ctrSchedules.find(_key.bytes, _key.length);
+    if (cached) {
+        ctr = *cached;
+    } else {
+        CTRCommon *&schedule = ctrSchedules.insert(_key.bytes, _key.length);
+        if (schedule && schedule->keySize() != (size_t)_key.length) {
+            delete schedule;
+            schedule = nullptr;
+        }
+        if (!schedule) {
+            if (_key.length == 16)
+                schedule = new CTR<AES128>();
+            else
+                schedule = new CTR<AES256>();
+        }
+        schedule->setKey(_key.bytes, _key.length);
+        ctr = schedule;
+    }
 
+    // Resets the counter, the key schedule stays. CTR only XORs the keystream in, so it can work in place.
     ctr->setIV(_nonce, 16);
     ctr->setCounterSize(4);
-    ctr->encrypt(bytes, scratch, numBytes);
+    ctr->encrypt(bytes, bytes, numBytes);
 }
 
 /**
@@ -1,6 +1,7 @@
 #pragma once
 #include "AES.h"
 #include "CTR.h"
+#include "KeyCache.h"
 #include "concurrency/LockGuard.h"
 #include "configuration.h"
 #include "mesh-pb-constants.h"
@@ -30,7 +31,7 @@ class CryptoEngine
     uint8_t public_key[32] = {0};
 #endif
 
-    virtual ~CryptoEngine() {}
+    virtual ~CryptoEngine();
 #if !(MESHTASTIC_EXCLUDE_PKI)
 #if !(MESHTASTIC_EXCLUDE_PKI_KEYGEN)
     virtual void generateKeyPair(uint8_t *pubKey, uint8_t *privKey);
@@ -49,7 +50,7 @@ class CryptoEngine
     virtual void aesSetKey(const uint8_t *key, size_t key_len);
 
     virtual void aesEncrypt(uint8_t *in, uint8_t *out);
-    AESSmall256 *aes = NULL;
+    AES256 *aes = NULL; // Owned by aesSchedules
 
 #endif
 
@@ -78,10 +79,24 @@ class CryptoEngine
     /** Our per packet nonce */
     uint8_t nonce[16] = {0};
     CryptoKey key = {};
-    CTRCommon *ctr = NULL;
+
+    /// Expanded channel keys, a CTR<AES128> or CTR<AES256> depending on the key
+    KeyCache<CTRCommon *, 4> ctrSchedules;
 #if !(MESHTASTIC_EXCLUDE_PKI)
     uint8_t shared_key[32] = {0};
     uint8_t private_key[32] = {0};
+
+    /// Expanded PKI shared keys for aes-ccm
+    KeyCache<AES256 *, 4> aesSchedules;
+
+    struct SharedKey {
+        uint8_t bytes[32];
+    };
+    /// Hashed Curve25519 shared secrets by remote public key, flushed whenever private_key changes
+    KeyCache<SharedKey, 8> sharedKeys;
+
+    /// Put the hashed shared secret with this remote public key in shared_key
+    bool deriveSharedKey(const uint8_t *remotePublic);
 #endif
     /**
      * Init our 128 bit nonce for a new packet
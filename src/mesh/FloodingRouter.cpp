@@ -1,3 +1,4 @@
+#define LOG_MODULE_LEVEL MESHTASTIC_LOG_MESH_LEVEL // Packet hot path, see DebugConfiguration.h
 #include "FloodingRouter.h"
 #include "MeshTypes.h"
 #include "NodeDB.h"
@@ -124,6 +125,7 @@ void FloodingRouter::perhapsRebroadcast(const meshtastic_MeshPacket *p)
         if (p->id != 0) {
             if (isRebroadcaster()) {
                 meshtastic_MeshPacket *tosend = packetPool.allocCopy(*p); // keep a copy because we will be sending it
+                tosend->rx_snr = rebroadcastSnr(p);
 
                 // Use shared logic to determine if hop_limit should be decremented
                 if (shouldDecrementHopLimit(p)) {
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * The last few encoded frames from one producer, read by any number of viewers that each keep their own cursor.
+ *
+ * Every web client used to poll the one PhoneAPI behind the web server, so a packet went to whichever browser asked first.
+ * Here a frame is copied in once and every viewer reads it at its own pace: a cursor is the sequence number of the next frame
+ * it wants. The producer never waits for anyone. A viewer that falls more than Slots frames behind skips to the oldest frame
+ * still held and is told how many it missed, so one slow browser costs the others nothing.
+ *
+ * Safe to use from several threads, viewers may block in wait() until the producer publishes.
+ */
+template <size_t Slots, size_t FrameBytes> class FrameBroadcast
+{
+    static_assert(Slots >= 2 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+  public:
+    /// Copy a frame in, overwriting the oldest one once every slot is used, and wake any waiting viewer
+    void publish(const uint8_t *bytes, size_t length)
+    {
+        if (length > FrameBytes)
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            Frame &frame = frames[head % Slots];
+            memcpy(frame.bytes, bytes, length);
+            frame.length = length;
+            head++;
+            if (held < Slots)
+                held++;
+        }
+        published.notify_all();
+    }
+
+    /**
+     * Copy out the frame at the cursor and move the cursor past it.
+     *
+     * A cursor older than the oldest frame held moves up to it first, and one ahead of anything this feed has handed out
+     * (e.g. from before a reboot) starts over from the oldest frame.
+     *
+     * @param out at least FrameBytes
+     * @param dropped set to the number of frames skipped to catch up
+     * @return the frame length, 0 if the viewer is up to date
+     */
+    size_t read(uint32_t &cursor, uint8_t *out, uint32_t &dropped)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        uint32_t first = oldestLocked();
+        dropped = 0;
+        if ((int32_t)(head - cursor) < 0) {
+            cursor = first;
+        } else if (head - cursor > held) {
+            dropped = first - cursor;
+            cursor = first;
+        }
+        if (cursor == head)
+            return 0;
+        const Frame &frame = frames[cursor % Slots];
+        memcpy(out, frame.bytes, frame.length);
+        cursor++;
+        return frame.length;
+    }
+
+    /// Block until there is a frame at the cursor, close() is called or timeoutMs passes. @return whether there is a frame
+    bool wait(uint32_t cursor, uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        published.wait_for(guard, std::chrono::milliseconds(timeoutMs), [&] { return closed || cursor != head; });
+        return !closed && cursor != head;
+    }
+
+    /// Where a viewer that only wants frames from now on starts
+    uint32_t next()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return head;
+    }
+
+    /// Where a viewer that wants everything still held starts
+    uint32_t oldest()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return oldestLocked();
+    }
+
+    /// Wake every waiting viewer and keep wait() from blocking again, e.g. before the web server stops
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        published.notify_all();
+    }
+
+    bool isClosed()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return closed;
+    }
+
+    /// A viewer looked at nowMs
+    void markViewed(uint32_t nowMs)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        lastViewedMs = nowMs;
+        viewed = true;
+    }
+
+    /// Whether a viewer looked in the timeoutMs before nowMs, so the producer can skip encoding frames nobody reads
+    bool isViewed(uint32_t nowMs, uint32_t timeoutMs)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return viewed && nowMs - lastViewedMs <= timeoutMs;
+    }
+
+  private:
+    struct Frame {
+        size_t length;
+        uint8_t bytes[FrameBytes];
+    };
+
+    Frame frames[Slots];
+    uint32_t head = 0; // Sequence number of the next frame published
+    uint32_t held = 0; // Frames in the slots, Slots once they have all been used
+    bool closed = false;
+    bool viewed = false;
+    uint32_t lastViewedMs = 0;
+    std::mutex lock;
+    std::condition_variable published;
+
+    uint32_t oldestLocked() const { return head - held; }
+};
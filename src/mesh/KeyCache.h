@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * A few values derived from secret keys (AES key schedules, PKI shared secrets), looked up by the key bytes.
+ *
+ * Every packet used to expand its channel key, or redo the Curve25519 agreement with its sender, from scratch. With a handful
+ * of channels and PKI peers in use, keeping the last few derivations makes that a memcmp for nearly every packet.
+ *
+ * Values stay in their slots when a key is evicted, so the caller can rekey a schedule in place instead of reallocating it.
+ * Callers hold cryptLock, like everything else in CryptoEngine.
+ */
+template <typename Value, size_t Slots, size_t KeyBytes = 32> class KeyCache
+{
+  public:
+    /// The value derived from this key, nullptr if it is not cached
+    Value *find(const uint8_t *key, size_t length)
+    {
+        for (size_t i = 0; i < Slots; i++) {
+            Slot &slot = slots[i];
+            if (slot.length && slot.length == length && memcmp(slot.key, key, length) == 0) {
+                slot.used = ++clock;
+                hits++;
+                return &slot.value;
+            }
+        }
+        misses++;
+        return nullptr;
+    }
+
+    /**
+     * Take the least recently used slot for a key find() did not have.
+     *
+     * @return the slot's value, still derived from whatever key it held before, for the caller to rederive
+     */
+    Value &insert(const uint8_t *key, size_t length)
+    {
+        Slot *oldest = &slots[0];
+        for (size_t i = 1; i < Slots; i++) {
+            if (slots[i].used < oldest->used)
+                oldest = &slots[i];
+        }
+        if (length > KeyBytes)
+            length = KeyBytes;
+        memcpy(oldest->key, key, length);
+        oldest->length = length;
+        oldest->used = ++clock;
+        return oldest->value;
+    }
+
+    /// Forget one key, e.g. when deriving from it failed after insert()
+    void remove(const uint8_t *key, size_t length)
+    {
+        for (size_t i = 0; i < Slots; i++) {
+            Slot &slot = slots[i];
+            if (slot.length && slot.length == length && memcmp(slot.key, key, length) == 0) {
+                memset(slot.key, 0, sizeof(slot.key));
+                slot.length = 0;
+                slot.used = 0;
+            }
+        }
+    }
+
+    /// Forget every key, e.g. when our private key changes. The values are left for reuse.
+    void clear()
+    {
+        for (size_t i = 0; i < Slots; i++) {
+            memset(slots[i].key, 0, sizeof(slots[i].key));
+            slots[i].length = 0;
+            slots[i].used = 0;
+        }
+    }
+
+    /// Every value, evicted or not, e.g. to free them
+    Value &at(size_t i) { return slots[i].value; }
+
+    static size_t size() { return Slots; }
+
+    uint32_t getHits() const { return hits; }
+    uint32_t getMisses() const { return misses; }
+
+  private:
+    struct Slot {
+        uint8_t key[KeyBytes] = {0};
+        uint8_t length = 0;
+        uint32_t used = 0;
+        Value value = {};
+    };
+
+    Slot slots[Slots];
+    uint32_t clock = 0, hits = 0, misses = 0;
+};
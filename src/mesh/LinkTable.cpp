@@ -0,0 +1,172 @@
+#include "LinkTable.h"
+
+LinkTable linkTable;
+
+static uint32_t ageMs(const LinkTable::Link &link, uint32_t nowMs)
+{
+    return nowMs - link.lastHeardMs; // Wraps correctly across the millis() rollover
+}
+
+LinkTable::Link &LinkTable::findOrAdd(uint32_t num, uint32_t nowMs)
+{
+    size_t first = slotFor(relayByte(num));
+    Link *victim = nullptr;
+    for (size_t i = 0; i < PROBE; i++) {
+        Link &link = links[(first + i) & (SLOTS - 1)];
+        if (link.num == num)
+            return link;
+        if (!link.num) {
+            if (!victim || victim->num)
+                victim = &link;
+        } else if (!victim || (victim->num && ageMs(link, nowMs) > ageMs(*victim, nowMs))) {
+            victim = &link;
+        }
+    }
+    if (victim->num)
+        evictions++;
+    *victim = Link();
+    victim->num = num;
+    victim->lastHeardMs = nowMs;
+    victim->pdr = 1;
+    return *victim;
+}
+
+const LinkTable::Link *LinkTable::find(uint32_t num) const
+{
+    if (!num)
+        return nullptr;
+    size_t first = slotFor(relayByte(num));
+    for (size_t i = 0; i < PROBE; i++) {
+        const Link &link = links[(first + i) & (SLOTS - 1)];
+        if (link.num == num)
+            return &link;
+        if (!link.num)
+            break; // Slots are only freed all at once, so nothing of ours lies past a free one
+    }
+    return nullptr;
+}
+
+const LinkTable::Link *LinkTable::findByRelay(uint8_t relayNode) const
+{
+    if (!relayNode)
+        return nullptr;
+    size_t first = slotFor(relayNode);
+    const Link *found = nullptr;
+    for (size_t i = 0; i < PROBE; i++) {
+        const Link &link = links[(first + i) & (SLOTS - 1)];
+        if (!link.num)
+            break;
+        // Two neighbors can share a last byte, then the one heard last is the better guess
+        if (relayByte(link.num) == relayNode &&
+            (!found || (int32_t)(link.lastHeardMs - found->lastHeardMs) > 0))
+            found = &link;
+    }
+    return found;
+}
+
+void LinkTable::sample(Link &link, float snr, int32_t rssi, uint32_t nowMs)
+{
+    if (!link.frames) {
+        link.snr = snr;
+        link.rssi = rssi;
+    } else {
+        link.snr += ALPHA * (snr - link.snr);
+        link.rssi += ALPHA * (rssi - link.rssi);
+    }
+    if (link.frames < UINT16_MAX)
+        link.frames++;
+    link.lastHeardMs = nowMs;
+}
+
+void LinkTable::deliveredSample(Link &link, bool ok)
+{
+    link.attempts = link.attempts * (1 - ALPHA) + 1;
+    link.successes = link.successes * (1 - ALPHA) + ok;
+    link.pdr = link.successes / link.attempts;
+    if (link.deliveries < UINT8_MAX)
+        link.deliveries++;
+}
+
+const LinkTable::Link *LinkTable::heard(uint32_t from, uint8_t relayNode, bool direct, float snr, int32_t rssi,
+                                        uint32_t nowMs)
+{
+    if (!direct) {
+        Link *link = const_cast<Link *>(findByRelay(relayNode));
+        if (link)
+            sample(*link, snr, rssi, nowMs);
+        return link;
+    }
+    if (!from)
+        return nullptr;
+
+    Link &link = findOrAdd(from, nowMs);
+    sample(link, snr, rssi, nowMs);
+    return &link;
+}
+
+void LinkTable::delivered(uint8_t relayNode, bool ok)
+{
+    Link *link = const_cast<Link *>(findByRelay(relayNode));
+    if (link)
+        deliveredSample(*link, ok);
+}
+
+bool LinkTable::isUsable(const Link &link, uint32_t nowMs)
+{
+    if (ageMs(link, nowMs) > STALE_MS)
+        return false;
+    return link.deliveries < MIN_SAMPLES || link.pdr >= MIN_PDR;
+}
+
+void LinkTable::noteNeighborInfo(uint32_t num, uint32_t intervalSecs, float snr, int32_t rssi, uint32_t nowMs)
+{
+    if (!num)
+        return;
+    Link &link = findOrAdd(num, nowMs);
+    // The router has already counted this frame if it knew the relayer
+    if (!link.frames)
+        sample(link, snr, rssi, nowMs);
+    if (intervalSecs)
+        link.broadcastIntervalSecs = intervalSecs;
+}
+
+static bool isBetter(const LinkTable::Link &a, const LinkTable::Link &b)
+{
+    return a.pdr != b.pdr ? a.pdr > b.pdr : a.snr > b.snr;
+}
+
+size_t LinkTable::collect(const Link **out, size_t max, uint32_t defaultIntervalSecs, uint32_t nowMs) const
+{
+    size_t count = 0;
+    for (const Link &link : links) {
+        if (!link.num)
+            continue;
+        uint32_t interval = link.broadcastIntervalSecs ? link.broadcastIntervalSecs : defaultIntervalSecs;
+        if ((uint64_t)ageMs(link, nowMs) > (uint64_t)interval * 2000)
+            continue;
+        // Insertion sort, out holds at most a NeighborInfo's worth
+        size_t at = count < max ? count++ : max;
+        while (at > 0 && isBetter(link, *out[at - 1])) {
+            if (at < max)
+                out[at] = out[at - 1];
+            at--;
+        }
+        if (at < max)
+            out[at] = &link;
+    }
+    return count;
+}
+
+size_t LinkTable::size() const
+{
+    size_t count = 0;
+    for (const Link &link : links)
+        count += link.num != 0;
+    return count;
+}
+
+void LinkTable::clear()
+{
+    for (Link &link : links)
+        link = Link();
+}
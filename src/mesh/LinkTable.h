@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * What we know of the radio link to each node we hear directly, for routing, rebroadcast timing and NeighborInfo.
+ *
+ * The router feeds every LoRa frame it hears (heard()). The transmitter of a frame is its originator on the first hop, and
+ * otherwise a relayer known only by the low byte of its number (relay_node). The table is hashed on that byte, so a lookup by
+ * either one is a hash and at most PROBE compares. For each link it keeps:
+ *
+ * - an EWMA of SNR and RSSI over every frame heard from it
+ * - a packet delivery ratio over what we handed it as next hop: each implicit ACK (hearing it relay the packet) is a
+ *   success, each retransmission because none came a failure (delivered()). Successes and attempts both decay by
+ *   1 - ALPHA per outcome.
+ * - when it was last heard
+ *
+ * Gaps in a neighbor's packet ids say nothing about loss, as generatePacketId() also numbers packets that never go on air
+ * (replies to the phone, local stats, admin), so frames heard only feed SNR, RSSI and age.
+ */
+class LinkTable
+{
+  public:
+    static const unsigned SLOT_BITS = 5;
+    static const size_t SLOTS = 1 << SLOT_BITS; // Three times what NeighborInfo can carry
+    static const size_t PROBE = 8;
+    static constexpr float ALPHA = 0.125f;        // Weight of a new sample
+    static const uint8_t MIN_SAMPLES = 4;         // Samples before an average or the ratio is trusted
+    static constexpr float MIN_PDR = 0.25f;       // Below this a link is not worth routing over
+    static const uint32_t STALE_MS = 2 * 60 * 60 * 1000UL;
+
+    struct Link {
+        uint32_t num; // 0 for a free slot
+        uint32_t lastHeardMs;
+        uint32_t broadcastIntervalSecs; // From its NeighborInfo, 0 if it never said
+        float snr;
+        float rssi;
+        float pdr;       // successes / attempts, 1 until there is any
+        float attempts;  // Decayed counts behind pdr
+        float successes;
+        uint16_t frames;    // Frames heard, saturating
+        uint8_t deliveries; // Delivery samples behind pdr, saturating
+    };
+
+    /**
+     * Record a frame heard over LoRa.
+     *
+     * @param direct from transmitted it itself (hop_start == hop_limit and relay_node is from's), else relayNode did
+     * @return the transmitter's link, nullptr if a relayer we don't know the number of
+     */
+    const Link *heard(uint32_t from, uint8_t relayNode, bool direct, float snr, int32_t rssi, uint32_t nowMs);
+
+    /// What we handed relayNode as next hop was (ok) or was not (!ok) relayed on
+    void delivered(uint8_t relayNode, bool ok);
+
+    const Link *find(uint32_t num) const;
+
+    /// The most recently heard link whose number ends in relayNode
+    const Link *findByRelay(uint8_t relayNode) const;
+
+    /// The link that sent a frame, as heard() reads it
+    const Link *transmitter(uint32_t from, uint8_t relayNode, bool direct) const
+    {
+        return direct ? find(from) : findByRelay(relayNode);
+    }
+
+    /// Heard lately and, once the ratio is known, delivering often enough
+    static bool isUsable(const Link &link, uint32_t nowMs);
+
+    /// Smoothed SNR of the link once it has a few frames behind it, else the sample
+    static float smoothedSnr(const Link *link, float sample)
+    {
+        return link && link->frames >= MIN_SAMPLES ? link->snr : sample;
+    }
+
+    /**
+     * A NeighborInfo was last sent by num, heard at snr/rssi. Adds num if we only knew its relay byte, and keeps intervalSecs
+     * (0 if num only relayed it) for collect().
+     */
+    void noteNeighborInfo(uint32_t num, uint32_t intervalSecs, float snr, int32_t rssi, uint32_t nowMs);
+
+    /**
+     * The best links heard within twice their broadcast interval (defaultIntervalSecs if they never said), best ratio first.
+     * @return how many were written to out
+     */
+    size_t collect(const Link **out, size_t max, uint32_t defaultIntervalSecs, uint32_t nowMs) const;
+
+    size_t size() const;
+    uint32_t getEvictions() const { return evictions; }
+
+    void clear();
+
+    /// The relay_node byte a node stamps on what it relays, as NodeDB::getLastByteOfNodeNum()
+    static uint8_t relayByte(uint32_t num) { return (num & 0xff) ? num & 0xff : 0xff; }
+
+  private:
+    Link links[SLOTS] = {};
+    uint32_t evictions = 0;
+
+    // Fibonacci hash of the last byte, so a relay_node finds the same slots as the whole number
+    static size_t slotFor(uint8_t relayNode) { return (uint32_t)(relayNode * 2654435761u) >> (32 - SLOT_BITS); }
+
+    /// The link for num, a fresh one if it is new
+    Link &findOrAdd(uint32_t num, uint32_t nowMs);
+
+    static void sample(Link &link, float snr, int32_t rssi, uint32_t nowMs);
+    static void deliveredSample(Link &link, bool ok);
+};
+
+extern LinkTable linkTable;
@@ -0,0 +1,21 @@
+#include "LiveFeed.h"
+
+#if HAS_LIVE_FEED
+#include "mesh-pb-constants.h"
+
+LiveFeed *liveFeed;
+
+void LiveFeed::onPacketForPhone(const meshtastic_MeshPacket &p)
+{
+    if (!frames.isViewed(millis(), VIEWER_TIMEOUT_MS))
+        return;
+
+    scratch = meshtastic_FromRadio_init_zero;
+    scratch.which_payload_variant = meshtastic_FromRadio_packet_tag;
+    scratch.packet = p;
+    size_t length = pb_encode_to_bytes(encoded, sizeof(encoded), &meshtastic_FromRadio_msg, &scratch);
+    if (length)
+        frames.publish(encoded, length);
+}
+
+#endif
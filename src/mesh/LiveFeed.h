@@ -0,0 +1,58 @@
+#pragma once
+
+#include "configuration.h"
+
+// The only viewers are the web servers: the ESP32 one, and ulfius on Linux native
+#if (defined(ARCH_ESP32) && !MESHTASTIC_EXCLUDE_WEBSERVER) || (defined(PORTDUINO_LINUX_HARDWARE) && __has_include(<ulfius.h>))
+#define HAS_LIVE_FEED 1
+#else
+#define HAS_LIVE_FEED 0
+#endif
+
+#if HAS_LIVE_FEED
+
+#include "FrameBroadcast.h"
+#include "mesh/generated/meshtastic/mesh.pb.h"
+
+#ifndef LIVE_FEED_SLOTS
+#ifdef ARCH_PORTDUINO
+#define LIVE_FEED_SLOTS 64
+#else
+#define LIVE_FEED_SLOTS 16 // 8 KB of heap while the web server runs
+#endif
+#endif
+
+/**
+ * Every packet the phone would get, as encoded FromRadio frames, for web dashboards to watch.
+ *
+ * Unlike /api/v1/fromradio, which drains the one PhoneAPI behind the web server, each viewer reads the feed with its own cursor
+ * (see FrameBroadcast), so any number of browsers see every packet. Packets are only encoded while someone has looked in the
+ * last VIEWER_TIMEOUT_MS.
+ */
+class LiveFeed
+{
+  public:
+    typedef FrameBroadcast<LIVE_FEED_SLOTS, meshtastic_FromRadio_size> Frames;
+
+    static const uint32_t VIEWER_TIMEOUT_MS = 60 * 1000;
+
+    /// From MeshService::sendToPhone(), on the main thread
+    void onPacketForPhone(const meshtastic_MeshPacket &p);
+
+    /// The frames, for a viewer that is looking now. Called from the web server's threads.
+    Frames &watch()
+    {
+        frames.markViewed(millis());
+        return frames;
+    }
+
+  private:
+    Frames frames;
+    meshtastic_FromRadio scratch = meshtastic_FromRadio_init_zero;
+    uint8_t encoded[meshtastic_FromRadio_size];
+};
+
+/// Created by the web server when it starts
+extern LiveFeed *liveFeed;
+
+#endif
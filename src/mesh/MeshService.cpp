@@ -1,3 +1,4 @@
+#define LOG_MODULE_LEVEL MESHTASTIC_LOG_MESH_LEVEL // Packet hot path, see DebugConfiguration.h
 #include "configuration.h"
 
 #if !MESHTASTIC_EXCLUDE_GPS
@@ -10,6 +11,7 @@
 #include "NodeDB.h"
 #include "PowerFSM.h"
 #include "RTC.h"
+#include "LiveFeed.h"
 #include "TypeConversions.h"
 #include "main.h"
 #include "mesh-pb-constants.h"
@@ -17,6 +19,7 @@
 #include "modules/NodeInfoModule.h"
 #include "modules/PositionModule.h"
 #include "modules/RoutingModule.h"
+#include "modules/TraceRouteModule.h"
 #include "power.h"
 #include <assert.h>
 #include <string>
@@ -195,6 +198,17 @@ void MeshService::handleToRadio(meshtastic_MeshPacket &p)
     p.rx_time = getValidTime(RTCQualityFromNet); // Record the time the packet arrived from the phone
                                                  // (so we update our nodedb for the local node)
 
+#if USERPREFS_TRACEROUTE_FROM_CACHE
+    if (traceRouteModule && traceRouteModule->answerFromCache(p)) {
+        // Traced lately, so the phone has its answer without a round trip over the air. It still gets what sending would
+        // have given it: the queue status, and an ACK from us, as for a packet that only made it onto the mesh.
+        sendQueueStatusToPhone(router->getQueueStatus(), ERRNO_OK, p.id);
+        if (p.want_ack && routingModule)
+            routingModule->sendAckNak(meshtastic_Routing_Error_NONE, nodeDB->getNodeNum(), p.id, p.channel);
+        return;
+    }
+#endif
+
     // Send the packet into the mesh
     DEBUG_HEAP_BEFORE;
     auto a = packetPool.allocCopy(p);
@@ -295,6 +309,11 @@ void MeshService::sendToPhone(meshtastic_MeshPacket *p)
 {
     perhapsDecode(p);
 
+#if HAS_LIVE_FEED
+    if (liveFeed)
+        liveFeed->onPacketForPhone(*p);
+#endif
+
 #ifdef ARCH_ESP32
 #if !MESHTASTIC_EXCLUDE_STOREFORWARD
     if (moduleConfig.store_forward.enabled && storeForwardModule->isServer() &&
@@ -1,3 +1,4 @@
+#define LOG_MODULE_LEVEL MESHTASTIC_LOG_MESH_LEVEL // Packet hot path, see DebugConfiguration.h
 #include "NextHopRouter.h"
 #include "MeshTypes.h"
 #include "meshUtils.h"
@@ -71,6 +72,10 @@ bool NextHopRouter::shouldFilterReceived(const meshtastic_MeshPacket *p)
 
         if (p->transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA) {
             rxDupe++;
+            // Hearing the next hop we picked relay it is the implicit ACK for that link
+            PendingPacket *sent = findPendingPacket(GlobalPacketId(p->from, p->id));
+            if (sent && sent->packet->next_hop != NO_NEXT_HOP_PREFERENCE && sent->packet->next_hop == p->relay_node)
+                linkTable.delivered(p->relay_node, true);
             stopRetransmission(p->from, p->id);
         }
 
@@ -143,6 +148,7 @@ bool NextHopRouter::perhapsRelay(const meshtastic_MeshPacket *p)
         if (p->next_hop == NO_NEXT_HOP_PREFERENCE || p->next_hop == nodeDB->getLastByteOfNodeNum(getNodeNum())) {
             if (isRebroadcaster()) {
                 meshtastic_MeshPacket *tosend = packetPool.allocCopy(*p); // keep a copy because we will be sending it
+                tosend->rx_snr = rebroadcastSnr(p);
                 LOG_INFO("Relaying received message coming from %x", p->relay_node);
 
                 // Use shared logic to determine if hop_limit should be decremented
@@ -176,6 +182,13 @@ uint8_t NextHopRouter::getNextHop(NodeNum to, uint8_t relay_node)
 
     meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(to);
     if (node && node->next_hop) {
+        // A next hop gone quiet or losing most of what we hand it costs a retransmission before we flood anyway
+        const LinkTable::Link *link = linkTable.findByRelay(node->next_hop);
+        if (link && !LinkTable::isUsable(*link, millis())) {
+            LOG_INFO("Next hop 0x%x for 0x%x has a poor link (pdr %.2f, heard %us ago); set no pref", node->next_hop, to,
+                     link->pdr, (millis() - link->lastHeardMs) / 1000);
+            return NO_NEXT_HOP_PREFERENCE;
+        }
         // We are careful not to return the relay node as the next hop
         if (node->next_hop != relay_node) {
             // LOG_DEBUG("Next hop for 0x%x is 0x%x", to, node->next_hop);
@@ -290,6 +303,9 @@ int32_t NextHopRouter::doRetransmissions()
                           p.packet->id, p.numRetransmissions);
 
                 if (!isBroadcast(p.packet->to)) {
+                    // The next hop did not relay the last try
+                    if (p.packet->next_hop != NO_NEXT_HOP_PREFERENCE)
+                        linkTable.delivered(p.packet->next_hop, false);
                     if (p.numRetransmissions == 1) {
                         // Last retransmission, reset next_hop (fallback to FloodingRouter)
                         p.packet->next_hop = NO_NEXT_HOP_PREFERENCE;
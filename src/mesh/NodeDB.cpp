@@ -7,21 +7,25 @@
 #include "CryptoEngine.h"
 #include "Default.h"
 #include "FSCommon.h"
+#include "LinkTable.h"
 #include "MeshRadio.h"
 #include "MeshService.h"
 #include "NodeDB.h"
+#include "NodeDBJournal.h"
 #include "PacketHistory.h"
 #include "PowerFSM.h"
+#include "PrefsStore.h"
 #include "RTC.h"
+#include "RouteCache.h"
 #include "Router.h"
 #include "SPILock.h"
 #include "SafeFile.h"
 #include "TypeConversions.h"
+#include "concurrency/Periodic.h"
 #include "error.h"
 #include "main.h"
 #include "mesh-pb-constants.h"
 #include "meshUtils.h"
-#include "modules/NeighborInfoModule.h"
 #include <ErriezCRC32.h>
 #include <algorithm>
 #include <pb_decode.h>
@@ -191,9 +195,19 @@ uint32_t error_address = 0;
 
 static uint8_t ourMacAddr[6];
 
+/// Periodically fold the node journal back into the nodes.proto snapshot, away from the code paths that save nodes
+static concurrency::Periodic *nodeDBCompactor;
+static int32_t compactNodeDatabaseJournal()
+{
+    if (nodeDB)
+        nodeDB->compactNodeDatabase();
+    return 10 * 60 * 1000;
+}
+
 NodeDB::NodeDB()
 {
     LOG_INFO("Init NodeDB");
+    nodesVersion = random(0, LONG_MAX); // So an ETag from before a reboot does not match
     loadFromDisk();
     cleanupMeshDB();
 
@@ -430,6 +444,8 @@ NodeDB::NodeDB()
 #endif
     sortMeshDB();
     saveToDisk(saveWhat);
+    if (!nodeDBCompactor)
+        nodeDBCompactor = new concurrency::Periodic("NodeDBCompact", compactNodeDatabaseJournal);
 }
 
 /**
@@ -489,6 +505,8 @@ bool NodeDB::factoryReset(bool eraseBleBonds)
     }
 #endif
     spiLock->unlock();
+    if (prefsStore())
+        prefsStore()->clear(); // Its segments were in /prefs
     // second, install default state (this will deal with the duplicate mac address issue)
     installDefaultNodeDatabase();
     installDefaultDeviceState();
@@ -990,10 +1008,11 @@ void NodeDB::resetNodes()
     std::fill(nodeDatabase.nodes.begin() + 1, nodeDatabase.nodes.end(), meshtastic_NodeInfoLite());
     devicestate.has_rx_text_message = false;
     devicestate.has_rx_waypoint = false;
+    nodesChanged();
     saveNodeDatabaseToDisk();
     saveDeviceStateToDisk();
-    if (neighborInfoModule && moduleConfig.neighbor_info.enabled)
-        neighborInfoModule->resetNeighbors();
+    linkTable.clear();
+    routeCache.clear();
 }
 
 void NodeDB::removeNodeByNum(NodeNum nodeNum)
@@ -1008,6 +1027,7 @@ void NodeDB::removeNodeByNum(NodeNum nodeNum)
     numMeshNodes -= removed;
     std::fill(nodeDatabase.nodes.begin() + numMeshNodes, nodeDatabase.nodes.begin() + numMeshNodes + 1,
               meshtastic_NodeInfoLite());
+    nodesChanged();
     LOG_DEBUG("NodeDB::removeNodeByNum purged %d entries. Save changes", removed);
     saveNodeDatabaseToDisk();
 }
@@ -1043,6 +1063,8 @@ void NodeDB::cleanupMeshDB()
     numMeshNodes -= removed;
     std::fill(nodeDatabase.nodes.begin() + numMeshNodes, nodeDatabase.nodes.begin() + numMeshNodes + removed,
               meshtastic_NodeInfoLite());
+    if (removed)
+        nodesChanged();
     LOG_DEBUG("cleanupMeshDB purged %d entries", removed);
 }
 
@@ -1109,12 +1131,72 @@ void NodeDB::pickNewNodeNum()
     myNodeInfo.my_node_num = nodeNum;
 }
 
+#ifdef FSCom
+/// Settings protobufs under /prefs small enough for the record store are kept there instead of in their own file
+static bool isStoreRecord(const char *filename, size_t protoSize)
+{
+    return protoSize <= RecordStore::MAX_VALUE && strlen(filename) <= RecordStore::MAX_KEY &&
+           strncmp(filename, "/prefs/", 7) == 0 && strcmp(filename, nodeDatabaseFileName) != 0 && prefsStore();
+}
+
+static LoadFileResult loadStoredProto(const char *filename, size_t objSize, const pb_msgdesc_t *fields, void *dest_struct)
+{
+    int32_t length = prefsStore()->length(filename);
+    uint8_t *buf = new uint8_t[length > 0 ? length : 1];
+    LoadFileResult state = LoadFileResult::OTHER_FAILURE;
+    size_t got = 0;
+    if (!prefsStore()->get(filename, buf, length, &got)) {
+        LOG_ERROR("Could not read %s from the record store", filename);
+    } else {
+        pb_istream_t stream = pb_istream_from_buffer(buf, got);
+        memset(dest_struct, 0, objSize);
+        if (!pb_decode(&stream, fields, dest_struct)) {
+            LOG_ERROR("Error: can't decode protobuf %s", PB_GET_ERROR(&stream));
+            state = LoadFileResult::DECODE_FAILED;
+        } else {
+            LOG_INFO("Loaded %s from the record store", filename);
+            state = LoadFileResult::LOAD_SUCCESS;
+        }
+    }
+    delete[] buf;
+    return state;
+}
+
+static bool saveStoredProto(const char *filename, size_t protoSize, const pb_msgdesc_t *fields, const void *dest_struct)
+{
+    uint32_t started = millis();
+    uint8_t *buf = new uint8_t[protoSize];
+    pb_ostream_t stream = pb_ostream_from_buffer(buf, protoSize);
+    bool okay = pb_encode(&stream, fields, dest_struct);
+    if (!okay) {
+        LOG_ERROR("Error: can't encode protobuf %s", PB_GET_ERROR(&stream));
+    } else {
+        uint32_t unchanged = prefsStore()->getUnchanged();
+        okay = prefsStore()->put(filename, buf, stream.bytes_written);
+        if (!okay)
+            LOG_ERROR("Can't write prefs!");
+        else if (prefsStore()->getUnchanged() == unchanged)
+            LOG_INFO("Saved %s to the record store (%u bytes, %u ms)", filename, (unsigned)stream.bytes_written,
+                     millis() - started);
+    }
+    delete[] buf;
+    // The file from before the record store is left alone, so going back to older firmware finds the settings as they
+    // were when they moved into the store. Remove it once downgrading past the store is no longer supported.
+    return okay;
+}
+#endif
+
 /** Load a protobuf from a file, return LoadFileResult */
 LoadFileResult NodeDB::loadProto(const char *filename, size_t protoSize, size_t objSize, const pb_msgdesc_t *fields,
                                  void *dest_struct)
 {
     LoadFileResult state = LoadFileResult::OTHER_FAILURE;
 #ifdef FSCom
+    // Without a record, this is the first boot after an upgrade and the file is loaded. The next save moves it into the
+    // store.
+    if (isStoreRecord(filename, protoSize) && prefsStore()->has(filename))
+        return loadStoredProto(filename, objSize, fields, dest_struct);
+
     concurrency::LockGuard g(spiLock);
 
     auto f = FSCom.open(filename, FILE_O_READ);
@@ -1171,6 +1253,7 @@ void NodeDB::loadFromDisk()
         spiLock->lock();
         rmDir("/prefs");
         spiLock->unlock();
+        prefsStore()->clear();
     } else {
         spiLock->unlock();
     }
@@ -1182,6 +1265,12 @@ void NodeDB::loadFromDisk()
         LOG_WARN("NodeDatabase %d is old, discard", nodeDatabase.version);
         installDefaultNodeDatabase();
     } else {
+#ifdef FSCom
+        // Changes saved since the snapshot was written live in the journal
+        size_t snapshotSize;
+        uint32_t snapshotCrc = NodeDBJournal::snapshotFileCrc(nodeDatabaseFileName, snapshotSize);
+        nodeJournal.replay(nodeDatabase.nodes, snapshotSize, snapshotCrc);
+#endif
         meshNodes = &nodeDatabase.nodes;
         numMeshNodes = nodeDatabase.nodes.size();
         LOG_INFO("Loaded saved nodedatabase version %d, with nodes count: %d", nodeDatabase.version, nodeDatabase.nodes.size());
@@ -1192,6 +1281,7 @@ void NodeDB::loadFromDisk()
         numMeshNodes = MAX_NUM_NODES;
     }
     meshNodes->resize(MAX_NUM_NODES);
+    nodeJournal.track(*meshNodes, numMeshNodes);
 
     // static DeviceState scratch; We no longer read into a tempbuf because this structure is 15KB of valuable RAM
     state = loadProto(deviceStateFileName, meshtastic_DeviceState_size, sizeof(meshtastic_DeviceState),
@@ -1347,6 +1437,9 @@ bool NodeDB::saveProto(const char *filename, size_t protoSize, const pb_msgdesc_
 {
     bool okay = false;
 #ifdef FSCom
+    if (isStoreRecord(filename, protoSize))
+        return saveStoredProto(filename, protoSize, fields, dest_struct);
+
     auto f = SafeFile(filename, fullAtomic);
 
     LOG_INFO("Save %s", filename);
@@ -1398,9 +1491,32 @@ bool NodeDB::saveNodeDatabaseToDisk()
     FSCom.mkdir("/prefs");
     spiLock->unlock();
 #endif
+    // Usually only a few nodes changed since the last save, append just those to the journal
+    if (nodeJournal.append(*meshNodes, numMeshNodes))
+        return true;
+    return saveNodeDatabaseSnapshot();
+}
+
+bool NodeDB::saveNodeDatabaseSnapshot()
+{
+    uint32_t started = millis();
     size_t nodeDatabaseSize;
     pb_get_encoded_size(&nodeDatabaseSize, meshtastic_NodeDatabase_fields, &nodeDatabase);
-    return saveProto(nodeDatabaseFileName, nodeDatabaseSize, &meshtastic_NodeDatabase_msg, &nodeDatabase, false);
+    bool okay = saveProto(nodeDatabaseFileName, nodeDatabaseSize, &meshtastic_NodeDatabase_msg, &nodeDatabase, false);
+    nodeJournal.noteSnapshotWrite(nodeDatabaseSize, millis() - started);
+    if (okay)
+        nodeJournal.rebase(*meshNodes, numMeshNodes, nodeDatabaseSize, NodeDBJournal::snapshotCrc(nodeDatabase));
+    return okay;
+}
+
+void NodeDB::compactNodeDatabase()
+{
+    if (nodeJournal.needsCompaction()) {
+        LOG_INFO("Compact NodeDB journal into a new snapshot");
+        saveNodeDatabaseSnapshot();
+    }
+    nodeJournal.reportStats();
+    reportPrefsStoreStats();
 }
 
 bool NodeDB::saveToDiskNoRetry(int saveWhat)
@@ -1468,6 +1584,8 @@ bool NodeDB::saveToDisk(int saveWhat)
         spiLock->lock();
         FSCom.format();
         spiLock->unlock();
+        if (prefsStore())
+            prefsStore()->clear(); // Its segments went with the format, appends must start a fresh one
 
 #endif
         success = saveToDiskNoRetry(saveWhat);
@@ -1527,6 +1645,20 @@ size_t NodeDB::getNumOnlineMeshNodes(bool localOnly)
     return numseen;
 }
 
+bool NodeDB::allOnlineNodesCanDecompress()
+{
+    size_t numseen = 0;
+    for (int i = 0; i < numMeshNodes; i++) {
+        const meshtastic_NodeInfoLite &node = meshNodes->at(i);
+        if (node.num == getNodeNum() || sinceLastSeen(&node) >= NUM_ONLINE_SECS)
+            continue;
+        if (!(node.bitfield & NODEINFO_BITFIELD_CAN_DECOMPRESS_MASK))
+            return false;
+        numseen++;
+    }
+    return numseen > 0;
+}
+
 #include "MeshModule.h"
 #include "Throttle.h"
 
@@ -1728,11 +1860,18 @@ void NodeDB::updateFrom(const meshtastic_MeshPacket &mp)
 
         info->via_mqtt = mp.via_mqtt; // Store if we received this packet via MQTT
 
+        // Only the sender sets the bitfield, so this is what its firmware can do now
+        if (mp.decoded.has_bitfield && (mp.decoded.bitfield & BITFIELD_CAN_DECOMPRESS_MASK))
+            info->bitfield |= NODEINFO_BITFIELD_CAN_DECOMPRESS_MASK;
+        else
+            info->bitfield &= ~NODEINFO_BITFIELD_CAN_DECOMPRESS_MASK;
+
         // If hopStart was set and there wasn't someone messing with the limit in the middle, add hopsAway
         if (mp.hop_start != 0 && mp.hop_limit <= mp.hop_start) {
             info->has_hops_away = true;
             info->hops_away = mp.hop_start - mp.hop_limit;
         }
+        nodesChanged();
         sortMeshDB();
     }
 }
@@ -1742,6 +1881,7 @@ void NodeDB::set_favorite(bool is_favorite, uint32_t nodeId)
     meshtastic_NodeInfoLite *lite = getMeshNode(nodeId);
     if (lite && lite->is_favorite != is_favorite) {
         lite->is_favorite = is_favorite;
+        nodesChanged();
         sortMeshDB();
         saveNodeDatabaseToDisk();
     }
@@ -1815,7 +1955,7 @@ void NodeDB::sortMeshDB()
 {
     if (!sortingIsPaused && (lastSort == 0 || !Throttle::isWithinTimespanMs(lastSort, 1000 * 5))) {
         lastSort = millis();
-        bool changed = true;
+        bool changed = true, reordered = false;
         while (changed) { // dumb reverse bubble sort, but probably not bad for what we're doing
             changed = false;
             for (int i = numMeshNodes - 1; i > 0; i--) { // lowest case this should examine is i == 1
@@ -1836,7 +1976,10 @@ void NodeDB::sortMeshDB()
                     changed = true;
                 }
             }
+            reordered |= changed;
         }
+        if (reordered)
+            nodesChanged();
         LOG_INFO("Sort took %u milliseconds", millis() - lastSort);
     }
 }
@@ -1915,6 +2058,7 @@ meshtastic_NodeInfoLite *NodeDB::getOrCreateMeshNode(NodeNum n)
         // everything is missing except the nodenum
         memset(lite, 0, sizeof(*lite));
         lite->num = n;
+        nodesChanged();
         LOG_INFO("Adding node to database with %i nodes and %u bytes free!", numMeshNodes, memGet.getFreeHeap());
     }
 
@@ -8,9 +8,11 @@
 #include <vector>
 
 #include "MeshTypes.h"
+#include "NodeDBJournal.h"
 #include "NodeStatus.h"
 #include "configuration.h"
 #include "mesh-pb-constants.h"
+#include "mesh/generated/meshtastic/bitfield.pb.h"
 #include "mesh/generated/meshtastic/mesh.pb.h" // For CriticalErrorCode
 
 #if ARCH_PORTDUINO
@@ -225,6 +227,12 @@ class NodeDB
      */
     size_t getNumOnlineMeshNodes(bool localOnly = false);
 
+    /**
+     * Whether every node heard from in the last two hours has told us it can decompress payloads, false if we've heard none.
+     * Nodes quieter than that are not asked, see USERPREFS_PAYLOAD_COMPRESSION.
+     */
+    bool allOnlineNodesCanDecompress();
+
     void initConfigIntervals(), initModuleConfigIntervals(), resetNodes(), removeNodeByNum(NodeNum nodeNum);
 
     bool factoryReset(bool eraseBleBonds = false);
@@ -247,6 +255,12 @@ class NodeDB
     virtual meshtastic_NodeInfoLite *getMeshNode(NodeNum n);
     size_t getNumMeshNodes() { return numMeshNodes; }
 
+    /**
+     * Changes whenever a node is added, removed, reordered or updated, so readers of the node list (e.g. the web server's
+     * ETags) can tell whether it is worth reading again. Starts from a random value each boot.
+     */
+    uint32_t getNodesVersion() const { return nodesVersion; }
+
     UserLicenseStatus getLicenseStatus(uint32_t nodeNum);
 
     size_t getMaxNodesAllocatedSize()
@@ -284,11 +298,15 @@ class NodeDB
     bool restorePreferences(meshtastic_AdminMessage_BackupLocation location,
                             int restoreWhat = SEGMENT_CONFIG | SEGMENT_MODULECONFIG | SEGMENT_DEVICESTATE | SEGMENT_CHANNELS);
 
+    /// Write a new snapshot if the node journal has grown too big or too old, called periodically
+    void compactNodeDatabase();
+
     /// Notify observers of changes to the DB
     void notifyObservers(bool forceUpdate = false)
     {
         // Notify observers of the current node state
         const meshtastic::NodeStatus status = meshtastic::NodeStatus(getNumOnlineMeshNodes(), getNumMeshNodes(), forceUpdate);
+        nodesChanged();
         newStatus.notifyObservers(&status);
     }
 
@@ -297,6 +315,11 @@ class NodeDB
     uint32_t lastNodeDbSave = 0;    // when we last saved our db to flash
     uint32_t lastBackupAttempt = 0; // when we last tried a backup automatically or manually
     uint32_t lastSort = 0;          // When last sorted the nodeDB
+    NodeDBJournal nodeJournal;      // Node changes appended since nodes.proto was last written
+    uint32_t nodesVersion = 0;      // See getNodesVersion()
+
+    void nodesChanged() { nodesVersion++; }
+
     /// Find a node in our DB, create an empty NodeInfoLite if missing
     meshtastic_NodeInfoLite *getOrCreateMeshNode(NodeNum n);
 
@@ -325,6 +348,8 @@ class NodeDB
     bool saveChannelsToDisk();
     bool saveDeviceStateToDisk();
     bool saveNodeDatabaseToDisk();
+    /// Rewrite the whole nodes.proto and start a new journal
+    bool saveNodeDatabaseSnapshot();
     void sortMeshDB();
 };
 
@@ -362,6 +387,8 @@ extern meshtastic_CriticalErrorCode error_code;
 extern uint32_t error_address;
 #define NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_SHIFT 0
 #define NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_MASK (1 << NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_SHIFT)
+// GateMesh's bit, claimed in bitfield.proto
+#define NODEINFO_BITFIELD_CAN_DECOMPRESS_MASK meshtastic_NodeInfoBitfield_NODE_INFO_BITFIELD_CAN_DECOMPRESS
 
 #define Module_Config_size                                                                                                       \
     (ModuleConfig_CannedMessageConfig_size + ModuleConfig_ExternalNotificationConfig_size + ModuleConfig_MQTTConfig_size +       \
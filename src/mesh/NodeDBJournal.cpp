@@ -0,0 +1,299 @@
+#include "NodeDBJournal.h"
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "Throttle.h"
+#include "mesh-pb-constants.h"
+#include <ErriezCRC32.h>
+#include <algorithm>
+#include <pb_encode.h>
+
+static bool crcWriter(pb_ostream_t *stream, const uint8_t *buf, size_t count)
+{
+    uint32_t *crc = static_cast<uint32_t *>(stream->state);
+    *crc = crc32Update(buf, count, *crc);
+    return true;
+}
+
+static uint32_t encodedCrc(const pb_msgdesc_t *fields, const void *message)
+{
+    uint32_t crc = CRC32_INITIAL;
+    pb_ostream_t stream = {&crcWriter, &crc, SIZE_MAX, 0};
+    pb_encode(&stream, fields, message);
+    return crc32Final(crc);
+}
+
+uint32_t NodeDBJournal::hashNode(const meshtastic_NodeInfoLite &node)
+{
+    return encodedCrc(&meshtastic_NodeInfoLite_msg, &node);
+}
+
+uint32_t NodeDBJournal::snapshotCrc(const meshtastic_NodeDatabase &database)
+{
+    return encodedCrc(&meshtastic_NodeDatabase_msg, &database);
+}
+
+uint32_t NodeDBJournal::snapshotFileCrc(const char *snapshotFileName, size_t &size)
+{
+    size = 0;
+#ifdef FSCom
+    concurrency::LockGuard g(spiLock);
+    auto f = FSCom.open(snapshotFileName, FILE_O_READ);
+    if (!f)
+        return 0;
+    uint32_t crc = CRC32_INITIAL;
+    uint8_t buf[256];
+    int got;
+    while ((got = f.read(buf, sizeof(buf))) > 0) {
+        crc = crc32Update(buf, got, crc);
+        size += got;
+    }
+    f.close();
+    return crc32Final(crc);
+#else
+    return 0;
+#endif
+}
+
+uint8_t NodeDBJournal::checkByte(uint8_t type, const uint8_t *payload, size_t length)
+{
+    uint8_t check = type;
+    for (size_t i = 0; i < length; i++)
+        check ^= payload[i];
+    return check;
+}
+
+void NodeDBJournal::track(const std::vector<meshtastic_NodeInfoLite> &nodes, size_t numNodes)
+{
+    written.clear();
+    written.reserve(numNodes);
+    for (size_t i = 0; i < numNodes && i < nodes.size(); i++) {
+        if (nodes[i].num)
+            written.push_back(std::make_pair(nodes[i].num, hashNode(nodes[i])));
+    }
+    std::sort(written.begin(), written.end());
+}
+
+void NodeDBJournal::removeFile()
+{
+#ifdef FSCom
+    concurrency::LockGuard g(spiLock);
+    if (FSCom.exists(fileName))
+        FSCom.remove(fileName);
+#endif
+    journalSize = 0;
+    damaged = false;
+}
+
+void NodeDBJournal::rebase(const std::vector<meshtastic_NodeInfoLite> &nodes, size_t numNodes, size_t newSnapshotSize,
+                           uint32_t newSnapshotCrc)
+{
+    removeFile();
+    snapshotSize = newSnapshotSize;
+    snapshotCrc32 = newSnapshotCrc;
+    track(nodes, numNodes);
+}
+
+size_t NodeDBJournal::replay(std::vector<meshtastic_NodeInfoLite> &nodes, size_t expectedSnapshotSize,
+                             uint32_t expectedSnapshotCrc)
+{
+    snapshotSize = expectedSnapshotSize;
+    snapshotCrc32 = expectedSnapshotCrc;
+    journalSize = 0;
+    damaged = false;
+    size_t applied = 0;
+#ifdef FSCom
+    concurrency::LockGuard g(spiLock);
+    auto f = FSCom.open(fileName, FILE_O_READ);
+    if (!f)
+        return 0;
+
+    FileHeader header;
+    if (f.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || header.magic != MAGIC ||
+        header.snapshotSize != expectedSnapshotSize || header.snapshotCrc != expectedSnapshotCrc) {
+        // Written against another snapshot, e.g. power was lost between a compaction and removing the old journal
+        LOG_WARN("Discard NodeDB journal that does not match the snapshot");
+        f.close();
+        FSCom.remove(fileName);
+        return 0;
+    }
+
+    size_t offset = sizeof(header);
+    uint8_t payload[meshtastic_NodeInfoLite_size];
+    RecordHeader record;
+    while (f.read((uint8_t *)&record, sizeof(record)) == sizeof(record)) {
+        if (record.length > sizeof(payload) || f.read(payload, record.length) != record.length ||
+            checkByte(record.type, payload, record.length) != record.check) {
+            damaged = true;
+            break;
+        }
+
+        if (record.type == RECORD_UPSERT) {
+            meshtastic_NodeInfoLite node = meshtastic_NodeInfoLite_init_default;
+            if (!pb_decode_from_bytes(payload, record.length, &meshtastic_NodeInfoLite_msg, &node) || !node.num) {
+                damaged = true;
+                break;
+            }
+            auto existing = std::find_if(nodes.begin(), nodes.end(),
+                                         [&node](const meshtastic_NodeInfoLite &n) { return n.num == node.num; });
+            if (existing == nodes.end()) // Reuse an empty slot before growing the vector
+                existing = std::find_if(nodes.begin(), nodes.end(), [](const meshtastic_NodeInfoLite &n) { return n.num == 0; });
+            if (existing == nodes.end())
+                nodes.push_back(node);
+            else
+                *existing = node;
+        } else if (record.type == RECORD_REMOVE && record.length == sizeof(NodeNum)) {
+            NodeNum num;
+            memcpy(&num, payload, sizeof(num));
+            auto isRemoved = [num](const meshtastic_NodeInfoLite &n) { return n.num == num; };
+            nodes.erase(std::remove_if(nodes.begin(), nodes.end(), isRemoved), nodes.end());
+        } else {
+            damaged = true;
+            break;
+        }
+        offset += sizeof(record) + record.length;
+        applied++;
+    }
+    f.close();
+
+    journalSize = offset;
+    journalStartedMs = millis();
+    if (damaged)
+        LOG_WARN("NodeDB journal damaged after %u records, will compact", (unsigned)applied);
+    else
+        LOG_INFO("Replayed %u NodeDB journal records (%u bytes)", (unsigned)applied, (unsigned)journalSize);
+#endif
+    return applied;
+}
+
+bool NodeDBJournal::append(const std::vector<meshtastic_NodeInfoLite> &nodes, size_t numNodes)
+{
+#ifdef FSCom
+    if (!snapshotSize || damaged)
+        return false;
+
+    // Walk the current nodes and what was last written side by side, both sorted by NodeNum
+    std::vector<std::pair<NodeNum, uint32_t>> current;
+    current.reserve(numNodes);
+    std::vector<NodeNum> changed; // Sorted, like current
+    for (size_t i = 0; i < numNodes && i < nodes.size(); i++) {
+        if (nodes[i].num)
+            current.push_back(std::make_pair(nodes[i].num, hashNode(nodes[i])));
+    }
+    std::sort(current.begin(), current.end());
+
+    std::vector<NodeNum> removed;
+    auto old = written.begin();
+    for (const auto &entry : current) {
+        while (old != written.end() && old->first < entry.first)
+            removed.push_back((old++)->first);
+        if (old != written.end() && old->first == entry.first) {
+            if (old->second != entry.second)
+                changed.push_back(entry.first);
+            old++;
+        } else {
+            changed.push_back(entry.first);
+        }
+    }
+    while (old != written.end())
+        removed.push_back((old++)->first);
+
+    if (changed.empty() && removed.empty())
+        return true;
+    // Mass changes (reset, first save after a wipe) go into one snapshot rather than a long journal
+    if ((changed.size() + removed.size()) * 4 > current.size() + 4)
+        return false;
+
+    uint32_t started = micros();
+    size_t bytes = 0;
+    bool ok;
+    {
+        concurrency::LockGuard g(spiLock);
+        auto f = FSCom.open(fileName, FILE_O_APPEND);
+        ok = !!f;
+        if (ok && journalSize == 0) {
+            FileHeader header = {MAGIC, (uint32_t)snapshotSize, snapshotCrc32};
+            ok = f.write((uint8_t *)&header, sizeof(header)) == sizeof(header);
+            bytes += sizeof(header);
+        }
+
+        uint8_t payload[meshtastic_NodeInfoLite_size];
+        for (size_t i = 0; ok && i < numNodes && i < nodes.size(); i++) {
+            if (!nodes[i].num || !std::binary_search(changed.begin(), changed.end(), nodes[i].num))
+                continue;
+            RecordHeader record = {RECORD_UPSERT, 0, 0};
+            record.length = pb_encode_to_bytes(payload, sizeof(payload), &meshtastic_NodeInfoLite_msg, &nodes[i]);
+            record.check = checkByte(record.type, payload, record.length);
+            ok = record.length && f.write((uint8_t *)&record, sizeof(record)) == sizeof(record) &&
+                 f.write(payload, record.length) == record.length;
+            bytes += sizeof(record) + record.length;
+        }
+        for (size_t i = 0; ok && i < removed.size(); i++) {
+            RecordHeader record = {RECORD_REMOVE, 0, sizeof(NodeNum)};
+            memcpy(payload, &removed[i], sizeof(NodeNum));
+            record.check = checkByte(record.type, payload, record.length);
+            ok = f.write((uint8_t *)&record, sizeof(record)) == sizeof(record) &&
+                 f.write(payload, sizeof(NodeNum)) == sizeof(NodeNum);
+            bytes += sizeof(record) + sizeof(NodeNum);
+        }
+        if (f)
+            f.close();
+    }
+    uint32_t held = micros() - started;
+
+    if (!ok) {
+        // Part of a record may be on flash now, do not append after it
+        LOG_ERROR("Can't append to NodeDB journal");
+        damaged = true;
+        return false;
+    }
+
+    if (journalSize == 0)
+        journalStartedMs = millis();
+    journalSize += bytes;
+    written.swap(current);
+
+    appends++;
+    journalBytes += bytes;
+    if (held > worstAppendHoldUs)
+        worstAppendHoldUs = held;
+    LOG_DEBUG("NodeDB journal: %u changed, %u removed, %u bytes in %u us", (unsigned)changed.size(), (unsigned)removed.size(),
+              (unsigned)bytes, held);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NodeDBJournal::needsCompaction() const
+{
+    if (damaged)
+        return true;
+    if (!journalSize)
+        return false;
+    return journalSize > std::max((size_t)MIN_COMPACT_BYTES, snapshotSize / 2) ||
+           !Throttle::isWithinTimespanMs(journalStartedMs, MAX_JOURNAL_AGE_MS);
+}
+
+void NodeDBJournal::noteSnapshotWrite(size_t bytes, uint32_t durationMs)
+{
+    snapshots++;
+    snapshotBytes += bytes;
+    if (durationMs > worstSnapshotMs)
+        worstSnapshotMs = durationMs;
+}
+
+void NodeDBJournal::reportStats()
+{
+    if (statsStartedMs == 0) {
+        statsStartedMs = millis();
+        return;
+    }
+    if (Throttle::isWithinTimespanMs(statsStartedMs, STATS_INTERVAL_MS))
+        return;
+
+    LOG_INFO("NodeDB flash writes in the last day: %u journal appends (%u bytes, worst spiLock hold %u us), %u snapshots "
+             "(%u bytes, worst %u ms)",
+             appends, journalBytes, worstAppendHoldUs, snapshots, snapshotBytes, worstSnapshotMs);
+    statsStartedMs = millis();
+    journalBytes = snapshotBytes = appends = snapshots = worstAppendHoldUs = worstSnapshotMs = 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "configuration.h"
+#include "mesh/generated/meshtastic/deviceonly.pb.h"
+#include <utility>
+#include <vector>
+
+/**
+ * Append-only journal of node changes layered on top of the /prefs/nodes.proto snapshot.
+ *
+ * Instead of rewriting the whole NodeDatabase (up to MAX_NUM_NODES * meshtastic_NodeInfoLite_size bytes) every time one
+ * node changes, each save appends one record per node that changed since the last save. Records are keyed by NodeNum
+ * and carry the encoded NodeInfoLite of that node (or just the NodeNum for a removal). On boot the journal is replayed
+ * over the snapshot, and once it grows too big or too old NodeDB writes a fresh snapshot and the journal starts over.
+ *
+ * File layout: FileHeader, then RecordHeader + payload repeated. A torn record at the tail (power loss during an
+ * append) ends the replay, everything before it is still applied. The header names its snapshot by size and CRC32 of
+ * the encoded file, so a journal is never replayed onto a newer snapshot that happens to have the same size.
+ *
+ * reportStats() logs the bytes written and the worst spiLock hold once a day, to compare against the snapshot writes on
+ * real hardware.
+ */
+class NodeDBJournal
+{
+  public:
+    /**
+     * Apply the journal on top of a freshly loaded snapshot.
+     *
+     * @param snapshotSize size in bytes of the snapshot file the nodes came from
+     * @param snapshotCrc snapshotFileCrc() of that file. A journal written against another snapshot is discarded.
+     * @return number of records applied
+     */
+    size_t replay(std::vector<meshtastic_NodeInfoLite> &nodes, size_t snapshotSize, uint32_t snapshotCrc);
+
+    /// Remember the current state of every node so the next append() only writes what changed after this point
+    void track(const std::vector<meshtastic_NodeInfoLite> &nodes, size_t numNodes);
+
+    /// A new snapshot was written: drop the journal and track the nodes it contains
+    void rebase(const std::vector<meshtastic_NodeInfoLite> &nodes, size_t numNodes, size_t snapshotSize, uint32_t snapshotCrc);
+
+    /// CRC32 of the snapshot as saveProto() writes it, without writing or reading anything
+    static uint32_t snapshotCrc(const meshtastic_NodeDatabase &database);
+
+    /// CRC32 and size of the snapshot file on flash, 0 and 0 if there is none
+    static uint32_t snapshotFileCrc(const char *snapshotFileName, size_t &size);
+
+    /**
+     * Append records for every node that changed or disappeared since the last append/rebase.
+     *
+     * @return false if the caller should write a full snapshot instead (no valid snapshot to journal against, or
+     * enough changed that a snapshot is cheaper)
+     */
+    bool append(const std::vector<meshtastic_NodeInfoLite> &nodes, size_t numNodes);
+
+    /// True when the journal is big or old enough that it should be folded into a new snapshot
+    bool needsCompaction() const;
+
+    /// Account for a snapshot write done by NodeDB, for the daily flash write statistics
+    void noteSnapshotWrite(size_t bytes, uint32_t durationMs);
+
+    /// Log the bytes written to flash and worst stall once a day
+    void reportStats();
+
+    static constexpr const char *fileName = "/prefs/nodes.journal";
+
+  private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t snapshotSize; // Size and CRC32 of the snapshot this journal applies to
+        uint32_t snapshotCrc;
+    };
+
+    enum RecordType : uint8_t { RECORD_UPSERT = 1, RECORD_REMOVE = 2 };
+
+    struct RecordHeader {
+        uint8_t type;
+        uint8_t check; // xor of the payload bytes and the type
+        uint16_t length;
+    };
+
+    static constexpr uint32_t MAGIC = 0x324a444e; // "NDJ2", NDJ1 had no snapshot CRC
+    static constexpr size_t MIN_COMPACT_BYTES = 4096;
+    static constexpr uint32_t MAX_JOURNAL_AGE_MS = 24 * 60 * 60 * 1000;
+    static constexpr uint32_t STATS_INTERVAL_MS = 24 * 60 * 60 * 1000;
+
+    /// NodeNum and a hash of the NodeInfoLite last written for it, sorted by NodeNum
+    std::vector<std::pair<NodeNum, uint32_t>> written;
+
+    size_t snapshotSize = 0; // 0 = no snapshot to journal against
+    uint32_t snapshotCrc32 = 0;
+    size_t journalSize = 0;  // 0 = no journal file
+    uint32_t journalStartedMs = 0;
+    bool damaged = false; // Replay stopped at a bad record, compact so it is not hit again
+
+    // Statistics for the current reporting window
+    uint32_t statsStartedMs = 0;
+    uint32_t journalBytes = 0;
+    uint32_t snapshotBytes = 0;
+    uint32_t appends = 0;
+    uint32_t snapshots = 0;
+    uint32_t worstAppendHoldUs = 0;
+    uint32_t worstSnapshotMs = 0;
+
+    /// Over the encoded fields, so struct padding and stale bytes past an array's count don't look like a change
+    static uint32_t hashNode(const meshtastic_NodeInfoLite &node);
+    static uint8_t checkByte(uint8_t type, const uint8_t *payload, size_t length);
+    void removeFile();
+};
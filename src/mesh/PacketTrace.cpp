@@ -0,0 +1,149 @@
+#include "PacketTrace.h"
+#include "concurrency/OSThread.h"
+#include "configuration.h"
+#include <pb_encode.h>
+#include <string.h>
+
+PacketTraceWriter packetTrace;
+
+static const uint32_t FLUSH_AFTER_MS = 1000;
+
+class PacketTraceFlushThread : public concurrency::OSThread
+{
+  public:
+    PacketTraceFlushThread() : OSThread("PacketTrace") {}
+
+  protected:
+    int32_t runOnce() override
+    {
+        packetTrace.flushIfDue();
+        return FLUSH_AFTER_MS / 2;
+    }
+};
+
+static PacketTraceFlushThread *flushThread;
+
+static uint8_t *put8(uint8_t *out, uint8_t v)
+{
+    *out = v;
+    return out + 1;
+}
+
+static uint8_t *put16(uint8_t *out, uint16_t v)
+{
+    out[0] = v & 0xff;
+    out[1] = v >> 8;
+    return out + 2;
+}
+
+static uint8_t *put32(uint8_t *out, uint32_t v)
+{
+    out[0] = v & 0xff;
+    out[1] = (v >> 8) & 0xff;
+    out[2] = (v >> 16) & 0xff;
+    out[3] = v >> 24;
+    return out + 4;
+}
+
+PacketTraceWriter::~PacketTraceWriter()
+{
+    // No flush, during static destruction the sink's file may already be gone. end() is the place for that.
+    delete[] buffer;
+}
+
+void PacketTraceWriter::begin(Sink _sink, size_t _bufferSize)
+{
+    flush();
+    delete[] buffer;
+    // Room for at least one record of either kind
+    if (_bufferSize < RECORD_HEADER_SIZE + meshtastic_Data_size)
+        _bufferSize = RECORD_HEADER_SIZE + meshtastic_Data_size;
+    buffer = new uint8_t[_bufferSize];
+    bufferSize = _bufferSize;
+    used = 0;
+    sink = _sink;
+
+    uint8_t *out = put32(buffer, MAGIC);
+    out = put16(out, RECORD_HEADER_SIZE);
+    out = put16(out, 0);
+    used = out - buffer;
+    flush();
+    if (!flushThread)
+        flushThread = new PacketTraceFlushThread();
+}
+
+void PacketTraceWriter::flush()
+{
+    if (sink && used)
+        sink(buffer, used);
+    used = 0;
+}
+
+void PacketTraceWriter::end()
+{
+    flush();
+    sink = nullptr;
+}
+
+void PacketTraceWriter::flushIfDue()
+{
+    if (used && millis() - oldestUnflushedMs >= FLUSH_AFTER_MS)
+        flush();
+}
+
+void PacketTraceWriter::append(RecordType type, const meshtastic_MeshPacket &p)
+{
+    if (!sink)
+        return;
+    uint32_t now = millis();
+    if (bufferSize - used < RECORD_HEADER_SIZE + meshtastic_Data_size)
+        flush();
+
+    // Payload first, straight into the buffer after the header
+    uint8_t *payload = buffer + used + RECORD_HEADER_SIZE;
+    size_t payloadLen = 0;
+    uint16_t portnum = 0;
+    if (type == RECORD_DECODED) {
+        if (p.which_payload_variant != meshtastic_MeshPacket_decoded_tag)
+            return;
+        pb_ostream_t stream = pb_ostream_from_buffer(payload, bufferSize - used - RECORD_HEADER_SIZE);
+        if (!pb_encode(&stream, &meshtastic_Data_msg, &p.decoded))
+            return;
+        payloadLen = stream.bytes_written;
+        portnum = p.decoded.portnum;
+    } else {
+        if (p.which_payload_variant != meshtastic_MeshPacket_encrypted_tag)
+            return;
+        payloadLen = p.encrypted.size;
+        memcpy(payload, p.encrypted.bytes, payloadLen);
+    }
+
+    uint8_t flags = (p.want_ack ? FLAG_WANT_ACK : 0) | (p.via_mqtt ? FLAG_VIA_MQTT : 0) | (p.pki_encrypted ? FLAG_PKI : 0);
+    uint8_t *out = buffer + used;
+    out = put16(out, RECORD_HEADER_SIZE + payloadLen);
+    out = put8(out, type);
+    out = put8(out, flags);
+    out = put32(out, now);
+    out = put32(out, p.rx_time);
+    out = put32(out, p.from);
+    out = put32(out, p.to);
+    out = put32(out, p.id);
+    out = put8(out, p.channel);
+    out = put8(out, p.hop_limit);
+    out = put8(out, p.hop_start);
+    out = put8(out, p.transport_mechanism);
+    out = put16(out, (uint16_t)(int16_t)p.rx_rssi);
+    out = put16(out, (uint16_t)(int16_t)(p.rx_snr * 4)); // Quarter dB
+    out = put8(out, p.next_hop);
+    out = put8(out, p.relay_node);
+    out = put8(out, p.priority);
+    out = put8(out, 0);
+    out = put16(out, portnum);
+    out = put16(out, payloadLen);
+
+    if (used == 0)
+        oldestUnflushedMs = now;
+    used += RECORD_HEADER_SIZE + payloadLen;
+    if (now - oldestUnflushedMs >= FLUSH_AFTER_MS)
+        flush();
+}
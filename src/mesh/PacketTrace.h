@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mesh/generated/meshtastic/mesh.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Compact binary packet trace, the replacement for writing a JSON line per packet into the trace file.
+ *
+ * A trace is a FileHeader followed by records. Every record is a fixed 40 byte RecordHeader followed by its payload:
+ * the encrypted bytes exactly as received for RECORD_RECEIVED, or the encoded meshtastic_Data for RECORD_DECODED.
+ * All integers are little endian. bin/trace-to-json.py turns a trace back into JSON lines.
+ *
+ * Records are collected in a RAM buffer and handed to the sink when it fills up or a second after the oldest
+ * unflushed record, so tracing a packet is a couple of memcpy()s rather than a JSON serialization and a file write.
+ * A thread started by begin() does the timed flush, so the tail is written on a quiet mesh too. Call end() before the
+ * sink goes away.
+ */
+class PacketTraceWriter
+{
+  public:
+    /// Receives completed chunks of the trace, e.g. a write to the trace file
+    typedef void (*Sink)(const uint8_t *data, size_t len);
+
+    enum RecordType : uint8_t { RECORD_RECEIVED = 1, RECORD_DECODED = 2 };
+
+    enum RecordFlags : uint8_t { FLAG_WANT_ACK = 1, FLAG_VIA_MQTT = 2, FLAG_PKI = 4 };
+
+    static constexpr uint32_t MAGIC = 0x3154504d; // "MPT1"
+    static constexpr size_t FILE_HEADER_SIZE = 8;  // magic, u16 header size, u16 reserved
+    static constexpr size_t RECORD_HEADER_SIZE = 40;
+
+    ~PacketTraceWriter();
+
+    /// Start tracing into sink, writes the file header. bufferSize bytes are allocated for batching.
+    void begin(Sink sink, size_t bufferSize = 4096);
+
+    bool isEnabled() const { return sink != nullptr; }
+
+    /// A packet as it came off the radio (or MQTT), before any decoding
+    void traceReceived(const meshtastic_MeshPacket &p) { append(RECORD_RECEIVED, p); }
+
+    /// A packet we managed to decrypt and decode
+    void traceDecoded(const meshtastic_MeshPacket &p) { append(RECORD_DECODED, p); }
+
+    /// Hand everything buffered to the sink
+    void flush();
+
+    /// Flush and stop tracing, e.g. before exit
+    void end();
+
+    /// Flush if the oldest buffered record has waited long enough. Called from the flush thread.
+    void flushIfDue();
+
+  private:
+    Sink sink = nullptr;
+    uint8_t *buffer = nullptr;
+    size_t bufferSize = 0;
+    size_t used = 0;
+    uint32_t oldestUnflushedMs = 0;
+
+    void append(RecordType type, const meshtastic_MeshPacket &p);
+};
+
+extern PacketTraceWriter packetTrace;
@@ -129,6 +129,9 @@ class PhoneAPI
 
     bool isConnected() { return state != STATE_SEND_NOTHING; }
 
+    /// Config download finished, FromRadio now carries mesh packets
+    bool isSendingPackets() { return state == STATE_SEND_PACKETS; }
+
   protected:
     /// Our fromradio packet while it is being assembled
     meshtastic_FromRadio fromRadioScratch = {};
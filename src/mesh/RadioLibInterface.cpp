@@ -1,3 +1,4 @@
+#define LOG_MODULE_LEVEL MESHTASTIC_LOG_MESH_LEVEL // Packet hot path, see DebugConfiguration.h
 #include "RadioLibInterface.h"
 #include "MeshTypes.h"
 #include "NodeDB.h"
@@ -0,0 +1,294 @@
+#include "RouteCache.h"
+#include <stdlib.h>
+#include <string.h>
+
+RouteCache routeCache;
+
+static bool isKnown(uint32_t num)
+{
+    return num && num != RouteCache::UNKNOWN_NODE;
+}
+
+void RouteCache::learnEdgeLocked(uint32_t from, uint32_t to, int8_t snr, uint8_t pdr, uint8_t source, uint32_t nowMs)
+{
+    if (!isKnown(from) || !isKnown(to) || from == to)
+        return;
+    Edge *slot = nullptr;
+    for (Edge &edge : edges) {
+        if (edge.from == from && edge.to == to) {
+            slot = &edge;
+            break;
+        }
+        // A free slot, else the one heard of longest ago
+        if (!slot || (slot->from && (!edge.from || nowMs - edge.updatedMs > nowMs - slot->updatedMs)))
+            slot = &edge;
+    }
+    if (slot->from != from || slot->to != to) {
+        *slot = Edge();
+        slot->from = from;
+        slot->to = to;
+        slot->snr = UNKNOWN_SNR;
+        slot->updatedMs = nowMs;
+    } else if ((int32_t)(nowMs - slot->updatedMs) < 0) {
+        // Older news than what we have, e.g. a link last heard before a traceroute over it came back
+        slot->sources |= source;
+        return;
+    }
+    if (snr != UNKNOWN_SNR)
+        slot->snr = snr;
+    if (pdr)
+        slot->pdr = pdr;
+    slot->sources |= source;
+    slot->updatedMs = nowMs;
+}
+
+void RouteCache::learnPathLocked(const Path &path, uint32_t nowMs)
+{
+    for (uint8_t i = 1; i < path.count && i < MAX_PATH; i++)
+        learnEdgeLocked(path.nodes[i - 1], path.nodes[i], path.snr[i - 1], 0, FROM_TRACEROUTE, nowMs);
+}
+
+void RouteCache::learnPath(const Path &path, uint32_t nowMs)
+{
+    Guard guard(lock);
+    learnPathLocked(path, nowMs);
+}
+
+void RouteCache::learnRoute(const Path &towards, const Path &back, uint32_t nowMs)
+{
+    if (towards.count < 2 || towards.count > MAX_PATH || back.count > MAX_PATH)
+        return;
+    Guard guard(lock);
+    learnPathLocked(towards, nowMs);
+    learnPathLocked(back, nowMs);
+
+    uint32_t dest = towards.nodes[towards.count - 1];
+    Route *slot = nullptr;
+    for (Route &route : routes) {
+        if (route.dest == dest) {
+            slot = &route;
+            break;
+        }
+        if (!slot || (slot->dest && (!route.dest || nowMs - route.learnedMs > nowMs - slot->learnedMs)))
+            slot = &route;
+    }
+    slot->dest = dest;
+    slot->learnedMs = nowMs;
+    slot->sources = FROM_TRACEROUTE;
+    slot->towards = towards;
+    slot->back = back;
+}
+
+void RouteCache::learnEdge(uint32_t from, uint32_t to, int8_t snr, uint8_t pdr, uint8_t source, uint32_t nowMs)
+{
+    Guard guard(lock);
+    learnEdgeLocked(from, to, snr, pdr, source, nowMs);
+}
+
+void RouteCache::learnLinks(const LinkTable &links, uint32_t self, uint32_t nowMs)
+{
+    const LinkTable::Link *heard[LinkTable::SLOTS];
+    size_t count = links.collect(heard, LinkTable::SLOTS, EDGE_MAX_AGE_MS / 2000, nowMs);
+    Guard guard(lock);
+    for (size_t i = 0; i < count; i++) {
+        const LinkTable::Link &link = *heard[i];
+        if (!LinkTable::isUsable(link, nowMs))
+            continue;
+        uint8_t pdr = 0;
+        if (link.deliveries >= LinkTable::MIN_SAMPLES)
+            pdr = link.pdr >= 0.005f ? (uint8_t)(link.pdr * 100 + 0.5f) : 1;
+        learnEdgeLocked(link.num, self, quarterDb(link.snr), pdr, FROM_LINK, link.lastHeardMs);
+    }
+}
+
+bool RouteCache::findPathLocked(uint32_t from, uint32_t to, uint32_t nowMs, Path &path, uint8_t &sources,
+                                uint32_t &oldestMs) const
+{
+    // Breadth first, so the first time to is reached is over the fewest hops. Each edge can reach at most one new node.
+    uint32_t reached[MAX_EDGES + 1];
+    uint8_t parent[MAX_EDGES + 1];
+    uint8_t via[MAX_EDGES + 1]; // The edge each node was reached over
+    bool reversed[MAX_EDGES + 1];
+    uint8_t depth[MAX_EDGES + 1];
+    size_t count = 1;
+    reached[0] = from;
+    depth[0] = 0;
+    for (size_t at = 0; at < count; at++) {
+        if (reached[at] == to) {
+            path.count = depth[at] + 1;
+            sources = 0;
+            oldestMs = nowMs;
+            for (size_t node = at, i = path.count - 1; i > 0; node = parent[node], i--) {
+                const Edge &edge = edges[via[node]];
+                path.nodes[i] = reached[node];
+                path.snr[i - 1] = reversed[node] ? UNKNOWN_SNR : edge.snr;
+                sources |= edge.sources;
+                if (nowMs - edge.updatedMs > nowMs - oldestMs)
+                    oldestMs = edge.updatedMs;
+            }
+            path.nodes[0] = from;
+            return true;
+        }
+        if (depth[at] + 1u >= MAX_PATH)
+            continue;
+        for (size_t e = 0; e < MAX_EDGES; e++) {
+            const Edge &edge = edges[e];
+            // LoRa links mostly work both ways, so one heard only the other way will do, with its SNR unknown
+            bool backwards = edge.to == reached[at];
+            if ((edge.from != reached[at] && !backwards) || !isUsable(edge, nowMs))
+                continue;
+            uint32_t next = backwards ? edge.from : edge.to;
+            bool seen = false;
+            for (size_t i = 0; i < count && !seen; i++)
+                seen = reached[i] == next;
+            if (seen)
+                continue;
+            reached[count] = next;
+            parent[count] = at;
+            via[count] = e;
+            reversed[count] = backwards;
+            depth[count] = depth[at] + 1;
+            count++;
+        }
+    }
+    return false;
+}
+
+bool RouteCache::lookup(uint32_t self, uint32_t dest, uint32_t nowMs, Route &out) const
+{
+    if (!isKnown(dest) || dest == self)
+        return false;
+    Guard guard(lock);
+    for (const Route &route : routes) {
+        if (route.dest == dest && nowMs - route.learnedMs <= ROUTE_MAX_AGE_MS) {
+            out = route;
+            return true;
+        }
+    }
+
+    memset(&out, 0, sizeof(out));
+    uint8_t sources;
+    uint32_t oldestMs;
+    if (!findPathLocked(self, dest, nowMs, out.towards, sources, oldestMs))
+        return nextHopLocked(self, dest, nowMs, out);
+    out.dest = dest;
+    out.sources = sources;
+    out.learnedMs = oldestMs;
+    if (findPathLocked(dest, self, nowMs, out.back, sources, oldestMs)) {
+        out.sources |= sources;
+        if (nowMs - oldestMs > nowMs - out.learnedMs)
+            out.learnedMs = oldestMs;
+    }
+    return true;
+}
+
+void RouteCache::learnNextHops(const NextHop *hops, size_t count)
+{
+    Guard guard(lock);
+    for (size_t i = 0; i < MAX_NEXT_HOPS; i++)
+        nextHops[i] = i < count ? hops[i] : NextHop();
+}
+
+bool RouteCache::nextHopLocked(uint32_t self, uint32_t dest, uint32_t nowMs, Route &out) const
+{
+    for (const NextHop &hop : nextHops) {
+        if (hop.dest != dest || nowMs - hop.heardMs > EDGE_MAX_AGE_MS || hop.hopsAway + 2u > MAX_PATH)
+            continue;
+        out.dest = dest;
+        out.learnedMs = hop.heardMs;
+        out.sources = FROM_NEXT_HOP;
+        Path &path = out.towards;
+        path.nodes[path.count++] = self;
+        if (hop.via != dest) {
+            path.nodes[path.count++] = hop.via;
+            for (uint8_t i = 1; i < hop.hopsAway; i++)
+                path.nodes[path.count++] = UNKNOWN_NODE;
+        }
+        path.nodes[path.count++] = dest;
+        for (uint8_t i = 0; i + 1 < path.count; i++)
+            path.snr[i] = UNKNOWN_SNR;
+        return true;
+    }
+    return false;
+}
+
+bool RouteCache::findEdge(uint32_t from, uint32_t to, Edge &out) const
+{
+    Guard guard(lock);
+    for (const Edge &edge : edges) {
+        if (edge.from == from && edge.to == to && from) {
+            out = edge;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RouteCache::request(uint32_t dest)
+{
+    if (!isKnown(dest))
+        return false;
+    Guard guard(lock);
+    if (queuedCount == MAX_QUEUED)
+        return false;
+    for (size_t i = 0; i < queuedCount; i++) {
+        if (queue[(queueHead + i) % MAX_QUEUED] == dest)
+            return false;
+    }
+    queue[(queueHead + queuedCount) % MAX_QUEUED] = dest;
+    queuedCount++;
+    return true;
+}
+
+bool RouteCache::takeRequest(uint32_t &dest)
+{
+    Guard guard(lock);
+    if (!queuedCount)
+        return false;
+    dest = queue[queueHead];
+    queueHead = (queueHead + 1) % MAX_QUEUED;
+    queuedCount--;
+    return true;
+}
+
+size_t RouteCache::queued() const
+{
+    Guard guard(lock);
+    return queuedCount;
+}
+
+size_t RouteCache::edgeCount() const
+{
+    Guard guard(lock);
+    size_t count = 0;
+    for (const Edge &edge : edges)
+        count += edge.from != 0;
+    return count;
+}
+
+void RouteCache::clear()
+{
+    Guard guard(lock);
+    for (Edge &edge : edges)
+        edge = Edge();
+    for (Route &route : routes)
+        route = Route();
+    for (NextHop &hop : nextHops)
+        hop = NextHop();
+    queueHead = queuedCount = 0;
+}
+
+size_t RouteCache::parseNodes(const char *text, uint32_t *out, size_t max)
+{
+    size_t count = 0;
+    while (text && *text && count < max) {
+        char *end;
+        uint32_t num = *text == '!' ? strtoul(text + 1, &end, 16) : strtoul(text, &end, 0);
+        if (isKnown(num) && (*end == ',' || !*end))
+            out[count++] = num;
+        text = strchr(text, ',');
+        if (text)
+            text++;
+    }
+    return count;
+}
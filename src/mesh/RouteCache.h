@@ -0,0 +1,237 @@
+#pragma once
+
+#include "LinkTable.h"
+#include "serialization/JSONWriter.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#ifdef ARCH_PORTDUINO
+#include <mutex>
+#endif
+
+/**
+ * Routes, and the links between nodes they are made of, as far as we have learned them without asking. "How does X reach
+ * us" is then answered from memory in microseconds instead of with a traceroute flood and its round trip.
+ *
+ * The graph is a set of directed edges, a -> b meaning b hears a, each with the SNR b heard a at and a delivery ratio where
+ * one is known. Edges come from:
+ *
+ * - every traceroute we see pass, request or response, to us or relayed (learnPath())
+ * - NeighborInfo, each neighbor a node lists being an edge from the neighbor to it, with its delivery ratio from the
+ *   LinkQuality that follows (learnEdge())
+ * - our own LinkTable (learnLinks())
+ *
+ * Routes come from the answers to our own traceroutes (learnRoute()). lookup() returns one traced within ROUTE_MAX_AGE_MS,
+ * else the path with the fewest hops through edges heard within EDGE_MAX_AGE_MS, else the next hop NodeDB has for the node
+ * (learnNextHops()), with the hops beyond it unknown.
+ *
+ * It also holds the nodes waiting to be traced (request()), which TraceRouteModule works through as the channel allows.
+ */
+class RouteCache
+{
+  public:
+    static const size_t MAX_PATH = 10; // Both ends and the 8 hops a RouteDiscovery has room for between them
+    static const size_t MAX_EDGES = 96;
+    static const size_t MAX_ROUTES = 16;
+    static const size_t MAX_QUEUED = 32;
+    static const size_t MAX_NEXT_HOPS = 32;
+    static const uint32_t ROUTE_MAX_AGE_MS = 15 * 60 * 1000UL;
+    static const uint32_t EDGE_MAX_AGE_MS = 3 * 60 * 60 * 1000UL;
+    static const uint8_t MIN_PDR = 25;               // Percent, below this an edge is not worth routing over
+    static const uint32_t UNKNOWN_NODE = 0xffffffff; // A hop that could not add itself, as RouteDiscovery has it
+    static const int8_t UNKNOWN_SNR = INT8_MIN;
+
+    enum Source : uint8_t { FROM_TRACEROUTE = 1, FROM_NEIGHBORINFO = 2, FROM_LINK = 4, FROM_NEXT_HOP = 8 };
+
+    struct Edge {
+        uint32_t from; // 0 for a free slot
+        uint32_t to;
+        uint32_t updatedMs;
+        int8_t snr;      // Quarter dB as heard by to, as in RouteDiscovery
+        uint8_t pdr;     // Percent, 0 if not known
+        uint8_t sources; // Source bits
+    };
+
+    /// Nodes in the order a packet passed them, snr[i] being what nodes[i + 1] heard nodes[i] at
+    struct Path {
+        uint8_t count;
+        uint32_t nodes[MAX_PATH];
+        int8_t snr[MAX_PATH - 1];
+    };
+
+    struct Route {
+        uint32_t dest;      // 0 for a free slot
+        uint32_t learnedMs; // When it was traced, or when its oldest edge was heard
+        uint8_t sources;    // FROM_TRACEROUTE if traced, else the sources of the edges it was pieced together from
+        Path towards;       // From us to dest
+        Path back;          // From dest to us, count 0 if not known
+    };
+
+    /// Where NextHopRouter sends packets for dest
+    struct NextHop {
+        uint32_t dest;    // 0 for a free slot
+        uint32_t via;     // One of our links, dest itself if it is one
+        uint32_t heardMs; // When via was last heard
+        uint8_t hopsAway;
+    };
+
+    /// SNR in dB as the quarter dB RouteDiscovery and Edge keep
+    static int8_t quarterDb(float snr)
+    {
+        float quarters = snr * 4;
+        return quarters <= -127 ? -127 : quarters >= 127 ? 127 : (int8_t)quarters;
+    }
+
+    /// The edges along a traceroute's path. A hop that could not add itself breaks the chain there.
+    void learnPath(const Path &path, uint32_t nowMs);
+
+    /// The answer to our own traceroute, to towards.nodes[towards.count - 1]
+    void learnRoute(const Path &towards, const Path &back, uint32_t nowMs);
+
+    /// @param snr quarter dB, UNKNOWN_SNR if not known, and pdr percent, 0 if not known
+    void learnEdge(uint32_t from, uint32_t to, int8_t snr, uint8_t pdr, uint8_t source, uint32_t nowMs);
+
+    /// An edge from every usable link we have, to self
+    void learnLinks(const LinkTable &links, uint32_t self, uint32_t nowMs);
+
+    /// Replaces the next hops lookup() falls back on, as NodeDB and LinkTable have them on the main loop
+    void learnNextHops(const NextHop *hops, size_t count);
+
+    /// A recently traced route from self to dest, else one pieced together from edges or the next hop. @return false if none
+    bool lookup(uint32_t self, uint32_t dest, uint32_t nowMs, Route &out) const;
+
+    bool findEdge(uint32_t from, uint32_t to, Edge &out) const;
+
+    /// Ask for dest to be traced. @return false if it already is queued or the queue is full
+    bool request(uint32_t dest);
+
+    /// The next node to trace, oldest request first
+    bool takeRequest(uint32_t &dest);
+
+    size_t queued() const;
+    size_t edgeCount() const;
+
+    void clear();
+
+    /// Node numbers from a comma separated list of "!a1b2c3d4", "0xa1b2c3d4" or decimal. @return how many were written to out
+    static size_t parseNodes(const char *text, uint32_t *out, size_t max);
+
+    /// The whole graph as JSON: {"edges": [...], "routes": [...], "queued": N}
+    template <typename Output> void writeTopology(JSONWriter<Output> &json, uint32_t nowMs) const
+    {
+        Guard guard(lock);
+        json.beginObject().key("edges").beginArray();
+        for (const Edge &edge : edges) {
+            if (!edge.from)
+                continue;
+            json.beginObject();
+            writeNode(json.key("from"), edge.from);
+            writeNode(json.key("to"), edge.to);
+            writeSnr(json.key("snr"), edge.snr);
+            if (edge.pdr)
+                json.key("pdr").value((int)edge.pdr);
+            else
+                json.key("pdr").null();
+            json.key("age").value((long)((nowMs - edge.updatedMs) / 1000));
+            writeSources(json, edge.sources);
+            json.endObject();
+        }
+        json.endArray().key("routes").beginArray();
+        for (const Route &route : routes) {
+            if (route.dest)
+                writeRoute(json, route, nowMs);
+        }
+        json.endArray().key("queued").value((long)queuedCount).endObject();
+    }
+
+    /// One route as JSON: to, age in seconds, sources, then the nodes and SNRs each way as RouteDiscovery names them
+    template <typename Output> static void writeRoute(JSONWriter<Output> &json, const Route &route, uint32_t nowMs)
+    {
+        json.beginObject();
+        writeNode(json.key("to"), route.dest);
+        json.key("age").value((long)((nowMs - route.learnedMs) / 1000));
+        writeSources(json, route.sources);
+        writePath(json, "towards", "snr_towards", route.towards);
+        writePath(json, "back", "snr_back", route.back);
+        json.endObject();
+    }
+
+    /// "!a1b2c3d4", or null for UNKNOWN_NODE
+    template <typename Output> static void writeNode(JSONWriter<Output> &json, uint32_t num)
+    {
+        if (num == UNKNOWN_NODE) {
+            json.null();
+            return;
+        }
+        char id[12];
+        snprintf(id, sizeof(id), "!%08x", (unsigned)num);
+        json.value(id);
+    }
+
+  private:
+#ifdef ARCH_PORTDUINO
+    // The native web server answers from its own threads. Elsewhere it runs on the main loop like everything else here.
+    mutable std::mutex lock;
+    typedef std::lock_guard<std::mutex> Guard;
+#else
+    struct NoLock {
+    };
+    struct Guard {
+        explicit Guard(NoLock &) {}
+    };
+    mutable NoLock lock;
+#endif
+
+    Edge edges[MAX_EDGES] = {};
+    Route routes[MAX_ROUTES] = {};
+    NextHop nextHops[MAX_NEXT_HOPS] = {};
+    uint32_t queue[MAX_QUEUED] = {};
+    size_t queueHead = 0, queuedCount = 0;
+
+    void learnEdgeLocked(uint32_t from, uint32_t to, int8_t snr, uint8_t pdr, uint8_t source, uint32_t nowMs);
+    void learnPathLocked(const Path &path, uint32_t nowMs);
+
+    /// Fewest hops from from to to over usable edges. @return false if there is none within MAX_PATH nodes
+    bool findPathLocked(uint32_t from, uint32_t to, uint32_t nowMs, Path &path, uint8_t &sources, uint32_t &oldestMs) const;
+
+    /// The path through dest's next hop, to an unknown node for each hop past it. @return false if none is known
+    bool nextHopLocked(uint32_t self, uint32_t dest, uint32_t nowMs, Route &out) const;
+
+    static bool isUsable(const Edge &edge, uint32_t nowMs)
+    {
+        return edge.from && nowMs - edge.updatedMs <= EDGE_MAX_AGE_MS && (!edge.pdr || edge.pdr >= MIN_PDR);
+    }
+
+    template <typename Output> static void writeSnr(JSONWriter<Output> &json, int8_t snr)
+    {
+        if (snr == UNKNOWN_SNR)
+            json.null();
+        else
+            json.value(snr / 4.0);
+    }
+
+    template <typename Output> static void writeSources(JSONWriter<Output> &json, uint8_t sources)
+    {
+        static const char *const names[] = {"traceroute", "neighborinfo", "link", "next_hop"};
+        json.key("sources").beginArray();
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (sources & (1 << i))
+                json.value(names[i]);
+        }
+        json.endArray();
+    }
+
+    template <typename Output>
+    static void writePath(JSONWriter<Output> &json, const char *nodesKey, const char *snrKey, const Path &path)
+    {
+        json.key(nodesKey).beginArray();
+        for (uint8_t i = 0; i < path.count && i < MAX_PATH; i++)
+            writeNode(json, path.nodes[i]);
+        json.endArray().key(snrKey).beginArray();
+        for (uint8_t i = 1; i < path.count && i < MAX_PATH; i++)
+            writeSnr(json, path.snr[i - 1]);
+        json.endArray();
+    }
+};
+
+extern RouteCache routeCache;
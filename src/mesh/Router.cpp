@@ -1,3 +1,4 @@
+#define LOG_MODULE_LEVEL MESHTASTIC_LOG_MESH_LEVEL // Packet hot path, see DebugConfiguration.h
 #include "Router.h"
 #include "Channels.h"
 #include "CryptoEngine.h"
@@ -16,7 +17,10 @@
 #include "mqtt/MQTT.h"
 #endif
 #include "Default.h"
+#include "compression/PayloadCodec.h"
+#include "compression/unishox2.h"
 #if ARCH_PORTDUINO
+#include "PacketTrace.h"
 #include "platform/portduino/PortduinoGlue.h"
 #endif
 #if ENABLE_JSON_LOGGING || ARCH_PORTDUINO
@@ -49,12 +53,24 @@ Allocator<meshtastic_MeshPacket> &packetPool = staticPool;
 
 static uint8_t bytes[MAX_LORA_PAYLOAD_LEN + 1] __attribute__((__aligned__));
 
+// Percent of the duty cycle each port may spend on what this node originates. The rest share what is left over.
+static const TxBudget::Share txShares[] = {
+    {meshtastic_PortNum_TEXT_MESSAGE_APP, 20}, {meshtastic_PortNum_IRRIGATION_APP, 15}, {meshtastic_PortNum_TELEMETRY_APP, 15},
+    {meshtastic_PortNum_GATE_CONTROL_APP, 10}, {meshtastic_PortNum_POSITION_APP, 10},   {meshtastic_PortNum_NODEINFO_APP, 5},
+    {meshtastic_PortNum_NEIGHBORINFO_APP, 5},  {meshtastic_PortNum_TRACEROUTE_APP, 5},  {meshtastic_PortNum_FRAGMENT_APP, 5},
+};
+
+// How often held packets are looked at while there are any
+#define HELD_POLL_MS 1000
+
 /**
  * Constructor
  *
  * Currently we only allow one interface, that may change in the future
  */
-Router::Router() : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRADIO)
+Router::Router()
+    : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRADIO),
+      txBudget(txShares, sizeof(txShares) / sizeof(txShares[0]))
 {
     // This is called pre main(), don't touch anything here, the following code is not safe
 
@@ -133,6 +149,10 @@ int32_t Router::runOnce()
         perhapsHandleReceived(mp);
     }
 
+    releaseHeld();
+    if (txBudget.heldCount())
+        return HELD_POLL_MS;
+
     // LOG_DEBUG("Sleep forever!");
     return INT32_MAX; // Wait a long time - until we get woken for the message queue
 }
@@ -210,6 +230,46 @@ void Router::abortSendAndNak(meshtastic_Routing_Error err, meshtastic_MeshPacket
     packetPool.release(p);
 }
 
+ErrorCode Router::holdForBudget(meshtastic_MeshPacket *p, uint32_t airtimeMs)
+{
+    meshtastic_MeshPacket *dropped = txBudget.hold(p, p->decoded.portnum, airtimeMs, millis());
+    if (dropped) {
+        LOG_WARN("TX budget hold of port %d full, drop 0x%08x", dropped->decoded.portnum, dropped->id);
+        packetPool.release(dropped);
+    }
+    LOG_DEBUG("Port %d waits for airtime, hold 0x%08x (%u held)", p->decoded.portnum, p->id, (unsigned)txBudget.heldCount());
+    setReceivedMessage(); // So runOnce() starts polling for it
+    return ERRNO_OK;
+}
+
+void Router::releaseHeld()
+{
+    meshtastic_MeshPacket *p;
+    bool expired;
+    while ((p = txBudget.takeReady(airTime->utilizationTXPercent(), millis(), expired)) != NULL) {
+        if (expired) {
+            LOG_WARN("0x%08x of port %d held too long for its TX budget, drop", p->id, p->decoded.portnum);
+            packetPool.release(p);
+            continue;
+        }
+        // Straight to our own send(): the subclasses have already done their part when it was first sent
+        releasingHeld = true;
+        Router::send(p);
+        releasingHeld = false;
+        break; // The hour's airtime only counts it once it has been transmitted, look again on the next poll
+    }
+}
+
+bool Router::isDuplicate(const meshtastic_MeshPacket *p)
+{
+    bool wasFallback = false, upgraded;
+    if (!wasSeenRecently(p, false, &wasFallback, nullptr, &upgraded))
+        return false;
+    // Cancelling a relay and the next hop's implicit ACK only follow a copy heard over LoRa. What is left for a copy from
+    // elsewhere: relaying on a fallback to flooding, the implicit ACK for a packet of ours, and ROUTER_LATE's late window
+    return !wasFallback && p->from != getNodeNum() && config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER_LATE;
+}
+
 void Router::setReceivedMessage()
 {
     // LOG_DEBUG("set interval to ASAP");
@@ -283,6 +343,19 @@ ErrorCode Router::send(meshtastic_MeshPacket *p)
         return meshtastic_Routing_Error_BAD_REQUEST;
     } // should have already been handled by sendLocal
 
+    // What our own modules originate waits its turn for airtime, rather than being refused below once the hour is over the
+    // duty cycle, and before it costs an allocation and encryption. Relays, routing and admin are never held.
+    if (!releasingHeld && isFromUs(p) && p->which_payload_variant == meshtastic_MeshPacket_decoded_tag &&
+        !IS_ONE_OF(p->decoded.portnum, meshtastic_PortNum_ROUTING_APP, meshtastic_PortNum_ADMIN_APP) && iface) {
+        txBudget.setDutyCycle(config.lora.override_duty_cycle ? 100 : myRegion->dutyCycle, millis());
+        if (txBudget.isActive()) {
+            uint32_t airtimeMs = iface->getPacketTime(p);
+            if (txBudget.admit(p->decoded.portnum, airtimeMs, !p->want_ack, airTime->utilizationTXPercent(), millis()) ==
+                TxBudget::HOLD)
+                return holdForBudget(p, airtimeMs);
+        }
+    }
+
     // Abort sending if we are violating the duty cycle
     if (!config.lora.override_duty_cycle && myRegion->dutyCycle < 100) {
         float hourlyTxPercent = airTime->utilizationTXPercent();
@@ -395,6 +468,94 @@ void Router::sniffReceived(const meshtastic_MeshPacket *p, const meshtastic_Rout
     // FIXME, update nodedb here for any packet that passes through us
 }
 
+// Scratch for compressing and decompressing payloads, only touched with cryptLock held
+static uint8_t payloadScratch[meshtastic_Constants_DATA_PAYLOAD_LEN];
+
+/**
+ * Undo compressPayload() on a packet we just decrypted. BITFIELD_PAYLOAD_COMPRESSED stays set on the decoded packet, also
+ * for text, so a relay compresses it again in perhapsEncode() rather than sending it on bigger than it came.
+ *
+ * @return false if it does not decompress
+ */
+static bool decompressPayload(meshtastic_MeshPacket *p)
+{
+    meshtastic_Data &d = p->decoded;
+    int length;
+    if (d.portnum == meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP) {
+        length = unishox2_decompress((const char *)d.payload.bytes, d.payload.size, (char *)payloadScratch,
+                                     sizeof(payloadScratch), USX_PSET_DFLT);
+        if (length > (int)sizeof(payloadScratch))
+            length = -1; // unishox2 says it ran out of room that way
+        d.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+        d.has_bitfield = true;
+        d.bitfield |= BITFIELD_PAYLOAD_COMPRESSED_MASK;
+    } else if (d.has_bitfield && (d.bitfield & BITFIELD_PAYLOAD_COMPRESSED_MASK)) {
+        length = PayloadCodec::decompress(d.payload.bytes, d.payload.size, payloadScratch, sizeof(payloadScratch));
+    } else {
+        return true;
+    }
+    if (length < 0)
+        return false;
+    memcpy(d.payload.bytes, payloadScratch, length);
+    d.payload.size = length;
+    return true;
+}
+
+/**
+ * Shrink the payload of a packet we are about to send. Text goes through unishox2 and moves to
+ * TEXT_MESSAGE_COMPRESSED_APP, irrigation and telemetry protobufs through PayloadCodec with BITFIELD_PAYLOAD_COMPRESSED
+ * set. Anything that does not come out smaller is sent as it was.
+ *
+ * @return whether the payload was compressed
+ */
+static bool compressPayload(meshtastic_MeshPacket *p)
+{
+    meshtastic_Data &d = p->decoded;
+    d.bitfield &= ~BITFIELD_PAYLOAD_COMPRESSED_MASK;
+    bool text = d.portnum == meshtastic_PortNum_TEXT_MESSAGE_APP;
+    if (!text && d.portnum != meshtastic_PortNum_IRRIGATION_APP && d.portnum != meshtastic_PortNum_TELEMETRY_APP)
+        return false;
+    if (d.payload.size < 2)
+        return false;
+
+    int length;
+    if (text) {
+        length = unishox2_compress((const char *)d.payload.bytes, d.payload.size, (char *)payloadScratch, d.payload.size - 1,
+                                   USX_PSET_DFLT);
+        if (length >= (int)d.payload.size)
+            length = 0; // unishox2 says it ran out of room that way
+    } else {
+        length = PayloadCodec::compress(d.payload.bytes, d.payload.size, payloadScratch, sizeof(payloadScratch));
+    }
+    if (length <= 0)
+        return false;
+
+    LOG_DEBUG("Compressed payload of port %d from %u to %d bytes", d.portnum, d.payload.size, length);
+    memcpy(d.payload.bytes, payloadScratch, length);
+    d.payload.size = length;
+    if (text)
+        d.portnum = meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP;
+    else
+        d.bitfield |= BITFIELD_PAYLOAD_COMPRESSED_MASK;
+    return true;
+}
+
+#if USERPREFS_PAYLOAD_COMPRESSION
+/**
+ * Whether everyone a packet of ours is for has told us they can decompress it, see BITFIELD_CAN_DECOMPRESS_MASK.
+ *
+ * For a broadcast that is every node heard in the last two hours (NUM_ONLINE_SECS). A stock node quiet for longer, or one
+ * that only hears us through a relay we have not heard, drops what it can't decode.
+ */
+static bool canCompressFor(const meshtastic_MeshPacket *p)
+{
+    if (isBroadcast(p->to))
+        return nodeDB->allOnlineNodesCanDecompress();
+    const meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(p->to);
+    return node && (node->bitfield & NODEINFO_BITFIELD_CAN_DECOMPRESS_MASK);
+}
+#endif
+
 DecodeState perhapsDecode(meshtastic_MeshPacket *p)
 {
     concurrency::LockGuard g(cryptLock);
@@ -489,31 +650,17 @@ DecodeState perhapsDecode(meshtastic_MeshPacket *p)
         if (p->decoded.has_bitfield)
             p->decoded.want_response |= p->decoded.bitfield & BITFIELD_WANT_RESPONSE_MASK;
 
-        /* Not actually ever used.
-        // Decompress if needed. jm
-        if (p->decoded.portnum == meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP) {
-            // Decompress the payload
-            char compressed_in[meshtastic_Constants_DATA_PAYLOAD_LEN] = {};
-            char decompressed_out[meshtastic_Constants_DATA_PAYLOAD_LEN] = {};
-            int decompressed_len;
-
-            memcpy(compressed_in, p->decoded.payload.bytes, p->decoded.payload.size);
-
-            decompressed_len = unishox2_decompress_simple(compressed_in, p->decoded.payload.size, decompressed_out);
-
-            // LOG_DEBUG("**Decompressed length - %d ", decompressed_len);
-
-            memcpy(p->decoded.payload.bytes, decompressed_out, decompressed_len);
-
-            // Switch the port from PortNum_TEXT_MESSAGE_COMPRESSED_APP to PortNum_TEXT_MESSAGE_APP
-            p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
-        } */
+        if (!decompressPayload(p)) {
+            LOG_WARN("Payload of packet id=0x%08x from 0x%x does not decompress", p->id, p->from);
+            return DecodeState::DECODE_FAILURE;
+        }
 
         printPacket("decoded message", p);
 #if ENABLE_JSON_LOGGING
         LOG_TRACE("%s", MeshPacketSerializer::JsonSerialize(p, false).c_str());
 #elif ARCH_PORTDUINO
-        if (portduino_config.traceFilename != "" || portduino_config.logoutputlevel == level_trace) {
+        packetTrace.traceDecoded(*p);
+        if (LOG_LEVEL_ENABLED(TRACE) && portduino_config.logoutputlevel == level_trace) {
             LOG_TRACE("%s", MeshPacketSerializer::JsonSerialize(p, false).c_str());
         }
 #endif
@@ -538,45 +685,19 @@ meshtastic_Routing_Error perhapsEncode(meshtastic_MeshPacket *p)
             p->decoded.has_bitfield = true;
             p->decoded.bitfield |= (config.lora.config_ok_to_mqtt << BITFIELD_OK_TO_MQTT_SHIFT);
             p->decoded.bitfield |= (p->decoded.want_response << BITFIELD_WANT_RESPONSE_SHIFT);
+            p->decoded.bitfield |= BITFIELD_CAN_DECOMPRESS_MASK;
+            p->decoded.bitfield &= ~BITFIELD_PAYLOAD_COMPRESSED_MASK;
+#if USERPREFS_PAYLOAD_COMPRESSION
+            if (canCompressFor(p))
+                compressPayload(p);
+#endif
+        } else if (p->decoded.has_bitfield && (p->decoded.bitfield & BITFIELD_PAYLOAD_COMPRESSED_MASK)) {
+            // Relaying what came in compressed, its sender already knew who can decompress it
+            compressPayload(p);
         }
 
         size_t numbytes = pb_encode_to_bytes(bytes, sizeof(bytes), &meshtastic_Data_msg, &p->decoded);
 
-        /* Not actually used, so save the cycles
-        //  TODO: Allow modules to opt into compression.
-        if (p->decoded.portnum == meshtastic_PortNum_TEXT_MESSAGE_APP) {
-
-            char original_payload[meshtastic_Constants_DATA_PAYLOAD_LEN];
-            memcpy(original_payload, p->decoded.payload.bytes, p->decoded.payload.size);
-
-            char compressed_out[meshtastic_Constants_DATA_PAYLOAD_LEN] = {0};
-
-            int compressed_len;
-            compressed_len = unishox2_compress_simple(original_payload, p->decoded.payload.size, compressed_out);
-
-            LOG_DEBUG("Original length - %d ", p->decoded.payload.size);
-            LOG_DEBUG("Compressed length - %d ", compressed_len);
-            LOG_DEBUG("Original message - %s ", p->decoded.payload.bytes);
-
-            // If the compressed length is greater than or equal to the original size, don't use the compressed form
-            if (compressed_len >= p->decoded.payload.size) {
-
-                LOG_DEBUG("Not using compressing message");
-                // Set the uncompressed payload variant anyway. Shouldn't hurt?
-                // p->decoded.which_payloadVariant = Data_payload_tag;
-
-                // Otherwise we use the compressor
-            } else {
-                LOG_DEBUG("Use compressed message");
-                // Copy the compressed data into the meshpacket
-
-                p->decoded.payload.size = compressed_len;
-                memcpy(p->decoded.payload.bytes, compressed_out, compressed_len);
-
-                p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP;
-            }
-        } */
-
         if (numbytes + MESHTASTIC_HEADER_LENGTH > MAX_LORA_PAYLOAD_LEN)
             return meshtastic_Routing_Error_TOO_LARGE;
 
@@ -745,6 +866,21 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
     packetPool.release(p_encrypted); // Release the encrypted packet
 }
 
+/** True if the frame p came in was sent by its originator, false if by a relayer */
+static bool isHeardFromOriginator(const meshtastic_MeshPacket *p)
+{
+    // A favorite router relays without spending a hop, so the relayer byte has to agree too
+    return p->hop_start != 0 && p->hop_start == p->hop_limit &&
+           (!p->relay_node || p->relay_node == LinkTable::relayByte(p->from));
+}
+
+const LinkTable::Link *Router::transmitterLink(const meshtastic_MeshPacket *p)
+{
+    if (p->transport_mechanism != meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA)
+        return nullptr;
+    return linkTable.transmitter(p->from, p->relay_node, isHeardFromOriginator(p));
+}
+
 void Router::perhapsHandleReceived(meshtastic_MeshPacket *p)
 {
 #if ENABLE_JSON_LOGGING
@@ -753,9 +889,11 @@ void Router::perhapsHandleReceived(meshtastic_MeshPacket *p)
     LOG_TRACE("%s", MeshPacketSerializer::JsonSerializeEncrypted(p).c_str());
 #elif ARCH_PORTDUINO
     // Even ignored packets get logged in the trace
-    if (portduino_config.traceFilename != "" || portduino_config.logoutputlevel == level_trace) {
+    if (packetTrace.isEnabled() || portduino_config.logoutputlevel == level_trace) {
         p->rx_time = getValidTime(RTCQualityFromNet); // store the arrival timestamp for the phone
-        LOG_TRACE("%s", MeshPacketSerializer::JsonSerializeEncrypted(p).c_str());
+        packetTrace.traceReceived(*p);
+        if (LOG_LEVEL_ENABLED(TRACE) && portduino_config.logoutputlevel == level_trace)
+            LOG_TRACE("%s", MeshPacketSerializer::JsonSerializeEncrypted(p).c_str());
     }
 #endif
     // assert(radioConfig.has_preferences);
@@ -778,6 +916,10 @@ void Router::perhapsHandleReceived(meshtastic_MeshPacket *p)
         return;
     }
 
+    // Every frame heard counts for the link it came over, duplicates included
+    if (p->transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA)
+        linkTable.heard(p->from, p->relay_node, isHeardFromOriginator(p), p->rx_snr, p->rx_rssi, millis());
+
     if (config.lora.ignore_mqtt && p->via_mqtt) {
         LOG_DEBUG("Msg came in via MQTT from 0x%x", p->from);
         packetPool.release(p);
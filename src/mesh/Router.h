@@ -1,13 +1,16 @@
 #pragma once
 
 #include "Channels.h"
+#include "LinkTable.h"
 #include "MemoryPool.h"
 #include "MeshTypes.h"
 #include "Observer.h"
 #include "PacketHistory.h"
 #include "PointerQueue.h"
 #include "RadioInterface.h"
+#include "TxBudget.h"
 #include "concurrency/OSThread.h"
+#include "mesh/generated/meshtastic/bitfield.pb.h"
 
 /**
  * A mesh aware router that supports multiple interfaces.
@@ -19,6 +22,12 @@ class Router : protected concurrency::OSThread, protected PacketHistory
     /// forwarded to the phone.
     PointerQueue<meshtastic_MeshPacket> fromRadioQueue;
 
+    /// Airtime each port may spend of the duty cycle, and what we originate that is waiting for it
+    TxBudget txBudget;
+
+    /// Set while a held packet goes back through send(), which has already charged it
+    bool releasingHeld = false;
+
   protected:
     RadioInterface *iface = NULL;
 
@@ -54,6 +63,12 @@ class Router : protected concurrency::OSThread, protected PacketHistory
     /** Attempt to find a packet in the TxQueue. Returns true if the packet was found. */
     bool findInTxQueue(NodeNum from, PacketId id);
 
+    /** For transports that bridge packets in: true if p is a copy of one we already handled that our duplicate handling would
+     * only count, so it can be dropped before it is queued. Nothing is recorded, and a copy with more hops left than before is
+     * not a duplicate. Call from the router's thread.
+     */
+    bool isDuplicate(const meshtastic_MeshPacket *p);
+
     /** Allocate and return a meshpacket which defaults as send to broadcast from the current node.
      * The returned packet is guaranteed to have a unique packet ID already assigned
      */
@@ -91,6 +106,9 @@ class Router : protected concurrency::OSThread, protected PacketHistory
         before us */
     uint32_t rxDupe = 0, txRelayCanceled = 0;
 
+    /** Per port airtime buckets, and what they held back, for LocalStats */
+    const TxBudget &getTxBudget() const { return txBudget; }
+
   protected:
     friend class RoutingModule;
 
@@ -116,6 +134,12 @@ class Router : protected concurrency::OSThread, protected PacketHistory
      */
     bool shouldDecrementHopLimit(const meshtastic_MeshPacket *p);
 
+    /** The link of whoever transmitted the frame p was heard in, nullptr if not heard over LoRa or the relayer is unknown */
+    static const LinkTable::Link *transmitterLink(const meshtastic_MeshPacket *p);
+
+    /** The SNR to time the rebroadcast of p on: the transmitter's smoothed SNR rather than this one frame's */
+    static float rebroadcastSnr(const meshtastic_MeshPacket *p) { return LinkTable::smoothedSnr(transmitterLink(p), p->rx_snr); }
+
     /**
      * Every (non duplicate) packet this node receives will be passed through this method.  This allows subclasses to
      * update routing tables etc... based on what we overhear (even for messages not destined to our node)
@@ -150,6 +174,12 @@ class Router : protected concurrency::OSThread, protected PacketHistory
 
     /** Frees the provided packet, and generates a NAK indicating the specifed error while sending */
     void abortSendAndNak(meshtastic_Routing_Error err, meshtastic_MeshPacket *p);
+
+    /** Keep a packet we originate until there is airtime for it, see TxBudget. @return ERRNO_OK */
+    ErrorCode holdForBudget(meshtastic_MeshPacket *p, uint32_t airtimeMs);
+
+    /** Send what was held and can now go, and drop what was held too long */
+    void releaseHeld();
 };
 
 enum DecodeState { DECODE_SUCCESS, DECODE_FAILURE, DECODE_FATAL };
@@ -175,3 +205,7 @@ PacketId generatePacketId();
 #define BITFIELD_OK_TO_MQTT_SHIFT 0
 #define BITFIELD_WANT_RESPONSE_MASK (1 << BITFIELD_WANT_RESPONSE_SHIFT)
 #define BITFIELD_OK_TO_MQTT_MASK (1 << BITFIELD_OK_TO_MQTT_SHIFT)
+// GateMesh's bits, claimed in bitfield.proto
+#define BITFIELD_PAYLOAD_COMPRESSED_MASK meshtastic_DataBitfield_DATA_BITFIELD_PAYLOAD_COMPRESSED
+#define BITFIELD_CAN_DECOMPRESS_MASK meshtastic_DataBitfield_DATA_BITFIELD_CAN_DECOMPRESS
+#define BITFIELD_FROM_CACHE_MASK meshtastic_DataBitfield_DATA_BITFIELD_FROM_CACHE
@@ -0,0 +1,203 @@
+#include "TxBudget.h"
+
+TxBudget::TxBudget(const Share *shares, size_t count)
+{
+    unsigned given = 0;
+    bool hasOther = false;
+    for (size_t i = 0; i < count && bucketsUsed < MAX_BUCKETS; i++) {
+        Bucket &b = buckets[bucketsUsed++];
+        b.port = shares[i].port;
+        b.percent = shares[i].percent;
+        given += b.percent;
+        hasOther |= b.port == OTHER_PORT;
+    }
+    if (!hasOther) {
+        if (bucketsUsed == MAX_BUCKETS)
+            bucketsUsed--;
+        Bucket &b = buckets[bucketsUsed++];
+        b = Bucket();
+        b.port = OTHER_PORT;
+        b.percent = given < 95 ? 100 - given : 5;
+    }
+}
+
+void TxBudget::setDutyCycle(float percent, uint32_t nowMs)
+{
+    if (percent == dutyCycle)
+        return;
+    bool wasActive = isActive();
+    dutyCycle = percent;
+    for (size_t i = 0; i < bucketsUsed; i++) {
+        Bucket &b = buckets[i];
+        // Start full, or keep what was saved up if that still fits
+        if (!wasActive || b.tokensMs > capacity(b))
+            b.tokensMs = capacity(b);
+        b.refilledMs = nowMs;
+    }
+}
+
+size_t TxBudget::bucketFor(uint16_t port) const
+{
+    size_t other = 0;
+    for (size_t i = 0; i < bucketsUsed; i++) {
+        if (buckets[i].port == port)
+            return i;
+        if (buckets[i].port == OTHER_PORT)
+            other = i;
+    }
+    return other;
+}
+
+void TxBudget::refill(Bucket &b, uint32_t nowMs)
+{
+    b.tokensMs += rate(b) * (uint32_t)(nowMs - b.refilledMs); // Wraps correctly across the millis() rollover
+    if (b.tokensMs > capacity(b))
+        b.tokensMs = capacity(b);
+    b.refilledMs = nowMs;
+}
+
+void TxBudget::spend(Bucket &b, uint32_t airtimeMs)
+{
+    b.tokensMs -= airtimeMs;
+    // However much it borrowed, a bucket is back in credit within BURST_MS
+    if (b.tokensMs < -capacity(b))
+        b.tokensMs = -capacity(b);
+}
+
+TxBudget::Verdict TxBudget::admit(uint16_t port, uint32_t airtimeMs, bool mayHold, float txPercent, uint32_t nowMs)
+{
+    if (!isActive())
+        return SEND;
+    size_t index = bucketFor(port);
+    Bucket &b = buckets[index];
+    refill(b, nowMs);
+    bool canPay = b.tokensMs >= airtimeMs;
+
+    // Nothing overtakes what its port already has waiting, and a borrower nothing another port can pay for
+    bool first = !waiting[index];
+    if (first && !canPay && heldTotal) {
+        bool heldCanPay;
+        nextInLine(nowMs, heldCanPay);
+        first = !heldCanPay;
+    }
+    if (!mayHold || (first && hasRoom(txPercent, airtimeMs + (canPay ? 0 : owed(index, nowMs))))) {
+        spend(b, airtimeMs);
+        b.sent++;
+        if (!canPay)
+            b.borrowed++;
+        return SEND;
+    }
+    b.held++;
+    return HOLD;
+}
+
+meshtastic_MeshPacket *TxBudget::hold(meshtastic_MeshPacket *p, uint16_t port, uint32_t airtimeMs, uint32_t nowMs)
+{
+    size_t index = bucketFor(port);
+    meshtastic_MeshPacket *dropped = nullptr;
+    if (waiting[index] == HOLD_PER_PORT) {
+        buckets[index].dropped++;
+        dropped = takeFront(index);
+    }
+    Held &h = held[index][waiting[index]++];
+    heldTotal++;
+    h.packet = p;
+    h.heldMs = nowMs;
+    h.airtimeMs = airtimeMs > UINT16_MAX ? UINT16_MAX : airtimeMs;
+    return dropped;
+}
+
+meshtastic_MeshPacket *TxBudget::takeFront(size_t index)
+{
+    Held *queue = held[index];
+    meshtastic_MeshPacket *p = queue[0].packet;
+    for (size_t i = 0; i + 1 < waiting[index]; i++)
+        queue[i] = queue[i + 1];
+    waiting[index]--;
+    heldTotal--;
+    return p;
+}
+
+float TxBudget::owed(size_t index, uint32_t nowMs)
+{
+    float total = 0;
+    for (size_t i = 0; i < bucketsUsed; i++) {
+        if (i == index)
+            continue;
+        refill(buckets[i], nowMs);
+        float reserve = rate(buckets[i]) * RESERVE_MS;
+        if (buckets[i].tokensMs > 0)
+            total += buckets[i].tokensMs < reserve ? buckets[i].tokensMs : reserve;
+    }
+    return total;
+}
+
+size_t TxBudget::nextInLine(uint32_t nowMs, bool &canPay)
+{
+    size_t next = MAX_BUCKETS;
+    canPay = false;
+    for (size_t i = 0; i < bucketsUsed; i++) {
+        if (!waiting[i])
+            continue;
+        refill(buckets[i], nowMs);
+        bool pays = buckets[i].tokensMs >= held[i][0].airtimeMs;
+        // The front of each queue is the oldest of its port
+        bool older = next == MAX_BUCKETS || nowMs - held[i][0].heldMs > nowMs - held[next][0].heldMs;
+        if ((pays && !canPay) || (pays == canPay && older)) {
+            next = i;
+            canPay = pays;
+        }
+    }
+    return next;
+}
+
+meshtastic_MeshPacket *TxBudget::takeReady(float txPercent, uint32_t nowMs, bool &expired)
+{
+    expired = false;
+    if (!heldTotal)
+        return nullptr;
+    for (size_t i = 0; i < bucketsUsed; i++) {
+        if (waiting[i] && nowMs - held[i][0].heldMs > MAX_HOLD_MS) {
+            buckets[i].dropped++;
+            expired = true;
+            return takeFront(i);
+        }
+    }
+
+    bool canPay;
+    size_t next = nextInLine(nowMs, canPay);
+    if (next == MAX_BUCKETS || !hasRoom(txPercent, held[next][0].airtimeMs + (canPay ? 0 : owed(next, nowMs))))
+        return nullptr;
+    Bucket &b = buckets[next];
+    if (!canPay)
+        b.borrowed++;
+    spend(b, held[next][0].airtimeMs);
+    b.sent++;
+    return takeFront(next);
+}
+
+const TxBudget::Bucket *TxBudget::mostHeld() const
+{
+    const Bucket *most = nullptr;
+    for (size_t i = 0; i < bucketsUsed; i++) {
+        if (buckets[i].held && (!most || buckets[i].held > most->held))
+            most = &buckets[i];
+    }
+    return most;
+}
+
+uint32_t TxBudget::totalHeld() const
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < bucketsUsed; i++)
+        total += buckets[i].held;
+    return total;
+}
+
+uint32_t TxBudget::totalDropped() const
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < bucketsUsed; i++)
+        total += buckets[i].dropped;
+    return total;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct _meshtastic_MeshPacket meshtastic_MeshPacket;
+
+/**
+ * Admission control for what this node originates, so one module's burst can't spend the hour's duty cycle and leave the
+ * others to be refused by the router once it is gone.
+ *
+ * Each port has a token bucket of airtime. It refills at the port's share of the region's duty cycle and holds BURST_MS
+ * worth of that. A packet its bucket can pay for goes out whenever the hour's airtime has room for it under the duty cycle.
+ * One it can't pay for borrows, the bucket going into debt for it, as long as the hour keeps room besides for what each
+ * other port has saved up, up to RESERVE_MS of its share. So a burst uses whatever airtime nobody else is about to need,
+ * and the others can still send their next few minutes' worth straight away. A borrower also waits while another port has
+ * a packet held that its bucket can pay for. A packet that can't go is held, in order in its port's own queue, until the
+ * hour has room for it (takeReady()), rather than being refused by the router. After MAX_HOLD_MS it is dropped.
+ *
+ * Packets that want an ACK are never held, as their retransmission timers are already running. They are charged all the
+ * same.
+ *
+ * Ports without a share of their own use the OTHER_PORT bucket between them.
+ */
+class TxBudget
+{
+  public:
+    static const size_t MAX_BUCKETS = 12;
+    static const size_t HOLD_PER_PORT = 16; // Each is a packet out of packetPool, as it would be in the TX queue
+    static const uint32_t BURST_MS = 10 * 60 * 1000UL;
+    static const uint32_t MAX_HOLD_MS = 10 * 60 * 1000UL; // By then what a packet says is stale
+    static const uint32_t HOUR_MS = 60 * 60 * 1000UL;     // What the router and AirTime measure the duty cycle over
+    static const uint32_t RESERVE_MS = 2 * 60 * 1000UL;   // Of each other port's earnings that a borrower leaves room for
+    static const uint16_t OTHER_PORT = 0;
+
+    struct Share {
+        uint16_t port;
+        uint8_t percent; // Of the duty cycle
+    };
+
+    struct Bucket {
+        uint16_t port;
+        uint8_t percent;
+        float tokensMs; // Airtime it can spend, negative while in debt
+        uint32_t refilledMs;
+        uint32_t sent;     // Admitted, straight away or once held
+        uint32_t borrowed; // Of those, sent while the bucket could not pay
+        uint32_t held;
+        uint32_t dropped; // Held too long, or pushed out by a newer one of the same port
+    };
+
+    enum Verdict { SEND, HOLD };
+
+    /// Ports other than those in shares use the OTHER_PORT bucket, whose share is what is left of 100% if not given
+    TxBudget(const Share *shares, size_t count);
+
+    /// @param percent the region's duty cycle, 100 or more if there is none, which turns admission control off
+    void setDutyCycle(float percent, uint32_t nowMs);
+
+    bool isActive() const { return dutyCycle < 100; }
+
+    /**
+     * Charge a packet to its port's bucket.
+     *
+     * @param txPercent our airtime over the last hour as a percentage, AirTime::utilizationTXPercent()
+     * @param mayHold false for a packet that must go now. It is charged and sent whatever its bucket holds.
+     * @return HOLD if the packet must wait for hold()
+     */
+    Verdict admit(uint16_t port, uint32_t airtimeMs, bool mayHold, float txPercent, uint32_t nowMs);
+
+    /**
+     * Keep a packet that admit() said to hold, at the back of its port's queue. When that is full it replaces the oldest
+     * packet in it, as a newer reading is worth more than an older one. Other ports' queues are never touched.
+     *
+     * @return the packet it replaced, for the caller to release, else nullptr
+     */
+    meshtastic_MeshPacket *hold(meshtastic_MeshPacket *p, uint16_t port, uint32_t airtimeMs, uint32_t nowMs);
+
+    /**
+     * The next held packet to deal with. Either the hour has room for it and no port ahead of it in line, or it has been held
+     * too long.
+     *
+     * @param expired set for a packet held too long, which is to be dropped
+     * @return nullptr if there is none
+     */
+    meshtastic_MeshPacket *takeReady(float txPercent, uint32_t nowMs, bool &expired);
+
+    size_t heldCount() const { return heldTotal; }
+
+    size_t bucketCount() const { return bucketsUsed; }
+    const Bucket &bucket(size_t i) const { return buckets[i]; }
+
+    /// The bucket that has had to hold the most packets, nullptr if none has held any
+    const Bucket *mostHeld() const;
+
+    uint32_t totalHeld() const;
+    uint32_t totalDropped() const;
+
+  private:
+    struct Held {
+        meshtastic_MeshPacket *packet;
+        uint32_t heldMs;
+        uint16_t airtimeMs;
+    };
+
+    Bucket buckets[MAX_BUCKETS] = {};
+    size_t bucketsUsed = 0;
+    Held held[MAX_BUCKETS][HOLD_PER_PORT] = {}; // Per bucket, in the order they were held
+    uint8_t waiting[MAX_BUCKETS] = {};
+    size_t heldTotal = 0;
+    float dutyCycle = 100;
+
+    size_t bucketFor(uint16_t port) const;
+    float capacity(const Bucket &b) const { return rate(b) * BURST_MS; }
+    float rate(const Bucket &b) const { return dutyCycle * b.percent / (100.0f * 100.0f); } // Airtime ms per ms
+    void refill(Bucket &b, uint32_t nowMs);
+    void spend(Bucket &b, uint32_t airtimeMs);
+    bool hasRoom(float txPercent, float airtimeMs) const { return (dutyCycle - txPercent) * HOUR_MS / 100 >= airtimeMs; }
+
+    /// The bucket whose held packet goes next: the longest waiting of those that can pay, else of all. MAX_BUCKETS if none.
+    size_t nextInLine(uint32_t nowMs, bool &canPay);
+    meshtastic_MeshPacket *takeFront(size_t index);
+
+    /// Airtime the other buckets have saved up, up to RESERVE_MS worth each, refilling them first
+    float owed(size_t index, uint32_t nowMs);
+};
@@ -0,0 +1,210 @@
+#include "PayloadCodec.h"
+#include <string.h>
+
+namespace PayloadCodec
+{
+
+namespace
+{
+
+const uint8_t LITERAL_MAX = 128, COPY_MIN = 3, COPY_MAX = 66, PHRASE_MAX = 7;
+const size_t DISTANCE_MAX = 256;
+
+struct Phrase {
+    uint8_t length;
+    uint8_t bytes[PHRASE_MAX];
+};
+
+// Printed by test/test_PayloadCodec.cpp train, with what each saved over four days of traffic from our test field
+const Phrase PHRASES[] = {
+    {2, {0x18, 0x02}}, // saves 32650
+    {5, {0x1a, 0x0b, 0x08, 0x0c, 0x10}}, // saves 27648
+    {3, {0x1a, 0x06, 0x08}}, // saves 24242
+    {3, {0x08, 0x0a, 0x10}}, // saves 23040
+    {2, {0x3f, 0x58}}, // saves 8016
+    {2, {0x3f, 0x52}}, // saves 8005
+    {3, {0x12, 0x15, 0x08}}, // saves 7776
+    {7, {0x65, 0x15, 0x00, 0x00, 0x00, 0x00, 0x1d}}, // saves 7332
+    {3, {0x1a, 0x0b, 0x08}}, // saves 6048
+    {3, {0x18, 0x04, 0x20}}, // saves 3838
+    {2, {0x40, 0x1d}}, // saves 3659
+    {2, {0x40, 0x58}}, // saves 3560
+    {2, {0x40, 0x52}}, // saves 3553
+    {2, {0x10, 0x03}}, // saves 3473
+    {2, {0x41, 0x25}}, // saves 3294
+    {3, {0x1a, 0x08, 0x08}}, // saves 3022
+    {2, {0x10, 0x07}}, // saves 2892
+    {2, {0x10, 0x05}}, // saves 2615
+    {2, {0x10, 0x04}}, // saves 2610
+    {2, {0x3f, 0x28}}, // saves 2576
+    {6, {0x9d, 0x01, 0x00, 0x00, 0x00, 0x00}}, // saves 2535
+    {2, {0x10, 0x02}}, // saves 2523
+    {2, {0x1a, 0x1f}}, // saves 2351
+    {2, {0x1a, 0x2f}}, // saves 2349
+    {2, {0x1a, 0x2b}}, // saves 2297
+    {2, {0x1a, 0x27}}, // saves 2284
+    {2, {0x1a, 0x23}}, // saves 2258
+    {3, {0x12, 0x14, 0x08}}, // saves 1816
+    {2, {0x40, 0x28}}, // saves 1707
+    {2, {0x10, 0x01}}, // saves 1643
+    {2, {0x40, 0x25}}, // saves 1185
+    {2, {0x10, 0x06}}, // saves 1167
+    {3, {0x12, 0x08, 0x08}}, // saves 966
+    {2, {0x18, 0x03}}, // saves 954
+    {2, {0x10, 0x08}}, // saves 889
+    {3, {0x28, 0x01, 0x35}}, // saves 864
+    {3, {0x12, 0x0d, 0x08}}, // saves 824
+    {2, {0x02, 0x40}}, // saves 769
+    {3, {0x1a, 0x1d, 0x0d}}, // saves 744
+    {2, {0x06, 0x40}}, // saves 727
+    {2, {0x00, 0x40}}, // saves 681
+    {2, {0x09, 0x40}}, // saves 661
+    {2, {0x04, 0x40}}, // saves 648
+    {4, {0x1a, 0x12, 0x08, 0x03}}, // saves 648
+    {4, {0x1a, 0x14, 0x08, 0x16}}, // saves 648
+    {2, {0x3e, 0x28}}, // saves 596
+    {2, {0x41, 0x15}}, // saves 585
+    {2, {0x05, 0x40}}, // saves 581
+    {2, {0x44, 0x68}}, // saves 576
+    {4, {0x1a, 0x0d, 0x08, 0x1e}}, // saves 576
+    {2, {0x08, 0x40}}, // saves 571
+    {2, {0xcf, 0x3f}}, // saves 571
+    {2, {0x01, 0x40}}, // saves 568
+    {2, {0x0a, 0x40}}, // saves 489
+    {2, {0xce, 0x3f}}, // saves 486
+    {2, {0x0b, 0x40}}, // saves 481
+    {2, {0x42, 0x1d}}, // saves 474
+    {2, {0xcc, 0x3f}}, // saves 462
+    {2, {0xcd, 0x3f}}, // saves 462
+    {2, {0x03, 0x40}}, // saves 443
+    {2, {0x07, 0x40}}, // saves 440
+    {2, {0xe4, 0x3f}}, // saves 433
+    {2, {0xca, 0x3f}}, // saves 432
+    {2, {0x16, 0x40}}, // saves 429
+};
+const size_t PHRASE_COUNT = sizeof(PHRASES) / sizeof(PHRASES[0]);
+static_assert(PHRASE_COUNT <= 64, "Only 64 phrases fit in a control byte");
+
+struct Output {
+    uint8_t *bytes;
+    size_t size, length;
+
+    bool put(uint8_t b)
+    {
+        if (length >= size)
+            return false;
+        bytes[length++] = b;
+        return true;
+    }
+};
+
+bool flushLiterals(Output &out, const uint8_t *literals, size_t &count)
+{
+    if (!count)
+        return true;
+    if (out.length + 1 + count > out.size)
+        return false;
+    out.bytes[out.length++] = count - 1;
+    memcpy(out.bytes + out.length, literals, count);
+    out.length += count;
+    count = 0;
+    return true;
+}
+
+} // namespace
+
+size_t compress(const uint8_t *in, size_t length, uint8_t *out, size_t outSize)
+{
+    if (length < 2)
+        return 0;
+    // Only worth sending if it saves at least a byte
+    Output o = {out, outSize < length - 1 ? outSize : length - 1, 0};
+
+    size_t pos = 0, literals = 0;
+    while (pos < length) {
+        size_t remaining = length - pos;
+        int bestSaving = 0, bestPhrase = -1;
+        size_t bestLength = 0, bestDistance = 0;
+
+        for (size_t i = 0; i < PHRASE_COUNT; i++) {
+            const Phrase &phrase = PHRASES[i];
+            if (phrase.length - 1 > bestSaving && phrase.length <= remaining &&
+                memcmp(phrase.bytes, in + pos, phrase.length) == 0) {
+                bestSaving = phrase.length - 1;
+                bestPhrase = i;
+            }
+        }
+
+        // Copies may overlap what they produce, as in any LZ77
+        size_t maxCopy = remaining < COPY_MAX ? remaining : COPY_MAX;
+        for (size_t distance = 1; distance <= pos && distance <= DISTANCE_MAX; distance++) {
+            const uint8_t *from = in + pos - distance;
+            size_t n = 0;
+            while (n < maxCopy && from[n] == in[pos + n])
+                n++;
+            if (n >= COPY_MIN && (int)n - 2 > bestSaving) {
+                bestSaving = n - 2;
+                bestPhrase = -1;
+                bestLength = n;
+                bestDistance = distance;
+            }
+        }
+
+        if (bestSaving <= 0) {
+            literals++;
+            pos++;
+            if (literals == LITERAL_MAX && !flushLiterals(o, in + pos - literals, literals))
+                return 0;
+            continue;
+        }
+
+        if (!flushLiterals(o, in + pos - literals, literals))
+            return 0;
+        if (bestPhrase >= 0) {
+            if (!o.put(0xc0 | bestPhrase))
+                return 0;
+            pos += PHRASES[bestPhrase].length;
+        } else {
+            if (!o.put(0x80 | (bestLength - COPY_MIN)) || !o.put(bestDistance - 1))
+                return 0;
+            pos += bestLength;
+        }
+    }
+    if (!flushLiterals(o, in + pos - literals, literals))
+        return 0;
+    return o.length;
+}
+
+int decompress(const uint8_t *in, size_t length, uint8_t *out, size_t outSize)
+{
+    size_t i = 0, o = 0;
+    while (i < length) {
+        uint8_t c = in[i++];
+        if (c < 0x80) {
+            size_t n = c + 1;
+            if (n > length - i || n > outSize - o)
+                return -1;
+            memcpy(out + o, in + i, n);
+            i += n;
+            o += n;
+        } else if (c < 0xc0) {
+            size_t n = (c & 0x3f) + COPY_MIN;
+            if (i >= length)
+                return -1;
+            size_t distance = in[i++] + 1;
+            if (distance > o || n > outSize - o)
+                return -1;
+            for (size_t k = 0; k < n; k++, o++)
+                out[o] = out[o - distance];
+        } else {
+            size_t p = c & 0x3f;
+            if (p >= PHRASE_COUNT || PHRASES[p].length > outSize - o)
+                return -1;
+            memcpy(out + o, PHRASES[p].bytes, PHRASES[p].length);
+            o += PHRASES[p].length;
+        }
+    }
+    return o;
+}
+
+} // namespace PayloadCodec
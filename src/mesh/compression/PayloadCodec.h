@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A small LZ-style coder for the protobufs our nodes send most: irrigation reports, commands and acks, and telemetry.
+ *
+ * Those payloads are a few dozen bytes, too short for a general purpose compressor to find much to reuse, but their field
+ * tags and common values come in the same order every time. So besides copying from earlier in the payload, the coder has a
+ * static table of such phrases, found by counting substrings over days of our field's traffic (see test/test_PayloadCodec.cpp),
+ * and naming one costs a single byte.
+ *
+ * Each token starts with a control byte c:
+ *   0x00-0x7f  c + 1 literal bytes follow
+ *   0x80-0xbf  copy (c & 0x3f) + 3 bytes from d + 1 bytes back, d is the next byte
+ *   0xc0-0xff  phrase c & 0x3f from the table
+ *
+ * The table is part of the wire format, so it must not change once nodes carry it.
+ */
+namespace PayloadCodec
+{
+
+/// @return the compressed length, 0 if it would not be shorter than the input or fit in outSize
+size_t compress(const uint8_t *in, size_t length, uint8_t *out, size_t outSize);
+
+/// @return the decompressed length, -1 if the input is corrupt or would not fit in outSize
+int decompress(const uint8_t *in, size_t length, uint8_t *out, size_t outSize);
+
+} // namespace PayloadCodec
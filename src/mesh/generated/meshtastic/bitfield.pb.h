@@ -0,0 +1,56 @@
+/* Automatically generated nanopb header */
+/* Generated by nanopb-0.4.9.1 */
+
+#ifndef PB_MESHTASTIC_MESHTASTIC_BITFIELD_PB_H_INCLUDED
+#define PB_MESHTASTIC_MESHTASTIC_BITFIELD_PB_H_INCLUDED
+#include <pb.h>
+
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+/* Enum definitions */
+/* The bits GateMesh claims in upstream bitfields.
+ Upstream's Data.bitfield only assigns bit 0 (ok to MQTT) and bit 1 (want
+ response), NodeInfoLite.bitfield only bit 0 (key manually verified). Nodes
+ without GateMesh ignore the bits they don't know. Claim new bits here, so
+ they are checked against upstream's in one place when protos are merged. */
+typedef enum _meshtastic_DataBitfield {
+    meshtastic_DataBitfield_DATA_BITFIELD_NONE = 0,
+    /* The payload went through PayloadCodec. Once decoded, that it came
+ compressed, text included, so a relay compresses it again. */
+    meshtastic_DataBitfield_DATA_BITFIELD_PAYLOAD_COMPRESSED = 4,
+    /* The sender can decompress payloads, so we may compress what we send it */
+    meshtastic_DataBitfield_DATA_BITFIELD_CAN_DECOMPRESS = 8,
+    /* Not from the sender: made up by our own node from what it remembers, like
+ a traceroute answered from the route cache. Only ever sent to the phone. */
+    meshtastic_DataBitfield_DATA_BITFIELD_FROM_CACHE = 16
+} meshtastic_DataBitfield;
+
+/* Kept on flash in NodeInfoLite.bitfield, never sent */
+typedef enum _meshtastic_NodeInfoBitfield {
+    meshtastic_NodeInfoBitfield_NODE_INFO_BITFIELD_NONE = 0,
+    /* The node's packets carried DATA_BITFIELD_CAN_DECOMPRESS */
+    meshtastic_NodeInfoBitfield_NODE_INFO_BITFIELD_CAN_DECOMPRESS = 2
+} meshtastic_NodeInfoBitfield;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Helper constants for enums */
+#define _meshtastic_DataBitfield_MIN meshtastic_DataBitfield_DATA_BITFIELD_NONE
+#define _meshtastic_DataBitfield_MAX meshtastic_DataBitfield_DATA_BITFIELD_FROM_CACHE
+#define _meshtastic_DataBitfield_ARRAYSIZE ((meshtastic_DataBitfield)(meshtastic_DataBitfield_DATA_BITFIELD_FROM_CACHE+1))
+
+#define _meshtastic_NodeInfoBitfield_MIN meshtastic_NodeInfoBitfield_NODE_INFO_BITFIELD_NONE
+#define _meshtastic_NodeInfoBitfield_MAX meshtastic_NodeInfoBitfield_NODE_INFO_BITFIELD_CAN_DECOMPRESS
+#define _meshtastic_NodeInfoBitfield_ARRAYSIZE ((meshtastic_NodeInfoBitfield)(meshtastic_NodeInfoBitfield_NODE_INFO_BITFIELD_CAN_DECOMPRESS+1))
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+/* Automatically generated nanopb constant definitions */
+/* Generated by nanopb-0.4.9.1 */
+
+#include "meshtastic/gate_control.pb.h"
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+PB_BIND(meshtastic_GateControl, meshtastic_GateControl, 2)
+
+
+PB_BIND(meshtastic_GateStatus, meshtastic_GateStatus, AUTO)
+
+
+PB_BIND(meshtastic_AccessControl, meshtastic_AccessControl, AUTO)
+
+
+PB_BIND(meshtastic_AccessControl_User, meshtastic_AccessControl_User, AUTO)
+
+
+PB_BIND(meshtastic_GateSchedule, meshtastic_GateSchedule, 2)
+
+
+PB_BIND(meshtastic_GateSchedule_Event, meshtastic_GateSchedule_Event, AUTO)
+
+
+PB_BIND(meshtastic_GateConfig, meshtastic_GateConfig, AUTO)
+
+
+PB_BIND(meshtastic_GateAuditLog, meshtastic_GateAuditLog, AUTO)
+
+
+PB_BIND(meshtastic_GateAuditBatch, meshtastic_GateAuditBatch, AUTO)
+
+
+
+
+
+
+
+
+
+
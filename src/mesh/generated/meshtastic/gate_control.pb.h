@@ -0,0 +1,399 @@
+/* Automatically generated nanopb header */
+/* Generated by nanopb-0.4.9.1 */
+
+#ifndef PB_MESHTASTIC_MESHTASTIC_GATE_CONTROL_PB_H_INCLUDED
+#define PB_MESHTASTIC_MESHTASTIC_GATE_CONTROL_PB_H_INCLUDED
+#include <pb.h>
+#include "meshtastic/channel.pb.h"
+
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+/* Enum definitions */
+typedef enum _meshtastic_GateControl_Command {
+    meshtastic_GateControl_Command_UNSET = 0,
+    meshtastic_GateControl_Command_OPEN = 1,
+    meshtastic_GateControl_Command_CLOSE = 2,
+    meshtastic_GateControl_Command_STOP = 3,
+    meshtastic_GateControl_Command_STATUS_REQUEST = 4,
+    meshtastic_GateControl_Command_LOCK = 5,
+    meshtastic_GateControl_Command_UNLOCK = 6,
+    meshtastic_GateControl_Command_CALIBRATE = 7,
+    meshtastic_GateControl_Command_AUDIT_REQUEST = 8 /* Upload the audit log entries not yet acknowledged */
+} meshtastic_GateControl_Command;
+
+typedef enum _meshtastic_GateStatus_State {
+    meshtastic_GateStatus_State_UNKNOWN = 0,
+    meshtastic_GateStatus_State_CLOSED = 1,
+    meshtastic_GateStatus_State_OPENING = 2,
+    meshtastic_GateStatus_State_OPEN = 3,
+    meshtastic_GateStatus_State_CLOSING = 4,
+    meshtastic_GateStatus_State_ERROR = 5,
+    meshtastic_GateStatus_State_BLOCKED = 6,
+    meshtastic_GateStatus_State_LOCKED = 7,
+    meshtastic_GateStatus_State_OFFLINE = 8
+} meshtastic_GateStatus_State;
+
+typedef enum _meshtastic_GateSchedule_Event_Action {
+    meshtastic_GateSchedule_Event_Action_OPEN = 0,
+    meshtastic_GateSchedule_Event_Action_CLOSE = 1,
+    meshtastic_GateSchedule_Event_Action_LOCK = 2,
+    meshtastic_GateSchedule_Event_Action_UNLOCK = 3
+} meshtastic_GateSchedule_Event_Action;
+
+/* Struct definitions */
+/* Gate status report */
+typedef struct _meshtastic_GateStatus {
+    uint32_t gate_id;
+    meshtastic_GateStatus_State state;
+    uint32_t position_percent;
+    float battery_voltage;
+    int32_t temperature_c;
+    uint32_t cycle_count;
+    uint32_t error_code;
+    char error_message[40];
+    uint64_t last_opened;
+    uint64_t last_closed;
+    bool manual_override;
+    int32_t motor_current_ma;
+} meshtastic_GateStatus;
+
+typedef PB_BYTES_ARRAY_T(32) meshtastic_AccessControl_User_pin_hash_t;
+typedef PB_BYTES_ARRAY_T(16) meshtastic_AccessControl_User_pin_salt_t;
+typedef struct _meshtastic_AccessControl_User {
+    uint32_t node_id;
+    char name[16];
+    uint32_t access_level;
+    uint64_t valid_from;
+    uint64_t valid_until;
+    pb_size_t allowed_gates_count;
+    uint32_t allowed_gates[4];
+    meshtastic_AccessControl_User_pin_hash_t pin_hash; /* SHA-256 of the PIN followed by pin_salt */
+    meshtastic_AccessControl_User_pin_salt_t pin_salt; /* Random, chosen by the controller for each user */
+} meshtastic_AccessControl_User;
+
+/* Access control. Lists larger than one packet are sent in several
+ AccessControl messages; gate nodes merge users by node_id. */
+typedef struct _meshtastic_AccessControl {
+    pb_size_t users_count;
+    meshtastic_AccessControl_User users[2];
+    bool require_auth;
+    bool log_access;
+} meshtastic_AccessControl;
+
+typedef struct _meshtastic_GateSchedule_Event {
+    meshtastic_GateSchedule_Event_Action action;
+    uint32_t hour;
+    uint32_t minute;
+    pb_size_t days_of_week_count;
+    uint32_t days_of_week[7]; /* 0=Sun, 6=Sat */
+    bool enabled;
+} meshtastic_GateSchedule_Event;
+
+/* Scheduling */
+typedef struct _meshtastic_GateSchedule {
+    pb_size_t events_count;
+    meshtastic_GateSchedule_Event events[8];
+    char timezone[32];
+} meshtastic_GateSchedule;
+
+/* Gate configuration */
+typedef struct _meshtastic_GateConfig {
+    uint32_t gate_id;
+    char name[24];
+    uint32_t open_time_ms; /* Max time to open */
+    uint32_t close_time_ms; /* Max time to close */
+    uint32_t auto_close_delay_ms;
+    uint32_t obstruction_current_ma;
+    bool safety_beam_enabled;
+    bool auto_close_enabled;
+    float latitude;
+    float longitude;
+    char address[48];
+} meshtastic_GateConfig;
+
+/* Audit log entry */
+typedef struct _meshtastic_GateAuditLog {
+    uint64_t timestamp;
+    uint32_t gate_id;
+    uint32_t user_id;
+    char action[12];
+    bool success;
+    char details[16];
+} meshtastic_GateAuditLog;
+
+/* Batch of audit entries uploaded in response to AUDIT_REQUEST */
+typedef struct _meshtastic_GateAuditBatch {
+    pb_size_t entries_count;
+    meshtastic_GateAuditLog entries[3];
+    uint32_t remaining; /* Entries still queued on the gate after this batch */
+} meshtastic_GateAuditBatch;
+
+typedef PB_BYTES_ARRAY_T(16) meshtastic_GateControl_auth_token_t;
+/* Gate control messages */
+typedef struct _meshtastic_GateControl {
+    meshtastic_GateControl_Command command;
+    uint32_t gate_id;
+    meshtastic_GateControl_auth_token_t auth_token; /* The sender's PIN, checked against its AccessControl.User.pin_hash */
+    pb_size_t which_variant;
+    union {
+        meshtastic_GateStatus status;
+        meshtastic_GateSchedule schedule;
+        meshtastic_AccessControl access;
+        meshtastic_GateConfig config;
+        meshtastic_GateAuditBatch audit;
+    } variant;
+} meshtastic_GateControl;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Helper constants for enums */
+#define _meshtastic_GateControl_Command_MIN meshtastic_GateControl_Command_UNSET
+#define _meshtastic_GateControl_Command_MAX meshtastic_GateControl_Command_AUDIT_REQUEST
+#define _meshtastic_GateControl_Command_ARRAYSIZE ((meshtastic_GateControl_Command)(meshtastic_GateControl_Command_AUDIT_REQUEST+1))
+
+#define _meshtastic_GateStatus_State_MIN meshtastic_GateStatus_State_UNKNOWN
+#define _meshtastic_GateStatus_State_MAX meshtastic_GateStatus_State_OFFLINE
+#define _meshtastic_GateStatus_State_ARRAYSIZE ((meshtastic_GateStatus_State)(meshtastic_GateStatus_State_OFFLINE+1))
+
+#define _meshtastic_GateSchedule_Event_Action_MIN meshtastic_GateSchedule_Event_Action_OPEN
+#define _meshtastic_GateSchedule_Event_Action_MAX meshtastic_GateSchedule_Event_Action_UNLOCK
+#define _meshtastic_GateSchedule_Event_Action_ARRAYSIZE ((meshtastic_GateSchedule_Event_Action)(meshtastic_GateSchedule_Event_Action_UNLOCK+1))
+
+#define meshtastic_GateControl_command_ENUMTYPE meshtastic_GateControl_Command
+
+#define meshtastic_GateStatus_state_ENUMTYPE meshtastic_GateStatus_State
+
+
+
+
+#define meshtastic_GateSchedule_Event_action_ENUMTYPE meshtastic_GateSchedule_Event_Action
+
+
+
+
+
+
+/* Initializer values for message structs */
+#define meshtastic_GateControl_init_default      {_meshtastic_GateControl_Command_MIN, 0, {0, {0}}, 0, {meshtastic_GateStatus_init_default}}
+#define meshtastic_GateStatus_init_default       {0, _meshtastic_GateStatus_State_MIN, 0, 0, 0, 0, 0, "", 0, 0, 0, 0}
+#define meshtastic_AccessControl_init_default    {0, {meshtastic_AccessControl_User_init_default, meshtastic_AccessControl_User_init_default}, 0, 0}
+#define meshtastic_AccessControl_User_init_default {0, "", 0, 0, 0, 0, {0, 0, 0, 0}, {0, {0}}, {0, {0}}}
+#define meshtastic_GateSchedule_init_default     {0, {meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default, meshtastic_GateSchedule_Event_init_default}, ""}
+#define meshtastic_GateSchedule_Event_init_default {_meshtastic_GateSchedule_Event_Action_MIN, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0}, 0}
+#define meshtastic_GateConfig_init_default       {0, "", 0, 0, 0, 0, 0, 0, 0, 0, ""}
+#define meshtastic_GateAuditLog_init_default     {0, 0, 0, "", 0, ""}
+#define meshtastic_GateAuditBatch_init_default   {0, {meshtastic_GateAuditLog_init_default, meshtastic_GateAuditLog_init_default, meshtastic_GateAuditLog_init_default}, 0}
+#define meshtastic_GateControl_init_zero         {_meshtastic_GateControl_Command_MIN, 0, {0, {0}}, 0, {meshtastic_GateStatus_init_zero}}
+#define meshtastic_GateStatus_init_zero          {0, _meshtastic_GateStatus_State_MIN, 0, 0, 0, 0, 0, "", 0, 0, 0, 0}
+#define meshtastic_AccessControl_init_zero       {0, {meshtastic_AccessControl_User_init_zero, meshtastic_AccessControl_User_init_zero}, 0, 0}
+#define meshtastic_AccessControl_User_init_zero  {0, "", 0, 0, 0, 0, {0, 0, 0, 0}, {0, {0}}, {0, {0}}}
+#define meshtastic_GateSchedule_init_zero        {0, {meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero, meshtastic_GateSchedule_Event_init_zero}, ""}
+#define meshtastic_GateSchedule_Event_init_zero  {_meshtastic_GateSchedule_Event_Action_MIN, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0}, 0}
+#define meshtastic_GateConfig_init_zero          {0, "", 0, 0, 0, 0, 0, 0, 0, 0, ""}
+#define meshtastic_GateAuditLog_init_zero        {0, 0, 0, "", 0, ""}
+#define meshtastic_GateAuditBatch_init_zero      {0, {meshtastic_GateAuditLog_init_zero, meshtastic_GateAuditLog_init_zero, meshtastic_GateAuditLog_init_zero}, 0}
+
+/* Field tags (for use in manual encoding/decoding) */
+#define meshtastic_GateStatus_gate_id_tag        1
+#define meshtastic_GateStatus_state_tag          2
+#define meshtastic_GateStatus_position_percent_tag 3
+#define meshtastic_GateStatus_battery_voltage_tag 4
+#define meshtastic_GateStatus_temperature_c_tag  5
+#define meshtastic_GateStatus_cycle_count_tag    6
+#define meshtastic_GateStatus_error_code_tag     7
+#define meshtastic_GateStatus_error_message_tag  8
+#define meshtastic_GateStatus_last_opened_tag    9
+#define meshtastic_GateStatus_last_closed_tag    10
+#define meshtastic_GateStatus_manual_override_tag 11
+#define meshtastic_GateStatus_motor_current_ma_tag 12
+#define meshtastic_AccessControl_User_node_id_tag 1
+#define meshtastic_AccessControl_User_name_tag   2
+#define meshtastic_AccessControl_User_access_level_tag 3
+#define meshtastic_AccessControl_User_valid_from_tag 4
+#define meshtastic_AccessControl_User_valid_until_tag 5
+#define meshtastic_AccessControl_User_allowed_gates_tag 6
+#define meshtastic_AccessControl_User_pin_hash_tag 7
+#define meshtastic_AccessControl_User_pin_salt_tag 8
+#define meshtastic_AccessControl_users_tag       1
+#define meshtastic_AccessControl_require_auth_tag 2
+#define meshtastic_AccessControl_log_access_tag  3
+#define meshtastic_GateSchedule_Event_action_tag 1
+#define meshtastic_GateSchedule_Event_hour_tag   2
+#define meshtastic_GateSchedule_Event_minute_tag 3
+#define meshtastic_GateSchedule_Event_days_of_week_tag 4
+#define meshtastic_GateSchedule_Event_enabled_tag 5
+#define meshtastic_GateSchedule_events_tag       1
+#define meshtastic_GateSchedule_timezone_tag     2
+#define meshtastic_GateConfig_gate_id_tag        1
+#define meshtastic_GateConfig_name_tag           2
+#define meshtastic_GateConfig_open_time_ms_tag   3
+#define meshtastic_GateConfig_close_time_ms_tag  4
+#define meshtastic_GateConfig_auto_close_delay_ms_tag 5
+#define meshtastic_GateConfig_obstruction_current_ma_tag 6
+#define meshtastic_GateConfig_safety_beam_enabled_tag 7
+#define meshtastic_GateConfig_auto_close_enabled_tag 8
+#define meshtastic_GateConfig_latitude_tag       9
+#define meshtastic_GateConfig_longitude_tag      10
+#define meshtastic_GateConfig_address_tag        11
+#define meshtastic_GateAuditLog_timestamp_tag    1
+#define meshtastic_GateAuditLog_gate_id_tag      2
+#define meshtastic_GateAuditLog_user_id_tag      3
+#define meshtastic_GateAuditLog_action_tag       4
+#define meshtastic_GateAuditLog_success_tag      5
+#define meshtastic_GateAuditLog_details_tag      6
+#define meshtastic_GateAuditBatch_entries_tag    1
+#define meshtastic_GateAuditBatch_remaining_tag  2
+#define meshtastic_GateControl_command_tag       1
+#define meshtastic_GateControl_gate_id_tag       2
+#define meshtastic_GateControl_auth_token_tag    3
+#define meshtastic_GateControl_status_tag        4
+#define meshtastic_GateControl_schedule_tag      5
+#define meshtastic_GateControl_access_tag        6
+#define meshtastic_GateControl_config_tag        7
+#define meshtastic_GateControl_audit_tag         8
+
+/* Struct field encoding specification for nanopb */
+#define meshtastic_GateControl_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UENUM,    command,           1) \
+X(a, STATIC,   SINGULAR, UINT32,   gate_id,           2) \
+X(a, STATIC,   SINGULAR, BYTES,    auth_token,        3) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (variant,status,variant.status),   4) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (variant,schedule,variant.schedule),   5) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (variant,access,variant.access),   6) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (variant,config,variant.config),   7) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (variant,audit,variant.audit),   8)
+#define meshtastic_GateControl_CALLBACK NULL
+#define meshtastic_GateControl_DEFAULT NULL
+#define meshtastic_GateControl_variant_status_MSGTYPE meshtastic_GateStatus
+#define meshtastic_GateControl_variant_schedule_MSGTYPE meshtastic_GateSchedule
+#define meshtastic_GateControl_variant_access_MSGTYPE meshtastic_AccessControl
+#define meshtastic_GateControl_variant_config_MSGTYPE meshtastic_GateConfig
+#define meshtastic_GateControl_variant_audit_MSGTYPE meshtastic_GateAuditBatch
+
+#define meshtastic_GateStatus_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   gate_id,           1) \
+X(a, STATIC,   SINGULAR, UENUM,    state,             2) \
+X(a, STATIC,   SINGULAR, UINT32,   position_percent,   3) \
+X(a, STATIC,   SINGULAR, FLOAT,    battery_voltage,   4) \
+X(a, STATIC,   SINGULAR, INT32,    temperature_c,     5) \
+X(a, STATIC,   SINGULAR, UINT32,   cycle_count,       6) \
+X(a, STATIC,   SINGULAR, UINT32,   error_code,        7) \
+X(a, STATIC,   SINGULAR, STRING,   error_message,     8) \
+X(a, STATIC,   SINGULAR, UINT64,   last_opened,       9) \
+X(a, STATIC,   SINGULAR, UINT64,   last_closed,      10) \
+X(a, STATIC,   SINGULAR, BOOL,     manual_override,  11) \
+X(a, STATIC,   SINGULAR, INT32,    motor_current_ma,  12)
+#define meshtastic_GateStatus_CALLBACK NULL
+#define meshtastic_GateStatus_DEFAULT NULL
+
+#define meshtastic_AccessControl_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, MESSAGE,  users,             1) \
+X(a, STATIC,   SINGULAR, BOOL,     require_auth,      2) \
+X(a, STATIC,   SINGULAR, BOOL,     log_access,        3)
+#define meshtastic_AccessControl_CALLBACK NULL
+#define meshtastic_AccessControl_DEFAULT NULL
+#define meshtastic_AccessControl_users_MSGTYPE meshtastic_AccessControl_User
+
+#define meshtastic_AccessControl_User_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   node_id,           1) \
+X(a, STATIC,   SINGULAR, STRING,   name,              2) \
+X(a, STATIC,   SINGULAR, UINT32,   access_level,      3) \
+X(a, STATIC,   SINGULAR, UINT64,   valid_from,        4) \
+X(a, STATIC,   SINGULAR, UINT64,   valid_until,       5) \
+X(a, STATIC,   REPEATED, UINT32,   allowed_gates,     6) \
+X(a, STATIC,   SINGULAR, BYTES,    pin_hash,          7) \
+X(a, STATIC,   SINGULAR, BYTES,    pin_salt,          8)
+#define meshtastic_AccessControl_User_CALLBACK NULL
+#define meshtastic_AccessControl_User_DEFAULT NULL
+
+#define meshtastic_GateSchedule_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, MESSAGE,  events,            1) \
+X(a, STATIC,   SINGULAR, STRING,   timezone,          2)
+#define meshtastic_GateSchedule_CALLBACK NULL
+#define meshtastic_GateSchedule_DEFAULT NULL
+#define meshtastic_GateSchedule_events_MSGTYPE meshtastic_GateSchedule_Event
+
+#define meshtastic_GateSchedule_Event_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UENUM,    action,            1) \
+X(a, STATIC,   SINGULAR, UINT32,   hour,              2) \
+X(a, STATIC,   SINGULAR, UINT32,   minute,            3) \
+X(a, STATIC,   REPEATED, UINT32,   days_of_week,      4) \
+X(a, STATIC,   SINGULAR, BOOL,     enabled,           5)
+#define meshtastic_GateSchedule_Event_CALLBACK NULL
+#define meshtastic_GateSchedule_Event_DEFAULT NULL
+
+#define meshtastic_GateConfig_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   gate_id,           1) \
+X(a, STATIC,   SINGULAR, STRING,   name,              2) \
+X(a, STATIC,   SINGULAR, UINT32,   open_time_ms,      3) \
+X(a, STATIC,   SINGULAR, UINT32,   close_time_ms,     4) \
+X(a, STATIC,   SINGULAR, UINT32,   auto_close_delay_ms,   5) \
+X(a, STATIC,   SINGULAR, UINT32,   obstruction_current_ma,   6) \
+X(a, STATIC,   SINGULAR, BOOL,     safety_beam_enabled,   7) \
+X(a, STATIC,   SINGULAR, BOOL,     auto_close_enabled,   8) \
+X(a, STATIC,   SINGULAR, FLOAT,    latitude,          9) \
+X(a, STATIC,   SINGULAR, FLOAT,    longitude,        10) \
+X(a, STATIC,   SINGULAR, STRING,   address,          11)
+#define meshtastic_GateConfig_CALLBACK NULL
+#define meshtastic_GateConfig_DEFAULT NULL
+
+#define meshtastic_GateAuditLog_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT64,   timestamp,         1) \
+X(a, STATIC,   SINGULAR, UINT32,   gate_id,           2) \
+X(a, STATIC,   SINGULAR, UINT32,   user_id,           3) \
+X(a, STATIC,   SINGULAR, STRING,   action,            4) \
+X(a, STATIC,   SINGULAR, BOOL,     success,           5) \
+X(a, STATIC,   SINGULAR, STRING,   details,           6)
+#define meshtastic_GateAuditLog_CALLBACK NULL
+#define meshtastic_GateAuditLog_DEFAULT NULL
+
+#define meshtastic_GateAuditBatch_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, MESSAGE,  entries,           1) \
+X(a, STATIC,   SINGULAR, UINT32,   remaining,         2)
+#define meshtastic_GateAuditBatch_CALLBACK NULL
+#define meshtastic_GateAuditBatch_DEFAULT NULL
+#define meshtastic_GateAuditBatch_entries_MSGTYPE meshtastic_GateAuditLog
+
+extern const pb_msgdesc_t meshtastic_GateControl_msg;
+extern const pb_msgdesc_t meshtastic_GateStatus_msg;
+extern const pb_msgdesc_t meshtastic_AccessControl_msg;
+extern const pb_msgdesc_t meshtastic_AccessControl_User_msg;
+extern const pb_msgdesc_t meshtastic_GateSchedule_msg;
+extern const pb_msgdesc_t meshtastic_GateSchedule_Event_msg;
+extern const pb_msgdesc_t meshtastic_GateConfig_msg;
+extern const pb_msgdesc_t meshtastic_GateAuditLog_msg;
+extern const pb_msgdesc_t meshtastic_GateAuditBatch_msg;
+
+/* Defines for backwards compatibility with code written before nanopb-0.4.0 */
+#define meshtastic_GateControl_fields &meshtastic_GateControl_msg
+#define meshtastic_GateStatus_fields &meshtastic_GateStatus_msg
+#define meshtastic_AccessControl_fields &meshtastic_AccessControl_msg
+#define meshtastic_AccessControl_User_fields &meshtastic_AccessControl_User_msg
+#define meshtastic_GateSchedule_fields &meshtastic_GateSchedule_msg
+#define meshtastic_GateSchedule_Event_fields &meshtastic_GateSchedule_Event_msg
+#define meshtastic_GateConfig_fields &meshtastic_GateConfig_msg
+#define meshtastic_GateAuditLog_fields &meshtastic_GateAuditLog_msg
+#define meshtastic_GateAuditBatch_fields &meshtastic_GateAuditBatch_msg
+
+/* Maximum encoded size of messages (where known) */
+#define MESHTASTIC_MESHTASTIC_GATE_CONTROL_PB_H_MAX_SIZE meshtastic_GateControl_size
+#define meshtastic_AccessControl_User_size       127
+#define meshtastic_AccessControl_size            262
+#define meshtastic_GateAuditBatch_size           177
+#define meshtastic_GateAuditLog_size             55
+#define meshtastic_GateConfig_size               118
+#define meshtastic_GateControl_size              542
+#define meshtastic_GateSchedule_Event_size       58
+#define meshtastic_GateSchedule_size             513
+#define meshtastic_GateStatus_size               118
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+/* Automatically generated nanopb constant definitions */
+/* Generated by nanopb-0.4.9.1 */
+
+#include "meshtastic/irrigation.pb.h"
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+PB_BIND(meshtastic_IrrigationPacket, meshtastic_IrrigationPacket, 2)
+
+
+PB_BIND(meshtastic_IrrigationCommand, meshtastic_IrrigationCommand, AUTO)
+
+
+PB_BIND(meshtastic_IrrigationCommand_Target, meshtastic_IrrigationCommand_Target, AUTO)
+
+
+PB_BIND(meshtastic_IrrigationAck, meshtastic_IrrigationAck, AUTO)
+
+
+PB_BIND(meshtastic_IrrigationAck_Entry, meshtastic_IrrigationAck_Entry, AUTO)
+
+
+PB_BIND(meshtastic_IrrigationReport, meshtastic_IrrigationReport, AUTO)
+
+
+PB_BIND(meshtastic_IrrigationNodeConfig, meshtastic_IrrigationNodeConfig, AUTO)
+
+
+
+
+
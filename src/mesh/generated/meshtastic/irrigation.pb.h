@@ -0,0 +1,315 @@
+/* Automatically generated nanopb header */
+/* Generated by nanopb-0.4.9.1 */
+
+#ifndef PB_MESHTASTIC_MESHTASTIC_IRRIGATION_PB_H_INCLUDED
+#define PB_MESHTASTIC_MESHTASTIC_IRRIGATION_PB_H_INCLUDED
+#include <pb.h>
+
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+/* Enum definitions */
+typedef enum _meshtastic_IrrigationCommand_Action {
+    meshtastic_IrrigationCommand_Action_NOOP = 0,
+    meshtastic_IrrigationCommand_Action_SET_VALVE = 1,
+    meshtastic_IrrigationCommand_Action_CLOSE_VALVE = 2,
+    meshtastic_IrrigationCommand_Action_START_PUMP = 3,
+    meshtastic_IrrigationCommand_Action_STOP_PUMP = 4,
+    meshtastic_IrrigationCommand_Action_EMERGENCY_STOP = 5,
+    meshtastic_IrrigationCommand_Action_STATUS_REQUEST = 6
+} meshtastic_IrrigationCommand_Action;
+
+typedef enum _meshtastic_IrrigationAck_Result {
+    meshtastic_IrrigationAck_Result_OK = 0,
+    /* Sequence already executed, result repeated */
+    meshtastic_IrrigationAck_Result_DUPLICATE = 1,
+    /* Sender does not control this node's zone */
+    meshtastic_IrrigationAck_Result_NO_AUTHORITY = 2,
+    /* Node has no actuator for this action */
+    meshtastic_IrrigationAck_Result_NOT_CAPABLE = 3,
+    meshtastic_IrrigationAck_Result_FAILED = 4
+} meshtastic_IrrigationAck_Result;
+
+/* Struct definitions */
+typedef struct _meshtastic_IrrigationCommand_Target {
+    uint32_t node_id;
+    meshtastic_IrrigationCommand_Action action;
+    uint32_t position_percent;
+    uint32_t duration_s; /* 0 = until told otherwise */
+} meshtastic_IrrigationCommand_Target;
+
+/* A batch of actuator commands from one controller. A single packet can drive
+ every valve of a field; each node executes only the targets addressed to it. */
+typedef struct _meshtastic_IrrigationCommand {
+    /* Per-controller sequence number. A repeated sequence is acknowledged again
+ but never re-executed, so retries are idempotent. */
+    uint32_t sequence;
+    pb_size_t targets_count;
+    meshtastic_IrrigationCommand_Target targets[16];
+} meshtastic_IrrigationCommand;
+
+typedef struct _meshtastic_IrrigationAck_Entry {
+    uint32_t node_id;
+    meshtastic_IrrigationAck_Result result;
+    uint32_t position_percent;
+} meshtastic_IrrigationAck_Entry;
+
+/* One ACK per node per batch, covering all of its targets */
+typedef struct _meshtastic_IrrigationAck {
+    uint32_t sequence;
+    pb_size_t entries_count;
+    meshtastic_IrrigationAck_Entry entries[16];
+} meshtastic_IrrigationAck;
+
+/* Periodic / change-triggered node status */
+typedef struct _meshtastic_IrrigationReport {
+    uint32_t node_type;
+    uint32_t zone_id;
+    uint32_t state;
+    uint32_t valve_position;
+    bool pump_running;
+    float flow_rate;
+    float pressure;
+    float moisture;
+    float water_level;
+    pb_size_t level_history_count;
+    float level_history[8]; /* Filtered samples since the last report, newest first */
+    uint32_t report_reason;
+} meshtastic_IrrigationReport;
+
+/* Everything sent on IRRIGATION_APP (portnum 68) is wrapped in this envelope */
+typedef struct _meshtastic_IrrigationPacket {
+    pb_size_t which_payload_variant;
+    union {
+        meshtastic_IrrigationCommand command;
+        meshtastic_IrrigationAck ack;
+        meshtastic_IrrigationReport report;
+    } payload_variant;
+} meshtastic_IrrigationPacket;
+
+/* On-flash node configuration (/prefs/irrigation.proto). Never sent over the air.
+ Add fields at the end and bump CURRENT_VERSION in IrrigationNode.cpp. */
+typedef struct _meshtastic_IrrigationNodeConfig {
+    uint32_t version;
+    uint32_t type;
+    uint32_t zone_id;
+    char location_name[32];
+    double latitude;
+    double longitude;
+    uint32_t elevation_m;
+    uint32_t parent_node;
+    pb_size_t child_nodes_count;
+    uint32_t child_nodes[8];
+    uint32_t capabilities;
+    float flow_calibration;
+    float pressure_offset;
+    float moisture_min;
+    float moisture_max;
+    uint32_t max_flow_gpm;
+    uint32_t min_pressure_psi;
+    uint32_t max_pressure_psi;
+    uint32_t valve_timeout_ms;
+    bool has_level_alert_ft;
+    float level_alert_ft; /* Set from the console; unset keeps the role's default */
+    bool has_level_critical_ft;
+    float level_critical_ft;
+} meshtastic_IrrigationNodeConfig;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Helper constants for enums */
+#define _meshtastic_IrrigationCommand_Action_MIN meshtastic_IrrigationCommand_Action_NOOP
+#define _meshtastic_IrrigationCommand_Action_MAX meshtastic_IrrigationCommand_Action_STATUS_REQUEST
+#define _meshtastic_IrrigationCommand_Action_ARRAYSIZE ((meshtastic_IrrigationCommand_Action)(meshtastic_IrrigationCommand_Action_STATUS_REQUEST+1))
+
+#define _meshtastic_IrrigationAck_Result_MIN meshtastic_IrrigationAck_Result_OK
+#define _meshtastic_IrrigationAck_Result_MAX meshtastic_IrrigationAck_Result_FAILED
+#define _meshtastic_IrrigationAck_Result_ARRAYSIZE ((meshtastic_IrrigationAck_Result)(meshtastic_IrrigationAck_Result_FAILED+1))
+
+
+
+#define meshtastic_IrrigationCommand_Target_action_ENUMTYPE meshtastic_IrrigationCommand_Action
+
+
+#define meshtastic_IrrigationAck_Entry_result_ENUMTYPE meshtastic_IrrigationAck_Result
+
+
+
+/* Initializer values for message structs */
+#define meshtastic_IrrigationPacket_init_default {0, {meshtastic_IrrigationCommand_init_default}}
+#define meshtastic_IrrigationCommand_init_default {0, 0, {meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default, meshtastic_IrrigationCommand_Target_init_default}}
+#define meshtastic_IrrigationCommand_Target_init_default {0, _meshtastic_IrrigationCommand_Action_MIN, 0, 0}
+#define meshtastic_IrrigationAck_init_default    {0, 0, {meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default, meshtastic_IrrigationAck_Entry_init_default}}
+#define meshtastic_IrrigationAck_Entry_init_default {0, _meshtastic_IrrigationAck_Result_MIN, 0}
+#define meshtastic_IrrigationReport_init_default {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}, 0}
+#define meshtastic_IrrigationNodeConfig_init_default {0, 0, 0, "", 0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}, 0, 0, 0, 0, 0, 0, 0, 0, 0, false, 0, false, 0}
+#define meshtastic_IrrigationPacket_init_zero    {0, {meshtastic_IrrigationCommand_init_zero}}
+#define meshtastic_IrrigationCommand_init_zero   {0, 0, {meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero, meshtastic_IrrigationCommand_Target_init_zero}}
+#define meshtastic_IrrigationCommand_Target_init_zero {0, _meshtastic_IrrigationCommand_Action_MIN, 0, 0}
+#define meshtastic_IrrigationAck_init_zero       {0, 0, {meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero, meshtastic_IrrigationAck_Entry_init_zero}}
+#define meshtastic_IrrigationAck_Entry_init_zero {0, _meshtastic_IrrigationAck_Result_MIN, 0}
+#define meshtastic_IrrigationReport_init_zero    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}, 0}
+#define meshtastic_IrrigationNodeConfig_init_zero {0, 0, 0, "", 0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}, 0, 0, 0, 0, 0, 0, 0, 0, 0, false, 0, false, 0}
+
+/* Field tags (for use in manual encoding/decoding) */
+#define meshtastic_IrrigationCommand_Target_node_id_tag 1
+#define meshtastic_IrrigationCommand_Target_action_tag 2
+#define meshtastic_IrrigationCommand_Target_position_percent_tag 3
+#define meshtastic_IrrigationCommand_Target_duration_s_tag 4
+#define meshtastic_IrrigationCommand_sequence_tag 1
+#define meshtastic_IrrigationCommand_targets_tag 2
+#define meshtastic_IrrigationAck_Entry_node_id_tag 1
+#define meshtastic_IrrigationAck_Entry_result_tag 2
+#define meshtastic_IrrigationAck_Entry_position_percent_tag 3
+#define meshtastic_IrrigationAck_sequence_tag    1
+#define meshtastic_IrrigationAck_entries_tag     2
+#define meshtastic_IrrigationReport_node_type_tag 1
+#define meshtastic_IrrigationReport_zone_id_tag  2
+#define meshtastic_IrrigationReport_state_tag    3
+#define meshtastic_IrrigationReport_valve_position_tag 4
+#define meshtastic_IrrigationReport_pump_running_tag 5
+#define meshtastic_IrrigationReport_flow_rate_tag 6
+#define meshtastic_IrrigationReport_pressure_tag 7
+#define meshtastic_IrrigationReport_moisture_tag 8
+#define meshtastic_IrrigationReport_water_level_tag 9
+#define meshtastic_IrrigationReport_level_history_tag 10
+#define meshtastic_IrrigationReport_report_reason_tag 11
+#define meshtastic_IrrigationNodeConfig_version_tag 1
+#define meshtastic_IrrigationNodeConfig_type_tag 2
+#define meshtastic_IrrigationNodeConfig_zone_id_tag 3
+#define meshtastic_IrrigationNodeConfig_location_name_tag 4
+#define meshtastic_IrrigationNodeConfig_latitude_tag 5
+#define meshtastic_IrrigationNodeConfig_longitude_tag 6
+#define meshtastic_IrrigationNodeConfig_elevation_m_tag 7
+#define meshtastic_IrrigationNodeConfig_parent_node_tag 8
+#define meshtastic_IrrigationNodeConfig_child_nodes_tag 9
+#define meshtastic_IrrigationNodeConfig_capabilities_tag 10
+#define meshtastic_IrrigationNodeConfig_flow_calibration_tag 11
+#define meshtastic_IrrigationNodeConfig_pressure_offset_tag 12
+#define meshtastic_IrrigationNodeConfig_moisture_min_tag 13
+#define meshtastic_IrrigationNodeConfig_moisture_max_tag 14
+#define meshtastic_IrrigationNodeConfig_max_flow_gpm_tag 15
+#define meshtastic_IrrigationNodeConfig_min_pressure_psi_tag 16
+#define meshtastic_IrrigationNodeConfig_max_pressure_psi_tag 17
+#define meshtastic_IrrigationNodeConfig_valve_timeout_ms_tag 18
+#define meshtastic_IrrigationNodeConfig_level_alert_ft_tag 19
+#define meshtastic_IrrigationNodeConfig_level_critical_ft_tag 20
+#define meshtastic_IrrigationPacket_command_tag  1
+#define meshtastic_IrrigationPacket_ack_tag      2
+#define meshtastic_IrrigationPacket_report_tag   3
+
+/* Struct field encoding specification for nanopb */
+#define meshtastic_IrrigationPacket_FIELDLIST(X, a) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,command,payload_variant.command),   1) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,ack,payload_variant.ack),   2) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,report,payload_variant.report),   3)
+#define meshtastic_IrrigationPacket_CALLBACK NULL
+#define meshtastic_IrrigationPacket_DEFAULT NULL
+#define meshtastic_IrrigationPacket_payload_variant_command_MSGTYPE meshtastic_IrrigationCommand
+#define meshtastic_IrrigationPacket_payload_variant_ack_MSGTYPE meshtastic_IrrigationAck
+#define meshtastic_IrrigationPacket_payload_variant_report_MSGTYPE meshtastic_IrrigationReport
+
+#define meshtastic_IrrigationCommand_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   sequence,          1) \
+X(a, STATIC,   REPEATED, MESSAGE,  targets,           2)
+#define meshtastic_IrrigationCommand_CALLBACK NULL
+#define meshtastic_IrrigationCommand_DEFAULT NULL
+#define meshtastic_IrrigationCommand_targets_MSGTYPE meshtastic_IrrigationCommand_Target
+
+#define meshtastic_IrrigationCommand_Target_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   node_id,           1) \
+X(a, STATIC,   SINGULAR, UENUM,    action,            2) \
+X(a, STATIC,   SINGULAR, UINT32,   position_percent,   3) \
+X(a, STATIC,   SINGULAR, UINT32,   duration_s,        4)
+#define meshtastic_IrrigationCommand_Target_CALLBACK NULL
+#define meshtastic_IrrigationCommand_Target_DEFAULT NULL
+
+#define meshtastic_IrrigationAck_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   sequence,          1) \
+X(a, STATIC,   REPEATED, MESSAGE,  entries,           2)
+#define meshtastic_IrrigationAck_CALLBACK NULL
+#define meshtastic_IrrigationAck_DEFAULT NULL
+#define meshtastic_IrrigationAck_entries_MSGTYPE meshtastic_IrrigationAck_Entry
+
+#define meshtastic_IrrigationAck_Entry_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   node_id,           1) \
+X(a, STATIC,   SINGULAR, UENUM,    result,            2) \
+X(a, STATIC,   SINGULAR, UINT32,   position_percent,   3)
+#define meshtastic_IrrigationAck_Entry_CALLBACK NULL
+#define meshtastic_IrrigationAck_Entry_DEFAULT NULL
+
+#define meshtastic_IrrigationReport_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   node_type,         1) \
+X(a, STATIC,   SINGULAR, UINT32,   zone_id,           2) \
+X(a, STATIC,   SINGULAR, UINT32,   state,             3) \
+X(a, STATIC,   SINGULAR, UINT32,   valve_position,    4) \
+X(a, STATIC,   SINGULAR, BOOL,     pump_running,      5) \
+X(a, STATIC,   SINGULAR, FLOAT,    flow_rate,         6) \
+X(a, STATIC,   SINGULAR, FLOAT,    pressure,          7) \
+X(a, STATIC,   SINGULAR, FLOAT,    moisture,          8) \
+X(a, STATIC,   SINGULAR, FLOAT,    water_level,       9) \
+X(a, STATIC,   REPEATED, FLOAT,    level_history,    10) \
+X(a, STATIC,   SINGULAR, UINT32,   report_reason,    11)
+#define meshtastic_IrrigationReport_CALLBACK NULL
+#define meshtastic_IrrigationReport_DEFAULT NULL
+
+#define meshtastic_IrrigationNodeConfig_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   version,           1) \
+X(a, STATIC,   SINGULAR, UINT32,   type,              2) \
+X(a, STATIC,   SINGULAR, UINT32,   zone_id,           3) \
+X(a, STATIC,   SINGULAR, STRING,   location_name,     4) \
+X(a, STATIC,   SINGULAR, DOUBLE,   latitude,          5) \
+X(a, STATIC,   SINGULAR, DOUBLE,   longitude,         6) \
+X(a, STATIC,   SINGULAR, UINT32,   elevation_m,       7) \
+X(a, STATIC,   SINGULAR, UINT32,   parent_node,       8) \
+X(a, STATIC,   REPEATED, FIXED32,  child_nodes,       9) \
+X(a, STATIC,   SINGULAR, UINT32,   capabilities,     10) \
+X(a, STATIC,   SINGULAR, FLOAT,    flow_calibration,  11) \
+X(a, STATIC,   SINGULAR, FLOAT,    pressure_offset,  12) \
+X(a, STATIC,   SINGULAR, FLOAT,    moisture_min,     13) \
+X(a, STATIC,   SINGULAR, FLOAT,    moisture_max,     14) \
+X(a, STATIC,   SINGULAR, UINT32,   max_flow_gpm,     15) \
+X(a, STATIC,   SINGULAR, UINT32,   min_pressure_psi,  16) \
+X(a, STATIC,   SINGULAR, UINT32,   max_pressure_psi,  17) \
+X(a, STATIC,   SINGULAR, UINT32,   valve_timeout_ms,  18) \
+X(a, STATIC,   OPTIONAL, FLOAT,    level_alert_ft,   19) \
+X(a, STATIC,   OPTIONAL, FLOAT,    level_critical_ft,  20)
+#define meshtastic_IrrigationNodeConfig_CALLBACK NULL
+#define meshtastic_IrrigationNodeConfig_DEFAULT NULL
+
+extern const pb_msgdesc_t meshtastic_IrrigationPacket_msg;
+extern const pb_msgdesc_t meshtastic_IrrigationCommand_msg;
+extern const pb_msgdesc_t meshtastic_IrrigationCommand_Target_msg;
+extern const pb_msgdesc_t meshtastic_IrrigationAck_msg;
+extern const pb_msgdesc_t meshtastic_IrrigationAck_Entry_msg;
+extern const pb_msgdesc_t meshtastic_IrrigationReport_msg;
+extern const pb_msgdesc_t meshtastic_IrrigationNodeConfig_msg;
+
+/* Defines for backwards compatibility with code written before nanopb-0.4.0 */
+#define meshtastic_IrrigationPacket_fields &meshtastic_IrrigationPacket_msg
+#define meshtastic_IrrigationCommand_fields &meshtastic_IrrigationCommand_msg
+#define meshtastic_IrrigationCommand_Target_fields &meshtastic_IrrigationCommand_Target_msg
+#define meshtastic_IrrigationAck_fields &meshtastic_IrrigationAck_msg
+#define meshtastic_IrrigationAck_Entry_fields &meshtastic_IrrigationAck_Entry_msg
+#define meshtastic_IrrigationReport_fields &meshtastic_IrrigationReport_msg
+#define meshtastic_IrrigationNodeConfig_fields &meshtastic_IrrigationNodeConfig_msg
+
+/* Maximum encoded size of messages (where known) */
+#define MESHTASTIC_MESHTASTIC_IRRIGATION_PB_H_MAX_SIZE meshtastic_IrrigationPacket_size
+#define meshtastic_IrrigationAck_Entry_size      14
+#define meshtastic_IrrigationAck_size            262
+#define meshtastic_IrrigationCommand_Target_size 20
+#define meshtastic_IrrigationCommand_size        358
+#define meshtastic_IrrigationNodeConfig_size     183
+#define meshtastic_IrrigationPacket_size         361
+#define meshtastic_IrrigationReport_size         92
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,15 @@
+/* Automatically generated nanopb constant definitions */
+/* Generated by nanopb-0.4.9.1 */
+
+#include "meshtastic/link_quality.pb.h"
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+PB_BIND(meshtastic_LinkQuality, meshtastic_LinkQuality, AUTO)
+
+
+PB_BIND(meshtastic_LinkQuality_Link, meshtastic_LinkQuality_Link, AUTO)
+
+
+
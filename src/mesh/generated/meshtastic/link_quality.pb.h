@@ -0,0 +1,76 @@
+/* Automatically generated nanopb header */
+/* Generated by nanopb-0.4.9.1 */
+
+#ifndef PB_MESHTASTIC_MESHTASTIC_LINK_QUALITY_PB_H_INCLUDED
+#define PB_MESHTASTIC_MESHTASTIC_LINK_QUALITY_PB_H_INCLUDED
+#include <pb.h>
+
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+/* Struct definitions */
+typedef struct _meshtastic_LinkQuality_Link {
+    /* The neighbor, as in NeighborInfo */
+    uint32_t node_id;
+    /* Share of what the sender handed this neighbor that it was heard to
+ relay, in percent (1-100) */
+    uint32_t pdr;
+} meshtastic_LinkQuality_Link;
+
+/* Delivery ratios of the links a node lists in its NeighborInfo, sent on
+ LINK_QUALITY_APP (portnum 261) to the same destination right after it.
+ Upstream's Neighbor has no field for them. Nodes without GateMesh relay
+ the packet like any other and ignore it. */
+typedef struct _meshtastic_LinkQuality {
+    /* Only the links the sender has enough samples for */
+    pb_size_t links_count;
+    meshtastic_LinkQuality_Link links[10];
+} meshtastic_LinkQuality;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Initializer values for message structs */
+#define meshtastic_LinkQuality_init_default      {0, {meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default, meshtastic_LinkQuality_Link_init_default}}
+#define meshtastic_LinkQuality_Link_init_default {0, 0}
+#define meshtastic_LinkQuality_init_zero         {0, {meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero, meshtastic_LinkQuality_Link_init_zero}}
+#define meshtastic_LinkQuality_Link_init_zero    {0, 0}
+
+/* Field tags (for use in manual encoding/decoding) */
+#define meshtastic_LinkQuality_Link_node_id_tag  1
+#define meshtastic_LinkQuality_Link_pdr_tag      2
+#define meshtastic_LinkQuality_links_tag         1
+
+/* Struct field encoding specification for nanopb */
+#define meshtastic_LinkQuality_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, MESSAGE,  links,             1)
+#define meshtastic_LinkQuality_CALLBACK NULL
+#define meshtastic_LinkQuality_DEFAULT NULL
+#define meshtastic_LinkQuality_links_MSGTYPE meshtastic_LinkQuality_Link
+
+#define meshtastic_LinkQuality_Link_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   node_id,           1) \
+X(a, STATIC,   SINGULAR, UINT32,   pdr,               2)
+#define meshtastic_LinkQuality_Link_CALLBACK NULL
+#define meshtastic_LinkQuality_Link_DEFAULT NULL
+
+extern const pb_msgdesc_t meshtastic_LinkQuality_msg;
+extern const pb_msgdesc_t meshtastic_LinkQuality_Link_msg;
+
+/* Defines for backwards compatibility with code written before nanopb-0.4.0 */
+#define meshtastic_LinkQuality_fields &meshtastic_LinkQuality_msg
+#define meshtastic_LinkQuality_Link_fields &meshtastic_LinkQuality_Link_msg
+
+/* Maximum encoded size of messages (where known) */
+#define MESHTASTIC_MESHTASTIC_LINK_QUALITY_PB_H_MAX_SIZE meshtastic_LinkQuality_size
+#define meshtastic_LinkQuality_Link_size         12
+#define meshtastic_LinkQuality_size              140
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
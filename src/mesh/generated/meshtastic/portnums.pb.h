@@ -148,6 +148,21 @@ typedef enum _meshtastic_PortNum {
     /* ATAK Forwarder Module https://github.com/paulmandal/atak-forwarder
  ENCODING: libcotshrink */
     meshtastic_PortNum_ATAK_FORWARDER = 257,
+    /* GateMesh gate access control, schedules and audit upload.
+ Payload is a GateControl message.
+ ENCODING: Protobuf */
+    meshtastic_PortNum_GATE_CONTROL_APP = 258,
+    /* GateMesh fragmentation: payloads larger than one packet, split, selectively acknowledged and reassembled.
+ ENCODING: Fragment header, see modules/fragment/FragmentTransfer.h */
+    meshtastic_PortNum_FRAGMENT_APP = 259,
+    /* GateMesh per-port airtime budget, sent to the phone next to LocalStats.
+ Payload is a TxBudgetStats message.
+ ENCODING: Protobuf */
+    meshtastic_PortNum_TX_BUDGET_APP = 260,
+    /* GateMesh link delivery ratios, sent after each NeighborInfo.
+ Payload is a LinkQuality message.
+ ENCODING: Protobuf */
+    meshtastic_PortNum_LINK_QUALITY_APP = 261,
     /* Currently we limit port nums to no higher than this value */
     meshtastic_PortNum_MAX = 511
 } meshtastic_PortNum;
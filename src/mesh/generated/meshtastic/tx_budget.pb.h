@@ -0,0 +1,63 @@
+/* Automatically generated nanopb header */
+/* Generated by nanopb-0.4.9.1 */
+
+#ifndef PB_MESHTASTIC_MESHTASTIC_TX_BUDGET_PB_H_INCLUDED
+#define PB_MESHTASTIC_MESHTASTIC_TX_BUDGET_PB_H_INCLUDED
+#include <pb.h>
+
+#if PB_PROTO_HEADER_VERSION != 40
+#error Regenerate this file with the current version of nanopb generator.
+#endif
+
+/* Struct definitions */
+/* State of this node's per-port airtime budget, sent to the phone on
+ TX_BUDGET_APP (portnum 260) next to each LocalStats. Upstream's LocalStats
+ has no room for it, so it travels as a message of its own. */
+typedef struct _meshtastic_TxBudgetStats {
+    /* Number of packets we originated that were held back because their port
+ had spent its share of the duty cycle */
+    uint32_t num_tx_held;
+    /* Number of packets dropped by that admission control: held too long, or
+ no room to hold them */
+    uint32_t num_tx_budget_dropped;
+    /* The port whose packets were held back the most; 0 if none were, or ports
+ without a share of their own */
+    uint32_t tx_starved_port;
+} meshtastic_TxBudgetStats;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Initializer values for message structs */
+#define meshtastic_TxBudgetStats_init_default    {0, 0, 0}
+#define meshtastic_TxBudgetStats_init_zero       {0, 0, 0}
+
+/* Field tags (for use in manual encoding/decoding) */
+#define meshtastic_TxBudgetStats_num_tx_held_tag 1
+#define meshtastic_TxBudgetStats_num_tx_budget_dropped_tag 2
+#define meshtastic_TxBudgetStats_tx_starved_port_tag 3
+
+/* Struct field encoding specification for nanopb */
+#define meshtastic_TxBudgetStats_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   num_tx_held,       1) \
+X(a, STATIC,   SINGULAR, UINT32,   num_tx_budget_dropped,   2) \
+X(a, STATIC,   SINGULAR, UINT32,   tx_starved_port,   3)
+#define meshtastic_TxBudgetStats_CALLBACK NULL
+#define meshtastic_TxBudgetStats_DEFAULT NULL
+
+extern const pb_msgdesc_t meshtastic_TxBudgetStats_msg;
+
+/* Defines for backwards compatibility with code written before nanopb-0.4.0 */
+#define meshtastic_TxBudgetStats_fields &meshtastic_TxBudgetStats_msg
+
+/* Maximum encoded size of messages (where known) */
+#define MESHTASTIC_MESHTASTIC_TX_BUDGET_PB_H_MAX_SIZE meshtastic_TxBudgetStats_size
+#define meshtastic_TxBudgetStats_size            18
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
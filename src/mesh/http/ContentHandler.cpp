@@ -2,6 +2,7 @@
 #include "NodeDB.h"
 #include "PowerFSM.h"
 #include "RadioLibInterface.h"
+#include "RouteCache.h"
 #include "airtime.h"
 #include "main.h"
 #include "mesh/http/ContentHelper.h"
@@ -10,9 +11,12 @@
 #include "mesh/wifi/WiFiAPClient.h"
 #endif
 #include "Led.h"
+#include "LiveFeed.h"
 #include "SPILock.h"
+#include "modules/TraceRouteModule.h"
 #include "power.h"
 #include "serialization/JSON.h"
+#include "serialization/JSONWriter.h"
 #include <FSCommon.h>
 #include <HTTPBodyParser.hpp>
 #include <HTTPMultipartBodyParser.hpp>
@@ -53,6 +57,23 @@ HTTPClient httpClient;
 
 #define DEST_FS_USES_LITTLEFS
 
+// Each protobuf in /api/v1/fromradio?all=true&framed=true and /api/v1/live starts with the same 4 byte header as StreamAPI
+// uses
+#define FRAME_HEADER_LEN 4
+
+// Only the web server thread gets here, so one buffer serves every request
+static uint8_t txBuf[4 * MAX_STREAM_BUF_SIZE];
+
+/// Put the header in front of the protobuf already at frame + FRAME_HEADER_LEN, @return the length with the header
+static size_t frameProtobuf(uint8_t *frame, size_t length)
+{
+    frame[0] = 0x94;
+    frame[1] = 0xc3;
+    frame[2] = (length >> 8) & 0xff;
+    frame[3] = length & 0xff;
+    return FRAME_HEADER_LEN + length;
+}
+
 // We need to specify some content-type mapping, so the resources get delivered with the
 // right content type and are displayed correctly in the browser
 char const *contentTypes[][2] = {{".txt", "text/plain"},     {".html", "text/html"},
@@ -77,6 +98,10 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     ResourceNode *nodeAPIv1ToRadio = new ResourceNode("/api/v1/toradio", "PUT", &handleAPIv1ToRadio);
     ResourceNode *nodeAPIv1FromRadioOptions = new ResourceNode("/api/v1/fromradio", "OPTIONS", &handleAPIv1FromRadio);
     ResourceNode *nodeAPIv1FromRadio = new ResourceNode("/api/v1/fromradio", "GET", &handleAPIv1FromRadio);
+    ResourceNode *nodeAPIv1LiveOptions = new ResourceNode("/api/v1/live", "OPTIONS", &handleAPIv1Live);
+    ResourceNode *nodeAPIv1Live = new ResourceNode("/api/v1/live", "GET", &handleAPIv1Live);
+    ResourceNode *nodeAPIv1Topology = new ResourceNode("/api/v1/topology", "GET", &handleAPIv1Topology);
+    ResourceNode *nodeAPIv1TraceRoute = new ResourceNode("/api/v1/traceroute", "GET", &handleAPIv1TraceRoute);
 
     //    ResourceNode *nodeHotspotApple = new ResourceNode("/hotspot-detect.html", "GET", &handleHotspot);
     //    ResourceNode *nodeHotspotAndroid = new ResourceNode("/generate_204", "GET", &handleHotspot);
@@ -105,6 +130,10 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     secureServer->registerNode(nodeAPIv1ToRadio);
     secureServer->registerNode(nodeAPIv1FromRadioOptions);
     secureServer->registerNode(nodeAPIv1FromRadio);
+    secureServer->registerNode(nodeAPIv1LiveOptions);
+    secureServer->registerNode(nodeAPIv1Live);
+    secureServer->registerNode(nodeAPIv1Topology);
+    secureServer->registerNode(nodeAPIv1TraceRoute);
     //    secureServer->registerNode(nodeHotspotApple);
     //    secureServer->registerNode(nodeHotspotAndroid);
     secureServer->registerNode(nodeRestart);
@@ -128,6 +157,10 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     insecureServer->registerNode(nodeAPIv1ToRadio);
     insecureServer->registerNode(nodeAPIv1FromRadioOptions);
     insecureServer->registerNode(nodeAPIv1FromRadio);
+    insecureServer->registerNode(nodeAPIv1LiveOptions);
+    insecureServer->registerNode(nodeAPIv1Live);
+    insecureServer->registerNode(nodeAPIv1Topology);
+    insecureServer->registerNode(nodeAPIv1TraceRoute);
     //    insecureServer->registerNode(nodeHotspotApple);
     //    insecureServer->registerNode(nodeHotspotAndroid);
     insecureServer->registerNode(nodeRestart);
@@ -162,6 +195,7 @@ void handleAPIv1FromRadio(HTTPRequest *req, HTTPResponse *res)
 
     // std::string paramAll = "all";
     std::string valueAll;
+    std::string valueFramed;
 
     // Status code is 200 OK by default.
     res->setHeader("Content-Type", "application/x-protobuf");
@@ -175,26 +209,33 @@ void handleAPIv1FromRadio(HTTPRequest *req, HTTPResponse *res)
         return;
     }
 
-    uint8_t txBuf[MAX_STREAM_BUF_SIZE];
-    uint32_t len = 1;
-
-    if (params->getQueryParameter("all", valueAll)) {
-
-        // If all is true, return all the buffers we have available
-        //   to us at this point in time.
-        if (valueAll == "true") {
-            while (len) {
-                len = webAPI.getFromRadio(txBuf);
-                res->write(txBuf, len);
+    uint32_t len = 0;
+
+    // If all is true, return all the buffers we have available to us at this point in time, a few to each write instead
+    // of one write per protobuf. They go back to back as before, unless framed=true asks for each to be framed like
+    // StreamAPI frames them (0x94 0xc3, then the length big endian) so the client can split them again.
+    if (params->getQueryParameter("all", valueAll) && valueAll == "true") {
+        bool framed = params->getQueryParameter("framed", valueFramed) && valueFramed == "true";
+        size_t header = framed ? FRAME_HEADER_LEN : 0;
+        size_t used = 0;
+        uint32_t frames = 0;
+        while (true) {
+            if (sizeof(txBuf) - used < header + MAX_STREAM_BUF_SIZE) {
+                res->write(txBuf, used);
+                len += used;
+                used = 0;
             }
-
-            // Otherwise, just return one protobuf
-        } else {
-            len = webAPI.getFromRadio(txBuf);
-            res->write(txBuf, len);
+            uint32_t frameLen = webAPI.getFromRadio(txBuf + used + header);
+            if (!frameLen)
+                break;
+            used += framed ? frameProtobuf(txBuf + used, frameLen) : frameLen;
+            frames++;
         }
+        res->write(txBuf, used);
+        len += used;
+        LOG_DEBUG("webAPI handleAPIv1FromRadio, %u protobufs", frames);
 
-        // the param "all" was not specified. Return just one protobuf
+        // Otherwise, just return one protobuf
     } else {
         len = webAPI.getFromRadio(txBuf);
         res->write(txBuf, len);
@@ -203,6 +244,98 @@ void handleAPIv1FromRadio(HTTPRequest *req, HTTPResponse *res)
     LOG_DEBUG("webAPI handleAPIv1FromRadio, len %d", len);
 }
 
+void handleAPIv1Live(HTTPRequest *req, HTTPResponse *res)
+{
+    /*
+        Every packet the phone would get, for any number of viewers (see LiveFeed). The body is the FromRadio protobufs
+        after the client's cursor, framed like /api/v1/fromradio?all=true&framed=true, and X-Live-Next is the cursor to
+        ask with next time. Without ?since= the client gets everything still held. X-Live-Dropped counts the packets a
+        client missed by asking too rarely.
+
+        This server runs on the main loop, so it answers straight away instead of holding the request open until a packet
+        arrives. The native server also has long polling and Server-Sent Events.
+    */
+    res->setHeader("Content-Type", "application/x-protobuf");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->setHeader("Access-Control-Expose-Headers", "X-Live-Next, X-Live-Dropped");
+    res->setHeader("Cache-Control", "no-store");
+    res->setHeader("X-Protobuf-Schema", "https://raw.githubusercontent.com/meshtastic/protobufs/master/meshtastic/mesh.proto");
+
+    if (req->getMethod() == "OPTIONS") {
+        res->setStatusCode(204); // Success with no content
+        return;
+    }
+
+    if (!liveFeed)
+        liveFeed = new LiveFeed(); // Only costs the heap once someone watches, the main loop is the only other user
+    LiveFeed::Frames &frames = liveFeed->watch();
+
+    std::string since;
+    uint32_t cursor = req->getParams()->getQueryParameter("since", since) ? strtoul(since.c_str(), NULL, 10) : frames.oldest();
+    uint32_t dropped = 0, skipped;
+    size_t used = 0;
+    // The cursor header has to go out before the body, so a response is what fits in one buffer. A client that got a full
+    // one asks again straight away.
+    while (sizeof(txBuf) - used >= MAX_STREAM_BUF_SIZE) {
+        size_t frameLen = frames.read(cursor, txBuf + used + FRAME_HEADER_LEN, skipped);
+        dropped += skipped;
+        if (!frameLen)
+            break;
+        used += frameProtobuf(txBuf + used, frameLen);
+    }
+
+    char header[12];
+    snprintf(header, sizeof(header), "%u", cursor);
+    res->setHeader("X-Live-Next", header);
+    snprintf(header, sizeof(header), "%u", dropped);
+    res->setHeader("X-Live-Dropped", header);
+    res->write(txBuf, used);
+}
+
+void handleAPIv1Topology(HTTPRequest *req, HTTPResponse *res)
+{
+    /*
+        What routeCache knows of the mesh, from memory: every edge with the SNR it was heard at, its delivery ratio and its
+        age in seconds, and the routes traced lately.
+    */
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->setHeader("Cache-Control", "no-store");
+
+    JSONWriter<HTTPResponse> json(*res);
+    routeCache.writeTopology(json, millis());
+    json.flush();
+}
+
+void handleAPIv1TraceRoute(HTTPRequest *req, HTTPResponse *res)
+{
+    /*
+        GET /api/v1/traceroute?to=!a1b2c3d4,!... answers straight away with the route known to each node, and queues a trace
+        to those not traced lately (all of them with &refresh=1). The traces go out a few at a time as the channel allows,
+        so asking again later picks up their answers.
+    */
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->setHeader("Cache-Control", "no-store");
+
+    if (!traceRouteModule) {
+        res->setStatusCode(404);
+        res->setStatusText("Not Found");
+        return;
+    }
+    std::string to, refresh;
+    ResourceParameters *params = req->getParams();
+    params->getQueryParameter("to", to);
+    params->getQueryParameter("refresh", refresh);
+
+    JSONWriter<HTTPResponse> json(*res);
+    traceRouteModule->writeLookups(json, to.c_str(), refresh == "1" || refresh == "true");
+    json.flush();
+}
+
 void handleAPIv1ToRadio(HTTPRequest *req, HTTPResponse *res)
 {
     LOG_DEBUG("webAPI handleAPIv1ToRadio");
@@ -721,72 +854,73 @@ void handleNodes(HTTPRequest *req, HTTPResponse *res)
         content = "json";
     }
 
+    // The list only changes with NodeDB, so a poller that already has this version gets a 304 instead of the whole list
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08x-%s\"", nodeDB->getNodesVersion(), content == "json" ? "json" : "html");
+    res->setHeader("ETag", etag);
+    res->setHeader("Cache-Control", "no-cache");
+
     if (content == "json") {
         res->setHeader("Content-Type", "application/json");
         res->setHeader("Access-Control-Allow-Origin", "*");
         res->setHeader("Access-Control-Allow-Methods", "GET");
+        res->setHeader("Access-Control-Expose-Headers", "ETag");
     } else {
         res->setHeader("Content-Type", "text/html");
-        res->println("<pre>");
     }
 
-    JSONArray nodesArray;
+    std::string ifNoneMatch = req->getHeader("If-None-Match");
+    if (ifNoneMatch == "*" || ifNoneMatch.find(etag) != std::string::npos) {
+        res->setStatusCode(304);
+        res->setStatusText("Not Modified");
+        return;
+    }
+
+    if (content != "json")
+        res->println("<pre>");
+
+    // Written out as NodeDB is walked, rather than building every node as JSONValues first. Keys are in the order
+    // JSONValue::Stringify() used to put them in, so the output has not changed.
+    JSONWriter<HTTPResponse> json(*res);
+    json.beginObject().key("data").beginObject().key("nodes").beginArray();
 
     uint32_t readIndex = 0;
     const meshtastic_NodeInfoLite *tempNodeInfo = nodeDB->readNextMeshNode(readIndex);
     while (tempNodeInfo != NULL) {
         if (tempNodeInfo->has_user) {
-            JSONObject node;
-
             char id[16];
             snprintf(id, sizeof(id), "!%08x", tempNodeInfo->num);
-
-            node["id"] = new JSONValue(id);
-            node["snr"] = new JSONValue(tempNodeInfo->snr);
-            node["via_mqtt"] = new JSONValue(BoolToString(tempNodeInfo->via_mqtt));
-            node["last_heard"] = new JSONValue((int)tempNodeInfo->last_heard);
-            node["position"] = new JSONValue();
-
-            if (nodeDB->hasValidPosition(tempNodeInfo)) {
-                JSONObject position;
-                position["latitude"] = new JSONValue((float)tempNodeInfo->position.latitude_i * 1e-7);
-                position["longitude"] = new JSONValue((float)tempNodeInfo->position.longitude_i * 1e-7);
-                position["altitude"] = new JSONValue((int)tempNodeInfo->position.altitude);
-                node["position"] = new JSONValue(position);
-            }
-
-            node["long_name"] = new JSONValue(tempNodeInfo->user.long_name);
-            node["short_name"] = new JSONValue(tempNodeInfo->user.short_name);
             char macStr[18];
             snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X", tempNodeInfo->user.macaddr[0],
                      tempNodeInfo->user.macaddr[1], tempNodeInfo->user.macaddr[2], tempNodeInfo->user.macaddr[3],
                      tempNodeInfo->user.macaddr[4], tempNodeInfo->user.macaddr[5]);
-            node["mac_address"] = new JSONValue(macStr);
-            node["hw_model"] = new JSONValue(tempNodeInfo->user.hw_model);
 
-            nodesArray.push_back(new JSONValue(node));
+            json.beginObject();
+            json.key("hw_model").value((int)tempNodeInfo->user.hw_model);
+            json.key("id").value(id);
+            json.key("last_heard").value((int)tempNodeInfo->last_heard);
+            json.key("long_name").value(tempNodeInfo->user.long_name);
+            json.key("mac_address").value(macStr);
+            json.key("position");
+            if (nodeDB->hasValidPosition(tempNodeInfo)) {
+                json.beginObject();
+                json.key("altitude").value((int)tempNodeInfo->position.altitude);
+                json.key("latitude").value((float)tempNodeInfo->position.latitude_i * 1e-7);
+                json.key("longitude").value((float)tempNodeInfo->position.longitude_i * 1e-7);
+                json.endObject();
+            } else {
+                json.null();
+            }
+            json.key("short_name").value(tempNodeInfo->user.short_name);
+            json.key("snr").value(tempNodeInfo->snr);
+            json.key("via_mqtt").value(BoolToString(tempNodeInfo->via_mqtt));
+            json.endObject();
         }
         tempNodeInfo = nodeDB->readNextMeshNode(readIndex);
     }
 
-    // collect data to inner data object
-    JSONObject jsonObjInner;
-    jsonObjInner["nodes"] = new JSONValue(nodesArray);
-
-    // create json output structure
-    JSONObject jsonObjOuter;
-    jsonObjOuter["data"] = new JSONValue(jsonObjInner);
-    jsonObjOuter["status"] = new JSONValue("ok");
-    // serialize and write it to the stream
-    JSONValue *value = new JSONValue(jsonObjOuter);
-    std::string jsonString = value->Stringify();
-    res->print(jsonString.c_str());
-    delete value;
-
-    // Clean up the nodesArray to prevent memory leak
-    for (auto *val : nodesArray) {
-        delete val;
-    }
+    json.endArray().endObject().key("status").value("ok").endObject();
+    json.flush();
 }
 
 /*
@@ -37,14 +37,17 @@ mail:   marchammermann@googlemail.com
 #ifdef PORTDUINO_LINUX_HARDWARE
 #if __has_include(<ulfius.h>)
 #include "PiWebServer.h"
+#include "LiveFeed.h"
 #include "NodeDB.h"
 #include "PhoneAPI.h"
 #include "PowerFSM.h"
 #include "RadioLibInterface.h"
+#include "RouteCache.h"
 #include "airtime.h"
 #include "graphics/Screen.h"
 #include "main.h"
 #include "mesh/wifi/WiFiAPClient.h"
+#include "modules/TraceRouteModule.h"
 #include "sleep.h"
 #include <openssl/bn.h>
 #include <openssl/evp.h>
@@ -302,6 +305,194 @@ int handleAPIv1FromRadio(const struct _u_request *req, struct _u_response *res,
     return U_CALLBACK_COMPLETE;
 }
 
+// Longest a long poll on /api/v1/live is held open, and how often an idle event stream sends a comment to keep proxies from
+// closing it. Both well inside LiveFeed::VIEWER_TIMEOUT_MS.
+#define LIVE_MAX_WAIT_MS 30000
+#define LIVE_KEEPALIVE_MS 15000
+
+static uint32_t liveCursor(const struct _u_map *map, const char *key, uint32_t fallback)
+{
+    const char *value = u_map_get_case(map, key);
+    return value ? strtoul(value, NULL, 10) : fallback;
+}
+
+/*
+ * Every packet the phone would get, for any number of viewers (see LiveFeed). Unlike /api/v1/fromradio this does not
+ * drain the PhoneAPI, so browsers no longer take packets from each other.
+ *
+ * GET /api/v1/live?since=N&wait=S holds the request open up to S seconds (at most 30) until there is something after
+ * cursor N, then answers with the FromRadio protobufs framed like StreamAPI frames them (0x94 0xc3, then the length big
+ * endian). X-Live-Next is the cursor to ask with next time, X-Live-Dropped the packets missed by falling behind. Without
+ * since the client gets everything still held.
+ */
+int handleAPIv1Live(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/x-protobuf");
+    ulfius_add_header_to_response(res, "Access-Control-Allow-Origin", "*");
+    ulfius_add_header_to_response(res, "Access-Control-Allow-Methods", "GET");
+    ulfius_add_header_to_response(res, "Access-Control-Expose-Headers", "X-Live-Next, X-Live-Dropped");
+    ulfius_add_header_to_response(res, "Cache-Control", "no-store");
+    ulfius_add_header_to_response(res, "X-Protobuf-Schema",
+                                  "https://raw.githubusercontent.com/meshtastic/protobufs/master/meshtastic/mesh.proto");
+
+    if (strcmp(req->http_verb, "OPTIONS") == 0) {
+        ulfius_set_response_properties(res, U_OPT_STATUS, 204);
+        return U_CALLBACK_COMPLETE;
+    }
+
+    LiveFeed::Frames &frames = liveFeed->watch();
+    uint32_t cursor = liveCursor(req->map_url, "since", frames.oldest());
+    uint32_t waitMs = liveCursor(req->map_url, "wait", 0) * 1000;
+    if (waitMs > LIVE_MAX_WAIT_MS)
+        waitMs = LIVE_MAX_WAIT_MS;
+    if (waitMs)
+        frames.wait(cursor, waitMs);
+
+    // Everything the feed holds fits, so one answer always catches the client up
+    static const size_t FRAME_BYTES = 4 + meshtastic_FromRadio_size;
+    uint8_t *body = (uint8_t *)malloc(LIVE_FEED_SLOTS * FRAME_BYTES);
+    size_t used = 0;
+    uint32_t dropped = 0, skipped;
+    while (used + FRAME_BYTES <= LIVE_FEED_SLOTS * FRAME_BYTES) {
+        size_t length = frames.read(cursor, body + used + 4, skipped);
+        dropped += skipped;
+        if (!length)
+            break;
+        body[used] = 0x94;
+        body[used + 1] = 0xc3;
+        body[used + 2] = (length >> 8) & 0xff;
+        body[used + 3] = length & 0xff;
+        used += 4 + length;
+    }
+
+    char header[12];
+    snprintf(header, sizeof(header), "%u", cursor);
+    ulfius_add_header_to_response(res, "X-Live-Next", header);
+    snprintf(header, sizeof(header), "%u", dropped);
+    ulfius_add_header_to_response(res, "X-Live-Dropped", header);
+    ulfius_set_binary_body_response(res, 200, (const char *)body, used);
+    free(body);
+    return U_CALLBACK_COMPLETE;
+}
+
+/// One /api/v1/live/events viewer
+struct LiveEventStream {
+    uint32_t cursor;
+    uint8_t frame[meshtastic_FromRadio_size];
+    char encoded[4 * ((meshtastic_FromRadio_size + 2) / 3) + 1];
+};
+
+// Room for an event, "id: <cursor>\ndata: <base64 FromRadio>\n\n", and a dropped event before it
+#define LIVE_EVENT_MAX (sizeof(LiveEventStream::encoded) + 64)
+#define LIVE_EVENT_BLOCK (4 * LIVE_EVENT_MAX)
+
+/**
+ * Called by the server's thread for this connection whenever the client has taken everything sent so far. A client that
+ * reads slowly just gets called less often and falls behind in the feed, it never holds up the radio or other viewers.
+ */
+static ssize_t liveEventsStream(void *cls, uint64_t pos, char *buf, size_t max)
+{
+    (void)(pos);
+    LiveEventStream *stream = (LiveEventStream *)cls;
+    LiveFeed::Frames &frames = liveFeed->watch();
+    if (!frames.wait(stream->cursor, LIVE_KEEPALIVE_MS))
+        return frames.isClosed() ? U_STREAM_END : snprintf(buf, max, ": keepalive\n\n");
+
+    size_t used = 0;
+    uint32_t dropped;
+    while (max - used >= LIVE_EVENT_MAX) {
+        size_t length = frames.read(stream->cursor, stream->frame, dropped);
+        if (dropped)
+            used += snprintf(buf + used, max - used, "event: dropped\ndata: %u\n\n", dropped);
+        if (!length)
+            break;
+        size_t encodedLength = 0;
+        o_base64_encode(stream->frame, length, (unsigned char *)stream->encoded, &encodedLength);
+        stream->encoded[encodedLength] = '\0';
+        used += snprintf(buf + used, max - used, "id: %u\ndata: %s\n\n", stream->cursor, stream->encoded);
+    }
+    return used ? used : snprintf(buf, max, ": keepalive\n\n"); // 0 would have the server call straight back
+}
+
+static void liveEventsStreamFree(void *cls)
+{
+    delete (LiveEventStream *)cls;
+}
+
+/*
+ * GET /api/v1/live/events: the same feed as Server-Sent Events. Each event's data is one base64 FromRadio protobuf and
+ * its id the cursor after it, so a reconnecting EventSource resumes where it left off via Last-Event-ID.
+ */
+int handleAPIv1LiveEvents(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    LiveFeed::Frames &frames = liveFeed->watch();
+    LiveEventStream *stream = new LiveEventStream();
+    stream->cursor = liveCursor(req->map_header, "Last-Event-ID", frames.next());
+
+    ulfius_add_header_to_response(res, "Content-Type", "text/event-stream");
+    ulfius_add_header_to_response(res, "Cache-Control", "no-store");
+    if (ulfius_set_stream_response(res, 200, liveEventsStream, liveEventsStreamFree, U_STREAM_SIZE_UNKNOWN, LIVE_EVENT_BLOCK,
+                                   stream) != U_OK) {
+        LOG_DEBUG("handleAPIv1LiveEvents - Error ulfius_set_stream_response");
+        delete stream;
+        return U_CALLBACK_ERROR;
+    }
+    return U_CALLBACK_COMPLETE;
+}
+
+/// Where a JSONWriter puts a response ulfius wants in one piece
+struct StringOutput {
+    std::string text;
+    void write(const uint8_t *bytes, size_t length) { text.append((const char *)bytes, length); }
+};
+
+static void setJsonHeaders(struct _u_response *res)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/json");
+    ulfius_add_header_to_response(res, "Access-Control-Allow-Origin", "*");
+    ulfius_add_header_to_response(res, "Access-Control-Allow-Methods", "GET");
+    ulfius_add_header_to_response(res, "Cache-Control", "no-store");
+}
+
+/*
+ * GET /api/v1/topology: what routeCache knows of the mesh, from memory. Every edge with the SNR it was heard at, its
+ * delivery ratio and its age in seconds, and the routes traced lately.
+ */
+int handleAPIv1Topology(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    setJsonHeaders(res);
+    StringOutput out;
+    {
+        JSONWriter<StringOutput> json(out);
+        routeCache.writeTopology(json, millis());
+    }
+    ulfius_set_string_body_response(res, 200, out.text.c_str());
+    return U_CALLBACK_COMPLETE;
+}
+
+/*
+ * GET /api/v1/traceroute?to=!a1b2c3d4,!... answers straight away with the route known to each node, and queues a trace to
+ * those not traced lately (all of them with &refresh=1). The traces go out a few at a time as the channel allows, so asking
+ * again later picks up their answers.
+ */
+int handleAPIv1TraceRoute(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    setJsonHeaders(res);
+    if (!traceRouteModule) {
+        ulfius_set_response_properties(res, U_OPT_STATUS, 404);
+        return U_CALLBACK_COMPLETE;
+    }
+    const char *to = u_map_get(req->map_url, "to");
+    const char *refresh = u_map_get(req->map_url, "refresh");
+    StringOutput out;
+    {
+        JSONWriter<StringOutput> json(out);
+        traceRouteModule->writeLookups(json, to ? to : "", refresh && (!strcmp(refresh, "1") || !strcmp(refresh, "true")));
+    }
+    ulfius_set_string_body_response(res, 200, out.text.c_str());
+    return U_CALLBACK_COMPLETE;
+}
+
 /*
 OpenSSL RSA Key Gen
 */
@@ -503,6 +694,12 @@ PiWebServerThread::PiWebServerThread()
         ulfius_add_endpoint_by_val(&instanceWeb, "OPTIONS", PREFIX, "/api/v1/fromradio/*", 1, &handleAPIv1FromRadio, &webAPI);
         ulfius_add_endpoint_by_val(&instanceWeb, "PUT", PREFIX, "/api/v1/toradio/*", 1, &handleAPIv1ToRadio, &webAPI);
         ulfius_add_endpoint_by_val(&instanceWeb, "OPTIONS", PREFIX, "/api/v1/toradio/*", 1, &handleAPIv1ToRadio, &webAPI);
+        liveFeed = new LiveFeed();
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", PREFIX, "/api/v1/live/events", 0, &handleAPIv1LiveEvents, NULL);
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", PREFIX, "/api/v1/live", 1, &handleAPIv1Live, NULL);
+        ulfius_add_endpoint_by_val(&instanceWeb, "OPTIONS", PREFIX, "/api/v1/live", 1, &handleAPIv1Live, NULL);
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", PREFIX, "/api/v1/topology", 1, &handleAPIv1Topology, NULL);
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", PREFIX, "/api/v1/traceroute", 1, &handleAPIv1TraceRoute, NULL);
 
         // Add callback function to all endpoints for the Web Server
         ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/*", 2, &callback_static_file, &configWeb);
@@ -526,6 +723,8 @@ PiWebServerThread::~PiWebServerThread()
 {
     u_map_clean(&configWeb.mime_types);
 
+    if (liveFeed)
+        liveFeed->watch().close(); // Ends the event streams, which would otherwise keep the server from stopping
     ulfius_stop_framework(&instanceWeb);
     ulfius_clean_instance(&instanceWeb);
     free(configWeb.rootPath);
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Datagram framing for the UDP multicast bridge.
+ *
+ * A legacy datagram is one bare encoded MeshPacket. A batch carries several, each behind a little endian length:
+ *
+ *   [MARKER][VERSION] [length:2][MeshPacket] [length:2][MeshPacket] ...
+ *
+ * No MeshPacket encoding starts with a zero byte, and nanopb takes one as the end of the message, so a node from before
+ * batching decodes a batch as an empty MeshPacket and ignores it.
+ */
+namespace UdpBatch
+{
+
+static constexpr uint8_t MARKER = 0x00, VERSION = 1;
+static constexpr size_t HEADER_BYTES = 2, LENGTH_BYTES = 2;
+/// The nRF52 Ethernet gateways read no more of a datagram than this, so no batch is longer
+static constexpr size_t MAX_DATAGRAM = 512;
+
+inline bool isBatch(const uint8_t *data, size_t length)
+{
+    return length >= HEADER_BYTES && data[0] == MARKER;
+}
+
+/// A datagram being filled, packets are encoded straight into it
+struct Datagram {
+    uint8_t bytes[MAX_DATAGRAM];
+    size_t length = 0;
+    uint8_t count = 0;
+
+    void clear()
+    {
+        length = 0;
+        count = 0;
+    }
+
+    /// Where the next packet goes, with room set to how many bytes it may take
+    uint8_t *reserve(size_t &room)
+    {
+        size_t used = (length ? length : HEADER_BYTES) + LENGTH_BYTES;
+        room = used < MAX_DATAGRAM ? MAX_DATAGRAM - used : 0;
+        return bytes + used;
+    }
+
+    /// Keep the packetLength bytes written at reserve()
+    void commit(size_t packetLength)
+    {
+        if (!length) {
+            bytes[0] = MARKER;
+            bytes[1] = VERSION;
+            length = HEADER_BYTES;
+        }
+        bytes[length] = packetLength;
+        bytes[length + 1] = packetLength >> 8;
+        length += LENGTH_BYTES + packetLength;
+        count++;
+    }
+};
+
+/**
+ * Call visit(bytes, length) for each packet in a datagram, batched or legacy.
+ *
+ * @return how many packets were visited. A batch from a newer version is skipped whole, a record running past the end stops
+ * the walk.
+ */
+template <typename Visit> size_t forEach(const uint8_t *data, size_t length, Visit visit)
+{
+    if (!isBatch(data, length)) {
+        if (!length)
+            return 0;
+        visit(data, length);
+        return 1;
+    }
+    if (data[1] != VERSION)
+        return 0;
+    size_t pos = HEADER_BYTES, count = 0;
+    while (length - pos >= LENGTH_BYTES) {
+        size_t packetLength = data[pos] | data[pos + 1] << 8;
+        pos += LENGTH_BYTES;
+        if (!packetLength || packetLength > length - pos)
+            break;
+        visit(data + pos, packetLength);
+        pos += packetLength;
+        count++;
+    }
+    return count;
+}
+
+/// The MeshPacket fields a duplicate check looks at
+struct Ids {
+    uint32_t from, to, id;
+    uint8_t hopLimit, hopStart, nextHop, relayNode;
+    bool encrypted;
+};
+
+/**
+ * Read the duplicate check fields of an encoded MeshPacket by walking its top level tags, without decoding the payload.
+ * @return false if the encoding is malformed
+ */
+inline bool peek(const uint8_t *packet, size_t length, Ids &ids)
+{
+    memset(&ids, 0, sizeof(ids));
+    size_t pos = 0;
+    auto varint = [&](uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < length; shift += 7) {
+            uint8_t b = packet[pos++];
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    };
+    while (pos < length) {
+        uint64_t key, value = 0;
+        if (!varint(key))
+            return false;
+        uint32_t field = key >> 3;
+        switch (key & 7) {
+        case 0: // varint
+            if (!varint(value))
+                return false;
+            break;
+        case 1: // fixed64
+            if (length - pos < 8)
+                return false;
+            pos += 8;
+            break;
+        case 2: // length delimited
+            if (!varint(value) || value > length - pos)
+                return false;
+            pos += value;
+            break;
+        case 5: // fixed32
+            if (length - pos < 4)
+                return false;
+            value = packet[pos] | packet[pos + 1] << 8 | packet[pos + 2] << 16 | (uint32_t)packet[pos + 3] << 24;
+            pos += 4;
+            break;
+        default:
+            return false;
+        }
+        switch (field) {
+        case 1:
+            ids.from = value;
+            break;
+        case 2:
+            ids.to = value;
+            break;
+        case 5:
+            ids.encrypted = true;
+            break;
+        case 6:
+            ids.id = value;
+            break;
+        case 9:
+            ids.hopLimit = value;
+            break;
+        case 15:
+            ids.hopStart = value;
+            break;
+        case 18:
+            ids.nextHop = value;
+            break;
+        case 19:
+            ids.relayNode = value;
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * Transmissions lately let in from the LAN, to drop the copies other gateways bridge of the same one before the router sees
+ * it. A copy only matches if its hop limit, relayer and next hop match too, so a relay of the packet is not a copy of it.
+ */
+template <size_t Size> class RecentRing
+{
+  public:
+    /// @return true if the transmission is already held, else remember it
+    bool checkAndAdd(const Ids &ids)
+    {
+        for (size_t i = 0; i < Size; i++) {
+            const Entry &e = entries[i];
+            if (e.id == ids.id && e.from == ids.from && e.hopLimit == ids.hopLimit && e.relayNode == ids.relayNode &&
+                e.nextHop == ids.nextHop)
+                return true;
+        }
+        entries[next] = {ids.from, ids.id, ids.hopLimit, ids.relayNode, ids.nextHop};
+        next = (next + 1) % Size;
+        return false;
+    }
+
+  private:
+    struct Entry {
+        uint32_t from, id;
+        uint8_t hopLimit, relayNode, nextHop;
+    };
+    Entry entries[Size] = {};
+    size_t next = 0;
+};
+
+} // namespace UdpBatch
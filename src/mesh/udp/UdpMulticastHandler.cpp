@@ -0,0 +1,272 @@
+#include "configuration.h"
+#if HAS_UDP_MULTICAST
+#include "UdpMulticastHandler.h"
+#include "concurrency/LockGuard.h"
+#include "main.h"
+#include "mesh/mesh-pb-constants.h"
+#include <errno.h>
+#include <pb_encode.h>
+
+static constexpr uint32_t UDP_MULTICAST_GROUP = 0xe0000045; // 224.0.0.69
+
+UdpMulticastHandler::UdpMulticastHandler() : concurrency::OSThread("UdpMulticast")
+{
+#if !UDP_MULTICAST_MMSG
+    udpIpAddress = IPAddress(224, 0, 0, 69);
+#endif
+}
+
+void UdpMulticastHandler::start()
+{
+#if UDP_MULTICAST_MMSG
+    if (!socket.listen(UDP_MULTICAST_GROUP, UDP_MULTICAST_DEFAUL_PORT, 64)) {
+        LOG_DEBUG("Failed to listen on UDP: %s", strerror(errno));
+        return;
+    }
+    LOG_DEBUG("UDP Listening on IP: 224.0.0.69:%u", UDP_MULTICAST_DEFAUL_PORT);
+#else
+    if (!udp.listenMulticast(udpIpAddress, UDP_MULTICAST_DEFAUL_PORT, 64)) {
+        LOG_DEBUG("Failed to listen on UDP");
+        return;
+    }
+#if defined(ARCH_NRF52) || defined(ARCH_PORTDUINO)
+    LOG_DEBUG("UDP Listening on IP: %u.%u.%u.%u:%u", udpIpAddress[0], udpIpAddress[1], udpIpAddress[2], udpIpAddress[3],
+              UDP_MULTICAST_DEFAUL_PORT);
+#else
+    LOG_DEBUG("UDP Listening on IP: %s", WiFi.localIP().toString().c_str());
+#endif
+    udp.onPacket([this](AsyncUDPPacket packet) { onReceive(packet); });
+#endif
+    enabled = true;
+    setIntervalFromNow(0);
+}
+
+bool UdpMulticastHandler::isListening()
+{
+#if UDP_MULTICAST_MMSG
+    return (bool)socket;
+#else
+    return (bool)udp;
+#endif
+}
+
+int32_t UdpMulticastHandler::runOnce()
+{
+    if (!isListening())
+        return disable();
+#if UDP_MULTICAST_MMSG
+    size_t received = socket.receive([this](const uint8_t *bytes, size_t length) { receiveDatagram(bytes, length); });
+#else
+    size_t received = drainInbox();
+#endif
+    bool sent = outgoingCount;
+    flush();
+    // Back off while nothing comes or goes, onSend brings us back
+    if (received || sent)
+        pollMs = POLL_MS;
+    else if (pollMs < IDLE_POLL_MS)
+        pollMs *= 2;
+    return pollMs;
+}
+
+#if !UDP_MULTICAST_MMSG
+void UdpMulticastHandler::onReceive(AsyncUDPPacket &packet)
+{
+    size_t packetLength = packet.length();
+#if defined(ARCH_NRF52)
+    IPAddress ip = packet.remoteIP();
+    LOG_DEBUG("UDP broadcast from: %u.%u.%u.%u, len=%u", ip[0], ip[1], ip[2], ip[3], packetLength);
+#elif !defined(ARCH_PORTDUINO)
+    // FIXME(PORTDUINO): arduino lacks IPAddress::toString()
+    LOG_DEBUG("UDP broadcast from: %s, len=%u", packet.remoteIP().toString().c_str(), packetLength);
+#endif
+    if (!packetLength || packetLength > UdpBatch::MAX_DATAGRAM)
+        return;
+    concurrency::LockGuard guard(&inboxLock);
+    if (inboxCount == INBOX_DATAGRAMS) {
+        inboxDropped++;
+        return;
+    }
+    InboxDatagram &slot = inbox[(inboxHead + inboxCount) % INBOX_DATAGRAMS];
+    memcpy(slot.bytes, packet.data(), packetLength);
+    slot.length = packetLength;
+    inboxCount++;
+    // Like TypedQueue::enqueue for a reader thread
+    setInterval(0);
+    concurrency::mainDelay.interrupt();
+}
+
+size_t UdpMulticastHandler::drainInbox()
+{
+    size_t drained = 0;
+    for (;;) {
+        InboxDatagram *slot;
+        uint32_t dropped;
+        {
+            concurrency::LockGuard guard(&inboxLock);
+            if (!inboxCount)
+                break;
+            slot = &inbox[inboxHead];
+            dropped = inboxDropped;
+            inboxDropped = 0;
+        }
+        if (dropped)
+            LOG_WARN("UDP inbox full, dropped %u datagram(s)", dropped);
+        // The slot stays ours until it is counted out, AsyncUDP only fills free ones
+        receiveDatagram(slot->bytes, slot->length);
+        concurrency::LockGuard guard(&inboxLock);
+        inboxHead = (inboxHead + 1) % INBOX_DATAGRAMS;
+        inboxCount--;
+        drained++;
+    }
+    return drained;
+}
+#endif
+
+void UdpMulticastHandler::receiveDatagram(const uint8_t *bytes, size_t length)
+{
+    UdpBatch::forEach(bytes, length, [this](const uint8_t *packet, size_t packetLength) { receivePacket(packet, packetLength); });
+}
+
+// Copies straight from the original sender (hop_start == hop_limit) always go through, the router answers a retransmission of
+// a packet it has seen with another relay or ACK. An identical copy of a transmission let in moments ago is dropped even when
+// the router's duplicate handling would act on it: that handling is for hearing a packet again, and this is the same
+// transmission heard by another gateway, which the router acts on once, for the first copy
+bool UdpMulticastHandler::isDuplicate(const UdpBatch::Ids &ids)
+{
+    if (!ids.id || (ids.hopStart && ids.hopStart == ids.hopLimit))
+        return false;
+    peeked.from = ids.from;
+    peeked.to = ids.to;
+    peeked.id = ids.id;
+    peeked.hop_limit = ids.hopLimit;
+    peeked.hop_start = ids.hopStart;
+    peeked.next_hop = ids.nextHop;
+    peeked.relay_node = ids.relayNode;
+    // The ring catches the copies that arrive before the router has taken the first from its queue
+    return router->isDuplicate(&peeked) || recent.checkAndAdd(ids);
+}
+
+void UdpMulticastHandler::receivePacket(const uint8_t *bytes, size_t length)
+{
+    UdpBatch::Ids ids;
+    if (!router || !UdpBatch::peek(bytes, length, ids) || !ids.encrypted)
+        return;
+    if (isDuplicate(ids)) {
+        if (++duplicatesDropped % 100 == 1)
+            LOG_DEBUG("Dropped %u duplicate UDP packet(s) so far", duplicatesDropped);
+        return;
+    }
+
+    meshtastic_MeshPacket *p = packetPool.allocZeroed();
+    if (!p)
+        return;
+    LOG_DEBUG("Decoding MeshPacket from UDP len=%u", length);
+    if (!pb_decode_from_bytes(bytes, length, &meshtastic_MeshPacket_msg, p) ||
+        p->which_payload_variant != meshtastic_MeshPacket_encrypted_tag) {
+        packetPool.release(p);
+        return;
+    }
+    p->transport_mechanism = meshtastic_MeshPacket_TransportMechanism_TRANSPORT_MULTICAST_UDP;
+    p->pki_encrypted = false;
+    p->public_key.size = 0;
+    memset(p->public_key.bytes, 0, sizeof(p->public_key.bytes));
+    // Unset received SNR/RSSI
+    p->rx_snr = 0;
+    p->rx_rssi = 0;
+    router->enqueueReceivedMessage(p);
+}
+
+bool UdpMulticastHandler::onSend(const meshtastic_MeshPacket *mp)
+{
+    if (!mp || !isListening()) {
+        return false;
+    }
+#if defined(ARCH_NRF52)
+    if (!isEthernetAvailable()) {
+        return false;
+    }
+#elif !defined(ARCH_PORTDUINO)
+    if (WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+#endif
+    if (mp->transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_MULTICAST_UDP) {
+        // A packet from the LAN that we relay: every gateway there had it already
+        return false;
+    }
+    LOG_DEBUG("Broadcasting packet over UDP (id=%u)", mp->id);
+    if (!queue(mp)) {
+        return false;
+    }
+#if !UDP_MULTICAST_MMSG && !USERPREFS_UDP_MULTICAST_BATCH
+    // Nothing to gain from waiting
+    flush();
+#else
+    if (pollMs > POLL_MS) {
+        pollMs = POLL_MS;
+        setIntervalFromNow(POLL_MS);
+    }
+#endif
+    return true;
+}
+
+// Encode into the datagram being filled, else into a new one
+bool UdpMulticastHandler::queue(const meshtastic_MeshPacket *mp)
+{
+#if USERPREFS_UDP_MULTICAST_BATCH
+    if (outgoingCount) {
+        UdpBatch::Datagram &last = outgoing[outgoingCount - 1];
+        size_t room;
+        uint8_t *at = last.reserve(room);
+        // Not fitting is expected here, so no pb_encode_to_bytes and its error log
+        pb_ostream_t stream = pb_ostream_from_buffer(at, room);
+        if (pb_encode(&stream, &meshtastic_MeshPacket_msg, mp)) {
+            last.commit(stream.bytes_written);
+            return true;
+        }
+    }
+#endif
+    if (outgoingCount == OUTGOING_DATAGRAMS)
+        flush();
+    UdpBatch::Datagram &next = outgoing[outgoingCount];
+    next.clear();
+#if USERPREFS_UDP_MULTICAST_BATCH
+    size_t room;
+    uint8_t *at = next.reserve(room);
+    size_t length = pb_encode_to_bytes(at, room, &meshtastic_MeshPacket_msg, mp);
+    if (!length)
+        return false;
+    next.commit(length);
+#else
+    next.length = pb_encode_to_bytes(next.bytes, sizeof(next.bytes), &meshtastic_MeshPacket_msg, mp);
+    if (!next.length)
+        return false;
+    next.count = 1;
+#endif
+    outgoingCount++;
+    return true;
+}
+
+void UdpMulticastHandler::flush()
+{
+    if (!outgoingCount)
+        return;
+#if UDP_MULTICAST_MMSG
+    const uint8_t *datagrams[OUTGOING_DATAGRAMS];
+    size_t lengths[OUTGOING_DATAGRAMS];
+    for (uint8_t i = 0; i < outgoingCount; i++) {
+        datagrams[i] = outgoing[i].bytes;
+        lengths[i] = outgoing[i].length;
+    }
+    size_t sent = socket.send(datagrams, lengths, outgoingCount);
+    if (sent < outgoingCount)
+        LOG_WARN("UDP send failed for %u of %u datagram(s): %s", outgoingCount - sent, outgoingCount, strerror(errno));
+#else
+    for (uint8_t i = 0; i < outgoingCount; i++)
+        udp.writeTo(outgoing[i].bytes, outgoing[i].length, udpIpAddress, UDP_MULTICAST_DEFAUL_PORT);
+#endif
+    outgoingCount = 0;
+}
+
+#endif // HAS_UDP_MULTICAST
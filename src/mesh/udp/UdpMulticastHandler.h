@@ -1,8 +1,10 @@
 #pragma once
 #if HAS_UDP_MULTICAST
+#include "concurrency/Lock.h"
+#include "concurrency/OSThread.h"
 #include "configuration.h"
-#include "main.h"
 #include "mesh/Router.h"
+#include "mesh/udp/UdpBatch.h"
 
 #if HAS_ETHERNET && defined(ARCH_NRF52)
 #include "mesh/eth/ethClient.h"
@@ -17,80 +19,78 @@
 #define ETH ETH2
 #endif // HAS_ETHERNET
 
+#if defined(ARCH_PORTDUINO) && defined(__linux__)
+#define UDP_MULTICAST_MMSG 1
+#include "platform/portduino/MulticastSocket.h"
+#endif
+
 #define UDP_MULTICAST_DEFAUL_PORT 4403 // Default port for UDP multicast is same as TCP api server
 
-class UdpMulticastHandler final
+/**
+ * Bridges mesh packets between gateways that share a LAN, over UDP multicast.
+ *
+ * Outgoing packets are encoded straight into a datagram and sent within a few milliseconds. With USERPREFS_UDP_MULTICAST_BATCH
+ * several share one datagram (see UdpBatch.h), which every gateway on the LAN must understand; incoming batches are always
+ * understood.
+ *
+ * Before anything is allocated, an incoming packet is checked against the router's packet history and against the
+ * transmissions lately let in, so a LoRa transmission that several gateways bridge reaches our router once. Copies the router's
+ * duplicate handling still has work for (see Router::isDuplicate) go on to it. What is left is decoded straight into the
+ * packet pool. All of this runs on this thread, the router's: on Linux it reads the socket with recvmmsg, 16 datagrams per
+ * system call, polling less often while the LAN is quiet; elsewhere AsyncUDP calls back from the network stack, and the
+ * datagram waits in a small inbox and wakes us.
+ */
+class UdpMulticastHandler final : private concurrency::OSThread
 {
   public:
-    UdpMulticastHandler() { udpIpAddress = IPAddress(224, 0, 0, 69); }
-
-    void start()
-    {
-        if (udp.listenMulticast(udpIpAddress, UDP_MULTICAST_DEFAUL_PORT, 64)) {
-#if defined(ARCH_NRF52) || defined(ARCH_PORTDUINO)
-            LOG_DEBUG("UDP Listening on IP: %u.%u.%u.%u:%u", udpIpAddress[0], udpIpAddress[1], udpIpAddress[2], udpIpAddress[3],
-                      UDP_MULTICAST_DEFAUL_PORT);
-#else
-            LOG_DEBUG("UDP Listening on IP: %s", WiFi.localIP().toString().c_str());
-#endif
-            udp.onPacket([this](AsyncUDPPacket packet) { onReceive(packet); });
-        } else {
-            LOG_DEBUG("Failed to listen on UDP");
-        }
-    }
+    UdpMulticastHandler();
 
-    void onReceive(AsyncUDPPacket packet)
-    {
-        size_t packetLength = packet.length();
-#if defined(ARCH_NRF52)
-        IPAddress ip = packet.remoteIP();
-        LOG_DEBUG("UDP broadcast from: %u.%u.%u.%u, len=%u", ip[0], ip[1], ip[2], ip[3], packetLength);
-#elif !defined(ARCH_PORTDUINO)
-        // FIXME(PORTDUINO): arduino lacks IPAddress::toString()
-        LOG_DEBUG("UDP broadcast from: %s, len=%u", packet.remoteIP().toString().c_str(), packetLength);
-#endif
-        meshtastic_MeshPacket mp;
-        LOG_DEBUG("Decoding MeshPacket from UDP len=%u", packetLength);
-        bool isPacketDecoded = pb_decode_from_bytes(packet.data(), packetLength, &meshtastic_MeshPacket_msg, &mp);
-        if (isPacketDecoded && router && mp.which_payload_variant == meshtastic_MeshPacket_encrypted_tag) {
-            mp.transport_mechanism = meshtastic_MeshPacket_TransportMechanism_TRANSPORT_MULTICAST_UDP;
-            mp.pki_encrypted = false;
-            mp.public_key.size = 0;
-            memset(mp.public_key.bytes, 0, sizeof(mp.public_key.bytes));
-            UniquePacketPoolPacket p = packetPool.allocUniqueCopy(mp);
-            // Unset received SNR/RSSI
-            p->rx_snr = 0;
-            p->rx_rssi = 0;
-            router->enqueueReceivedMessage(p.release());
-        }
-    }
+    void start();
 
-    bool onSend(const meshtastic_MeshPacket *mp)
-    {
-        if (!mp || !udp) {
-            return false;
-        }
-#if defined(ARCH_NRF52)
-        if (!isEthernetAvailable()) {
-            return false;
-        }
-#elif !defined(ARCH_PORTDUINO)
-        if (WiFi.status() != WL_CONNECTED) {
-            return false;
-        }
-#endif
-        if (mp->transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_MULTICAST_UDP) {
-            LOG_ERROR("Attempt to send UDP sourced packet over UDP");
-        }
-        LOG_DEBUG("Broadcasting packet over UDP (id=%u)", mp->id);
-        uint8_t buffer[meshtastic_MeshPacket_size];
-        size_t encodedLength = pb_encode_to_bytes(buffer, sizeof(buffer), &meshtastic_MeshPacket_msg, mp);
-        udp.writeTo(buffer, encodedLength, udpIpAddress, UDP_MULTICAST_DEFAUL_PORT);
-        return true;
-    }
+    bool onSend(const meshtastic_MeshPacket *mp);
 
   private:
+    static constexpr uint32_t POLL_MS = 5;
+    static constexpr uint32_t IDLE_POLL_MS = 160;
+    static constexpr size_t RECENT_PACKETS = 32;
+
+#if UDP_MULTICAST_MMSG
+    static constexpr uint8_t OUTGOING_DATAGRAMS = MulticastSocket::BATCH;
+    MulticastSocket socket;
+#else
+    static constexpr uint8_t OUTGOING_DATAGRAMS = 1;
+    static constexpr uint8_t INBOX_DATAGRAMS = 4;
+
+    struct InboxDatagram {
+        uint8_t bytes[UdpBatch::MAX_DATAGRAM];
+        size_t length;
+    };
+
     IPAddress udpIpAddress;
     AsyncUDP udp;
+    InboxDatagram inbox[INBOX_DATAGRAMS];
+    uint8_t inboxHead = 0, inboxCount = 0;
+    uint32_t inboxDropped = 0;
+    concurrency::Lock inboxLock;
+
+    /// From AsyncUDP's task: copy the datagram for runOnce and wake it
+    void onReceive(AsyncUDPPacket &packet);
+    size_t drainInbox();
+#endif
+
+    UdpBatch::Datagram outgoing[OUTGOING_DATAGRAMS];
+    uint8_t outgoingCount = 0;
+    UdpBatch::RecentRing<RECENT_PACKETS> recent;
+    meshtastic_MeshPacket peeked = meshtastic_MeshPacket_init_zero;
+    uint32_t duplicatesDropped = 0;
+    uint32_t pollMs = POLL_MS;
+
+    int32_t runOnce() override;
+    bool isListening();
+    bool queue(const meshtastic_MeshPacket *mp);
+    void flush();
+    void receiveDatagram(const uint8_t *bytes, size_t length);
+    void receivePacket(const uint8_t *bytes, size_t length);
+    bool isDuplicate(const UdpBatch::Ids &ids);
 };
-#endif // HAS_UDP_MULTICAST
\ No newline at end of file
+#endif // HAS_UDP_MULTICAST
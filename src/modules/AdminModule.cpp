@@ -615,7 +615,7 @@ void AdminModule::handleSetConfig(const meshtastic_Config &c)
                       meshtastic_Config_DeviceConfig_Role_REPEATER)) {
             config.device.rebroadcast_mode = meshtastic_Config_DeviceConfig_RebroadcastMode_ALL;
             const char *warning = "Rebroadcast mode can't be set to NONE for a router or repeater";
-            LOG_WARN(warning);
+            LOG_WARN("%s", warning);
             sendWarning(warning);
         }
         // If we're setting router role for the first time, install its intervals
@@ -801,7 +801,7 @@ void AdminModule::handleSetConfig(const meshtastic_Config &c)
                                             config.security.admin_key[2].size == 32)) {
             config.security.is_managed = false;
             const char *warning = "You must provide at least one admin public key to enable managed mode";
-            LOG_WARN(warning);
+            LOG_WARN("%s", warning);
             sendWarning(warning);
         }
 
@@ -270,7 +270,7 @@ void KeyVerificationModule::processSecurityNumber(uint32_t incomingNumber)
             sizeof(cn->payload_variant.key_verification_final.remote_longname));
     cn->payload_variant.key_verification_final.isSender = true;
     service->sendClientNotification(cn);
-    LOG_INFO(message);
+    LOG_INFO("%s", message);
 
     return;
 }
@@ -99,6 +99,8 @@
 #if !MESHTASTIC_EXCLUDE_RANGETEST && !MESHTASTIC_EXCLUDE_GPS
 #include "modules/RangeTestModule.h"
 #endif
+#include "modules/fragment/FragmentModule.h"
+#include "modules/gate/GateControlModule.h"
 #include "modules/irrigation/IrrigationModule.h"
 #if !defined(CONFIG_IDF_TARGET_ESP32S2) && !MESHTASTIC_EXCLUDE_SERIAL
 #include "modules/SerialModule.h"
@@ -300,8 +302,12 @@ void setupModules()
         if (moduleConfig.has_range_test && moduleConfig.range_test.enabled)
             new RangeTestModule();
 #endif
+        // Payloads larger than one packet, before the modules that send them
+        fragmentModule = new FragmentModule();
         // Irrigation module
         irrigationModule = new IrrigationModule();
+        // Gate access control
+        gateControlModule = new GateControlModule();
     } else {
 #if !MESHTASTIC_EXCLUDE_ADMIN
         adminModule = new AdminModule();
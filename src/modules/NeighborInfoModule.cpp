@@ -1,9 +1,9 @@
 #include "NeighborInfoModule.h"
 #include "Default.h"
+#include "LinkTable.h"
 #include "MeshService.h"
 #include "NodeDB.h"
-#include "RTC.h"
-#include <Throttle.h>
+#include "RouteCache.h"
 
 NeighborInfoModule *neighborInfoModule;
 
@@ -22,18 +22,6 @@ void NeighborInfoModule::printNeighborInfo(const char *header, const meshtastic_
     }
 }
 
-/*
-Prints the nodeDB neighbors
-NOTE: for debugging only
-*/
-void NeighborInfoModule::printNodeDBNeighbors()
-{
-    LOG_DEBUG("Our NodeDB contains %d neighbors", neighbors.size());
-    for (size_t i = 0; i < neighbors.size(); i++) {
-        LOG_DEBUG("Node %d: node_id=0x%x, snr=%.2f", i, neighbors[i].node_id, neighbors[i].snr);
-    }
-}
-
 /* Send our initial owner announcement 35 seconds after we start (to give network time to setup) */
 NeighborInfoModule::NeighborInfoModule()
     : ProtobufModule("neighborinfo", meshtastic_PortNum_NEIGHBORINFO_APP, &meshtastic_NeighborInfo_msg),
@@ -53,11 +41,12 @@ NeighborInfoModule::NeighborInfoModule()
 }
 
 /*
-Collect neighbor info from the nodeDB's history, capping at a maximum number of entries and max time
+Collect the best links from the router's link table, capping at a maximum number of entries and max time
 Assumes that the neighborInfo packet has been allocated
+The delivery ratios of those we have enough samples for go in quality
 @returns the number of entries collected
 */
-uint32_t NeighborInfoModule::collectNeighborInfo(meshtastic_NeighborInfo *neighborInfo)
+uint32_t NeighborInfoModule::collectNeighborInfo(meshtastic_NeighborInfo *neighborInfo, meshtastic_LinkQuality *quality)
 {
     NodeNum my_node_id = nodeDB->getNodeNum();
     neighborInfo->node_id = my_node_id;
@@ -65,46 +54,34 @@ uint32_t NeighborInfoModule::collectNeighborInfo(meshtastic_NeighborInfo *neighb
     neighborInfo->node_broadcast_interval_secs =
         Default::getConfiguredOrDefault(moduleConfig.neighbor_info.update_interval, default_telemetry_broadcast_interval_secs);
 
-    cleanUpNeighbors();
-
-    for (auto nbr : neighbors) {
-        if ((neighborInfo->neighbors_count < MAX_NUM_NEIGHBORS) && (nbr.node_id != my_node_id)) {
-            neighborInfo->neighbors[neighborInfo->neighbors_count].node_id = nbr.node_id;
-            neighborInfo->neighbors[neighborInfo->neighbors_count].snr = nbr.snr;
-            // Note: we don't set the last_rx_time and node_broadcast_intervals_secs here, because we don't want to send this over
-            // the mesh
-            neighborInfo->neighbors_count++;
+    // Neighbors that never told us their interval are assumed to share ours
+    const LinkTable::Link *links[MAX_NUM_NEIGHBORS];
+    size_t count = linkTable.collect(links, MAX_NUM_NEIGHBORS, neighborInfo->node_broadcast_interval_secs, millis());
+    LOG_DEBUG("Our link table holds %u neighbors, %u current", (unsigned)linkTable.size(), (unsigned)count);
+    for (size_t i = 0; i < count; i++) {
+        if (links[i]->num == my_node_id)
+            continue;
+        meshtastic_Neighbor &nbr = neighborInfo->neighbors[neighborInfo->neighbors_count++];
+        nbr.node_id = links[i]->num;
+        nbr.snr = links[i]->snr;
+        // A percent that reads 0 would mean unknown
+        if (links[i]->deliveries >= LinkTable::MIN_SAMPLES) {
+            meshtastic_LinkQuality_Link &link = quality->links[quality->links_count++];
+            link.node_id = links[i]->num;
+            link.pdr = max(1, (int)(links[i]->pdr * 100 + 0.5f));
         }
+        // Note: we don't set the last_rx_time and node_broadcast_intervals_secs here, because we don't want to send this over
+        // the mesh
     }
-    printNodeDBNeighbors();
     return neighborInfo->neighbors_count;
 }
 
-/*
-  Remove neighbors from the database that we haven't heard from in a while
-*/
-void NeighborInfoModule::cleanUpNeighbors()
-{
-    uint32_t now = getTime();
-    NodeNum my_node_id = nodeDB->getNodeNum();
-    for (auto it = neighbors.rbegin(); it != neighbors.rend();) {
-        // We will remove a neighbor if we haven't heard from them in twice the broadcast interval
-        // cannot use isWithinTimespanMs() as it->last_rx_time is seconds since 1970
-        if ((now - it->last_rx_time > it->node_broadcast_interval_secs * 2) && (it->node_id != my_node_id)) {
-            LOG_DEBUG("Remove neighbor with node ID 0x%x", it->node_id);
-            it = std::vector<meshtastic_Neighbor>::reverse_iterator(
-                neighbors.erase(std::next(it).base())); // Erase the element and update the iterator
-        } else {
-            ++it;
-        }
-    }
-}
-
 /* Send neighbor info to the mesh */
 void NeighborInfoModule::sendNeighborInfo(NodeNum dest, bool wantReplies)
 {
     meshtastic_NeighborInfo neighborInfo = meshtastic_NeighborInfo_init_zero;
-    collectNeighborInfo(&neighborInfo);
+    meshtastic_LinkQuality quality = meshtastic_LinkQuality_init_zero;
+    collectNeighborInfo(&neighborInfo, &quality);
     // only send neighbours if we have some to send
     if (neighborInfo.neighbors_count > 0) {
         meshtastic_MeshPacket *p = allocDataProtobuf(neighborInfo);
@@ -114,6 +91,17 @@ void NeighborInfoModule::sendNeighborInfo(NodeNum dest, bool wantReplies)
         printNeighborInfo("SENDING", &neighborInfo);
         service->sendToMesh(p, RX_SRC_LOCAL, true);
     }
+    // NeighborInfo has no field for delivery ratios, so they follow on a port of their own
+    if (quality.links_count > 0) {
+        meshtastic_MeshPacket *p = router->allocForSending();
+        p->decoded.portnum = meshtastic_PortNum_LINK_QUALITY_APP;
+        p->decoded.payload.size = pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes),
+                                                     &meshtastic_LinkQuality_msg, &quality);
+        p->to = dest;
+        p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
+        LOG_DEBUG("Sending delivery ratios of %u links", (unsigned)quality.links_count);
+        service->sendToMesh(p, RX_SRC_LOCAL, true);
+    }
 }
 
 /*
@@ -141,14 +129,41 @@ bool NeighborInfoModule::handleReceivedProtobuf(const meshtastic_MeshPacket &mp,
     if (np) {
         printNeighborInfo("RECEIVED", np);
         updateNeighbors(mp, np);
-    } else if (mp.hop_start != 0 && mp.hop_start == mp.hop_limit) {
-        // If the hopLimit is the same as hopStart, then it is a neighbor
-        getOrCreateNeighbor(mp.from, mp.from, 0, mp.rx_snr); // Set the broadcast interval to 0, as we don't know it
+        // However it reached us, what a node hears is part of the map
+        for (pb_size_t i = 0; i < np->neighbors_count; i++) {
+            const meshtastic_Neighbor &neighbor = np->neighbors[i];
+            routeCache.learnEdge(neighbor.node_id, np->node_id, RouteCache::quarterDb(neighbor.snr), 0,
+                                 RouteCache::FROM_NEIGHBORINFO, millis());
+        }
+    } else if (mp.which_payload_variant == meshtastic_MeshPacket_decoded_tag &&
+               mp.decoded.portnum == meshtastic_PortNum_LINK_QUALITY_APP && !isFromUs(&mp)) {
+        handleLinkQuality(mp);
     }
+    // Any other packet heard straight from a neighbor is already in the router's link table
     // Allow others to handle this packet
     return false;
 }
 
+/*
+Collect the delivery ratios that follow a NeighborInfo packet into the route cache
+They add to the edges its neighbors made, or make them if the NeighborInfo was lost
+*/
+void NeighborInfoModule::handleLinkQuality(const meshtastic_MeshPacket &mp)
+{
+    meshtastic_LinkQuality quality = meshtastic_LinkQuality_init_zero;
+    if (!pb_decode_from_bytes(mp.decoded.payload.bytes, mp.decoded.payload.size, &meshtastic_LinkQuality_msg, &quality)) {
+        LOG_ERROR("Error decoding LinkQuality");
+        return;
+    }
+    LOG_DEBUG("Received delivery ratios of %u links from 0x%x", (unsigned)quality.links_count, mp.from);
+    for (pb_size_t i = 0; i < quality.links_count; i++) {
+        const meshtastic_LinkQuality_Link &link = quality.links[i];
+        LOG_DEBUG("Link %u: node_id=0x%x, pdr=%u%%", (unsigned)i, link.node_id, link.pdr);
+        routeCache.learnEdge(link.node_id, mp.from, RouteCache::UNKNOWN_SNR, link.pdr > 100 ? 100 : link.pdr,
+                             RouteCache::FROM_NEIGHBORINFO, millis());
+    }
+}
+
 /*
 Copy the content of a current NeighborInfo packet into a new one and update the last_sent_by_id to our NodeNum
 */
@@ -161,58 +176,15 @@ void NeighborInfoModule::alterReceivedProtobuf(meshtastic_MeshPacket &p, meshtas
         pb_encode_to_bytes(p.decoded.payload.bytes, sizeof(p.decoded.payload.bytes), &meshtastic_NeighborInfo_msg, n);
 }
 
-void NeighborInfoModule::resetNeighbors()
-{
-    neighbors.clear();
-}
-
 void NeighborInfoModule::updateNeighbors(const meshtastic_MeshPacket &mp, const meshtastic_NeighborInfo *np)
 {
     // The last sent ID will be 0 if the packet is from the phone, which we don't count as
-    // an edge. So we assume that if it's zero, then this packet is from our node.
-    if (mp.which_payload_variant == meshtastic_MeshPacket_decoded_tag && mp.from) {
-        getOrCreateNeighbor(mp.from, np->last_sent_by_id, np->node_broadcast_interval_secs, mp.rx_snr);
-    }
-}
-
-meshtastic_Neighbor *NeighborInfoModule::getOrCreateNeighbor(NodeNum originalSender, NodeNum n,
-                                                             uint32_t node_broadcast_interval_secs, float snr)
-{
-    // our node and the phone are the same node (not neighbors)
-    if (n == 0) {
-        n = nodeDB->getNodeNum();
-    }
-    // look for one in the existing list
-    for (size_t i = 0; i < neighbors.size(); i++) {
-        if (neighbors[i].node_id == n) {
-            // if found, update it
-            neighbors[i].snr = snr;
-            neighbors[i].last_rx_time = getTime();
-            // Only if this is the original sender, the broadcast interval corresponds to it
-            if (originalSender == n && node_broadcast_interval_secs != 0)
-                neighbors[i].node_broadcast_interval_secs = node_broadcast_interval_secs;
-            return &neighbors[i];
-        }
-    }
-    // otherwise, allocate one and assign data to it
-
-    meshtastic_Neighbor new_nbr = meshtastic_Neighbor_init_zero;
-    new_nbr.node_id = n;
-    new_nbr.snr = snr;
-    new_nbr.last_rx_time = getTime();
-    // Only if this is the original sender, the broadcast interval corresponds to it
-    if (originalSender == n && node_broadcast_interval_secs != 0)
-        new_nbr.node_broadcast_interval_secs = node_broadcast_interval_secs;
-    else // Assume the same broadcast interval as us for the neighbor if we don't know it
-        new_nbr.node_broadcast_interval_secs = moduleConfig.neighbor_info.update_interval;
-
-    if (neighbors.size() < MAX_NUM_NEIGHBORS) {
-        neighbors.push_back(new_nbr);
-    } else {
-        // If we have too many neighbors, replace the oldest one
-        LOG_WARN("Neighbor DB is full, replace oldest neighbor");
-        neighbors.erase(neighbors.begin());
-        neighbors.push_back(new_nbr);
+    // an edge, and only a packet heard over LoRa says anything about a link
+    if (mp.which_payload_variant == meshtastic_MeshPacket_decoded_tag && mp.from && np->last_sent_by_id &&
+        np->last_sent_by_id != nodeDB->getNodeNum() &&
+        mp.transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA) {
+        // Only if this is the original sender, the broadcast interval corresponds to it
+        uint32_t interval = mp.from == np->last_sent_by_id ? np->node_broadcast_interval_secs : 0;
+        linkTable.noteNeighborInfo(np->last_sent_by_id, interval, mp.rx_snr, mp.rx_rssi, millis());
     }
-    return &neighbors.back();
 }
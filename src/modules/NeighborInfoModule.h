@@ -1,5 +1,6 @@
 #pragma once
 #include "ProtobufModule.h"
+#include "mesh/generated/meshtastic/link_quality.pb.h"
 #define MAX_NUM_NEIGHBORS 10 // also defined in NeighborInfo protobuf options
 
 /*
@@ -10,17 +11,12 @@ class NeighborInfoModule : public ProtobufModule<meshtastic_NeighborInfo>, priva
     CallbackObserver<NeighborInfoModule, const meshtastic::Status *> nodeStatusObserver =
         CallbackObserver<NeighborInfoModule, const meshtastic::Status *>(this, &NeighborInfoModule::handleStatusUpdate);
 
-    std::vector<meshtastic_Neighbor> neighbors;
-
   public:
     /*
      * Expose the constructor
      */
     NeighborInfoModule();
 
-    /* Reset neighbor info after clearing nodeDB*/
-    void resetNeighbors();
-
   protected:
     /*
      * Called to handle a particular incoming message
@@ -29,22 +25,15 @@ class NeighborInfoModule : public ProtobufModule<meshtastic_NeighborInfo>, priva
     virtual bool handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_NeighborInfo *nb) override;
 
     /*
-     * Collect neighbor info from the nodeDB's history, capping at a maximum number of entries and max time
+     * Collect the best links from the router's link table that were heard within twice their broadcast interval, and the
+     * delivery ratios of those that have one
      * @return the number of entries collected
      */
-    uint32_t collectNeighborInfo(meshtastic_NeighborInfo *neighborInfo);
-
-    /*
-      Remove neighbors from the database that we haven't heard from in a while
-    */
-    void cleanUpNeighbors();
+    uint32_t collectNeighborInfo(meshtastic_NeighborInfo *neighborInfo, meshtastic_LinkQuality *quality);
 
     /* Allocate a new NeighborInfo packet */
     meshtastic_NeighborInfo *allocateNeighborInfoPacket();
 
-    // Find a neighbor in our DB, create an empty neighbor if missing
-    meshtastic_Neighbor *getOrCreateNeighbor(NodeNum originalSender, NodeNum n, uint32_t node_broadcast_interval_secs, float snr);
-
     /*
      * Send info on our node's neighbors into the mesh
      */
@@ -53,6 +42,9 @@ class NeighborInfoModule : public ProtobufModule<meshtastic_NeighborInfo>, priva
     /* update neighbors with subpacket sniffed from network */
     void updateNeighbors(const meshtastic_MeshPacket &mp, const meshtastic_NeighborInfo *np);
 
+    /* learn the delivery ratios a node sends after its NeighborInfo */
+    void handleLinkQuality(const meshtastic_MeshPacket &mp);
+
     /* update a NeighborInfo packet with our NodeNum as last_sent_by_id */
     void alterReceivedProtobuf(meshtastic_MeshPacket &p, meshtastic_NeighborInfo *n) override;
 
@@ -63,8 +55,7 @@ class NeighborInfoModule : public ProtobufModule<meshtastic_NeighborInfo>, priva
       Exception is when the packet came via MQTT */
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override { return enabled && !p->via_mqtt; }
 
-    /* These are for debugging only */
+    /* This is for debugging only */
     void printNeighborInfo(const char *header, const meshtastic_NeighborInfo *np);
-    void printNodeDBNeighbors();
 };
 extern NeighborInfoModule *neighborInfoModule;
\ No newline at end of file
@@ -353,6 +353,9 @@ void PositionModule::sendOurPosition(NodeNum dest, bool wantReplies, uint8_t cha
     if (channels.getByIndex(channel).settings.has_module_settings) {
         precision = channels.getByIndex(channel).settings.module_settings.position_precision;
     }
+    // Moving nodes only send the precision their reporting error bound supports
+    if (dest == NODENUM_BROADCAST && config.position.position_broadcast_smart_enabled)
+        precision = reportPolicy.precisionBits(precision, millis());
 
     meshtastic_MeshPacket *p = allocPositionPacket();
     if (p == nullptr) {
@@ -373,6 +376,8 @@ void PositionModule::sendOurPosition(NodeNum dest, bool wantReplies, uint8_t cha
         p->channel = channel;
 
     service->sendToMesh(p, RX_SRC_LOCAL, true);
+    if (dest == NODENUM_BROADCAST)
+        reportPolicy.reported(millis(), precision);
 
     if (IS_ONE_OF(config.device.role, meshtastic_Config_DeviceConfig_Role_TRACKER,
                   meshtastic_Config_DeviceConfig_Role_TAK_TRACKER) &&
@@ -409,6 +414,8 @@ int32_t PositionModule::runOnce()
     uint32_t now = millis();
     uint32_t intervalMs = Default::getConfiguredOrDefaultMsScaled(config.position.position_broadcast_secs,
                                                                   default_broadcast_interval_secs, numOnlineNodes);
+    if (config.position.position_broadcast_smart_enabled)
+        intervalMs = reportPolicy.heartbeatMs(intervalMs, now); // Stationary nodes check in less often
     uint32_t msSinceLastSend = now - lastGpsSend;
     // Only send packets if the channel util. is less than 25% utilized or we're a tracker with less than 40% utilized.
     if (!airTime->isTxAllowedChannelUtil(config.device.role != meshtastic_Config_DeviceConfig_Role_TRACKER &&
@@ -432,25 +439,8 @@ int32_t PositionModule::runOnce()
         const meshtastic_NodeInfoLite *node2 = service->refreshLocalMeshNode(); // should guarantee there is now a position
 
         if (nodeDB->hasValidPosition(node2)) {
-            // The minimum time (in seconds) that would pass before we are able to send a new position packet.
-
-            auto smartPosition = getDistanceTraveledSinceLastSend(node->position);
-            msSinceLastSend = now - lastGpsSend;
-
-            if (smartPosition.hasTraveledOverThreshold &&
-                Throttle::execute(
-                    &lastGpsSend, minimumTimeThreshold, []() { positionModule->sendOurPosition(); },
-                    []() { LOG_DEBUG("Skip send smart broadcast due to time throttling"); })) {
-
-                LOG_DEBUG("Sent smart pos@%x:6 to mesh (distanceTraveled=%fm, minDistanceThreshold=%im, timeElapsed=%ims, "
-                          "minTimeInterval=%ims)",
-                          localPosition.timestamp, smartPosition.distanceTraveled, smartPosition.distanceThreshold,
-                          msSinceLastSend, minimumTimeThreshold);
-
-                // Set the current coords as our last ones, after we've compared distance with current and decided to send
-                lastGpsLatitude = node->position.latitude_i;
-                lastGpsLongitude = node->position.longitude_i;
-            }
+            trackPosition(node2);
+            sendSmartPositionIfDue(node);
         }
     }
 
@@ -472,19 +462,46 @@ void PositionModule::sendLostAndFoundText()
     delete[] message;
 }
 
-struct SmartPosition PositionModule::getDistanceTraveledSinceLastSend(meshtastic_PositionLite currentPosition)
+void PositionModule::trackPosition(const meshtastic_NodeInfoLite *node)
+{
+    // Called every few seconds as well as on GPS updates, only new fixes are news to the filter
+    if (node->position.time == lastTracked.time && node->position.latitude_i == lastTracked.latitude_i &&
+        node->position.longitude_i == lastTracked.longitude_i)
+        return;
+    lastTracked = node->position;
+
+    uint32_t now = millis();
+    updateReportPolicyConfig();
+    reportPolicy.addFix(node->position.latitude_i, node->position.longitude_i, now);
+}
+
+void PositionModule::updateReportPolicyConfig()
 {
-    // The minimum distance to travel before we are able to send a new position packet.
-    const uint32_t distanceTravelThreshold =
-        Default::getConfiguredOrDefault(config.position.broadcast_smart_minimum_distance, 100);
+    PositionReportPolicy::Config policyConfig;
+    policyConfig.errorBoundM = Default::getConfiguredOrDefault(config.position.broadcast_smart_minimum_distance, 100);
+    policyConfig.minIntervalMs = minimumTimeThreshold;
+    // Even when reports carry speed and heading, the apps show the reported position as is
+    policyConfig.deadReckoning = false;
+    reportPolicy.setConfig(policyConfig);
+}
 
-    // Determine the distance in meters between two points on the globe
-    float distanceTraveledSinceLastSend = GeoCoord::latLongToMeter(
-        lastGpsLatitude * 1e-7, lastGpsLongitude * 1e-7, currentPosition.latitude_i * 1e-7, currentPosition.longitude_i * 1e-7);
+void PositionModule::sendSmartPositionIfDue(const meshtastic_NodeInfoLite *node)
+{
+    uint32_t now = millis();
+    if (!reportPolicy.isDue(now))
+        return;
 
-    return SmartPosition{.distanceTraveled = abs(distanceTraveledSinceLastSend),
-                         .distanceThreshold = distanceTravelThreshold,
-                         .hasTraveledOverThreshold = abs(distanceTraveledSinceLastSend) >= distanceTravelThreshold};
+    float error = reportPolicy.getError(now);
+    uint32_t msSinceLastSend = now - lastGpsSend;
+    lastGpsSend = now;
+    sendOurPosition();
+    LOG_DEBUG("Sent smart pos@%x:6 to mesh (error=%fm, errorBound=%fm, speed=%fm/s, timeElapsed=%ims, minTimeInterval=%ims)",
+              localPosition.timestamp, error, reportPolicy.getConfig().errorBoundM, reportPolicy.getSpeed(), msSinceLastSend,
+              minimumTimeThreshold);
+
+    // Set the current coords as our last ones, after we've compared distance with current and decided to send
+    lastGpsLatitude = node->position.latitude_i;
+    lastGpsLongitude = node->position.longitude_i;
 }
 
 void PositionModule::handleNewPosition()
@@ -493,22 +510,9 @@ void PositionModule::handleNewPosition()
     const meshtastic_NodeInfoLite *node2 = service->refreshLocalMeshNode(); // should guarantee there is now a position
     // We limit our GPS broadcasts to a max rate
     if (nodeDB->hasValidPosition(node2)) {
-        auto smartPosition = getDistanceTraveledSinceLastSend(node->position);
-        uint32_t msSinceLastSend = millis() - lastGpsSend;
-        if (smartPosition.hasTraveledOverThreshold &&
-            Throttle::execute(
-                &lastGpsSend, minimumTimeThreshold, []() { positionModule->sendOurPosition(); },
-                []() { LOG_DEBUG("Skip send smart broadcast due to time throttling"); })) {
-            LOG_DEBUG("Sent smart pos@%x:6 to mesh (distanceTraveled=%fm, minDistanceThreshold=%im, timeElapsed=%ims, "
-                      "minTimeInterval=%ims)",
-                      localPosition.timestamp, smartPosition.distanceTraveled, smartPosition.distanceThreshold, msSinceLastSend,
-                      minimumTimeThreshold);
-
-            // Set the current coords as our last ones, after we've compared distance with current and decided to send
-            lastGpsLatitude = node->position.latitude_i;
-            lastGpsLongitude = node->position.longitude_i;
-        }
+        trackPosition(node2);
+        sendSmartPositionIfDue(node);
     }
 }
 
-#endif
\ No newline at end of file
+#endif
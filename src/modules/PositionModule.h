@@ -1,5 +1,6 @@
 #pragma once
 #include "Default.h"
+#include "PositionReportPolicy.h"
 #include "ProtobufModule.h"
 #include "concurrency/OSThread.h"
 
@@ -24,6 +25,10 @@ class PositionModule : public ProtobufModule<meshtastic_Position>, private concu
     /// We force a rebroadcast if the radio settings change
     uint32_t currentGeneration = 0;
 
+    /// Tracks our motion and what the mesh last heard, decides smart broadcasts
+    PositionReportPolicy reportPolicy;
+    meshtastic_PositionLite lastTracked = meshtastic_PositionLite_init_zero; // Last fix given to reportPolicy
+
   public:
     /** Constructor
      * name is for debugging output
@@ -56,7 +61,9 @@ class PositionModule : public ProtobufModule<meshtastic_Position>, private concu
 
   private:
     meshtastic_MeshPacket *allocPositionPacket();
-    struct SmartPosition getDistanceTraveledSinceLastSend(meshtastic_PositionLite currentPosition);
+    void trackPosition(const meshtastic_NodeInfoLite *node);
+    void sendSmartPositionIfDue(const meshtastic_NodeInfoLite *node);
+    void updateReportPolicyConfig();
     meshtastic_MeshPacket *allocAtakPli();
     void trySetRtc(meshtastic_Position p, bool isLocal, bool forceUpdate = false);
     uint32_t precision;
@@ -76,10 +83,4 @@ class PositionModule : public ProtobufModule<meshtastic_Position>, private concu
 #endif
 };
 
-struct SmartPosition {
-    float distanceTraveled;
-    uint32_t distanceThreshold;
-    bool hasTraveledOverThreshold;
-};
-
 extern PositionModule *positionModule;
\ No newline at end of file
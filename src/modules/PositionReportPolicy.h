@@ -0,0 +1,263 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Decides when smart position broadcasts go out, from how wrong the mesh's picture of us has become.
+ *
+ * GPS fixes go through an alpha-beta filter on a local flat-earth grid, giving a smoothed position and a velocity. When we
+ * report, we remember what a receiver now believes: the last fix, which is what the packet carries, moving on from its time
+ * at our velocity for up to errorBoundM if the packet carries speed and heading (deadReckoning), or standing still
+ * otherwise. Capping the extrapolation keeps a stop or a turn, which we only see at the next fix, from putting receivers
+ * further off than ones that don't extrapolate, give or take the bound. The next report is
+ * due once our estimate has drifted more than errorBoundM from that belief, so a tractor at road speed reports every minimum
+ * interval, a pivot creeping along reports every few minutes, and a parked trailer or a headgate only sends heartbeats. The
+ * bound covers the whole error: a moving node that sends coarser lat/lon (precisionBits()) reports that much sooner.
+ *
+ * The phone apps draw the last reported position and don't extrapolate it, so PositionModule always runs with
+ * deadReckoning off. It is kept for receivers that do, and for comparing the two on recorded tracks.
+ *
+ * Nodes whose estimate has stayed within STATIONARY_DRIFT_M of where it settled, and of their last report, for
+ * STATIONARY_HOLD_MS are stationary: once a heartbeat has told receivers where we settled, it is stretched by
+ * STATIONARY_FACTOR. Comparing positions rather than speeds keeps jitter between frequent fixes from looking like motion,
+ * and the last report catches movers too slow to leave the drift radius within the hold, like a pivot.
+ *
+ * Kept free of Arduino and NodeDB calls so it can be replayed against recorded tracks on the host.
+ */
+class PositionReportPolicy
+{
+  public:
+    static constexpr float ALPHA = 0.5f;       // Weight of a new fix against the predicted position
+    static constexpr float BETA = 0.2f;        // Weight of the residual in the velocity update
+    static constexpr float MANEUVER_M = 25.0f; // Residual only real motion explains (GPS jitter is a few metres)
+    static constexpr float STATIONARY_SPEED_MPS = 0.3f; // Slower than this, the speed sent is jitter
+    static constexpr float STATIONARY_DRIFT_M = 15.0f; // Several times the jitter left after the filter
+    static constexpr float GPS_NOISE_M = 5.0f;         // Finer cells than this show nothing real
+    static const uint32_t STATIONARY_HOLD_MS = 5 * 60 * 1000;
+    static const uint32_t STATIONARY_FACTOR = 4;
+    static constexpr float METERS_PER_DEGREE = 111320.0f;
+
+    struct Config {
+        float errorBoundM;      // How far off a receiver may be before we report, from broadcast_smart_minimum_distance
+        uint32_t minIntervalMs; // Never report more often, from broadcast_smart_minimum_interval_secs
+        bool deadReckoning;     // Reports carry speed and heading, receivers can extrapolate
+    };
+
+    void setConfig(const Config &_config) { config = _config; }
+
+    const Config &getConfig() const { return config; }
+
+    /// Fold in a GPS fix taken at now
+    void addFix(int32_t latitude_i, int32_t longitude_i, uint32_t now)
+    {
+        if (!fixes || fabsf((float)latitude_i - refLatitude_i) > MAX_GRID_E7 ||
+            fabsf((float)longitude_i - refLongitude_i) > MAX_GRID_E7) {
+            // First fix, or far enough from the grid origin that the flat-earth approximation starts to hurt
+            float oldX = 0, oldY = 0;
+            if (fixes)
+                toGrid(latitude_i, longitude_i, oldX, oldY);
+            refLatitude_i = latitude_i;
+            refLongitude_i = longitude_i;
+            metersPerE7Lon = METERS_PER_DEGREE * 1e-7f * cosf(latitude_i * 1e-7f * (float)M_PI / 180);
+            if (fixes) {
+                // Move everything we remember into the new grid
+                x -= oldX;
+                y -= oldY;
+                fixX -= oldX;
+                fixY -= oldY;
+                reportedX -= oldX;
+                reportedY -= oldY;
+                restX -= oldX;
+                restY -= oldY;
+            } else {
+                x = y = vx = vy = 0;
+                fixX = fixY = 0;
+                restX = restY = 0;
+                lastFixMs = now;
+                movedMs = now;
+                fixes = 1;
+                return;
+            }
+        }
+
+        float mx, my;
+        toGrid(latitude_i, longitude_i, mx, my);
+        fixX = mx;
+        fixY = my;
+        float dt = (now - lastFixMs) / 1000.0f;
+        lastFixMs = now;
+        fixes++;
+        if (dt <= 0) {
+            x = mx;
+            y = my;
+            return;
+        }
+
+        float px = x + vx * dt, py = y + vy * dt;
+        float rx = mx - px, ry = my - py;
+        if (sqrtf(rx * rx + ry * ry) > MANEUVER_M) {
+            // Started, stopped or turned, or the GPS slept through the move: take the fix and the average velocity since
+            vx = (mx - x) / dt;
+            vy = (my - y) / dt;
+            x = mx;
+            y = my;
+        } else {
+            x = px + ALPHA * rx;
+            y = py + ALPHA * ry;
+            vx += BETA * rx / dt;
+            vy += BETA * ry / dt;
+        }
+        float fromRestX = x - restX, fromRestY = y - restY;
+        bool drifted = sqrtf(fromRestX * fromRestX + fromRestY * fromRestY) > STATIONARY_DRIFT_M;
+        if (drifted || (reports && getError(now) > STATIONARY_DRIFT_M)) {
+            movedMs = now;
+            restX = x;
+            restY = y;
+        }
+    }
+
+    bool hasFix() const { return fixes > 0; }
+
+    /// Estimated ground speed in m/s
+    float getSpeed() const { return sqrtf(vx * vx + vy * vy); }
+
+    /// No motion for STATIONARY_HOLD_MS
+    bool isStationary(uint32_t now) const { return fixes > 1 && now - movedMs >= STATIONARY_HOLD_MS; }
+
+    /// Distance in metres between where we think we are and where a receiver thinks we are
+    float getError(uint32_t now) const { return errorFrom(now, config.deadReckoning); }
+
+    /// A smart broadcast would be worth its airtime now
+    bool isDue(uint32_t now) const
+    {
+        if (!hasFix())
+            return false;
+        if (reports && now - reportedMs < config.minIntervalMs)
+            return false;
+        // A channel that only allows cells wider than the bound leaves receivers that far off however often we report
+        float threshold = config.errorBoundM - reportedCellErrorM;
+        return getError(now) > (threshold > reportedCellErrorM ? threshold : reportedCellErrorM);
+    }
+
+    /// Periodic broadcast interval, stretched while stationary once receivers have a position taken while stationary
+    uint32_t heartbeatMs(uint32_t intervalMs, uint32_t now) const
+    {
+        if (!isStationary(now) || !reportedStationary || intervalMs > UINT32_MAX / STATIONARY_FACTOR)
+            return intervalMs;
+        return intervalMs * STATIONARY_FACTOR;
+    }
+
+    /**
+     * How far a coarser report may put us off, on top of the drift the bound allows.
+     *
+     * A report is already stale by about what we cover in a minimum interval, so that much precision isn't worth showing,
+     * up to a quarter of the bound. Nothing for stationary nodes, for slow ones whose staleness is lost in the GPS noise, or
+     * for fast ones that the minimum interval already holds past the bound, as coarser cells would only add to that.
+     */
+    float cellBudgetM(uint32_t now) const
+    {
+        float stale = getSpeed() * config.minIntervalMs / 1000.0f;
+        float budget = config.errorBoundM / 4;
+        if (isStationary(now) || stale < GPS_NOISE_M || stale > config.errorBoundM - budget)
+            return 0;
+        return stale < budget ? stale : budget;
+    }
+
+    /**
+     * Precision bits for the next report, the coarsest whose cell error fits cellBudgetM(). isDue() takes what that costs
+     * off the bound, so receivers stay within it.
+     *
+     * @param channelPrecision the channel's position_precision, never exceeded
+     */
+    uint8_t precisionBits(uint8_t channelPrecision, uint32_t now) const
+    {
+        if (channelPrecision == 0)
+            return channelPrecision;
+        float budget = cellBudgetM(now);
+        uint8_t bits = 32;
+        while (bits > MIN_PRECISION && cellError(bits - 1) <= budget)
+            bits--;
+        return bits < channelPrecision ? bits : channelPrecision;
+    }
+
+    /**
+     * A position went out, receivers now hold our last fix
+     *
+     * @param precisionSent the precision_bits the packet carried, after the channel's cap
+     */
+    void reported(uint32_t now, uint8_t precisionSent)
+    {
+        reportedX = fixX;
+        reportedY = fixY;
+        reportedFixMs = lastFixMs;
+        // GPS receivers hold speed at zero while parked, jitter is all the filter would have to offer
+        bool moving = getSpeed() >= STATIONARY_SPEED_MPS;
+        reportedVx = moving ? vx : 0;
+        reportedVy = moving ? vy : 0;
+        reportedMs = now;
+        reportedCellErrorM = cellError(precisionSent);
+        reportedStationary = isStationary(now);
+        reports++;
+    }
+
+    uint32_t getReports() const { return reports; }
+
+    /**
+     * How many seconds of travel at the reported velocity a receiver adds to the reported fix: all of them, but never more
+     * than boundM. A stop or a turn we only see at the next fix then can't put it further off than a receiver that doesn't
+     * extrapolate, plus the bound.
+     */
+    static float reckonSeconds(float vx, float vy, float seconds, float boundM)
+    {
+        float speed = sqrtf(vx * vx + vy * vy);
+        return speed * seconds > boundM ? boundM / speed : seconds;
+    }
+
+    /// Worst case distance from a point to the centre of its cell at this precision
+    static float cellError(uint8_t bits)
+    {
+        if (bits >= 32 || bits == 0)
+            return 0;
+        // Latitude cells are the taller side, 0.71 is half the diagonal of a square one
+        return (float)(1UL << (32 - bits)) * 1e-7f * METERS_PER_DEGREE * 0.71f;
+    }
+
+  private:
+    static const uint8_t MIN_PRECISION = 10;   // Matches the coarsest channel precision the apps offer
+    static constexpr float MAX_GRID_E7 = 1e6f; // 0.1 degrees, about 11 km
+
+    Config config = {100, 30000, false};
+    int32_t refLatitude_i = 0, refLongitude_i = 0;
+    float metersPerE7Lon = 0;
+    float x = 0, y = 0, vx = 0, vy = 0; // Metres east/north of the grid origin, and m/s
+    float fixX = 0, fixY = 0;           // The last fix as it came, unfiltered
+    float restX = 0, restY = 0;         // Where we were when we last moved
+    uint32_t lastFixMs = 0, movedMs = 0;
+    uint32_t fixes = 0;
+    float reportedX = 0, reportedY = 0, reportedVx = 0, reportedVy = 0;
+    uint32_t reportedMs = 0, reportedFixMs = 0;
+    float reportedCellErrorM = 0; // What the precision of the last report cost
+    bool reportedStationary = false;
+    uint32_t reports = 0;
+
+    float errorFrom(uint32_t now, bool reckon) const
+    {
+        if (!reports)
+            return INFINITY;
+        float sinceFix = (now - lastFixMs) / 1000.0f, sinceReportedFix = (now - reportedFixMs) / 1000.0f;
+        float dx = x + vx * sinceFix - reportedX, dy = y + vy * sinceFix - reportedY;
+        if (reckon) {
+            float reckonS = reckonSeconds(reportedVx, reportedVy, sinceReportedFix, config.errorBoundM);
+            dx -= reportedVx * reckonS;
+            dy -= reportedVy * reckonS;
+        }
+        return sqrtf(dx * dx + dy * dy);
+    }
+
+    void toGrid(int32_t latitude_i, int32_t longitude_i, float &gx, float &gy) const
+    {
+        gx = (float)((int64_t)longitude_i - refLongitude_i) * metersPerE7Lon;
+        gy = (float)((int64_t)latitude_i - refLatitude_i) * METERS_PER_DEGREE * 1e-7f;
+    }
+};
@@ -154,6 +154,22 @@ meshtastic_Telemetry DeviceTelemetryModule::getLocalStatsTelemetry()
     return telemetry;
 }
 
+meshtastic_TxBudgetStats DeviceTelemetryModule::getTxBudgetStats()
+{
+    meshtastic_TxBudgetStats stats = meshtastic_TxBudgetStats_init_zero;
+    const TxBudget &budget = router->getTxBudget();
+    const TxBudget::Bucket *starved = budget.mostHeld();
+    stats.num_tx_held = budget.totalHeld();
+    stats.num_tx_budget_dropped = budget.totalDropped();
+    stats.tx_starved_port = starved ? starved->port : 0;
+    for (size_t i = 0; i < budget.bucketCount() && budget.isActive(); i++) {
+        const TxBudget::Bucket &b = budget.bucket(i);
+        LOG_INFO("TX budget port %u (%u%%): %.0fms left, sent %u (%u borrowed), held %u, dropped %u", b.port, b.percent,
+                 b.tokensMs, b.sent, b.borrowed, b.held, b.dropped);
+    }
+    return stats;
+}
+
 void DeviceTelemetryModule::sendLocalStatsToPhone()
 {
     meshtastic_MeshPacket *p = allocDataProtobuf(getLocalStatsTelemetry());
@@ -162,6 +178,18 @@ void DeviceTelemetryModule::sendLocalStatsToPhone()
     p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
 
     service->sendToPhone(p);
+
+    // Upstream's LocalStats has no fields for the TX budget, so it follows on a port of its own
+    if (router) {
+        meshtastic_TxBudgetStats stats = getTxBudgetStats();
+        meshtastic_MeshPacket *b = router->allocForSending();
+        b->decoded.portnum = meshtastic_PortNum_TX_BUDGET_APP;
+        b->decoded.payload.size = pb_encode_to_bytes(b->decoded.payload.bytes, sizeof(b->decoded.payload.bytes),
+                                                     &meshtastic_TxBudgetStats_msg, &stats);
+        b->to = NODENUM_BROADCAST;
+        b->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
+        service->sendToPhone(b);
+    }
 }
 
 bool DeviceTelemetryModule::sendTelemetry(NodeNum dest, bool phoneOnly)
@@ -1,5 +1,6 @@
 #pragma once
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "../mesh/generated/meshtastic/tx_budget.pb.h"
 #include "NodeDB.h"
 #include "ProtobufModule.h"
 #include <OLEDDisplay.h>
@@ -43,6 +44,7 @@ class DeviceTelemetryModule : private concurrency::OSThread, public ProtobufModu
   private:
     meshtastic_Telemetry getDeviceTelemetry();
     meshtastic_Telemetry getLocalStatsTelemetry();
+    meshtastic_TxBudgetStats getTxBudgetStats();
 
     void sendLocalStatsToPhone();
     uint32_t sendToPhoneIntervalMs = SECONDS_IN_MINUTE * 1000;           // Send to phone every minute
@@ -189,6 +189,17 @@ NullSensor pct2075Sensor;
 RCWL9620Sensor rcwl9620Sensor;
 CGRadSensSensor cgRadSens;
 
+// Every external sensor, in the order they are initialised. Sensors that were not detected at boot are skipped.
+static TelemetrySensor *const externalSensors[] = {
+    &dfRobotLarkSensor, &dfRobotGravitySensor, &bmp085Sensor,
+#if __has_include(<Adafruit_BME280.h>)
+    &bmp280Sensor,
+#endif
+    &bme280Sensor, &ltr390uvSensor, &bmp3xxSensor, &bme680Sensor, &dps310Sensor, &mcp9808Sensor, &shtc3Sensor, &lps22hbSensor,
+    &sht31Sensor, &sht4xSensor, &ina219Sensor, &ina260Sensor, &ina3221Sensor, &veml7700Sensor, &tsl2591Sensor, &opt3001Sensor,
+    &rcwl9620Sensor, &aht10Sensor, &mlx90632Sensor, &nau7802Sensor, &max17048Sensor, &cgRadSens, &tsl2561Sensor,
+    &pct2075Sensor};
+
 #endif
 #ifdef T1000X_SENSOR_EN
 #include "Sensor/T1000xSensor.h"
@@ -250,66 +261,12 @@ int32_t EnvironmentTelemetryModule::runOnce()
 #ifdef T1000X_SENSOR_EN
             result = t1000xSensor.runOnce();
 #elif !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR_EXTERNAL
-            if (dfRobotLarkSensor.hasSensor())
-                result = dfRobotLarkSensor.runOnce();
-            if (dfRobotGravitySensor.hasSensor())
-                result = dfRobotGravitySensor.runOnce();
-            if (bmp085Sensor.hasSensor())
-                result = bmp085Sensor.runOnce();
-#if __has_include(<Adafruit_BME280.h>)
-            if (bmp280Sensor.hasSensor())
-                result = bmp280Sensor.runOnce();
-#endif
-            if (bme280Sensor.hasSensor())
-                result = bme280Sensor.runOnce();
-            if (ltr390uvSensor.hasSensor())
-                result = ltr390uvSensor.runOnce();
-            if (bmp3xxSensor.hasSensor())
-                result = bmp3xxSensor.runOnce();
-            if (bme680Sensor.hasSensor())
-                result = bme680Sensor.runOnce();
-            if (dps310Sensor.hasSensor())
-                result = dps310Sensor.runOnce();
-            if (mcp9808Sensor.hasSensor())
-                result = mcp9808Sensor.runOnce();
-            if (shtc3Sensor.hasSensor())
-                result = shtc3Sensor.runOnce();
-            if (lps22hbSensor.hasSensor())
-                result = lps22hbSensor.runOnce();
-            if (sht31Sensor.hasSensor())
-                result = sht31Sensor.runOnce();
-            if (sht4xSensor.hasSensor())
-                result = sht4xSensor.runOnce();
-            if (ina219Sensor.hasSensor())
-                result = ina219Sensor.runOnce();
-            if (ina260Sensor.hasSensor())
-                result = ina260Sensor.runOnce();
-            if (ina3221Sensor.hasSensor())
-                result = ina3221Sensor.runOnce();
-            if (veml7700Sensor.hasSensor())
-                result = veml7700Sensor.runOnce();
-            if (tsl2591Sensor.hasSensor())
-                result = tsl2591Sensor.runOnce();
-            if (opt3001Sensor.hasSensor())
-                result = opt3001Sensor.runOnce();
-            if (rcwl9620Sensor.hasSensor())
-                result = rcwl9620Sensor.runOnce();
-            if (aht10Sensor.hasSensor())
-                result = aht10Sensor.runOnce();
-            if (mlx90632Sensor.hasSensor())
-                result = mlx90632Sensor.runOnce();
-            if (nau7802Sensor.hasSensor())
-                result = nau7802Sensor.runOnce();
-            if (max17048Sensor.hasSensor())
-                result = max17048Sensor.runOnce();
-            if (cgRadSens.hasSensor())
-                result = cgRadSens.runOnce();
-            if (tsl2561Sensor.hasSensor())
-                result = tsl2561Sensor.runOnce();
-            if (pct2075Sensor.hasSensor())
-                result = pct2075Sensor.runOnce();
-                // this only works on the wismesh hub with the solar option. This is not an I2C sensor, so we don't need the
-                // sensormap here.
+            for (TelemetrySensor *sensor : externalSensors) {
+                if (sensor->hasSensor())
+                    result = sensor->runOnce();
+            }
+            // this only works on the wismesh hub with the solar option. This is not an I2C sensor, so we don't need the
+            // sensormap here.
 #ifdef HAS_RAKPROT
 
             result = rak9154Sensor.runOnce();
@@ -335,25 +292,65 @@ int32_t EnvironmentTelemetryModule::runOnce()
 #endif
         }
 
-        if (((lastSentToMesh == 0) ||
-             !Throttle::isWithinTimespanMs(lastSentToMesh, Default::getConfiguredOrDefaultMsScaled(
-                                                               moduleConfig.telemetry.environment_update_interval,
-                                                               default_telemetry_broadcast_interval_secs, numOnlineNodes))) &&
-            airTime->isTxAllowedChannelUtil(config.device.role != meshtastic_Config_DeviceConfig_Role_SENSOR) &&
-            airTime->isTxAllowedAirUtil()) {
+        bool toMesh = ((lastSentToMesh == 0) ||
+                       !Throttle::isWithinTimespanMs(lastSentToMesh, Default::getConfiguredOrDefaultMsScaled(
+                                                                         moduleConfig.telemetry.environment_update_interval,
+                                                                         default_telemetry_broadcast_interval_secs,
+                                                                         numOnlineNodes))) &&
+                      airTime->isTxAllowedChannelUtil(config.device.role != meshtastic_Config_DeviceConfig_Role_SENSOR) &&
+                      airTime->isTxAllowedAirUtil();
+        // Just send to phone when it's not our time to send to mesh yet
+        // Only send while queue is empty (phone assumed connected)
+        bool toPhone = !toMesh &&
+                       ((lastSentToPhone == 0) || !Throttle::isWithinTimespanMs(lastSentToPhone, sendToPhoneIntervalMs)) &&
+                       (service->isToPhoneQueueEmpty());
+
+        if ((toMesh || toPhone) && !Throttle::isWithinTimespanMs(conversionsStartedMs, CONVERSION_VALID_MS)) {
+            // Start every sensor that can measure in the background at once and come back when the slowest is done,
+            // instead of each one blocking for its own conversion in turn while we read them
+            uint32_t wait = startConversions();
+            if (wait) {
+                conversionsStartedMs = millis();
+                return wait;
+            }
+        }
+        if (toMesh) {
             sendTelemetry();
             lastSentToMesh = millis();
-        } else if (((lastSentToPhone == 0) || !Throttle::isWithinTimespanMs(lastSentToPhone, sendToPhoneIntervalMs)) &&
-                   (service->isToPhoneQueueEmpty())) {
-            // Just send to phone when it's not our time to send to mesh yet
-            // Only send while queue is empty (phone assumed connected)
+            conversionsStartedMs = 0;
+            logSensorStats();
+        } else if (toPhone) {
             sendTelemetry(NODENUM_BROADCAST, true);
             lastSentToPhone = millis();
+            conversionsStartedMs = 0;
         }
     }
     return min(sendToPhoneIntervalMs, result);
 }
 
+uint32_t EnvironmentTelemetryModule::startConversions()
+{
+    uint32_t wait = 0;
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR_EXTERNAL
+    for (TelemetrySensor *sensor : externalSensors) {
+        if (sensor->hasSensor())
+            wait = max(wait, sensor->startMeasurement());
+    }
+#endif
+    return wait;
+}
+
+void EnvironmentTelemetryModule::logSensorStats()
+{
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR_EXTERNAL
+    for (TelemetrySensor *sensor : externalSensors) {
+        if (sensor->hasSensor() && sensor->getReadCount())
+            LOG_DEBUG("Sensor %s: read in %uus (max %uus), %u of %u reads failed", sensor->getSensorName(),
+                      sensor->getLastReadUs(), sensor->getMaxReadUs(), sensor->getErrorCount(), sensor->getReadCount());
+    }
+#endif
+}
+
 bool EnvironmentTelemetryModule::wantUIFrame()
 {
     return moduleConfig.telemetry.environment_screen_enabled;
@@ -559,133 +556,133 @@ bool EnvironmentTelemetryModule::getEnvironmentTelemetry(meshtastic_Telemetry *m
     hasSensor = true;
 #else
     if (dfRobotLarkSensor.hasSensor()) {
-        valid = valid && dfRobotLarkSensor.getMetrics(m);
+        valid = valid && dfRobotLarkSensor.readMetrics(m);
         hasSensor = true;
     }
     if (dfRobotGravitySensor.hasSensor()) {
-        valid = valid && dfRobotGravitySensor.getMetrics(m);
+        valid = valid && dfRobotGravitySensor.readMetrics(m);
         hasSensor = true;
     }
     if (sht31Sensor.hasSensor()) {
-        valid = valid && sht31Sensor.getMetrics(m);
+        valid = valid && sht31Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (sht4xSensor.hasSensor()) {
-        valid = valid && sht4xSensor.getMetrics(m);
+        valid = valid && sht4xSensor.readMetrics(m);
         hasSensor = true;
     }
     if (lps22hbSensor.hasSensor()) {
-        valid = valid && lps22hbSensor.getMetrics(m);
+        valid = valid && lps22hbSensor.readMetrics(m);
         hasSensor = true;
     }
     if (shtc3Sensor.hasSensor()) {
-        valid = valid && shtc3Sensor.getMetrics(m);
+        valid = valid && shtc3Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (bmp085Sensor.hasSensor()) {
-        valid = valid && bmp085Sensor.getMetrics(m);
+        valid = valid && bmp085Sensor.readMetrics(m);
         hasSensor = true;
     }
 #if __has_include(<Adafruit_BME280.h>)
     if (bmp280Sensor.hasSensor()) {
-        valid = valid && bmp280Sensor.getMetrics(m);
+        valid = valid && bmp280Sensor.readMetrics(m);
         hasSensor = true;
     }
 #endif
     if (bme280Sensor.hasSensor()) {
-        valid = valid && bme280Sensor.getMetrics(m);
+        valid = valid && bme280Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (ltr390uvSensor.hasSensor()) {
-        valid = valid && ltr390uvSensor.getMetrics(m);
+        valid = valid && ltr390uvSensor.readMetrics(m);
         hasSensor = true;
     }
     if (bmp3xxSensor.hasSensor()) {
-        valid = valid && bmp3xxSensor.getMetrics(m);
+        valid = valid && bmp3xxSensor.readMetrics(m);
         hasSensor = true;
     }
     if (bme680Sensor.hasSensor()) {
-        valid = valid && bme680Sensor.getMetrics(m);
+        valid = valid && bme680Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (dps310Sensor.hasSensor()) {
-        valid = valid && dps310Sensor.getMetrics(m);
+        valid = valid && dps310Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (mcp9808Sensor.hasSensor()) {
-        valid = valid && mcp9808Sensor.getMetrics(m);
+        valid = valid && mcp9808Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (ina219Sensor.hasSensor()) {
-        valid = valid && ina219Sensor.getMetrics(m);
+        valid = valid && ina219Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (ina260Sensor.hasSensor()) {
-        valid = valid && ina260Sensor.getMetrics(m);
+        valid = valid && ina260Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (ina3221Sensor.hasSensor()) {
-        valid = valid && ina3221Sensor.getMetrics(m);
+        valid = valid && ina3221Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (veml7700Sensor.hasSensor()) {
-        valid = valid && veml7700Sensor.getMetrics(m);
+        valid = valid && veml7700Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (tsl2591Sensor.hasSensor()) {
-        valid = valid && tsl2591Sensor.getMetrics(m);
+        valid = valid && tsl2591Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (opt3001Sensor.hasSensor()) {
-        valid = valid && opt3001Sensor.getMetrics(m);
+        valid = valid && opt3001Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (mlx90632Sensor.hasSensor()) {
-        valid = valid && mlx90632Sensor.getMetrics(m);
+        valid = valid && mlx90632Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (rcwl9620Sensor.hasSensor()) {
-        valid = valid && rcwl9620Sensor.getMetrics(m);
+        valid = valid && rcwl9620Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (nau7802Sensor.hasSensor()) {
-        valid = valid && nau7802Sensor.getMetrics(m);
+        valid = valid && nau7802Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (tsl2561Sensor.hasSensor()) {
-        valid = valid && tsl2561Sensor.getMetrics(m);
+        valid = valid && tsl2561Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (aht10Sensor.hasSensor()) {
         if (!bmp280Sensor.hasSensor() && !bmp3xxSensor.hasSensor()) {
-            valid = valid && aht10Sensor.getMetrics(m);
+            valid = valid && aht10Sensor.readMetrics(m);
             hasSensor = true;
         } else if (bmp280Sensor.hasSensor()) {
             // prefer bmp280 temp if both sensors are present, fetch only humidity
             meshtastic_Telemetry m_ahtx = meshtastic_Telemetry_init_zero;
             LOG_INFO("AHTX0+BMP280 module detected: using temp from BMP280 and humy from AHTX0");
-            aht10Sensor.getMetrics(&m_ahtx);
+            aht10Sensor.readMetrics(&m_ahtx);
             m->variant.environment_metrics.relative_humidity = m_ahtx.variant.environment_metrics.relative_humidity;
             m->variant.environment_metrics.has_relative_humidity = m_ahtx.variant.environment_metrics.has_relative_humidity;
         } else {
             // prefer bmp3xx temp if both sensors are present, fetch only humidity
             meshtastic_Telemetry m_ahtx = meshtastic_Telemetry_init_zero;
             LOG_INFO("AHTX0+BMP3XX module detected: using temp from BMP3XX and humy from AHTX0");
-            aht10Sensor.getMetrics(&m_ahtx);
+            aht10Sensor.readMetrics(&m_ahtx);
             m->variant.environment_metrics.relative_humidity = m_ahtx.variant.environment_metrics.relative_humidity;
             m->variant.environment_metrics.has_relative_humidity = m_ahtx.variant.environment_metrics.has_relative_humidity;
         }
     }
     if (max17048Sensor.hasSensor()) {
-        valid = valid && max17048Sensor.getMetrics(m);
+        valid = valid && max17048Sensor.readMetrics(m);
         hasSensor = true;
     }
     if (cgRadSens.hasSensor()) {
-        valid = valid && cgRadSens.getMetrics(m);
+        valid = valid && cgRadSens.readMetrics(m);
         hasSensor = true;
     }
     if (pct2075Sensor.hasSensor()) {
-        valid = valid && pct2075Sensor.getMetrics(m);
+        valid = valid && pct2075Sensor.readMetrics(m);
         hasSensor = true;
     }
 #ifdef HAS_RAKPROT
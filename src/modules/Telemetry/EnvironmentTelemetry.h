@@ -52,6 +52,15 @@ class EnvironmentTelemetryModule : private concurrency::OSThread, public Protobu
      */
     bool sendTelemetry(NodeNum dest = NODENUM_BROADCAST, bool wantReplies = false);
 
+    /**
+     * Start background conversions on the sensors that support it
+     * @return ms until the slowest of them can be read, 0 if none started
+     */
+    uint32_t startConversions();
+
+    /// Per-sensor read latency and error counts, logged after each mesh report
+    void logSensorStats();
+
     virtual AdminMessageHandleResult handleAdminMessageForModule(const meshtastic_MeshPacket &mp,
                                                                  meshtastic_AdminMessage *request,
                                                                  meshtastic_AdminMessage *response) override;
@@ -63,6 +72,8 @@ class EnvironmentTelemetryModule : private concurrency::OSThread, public Protobu
     uint32_t lastSentToMesh = 0;
     uint32_t lastSentToPhone = 0;
     uint32_t sensor_read_error_count = 0;
+    uint32_t conversionsStartedMs = 0; // Results of startConversions() are only used while this is recent
+    static const uint32_t CONVERSION_VALID_MS = 1000;
 };
 
 #endif
\ No newline at end of file
@@ -11,8 +11,15 @@
 #include "TelemetrySensor.h"
 
 #include <Adafruit_AHTX0.h>
+#include <Wire.h>
 #include <typeinfo>
 
+// Trigger measurement command and how long the datasheet gives it to finish. getEvent() sends the same command and then
+// busy waits, which is most of the time environment telemetry used to block for.
+static const uint8_t AHTX0_CMD_TRIGGER[] = {0xAC, 0x33, 0x00};
+static const uint32_t AHTX0_CONVERSION_MS = 80;
+static const uint32_t AHTX0_RESULT_STALE_MS = 2000;
+
 AHT10Sensor::AHT10Sensor() : TelemetrySensor(meshtastic_TelemetrySensorType_AHT10, "AHT10") {}
 
 int32_t AHT10Sensor::runOnce()
@@ -29,10 +36,58 @@ int32_t AHT10Sensor::runOnce()
 
 void AHT10Sensor::setup() {}
 
+uint32_t AHT10Sensor::startConversion()
+{
+    TwoWire *bus = nodeTelemetrySensorsMap[sensorType].second;
+    bus->beginTransmission(nodeTelemetrySensorsMap[sensorType].first);
+    bus->write(AHTX0_CMD_TRIGGER, sizeof(AHTX0_CMD_TRIGGER));
+    if (bus->endTransmission() != 0) {
+        conversionStartMs = 0;
+        return 0;
+    }
+    conversionStartMs = millis();
+    if (conversionStartMs == 0)
+        conversionStartMs = 1;
+    return AHTX0_CONVERSION_MS;
+}
+
+/**
+ * Collect the measurement started by startConversion(), false if there is none or it is not ready
+ */
+bool AHT10Sensor::readConversion(meshtastic_Telemetry *measurement)
+{
+    uint32_t age = millis() - conversionStartMs;
+    if (!conversionStartMs || age < AHTX0_CONVERSION_MS || age > AHTX0_RESULT_STALE_MS)
+        return false;
+    conversionStartMs = 0;
+
+    TwoWire *bus = nodeTelemetrySensorsMap[sensorType].second;
+    uint8_t data[6];
+    if (bus->requestFrom(nodeTelemetrySensorsMap[sensorType].first, (uint8_t)sizeof(data)) != sizeof(data))
+        return false;
+    for (uint8_t i = 0; i < sizeof(data); i++)
+        data[i] = bus->read();
+    if (data[0] & 0x80) // Still busy
+        return false;
+
+    // Same conversion as Adafruit_AHTX0::getEvent()
+    uint32_t rawHumidity = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
+    uint32_t rawTemp = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
+
+    measurement->variant.environment_metrics.has_temperature = true;
+    measurement->variant.environment_metrics.has_relative_humidity = true;
+    measurement->variant.environment_metrics.temperature = ((float)rawTemp * 200 / 0x100000) - 50;
+    measurement->variant.environment_metrics.relative_humidity = ((float)rawHumidity * 100) / 0x100000;
+    return true;
+}
+
 bool AHT10Sensor::getMetrics(meshtastic_Telemetry *measurement)
 {
     LOG_DEBUG("AHT10 getMetrics");
 
+    if (readConversion(measurement))
+        return true;
+
     sensors_event_t humidity, temp;
     aht10.getEvent(&humidity, &temp);
 
@@ -14,9 +14,13 @@ class AHT10Sensor : public TelemetrySensor
 {
   private:
     Adafruit_AHTX0 aht10;
+    uint32_t conversionStartMs = 0; // 0 if no measurement was started by startConversion()
+
+    bool readConversion(meshtastic_Telemetry *measurement);
 
   protected:
     virtual void setup() override;
+    virtual uint32_t startConversion() override;
 
   public:
     AHT10Sensor();
@@ -3,11 +3,13 @@
 #if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR && defined(T1000X_SENSOR_EN)
 
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "AnalogSampler.h"
 #include "T1000xSensor.h"
 #include "TelemetrySensor.h"
 #include <Adafruit_Sensor.h>
 
 #define T1000X_SENSE_SAMPLES 15
+#define T1000X_SENSE_INTERVAL_MS 30000 // Light and heater temperature are sampled in the background, read at telemetry time
 #define T1000X_LIGHT_REF_VCC 2400
 
 #define HEATER_NTC_BX 4250   // thermistor coefficient B
@@ -44,12 +46,36 @@ int32_t T1000xSensor::runOnce()
     if (!hasSensor()) {
         return DEFAULT_SENSOR_MINIMUM_WAIT_TIME_BETWEEN_READS;
     }
+    setup();
     return DEFAULT_SENSOR_MINIMUM_WAIT_TIME_BETWEEN_READS;
 }
 
+static int32_t readPin(void *pin)
+{
+    return analogRead((uint32_t)(uintptr_t)pin);
+}
+
+static int8_t addPinChannel(const char *name, uint32_t pin)
+{
+    AnalogChannel::Config channel = {};
+    channel.name = name;
+    channel.intervalMs = T1000X_SENSE_INTERVAL_MS;
+    channel.oversample = T1000X_SENSE_SAMPLES;
+    channel.medianWindow = 3;
+    channel.emaAlpha = 0.5;
+    channel.read = readPin;
+    channel.ctx = (void *)(uintptr_t)pin;
+    return analogSampler->addChannel(channel);
+}
+
 void T1000xSensor::setup()
 {
-    // Set up oversampling and filter initialization
+    // Oversampling and filtering happen on the sampler thread
+    if (luxChannel >= 0)
+        return;
+    luxChannel = addPinChannel("t1000x lux", T1000X_LUX_PIN);
+    vccChannel = addPinChannel("t1000x vcc", T1000X_VCC_PIN);
+    ntcChannel = addPinChannel("t1000x ntc", T1000X_NTC_PIN);
 }
 
 float T1000xSensor::getLux()
@@ -57,10 +83,7 @@ float T1000xSensor::getLux()
     uint32_t lux_vot = 0;
     float lux_level = 0;
 
-    for (uint32_t i = 0; i < T1000X_SENSE_SAMPLES; i++) {
-        lux_vot += analogRead(T1000X_LUX_PIN);
-    }
-    lux_vot = lux_vot / T1000X_SENSE_SAMPLES;
+    lux_vot = analogSampler->read(luxChannel);
     lux_vot = ((1000 * AREF_VOLTAGE) / pow(2, BATTERY_SENSE_RESOLUTION_BITS)) * lux_vot;
 
     if (lux_vot <= 80)
@@ -81,16 +104,10 @@ float T1000xSensor::getTemp()
     float Vout = 0, Rt = 0, temp = 0;
     float Temp = 0;
 
-    for (uint32_t i = 0; i < T1000X_SENSE_SAMPLES; i++) {
-        vcc_vot += analogRead(T1000X_VCC_PIN);
-    }
-    vcc_vot = vcc_vot / T1000X_SENSE_SAMPLES;
+    vcc_vot = analogSampler->read(vccChannel);
     vcc_vot = 2 * ((1000 * AREF_VOLTAGE) / pow(2, BATTERY_SENSE_RESOLUTION_BITS)) * vcc_vot;
 
-    for (uint32_t i = 0; i < T1000X_SENSE_SAMPLES; i++) {
-        ntc_vot += analogRead(T1000X_NTC_PIN);
-    }
-    ntc_vot = ntc_vot / T1000X_SENSE_SAMPLES;
+    ntc_vot = analogSampler->read(ntcChannel);
     ntc_vot = ((1000 * AREF_VOLTAGE) / pow(2, BATTERY_SENSE_RESOLUTION_BITS)) * ntc_vot;
 
     Vout = ntc_vot;
@@ -108,6 +125,7 @@ float T1000xSensor::getTemp()
 
 bool T1000xSensor::getMetrics(meshtastic_Telemetry *measurement)
 {
+    setup();
     measurement->variant.environment_metrics.has_temperature = true;
     measurement->variant.environment_metrics.has_lux = true;
 
@@ -10,6 +10,11 @@ class T1000xSensor : public TelemetrySensor
   protected:
     virtual void setup() override;
 
+    // analogSampler channels, registered by setup()
+    int8_t luxChannel = -1;
+    int8_t vccChannel = -1;
+    int8_t ntcChannel = -1;
+
   public:
     T1000xSensor();
     virtual int32_t runOnce() override;
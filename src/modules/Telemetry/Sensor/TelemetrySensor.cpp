@@ -3,8 +3,34 @@
 #if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
 
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "I2CLock.h"
 #include "NodeDB.h"
 #include "TelemetrySensor.h"
 #include "main.h"
 
+uint32_t TelemetrySensor::startMeasurement()
+{
+    concurrency::LockGuard guard(i2cLock(nodeTelemetrySensorsMap[sensorType].second));
+    return startConversion();
+}
+
+bool TelemetrySensor::readMetrics(meshtastic_Telemetry *measurement)
+{
+    bool ok;
+    uint32_t start = micros();
+    {
+        concurrency::LockGuard guard(i2cLock(nodeTelemetrySensorsMap[sensorType].second));
+        ok = getMetrics(measurement);
+    }
+    lastReadUs = micros() - start;
+    if (lastReadUs > maxReadUs)
+        maxReadUs = lastReadUs;
+    readCount++;
+    if (!ok) {
+        errorCount++;
+        LOG_WARN("%s read failed (%u of %u)", sensorName, errorCount, readCount);
+    }
+    return ok;
+}
+
 #endif
\ No newline at end of file
@@ -44,6 +44,14 @@ class TelemetrySensor
     }
     virtual void setup() = 0;
 
+    /**
+     * Start a measurement and return without waiting for it, for sensors that would otherwise spend their conversion time
+     * blocking inside getMetrics().
+     *
+     * @return ms until getMetrics() can read the result, 0 if getMetrics() does the whole job itself
+     */
+    virtual uint32_t startConversion() { return 0; }
+
   public:
     virtual AdminMessageHandleResult handleAdminMessage(const meshtastic_MeshPacket &mp, meshtastic_AdminMessage *request,
                                                         meshtastic_AdminMessage *response)
@@ -58,6 +66,24 @@ class TelemetrySensor
     virtual bool isRunning() { return status > 0; }
 
     virtual bool getMetrics(meshtastic_Telemetry *measurement) = 0;
+
+    /// startConversion() with the sensor's bus held
+    uint32_t startMeasurement();
+
+    /// getMetrics() with the sensor's bus held, timed and counted in the read statistics below
+    bool readMetrics(meshtastic_Telemetry *measurement);
+
+    const char *getSensorName() const { return sensorName; }
+    uint32_t getReadCount() const { return readCount; }
+    uint32_t getErrorCount() const { return errorCount; }
+    uint32_t getLastReadUs() const { return lastReadUs; }
+    uint32_t getMaxReadUs() const { return maxReadUs; }
+
+  private:
+    uint32_t readCount = 0;
+    uint32_t errorCount = 0; // getMetrics() returned false
+    uint32_t lastReadUs = 0;
+    uint32_t maxReadUs = 0;
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "TraceRouteModule.h"
 #include "MeshService.h"
+#include "RTC.h"
+#include "airtime.h"
 #include "graphics/Screen.h"
 #include "graphics/ScreenFonts.h"
 #include "graphics/SharedUIDisplay.h"
@@ -35,6 +37,8 @@ void TraceRouteModule::alterReceivedProtobuf(meshtastic_MeshPacket &p, meshtasti
     p.decoded.payload.size =
         pb_encode_to_bytes(p.decoded.payload.bytes, sizeof(p.decoded.payload.bytes), &meshtastic_RouteDiscovery_msg, r);
 
+    learnRoute(p, r);
+
     if (tracingNode != 0) {
         // check isResponseFromTarget
         bool isResponseFromTarget = (incoming.request_id != 0 && p.from == tracingNode);
@@ -153,6 +157,48 @@ void TraceRouteModule::alterReceivedProtobuf(meshtastic_MeshPacket &p, meshtasti
     }
 }
 
+void TraceRouteModule::learnRoute(const meshtastic_MeshPacket &p, const meshtastic_RouteDiscovery *r)
+{
+    // The request went from its sender through route[] and, once it got there, to its destination. A response carries that
+    // with it, and adds its own way back from the destination through route_back[].
+    bool isResponse = p.decoded.request_id != 0;
+    NodeNum requester = isResponse ? p.to : p.from;
+    NodeNum target = isResponse ? p.from : p.to;
+
+    RouteCache::Path towards = {};
+    towards.nodes[towards.count++] = requester;
+    for (pb_size_t i = 0; i < r->route_count && towards.count < RouteCache::MAX_PATH - 1; i++)
+        towards.nodes[towards.count++] = r->route[i];
+    if (r->snr_towards_count > r->route_count)
+        towards.nodes[towards.count++] = target;
+    for (uint8_t i = 0; i + 1 < towards.count; i++)
+        towards.snr[i] = i < r->snr_towards_count ? r->snr_towards[i] : RouteCache::UNKNOWN_SNR;
+
+    RouteCache::Path back = {};
+    if (isResponse) {
+        back.nodes[back.count++] = target;
+        for (pb_size_t i = 0; i < r->route_back_count && back.count < RouteCache::MAX_PATH - 1; i++)
+            back.nodes[back.count++] = r->route_back[i];
+        if (r->snr_back_count > r->route_back_count)
+            back.nodes[back.count++] = requester;
+        for (uint8_t i = 0; i + 1 < back.count; i++)
+            back.snr[i] = i < r->snr_back_count ? r->snr_back[i] : RouteCache::UNKNOWN_SNR;
+    }
+
+    if (!isResponse || !isToUs(&p)) {
+        routeCache.learnPath(towards, millis());
+        routeCache.learnPath(back, millis());
+        return;
+    }
+    routeCache.learnRoute(towards, back, millis());
+    for (InFlight &trace : inFlight) {
+        if (trace.dest && trace.id == p.decoded.request_id) {
+            LOG_INFO("Queued traceroute to 0x%08x answered after %u ms", trace.dest, millis() - trace.sentMs);
+            trace.dest = 0;
+        }
+    }
+}
+
 void TraceRouteModule::processUpgradedPacket(const meshtastic_MeshPacket &mp)
 {
     if (mp.which_payload_variant != meshtastic_MeshPacket_decoded_tag || mp.decoded.portnum != meshtastic_PortNum_TRACEROUTE_APP)
@@ -281,7 +327,7 @@ void TraceRouteModule::printRoute(meshtastic_RouteDiscovery *r, uint32_t origin,
         }
         route += vformat("0x%x", dest);
     }
-    LOG_INFO(route.c_str());
+    LOG_INFO("%s", route.c_str());
 #endif
 }
 
@@ -557,6 +603,137 @@ void TraceRouteModule::launch(NodeNum node)
     }
 }
 
+PacketId TraceRouteModule::sendRequest(NodeNum node)
+{
+    if (!service)
+        return 0;
+    meshtastic_MeshPacket *p = router->allocForSending();
+    if (!p)
+        return 0;
+    meshtastic_RouteDiscovery req = meshtastic_RouteDiscovery_init_zero;
+    p->to = node;
+    p->decoded.portnum = meshtastic_PortNum_TRACEROUTE_APP;
+    p->decoded.want_response = true;
+    p->decoded.payload.size =
+        pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes), &meshtastic_RouteDiscovery_msg, &req);
+    PacketId id = p->id;
+    service->sendToMesh(p, RX_SRC_USER);
+    return id;
+}
+
+bool TraceRouteModule::queueTraceRoute(NodeNum dest)
+{
+    if (dest == nodeDB->getNodeNum() || !routeCache.request(dest))
+        return false;
+#ifndef ARCH_PORTDUINO
+    // Elsewhere the web server runs on the main loop too. On native its threads leave this thread alone, runQueue() polls.
+    setIntervalFromNow(0);
+#endif
+    return true;
+}
+
+bool TraceRouteModule::lookupRoute(NodeNum dest, RouteCache::Route &out)
+{
+    return routeCache.lookup(nodeDB->getNodeNum(), dest, millis(), out);
+}
+
+void TraceRouteModule::learnNextHops(uint32_t now)
+{
+    // NextHopRouter knows the last byte of the next hop towards a node and, from the last packet it sent, how many hops
+    // away it is, but nothing of the hops in between
+    RouteCache::NextHop hops[RouteCache::MAX_NEXT_HOPS];
+    size_t count = 0;
+    for (size_t i = 0; i < nodeDB->getNumMeshNodes() && count < RouteCache::MAX_NEXT_HOPS; i++) {
+        const meshtastic_NodeInfoLite *node = nodeDB->getMeshNodeByIndex(i);
+        if (!node->next_hop || !node->has_hops_away)
+            continue;
+        const LinkTable::Link *link = linkTable.findByRelay(node->next_hop);
+        if (!link)
+            continue;
+        RouteCache::NextHop &hop = hops[count++];
+        hop.dest = node->num;
+        hop.via = link->num;
+        hop.heardMs = link->lastHeardMs;
+        hop.hopsAway = node->hops_away;
+    }
+    routeCache.learnNextHops(hops, count);
+}
+
+bool TraceRouteModule::answerFromCache(const meshtastic_MeshPacket &p)
+{
+    NodeNum self = nodeDB->getNodeNum();
+    if (p.which_payload_variant != meshtastic_MeshPacket_decoded_tag || p.decoded.portnum != meshtastic_PortNum_TRACEROUTE_APP ||
+        !p.decoded.want_response || isBroadcast(p.to) || p.to == self)
+        return false;
+    meshtastic_RouteDiscovery request = meshtastic_RouteDiscovery_init_zero;
+    if (!pb_decode_from_bytes(p.decoded.payload.bytes, p.decoded.payload.size, &meshtastic_RouteDiscovery_msg, &request) ||
+        request.route_count || request.route_back_count)
+        return false;
+
+    // Asking again for the node just answered from memory means the phone wants it traced live
+    uint32_t now = millis();
+    if (p.to == answeredDest && now - answeredMs < RETRACE_MS) {
+        answeredDest = 0;
+        return false;
+    }
+
+    // Only a route that was traced, both ways, stands in for a trace. One pieced together is for the web API.
+    RouteCache::Route route;
+    if (!routeCache.lookup(self, p.to, now, route) || route.sources != RouteCache::FROM_TRACEROUTE || route.back.count < 2)
+        return false;
+
+    // The response as it reached us when it was traced
+    meshtastic_RouteDiscovery answer = meshtastic_RouteDiscovery_init_zero;
+    for (uint8_t i = 1; i + 1 < route.towards.count && answer.route_count < ROUTE_SIZE; i++)
+        answer.route[answer.route_count++] = route.towards.nodes[i];
+    for (uint8_t i = 0; i + 1 < route.towards.count && answer.snr_towards_count < ROUTE_SIZE; i++)
+        answer.snr_towards[answer.snr_towards_count++] = route.towards.snr[i];
+    for (uint8_t i = 1; i + 1 < route.back.count && answer.route_back_count < ROUTE_SIZE; i++)
+        answer.route_back[answer.route_back_count++] = route.back.nodes[i];
+    for (uint8_t i = 0; i + 1 < route.back.count && answer.snr_back_count < ROUTE_SIZE; i++)
+        answer.snr_back[answer.snr_back_count++] = route.back.snr[i];
+
+    meshtastic_MeshPacket *reply = packetPool.allocZeroed();
+    if (!reply)
+        return false;
+    uint32_t ageSecs = (now - route.learnedMs) / 1000;
+    reply->from = p.to;
+    reply->to = self;
+    reply->id = generatePacketId();
+    reply->channel = p.channel;
+    reply->transport_mechanism = meshtastic_MeshPacket_TransportMechanism_TRANSPORT_INTERNAL;
+    uint32_t rxTime = getValidTime(RTCQualityFromNet);
+    reply->rx_time = rxTime > ageSecs ? rxTime - ageSecs : 0; // When the real answer came
+    reply->which_payload_variant = meshtastic_MeshPacket_decoded_tag;
+    reply->decoded.portnum = meshtastic_PortNum_TRACEROUTE_APP;
+    reply->decoded.request_id = p.id;
+    // From p.to so the apps draw the route to it, but marked as ours, not the node's
+    reply->decoded.has_bitfield = true;
+    reply->decoded.bitfield = BITFIELD_FROM_CACHE_MASK;
+    reply->decoded.payload.size = pb_encode_to_bytes(reply->decoded.payload.bytes, sizeof(reply->decoded.payload.bytes),
+                                                     &meshtastic_RouteDiscovery_msg, &answer);
+    LOG_INFO("Traceroute to 0x%08x answered from the route traced %us ago", p.to, ageSecs);
+    service->sendToPhone(reply);
+    answeredDest = p.to;
+    answeredMs = now;
+
+    // The answer reads as the one the node gave back then, so say where it came from
+    meshtastic_ClientNotification *cn = clientNotificationPool.allocZeroed();
+    cn->has_reply_id = true;
+    cn->reply_id = p.id;
+    cn->level = meshtastic_LogRecord_Level_INFO;
+    cn->time = getValidTime(RTCQualityFromNet);
+    snprintf(cn->message, sizeof(cn->message),
+             "Traceroute answered from the route traced %us ago, send again within %us to trace live", (unsigned)ageSecs,
+             (unsigned)(RETRACE_MS / 1000));
+    service->sendClientNotification(cn);
+
+    // Still good for now, but due for another look
+    if (now - route.learnedMs > RouteCache::ROUTE_MAX_AGE_MS / 2)
+        queueTraceRoute(p.to);
+    return true;
+}
+
 void TraceRouteModule::handleTraceRouteResult(const String &result)
 {
     resultText = result;
@@ -700,7 +877,60 @@ void TraceRouteModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiState *state
 int32_t TraceRouteModule::runOnce()
 {
     unsigned long now = millis();
+    int32_t display = runDisplay(now);
+    int32_t queue = runQueue(now);
+    return queue < display ? queue : display;
+}
 
+int32_t TraceRouteModule::runQueue(unsigned long now)
+{
+    if (!linksLearnedMs || now - linksLearnedMs >= LINKS_REFRESH_MS) {
+        routeCache.learnLinks(linkTable, nodeDB->getNodeNum(), now);
+        learnNextHops(now);
+        linksLearnedMs = now ? now : 1;
+    }
+
+    uint8_t busy = 0;
+    for (InFlight &trace : inFlight) {
+        if (trace.dest && now - trace.sentMs > ANSWER_TIMEOUT_MS) {
+            LOG_INFO("Queued traceroute to 0x%08x got no answer", trace.dest);
+            trace.dest = 0;
+        }
+        busy += trace.dest != 0;
+    }
+    size_t queued = routeCache.queued();
+    if (!queued)
+        return busy ? 1000 : IDLE_POLL_MS;
+    if (busy == MAX_IN_FLIGHT || (int32_t)(nextQueuedSendMs - now) > 0)
+        return 1000;
+    // Politely, leaving the channel to everyone else first
+    if (airTime && (!airTime->isTxAllowedChannelUtil(true) || !airTime->isTxAllowedAirUtil()))
+        return SPACING_MS;
+
+    NodeNum dest;
+    if (!routeCache.takeRequest(dest))
+        return 1000;
+    PacketId id = sendRequest(dest);
+    if (id) {
+        for (InFlight &trace : inFlight) {
+            if (!trace.dest) {
+                trace.dest = dest;
+                trace.id = id;
+                trace.sentMs = now;
+                break;
+            }
+        }
+        LOG_INFO("Sent queued traceroute to 0x%08x, %u more queued", dest, queued - 1);
+    } else {
+        LOG_WARN("Could not send queued traceroute to 0x%08x", dest);
+    }
+    float utilization = airTime ? airTime->channelUtilizationPercent() : 0;
+    nextQueuedSendMs = now + SPACING_MS + (uint32_t)(utilization * SPACING_PER_UTIL_PERCENT_MS);
+    return 1000;
+}
+
+int32_t TraceRouteModule::runDisplay(unsigned long now)
+{
     if (runState == TRACEROUTE_STATE_IDLE) {
         return INT32_MAX;
     }
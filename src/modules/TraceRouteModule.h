@@ -4,6 +4,7 @@
 #include "graphics/Screen.h"
 #include "graphics/SharedUIDisplay.h"
 #include "input/InputBroker.h"
+#include "mesh/RouteCache.h"
 #if HAS_SCREEN
 #include "OLEDDisplayUi.h"
 #endif
@@ -37,6 +38,50 @@ class TraceRouteModule : public ProtobufModule<meshtastic_RouteDiscovery>,
 
     void processUpgradedPacket(const meshtastic_MeshPacket &mp);
 
+    /// Queue a trace to dest, sent once the channel allows. @return false if it already is queued or the queue is full
+    bool queueTraceRoute(NodeNum dest);
+
+    /**
+     * A route to dest without going on air: traced lately, pieced together from what routeCache knows of the mesh, or at
+     * least the next hop NodeDB has for it. Safe from the web server's threads, as it only reads routeCache, which the main
+     * loop keeps the next hops in.
+     */
+    bool lookupRoute(NodeNum dest, RouteCache::Route &out);
+
+    /**
+     * GET /api/v1/traceroute: for each of nodes (see RouteCache::parseNodes()) the route lookupRoute() has, and a trace queued
+     * if it was not traced lately, or whatever it had with refresh. {"routes": [RouteCache::writeRoute()...], "queued": [ids
+     * queued by this call], "pending": traces waiting in all}
+     */
+    template <typename Output> void writeLookups(JSONWriter<Output> &json, const char *nodes, bool refresh)
+    {
+        uint32_t now = millis();
+        NodeNum dests[RouteCache::MAX_QUEUED];
+        bool queued[RouteCache::MAX_QUEUED];
+        size_t count = RouteCache::parseNodes(nodes, dests, RouteCache::MAX_QUEUED);
+        json.beginObject().key("routes").beginArray();
+        for (size_t i = 0; i < count; i++) {
+            RouteCache::Route route;
+            bool found = lookupRoute(dests[i], route);
+            if (found)
+                RouteCache::writeRoute(json, route, now);
+            queued[i] = (refresh || !found || route.sources != RouteCache::FROM_TRACEROUTE) && queueTraceRoute(dests[i]);
+        }
+        json.endArray().key("queued").beginArray();
+        for (size_t i = 0; i < count; i++) {
+            if (queued[i])
+                RouteCache::writeNode(json, dests[i]);
+        }
+        json.endArray().key("pending").value((long)routeCache.queued()).endObject();
+    }
+
+    /**
+     * Answer a traceroute the phone sends from routeCache if it was traced lately, and tell the phone so with a
+     * ClientNotification. The same request again within RETRACE_MS goes on air. Only with USERPREFS_TRACEROUTE_FROM_CACHE.
+     * @return true if it was answered, and the caller owes the phone what sending it would have given it
+     */
+    bool answerFromCache(const meshtastic_MeshPacket &p);
+
   protected:
     bool handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_RouteDiscovery *r) override;
 
@@ -60,6 +105,44 @@ class TraceRouteModule : public ProtobufModule<meshtastic_RouteDiscovery>,
        Set dest to the ID of its destination, or NODENUM_BROADCAST if it has not yet arrived there. */
     void printRoute(meshtastic_RouteDiscovery *r, uint32_t origin, uint32_t dest, bool isTowardsDestination);
 
+    /// Add the hops a RouteDiscovery passing us has seen to routeCache, and the whole route if it answers our own trace
+    void learnRoute(const meshtastic_MeshPacket &p, const meshtastic_RouteDiscovery *r);
+
+    /// Copy the next hops NodeDB and linkTable have into routeCache, for lookupRoute() to fall back on
+    void learnNextHops(uint32_t now);
+
+    /// Send a RouteDiscovery request to node without touching the screen. @return its packet id, 0 if it could not be sent
+    PacketId sendRequest(NodeNum node);
+
+    // The screen's single trace, and the queued ones, @return ms until each wants to run again
+    int32_t runDisplay(unsigned long now);
+    int32_t runQueue(unsigned long now);
+
+    // Queued traces are sent a few at a time, each next one once the channel is quiet enough and SPACING_MS has passed,
+    // more as the channel gets busier
+    static const uint8_t MAX_IN_FLIGHT = 3;
+    static const uint32_t SPACING_MS = 5000;
+    static const uint32_t SPACING_PER_UTIL_PERCENT_MS = 1000;
+    static const uint32_t ANSWER_TIMEOUT_MS = 60 * 1000;
+    static const uint32_t RETRACE_MS = 2 * 60 * 1000;   // Longer than PhoneAPI's 30 s between traceroutes
+    static const uint32_t LINKS_REFRESH_MS = 60 * 1000; // How often routeCache learns our own links and next hops
+#ifdef ARCH_PORTDUINO
+    static const uint32_t IDLE_POLL_MS = 1000; // The web server's threads can't wake us, so look for what they queued
+#else
+    static const uint32_t IDLE_POLL_MS = LINKS_REFRESH_MS;
+#endif
+
+    struct InFlight {
+        NodeNum dest; // 0 if free
+        PacketId id;
+        uint32_t sentMs;
+    };
+    InFlight inFlight[MAX_IN_FLIGHT] = {};
+    uint32_t nextQueuedSendMs = 0;
+    uint32_t linksLearnedMs = 0;
+    NodeNum answeredDest = 0; // Last answered from routeCache
+    uint32_t answeredMs = 0;
+
     TraceRouteRunState runState = TRACEROUTE_STATE_IDLE;
     unsigned long lastTraceRouteTime = 0;
     unsigned long resultShowTime = 0;
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <string>
@@ -9,6 +11,7 @@ class FieldHierarchy {
 public:
     struct Field;
     struct Zone;
+    struct Infrastructure;
     struct Farm {
         std::string id;
         std::string name;
@@ -25,6 +28,7 @@ public:
         std::string crop_type;
         std::vector<Zone*> zones;
         Farm* parent_farm;
+        uint32_t controller_node = 0; // Section controller with authority over every zone in the field
         float getTotalWaterUsed() const { return 0; }
         float getAverageMoisture() const { return 0; }
         bool needsIrrigation() const { return false; }
@@ -35,6 +39,7 @@ public:
         float acres;
         uint8_t priority;
         Field* parent_field;
+        uint32_t controller_node = 0; // Node allowed to command this zone's actuators
         std::vector<void*> valves; // Placeholder
         std::vector<void*> sensors; // Placeholder
         // Schedule schedule; // Placeholder
@@ -63,6 +68,33 @@ public:
     void addField(Field* field) { fields_by_id[field->id] = field; farm.fields.push_back(field); }
     void addZone(const std::string& field_id, Zone* zone) { zones_by_id[zone->id] = zone; fields_by_id[field_id]->zones.push_back(zone); }
     void assignNodeToZone(uint32_t node_id, const std::string& zone_id) { node_to_zone[node_id] = zone_id; }
+    void addInfrastructure(Infrastructure* infra) { farm.infrastructure.push_back(infra); }
+    void clear() {
+        farm.fields.clear();
+        farm.infrastructure.clear();
+        fields_by_id.clear();
+        zones_by_id.clear();
+        node_to_zone.clear();
+    }
+
+    // May `source` command the actuators on `target`? Headgate infrastructure nodes have
+    // farm-wide authority, otherwise the source must control the target's zone or its field.
+    bool hasAuthority(uint32_t source, uint32_t target) const {
+        if (source == 0) return false;
+        for (const Infrastructure* infra : farm.infrastructure) {
+            if (infra->type == Infrastructure::HEADGATE &&
+                std::find(infra->node_ids.begin(), infra->node_ids.end(), source) != infra->node_ids.end()) {
+                return true;
+            }
+        }
+        auto nodeIt = node_to_zone.find(target);
+        if (nodeIt == node_to_zone.end()) return false;
+        auto zoneIt = zones_by_id.find(nodeIt->second);
+        if (zoneIt == zones_by_id.end() || !zoneIt->second) return false;
+        const Zone* zone = zoneIt->second;
+        if (zone->controller_node == source) return true;
+        return zone->parent_field && zone->parent_field->controller_node == source;
+    }
 };
 
 } // namespace GateMesh
@@ -0,0 +1,232 @@
+#include "FragmentModule.h"
+#include "MeshService.h"
+#include "RadioLibInterface.h"
+#include "Router.h"
+#include "airtime.h"
+#include "main.h"
+#include <Arduino.h>
+
+FragmentModule *fragmentModule;
+
+static_assert(Fragment::PAYLOAD_BYTES == meshtastic_Constants_DATA_PAYLOAD_LEN, "Fragment sizes assume a full packet");
+
+FragmentModule::FragmentModule()
+    : SinglePortModule("Fragment", meshtastic_PortNum_FRAGMENT_APP), concurrency::OSThread("Fragment") {
+    // A random start keeps a rebooted sender from reusing ids a receiver still remembers
+    nextId = random(1, 0x10000);
+    setIntervalFromNow(IDLE_INTERVAL_MS);
+}
+
+uint16_t FragmentModule::send(NodeNum dest, uint16_t port, const uint8_t *bytes, size_t length, uint8_t channel) {
+    if (isBroadcast(dest) || dest == nodeDB->getNodeNum()) {
+        LOG_WARN("Fragment: only single node destinations are supported");
+        return 0;
+    }
+    if (length > Fragment::MAX_MESSAGE) {
+        LOG_WARN("Fragment: %u bytes is over the %u byte limit", (unsigned)length, (unsigned)Fragment::MAX_MESSAGE);
+        return 0;
+    }
+
+    Outgoing *o = nullptr;
+    for (auto &slot : outgoing) {
+        if (!slot.active) {
+            o = &slot;
+            break;
+        }
+    }
+    if (!o) {
+        LOG_WARN("Fragment: already sending %d messages", OUTGOING_SLOTS);
+        return 0;
+    }
+    o->bytes = (uint8_t *)malloc(length ? length : 1);
+    if (!o->bytes) {
+        LOG_ERROR("Fragment: no memory for %u bytes", (unsigned)length);
+        return 0;
+    }
+    memcpy(o->bytes, bytes, length);
+
+    uint16_t id = nextId++;
+    if (!nextId) nextId = 1;
+    o->active = true;
+    o->dest = dest;
+    o->port = port;
+    o->channel = channel;
+    o->length = length;
+    // A SACK comes back in about the air time of a fragment and of the SACK
+    o->sender.start(id, length, airtimeMs(Fragment::PAYLOAD_BYTES) + airtimeMs(Fragment::SACK_BYTES));
+    LOG_INFO("Fragment: message %u to 0x%x, %u bytes in %d fragment(s)", id, dest, (unsigned)length,
+             o->sender.getCount());
+
+    setIntervalFromNow(0);
+    return id;
+}
+
+uint32_t FragmentModule::airtimeMs(size_t payloadLength) const {
+    if (!RadioLibInterface::instance) return DEFAULT_AIRTIME_MS * payloadLength / Fragment::PAYLOAD_BYTES;
+    return RadioLibInterface::instance->getPacketTime(payloadLength + MESHTASTIC_HEADER_LENGTH);
+}
+
+// Time between fragments: a packet's air time for our own, plus room for the rest of the mesh that
+// grows as the channel fills
+uint32_t FragmentModule::paceMs() const {
+    float util = airTime ? airTime->channelUtilizationPercent() : 0;
+    return airtimeMs(Fragment::PAYLOAD_BYTES) * (2 + util / 5);
+}
+
+bool FragmentModule::queueHasRoom() const {
+    if (!router) return false;
+    meshtastic_QueueStatus status = router->getQueueStatus();
+    // Leave half the queue to everyone else
+    return status.free * 2 >= status.maxlen;
+}
+
+int32_t FragmentModule::runOnce() {
+    uint32_t now = millis();
+    reassembler.expire(now);
+
+    bool busy = false;
+    for (auto &o : outgoing) busy |= o.active;
+    if (!busy) return IDLE_INTERVAL_MS;
+
+    uint32_t pace = paceMs(), since = now - lastSentMs;
+    if (since < pace) return pace - since;
+    if (airTime && airTime->channelUtilizationPercent() >= POLITE_CHANNEL_UTIL_PERCENT) return BUSY_RETRY_MS;
+    if (!queueHasRoom()) return BUSY_RETRY_MS;
+
+    return sendNextFragment(now);
+}
+
+// Round robin over the messages being sent, one fragment per call
+int32_t FragmentModule::sendNextFragment(uint32_t now) {
+    uint32_t sleepMs = IDLE_INTERVAL_MS;
+    for (uint8_t n = 0; n < OUTGOING_SLOTS; n++) {
+        Outgoing &o = outgoing[(nextOutgoing + n) % OUTGOING_SLOTS];
+        if (!o.active) continue;
+
+        uint8_t index;
+        bool wantSack;
+        switch (o.sender.next(now, index, wantSack)) {
+            case Fragment::Sender::DONE:
+                finish(o, true);
+                continue;
+            case Fragment::Sender::FAILED:
+                finish(o, false);
+                continue;
+            case Fragment::Sender::WAIT: {
+                uint32_t left = o.sender.waitLeftMs(now);
+                if (left < sleepMs) sleepMs = left;
+                continue;
+            }
+            case Fragment::Sender::SEND:
+                break;
+        }
+
+        Fragment::Header h = {};
+        h.wantSack = wantSack;
+        h.id = o.sender.getId();
+        h.index = index;
+        h.count = o.sender.getCount();
+        h.port = o.port;
+        size_t offset = (size_t)index * Fragment::FRAGMENT_BYTES;
+        size_t bytes = o.length - offset < Fragment::FRAGMENT_BYTES ? o.length - offset : Fragment::FRAGMENT_BYTES;
+
+        meshtastic_MeshPacket *p = allocDataPacket();
+        p->decoded.payload.size = Fragment::writeData(p->decoded.payload.bytes, h, o.bytes + offset, bytes);
+        p->to = o.dest;
+        p->channel = o.channel;
+        // Our own SACKs stand in for the router's per-packet acks and retransmissions
+        p->want_ack = false;
+        p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
+        service->sendToMesh(p);
+
+        o.sender.sent(index, wantSack, now);
+        lastSentMs = now;
+        nextOutgoing = (&o - outgoing + 1) % OUTGOING_SLOTS;
+        return paceMs();
+    }
+    return sleepMs;
+}
+
+FragmentModule::Outgoing *FragmentModule::findOutgoing(NodeNum dest, uint16_t id) {
+    for (auto &o : outgoing) {
+        if (o.active && o.dest == dest && o.sender.getId() == id) return &o;
+    }
+    return nullptr;
+}
+
+void FragmentModule::finish(Outgoing &o, bool delivered) {
+    Fragment::Outcome outcome = {o.dest, o.port, o.sender.getId(), delivered};
+    if (delivered) {
+        LOG_INFO("Fragment: message %u delivered to 0x%x", outcome.id, outcome.to);
+    } else {
+        LOG_WARN("Fragment: message %u to 0x%x failed", outcome.id, outcome.to);
+    }
+    free(o.bytes);
+    o.bytes = nullptr;
+    o.active = false;
+    finished.notifyObservers(&outcome);
+}
+
+void FragmentModule::sendControl(NodeNum dest, uint8_t channel, const uint8_t *bytes, size_t length) {
+    meshtastic_MeshPacket *p = allocDataPacket();
+    memcpy(p->decoded.payload.bytes, bytes, length);
+    p->decoded.payload.size = length;
+    p->to = dest;
+    p->channel = channel;
+    p->want_ack = false;
+    p->priority = meshtastic_MeshPacket_Priority_RESPONSE;
+    service->sendToMesh(p);
+}
+
+ProcessMessage FragmentModule::handleReceived(const meshtastic_MeshPacket &mp) {
+    if (isFromUs(&mp)) return ProcessMessage::CONTINUE;
+
+    const auto &payload = mp.decoded.payload;
+    Fragment::Header h;
+    if (!Fragment::parse(payload.bytes, payload.size, h)) {
+        LOG_WARN("Fragment: malformed packet from 0x%x", mp.from);
+        return ProcessMessage::STOP;
+    }
+    uint32_t now = millis();
+    uint8_t reply[Fragment::SACK_BYTES];
+
+    switch (h.type) {
+        case Fragment::DATA: {
+            if (isBroadcast(mp.to)) return ProcessMessage::STOP;
+            Fragment::Reassembler::Slot *slot;
+            auto result = reassembler.onData(mp.from, h, payload.bytes + Fragment::DATA_HEADER,
+                                             payload.size - Fragment::DATA_HEADER, now, slot);
+            if (result == Fragment::Reassembler::REFUSED) {
+                LOG_WARN("Fragment: no room for message %u from 0x%x", h.id, mp.from);
+                sendControl(mp.from, mp.channel, reply, Fragment::writeRefuse(reply, h.id));
+                break;
+            }
+            // A finished message always answers, so a sender whose SACK was lost hears it from its probe
+            if (h.wantSack || result != Fragment::Reassembler::STORED) {
+                sendControl(mp.from, mp.channel, reply, Fragment::writeSack(reply, h.id, h.count, slot->received));
+            }
+            if (result == Fragment::Reassembler::COMPLETE) {
+                LOG_INFO("Fragment: message %u from 0x%x complete, %u bytes for port %u", h.id, mp.from,
+                         (unsigned)slot->length, slot->port);
+                Fragment::Message message = {mp.from, slot->port, mp.channel, slot->buffer, slot->length};
+                received.notifyObservers(&message);
+                reassembler.finish(*slot);
+            }
+            break;
+        }
+        case Fragment::SACK: {
+            Outgoing *o = findOutgoing(mp.from, h.id);
+            if (o && h.count == o->sender.getCount()) {
+                o->sender.onSack(h.received, now);
+                setIntervalFromNow(0);
+            }
+            break;
+        }
+        case Fragment::REFUSE: {
+            Outgoing *o = findOutgoing(mp.from, h.id);
+            if (o) finish(*o, false);
+            break;
+        }
+    }
+    return ProcessMessage::STOP;
+}
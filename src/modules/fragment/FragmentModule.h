@@ -0,0 +1,81 @@
+#pragma once
+
+#include "FragmentTransfer.h"
+#include "Observer.h"
+#include "SinglePortModule.h"
+#include "concurrency/OSThread.h"
+
+namespace Fragment {
+
+// A whole message, as handed to observers of FragmentModule::received. The bytes are only valid
+// during the notification.
+struct Message {
+    NodeNum from;
+    uint16_t port;
+    uint8_t channel;
+    const uint8_t *bytes;
+    size_t length;
+};
+
+// How a send() ended, for observers of FragmentModule::finished
+struct Outcome {
+    NodeNum to;
+    uint16_t port;
+    uint16_t id;
+    bool delivered;
+};
+
+} // namespace Fragment
+
+// Carries payloads larger than one packet (farm configs, schedules, audit dumps) to a single node:
+// split into fragments on FRAGMENT_APP, sent a window at a time and paced by channel utilization,
+// with only the fragments a SACK shows missing sent again. The receiver reassembles them and hands
+// the whole message to whichever module observes `received` for that port.
+class FragmentModule : public SinglePortModule, private concurrency::OSThread {
+public:
+    FragmentModule();
+
+    // Queue up to Fragment::MAX_MESSAGE bytes (copied) for dest, delivered there as one message
+    // on port. Returns the message id to match against `finished`, 0 if it can't be queued.
+    uint16_t send(NodeNum dest, uint16_t port, const uint8_t *bytes, size_t length, uint8_t channel = 0);
+
+    Observable<const Fragment::Message *> received;
+    Observable<const Fragment::Outcome *> finished;
+
+protected:
+    ProcessMessage handleReceived(const meshtastic_MeshPacket &mp) override;
+    int32_t runOnce() override;
+
+private:
+    struct Outgoing {
+        bool active;
+        NodeNum dest;
+        uint16_t port;
+        uint8_t channel;
+        uint8_t *bytes;
+        size_t length;
+        Fragment::Sender sender;
+    };
+
+    static constexpr uint8_t OUTGOING_SLOTS = 2;
+    static constexpr uint32_t IDLE_INTERVAL_MS = 60 * 1000;
+    static constexpr uint32_t BUSY_RETRY_MS = 5000;
+    static constexpr uint32_t DEFAULT_AIRTIME_MS = 1500; // A full packet at LongFast, when there's no LoRa radio
+    static constexpr float POLITE_CHANNEL_UTIL_PERCENT = 25;
+
+    Outgoing outgoing[OUTGOING_SLOTS] = {};
+    uint8_t nextOutgoing = 0;
+    uint16_t nextId;
+    uint32_t lastSentMs = 0;
+    Fragment::Reassembler reassembler;
+
+    int32_t sendNextFragment(uint32_t now);
+    uint32_t airtimeMs(size_t payloadLength) const;
+    uint32_t paceMs() const;
+    bool queueHasRoom() const;
+    Outgoing *findOutgoing(NodeNum dest, uint16_t id);
+    void finish(Outgoing &o, bool delivered);
+    void sendControl(NodeNum dest, uint8_t channel, const uint8_t *bytes, size_t length);
+};
+
+extern FragmentModule *fragmentModule;
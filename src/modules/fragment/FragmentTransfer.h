@@ -0,0 +1,326 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace Fragment {
+
+// Wire format on FRAGMENT_APP, little endian:
+//   DATA    [DATA | WANT_SACK?][message id:2][index][count][port:2][up to FRAGMENT_BYTES]
+//   SACK    [SACK][message id:2][count][received bitmap:8]
+//   REFUSE  [REFUSE][message id:2]   the receiver will not take this message
+// A message is identified by its sender and id. Every fragment but the last carries exactly
+// FRAGMENT_BYTES, so the receiver can place any fragment as soon as it arrives.
+static constexpr uint8_t DATA = 1, SACK = 2, REFUSE = 3, WANT_SACK = 0x80;
+static constexpr size_t PAYLOAD_BYTES = 233; // meshtastic_Constants_DATA_PAYLOAD_LEN
+static constexpr size_t DATA_HEADER = 7, SACK_BYTES = 12, REFUSE_BYTES = 3;
+static constexpr size_t FRAGMENT_BYTES = PAYLOAD_BYTES - DATA_HEADER;
+static constexpr uint8_t MAX_FRAGMENTS = 64; // One bit each in a SACK
+static constexpr size_t MAX_MESSAGE = MAX_FRAGMENTS * FRAGMENT_BYTES;
+
+struct Header {
+    uint8_t type;
+    bool wantSack;
+    uint16_t id;
+    uint8_t index;
+    uint8_t count;
+    uint16_t port;
+    uint64_t received; // SACK only
+};
+
+inline uint64_t allFragments(uint8_t count) {
+    return count >= 64 ? ~0ull : (1ull << count) - 1;
+}
+
+inline uint8_t fragmentCount(size_t length) {
+    return length ? (length + FRAGMENT_BYTES - 1) / FRAGMENT_BYTES : 1;
+}
+
+inline size_t writeData(uint8_t *out, const Header &h, const uint8_t *bytes, size_t length) {
+    out[0] = DATA | (h.wantSack ? WANT_SACK : 0);
+    out[1] = h.id;
+    out[2] = h.id >> 8;
+    out[3] = h.index;
+    out[4] = h.count;
+    out[5] = h.port;
+    out[6] = h.port >> 8;
+    memcpy(out + DATA_HEADER, bytes, length);
+    return DATA_HEADER + length;
+}
+
+inline size_t writeSack(uint8_t *out, uint16_t id, uint8_t count, uint64_t received) {
+    out[0] = SACK;
+    out[1] = id;
+    out[2] = id >> 8;
+    out[3] = count;
+    for (int i = 0; i < 8; i++) out[4 + i] = received >> (8 * i);
+    return SACK_BYTES;
+}
+
+inline size_t writeRefuse(uint8_t *out, uint16_t id) {
+    out[0] = REFUSE;
+    out[1] = id;
+    out[2] = id >> 8;
+    return REFUSE_BYTES;
+}
+
+// @return false if this is not a well formed fragment packet. For DATA, the fragment's bytes
+// start at DATA_HEADER.
+inline bool parse(const uint8_t *in, size_t length, Header &h) {
+    if (length < REFUSE_BYTES) return false;
+    h = Header();
+    h.type = in[0] & ~WANT_SACK;
+    h.wantSack = in[0] & WANT_SACK;
+    h.id = in[1] | in[2] << 8;
+    switch (h.type) {
+        case DATA: {
+            if (length <= DATA_HEADER) return false;
+            h.index = in[3];
+            h.count = in[4];
+            h.port = in[5] | in[6] << 8;
+            size_t bytes = length - DATA_HEADER;
+            bool last = h.index == h.count - 1;
+            return h.count && h.count <= MAX_FRAGMENTS && h.index < h.count &&
+                   (last ? bytes <= FRAGMENT_BYTES : bytes == FRAGMENT_BYTES);
+        }
+        case SACK:
+            if (length != SACK_BYTES) return false;
+            h.count = in[3];
+            for (int i = 0; i < 8; i++) h.received |= (uint64_t)in[4 + i] << (8 * i);
+            return h.count && h.count <= MAX_FRAGMENTS;
+        case REFUSE:
+            return length == REFUSE_BYTES;
+        default:
+            return false;
+    }
+}
+
+// Sending side of one message: selective repeat. Every `window` fragments one asks for a SACK,
+// but sending goes on without waiting for it; since the receiver's SACK lists everything it has,
+// a lost one costs nothing once a later one arrives. Fragments a SACK shows missing go out again.
+// Only when everything missing is already in flight does the sender wait, and if the SACK never
+// comes it probes with the first missing fragment, on a timeout from the measured round trip.
+// The window grows with each SACK and halves on each timeout, trading SACK airtime against how
+// soon losses are found.
+class Sender {
+public:
+    enum Step { SEND, WAIT, DONE, FAILED };
+
+    static constexpr uint8_t MAX_WINDOW = 8;
+    static constexpr uint8_t MAX_PROBES = 8;
+    static constexpr uint32_t INITIAL_RTT_MS = 10000, MIN_TIMEOUT_MS = 4000, MAX_TIMEOUT_MS = 30000;
+
+    // rttMs is a first guess at the time from a fragment going out to its SACK arriving, the air
+    // time of both when the caller knows the radio settings
+    void start(uint16_t messageId, size_t messageLength, uint32_t initialRttMs = INITIAL_RTT_MS) {
+        id = messageId;
+        count = fragmentCount(messageLength);
+        acked = inFlight = covered = 0;
+        window = 2;
+        sinceSack = 0;
+        waiting = false;
+        probes = 0;
+        rttMs = initialRttMs;
+    }
+
+    uint16_t getId() const { return id; }
+    uint8_t getCount() const { return count; }
+    uint64_t getAcked() const { return acked; }
+    uint8_t getWindow() const { return window; }
+    bool isDone() const { return acked == allFragments(count); }
+
+    // What to do at now: on SEND, index is the fragment to send and wantSack whether it asks for a SACK
+    Step next(uint32_t now, uint8_t &index, bool &wantSack) {
+        if (isDone()) return DONE;
+        int candidate = firstMissing(inFlight);
+        if (candidate >= 0) {
+            index = candidate;
+            uint64_t left = allFragments(count) & ~acked & ~inFlight & ~(1ull << index);
+            wantSack = sinceSack + 1 >= window || !left;
+            return SEND;
+        }
+        if (waiting && now - sackRequestedAt < timeoutMs()) return WAIT;
+        if (++probes > MAX_PROBES) return FAILED;
+        // The SACK, or the fragment asking for it, was lost
+        window = window > 2 ? window / 2 : 1;
+        index = firstMissing(0);
+        wantSack = true;
+        return SEND;
+    }
+
+    // The fragment from next() went out at now
+    void sent(uint8_t index, bool wantSack, uint32_t now) {
+        inFlight |= 1ull << index;
+        sinceSack++;
+        if (wantSack) {
+            waiting = true;
+            sackRequestedAt = now;
+            covered = inFlight;
+            sinceSack = 0;
+        }
+    }
+
+    void onSack(uint64_t received, uint32_t now) {
+        received &= allFragments(count);
+        if (waiting && probes == 0) {
+            // Only an unambiguous round trip updates the estimate
+            uint32_t rtt = now - sackRequestedAt;
+            rttMs = (rttMs * 7 + rtt) / 8;
+        }
+        acked |= received;
+        // What went out before the SACK was asked for and isn't in it was lost, and can go again
+        inFlight &= ~covered & ~acked;
+        covered = 0;
+        if (window < MAX_WINDOW) window++;
+        waiting = false;
+        probes = 0;
+    }
+
+    uint32_t timeoutMs() const {
+        // Back off a little for a busy channel, but on a merely lossy one waiting longer doesn't help
+        uint32_t t = rttMs * 2 << (probes < 2 ? probes : 2);
+        return t < MIN_TIMEOUT_MS ? MIN_TIMEOUT_MS : t > MAX_TIMEOUT_MS ? MAX_TIMEOUT_MS : t;
+    }
+
+    // When next() will have something new to say, for sleeping until then
+    uint32_t waitLeftMs(uint32_t now) const {
+        if (!waiting) return 0;
+        uint32_t elapsed = now - sackRequestedAt, timeout = timeoutMs();
+        return elapsed >= timeout ? 0 : timeout - elapsed;
+    }
+
+private:
+    uint16_t id = 0;
+    uint8_t count = 0;
+    uint64_t acked = 0;    // Fragments the receiver has
+    uint64_t inFlight = 0; // Sent, and no SACK since has said whether they arrived
+    uint64_t covered = 0;  // What was in flight when the last SACK was asked for
+    uint8_t window = 2;
+    uint8_t sinceSack = 0;
+    bool waiting = false;
+    uint8_t probes = 0;
+    uint32_t sackRequestedAt = 0;
+    uint32_t rttMs = INITIAL_RTT_MS;
+
+    int firstMissing(uint64_t skip) const {
+        uint64_t missing = allFragments(count) & ~acked & ~skip;
+        for (uint8_t i = 0; i < count; i++) {
+            if (missing & (1ull << i)) return i;
+        }
+        return -1;
+    }
+};
+
+// Receiving side: a few messages at a time, each in a heap buffer sized from the fragment count.
+// A finished message is remembered until it times out so that fragments resent after a lost
+// SACK are answered again instead of starting it over.
+class Reassembler {
+public:
+    static constexpr uint8_t SLOTS = 2;
+    static constexpr uint32_t TIMEOUT_MS = 5 * 60 * 1000;
+
+    enum Result {
+        STORED,   // Keep going, SACK if the fragment asked
+        COMPLETE, // Message ready in the slot, SACK and deliver it
+        DUPLICATE,// Already finished, SACK if the fragment asked
+        REFUSED   // No room, tell the sender
+    };
+
+    struct Slot {
+        enum State : uint8_t { FREE, RECEIVING, DONE } state;
+        uint32_t from;
+        uint16_t id;
+        uint16_t port;
+        uint8_t count;
+        uint64_t received;
+        size_t length;
+        uint32_t lastHeardMs;
+        uint8_t *buffer;
+    };
+
+    ~Reassembler() {
+        for (auto &s : slots) free(s.buffer);
+    }
+
+    Result onData(uint32_t from, const Header &h, const uint8_t *bytes, size_t length, uint32_t now, Slot *&slot) {
+        expire(now);
+        slot = find(from, h.id);
+        if (slot && slot->state == Slot::DONE) {
+            slot->lastHeardMs = now;
+            return DUPLICATE;
+        }
+        if (slot && slot->count != h.count) {
+            // Same id, different message: the sender rebooted
+            drop(*slot);
+            slot = nullptr;
+        }
+        if (!slot) {
+            slot = claim(now);
+            if (!slot) return REFUSED;
+            slot->buffer = (uint8_t *)malloc((size_t)h.count * FRAGMENT_BYTES);
+            if (!slot->buffer) {
+                slot = nullptr;
+                return REFUSED;
+            }
+            slot->state = Slot::RECEIVING;
+            slot->from = from;
+            slot->id = h.id;
+            slot->port = h.port;
+            slot->count = h.count;
+            slot->received = 0;
+            slot->length = 0;
+        }
+        slot->lastHeardMs = now;
+        memcpy(slot->buffer + (size_t)h.index * FRAGMENT_BYTES, bytes, length);
+        slot->received |= 1ull << h.index;
+        if (h.index == h.count - 1) slot->length = (size_t)h.index * FRAGMENT_BYTES + length;
+        return slot->received == allFragments(slot->count) ? COMPLETE : STORED;
+    }
+
+    // After a COMPLETE message has been delivered: free its buffer, keep answering for it
+    void finish(Slot &slot) {
+        free(slot.buffer);
+        slot.buffer = nullptr;
+        slot.state = Slot::DONE;
+    }
+
+    void expire(uint32_t now) {
+        for (auto &s : slots) {
+            if (s.state != Slot::FREE && now - s.lastHeardMs >= TIMEOUT_MS) drop(s);
+        }
+    }
+
+    uint8_t receiving() const {
+        uint8_t n = 0;
+        for (auto &s : slots) n += s.state == Slot::RECEIVING;
+        return n;
+    }
+
+private:
+    Slot slots[SLOTS] = {};
+
+    Slot *find(uint32_t from, uint16_t id) {
+        for (auto &s : slots) {
+            if (s.state != Slot::FREE && s.from == from && s.id == id) return &s;
+        }
+        return nullptr;
+    }
+
+    // A free slot, else the finished one heard from longest ago. Messages still arriving are never evicted.
+    Slot *claim(uint32_t now) {
+        Slot *best = nullptr;
+        for (auto &s : slots) {
+            if (s.state == Slot::FREE) return &s;
+            if (s.state == Slot::DONE && (!best || now - s.lastHeardMs > now - best->lastHeardMs)) best = &s;
+        }
+        if (best) drop(*best);
+        return best;
+    }
+
+    void drop(Slot &s) {
+        free(s.buffer);
+        s = Slot();
+    }
+};
+
+} // namespace Fragment
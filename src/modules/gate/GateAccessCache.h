@@ -0,0 +1,235 @@
+#pragma once
+#include "mesh/generated/meshtastic/gate_control.pb.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Gate {
+
+enum Decision : uint8_t {
+    ALLOW = 0,
+    DENY_UNKNOWN_USER,
+    DENY_NOT_YET_VALID,
+    DENY_EXPIRED,
+    DENY_GATE,
+    DENY_LEVEL,
+    DENY_AUTH,
+    DENY_LOCKED
+};
+
+// AccessControl.User.access_level: each level includes the ones below it
+enum AccessLevel : uint8_t {
+    LEVEL_NONE = 0,    // Revokes the user when sent in an AccessControl update
+    LEVEL_OPERATE = 1, // Open, close, stop, status
+    LEVEL_LOCK = 2,    // Lock and unlock
+    LEVEL_ADMIN = 3    // Calibrate, audit upload, access list, schedule and config changes
+};
+
+inline AccessLevel requiredLevel(meshtastic_GateControl_Command command) {
+    switch (command) {
+        case meshtastic_GateControl_Command_LOCK:
+        case meshtastic_GateControl_Command_UNLOCK:
+            return LEVEL_LOCK;
+        case meshtastic_GateControl_Command_CALIBRATE:
+        case meshtastic_GateControl_Command_AUDIT_REQUEST:
+            return LEVEL_ADMIN;
+        default:
+            return LEVEL_OPERATE;
+    }
+}
+
+inline const char *getDecisionName(Decision decision) {
+    switch (decision) {
+        case ALLOW: return "ALLOW";
+        case DENY_UNKNOWN_USER: return "UNKNOWN_USER";
+        case DENY_NOT_YET_VALID: return "NOT_YET_VALID";
+        case DENY_EXPIRED: return "EXPIRED";
+        case DENY_GATE: return "WRONG_GATE";
+        case DENY_LEVEL: return "LEVEL";
+        case DENY_AUTH: return "BAD_AUTH";
+        case DENY_LOCKED: return "LOCKED";
+        default: return "UNKNOWN";
+    }
+}
+
+// SHA-256 of the PIN followed by the salt, into digest[32]. Passed in so this header stays free of a crypto library.
+typedef void (*PinDigest)(const uint8_t *pin, size_t pinLen, const uint8_t *salt, size_t saltLen, uint8_t *digest);
+
+// Local copy of the AccessControl user list, keyed by node id in an open-addressed table so a
+// command is decided with one or two probes instead of a round trip to the controller.
+// Entries carry their validity window; the earliest expiry is tracked so expired users are
+// swept out only when something actually expires.
+class AccessCache {
+public:
+    static constexpr uint8_t CAPACITY = 32; // Power of two
+    static constexpr uint8_t MAX_GATES = sizeof(((meshtastic_AccessControl_User *)0)->allowed_gates) / sizeof(uint32_t);
+    static constexpr uint8_t PIN_HASH_LEN = sizeof(((meshtastic_AccessControl_User *)0)->pin_hash.bytes);
+    static constexpr uint8_t PIN_SALT_LEN = sizeof(((meshtastic_AccessControl_User *)0)->pin_salt.bytes);
+    static constexpr uint32_t NEVER = 0xFFFFFFFF;
+
+    struct Entry {
+        uint32_t nodeId; // 0 = empty slot
+        uint32_t validFrom;
+        uint32_t validUntil; // NEVER for open-ended access
+        uint32_t gates[MAX_GATES];
+        uint8_t gateCount; // 0 = every gate
+        uint8_t level;
+        bool hasPin; // A full SHA-256 pin hash was sent
+        uint8_t saltLen;
+        uint8_t pinHash[PIN_HASH_LEN];
+        uint8_t pinSalt[PIN_SALT_LEN];
+    };
+
+    // Merge one user from an AccessControl update. access_level 0 revokes.
+    bool upsert(const meshtastic_AccessControl_User &user) {
+        if (user.node_id == 0) return false;
+        if (user.access_level == LEVEL_NONE) {
+            remove(user.node_id);
+            return true;
+        }
+        uint8_t slot = probe(user.node_id);
+        if (entries[slot].nodeId != user.node_id) {
+            if (count >= CAPACITY - 1) return false; // Keep one slot free so probes terminate
+            count++;
+        }
+        Entry &e = entries[slot];
+        memset(&e, 0, sizeof(e));
+        e.nodeId = user.node_id;
+        e.level = user.access_level > LEVEL_ADMIN ? static_cast<uint8_t>(LEVEL_ADMIN) : user.access_level;
+        e.validFrom = clampTime(user.valid_from);
+        e.validUntil = user.valid_until ? clampTime(user.valid_until) : NEVER;
+        e.gateCount = user.allowed_gates_count > MAX_GATES ? MAX_GATES : user.allowed_gates_count;
+        memcpy(e.gates, user.allowed_gates, e.gateCount * sizeof(uint32_t));
+        e.hasPin = user.pin_hash.size == PIN_HASH_LEN;
+        if (e.hasPin) {
+            memcpy(e.pinHash, user.pin_hash.bytes, PIN_HASH_LEN);
+            e.saltLen = user.pin_salt.size > PIN_SALT_LEN ? PIN_SALT_LEN : user.pin_salt.size;
+            memcpy(e.pinSalt, user.pin_salt.bytes, e.saltLen);
+        }
+        if (e.validUntil < nextExpiry) nextExpiry = e.validUntil;
+        return true;
+    }
+
+    bool remove(uint32_t nodeId) {
+        uint8_t slot = probe(nodeId);
+        if (entries[slot].nodeId != nodeId || nodeId == 0) return false;
+        erase(slot);
+        return true;
+    }
+
+    const Entry *find(uint32_t nodeId) const {
+        if (nodeId == 0) return nullptr;
+        uint8_t slot = probe(nodeId);
+        return entries[slot].nodeId == nodeId ? &entries[slot] : nullptr;
+    }
+
+    // Decide whether `nodeId` may do something needing `level` on `gateId` at `now` (epoch seconds).
+    // With requireAuth the presented PIN, hashed with the user's salt by `digest`, must match the user's pin hash.
+    Decision evaluate(uint32_t nodeId, uint32_t gateId, AccessLevel level, const uint8_t *pin, uint8_t pinLen,
+                      bool requireAuth, uint32_t now, PinDigest digest = nullptr) const {
+        const Entry *e = find(nodeId);
+        if (!e) return DENY_UNKNOWN_USER;
+        if (now < e->validFrom) return DENY_NOT_YET_VALID;
+        if (now >= e->validUntil) return DENY_EXPIRED;
+        if (e->gateCount) {
+            bool allowed = false;
+            for (uint8_t i = 0; i < e->gateCount; i++) {
+                if (e->gates[i] == gateId) allowed = true;
+            }
+            if (!allowed) return DENY_GATE;
+        }
+        if (e->level < level) return DENY_LEVEL;
+        if (requireAuth && !pinMatches(*e, pin, pinLen, digest)) return DENY_AUTH;
+        return ALLOW;
+    }
+
+    // Drop users whose validity ended. Cheap when nothing is due.
+    uint8_t expire(uint32_t now) {
+        if (now < nextExpiry) return 0;
+        uint8_t removed = 0;
+        nextExpiry = NEVER;
+        for (uint8_t i = 0; i < CAPACITY;) {
+            if (entries[i].nodeId && now >= entries[i].validUntil) {
+                erase(i);
+                removed++;
+                continue; // erase() may have shifted another entry into this slot
+            }
+            if (entries[i].nodeId && entries[i].validUntil < nextExpiry) nextExpiry = entries[i].validUntil;
+            i++;
+        }
+        return removed;
+    }
+
+    void clear() {
+        memset(entries, 0, sizeof(entries));
+        count = 0;
+        nextExpiry = NEVER;
+    }
+
+    uint8_t size() const { return count; }
+    uint32_t getNextExpiry() const { return nextExpiry; }
+
+    // Raw table, for persisting the cache across reboots
+    const Entry *data() const { return entries; }
+    bool restore(const Entry *saved, uint8_t n) {
+        clear();
+        for (uint8_t i = 0; i < n && i < CAPACITY; i++) {
+            if (!saved[i].nodeId) continue;
+            uint8_t slot = probe(saved[i].nodeId);
+            if (entries[slot].nodeId != saved[i].nodeId) count++;
+            entries[slot] = saved[i];
+            if (saved[i].validUntil < nextExpiry) nextExpiry = saved[i].validUntil;
+        }
+        return true;
+    }
+
+private:
+    Entry entries[CAPACITY] = {};
+    uint8_t count = 0;
+    uint32_t nextExpiry = NEVER;
+
+    static uint8_t home(uint32_t nodeId) { return (nodeId * 2654435761u) >> 27; } // Fibonacci hash, 5 bits
+
+    // Slot holding nodeId, or the empty slot where it would go
+    uint8_t probe(uint32_t nodeId) const {
+        uint8_t i = home(nodeId);
+        while (entries[i].nodeId && entries[i].nodeId != nodeId) {
+            i = (i + 1) & (CAPACITY - 1);
+        }
+        return i;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    void erase(uint8_t slot) {
+        uint8_t hole = slot;
+        uint8_t i = slot;
+        while (true) {
+            i = (i + 1) & (CAPACITY - 1);
+            if (!entries[i].nodeId) break;
+            uint8_t h = home(entries[i].nodeId);
+            // Move the entry back if its home is not in the cyclic range (hole, i]
+            bool inRange = hole <= i ? (h > hole && h <= i) : (h > hole || h <= i);
+            if (!inRange) {
+                entries[hole] = entries[i];
+                hole = i;
+            }
+        }
+        memset(&entries[hole], 0, sizeof(Entry));
+        count--;
+    }
+
+    static uint32_t clampTime(uint64_t t) { return t >= NEVER ? NEVER - 1 : static_cast<uint32_t>(t); }
+
+    static bool pinMatches(const Entry &e, const uint8_t *pin, uint8_t pinLen, PinDigest digest) {
+        if (!e.hasPin || !pinLen || !pin || !digest) return false;
+        uint8_t hashed[PIN_HASH_LEN];
+        digest(pin, pinLen, e.pinSalt, e.saltLen, hashed);
+        // Constant time: every byte is compared whatever the first mismatch
+        uint8_t diff = 0;
+        for (uint8_t i = 0; i < PIN_HASH_LEN; i++) {
+            diff |= e.pinHash[i] ^ hashed[i];
+        }
+        return diff == 0;
+    }
+};
+
+} // namespace Gate
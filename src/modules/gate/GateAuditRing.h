@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace Gate {
+
+// One gate event in 16 bytes. Expanded to GateAuditLog only when uploaded.
+struct AuditRecord {
+    uint32_t timestamp; // Epoch seconds, 0 if the clock was not set
+    uint32_t userId;    // Node that issued the command, our own node for scheduled actions
+    uint32_t gateId;    // As GateConfig.gate_id
+    uint8_t command;    // meshtastic_GateControl_Command
+    uint8_t decision;   // Gate::Decision, ALLOW on success
+    uint16_t reserved;
+};
+
+// Fixed-size ring of audit records with an upload cursor. The whole ring is a flat image
+// (header + records) so it can be written to flash in one piece and reloaded after a reboot.
+class AuditRing {
+public:
+    static constexpr uint16_t CAPACITY = 128;
+    static constexpr uint32_t MAGIC = 0x47415502; // "GAU" v2, 32-bit gate ids
+
+    struct Image {
+        uint32_t magic;
+        uint16_t head;   // Next slot to write
+        uint16_t count;  // Records held
+        uint16_t unsent; // Newest `unsent` records have not been uploaded
+        uint16_t reserved;
+        AuditRecord records[CAPACITY];
+    };
+
+    AuditRing() { clear(); }
+
+    void append(const AuditRecord &record) {
+        image.records[image.head] = record;
+        image.head = (image.head + 1) % CAPACITY;
+        if (image.count < CAPACITY) image.count++;
+        if (image.unsent < CAPACITY) image.unsent++; // When full, the oldest unsent record is lost
+        else overwritten++;
+        dirty = true;
+    }
+
+    uint16_t size() const { return image.count; }
+    uint16_t pending() const { return image.unsent; }
+
+    // Copy up to `max` of the oldest unsent records, in order
+    uint16_t peekUnsent(AuditRecord *out, uint16_t max) const {
+        uint16_t n = image.unsent < max ? image.unsent : max;
+        uint16_t start = (image.head + CAPACITY - image.unsent) % CAPACITY;
+        for (uint16_t i = 0; i < n; i++) {
+            out[i] = image.records[(start + i) % CAPACITY];
+        }
+        return n;
+    }
+
+    // Unsent records lost to wrap-around since boot. A batch awaiting its ACK shrinks by as many,
+    // as they were its oldest.
+    uint32_t overwrittenUnsent() const { return overwritten; }
+
+    void markSent(uint16_t n) {
+        image.unsent = n >= image.unsent ? 0 : image.unsent - n;
+        dirty = true;
+    }
+
+    // Newest first, i = 0 is the latest record
+    const AuditRecord *latest(uint16_t i) const {
+        if (i >= image.count) return nullptr;
+        return &image.records[(image.head + CAPACITY - 1 - i) % CAPACITY];
+    }
+
+    void clear() {
+        memset(&image, 0, sizeof(image));
+        image.magic = MAGIC;
+        dirty = false;
+    }
+
+    const Image &raw() const { return image; }
+    bool load(const Image &saved) {
+        if (saved.magic != MAGIC || saved.head >= CAPACITY || saved.count > CAPACITY || saved.unsent > saved.count) {
+            return false;
+        }
+        image = saved;
+        dirty = false;
+        return true;
+    }
+
+    bool isDirty() const { return dirty; }
+    void clearDirty() { dirty = false; }
+
+private:
+    Image image;
+    bool dirty = false;
+    uint32_t overwritten = 0;
+};
+
+} // namespace Gate
@@ -0,0 +1,537 @@
+#include "GateControlModule.h"
+#include "FSCommon.h"
+#include "MeshService.h"
+#include "NodeDB.h"
+#include "RTC.h"
+#include "SPILock.h"
+#include "SafeFile.h"
+#include "main.h"
+#include "modules/irrigation/IrrigationNode.h"
+#include <Arduino.h>
+#include <SHA256.h>
+
+GateControlModule *gateControlModule;
+
+static const char *accessFileName = "/prefs/gate_access.bin";
+static const char *settingsFileName = "/prefs/gate_settings.bin";
+static const char *auditFileName = "/prefs/gate_audit.bin";
+
+// Audit codes for list/config updates, beyond the GateControl commands
+static constexpr uint8_t AUDIT_ACCESS_UPDATE = 100;
+static constexpr uint8_t AUDIT_SCHEDULE_UPDATE = 101;
+static constexpr uint8_t AUDIT_CONFIG_UPDATE = 102;
+static constexpr uint8_t AUDIT_AUTO_CLOSE = 103;
+
+struct GateSettings {
+    meshtastic_GateConfig config;
+    meshtastic_GateSchedule schedule;
+    bool requireAuth;
+    bool logAccess;
+};
+
+static const char *getAuditActionName(uint8_t code) {
+    switch (code) {
+        case meshtastic_GateControl_Command_OPEN: return "OPEN";
+        case meshtastic_GateControl_Command_CLOSE: return "CLOSE";
+        case meshtastic_GateControl_Command_STOP: return "STOP";
+        case meshtastic_GateControl_Command_STATUS_REQUEST: return "STATUS";
+        case meshtastic_GateControl_Command_LOCK: return "LOCK";
+        case meshtastic_GateControl_Command_UNLOCK: return "UNLOCK";
+        case meshtastic_GateControl_Command_CALIBRATE: return "CALIBRATE";
+        case meshtastic_GateControl_Command_AUDIT_REQUEST: return "AUDIT";
+        case AUDIT_ACCESS_UPDATE: return "ACCESS_SET";
+        case AUDIT_SCHEDULE_UPDATE: return "SCHED_SET";
+        case AUDIT_CONFIG_UPDATE: return "CONFIG_SET";
+        case AUDIT_AUTO_CLOSE: return "AUTO_CLOSE";
+        default: return "UNSET";
+    }
+}
+
+// Each file starts with this header. A file from another layout is refused, rather than read into the new one.
+struct BlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t length;
+};
+static constexpr uint32_t BLOB_MAGIC = 0x47415445; // "GATE"
+// Bump when GateSettings, AccessCache::Entry or AuditRing::Image change. Version 1 files had no header.
+static constexpr uint16_t BLOB_VERSION = 3;
+
+static bool readBlob(const char *fileName, void *data, size_t len) {
+#ifdef FSCom
+    concurrency::LockGuard g(spiLock);
+    auto file = FSCom.open(fileName, FILE_O_READ);
+    if (!file) {
+        return false;
+    }
+    BlobHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && header.magic == BLOB_MAGIC &&
+              header.version == BLOB_VERSION && header.length == len && file.read((uint8_t *)data, len) == len;
+    file.close();
+    if (!ok) {
+        LOG_WARN("%s is from another firmware version, starting fresh", fileName);
+    }
+    return ok;
+#else
+    return false;
+#endif
+}
+
+// Written to a temporary file and renamed over the old one, so a power cut leaves either copy intact
+static bool writeBlob(const char *fileName, const void *data, size_t len) {
+#ifdef FSCom
+    spiLock->lock();
+    FSCom.mkdir("/prefs");
+    spiLock->unlock();
+
+    BlobHeader header = {BLOB_MAGIC, BLOB_VERSION, 0, (uint32_t)len};
+    auto file = SafeFile(fileName, true);
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)data, len) == len;
+    ok &= file.close();
+    if (!ok) {
+        LOG_ERROR("Can't write %s", fileName);
+    }
+    return ok;
+#else
+    return false;
+#endif
+}
+
+GateControlModule::GateControlModule()
+    : ProtobufModule("GateControl", meshtastic_PortNum_GATE_CONTROL_APP, &meshtastic_GateControl_msg),
+      concurrency::OSThread("GateControl") {
+    loadState();
+    LOG_INFO("Gate %u ready: %d user(s), %d schedule event(s), %d audit record(s) pending", gateConfig.gate_id,
+             access.size(), schedule.events_count, audit.pending());
+}
+
+int32_t GateControlModule::runOnce() {
+    uint32_t now = getValidTime(RTCQualityDevice);
+    if (now) {
+        uint8_t expired = access.expire(now);
+        if (expired) {
+            LOG_INFO("Gate access: %d user(s) expired", expired);
+            saveAccess();
+        }
+    }
+
+    runSchedule(getValidTime(RTCQualityDevice, true));
+
+    // A delay of 0 is taken as not configured, not as closing the moment the gate opens
+    if (gateConfig.auto_close_enabled && gateConfig.auto_close_delay_ms && state == meshtastic_GateStatus_State_OPEN &&
+        !locked && millis() - openedAtMs >= gateConfig.auto_close_delay_ms) {
+        applyCommand(meshtastic_GateControl_Command_CLOSE);
+        recordAudit(nodeDB->getNodeNum(), AUDIT_AUTO_CLOSE, Gate::ALLOW);
+    }
+
+    if (auditRequester) {
+        sendAuditBatch();
+    }
+
+    // Batch flash writes: a busy gate would otherwise rewrite the ring on every event
+    if (audit.isDirty() &&
+        (auditUnsaved >= AUDIT_SAVE_THRESHOLD || millis() - lastAuditSaveMs >= AUDIT_SAVE_INTERVAL_MS)) {
+        saveAudit();
+    }
+
+    return auditRequester ? 2000 : 5000;
+}
+
+bool GateControlModule::wantPacket(const meshtastic_MeshPacket *p) {
+    // The ACK or NAK for the audit batch in flight
+    if (p->decoded.portnum == meshtastic_PortNum_ROUTING_APP) {
+        return auditInFlight && p->decoded.request_id == auditPacketId;
+    }
+    return ProtobufModule::wantPacket(p);
+}
+
+bool GateControlModule::handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_GateControl *p) {
+    if (mp.decoded.portnum == meshtastic_PortNum_ROUTING_APP) {
+        handleAuditAck(mp);
+        return false; // The routing module still needs it
+    }
+    if (!p) {
+        return false;
+    }
+    // gate_id 0 addresses whichever gate the node runs
+    if (p->gate_id && gateConfig.gate_id && p->gate_id != gateConfig.gate_id) {
+        return false;
+    }
+
+    NodeNum from = getFrom(&mp);
+    switch (p->which_variant) {
+        case meshtastic_GateControl_status_tag:
+            LOG_DEBUG("Gate %u status from 0x%x: state %d", p->variant.status.gate_id, from, p->variant.status.state);
+            return true;
+        case meshtastic_GateControl_audit_tag:
+            // Uploads from other gates, consumed by the controller application
+            return false;
+        case meshtastic_GateControl_access_tag:
+        case meshtastic_GateControl_schedule_tag:
+        case meshtastic_GateControl_config_tag: {
+            Gate::Decision decision = authorize(mp, *p, Gate::LEVEL_ADMIN);
+            uint8_t code = p->which_variant == meshtastic_GateControl_access_tag     ? AUDIT_ACCESS_UPDATE
+                           : p->which_variant == meshtastic_GateControl_schedule_tag ? AUDIT_SCHEDULE_UPDATE
+                                                                                    : AUDIT_CONFIG_UPDATE;
+            recordAudit(from, code, decision);
+            if (decision != Gate::ALLOW) {
+                LOG_WARN("Gate update from 0x%x rejected: %s", from, Gate::getDecisionName(decision));
+                return true;
+            }
+            if (p->which_variant == meshtastic_GateControl_access_tag) {
+                mergeAccessList(p->variant.access);
+            } else if (p->which_variant == meshtastic_GateControl_schedule_tag) {
+                schedule = p->variant.schedule;
+                lastScheduleMinute = UINT32_MAX;
+                LOG_INFO("Gate schedule updated: %d event(s)", schedule.events_count);
+                saveSettings();
+            } else {
+                uint32_t keepId = gateConfig.gate_id;
+                gateConfig = p->variant.config;
+                if (!gateConfig.gate_id) {
+                    gateConfig.gate_id = keepId;
+                }
+                LOG_INFO("Gate config updated: id %u '%s'", gateConfig.gate_id, gateConfig.name);
+                saveSettings();
+            }
+            return true;
+        }
+        default:
+            handleCommand(mp, *p);
+            return true;
+    }
+}
+
+// How the controller makes AccessControl.User.pin_hash
+static void pinDigest(const uint8_t *pin, size_t pinLen, const uint8_t *salt, size_t saltLen, uint8_t *digest) {
+    SHA256 hash;
+    hash.update(pin, pinLen);
+    hash.update(salt, saltLen);
+    hash.finalize(digest, 32);
+}
+
+bool GateControlModule::isTrustedSource(NodeNum from) const {
+    // Our own phone/console, and the controller this gate reports to (it provisions the lists)
+    return from == nodeDB->getNodeNum() || (nodeConfig.parentNode && from == nodeConfig.parentNode);
+}
+
+Gate::Decision GateControlModule::authorize(const meshtastic_MeshPacket &mp, const meshtastic_GateControl &g,
+                                            Gate::AccessLevel level) {
+    NodeNum from = getFrom(&mp);
+    if (isTrustedSource(from)) {
+        return Gate::ALLOW;
+    }
+    // Without a valid clock now is 0, so users whose window starts later are refused
+    uint32_t now = getValidTime(RTCQualityDevice);
+    return access.evaluate(from, gateConfig.gate_id, level, g.auth_token.bytes, g.auth_token.size, requireAuth, now,
+                           pinDigest);
+}
+
+void GateControlModule::handleCommand(const meshtastic_MeshPacket &mp, const meshtastic_GateControl &g) {
+    NodeNum from = getFrom(&mp);
+    Gate::Decision decision = authorize(mp, g, Gate::requiredLevel(g.command));
+    if (decision == Gate::ALLOW && locked &&
+        (g.command == meshtastic_GateControl_Command_OPEN || g.command == meshtastic_GateControl_Command_CLOSE)) {
+        decision = Gate::DENY_LOCKED;
+    }
+
+    if (decision == Gate::ALLOW) {
+        if (g.command == meshtastic_GateControl_Command_AUDIT_REQUEST) {
+            auditRequester = from;
+            auditPacketsLeft = AUDIT_UPLOAD_PACKETS_PER_REQUEST;
+        } else {
+            applyCommand(g.command);
+        }
+    }
+    LOG_INFO("Gate %s from 0x%x: %s", getAuditActionName(g.command), from, Gate::getDecisionName(decision));
+
+    // Status polls are not worth flash space unless they were refused
+    if (decision != Gate::ALLOW || (logAccess && g.command != meshtastic_GateControl_Command_STATUS_REQUEST)) {
+        recordAudit(from, g.command, decision);
+    }
+    if (g.command != meshtastic_GateControl_Command_AUDIT_REQUEST || decision != Gate::ALLOW) {
+        sendStatus(from, decision);
+    }
+}
+
+bool GateControlModule::applyCommand(meshtastic_GateControl_Command command) {
+    uint32_t now = getValidTime(RTCQualityDevice);
+    switch (command) {
+        case meshtastic_GateControl_Command_OPEN:
+            driveGate(true);
+            state = meshtastic_GateStatus_State_OPEN;
+            cycleCount++;
+            lastOpened = now;
+            openedAtMs = millis();
+            return true;
+        case meshtastic_GateControl_Command_CLOSE:
+            driveGate(false);
+            state = meshtastic_GateStatus_State_CLOSED;
+            lastClosed = now;
+            return true;
+        case meshtastic_GateControl_Command_STOP:
+            stopGate();
+            return true;
+        case meshtastic_GateControl_Command_LOCK:
+            locked = true;
+            return true;
+        case meshtastic_GateControl_Command_UNLOCK:
+            locked = false;
+            return true;
+        case meshtastic_GateControl_Command_CALIBRATE:
+            stopGate();
+            LOG_INFO("Gate calibration requested");
+            return true;
+        case meshtastic_GateControl_Command_STATUS_REQUEST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void GateControlModule::mergeAccessList(const meshtastic_AccessControl &list) {
+    uint8_t rejected = 0;
+    for (pb_size_t i = 0; i < list.users_count; i++) {
+        if (!access.upsert(list.users[i])) {
+            rejected++;
+        }
+    }
+    requireAuth = list.require_auth;
+    logAccess = list.log_access;
+    if (rejected) {
+        LOG_WARN("Gate access cache full, %d user(s) not stored", rejected);
+    }
+    LOG_INFO("Gate access list merged: %d user(s) cached, auth %s", access.size(), requireAuth ? "required" : "off");
+    saveAccess();
+    saveSettings();
+}
+
+void GateControlModule::runSchedule(uint32_t localNow) {
+    if (!localNow || !schedule.events_count) {
+        return;
+    }
+    uint32_t minuteOfEpoch = localNow / 60;
+    if (minuteOfEpoch == lastScheduleMinute) {
+        return;
+    }
+    lastScheduleMinute = minuteOfEpoch;
+
+    uint32_t hour = (localNow / 3600) % 24;
+    uint32_t minute = minuteOfEpoch % 60;
+    uint32_t dayOfWeek = (localNow / 86400 + 4) % 7; // 1970-01-01 was a Thursday
+
+    for (pb_size_t i = 0; i < schedule.events_count; i++) {
+        const meshtastic_GateSchedule_Event &event = schedule.events[i];
+        if (!event.enabled || event.hour != hour || event.minute != minute) {
+            continue;
+        }
+        bool today = event.days_of_week_count == 0;
+        for (pb_size_t d = 0; d < event.days_of_week_count; d++) {
+            if (event.days_of_week[d] == dayOfWeek) {
+                today = true;
+            }
+        }
+        if (!today) {
+            continue;
+        }
+
+        meshtastic_GateControl_Command command;
+        switch (event.action) {
+            case meshtastic_GateSchedule_Event_Action_OPEN: command = meshtastic_GateControl_Command_OPEN; break;
+            case meshtastic_GateSchedule_Event_Action_CLOSE: command = meshtastic_GateControl_Command_CLOSE; break;
+            case meshtastic_GateSchedule_Event_Action_LOCK: command = meshtastic_GateControl_Command_LOCK; break;
+            default: command = meshtastic_GateControl_Command_UNLOCK; break;
+        }
+        Gate::Decision decision = Gate::ALLOW;
+        if (locked && (command == meshtastic_GateControl_Command_OPEN || command == meshtastic_GateControl_Command_CLOSE)) {
+            decision = Gate::DENY_LOCKED;
+        } else {
+            applyCommand(command);
+        }
+        LOG_INFO("Gate schedule %02u:%02u %s: %s", hour, minute, getAuditActionName(command), Gate::getDecisionName(decision));
+        recordAudit(nodeDB->getNodeNum(), command, decision);
+    }
+}
+
+void GateControlModule::recordAudit(uint32_t userId, uint8_t command, Gate::Decision decision) {
+    Gate::AuditRecord record;
+    record.timestamp = getValidTime(RTCQualityDevice);
+    record.userId = userId;
+    record.gateId = gateConfig.gate_id;
+    record.command = command;
+    record.decision = decision;
+    audit.append(record);
+    auditUnsaved++;
+}
+
+void GateControlModule::sendStatus(NodeNum dest, Gate::Decision decision) {
+    meshtastic_GateControl reply = meshtastic_GateControl_init_zero;
+    reply.gate_id = gateConfig.gate_id;
+    reply.which_variant = meshtastic_GateControl_status_tag;
+    meshtastic_GateStatus &status = reply.variant.status;
+    status.gate_id = gateConfig.gate_id;
+    status.state = locked ? meshtastic_GateStatus_State_LOCKED : state;
+    status.position_percent = state == meshtastic_GateStatus_State_OPEN ? 100 : 0;
+    status.cycle_count = cycleCount;
+    status.last_opened = lastOpened;
+    status.last_closed = lastClosed;
+    status.error_code = decision;
+    if (decision != Gate::ALLOW) {
+        strncpy(status.error_message, Gate::getDecisionName(decision), sizeof(status.error_message) - 1);
+    }
+
+    meshtastic_MeshPacket *p = allocDataProtobuf(reply);
+    p->to = dest;
+    p->priority = meshtastic_MeshPacket_Priority_RELIABLE;
+    service->sendToMesh(p);
+}
+
+void GateControlModule::sendAuditBatch() {
+    if (auditInFlight) {
+        if (millis() - auditSentMs < AUDIT_ACK_TIMEOUT_MS) {
+            return;
+        }
+        // Neither ACK nor NAK came back. The records are still unsent, the next batch carries them again.
+        LOG_WARN("Gate audit batch 0x%x to 0x%x not acknowledged", auditPacketId, auditRequester);
+        auditInFlight = 0;
+    }
+    if (!audit.pending() || !auditPacketsLeft) {
+        LOG_INFO("Gate audit upload to 0x%x done, %d record(s) still queued", auditRequester, audit.pending());
+        auditRequester = 0;
+        return;
+    }
+
+    static constexpr uint8_t PER_PACKET = sizeof(((meshtastic_GateAuditBatch *)0)->entries) / sizeof(meshtastic_GateAuditLog);
+    Gate::AuditRecord records[PER_PACKET];
+    uint16_t n = audit.peekUnsent(records, PER_PACKET);
+
+    meshtastic_GateControl reply = meshtastic_GateControl_init_zero;
+    reply.gate_id = gateConfig.gate_id;
+    reply.which_variant = meshtastic_GateControl_audit_tag;
+    meshtastic_GateAuditBatch &batch = reply.variant.audit;
+    for (uint16_t i = 0; i < n; i++) {
+        meshtastic_GateAuditLog &entry = batch.entries[batch.entries_count++];
+        entry.timestamp = records[i].timestamp;
+        entry.gate_id = records[i].gateId;
+        entry.user_id = records[i].userId;
+        strncpy(entry.action, getAuditActionName(records[i].command), sizeof(entry.action) - 1);
+        entry.success = records[i].decision == Gate::ALLOW;
+        if (!entry.success) {
+            strncpy(entry.details, Gate::getDecisionName(static_cast<Gate::Decision>(records[i].decision)),
+                    sizeof(entry.details) - 1);
+        }
+    }
+    batch.remaining = audit.pending() - n;
+
+    meshtastic_MeshPacket *p = allocDataProtobuf(reply);
+    p->to = auditRequester;
+    p->want_ack = true;
+    p->priority = meshtastic_MeshPacket_Priority_RELIABLE;
+    // Marked sent only once the requester ACKs it, so a lost packet is uploaded again
+    auditPacketId = p->id;
+    auditInFlight = n;
+    auditOverwrittenAtSend = audit.overwrittenUnsent();
+    auditSentMs = millis();
+    auditPacketsLeft--;
+    service->sendToMesh(p);
+}
+
+void GateControlModule::handleAuditAck(const meshtastic_MeshPacket &mp) {
+    meshtastic_Routing routing = meshtastic_Routing_init_default;
+    if (!pb_decode_from_bytes(mp.decoded.payload.bytes, mp.decoded.payload.size, meshtastic_Routing_fields, &routing)) {
+        return;
+    }
+    if (routing.error_reason == meshtastic_Routing_Error_NONE) {
+        // Records overwritten while we waited were the oldest of the batch, and are already gone
+        uint32_t lost = audit.overwrittenUnsent() - auditOverwrittenAtSend;
+        audit.markSent(lost >= auditInFlight ? 0 : auditInFlight - lost);
+        auditUnsaved++;
+    } else {
+        LOG_WARN("Gate audit batch 0x%x to 0x%x failed: %d", auditPacketId, auditRequester, routing.error_reason);
+    }
+    auditInFlight = 0;
+    setIntervalFromNow(0);
+}
+
+void GateControlModule::handleConsoleCommand(const char* cmd) {
+    if (strcmp(cmd, "status") == 0) {
+        LOG_INFO("Gate %u: %s%s, %u cycles\n", gateConfig.gate_id, locked ? "locked, " : "",
+                 state == meshtastic_GateStatus_State_OPEN ? "open" : "closed", cycleCount);
+        LOG_INFO("  Users: %d cached, auth %s, next expiry %u\n", access.size(), requireAuth ? "required" : "off",
+                 access.getNextExpiry());
+        LOG_INFO("  Schedule: %d event(s)\n", schedule.events_count);
+        LOG_INFO("  Audit: %d record(s), %d not uploaded\n", audit.size(), audit.pending());
+    }
+    else if (strcmp(cmd, "open") == 0 || strcmp(cmd, "close") == 0) {
+        meshtastic_GateControl_Command command =
+            cmd[0] == 'o' ? meshtastic_GateControl_Command_OPEN : meshtastic_GateControl_Command_CLOSE;
+        Gate::Decision decision = locked ? Gate::DENY_LOCKED : Gate::ALLOW;
+        if (decision == Gate::ALLOW) {
+            applyCommand(command);
+        }
+        recordAudit(nodeDB->getNodeNum(), command, decision);
+        LOG_INFO("Gate %s: %s\n", cmd, Gate::getDecisionName(decision));
+    }
+    else if (strcmp(cmd, "audit") == 0) {
+        for (uint16_t i = 0; i < 10; i++) {
+            const Gate::AuditRecord *r = audit.latest(i);
+            if (!r) {
+                break;
+            }
+            LOG_INFO("  %u 0x%x %s %s\n", r->timestamp, r->userId, getAuditActionName(r->command),
+                     Gate::getDecisionName(static_cast<Gate::Decision>(r->decision)));
+        }
+    }
+    else {
+        LOG_ERROR("Usage: gate status|open|close|audit\n");
+    }
+}
+
+void GateControlModule::loadState() {
+    GateSettings settings;
+    if (readBlob(settingsFileName, &settings, sizeof(settings))) {
+        gateConfig = settings.config;
+        schedule = settings.schedule;
+        requireAuth = settings.requireAuth;
+        logAccess = settings.logAccess;
+    }
+
+    Gate::AccessCache::Entry *entries = new Gate::AccessCache::Entry[Gate::AccessCache::CAPACITY];
+    if (readBlob(accessFileName, entries, sizeof(Gate::AccessCache::Entry) * Gate::AccessCache::CAPACITY)) {
+        access.restore(entries, Gate::AccessCache::CAPACITY);
+    }
+    delete[] entries;
+
+    Gate::AuditRing::Image *image = new Gate::AuditRing::Image;
+    if (readBlob(auditFileName, image, sizeof(*image)) && !audit.load(*image)) {
+        LOG_WARN("Gate audit log on flash is corrupt, starting a new one");
+    }
+    delete image;
+}
+
+void GateControlModule::saveAccess() {
+    writeBlob(accessFileName, access.data(), sizeof(Gate::AccessCache::Entry) * Gate::AccessCache::CAPACITY);
+}
+
+void GateControlModule::saveSettings() {
+    GateSettings settings;
+    settings.config = gateConfig;
+    settings.schedule = schedule;
+    settings.requireAuth = requireAuth;
+    settings.logAccess = logAccess;
+    writeBlob(settingsFileName, &settings, sizeof(settings));
+}
+
+void GateControlModule::saveAudit() {
+    if (writeBlob(auditFileName, &audit.raw(), sizeof(Gate::AuditRing::Image))) {
+        audit.clearDirty();
+        auditUnsaved = 0;
+    }
+    lastAuditSaveMs = millis();
+}
+
+// Hardware interface stubs (to be implemented based on actual hardware)
+void GateControlModule::driveGate(bool open) {}
+void GateControlModule::stopGate() {}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "GateAccessCache.h"
+#include "GateAuditRing.h"
+#include "ProtobufModule.h"
+#include "concurrency/OSThread.h"
+#include "mesh/generated/meshtastic/gate_control.pb.h"
+
+// Runs a gate on the node itself: commands are checked against a local copy of the access list,
+// schedules fire from the node's clock, and every decision lands in an on-flash audit ring
+// that the controller pulls with AUDIT_REQUEST. The mesh is only needed to update the lists.
+class GateControlModule : public ProtobufModule<meshtastic_GateControl>, private concurrency::OSThread {
+public:
+    GateControlModule();
+
+    int32_t runOnce() override;
+
+    void handleConsoleCommand(const char* cmd);
+
+    uint32_t getGateId() const { return gateConfig.gate_id; }
+    meshtastic_GateStatus_State getState() const { return state; }
+
+protected:
+    bool wantPacket(const meshtastic_MeshPacket *p) override;
+    bool handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_GateControl *p) override;
+
+private:
+    Gate::AccessCache access;
+    Gate::AuditRing audit;
+    meshtastic_GateConfig gateConfig = meshtastic_GateConfig_init_zero;
+    meshtastic_GateSchedule schedule = meshtastic_GateSchedule_init_zero;
+    bool requireAuth = true;
+    bool logAccess = true;
+
+    meshtastic_GateStatus_State state = meshtastic_GateStatus_State_UNKNOWN;
+    bool locked = false;
+    uint32_t cycleCount = 0;
+    uint32_t lastOpened = 0;
+    uint32_t lastClosed = 0;
+    uint32_t openedAtMs = 0;
+
+    uint32_t lastScheduleMinute = UINT32_MAX;
+    NodeNum auditRequester = 0;
+    uint32_t lastAuditSaveMs = 0;
+
+    static constexpr uint32_t AUDIT_SAVE_INTERVAL_MS = 60000;
+    static constexpr uint16_t AUDIT_SAVE_THRESHOLD = 16;
+    static constexpr uint16_t AUDIT_UPLOAD_PACKETS_PER_REQUEST = 8;
+    static constexpr uint32_t AUDIT_ACK_TIMEOUT_MS = 60000; // Past the router's own retransmissions and NAK
+    uint16_t auditUnsaved = 0;
+    uint16_t auditPacketsLeft = 0;
+
+    // The batch sent to auditRequester and not yet acknowledged
+    PacketId auditPacketId = 0;
+    uint16_t auditInFlight = 0;
+    uint32_t auditOverwrittenAtSend = 0;
+    uint32_t auditSentMs = 0;
+
+    bool isTrustedSource(NodeNum from) const;
+    Gate::Decision authorize(const meshtastic_MeshPacket &mp, const meshtastic_GateControl &g, Gate::AccessLevel level);
+    void handleCommand(const meshtastic_MeshPacket &mp, const meshtastic_GateControl &g);
+    bool applyCommand(meshtastic_GateControl_Command command);
+    void mergeAccessList(const meshtastic_AccessControl &list);
+    void runSchedule(uint32_t localNow);
+    void recordAudit(uint32_t userId, uint8_t command, Gate::Decision decision);
+    void sendStatus(NodeNum dest, Gate::Decision decision);
+    void sendAuditBatch();
+    void handleAuditAck(const meshtastic_MeshPacket &mp);
+
+    // Flash persistence
+    void loadState();
+    void saveAccess();
+    void saveSettings();
+    void saveAudit();
+
+    // Hardware interface (to be implemented based on actual hardware)
+    void driveGate(bool open);
+    void stopGate();
+};
+
+extern GateControlModule *gateControlModule;
@@ -0,0 +1,170 @@
+#pragma once
+#include "mesh/generated/meshtastic/irrigation.pb.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Irrigation {
+
+// Worst-case encoded size of a target is 22 bytes, so 10 always fit in one LoRa payload
+static constexpr uint8_t MAX_TARGETS_PER_PACKET = 10;
+static constexpr uint8_t MAX_TARGETS_PER_BATCH =
+    sizeof(((meshtastic_IrrigationCommand *)0)->targets) / sizeof(((meshtastic_IrrigationCommand *)0)->targets[0]);
+
+// Replay protection for command batches: per commanding node, the highest sequence seen
+// plus a 32-deep bitmap of recent ones. Anything older than the window is treated as stale.
+class SequenceWindow {
+private:
+    struct Entry {
+        uint32_t node;
+        uint32_t highest;
+        uint32_t seen;
+        uint32_t lastUsed;
+    };
+    static constexpr uint8_t MAX_SOURCES = 8;
+    Entry entries[MAX_SOURCES] = {};
+    uint32_t useCounter = 0;
+
+    Entry *find(uint32_t node) {
+        for (auto &e : entries) {
+            if (e.node == node) return &e;
+        }
+        return nullptr;
+    }
+public:
+    // True the first time (node, sequence) is seen, false for duplicates and stale sequences
+    bool accept(uint32_t node, uint32_t sequence) {
+        Entry *e = find(node);
+        if (!e) {
+            // Evict the least recently used source
+            e = &entries[0];
+            for (auto &candidate : entries) {
+                if (candidate.lastUsed < e->lastUsed) e = &candidate;
+            }
+            e->node = node;
+            e->highest = sequence;
+            e->seen = 1;
+            e->lastUsed = ++useCounter;
+            return true;
+        }
+        e->lastUsed = ++useCounter;
+        int32_t ahead = static_cast<int32_t>(sequence - e->highest);
+        if (ahead > 0) {
+            e->seen = ahead >= 32 ? 1 : (e->seen << ahead) | 1;
+            e->highest = sequence;
+            return true;
+        }
+        uint32_t behind = static_cast<uint32_t>(-ahead);
+        if (behind >= 32) return false;
+        uint32_t bit = 1u << behind;
+        if (e->seen & bit) return false;
+        e->seen |= bit;
+        return true;
+    }
+    void clear() {
+        memset(entries, 0, sizeof(entries));
+        useCounter = 0;
+    }
+};
+
+// Controller side: remembers outstanding batches, folds the per-node ACKs into one result
+// per batch, and builds retries that only carry the targets that have not answered yet.
+class BatchTracker {
+public:
+    struct Pending {
+        bool active;
+        uint32_t sequence;
+        uint32_t sentAtMs;
+        uint8_t retries;
+        uint8_t targetCount;
+        uint16_t ackedMask;
+        uint16_t failedMask;
+        meshtastic_IrrigationCommand_Target targets[MAX_TARGETS_PER_BATCH];
+        meshtastic_IrrigationAck_Result results[MAX_TARGETS_PER_BATCH];
+
+        bool complete() const { return ackedMask == static_cast<uint16_t>((1u << targetCount) - 1); }
+        uint8_t ackedCount() const { return __builtin_popcount(ackedMask); }
+        uint8_t failedCount() const { return __builtin_popcount(failedMask); }
+    };
+    static constexpr uint8_t MAX_PENDING = 4;
+
+    Pending *track(uint32_t sequence, const meshtastic_IrrigationCommand_Target *targets, uint8_t count, uint32_t nowMs) {
+        if (count > MAX_TARGETS_PER_BATCH) count = MAX_TARGETS_PER_BATCH;
+        Pending *slot = nullptr;
+        for (auto &p : pending) {
+            if (!p.active) {
+                slot = &p;
+                break;
+            }
+            if (!slot || static_cast<int32_t>(p.sentAtMs - slot->sentAtMs) < 0) slot = &p; // Oldest gets replaced
+        }
+        memset(slot, 0, sizeof(*slot));
+        slot->active = true;
+        slot->sequence = sequence;
+        slot->sentAtMs = nowMs;
+        slot->targetCount = count;
+        memcpy(slot->targets, targets, count * sizeof(targets[0]));
+        return slot;
+    }
+
+    Pending *find(uint32_t sequence) {
+        for (auto &p : pending) {
+            if (p.active && p.sequence == sequence) return &p;
+        }
+        return nullptr;
+    }
+
+    // Returns the batch the ACK belonged to, or nullptr if it is unknown/already closed
+    Pending *recordAck(const meshtastic_IrrigationAck &ack) {
+        Pending *p = find(ack.sequence);
+        if (!p) return nullptr;
+        for (pb_size_t i = 0; i < ack.entries_count; i++) {
+            const meshtastic_IrrigationAck_Entry &entry = ack.entries[i];
+            for (uint8_t t = 0; t < p->targetCount; t++) {
+                if (p->targets[t].node_id != entry.node_id) continue;
+                p->ackedMask |= (1u << t);
+                p->results[t] = entry.result;
+                bool ok = entry.result == meshtastic_IrrigationAck_Result_OK ||
+                          entry.result == meshtastic_IrrigationAck_Result_DUPLICATE;
+                if (ok) {
+                    p->failedMask &= ~(1u << t);
+                } else {
+                    p->failedMask |= (1u << t);
+                }
+            }
+        }
+        return p;
+    }
+
+    void close(Pending *p) {
+        if (p) p->active = false;
+    }
+
+    // For the first batch whose ACK timeout expired, fill `out` with the unacknowledged targets
+    // under the original sequence number. Batches out of retries are closed and returned via `expired`.
+    Pending *collectRetry(uint32_t nowMs, uint32_t timeoutMs, uint8_t maxRetries, meshtastic_IrrigationCommand &out,
+                          Pending **expired) {
+        if (expired) *expired = nullptr;
+        for (auto &p : pending) {
+            if (!p.active || p.complete() || nowMs - p.sentAtMs < timeoutMs) continue;
+            if (p.retries >= maxRetries) {
+                p.active = false;
+                if (expired) *expired = &p;
+                return nullptr;
+            }
+            memset(&out, 0, sizeof(out));
+            out.sequence = p.sequence;
+            for (uint8_t t = 0; t < p.targetCount && out.targets_count < MAX_TARGETS_PER_PACKET; t++) {
+                if (!(p.ackedMask & (1u << t))) out.targets[out.targets_count++] = p.targets[t];
+            }
+            p.retries++;
+            p.sentAtMs = nowMs;
+            return &p;
+        }
+        return nullptr;
+    }
+
+private:
+    Pending pending[MAX_PENDING] = {};
+};
+
+} // namespace Irrigation
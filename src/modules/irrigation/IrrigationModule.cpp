@@ -1,24 +1,51 @@
 #include "IrrigationModule.h"
+#include "AnalogSampler.h"
 #include "IrrigationTypes.h"
+#include "MeshService.h"
 #include "NodeDB.h"
 #include "PowerFSM.h"
+#include "RTC.h"
 #include "main.h"
-// #include "mesh/generated/meshtastic/irrigation.pb.h"  // Temporarily disabled until protobuf generation works
 #include <Arduino.h>
+#include <algorithm>
 
-// Temporary definition until protobuf is generated
-#ifndef meshtastic_PortNum_IRRIGATION_APP
-#define meshtastic_PortNum_IRRIGATION_APP 68
+IrrigationModule *irrigationModule;
+
+// Analog pressure transducer and soil moisture probe, wired by the variant. Both are sampled in the background by
+// analogSampler and scaled from a fraction of the ADC range using the calibration in nodeConfig.
+#ifndef IRRIGATION_ADC_MAX_COUNTS
+#define IRRIGATION_ADC_MAX_COUNTS 4095
+#endif
+#ifndef IRRIGATION_PRESSURE_FULL_SCALE_PSI
+#define IRRIGATION_PRESSURE_FULL_SCALE_PSI 100
+#endif
+#ifndef IRRIGATION_ANALOG_SAMPLES
+#define IRRIGATION_ANALOG_SAMPLES 8
 #endif
 
-IrrigationModule *irrigationModule;
+#if defined(IRRIGATION_PRESSURE_PIN) || defined(IRRIGATION_MOISTURE_PIN)
+static int32_t readAnalogPin(void *pin) {
+    return analogRead((uint8_t)(uintptr_t)pin);
+}
 
-IrrigationModule::IrrigationModule() : SinglePortModule("Irrigation", (meshtastic_PortNum)68), concurrency::OSThread("Irrigation") {
+static int8_t addAnalogChannel(const char *name, uint8_t pin, uint32_t intervalMs) {
+    AnalogChannel::Config channel = {};
+    channel.name = name;
+    channel.intervalMs = intervalMs;
+    channel.oversample = IRRIGATION_ANALOG_SAMPLES;
+    channel.medianWindow = 5; // Solenoids and pump starts put spikes on long sensor cables
+    channel.emaAlpha = 0.3f;
+    channel.read = readAnalogPin;
+    channel.ctx = (void *)(uintptr_t)pin;
+    return analogSampler->addChannel(channel);
 }
+#endif
 
-bool IrrigationModule::wantPacket(const meshtastic_MeshPacket *p) {
-    // Accept packets for our port number
-    return p->decoded.portnum == meshtastic_PortNum_IRRIGATION_APP;
+IrrigationModule::IrrigationModule()
+    : ProtobufModule("Irrigation", meshtastic_PortNum_IRRIGATION_APP, &meshtastic_IrrigationPacket_msg),
+      concurrency::OSThread("Irrigation") {
+    // Seed from the clock so a rebooted controller does not fall behind its receivers' replay windows
+    nextSequence = getTime() ? getTime() : random(1, INT32_MAX);
 }
 
 void IrrigationModule::setup() {
@@ -30,6 +57,24 @@ void IrrigationModule::setup() {
         performAutoDetection();
     }
 
+    // Analog inputs come from the variant pin map, so they count whatever type was configured
+    if (!hasPressureSensor) {
+        hasPressureSensor = detectPressureSensor();
+    }
+    if (!hasMoistureSensor) {
+        hasMoistureSensor = detectMoistureSensor();
+    }
+
+    // Authority checks go through the field hierarchy
+    rebuildLocalHierarchy();
+
+    // Controllers keep the water balance of their zone, as reference grass until a crop is configured
+    weather.setLocation(nodeConfig.latitude, nodeConfig.elevationM);
+    weather.attachScheduler(&scheduler);
+    if (nodeConfig.isController()) {
+        weather.addZone(nodeConfig.zoneId, ET::CROP_REFERENCE_GRASS, 1);
+    }
+
     // Set initial state
     setState(Irrigation::IDLE);
 
@@ -41,10 +86,19 @@ void IrrigationModule::setup() {
 
 void IrrigationModule::setupRoleBehavior() {
     switch (nodeConfig.type) {
-        case Irrigation::WATER_LEVEL_SENSOR:
-            // Report water level every 5 minutes
-            sensorIntervalMs = 300000;
+        case Irrigation::WATER_LEVEL_SENSOR: {
+            // Sample every 10 seconds; the pipeline decides when a report is worth the airtime
+            sensorIntervalMs = 10000;
+            SensorPipeline::PipelineConfig levelCfg;
+            levelCfg.deadband = 0.05f;        // ft
+            levelCfg.maxRatePerMin = 0.1f;    // ft/min, catches gate events early
+            levelCfg.heartbeatMs = 1800000;   // Still report every 30 minutes when quiet
+            levelSensor.configure(levelCfg);
+            if (!hasLevelSensor) {
+                hasLevelSensor = detectLevelSensor();
+            }
             break;
+        }
 
         case Irrigation::SOIL_MOISTURE_SENSOR:
             // Report moisture every 15 minutes
@@ -70,6 +124,11 @@ void IrrigationModule::setupRoleBehavior() {
             sensorIntervalMs = 60000; // 1 minute default
             break;
     }
+
+    // Thresholds set on the console outlive reboots and role changes; the role only decides them until then
+    if (nodeConfig.hasLevelThresholds) {
+        levelSensor.setThresholds(nodeConfig.levelAlertFt, nodeConfig.levelCriticalFt);
+    }
 }
 
 int32_t IrrigationModule::runOnce() {
@@ -86,10 +145,17 @@ int32_t IrrigationModule::runOnce() {
         lastSensorUpdate = now;
     }
 
-    // Send status reports periodically (every 5 minutes)
-    if (now - lastStatusReport >= 300000) {
+    // Retry only the targets of our own batches that have not acknowledged yet
+    checkOutstandingBatches();
+
+    updateWaterBalance();
+
+    // Controllers and actuators report their state every 5 minutes. Sensors report from updateSensors() on their own
+    // cadence, the level sensor only on change and its heartbeat.
+    if (statusReportRequested || (!nodeConfig.isSensor() && now - lastStatusReport >= STATUS_REPORT_INTERVAL_MS)) {
         sendStatusReport();
         lastStatusReport = now;
+        statusReportRequested = false;
     }
 
     // Update display if needed
@@ -98,24 +164,28 @@ int32_t IrrigationModule::runOnce() {
     return sensorIntervalMs; // Return next run time
 }
 
-ProcessMessage IrrigationModule::handleReceived(const meshtastic_MeshPacket &mp) {
-    // Only handle irrigation messages
-    if (mp.decoded.portnum != meshtastic_PortNum_IRRIGATION_APP) {
-        return ProcessMessage::CONTINUE;
+bool IrrigationModule::handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_IrrigationPacket *p) {
+    if (!p) {
+        return false;
     }
 
-    // Check if we can accept commands from this node
-    if (!canAcceptCommand(mp.from, mp)) {
-        LOG_WARN("Rejected command from node 0x%x (no authority)", mp.from);
-        return ProcessMessage::STOP;
+    switch (p->which_payload_variant) {
+        case meshtastic_IrrigationPacket_command_tag:
+            processCommand(mp, p->payload_variant.command);
+            break;
+        case meshtastic_IrrigationPacket_ack_tag:
+            handleAck(mp, p->payload_variant.ack);
+            break;
+        case meshtastic_IrrigationPacket_report_tag:
+            LOG_DEBUG("Irrigation report from 0x%x: zone %u, valve %u%%, level %.2f", mp.from,
+                      p->payload_variant.report.zone_id, p->payload_variant.report.valve_position,
+                      p->payload_variant.report.water_level);
+            break;
+        default:
+            LOG_WARN("Unknown irrigation payload %d from 0x%x", p->which_payload_variant, mp.from);
+            break;
     }
-
-    // For now, just log the message - protobuf decoding disabled
-    LOG_INFO("Received irrigation message from 0x%x, size: %d", mp.from, mp.decoded.payload.size);
-
-    // TODO: Process irrigation commands when protobuf is available
-    // processCommand(mp);
-    return ProcessMessage::STOP;
+    return true;
 }
 
 void IrrigationModule::setNodeType(Irrigation::NodeType type) {
@@ -134,29 +204,199 @@ void IrrigationModule::setState(Irrigation::IrrigationState newState) {
     }
 }
 
-bool IrrigationModule::canAcceptCommand(uint32_t sourceNode, const meshtastic_MeshPacket &packet) {
-    // Controllers can command their children
-    if (nodeConfig.isController()) {
-        return nodeConfig.isChild(sourceNode);
+bool IrrigationModule::canAcceptCommand(uint32_t sourceNode, uint32_t targetNode) const {
+    // Commands typed on our own console/phone are always trusted
+    if (sourceNode == nodeDB->getNodeNum()) {
+        return true;
     }
+    return hierarchy.hasAuthority(sourceNode, targetNode);
+}
 
-    // Headgate controller can command anything
+void IrrigationModule::rebuildLocalHierarchy() {
+    // Minimal hierarchy from our own config: one zone controlled by our parent, containing us and
+    // our children. Replaced wholesale when a farm configuration is loaded into getFieldHierarchy().
+    NodeNum me = nodeDB->getNodeNum();
+    hierarchy.clear();
+
+    localField = GateMesh::FieldHierarchy::Field();
+    localField.id = "local";
+    localField.parent_farm = nullptr;
+    hierarchy.addField(&localField);
+
+    localZone = GateMesh::FieldHierarchy::Zone();
+    localZone.id = "zone_" + std::to_string(nodeConfig.zoneId);
+    localZone.parent_field = &localField;
+    localZone.controller_node = nodeConfig.isController() ? me : nodeConfig.parentNode;
+    hierarchy.addZone(localField.id, &localZone);
+    hierarchy.assignNodeToZone(me, localZone.id);
+    for (uint8_t i = 0; i < nodeConfig.childCount; i++) {
+        hierarchy.assignNodeToZone(nodeConfig.childNodes[i], localZone.id);
+    }
+
+    // Our parent controls our zone and field, and no more: farm-wide authority comes only from a loaded farm
+    // configuration. The one piece of infrastructure we can vouch for is our own headgate.
+    if (nodeConfig.parentNode && nodeConfig.type != Irrigation::HEADGATE_CONTROLLER) {
+        localField.controller_node = nodeConfig.parentNode;
+    }
     if (nodeConfig.type == Irrigation::HEADGATE_CONTROLLER) {
-        return true;
+        localHeadgate = GateMesh::FieldHierarchy::Infrastructure();
+        localHeadgate.type = GateMesh::FieldHierarchy::Infrastructure::HEADGATE;
+        localHeadgate.id = "local";
+        localHeadgate.node_ids.push_back(me);
+        hierarchy.addInfrastructure(&localHeadgate);
     }
+}
 
-    // Parent can command children
-    if (nodeConfig.parentNode == sourceNode) {
-        return true;
+void IrrigationModule::processCommand(const meshtastic_MeshPacket &packet, const meshtastic_IrrigationCommand &command) {
+    NodeNum me = nodeDB->getNodeNum();
+    NodeNum source = getFrom(&packet);
+
+    // Only the targets addressed to us are ours; everybody else in the batch answers for themselves
+    bool addressed = false;
+    for (pb_size_t i = 0; i < command.targets_count; i++) {
+        if (command.targets[i].node_id == me) {
+            addressed = true;
+            break;
+        }
+    }
+    if (!addressed) {
+        return;
     }
 
-    return false;
+    meshtastic_IrrigationPacket reply = meshtastic_IrrigationPacket_init_zero;
+    reply.which_payload_variant = meshtastic_IrrigationPacket_ack_tag;
+    meshtastic_IrrigationAck &ack = reply.payload_variant.ack;
+    ack.sequence = command.sequence;
+
+    bool authorized = canAcceptCommand(source, me);
+    bool fresh = authorized && seenSequences.accept(source, command.sequence);
+    for (pb_size_t i = 0; i < command.targets_count && ack.entries_count < Irrigation::MAX_TARGETS_PER_BATCH; i++) {
+        const meshtastic_IrrigationCommand_Target &target = command.targets[i];
+        if (target.node_id != me) {
+            continue;
+        }
+        meshtastic_IrrigationAck_Entry &entry = ack.entries[ack.entries_count++];
+        entry.node_id = me;
+        if (!authorized) {
+            entry.result = meshtastic_IrrigationAck_Result_NO_AUTHORITY;
+        } else if (!fresh) {
+            // Retry of a batch we already executed: answer again, do not actuate twice
+            entry.result = meshtastic_IrrigationAck_Result_DUPLICATE;
+        } else {
+            entry.result = executeTarget(target);
+        }
+        entry.position_percent = valvePosition;
+    }
+
+    if (!authorized) {
+        LOG_WARN("Rejected command seq %u from node 0x%x (no authority)", command.sequence, source);
+    } else {
+        LOG_INFO("Irrigation command seq %u from 0x%x: %d target(s)%s", command.sequence, source, ack.entries_count,
+                 fresh ? "" : " (duplicate)");
+    }
+
+    // One ACK for all our targets in the batch
+    if (source != me) {
+        sendPacket(reply, source);
+    }
 }
 
-void IrrigationModule::processCommand(const meshtastic_MeshPacket &packet) {
-    // TODO: Decode and process irrigation commands
-    // This will depend on the protobuf definitions
-    LOG_INFO("Processing irrigation command from 0x%x", packet.from);
+meshtastic_IrrigationAck_Result IrrigationModule::executeTarget(const meshtastic_IrrigationCommand_Target &target) {
+    bool canActuate = nodeConfig.isActuator() || nodeConfig.hasCapability(Irrigation::CAN_ACTUATE);
+    switch (target.action) {
+        case meshtastic_IrrigationCommand_Action_SET_VALVE:
+        case meshtastic_IrrigationCommand_Action_CLOSE_VALVE: {
+            if (!canActuate) {
+                return meshtastic_IrrigationAck_Result_NOT_CAPABLE;
+            }
+            uint8_t position = target.action == meshtastic_IrrigationCommand_Action_CLOSE_VALVE
+                                   ? 0
+                                   : static_cast<uint8_t>(target.position_percent > 100 ? 100 : target.position_percent);
+            handleValveCommand(position, target.duration_s * 1000);
+            setState(position > 0 ? Irrigation::IRRIGATING : Irrigation::IDLE);
+            return meshtastic_IrrigationAck_Result_OK;
+        }
+        case meshtastic_IrrigationCommand_Action_START_PUMP:
+        case meshtastic_IrrigationCommand_Action_STOP_PUMP:
+            if (!canActuate) {
+                return meshtastic_IrrigationAck_Result_NOT_CAPABLE;
+            }
+            handlePumpCommand(target.action == meshtastic_IrrigationCommand_Action_START_PUMP);
+            return meshtastic_IrrigationAck_Result_OK;
+        case meshtastic_IrrigationCommand_Action_EMERGENCY_STOP:
+            handleValveCommand(0, 0);
+            handlePumpCommand(false);
+            setState(Irrigation::EMERGENCY_STOP);
+            return meshtastic_IrrigationAck_Result_OK;
+        case meshtastic_IrrigationCommand_Action_STATUS_REQUEST:
+            // Answered from runOnce(), once however many targets in the batch asked
+            statusReportRequested = true;
+            setIntervalFromNow(0);
+            return meshtastic_IrrigationAck_Result_OK;
+        default:
+            return meshtastic_IrrigationAck_Result_FAILED;
+    }
+}
+
+uint8_t IrrigationModule::sendCommandBatch(const meshtastic_IrrigationCommand_Target *targets, uint8_t count) {
+    uint8_t packets = 0;
+    for (uint8_t offset = 0; offset < count; offset += Irrigation::MAX_TARGETS_PER_PACKET) {
+        uint8_t chunk = count - offset;
+        if (chunk > Irrigation::MAX_TARGETS_PER_PACKET) {
+            chunk = Irrigation::MAX_TARGETS_PER_PACKET;
+        }
+
+        meshtastic_IrrigationPacket packet = meshtastic_IrrigationPacket_init_zero;
+        packet.which_payload_variant = meshtastic_IrrigationPacket_command_tag;
+        meshtastic_IrrigationCommand &command = packet.payload_variant.command;
+        command.sequence = nextSequence++;
+        command.targets_count = chunk;
+        memcpy(command.targets, targets + offset, chunk * sizeof(targets[0]));
+
+        outstanding.track(command.sequence, command.targets, chunk, millis());
+        sendPacket(packet, NODENUM_BROADCAST);
+        LOG_INFO("Sent irrigation batch seq %u with %d target(s)", command.sequence, chunk);
+        packets++;
+    }
+    return packets;
+}
+
+void IrrigationModule::handleAck(const meshtastic_MeshPacket &mp, const meshtastic_IrrigationAck &ack) {
+    Irrigation::BatchTracker::Pending *batch = outstanding.recordAck(ack);
+    if (!batch) {
+        LOG_DEBUG("Irrigation ACK seq %u from 0x%x for unknown batch", ack.sequence, mp.from);
+        return;
+    }
+    if (batch->complete()) {
+        LOG_INFO("Irrigation batch seq %u complete: %d/%d ok", batch->sequence, batch->targetCount - batch->failedCount(),
+                 batch->targetCount);
+        outstanding.close(batch);
+    }
+}
+
+void IrrigationModule::checkOutstandingBatches() {
+    meshtastic_IrrigationPacket packet = meshtastic_IrrigationPacket_init_zero;
+    Irrigation::BatchTracker::Pending *expired = nullptr;
+    Irrigation::BatchTracker::Pending *retry =
+        outstanding.collectRetry(millis(), ACK_TIMEOUT_MS, MAX_BATCH_RETRIES, packet.payload_variant.command, &expired);
+    if (expired) {
+        LOG_WARN("Irrigation batch seq %u gave up: %d/%d acknowledged", expired->sequence, expired->ackedCount(),
+                 expired->targetCount);
+    }
+    if (retry) {
+        // Same sequence number, so nodes that only lost their ACK answer DUPLICATE without actuating again
+        packet.which_payload_variant = meshtastic_IrrigationPacket_command_tag;
+        LOG_INFO("Retrying irrigation batch seq %u for %d target(s)", retry->sequence,
+                 packet.payload_variant.command.targets_count);
+        sendPacket(packet, NODENUM_BROADCAST);
+    }
+}
+
+void IrrigationModule::sendPacket(meshtastic_IrrigationPacket &packet, NodeNum dest) {
+    meshtastic_MeshPacket *p = allocDataProtobuf(packet);
+    p->to = dest;
+    p->priority = meshtastic_MeshPacket_Priority_RELIABLE;
+    service->sendToMesh(p);
 }
 
 void IrrigationModule::updateSensors() {
@@ -178,13 +418,47 @@ void IrrigationModule::updateSensors() {
     }
 
     if (hasLevelSensor) {
-        currentWaterLevel = readWaterLevel();
+        float level = readWaterLevel();
+        if (level >= 0) {
+            currentWaterLevel = level;
+        }
+        // Threshold crossings go out right away; otherwise only on deadband/rate/heartbeat
+        if (levelSensor.reportDue()) {
+            sendLevelReport();
+        }
+        if (nodeConfig.type == Irrigation::WATER_LEVEL_SENSOR) {
+            return;
+        }
     }
 
     // Send sensor data
     sendSensorData();
 }
 
+void IrrigationModule::updateWaterBalance() {
+    // Hours and days follow the wall clock, so nothing is booked before it is set or a weather reading came in
+    uint32_t now = getValidTime(RTCQualityDevice);
+    if (!now || !hasWeatherReadings) {
+        return;
+    }
+    uint32_t hour = now / 3600;
+    if (weatherHour == 0 || hour < weatherHour || hour - weatherHour > 24) {
+        // First valid time, or the clock jumped: start booking from this hour
+        time_t t = now;
+        weather.setDayOfYear(gmtime(&t)->tm_yday + 1);
+        weatherHour = hour;
+        return;
+    }
+    while (weatherHour < hour) {
+        weatherHour++;
+        weather.advanceHour();
+        if (weatherHour % 24 == 0) {
+            weather.endOfDay();
+            LOG_INFO("Reference ET %.2f in for the day", weather.getDailyET());
+        }
+    }
+}
+
 void IrrigationModule::controlActuators() {
     if (!nodeConfig.isActuator() && !nodeConfig.hasCapability(Irrigation::CAN_ACTUATE)) {
         return;
@@ -276,17 +550,103 @@ void IrrigationModule::handleConsoleCommand(const char* cmd) {
         LOG_INFO("  State: %s\n", Irrigation::getStateName(currentState));
         LOG_INFO("  Parent: 0x%x\n", nodeConfig.parentNode);
         LOG_INFO("  Children: %d nodes\n", nodeConfig.childCount);
+        if (hasLevelSensor) {
+            LOG_INFO("  Level: %.2f ft (raw %.2f, %.3f ft/min, band %d)\n", levelSensor.getFilteredLevel(),
+                     levelSensor.getRawLevel(), levelSensor.getRatePerMin(), levelSensor.getBand());
+        }
+        if (hasWeatherReadings) {
+            LOG_INFO("  ET today: %.2f in, yesterday %.2f in\n", weather.calculateET(), weather.getDailyET());
+        }
+    }
+    else if (strncmp(cmd, "close ", 6) == 0) {
+        // close <node> [node...]: one batched CLOSE_VALVE for every listed node
+        meshtastic_IrrigationCommand_Target targets[Irrigation::MAX_TARGETS_PER_BATCH] = {};
+        uint8_t count = 0;
+        const char *p = cmd + 6;
+        char *end = nullptr;
+        while (count < Irrigation::MAX_TARGETS_PER_BATCH) {
+            uint32_t node = strtoul(p, &end, 16);
+            if (end == p) {
+                break;
+            }
+            targets[count].node_id = node;
+            targets[count].action = meshtastic_IrrigationCommand_Action_CLOSE_VALVE;
+            count++;
+            p = end;
+        }
+        if (count) {
+            uint8_t packets = sendCommandBatch(targets, count);
+            LOG_INFO("Close sent to %d node(s) in %d packet(s)\n", count, packets);
+        } else {
+            LOG_ERROR("Usage: close <node hex> [node hex...]\n");
+        }
+    }
+    else if (strncmp(cmd, "weather ", 8) == 0) {
+        // weather <temp F> <humidity %> <wind mph> <rain in>: a reading from a station without a driver here
+        float temp = 0, humidity = 0, wind = 0, rain = 0;
+        if (sscanf(cmd + 8, "%f %f %f %f", &temp, &humidity, &wind, &rain) == 4) {
+            weather.updateLocalWeather(temp, humidity, wind, rain);
+            hasWeatherReadings = true;
+            LOG_INFO("Weather: %.1f F, %.0f%%, %.1f mph, %.2f in, ET today %.2f in\n", temp, humidity, wind, rain,
+                     weather.calculateET());
+        } else {
+            LOG_ERROR("Usage: weather <temp F> <humidity %%> <wind mph> <rain in>\n");
+        }
+    }
+    else if (strncmp(cmd, "level ", 6) == 0) {
+        // level <alert> <critical>: thresholds in ft, 0 disables
+        float alert = 0, critical = 0;
+        if (sscanf(cmd + 6, "%f %f", &alert, &critical) == 2) {
+            levelSensor.setThresholds(alert, critical);
+            nodeConfig.hasLevelThresholds = true;
+            nodeConfig.levelAlertFt = alert;
+            nodeConfig.levelCriticalFt = critical;
+            saveConfig();
+            LOG_INFO("Level thresholds: alert %.2f ft, critical %.2f ft\n", alert, critical);
+        } else {
+            LOG_ERROR("Usage: level <alert> <critical>\n");
+        }
     }
 }
 
+void IrrigationModule::fillReport(meshtastic_IrrigationReport &report) {
+    report.node_type = nodeConfig.type;
+    report.zone_id = nodeConfig.zoneId;
+    report.state = currentState;
+    report.valve_position = valvePosition;
+    report.pump_running = pumpRunning;
+    report.flow_rate = currentFlowRate;
+    report.pressure = currentPressure;
+    report.moisture = currentMoisture;
+    report.water_level = currentWaterLevel;
+}
+
 void IrrigationModule::sendStatusReport() {
-    // TODO: Send periodic status report
+    meshtastic_IrrigationPacket packet = meshtastic_IrrigationPacket_init_zero;
+    packet.which_payload_variant = meshtastic_IrrigationPacket_report_tag;
+    fillReport(packet.payload_variant.report);
     LOG_DEBUG("Sending irrigation status report");
+    sendPacket(packet, nodeConfig.parentNode ? nodeConfig.parentNode : NODENUM_BROADCAST);
 }
 
 void IrrigationModule::sendSensorData() {
-    // TODO: Send sensor data
-    LOG_DEBUG("Sending sensor data");
+    sendStatusReport();
+}
+
+void IrrigationModule::sendLevelReport() {
+    // Carry every filtered sample since the last report so the receiver still sees the trend
+    meshtastic_IrrigationPacket packet = meshtastic_IrrigationPacket_init_zero;
+    packet.which_payload_variant = meshtastic_IrrigationPacket_report_tag;
+    meshtastic_IrrigationReport &report = packet.payload_variant.report;
+    fillReport(report);
+    report.water_level = levelSensor.getFilteredLevel();
+    report.level_history_count = levelSensor.copyBatch(report.level_history, LEVEL_BATCH_MAX);
+    SensorPipeline::ReportReason reason = levelSensor.takeReport(millis());
+    report.report_reason = reason;
+    LOG_DEBUG("Level report (%s): %.2f ft, %.3f ft/min, %d samples",
+              SensorPipeline::getReportReasonName(reason), report.water_level,
+              levelSensor.getRatePerMin(), report.level_history_count);
+    sendPacket(packet, nodeConfig.parentNode ? nodeConfig.parentNode : NODENUM_BROADCAST);
 }
 
 void IrrigationModule::handleValveCommand(uint8_t position, uint32_t duration) {
@@ -307,16 +667,47 @@ void IrrigationModule::updateDisplay() {
 
 // Hardware detection stubs (to be implemented based on actual hardware)
 bool IrrigationModule::detectFlowSensor() { return false; }
-bool IrrigationModule::detectPressureSensor() { return false; }
-bool IrrigationModule::detectMoistureSensor() { return false; }
+
+bool IrrigationModule::detectPressureSensor() {
+#ifdef IRRIGATION_PRESSURE_PIN
+    if (pressureChannel < 0) {
+        pressureChannel = addAnalogChannel("pressure", IRRIGATION_PRESSURE_PIN, 2000);
+    }
+#endif
+    return pressureChannel >= 0;
+}
+
+bool IrrigationModule::detectMoistureSensor() {
+#ifdef IRRIGATION_MOISTURE_PIN
+    if (moistureChannel < 0) {
+        moistureChannel = addAnalogChannel("moisture", IRRIGATION_MOISTURE_PIN, 60000);
+    }
+#endif
+    return moistureChannel >= 0;
+}
+
 bool IrrigationModule::detectMotorControl() { return false; }
-bool IrrigationModule::detectLevelSensor() { return false; }
+bool IrrigationModule::detectLevelSensor() { return levelSensor.init(); }
 bool IrrigationModule::detectWeatherSensors() { return false; }
 
 float IrrigationModule::readFlowRate() { return 0.0; }
-float IrrigationModule::readPressure() { return 0.0; }
-float IrrigationModule::readMoisture() { return 0.0; }
-float IrrigationModule::readWaterLevel() { return 0.0; }
+
+float IrrigationModule::readPressure() {
+    float fraction = analogSampler->read(pressureChannel) / IRRIGATION_ADC_MAX_COUNTS;
+    return fraction * IRRIGATION_PRESSURE_FULL_SCALE_PSI + nodeConfig.pressureOffset;
+}
+
+float IrrigationModule::readMoisture() {
+    // Dry and wet calibration points are percent of the ADC range; capacitive probes read lower when wet, so max < min works
+    float percent = analogSampler->read(moistureChannel) * 100.0f / IRRIGATION_ADC_MAX_COUNTS;
+    float span = nodeConfig.moistureMax - nodeConfig.moistureMin;
+    if (span == 0) {
+        return 0.0;
+    }
+    return std::max(0.0f, std::min(100.0f, (percent - nodeConfig.moistureMin) * 100.0f / span));
+}
+
+float IrrigationModule::readWaterLevel() { return levelSensor.readLevel(); }
 void IrrigationModule::setValvePosition(uint8_t position) {}
 void IrrigationModule::setPumpState(bool enable) {}
 
@@ -1,17 +1,21 @@
 #pragma once
 
-#include "SinglePortModule.h"
+#include "ProtobufModule.h"
+#include "CommandBatch.h"
 #include "IrrigationNode.h"
 #include "IrrigationTypes.h"
 #include "concurrency/OSThread.h"
+#include "mesh/generated/meshtastic/irrigation.pb.h"
+#include "modules/field/FieldHierarchy.h"
+#include "modules/scheduling/IrrigationScheduler.h"
+#include "modules/sensors/WaterLevelSensor.h"
+#include "modules/weather/WeatherIntegration.h"
 
-class IrrigationModule : public SinglePortModule, private concurrency::OSThread {
+class IrrigationModule : public ProtobufModule<meshtastic_IrrigationPacket>, private concurrency::OSThread {
 public:
     IrrigationModule();
 
     // Module interface
-    bool wantPacket(const meshtastic_MeshPacket *p) override;
-    ProcessMessage handleReceived(const meshtastic_MeshPacket &mp) override;
     int32_t runOnce() override;
 
     // Console command handler
@@ -27,8 +31,18 @@ public:
     void setState(Irrigation::IrrigationState newState);
 
     // Command processing
-    bool canAcceptCommand(uint32_t sourceNode, const meshtastic_MeshPacket &packet);
-    void processCommand(const meshtastic_MeshPacket &packet);
+    bool canAcceptCommand(uint32_t sourceNode, uint32_t targetNode) const;
+    void processCommand(const meshtastic_MeshPacket &packet, const meshtastic_IrrigationCommand &command);
+
+    // Send one command batch to many nodes; split into as few packets as fit. Returns packets sent.
+    uint8_t sendCommandBatch(const meshtastic_IrrigationCommand_Target *targets, uint8_t count);
+
+    // Authority source. Defaults to a single zone built from nodeConfig; a farm configuration can replace it.
+    GateMesh::FieldHierarchy &getFieldHierarchy() { return hierarchy; }
+    void rebuildLocalHierarchy();
+
+protected:
+    bool handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_IrrigationPacket *p) override;
 
 private:
     Irrigation::IrrigationState currentState = Irrigation::OFFLINE;
@@ -36,6 +50,8 @@ private:
     // Timing
     uint32_t lastSensorUpdate = 0;
     uint32_t lastStatusReport = 0;
+    bool statusReportRequested = false; // A STATUS_REQUEST came in, answer on the next run
+    static constexpr uint32_t STATUS_REPORT_INTERVAL_MS = 300000;
     uint32_t sensorIntervalMs = 60000; // 1 minute default
 
     // Hardware detection results
@@ -46,20 +62,52 @@ private:
     bool hasLevelSensor = false;
     bool hasWeatherSensors = false;
 
+    // analogSampler channels of the analog sensors, -1 if the variant has none
+    int8_t pressureChannel = -1;
+    int8_t moistureChannel = -1;
+
     // Sensor values
     float currentFlowRate = 0.0;
     float currentPressure = 0.0;
     float currentMoisture = 0.0;
     float currentWaterLevel = 0.0;
 
+    // Level sensing runs through the filter pipeline and reports on change, not on a timer
+    WaterLevelSensor levelSensor;
+    static constexpr uint8_t LEVEL_BATCH_MAX = 8;
+
+    // Reference ET from local weather, booked into our zone's water balance every hour. Run times land in scheduler.
+    WeatherIntegration weather;
+    IrrigationScheduler scheduler;
+    bool hasWeatherReadings = false;
+    uint32_t weatherHour = 0; // Last hour since 1970 booked into the balance, 0 until the clock is valid
+
     // Actuator states
     bool valveOpen = false;
     uint8_t valvePosition = 0; // 0-100%
     bool pumpRunning = false;
 
+    // Command path state
+    GateMesh::FieldHierarchy hierarchy;
+    GateMesh::FieldHierarchy::Field localField;
+    GateMesh::FieldHierarchy::Zone localZone;
+    GateMesh::FieldHierarchy::Infrastructure localHeadgate;
+    Irrigation::SequenceWindow seenSequences;
+    Irrigation::BatchTracker outstanding;
+    uint32_t nextSequence = 0;
+    static constexpr uint32_t ACK_TIMEOUT_MS = 15000;
+    static constexpr uint8_t MAX_BATCH_RETRIES = 2;
+
+    meshtastic_IrrigationAck_Result executeTarget(const meshtastic_IrrigationCommand_Target &target);
+    void handleAck(const meshtastic_MeshPacket &mp, const meshtastic_IrrigationAck &ack);
+    void checkOutstandingBatches();
+    void sendPacket(meshtastic_IrrigationPacket &packet, NodeNum dest);
+
     // Helper methods
+    void fillReport(meshtastic_IrrigationReport &report);
     void sendStatusReport();
     void sendSensorData();
+    void sendLevelReport();
     void handleValveCommand(uint8_t position, uint32_t duration);
     void handlePumpCommand(bool enable);
     void updateDisplay();
@@ -67,6 +115,7 @@ private:
 
     // Core functionality
     void updateSensors();
+    void updateWaterBalance();
     void controlActuators();
     void performAutoDetection();
 
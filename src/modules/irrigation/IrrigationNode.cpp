@@ -1,45 +1,97 @@
 #include "IrrigationNode.h"
+#include "FSCommon.h"
 #include "IrrigationTypes.h"
+#include "NodeDB.h"
+#include "SPILock.h"
+#ifdef ARCH_ESP32
 #include <Preferences.h>
+#endif
 
 IrrigationNodeConfig nodeConfig;
 
-void IrrigationNodeConfig::save() {
-    Preferences prefs;
-    prefs.begin("irrigation", false);
-
-    prefs.putUChar("type", static_cast<uint8_t>(type));
-    prefs.putUInt("zoneId", zoneId);
-    prefs.putString("location", locationName);
-    prefs.putDouble("latitude", latitude);
-    prefs.putDouble("longitude", longitude);
-    prefs.putUShort("elevation", elevationM);
-    prefs.putUInt("parentNode", parentNode);
+static const char *irrigationConfigFileName = "/prefs/irrigation.proto";
+
+// Bump when fields are added to meshtastic_IrrigationNodeConfig that need a non-zero default
+static constexpr uint32_t CURRENT_VERSION = 2;
+
+void IrrigationNodeConfig::toProto(meshtastic_IrrigationNodeConfig &out) const {
+    out = meshtastic_IrrigationNodeConfig_init_zero;
+    out.version = CURRENT_VERSION;
+    out.type = static_cast<uint32_t>(type);
+    out.zone_id = zoneId;
+    strlcpy(out.location_name, locationName, sizeof(out.location_name));
+    out.latitude = latitude;
+    out.longitude = longitude;
+    out.elevation_m = elevationM;
+    out.parent_node = parentNode;
+    out.child_nodes_count = childCount;
+    memcpy(out.child_nodes, childNodes, childCount * sizeof(childNodes[0]));
+    out.capabilities = capabilities;
+    out.flow_calibration = flowCalibration;
+    out.pressure_offset = pressureOffset;
+    out.moisture_min = moistureMin;
+    out.moisture_max = moistureMax;
+    out.max_flow_gpm = maxFlowGPM;
+    out.min_pressure_psi = minPressurePSI;
+    out.max_pressure_psi = maxPressurePSI;
+    out.valve_timeout_ms = valveTimeoutMs;
+    out.has_level_alert_ft = out.has_level_critical_ft = hasLevelThresholds;
+    out.level_alert_ft = levelAlertFt;
+    out.level_critical_ft = levelCriticalFt;
+}
 
-    // Save child nodes array
-    for (int i = 0; i < 8; i++) {
-        char key[16];
-        snprintf(key, sizeof(key), "child%d", i);
-        prefs.putUInt(key, childNodes[i]);
-    }
-    prefs.putUChar("childCount", childCount);
-
-    prefs.putUInt("capabilities", capabilities);
-    prefs.putFloat("flowCal", flowCalibration);
-    prefs.putFloat("pressOff", pressureOffset);
-    prefs.putFloat("moistMin", moistureMin);
-    prefs.putFloat("moistMax", moistureMax);
-    prefs.putUShort("maxFlow", maxFlowGPM);
-    prefs.putUShort("minPress", minPressurePSI);
-    prefs.putUShort("maxPress", maxPressurePSI);
-    prefs.putULong("valveTimeout", valveTimeoutMs);
+void IrrigationNodeConfig::fromProto(const meshtastic_IrrigationNodeConfig &in) {
+    type = static_cast<Irrigation::NodeType>(in.type);
+    zoneId = in.zone_id;
+    strlcpy(locationName, in.location_name, sizeof(locationName));
+    latitude = in.latitude;
+    longitude = in.longitude;
+    elevationM = in.elevation_m;
+    parentNode = in.parent_node;
+    memset(childNodes, 0, sizeof(childNodes));
+    childCount = in.child_nodes_count > 8 ? 8 : in.child_nodes_count;
+    memcpy(childNodes, in.child_nodes, childCount * sizeof(childNodes[0]));
+    capabilities = in.capabilities;
+    flowCalibration = in.flow_calibration;
+    pressureOffset = in.pressure_offset;
+    moistureMin = in.moisture_min;
+    moistureMax = in.moisture_max;
+    maxFlowGPM = in.max_flow_gpm;
+    minPressurePSI = in.min_pressure_psi;
+    maxPressurePSI = in.max_pressure_psi;
+    valveTimeoutMs = in.valve_timeout_ms;
+    hasLevelThresholds = in.has_level_alert_ft && in.has_level_critical_ft;
+    levelAlertFt = in.level_alert_ft;
+    levelCriticalFt = in.level_critical_ft;
+}
 
-    prefs.end();
+bool IrrigationNodeConfig::save() {
+    // One encoded blob, written atomically, and timed for the log
+    uint32_t start = millis();
+    meshtastic_IrrigationNodeConfig file;
+    toProto(file);
+#ifdef FSCom
+    spiLock->lock();
+    FSCom.mkdir("/prefs");
+    spiLock->unlock();
+#endif
+    bool ok = nodeDB->saveProto(irrigationConfigFileName, meshtastic_IrrigationNodeConfig_size,
+                                &meshtastic_IrrigationNodeConfig_msg, &file, true);
+    LOG_INFO("Irrigation config %s in %u ms", ok ? "saved" : "save FAILED", millis() - start);
+    return ok;
 }
 
-void IrrigationNodeConfig::load() {
+#ifdef ARCH_ESP32
+// Firmware before the blob format kept one NVS key per setting. Read them once, then drop them.
+bool IrrigationNodeConfig::migrateFromNvs() {
     Preferences prefs;
-    prefs.begin("irrigation", true);
+    if (!prefs.begin("irrigation", true)) {
+        return false;
+    }
+    if (!prefs.isKey("type")) {
+        prefs.end();
+        return false;
+    }
 
     type = static_cast<Irrigation::NodeType>(prefs.getUChar("type", 0));
     zoneId = prefs.getUInt("zoneId", 0);
@@ -50,7 +102,6 @@ void IrrigationNodeConfig::load() {
     elevationM = prefs.getUShort("elevation", 0);
     parentNode = prefs.getUInt("parentNode", 0);
 
-    // Load child nodes array
     childCount = 0;
     for (int i = 0; i < 8; i++) {
         char key[16];
@@ -68,9 +119,43 @@ void IrrigationNodeConfig::load() {
     minPressurePSI = prefs.getUShort("minPress", 0);
     maxPressurePSI = prefs.getUShort("maxPress", 0);
     valveTimeoutMs = prefs.getULong("valveTimeout", 30000);
-
     prefs.end();
 
+    // Only drop the old keys once the blob is safely on flash. saveProto() can't see every failed write, so read it back.
+    meshtastic_IrrigationNodeConfig check = meshtastic_IrrigationNodeConfig_init_zero;
+    if (!save() ||
+        nodeDB->loadProto(irrigationConfigFileName, meshtastic_IrrigationNodeConfig_size, sizeof(check),
+                          &meshtastic_IrrigationNodeConfig_msg, &check) != LoadFileResult::LOAD_SUCCESS ||
+        check.version < 1 || check.type != static_cast<uint32_t>(type) || check.zone_id != zoneId) {
+        LOG_WARN("Irrigation config not on flash, keeping the NVS copy");
+        return true;
+    }
+    if (prefs.begin("irrigation", false)) {
+        prefs.clear();
+        prefs.end();
+    }
+    return true;
+}
+#endif
+
+void IrrigationNodeConfig::load() {
+    uint32_t start = millis();
+    meshtastic_IrrigationNodeConfig file = meshtastic_IrrigationNodeConfig_init_zero;
+    LoadFileResult result = nodeDB->loadProto(irrigationConfigFileName, meshtastic_IrrigationNodeConfig_size, sizeof(file),
+                                              &meshtastic_IrrigationNodeConfig_msg, &file);
+    if (result == LoadFileResult::LOAD_SUCCESS && file.version >= 1) {
+        fromProto(file);
+        LOG_INFO("Irrigation config loaded in %u ms", millis() - start);
+    }
+#ifdef ARCH_ESP32
+    else if (migrateFromNvs()) {
+        LOG_INFO("Irrigation config migrated from NVS in %u ms", millis() - start);
+    }
+#endif
+    else {
+        LOG_INFO("No irrigation config, using defaults");
+    }
+
     // If no type set, try auto-detection
     if (type == Irrigation::NodeType::UNDEFINED) {
         // TODO: Call auto-detection function
@@ -1,6 +1,7 @@
 #pragma once
 #include "IrrigationTypes.h"
 #include "configuration.h"
+#include "mesh/generated/meshtastic/irrigation.pb.h"
 
 class IrrigationNodeConfig {
 public:
@@ -34,9 +35,16 @@ public:
     uint16_t maxPressurePSI = 0;    // Max safe pressure
     uint32_t valveTimeoutMs = 30000; // Valve operation timeout
 
-    // Save/Load from NVS
-    void save();
+    // Water level alarm thresholds (ft) set from the console. Until then the role's defaults apply.
+    bool hasLevelThresholds = false;
+    float levelAlertFt = 0.0;
+    float levelCriticalFt = 0.0;
+
+    // Save/Load as one protobuf blob in /prefs. save() returns false if it could not be written.
+    bool save();
     void load();
+    void toProto(meshtastic_IrrigationNodeConfig &out) const;
+    void fromProto(const meshtastic_IrrigationNodeConfig &in);
     void setDefaults(Irrigation::NodeType type);
 
     // Utility functions
@@ -47,6 +55,11 @@ public:
     void addChild(uint32_t nodeId);
     void removeChild(uint32_t nodeId);
     bool isChild(uint32_t nodeId) const;
+
+private:
+#ifdef ARCH_ESP32
+    bool migrateFromNvs();
+#endif
 };
 
 extern IrrigationNodeConfig nodeConfig;
\ No newline at end of file
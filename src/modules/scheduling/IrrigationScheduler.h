@@ -20,11 +20,27 @@ public:
     }
     void checkSchedule(uint8_t currentHour, uint8_t currentMinute) {
         for (auto& entry : schedule) {
-            if (entry.enabled && entry.startHour == currentHour && entry.startMinute == currentMinute) {
+            if (entry.enabled && entry.durationMinutes > 0 && entry.startHour == currentHour &&
+                entry.startMinute == currentMinute) {
                 startIrrigation(entry);
             }
         }
     }
+    // Replace the run time of every entry for a zone, e.g. from the ET water balance.
+    // A duration of 0 keeps the entry but skips it until the zone needs water again.
+    void setZoneDuration(uint8_t zone, uint16_t durationMinutes) {
+        for (auto& entry : schedule) {
+            if (entry.zone == zone) {
+                entry.durationMinutes = durationMinutes;
+            }
+        }
+    }
+    uint16_t getZoneDuration(uint8_t zone) const {
+        for (const auto& entry : schedule) {
+            if (entry.zone == zone) return entry.durationMinutes;
+        }
+        return 0;
+    }
     void startIrrigation(ScheduleEntry& entry) {
         activeEntry = &entry;
         irrigationStartTime = millis();
@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Sampling pipeline shared by the slow-moving analog/I2C irrigation sensors.
+// Raw samples go into a fixed ring, get a median-of-N spike filter followed by an EMA,
+// and the filtered value drives report decisions instead of a fixed timer.
+namespace SensorPipeline {
+
+template <typename T, uint8_t N> class SampleRing {
+private:
+    T samples[N] = {};
+    uint32_t times[N] = {};
+    uint8_t head = 0;
+    uint8_t count = 0;
+public:
+    void push(T value, uint32_t timeMs) {
+        samples[head] = value;
+        times[head] = timeMs;
+        head = (head + 1) % N;
+        if (count < N) count++;
+    }
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+    uint8_t size() const { return count; }
+    bool full() const { return count == N; }
+    static constexpr uint8_t capacity() { return N; }
+    // 0 = newest, size()-1 = oldest
+    T at(uint8_t age) const { return samples[(head + N - 1 - age) % N]; }
+    uint32_t timeAt(uint8_t age) const { return times[(head + N - 1 - age) % N]; }
+    // Median of the newest `window` samples (window clamped to what we have)
+    T median(uint8_t window) const {
+        if (count == 0) return T();
+        if (window > count) window = count;
+        T scratch[N];
+        for (uint8_t i = 0; i < window; i++) scratch[i] = at(i);
+        std::nth_element(scratch, scratch + window / 2, scratch + window);
+        return scratch[window / 2];
+    }
+};
+
+// What changed since the last accepted report
+enum ReportReason : uint8_t {
+    REPORT_NONE = 0,
+    REPORT_FIRST = 1,       // Nothing sent yet
+    REPORT_DEADBAND = 2,    // Filtered value moved beyond the deadband
+    REPORT_THRESHOLD = 3,   // Alert/critical band entered or left
+    REPORT_RATE = 4,        // Rate of change exceeded the configured limit
+    REPORT_HEARTBEAT = 5    // Quiet for too long, send a keep-alive
+};
+
+// Alert bands; a threshold of 0 means "not configured" and never fires
+enum LevelBand : uint8_t {
+    BAND_NORMAL = 0,
+    BAND_ALERT = 1,
+    BAND_CRITICAL = 2
+};
+
+struct PipelineConfig {
+    uint8_t medianWindow = 5;           // Samples in the median spike filter
+    float emaAlpha = 0.3f;              // EMA weight of the newest median
+    float deadband = 0.05f;             // Min filtered change worth reporting
+    float alertLevel = 0.0f;            // Enter ALERT at or above this level
+    float criticalLevel = 0.0f;         // Enter CRITICAL at or above this level
+    float hysteresis = 0.02f;           // Band exit needs level < threshold - hysteresis
+    float maxRatePerMin = 0.0f;         // |d level / dt| that forces a report, 0 = off
+    uint32_t heartbeatMs = 3600000;     // Report at least this often, 0 = never
+};
+
+// Median + EMA filter with rate-of-change estimate and deadband/hysteresis reporting.
+// Feed it with addSample(); poll takeReport() to find out whether a packet is due.
+template <uint8_t N = 16> class LevelPipeline {
+private:
+    PipelineConfig cfg;
+    SampleRing<float, N> raw;
+    SampleRing<float, N> filteredHistory;
+    float filtered = 0.0f;
+    bool primed = false;
+    float ratePerMin = 0.0f;
+    LevelBand band = BAND_NORMAL;
+    LevelBand reportedBand = BAND_NORMAL;
+    float lastReported = 0.0f;
+    uint32_t lastReportMs = 0;
+    bool everReported = false;
+    bool rateLatched = false;
+    ReportReason pending = REPORT_NONE;
+    uint32_t samplesSinceReport = 0;
+
+    LevelBand classify(float level) const {
+        // Each band is entered at its threshold and left only below threshold - hysteresis
+        LevelBand next = BAND_NORMAL;
+        if (cfg.criticalLevel > 0) {
+            float exit = cfg.criticalLevel - cfg.hysteresis;
+            if (level >= cfg.criticalLevel || (band == BAND_CRITICAL && level >= exit)) return BAND_CRITICAL;
+        }
+        if (cfg.alertLevel > 0) {
+            float exit = cfg.alertLevel - cfg.hysteresis;
+            if (level >= cfg.alertLevel || (band >= BAND_ALERT && level >= exit)) next = BAND_ALERT;
+        }
+        return next;
+    }
+
+    void updateRate(uint32_t nowMs) {
+        // Slope between the newest filtered value and the oldest one in the history
+        uint8_t n = filteredHistory.size();
+        if (n < 2) {
+            ratePerMin = 0.0f;
+            return;
+        }
+        uint32_t dt = nowMs - filteredHistory.timeAt(n - 1);
+        if (dt == 0) return;
+        ratePerMin = (filteredHistory.at(0) - filteredHistory.at(n - 1)) * 60000.0f / dt;
+    }
+
+public:
+    LevelPipeline() = default;
+    explicit LevelPipeline(const PipelineConfig &config) : cfg(config) {}
+
+    void configure(const PipelineConfig &config) {
+        cfg = config;
+        if (cfg.medianWindow == 0) cfg.medianWindow = 1;
+        if (cfg.medianWindow > N) cfg.medianWindow = N;
+    }
+    const PipelineConfig &config() const { return cfg; }
+
+    // Push one raw reading. Returns the reason a report became due, if any.
+    ReportReason addSample(float value, uint32_t nowMs) {
+        if (std::isnan(value) || value < 0) return REPORT_NONE; // Failed read, keep old state
+        raw.push(value, nowMs);
+        float med = raw.median(cfg.medianWindow);
+        if (!primed) {
+            filtered = med;
+            primed = true;
+        } else {
+            filtered += cfg.emaAlpha * (med - filtered);
+        }
+        filteredHistory.push(filtered, nowMs);
+        updateRate(nowMs);
+        band = classify(filtered);
+        samplesSinceReport++;
+
+        ReportReason reason = REPORT_NONE;
+        if (!everReported) {
+            reason = REPORT_FIRST;
+        } else if (band != reportedBand) {
+            reason = REPORT_THRESHOLD;
+        } else if (cfg.maxRatePerMin > 0 && std::fabs(ratePerMin) >= cfg.maxRatePerMin && !rateLatched) {
+            // Fire once per excursion; re-arm after the slope settles below half the limit
+            reason = REPORT_RATE;
+            rateLatched = true;
+        } else if (std::fabs(filtered - lastReported) >= cfg.deadband) {
+            reason = REPORT_DEADBAND;
+        } else if (cfg.heartbeatMs && nowMs - lastReportMs >= cfg.heartbeatMs) {
+            reason = REPORT_HEARTBEAT;
+        }
+        if (rateLatched && std::fabs(ratePerMin) < cfg.maxRatePerMin / 2) rateLatched = false;
+
+        // Keep the most urgent reason if several arrive before the caller drains it
+        if (reason != REPORT_NONE && (pending == REPORT_NONE || reason == REPORT_THRESHOLD)) pending = reason;
+        return reason;
+    }
+
+    // Returns the pending report reason and marks the current value as reported
+    ReportReason takeReport(uint32_t nowMs) {
+        ReportReason reason = pending;
+        if (reason == REPORT_NONE) return reason;
+        pending = REPORT_NONE;
+        lastReported = filtered;
+        reportedBand = band;
+        lastReportMs = nowMs;
+        everReported = true;
+        samplesSinceReport = 0;
+        return reason;
+    }
+
+    bool reportDue() const { return pending != REPORT_NONE; }
+    bool isThresholdEvent() const { return pending == REPORT_THRESHOLD; }
+    float value() const { return filtered; }
+    float rate() const { return ratePerMin; }
+    LevelBand currentBand() const { return band; }
+    uint32_t pendingSamples() const { return samplesSinceReport; }
+
+    // Copy up to maxCount filtered values (newest first) so a report can carry
+    // the recent trend in one packet instead of one packet per sample
+    uint8_t copyBatch(float *out, uint8_t maxCount) const {
+        uint8_t n = filteredHistory.size();
+        if (n > maxCount) n = maxCount;
+        if (n > samplesSinceReport && everReported) n = samplesSinceReport;
+        for (uint8_t i = 0; i < n; i++) out[i] = filteredHistory.at(i);
+        return n;
+    }
+
+    void reset() {
+        raw.clear();
+        filteredHistory.clear();
+        primed = false;
+        ratePerMin = 0.0f;
+        band = reportedBand = BAND_NORMAL;
+        everReported = false;
+        rateLatched = false;
+        pending = REPORT_NONE;
+        samplesSinceReport = 0;
+    }
+};
+
+inline const char *getReportReasonName(ReportReason reason) {
+    switch (reason) {
+        case REPORT_FIRST: return "first";
+        case REPORT_DEADBAND: return "deadband";
+        case REPORT_THRESHOLD: return "threshold";
+        case REPORT_RATE: return "rate";
+        case REPORT_HEARTBEAT: return "heartbeat";
+        default: return "none";
+    }
+}
+
+} // namespace SensorPipeline
@@ -1,39 +1,69 @@
 #pragma once
 #include <Wire.h>
 #include "configuration.h"
+#include "I2CLock.h"
+#include "SensorPipeline.h"
 
 class WaterLevelSensor {
 private:
     static constexpr uint8_t SENSOR_ADDR = 0x77;  // Example I2C address
     static constexpr uint8_t CMD_READ_LEVEL = 0x01;
     float lastLevel = 0.0;
-    float alertLevel = 0.0;
-    float criticalLevel = 0.0;
     uint32_t lastReadTime = 0;
+    uint32_t readErrors = 0;
+    SensorPipeline::LevelPipeline<16> pipeline;
 public:
+    // Wire is started by main; calling begin() again here would reset the bus under the telemetry sensors
     bool init() {
-        Wire.begin(I2C_SDA, I2C_SCL);
-        // Optionally check sensor presence
+        concurrency::LockGuard guard(i2cLock(&Wire));
         Wire.beginTransmission(SENSOR_ADDR);
         if (Wire.endTransmission() != 0) return false;
         return true;
     }
-    float readLevel() {
+    // One I2C transaction, no filtering. Returns -1 on a failed read.
+    float readRaw() {
+        concurrency::LockGuard guard(i2cLock(&Wire));
         Wire.beginTransmission(SENSOR_ADDR);
         Wire.write(CMD_READ_LEVEL);
         Wire.endTransmission();
         Wire.requestFrom(SENSOR_ADDR, (uint8_t)2);
         if (Wire.available() < 2) return -1;
         uint16_t raw = Wire.read() << 8 | Wire.read();
-        lastLevel = raw * 0.01; // Example conversion
-        lastReadTime = millis();
-        return lastLevel;
+        return raw * 0.01; // Example conversion
     }
-    bool checkAlerts() {
-        if (lastLevel >= criticalLevel) {
-            // Trigger alert
-            return true;
+    // Sample the sensor into the pipeline and return the filtered level (-1 on read failure)
+    float readLevel() {
+        float raw = readRaw();
+        if (raw < 0) {
+            readErrors++;
+            return -1;
         }
-        return false;
+        addSample(raw, millis());
+        return pipeline.value();
+    }
+    // Feed a reading obtained elsewhere (shared ADC, trace replay) through the pipeline
+    SensorPipeline::ReportReason addSample(float level, uint32_t nowMs) {
+        lastLevel = level;
+        lastReadTime = nowMs;
+        return pipeline.addSample(level, nowMs);
+    }
+    void configure(const SensorPipeline::PipelineConfig &config) { pipeline.configure(config); }
+    void setThresholds(float alert, float critical) {
+        SensorPipeline::PipelineConfig cfg = pipeline.config();
+        cfg.alertLevel = alert;
+        cfg.criticalLevel = critical;
+        pipeline.configure(cfg);
+    }
+    // True while the filtered level sits in the critical band. Thresholds left at 0 never alert.
+    bool checkAlerts() {
+        return pipeline.currentBand() == SensorPipeline::BAND_CRITICAL;
     }
+    bool reportDue() const { return pipeline.reportDue(); }
+    SensorPipeline::ReportReason takeReport(uint32_t nowMs) { return pipeline.takeReport(nowMs); }
+    uint8_t copyBatch(float *out, uint8_t maxCount) const { return pipeline.copyBatch(out, maxCount); }
+    float getFilteredLevel() const { return pipeline.value(); }
+    float getRawLevel() const { return lastLevel; }
+    float getRatePerMin() const { return pipeline.rate(); }
+    SensorPipeline::LevelBand getBand() const { return pipeline.currentBand(); }
+    uint32_t getReadErrors() const { return readErrors; }
 };
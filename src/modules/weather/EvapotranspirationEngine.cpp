@@ -0,0 +1,229 @@
+#include "EvapotranspirationEngine.h"
+#include "EvapotranspirationTables.h"
+#include "modules/scheduling/IrrigationScheduler.h"
+#include <cmath>
+
+namespace ET {
+
+static constexpr float PI_F = 3.14159265f;
+static constexpr float SOLAR_CONSTANT = 0.0820f;  // MJ m-2 min-1
+static constexpr float STEFAN_BOLTZMANN = 4.903e-9f; // MJ K-4 m-2 day-1
+
+float saturationVaporPressure(float tempC) {
+    if (tempC <= SVP_TABLE_MIN_C || tempC >= SVP_TABLE_MAX_C) {
+        return saturationVaporPressureExact(tempC);
+    }
+    float pos = tempC - SVP_TABLE_MIN_C;
+    int i = static_cast<int>(pos);
+    float frac = pos - i;
+    return SVP_TABLE[i] + frac * (SVP_TABLE[i + 1] - SVP_TABLE[i]);
+}
+
+float saturationVaporPressureExact(float tempC) {
+    return 0.6108f * expf(17.27f * tempC / (tempC + 237.3f));
+}
+
+float extraterrestrialRadiation(float latitudeDeg, uint16_t dayOfYear) {
+    float row = (latitudeDeg - RA_TABLE_LAT_MIN) / RA_TABLE_LAT_STEP;
+    if (row < 0 || row > RA_TABLE_ROWS - 1) {
+        return extraterrestrialRadiationExact(latitudeDeg, dayOfYear);
+    }
+    int r = static_cast<int>(row);
+    if (r >= RA_TABLE_ROWS - 1) r = RA_TABLE_ROWS - 2;
+    float rowFrac = row - r;
+
+    // Columns are weekly starting at day 1 and wrap from late December back to January
+    float col = (dayOfYear - 1) * static_cast<float>(RA_TABLE_COLUMNS) / 365.0f;
+    int c = static_cast<int>(col);
+    float colFrac = col - c;
+    c %= RA_TABLE_COLUMNS;
+    int c2 = (c + 1) % RA_TABLE_COLUMNS;
+
+    float top = RA_TABLE[r][c] + colFrac * (RA_TABLE[r][c2] - RA_TABLE[r][c]);
+    float bottom = RA_TABLE[r + 1][c] + colFrac * (RA_TABLE[r + 1][c2] - RA_TABLE[r + 1][c]);
+    return (top + rowFrac * (bottom - top)) * 0.01f;
+}
+
+static float sunsetHourAngle(float phi, float declination) {
+    float x = -tanf(phi) * tanf(declination);
+    if (x > 1) x = 1;
+    if (x < -1) x = -1;
+    return acosf(x);
+}
+
+float extraterrestrialRadiationExact(float latitudeDeg, uint16_t dayOfYear) {
+    float phi = latitudeDeg * PI_F / 180.0f;
+    float dr = 1 + 0.033f * cosf(2 * PI_F * dayOfYear / 365);
+    float declination = 0.409f * sinf(2 * PI_F * dayOfYear / 365 - 1.39f);
+    float ws = sunsetHourAngle(phi, declination);
+    return 24 * 60 / PI_F * SOLAR_CONSTANT * dr *
+           (ws * sinf(phi) * sinf(declination) + cosf(phi) * cosf(declination) * sinf(ws));
+}
+
+float daylightHours(float latitudeDeg, uint16_t dayOfYear) {
+    float phi = latitudeDeg * PI_F / 180.0f;
+    float declination = 0.409f * sinf(2 * PI_F * dayOfYear / 365 - 1.39f);
+    return 24 / PI_F * sunsetHourAngle(phi, declination);
+}
+
+float windSpeedAt2m(float windMs, float measuredHeightM) {
+    if (measuredHeightM <= 2.0f) return windMs;
+    return windMs * 4.87f / logf(67.8f * measuredHeightM - 5.42f);
+}
+
+float hargreaves(const DailyWeather &weather, float ra) {
+    float tMean = (weather.tMaxC + weather.tMinC) / 2;
+    float range = weather.tMaxC - weather.tMinC;
+    if (range < 0) range = 0;
+    float et0 = 0.0023f * (tMean + 17.8f) * sqrtf(range) * 0.408f * ra;
+    return et0 > 0 ? et0 : 0;
+}
+
+float penmanMonteith(const DailyWeather &weather, const Site &site, uint16_t dayOfYear) {
+    float tMean = (weather.tMaxC + weather.tMinC) / 2;
+    float eMax = saturationVaporPressure(weather.tMaxC);
+    float eMin = saturationVaporPressure(weather.tMinC);
+    float es = (eMax + eMin) / 2;
+    float delta = 4098 * saturationVaporPressure(tMean) / ((tMean + 237.3f) * (tMean + 237.3f));
+
+    // Psychrometric constant from elevation (Eq. 7, 8)
+    float pressure = 101.3f * powf((293 - 0.0065f * site.elevationM) / 293, 5.26f);
+    float gamma = 0.000665f * pressure;
+
+    // Actual vapour pressure (Eq. 17, 19, or Tdew ~ Tmin as in Eq. 48)
+    float ea;
+    if (weather.rhMax >= 0 && weather.rhMin >= 0) {
+        ea = (eMin * weather.rhMax / 100 + eMax * weather.rhMin / 100) / 2;
+    } else if (weather.rhMean >= 0) {
+        ea = weather.rhMean / 100 * es;
+    } else {
+        ea = eMin;
+    }
+
+    float ra = extraterrestrialRadiation(site.latitudeDeg, dayOfYear);
+    float rso = (0.75f + 2e-5f * site.elevationM) * ra;
+    float rs;
+    if (weather.solarMJ >= 0) {
+        rs = weather.solarMJ;
+    } else if (weather.sunshineHours >= 0) {
+        rs = (0.25f + 0.5f * weather.sunshineHours / daylightHours(site.latitudeDeg, dayOfYear)) * ra;
+    } else {
+        float range = weather.tMaxC - weather.tMinC;
+        rs = site.krs * sqrtf(range > 0 ? range : 0) * ra;
+    }
+    if (rs > rso) rs = rso;
+
+    // Net radiation (Eq. 38, 39, 40); soil heat flux is ~0 for daily steps
+    float rns = 0.77f * rs;
+    float tMaxK = weather.tMaxC + 273.16f;
+    float tMinK = weather.tMinC + 273.16f;
+    float sigmaT4 = STEFAN_BOLTZMANN * (tMaxK * tMaxK * tMaxK * tMaxK + tMinK * tMinK * tMinK * tMinK) / 2;
+    float cloudiness = rso > 0 ? 1.35f * rs / rso - 0.35f : 0;
+    float rnl = sigmaT4 * (0.34f - 0.14f * sqrtf(ea > 0 ? ea : 0)) * cloudiness;
+    float rn = rns - rnl;
+
+    float u2 = weather.windMs;
+    float et0 = (0.408f * delta * rn + gamma * 900 / (tMean + 273) * u2 * (es - ea)) / (delta + gamma * (1 + 0.34f * u2));
+    return et0 > 0 ? et0 : 0;
+}
+
+// FAO-56 Table 12 Kc values with Table 11 stage lengths for semi-arid, spring-planted conditions.
+// Perennials (grass, alfalfa, pasture) repeat their curve, approximating the cutting/grazing cycle.
+static const KcCurve KC_CURVES[CROP_COUNT] = {
+    {"Reference Grass", 1.00f, 1.00f, 1.00f, 0, 0, 250, 0},
+    {"Alfalfa", 0.40f, 0.95f, 0.90f, 10, 30, 25, 10},
+    {"Corn", 0.30f, 1.20f, 0.60f, 30, 40, 50, 30},
+    {"Spring Wheat", 0.30f, 1.15f, 0.25f, 20, 25, 60, 30},
+    {"Potato", 0.50f, 1.15f, 0.75f, 25, 30, 45, 30},
+    {"Sugar Beet", 0.35f, 1.20f, 0.70f, 30, 45, 90, 15},
+    {"Dry Beans", 0.40f, 1.15f, 0.35f, 20, 30, 40, 20},
+    {"Pasture", 0.40f, 0.95f, 0.85f, 10, 20, 40, 10},
+};
+
+static bool isPerennial(CropType crop) {
+    return crop == CROP_REFERENCE_GRASS || crop == CROP_ALFALFA || crop == CROP_PASTURE;
+}
+
+const KcCurve &getKcCurve(CropType crop) {
+    return KC_CURVES[crop < CROP_COUNT ? crop : CROP_REFERENCE_GRASS];
+}
+
+float cropCoefficient(CropType crop, uint16_t daysAfterPlanting) {
+    const KcCurve &kc = getKcCurve(crop);
+    uint16_t endIni = kc.lengthIni;
+    uint16_t endDev = endIni + kc.lengthDev;
+    uint16_t endMid = endDev + kc.lengthMid;
+    uint16_t endLate = endMid + kc.lengthLate;
+    uint16_t d = daysAfterPlanting;
+    if (isPerennial(crop) && endLate > 0) {
+        d %= endLate;
+    }
+
+    if (d < endIni) return kc.kcIni;
+    if (d < endDev) return kc.kcIni + (kc.kcMid - kc.kcIni) * (d - endIni) / kc.lengthDev;
+    if (d < endMid) return kc.kcMid;
+    if (d < endLate) return kc.kcMid + (kc.kcEnd - kc.kcMid) * (d - endMid) / kc.lengthLate;
+    return kc.kcEnd;
+}
+
+uint16_t daysSince(uint16_t fromDayOfYear, uint16_t toDayOfYear) {
+    return (toDayOfYear + 365 - fromDayOfYear) % 365;
+}
+
+uint16_t ZoneBalance::irrigationMinutes() const {
+    if (!needsIrrigation() || applicationRateMmPerHour <= 0) return 0;
+    float grossMm = depletionMm / (efficiency > 0 ? efficiency : 1.0f);
+    float minutes = grossMm / applicationRateMmPerHour * 60.0f;
+    return minutes > 65535 ? 65535 : static_cast<uint16_t>(minutes + 0.5f);
+}
+
+void ZoneBalance::advance(float et0MmPerDay, float rainMm, float irrigationMm, uint16_t dayOfYear, float hours) {
+    float kc = cropCoefficient(crop, daysSince(plantingDay, dayOfYear));
+    lastEtcMm = kc * et0MmPerDay * hours / 24.0f;
+    // Eq. 85 without runoff/capillary rise; water beyond field capacity percolates
+    depletionMm += lastEtcMm - rainMm - irrigationMm;
+    float taw = totalAvailableWater();
+    if (depletionMm < 0) depletionMm = 0;
+    if (depletionMm > taw) depletionMm = taw;
+}
+
+ZoneBalance *WaterBalance::addZone(uint8_t zoneId, CropType crop, uint16_t plantingDay) {
+    ZoneBalance *zone = getZone(zoneId);
+    if (!zone) {
+        if (zoneCount >= MAX_ZONES) return nullptr;
+        zone = &zones[zoneCount++];
+        *zone = ZoneBalance();
+        zone->zoneId = zoneId;
+    }
+    zone->crop = crop;
+    zone->plantingDay = plantingDay;
+    return zone;
+}
+
+ZoneBalance *WaterBalance::getZone(uint8_t zoneId) {
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        if (zones[i].zoneId == zoneId) return &zones[i];
+    }
+    return nullptr;
+}
+
+void WaterBalance::advance(float et0MmPerDay, float rainMm, uint16_t dayOfYear, float hours) {
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        zones[i].advance(et0MmPerDay, rainMm, 0, dayOfYear, hours);
+    }
+}
+
+void WaterBalance::recordIrrigation(uint8_t zoneId, float grossMm) {
+    ZoneBalance *zone = getZone(zoneId);
+    if (!zone) return;
+    float netMm = grossMm * zone->efficiency;
+    zone->depletionMm = netMm >= zone->depletionMm ? 0 : zone->depletionMm - netMm;
+}
+
+void WaterBalance::applyToScheduler(IrrigationScheduler &scheduler) const {
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        scheduler.setZoneDuration(zones[i].zoneId, zones[i].irrigationMinutes());
+    }
+}
+
+} // namespace ET
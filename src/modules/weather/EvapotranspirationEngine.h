@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+
+class IrrigationScheduler;
+
+// FAO-56 reference evapotranspiration (ET0), crop coefficients and per-zone soil water balance.
+// The expensive terms (saturation vapour pressure, extraterrestrial radiation) come from the
+// precomputed tables in EvapotranspirationTables.h so many zones can be stepped every hour on an MCU.
+// All quantities are SI as in FAO-56: °C, kPa, m/s at 2 m, MJ m-2 day-1, mm.
+namespace ET {
+
+// ---- Meteorology ----------------------------------------------------------
+
+float saturationVaporPressure(float tempC);      // e°(T), kPa, table + linear interpolation
+float saturationVaporPressureExact(float tempC); // FAO-56 Eq. 11
+float extraterrestrialRadiation(float latitudeDeg, uint16_t dayOfYear);      // Ra, table + bilinear
+float extraterrestrialRadiationExact(float latitudeDeg, uint16_t dayOfYear); // FAO-56 Eq. 21
+float daylightHours(float latitudeDeg, uint16_t dayOfYear);                  // N, FAO-56 Eq. 34
+float windSpeedAt2m(float windMs, float measuredHeightM);                    // FAO-56 Eq. 47
+
+struct Site {
+    float latitudeDeg = 0;
+    float elevationM = 0;
+    float krs = 0.16f; // Hargreaves radiation adjustment, 0.16 interior / 0.19 coastal
+};
+
+// One day of weather. Optional inputs are negative when not measured.
+struct DailyWeather {
+    float tMaxC = 0;
+    float tMinC = 0;
+    float rhMax = -1;        // %
+    float rhMin = -1;        // %
+    float rhMean = -1;       // %, used when min/max are not available
+    float windMs = 2.0f;     // at 2 m; FAO-56 default when missing
+    float solarMJ = -1;      // Measured Rs
+    float sunshineHours = -1; // Actual sunshine duration n, used when Rs is missing
+    float rainMm = 0;
+};
+
+// Hargreaves ET0 (FAO-56 Eq. 52), mm/day. Needs only temperatures.
+float hargreaves(const DailyWeather &weather, float ra);
+
+// FAO-56 Penman-Monteith daily ET0 (Eq. 6), mm/day. Missing Rs is estimated from sunshine
+// hours (Eq. 35) or the temperature range (Eq. 50); missing humidity falls back to Tmin as dew point.
+float penmanMonteith(const DailyWeather &weather, const Site &site, uint16_t dayOfYear);
+
+// ---- Crops ----------------------------------------------------------------
+
+enum CropType : uint8_t {
+    CROP_REFERENCE_GRASS = 0,
+    CROP_ALFALFA,
+    CROP_CORN,
+    CROP_SPRING_WHEAT,
+    CROP_POTATO,
+    CROP_SUGAR_BEET,
+    CROP_DRY_BEANS,
+    CROP_PASTURE,
+    CROP_COUNT
+};
+
+// FAO-56 single crop coefficient curve (Tables 11/12): Kc_ini, Kc_mid, Kc_end and stage lengths in days
+struct KcCurve {
+    const char *name;
+    float kcIni;
+    float kcMid;
+    float kcEnd;
+    uint8_t lengthIni;
+    uint8_t lengthDev;
+    uint8_t lengthMid;
+    uint8_t lengthLate;
+};
+
+const KcCurve &getKcCurve(CropType crop);
+float cropCoefficient(CropType crop, uint16_t daysAfterPlanting);
+uint16_t daysSince(uint16_t fromDayOfYear, uint16_t toDayOfYear);
+
+// ---- Water balance --------------------------------------------------------
+
+// Root-zone depletion bookkeeping for one zone (FAO-56 Chapter 8, Eq. 85)
+struct ZoneBalance {
+    uint8_t zoneId = 0;
+    CropType crop = CROP_REFERENCE_GRASS;
+    uint16_t plantingDay = 1;            // Day of year the crop was planted/green-up
+    float rootDepthM = 1.0f;             // Effective root depth Zr
+    float availableWaterMmPerM = 140.0f; // 1000 (θFC - θWP), ~140 for loam
+    float depletionFraction = 0.5f;      // p, fraction of TAW usable without stress
+    float applicationRateMmPerHour = 10.0f;
+    float efficiency = 0.75f;            // Application efficiency
+    float depletionMm = 0;               // Dr, 0 = field capacity
+    float lastEtcMm = 0;
+
+    float totalAvailableWater() const { return availableWaterMmPerM * rootDepthM; }
+    float readilyAvailableWater() const { return depletionFraction * totalAvailableWater(); }
+    bool needsIrrigation() const { return depletionMm >= readilyAvailableWater(); }
+    // Gross run time needed to bring the zone back to field capacity
+    uint16_t irrigationMinutes() const;
+    // Advance the balance by `hours` of a day with the given ET0 rate; rain/irrigation in mm
+    void advance(float et0MmPerDay, float rainMm, float irrigationMm, uint16_t dayOfYear, float hours = 24.0f);
+};
+
+class WaterBalance {
+public:
+    static constexpr uint8_t MAX_ZONES = 64;
+
+    ZoneBalance *addZone(uint8_t zoneId, CropType crop, uint16_t plantingDay);
+    ZoneBalance *getZone(uint8_t zoneId);
+    uint8_t getZoneCount() const { return zoneCount; }
+
+    // Step every zone with one shared ET0 value; rain is applied to all zones
+    void advance(float et0MmPerDay, float rainMm, uint16_t dayOfYear, float hours = 24.0f);
+    // Record water applied to a zone (e.g. when the scheduler finishes a run)
+    void recordIrrigation(uint8_t zoneId, float grossMm);
+    // Write each zone's deficit-derived run time into the scheduler (0 skips the zone)
+    void applyToScheduler(IrrigationScheduler &scheduler) const;
+
+private:
+    ZoneBalance zones[MAX_ZONES];
+    uint8_t zoneCount = 0;
+};
+
+} // namespace ET
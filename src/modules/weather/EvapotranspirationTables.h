@@ -0,0 +1,55 @@
+#pragma once
+// Generated by bin/gen-et-tables.py - do not edit by hand
+#include <cstdint>
+
+namespace ET {
+
+static constexpr int SVP_TABLE_MIN_C = -10;
+static constexpr int SVP_TABLE_MAX_C = 50;
+// Saturation vapour pressure e°(T) in kPa at 1 °C steps (FAO-56 Eq. 11)
+static constexpr float SVP_TABLE[] = {
+    0.28571f, 0.30919f, 0.33437f, 0.36135f, 0.39025f, 0.42118f, 0.45426f, 0.48963f,
+    0.52741f, 0.56775f, 0.61080f, 0.65671f, 0.70564f, 0.75777f, 0.81326f, 0.87231f,
+    0.93511f, 1.00186f, 1.07277f, 1.14806f, 1.22796f, 1.31271f, 1.40256f, 1.49777f,
+    1.59860f, 1.70535f, 1.81829f, 1.93773f, 2.06399f, 2.19739f, 2.33828f, 2.48701f,
+    2.64393f, 2.80944f, 2.98392f, 3.16778f, 3.36144f, 3.56534f, 3.77993f, 4.00568f,
+    4.24307f, 4.49259f, 4.75478f, 5.03015f, 5.31926f, 5.62268f, 5.94100f, 6.27482f,
+    6.62476f, 6.99147f, 7.37561f, 7.77787f, 8.19896f, 8.63958f, 9.10050f, 9.58248f,
+    10.08631f, 10.61281f, 11.16281f, 11.73716f, 12.33676f,
+};
+
+static constexpr int RA_TABLE_LAT_MIN = -60;
+static constexpr int RA_TABLE_LAT_STEP = 5;
+static constexpr int RA_TABLE_ROWS = 25;
+static constexpr int RA_TABLE_COLUMNS = 52;
+// Extraterrestrial radiation Ra in 0.01 MJ m-2 day-1 (FAO-56 Eq. 21), one row per latitude,
+// one column per week starting at day 1
+static constexpr uint16_t RA_TABLE[RA_TABLE_ROWS][RA_TABLE_COLUMNS] = {
+    {4357, 4269, 4143, 3980, 3787, 3568, 3327, 3070, 2802, 2529, 2255, 1986, 1726, 1480, 1251, 1043, 858, 696, 560, 447, 358, 291, 243, 213, 199, 201, 219, 253, 306, 378, 472, 590, 731, 897, 1086, 1298, 1528, 1776, 2035, 2304, 2576, 2847, 3112, 3365, 3602, 3817, 4005, 4163, 4284, 4366, 4406, 4403}, // -60
+    {4389, 4315, 4207, 4067, 3899, 3706, 3492, 3261, 3018, 2767, 2512, 2259, 2011, 1773, 1549, 1341, 1153, 986, 841, 720, 620, 543, 487, 451, 434, 437, 458, 499, 559, 641, 745, 872, 1020, 1191, 1382, 1591, 1817, 2055, 2302, 2553, 2806, 3054, 3294, 3521, 3731, 3920, 4085, 4221, 4325, 4395, 4430, 4428}, // -55
+    {4421, 4358, 4266, 4145, 3999, 3830, 3641, 3434, 3215, 2986, 2751, 2515, 2282, 2055, 1838, 1635, 1448, 1280, 1132, 1005, 901, 818, 757, 718, 699, 701, 725, 769, 834, 921, 1030, 1160, 1312, 1482, 1671, 1875, 2092, 2318, 2550, 2784, 3016, 3242, 3459, 3662, 3848, 4014, 4157, 4275, 4365, 4425, 4455, 4454}, // -50
+    {4442, 4389, 4310, 4207, 4081, 3935, 3769, 3587, 3391, 3184, 2970, 2752, 2535, 2321, 2114, 1919, 1737, 1571, 1423, 1296, 1189, 1104, 1041, 1000, 980, 982, 1006, 1052, 1120, 1209, 1319, 1450, 1600, 1767, 1950, 2146, 2352, 2564, 2780, 2995, 3206, 3410, 3603, 3782, 3945, 4090, 4214, 4315, 4392, 4444, 4469, 4469}, // -45
+    {4444, 4400, 4335, 4248, 4142, 4017, 3874, 3715, 3542, 3359, 3166, 2968, 2769, 2570, 2376, 2191, 2016, 1856, 1712, 1586, 1480, 1395, 1331, 1289, 1269, 1271, 1295, 1341, 1409, 1498, 1607, 1735, 1881, 2042, 2217, 2402, 2594, 2791, 2988, 3183, 3373, 3554, 3724, 3880, 4021, 4144, 4250, 4335, 4400, 4444, 4466, 4466}, // -40
+    {4424, 4389, 4336, 4266, 4178, 4074, 3953, 3818, 3669, 3509, 3339, 3162, 2981, 2800, 2621, 2448, 2284, 2131, 1993, 1871, 1768, 1684, 1621, 1579, 1559, 1561, 1585, 1630, 1696, 1783, 1889, 2012, 2151, 2304, 2468, 2640, 2817, 2996, 3174, 3348, 3515, 3673, 3819, 3952, 4071, 4175, 4262, 4333, 4386, 4422, 4440, 4441}, // -35
+    {4379, 4353, 4312, 4257, 4188, 4104, 4006, 3894, 3769, 3633, 3486, 3332, 3172, 3009, 2847, 2688, 2536, 2394, 2263, 2148, 2049, 1968, 1907, 1866, 1847, 1848, 1871, 1914, 1978, 2061, 2162, 2278, 2409, 2551, 2702, 2859, 3019, 3178, 3336, 3487, 3631, 3765, 3888, 3999, 4096, 4179, 4249, 4305, 4347, 4376, 4391, 4392}, // -30
+    {4309, 4291, 4262, 4222, 4171, 4107, 4031, 3943, 3842, 3730, 3607, 3476, 3338, 3195, 3052, 2909, 2771, 2641, 2520, 2413, 2320, 2244, 2186, 2147, 2128, 2129, 2150, 2191, 2251, 2329, 2422, 2530, 2650, 2780, 2916, 3056, 3197, 3337, 3472, 3600, 3720, 3831, 3930, 4017, 4093, 4157, 4210, 4252, 4283, 4304, 4316, 4318}, // -25
+    {4213, 4203, 4185, 4160, 4126, 4082, 4028, 3963, 3887, 3799, 3701, 3594, 3479, 3358, 3234, 3109, 2987, 2870, 2762, 2663, 2578, 2508, 2454, 2417, 2399, 2400, 2420, 2457, 2512, 2584, 2669, 2767, 2874, 2989, 3109, 3231, 3352, 3470, 3582, 3686, 3782, 3868, 3943, 4008, 4063, 4108, 4144, 4172, 4193, 4207, 4215, 4217}, // -20
+    {4091, 4088, 4082, 4071, 4054, 4029, 3997, 3955, 3903, 3840, 3767, 3684, 3593, 3495, 3392, 3287, 3182, 3081, 2985, 2898, 2821, 2758, 2708, 2675, 2659, 2659, 2676, 2710, 2759, 2823, 2899, 2985, 3078, 3178, 3280, 3382, 3481, 3576, 3664, 3745, 3816, 3877, 3928, 3971, 4004, 4031, 4051, 4066, 4076, 4084, 4089, 4091}, // -15
+    {3944, 3948, 3952, 3954, 3954, 3948, 3937, 3918, 3890, 3852, 3804, 3747, 3680, 3605, 3525, 3440, 3354, 3269, 3188, 3113, 3047, 2991, 2948, 2918, 2903, 2903, 2918, 2947, 2990, 3044, 3109, 3182, 3261, 3343, 3426, 3507, 3584, 3656, 3719, 3774, 3820, 3857, 3885, 3905, 3919, 3927, 3931, 3933, 3934, 3935, 3937, 3940}, // -10
+    {3771, 3782, 3796, 3812, 3827, 3840, 3849, 3852, 3848, 3835, 3813, 3780, 3739, 3689, 3631, 3569, 3502, 3435, 3370, 3308, 3253, 3206, 3169, 3143, 3130, 3129, 3142, 3166, 3201, 3246, 3299, 3358, 3421, 3484, 3547, 3606, 3660, 3707, 3746, 3776, 3797, 3809, 3814, 3812, 3806, 3796, 3785, 3775, 3767, 3761, 3760, 3763}, // -5
+    {3575, 3592, 3616, 3644, 3674, 3705, 3733, 3758, 3777, 3789, 3792, 3786, 3770, 3744, 3711, 3671, 3625, 3577, 3528, 3481, 3438, 3400, 3370, 3349, 3338, 3337, 3346, 3365, 3392, 3427, 3467, 3511, 3556, 3600, 3642, 3678, 3708, 3730, 3744, 3749, 3745, 3733, 3715, 3692, 3666, 3640, 3615, 3592, 3575, 3564, 3560, 3564}, // 0
+    {3356, 3380, 3412, 3452, 3496, 3543, 3591, 3637, 3679, 3715, 3743, 3762, 3772, 3771, 3762, 3745, 3722, 3693, 3662, 3631, 3600, 3573, 3551, 3535, 3526, 3524, 3530, 3543, 3562, 3585, 3611, 3639, 3666, 3690, 3710, 3723, 3728, 3725, 3714, 3693, 3665, 3629, 3589, 3546, 3502, 3459, 3420, 3387, 3361, 3345, 3338, 3342}, // 5
+    {3117, 3146, 3187, 3237, 3295, 3358, 3424, 3490, 3554, 3613, 3665, 3710, 3745, 3770, 3786, 3793, 3791, 3784, 3771, 3755, 3739, 3723, 3709, 3698, 3691, 3689, 3692, 3698, 3708, 3719, 3731, 3742, 3750, 3753, 3750, 3739, 3720, 3692, 3655, 3610, 3557, 3499, 3437, 3375, 3313, 3255, 3203, 3160, 3127, 3105, 3096, 3100}, // 10
+    {2859, 2893, 2941, 3001, 3071, 3149, 3232, 3317, 3402, 3484, 3560, 3629, 3690, 3740, 3781, 3812, 3833, 3847, 3854, 3855, 3853, 3848, 3843, 3838, 3834, 3831, 3830, 3830, 3830, 3829, 3826, 3819, 3807, 3789, 3762, 3728, 3684, 3630, 3568, 3499, 3423, 3343, 3261, 3180, 3102, 3030, 2966, 2913, 2873, 2847, 2835, 2839}, // 15
+    {2585, 2624, 2678, 2747, 2828, 2919, 3018, 3121, 3225, 3328, 3428, 3521, 3606, 3682, 3748, 3803, 3848, 3883, 3910, 3928, 3941, 3949, 3953, 3954, 3952, 3949, 3944, 3937, 3927, 3913, 3894, 3869, 3837, 3797, 3747, 3688, 3619, 3541, 3455, 3362, 3263, 3162, 3061, 2963, 2870, 2785, 2711, 2649, 2603, 2572, 2559, 2563}, // 20
+    {2297, 2339, 2400, 2476, 2567, 2670, 2783, 2902, 3025, 3148, 3270, 3386, 3496, 3596, 3687, 3766, 3835, 3892, 3939, 3976, 4004, 4024, 4038, 4045, 4047, 4043, 4034, 4019, 3999, 3971, 3936, 3893, 3840, 3777, 3704, 3621, 3528, 3425, 3315, 3199, 3080, 2959, 2840, 2726, 2619, 2523, 2439, 2370, 2318, 2284, 2269, 2274}, // 25
+    {1999, 2044, 2109, 2191, 2290, 2404, 2529, 2663, 2802, 2945, 3087, 3226, 3358, 3483, 3598, 3702, 3794, 3874, 3941, 3997, 4041, 4075, 4098, 4112, 4117, 4113, 4099, 4077, 4046, 4004, 3952, 3890, 3816, 3731, 3634, 3527, 3409, 3283, 3150, 3012, 2873, 2734, 2599, 2471, 2352, 2246, 2154, 2079, 2023, 1986, 1969, 1974}, // 30
+    {1693, 1740, 1808, 1896, 2001, 2123, 2258, 2405, 2560, 2719, 2881, 3040, 3196, 3344, 3483, 3611, 3727, 3829, 3918, 3993, 4054, 4101, 4135, 4156, 4163, 4159, 4141, 4111, 4068, 4012, 3943, 3861, 3766, 3658, 3538, 3406, 3265, 3116, 2961, 2803, 2645, 2490, 2340, 2200, 2071, 1956, 1859, 1779, 1719, 1680, 1663, 1667}, // 35
+    {1383, 1432, 1502, 1592, 1702, 1830, 1974, 2132, 2299, 2474, 2653, 2832, 3009, 3180, 3342, 3494, 3634, 3759, 3869, 3964, 4042, 4103, 4148, 4176, 4187, 4182, 4160, 4121, 4067, 3996, 3909, 3807, 3690, 3559, 3415, 3260, 3096, 2925, 2750, 2573, 2398, 2228, 2066, 1916, 1779, 1658, 1556, 1473, 1411, 1371, 1353, 1357}, // 40
+    {1075, 1123, 1194, 1285, 1398, 1530, 1679, 1845, 2023, 2211, 2405, 2602, 2799, 2992, 3177, 3353, 3516, 3664, 3797, 3911, 4007, 4084, 4140, 4176, 4191, 4185, 4158, 4111, 4044, 3957, 3852, 3729, 3590, 3436, 3269, 3091, 2904, 2712, 2517, 2324, 2134, 1951, 1780, 1621, 1479, 1355, 1250, 1167, 1104, 1064, 1045, 1049}, // 45
+    {774, 821, 889, 980, 1092, 1224, 1377, 1547, 1733, 1932, 2139, 2353, 2568, 2781, 2989, 3188, 3375, 3548, 3703, 3839, 3954, 4046, 4115, 4159, 4178, 4171, 4139, 4082, 4002, 3899, 3774, 3630, 3468, 3290, 3100, 2899, 2691, 2479, 2266, 2057, 1855, 1662, 1484, 1321, 1176, 1051, 947, 864, 803, 764, 746, 749}, // 50
+    {489, 532, 596, 682, 790, 920, 1071, 1243, 1433, 1639, 1858, 2085, 2317, 2550, 2780, 3003, 3214, 3411, 3591, 3749, 3885, 3995, 4077, 4131, 4154, 4147, 4109, 4042, 3946, 3825, 3679, 3512, 3326, 3124, 2910, 2686, 2457, 2226, 1998, 1775, 1563, 1364, 1182, 1018, 874, 752, 652, 574, 516, 480, 463, 466}, // 55
+    {234, 270, 326, 402, 500, 622, 768, 937, 1127, 1337, 1563, 1802, 2049, 2301, 2553, 2799, 3036, 3260, 3466, 3650, 3809, 3940, 4039, 4103, 4132, 4124, 4079, 3999, 3886, 3744, 3574, 3381, 3169, 2941, 2702, 2455, 2205, 1957, 1714, 1481, 1263, 1061, 879, 719, 581, 468, 376, 307, 258, 227, 213, 215}, // 60
+};
+
+} // namespace ET
@@ -1,29 +1,128 @@
 #pragma once
 #include "configuration.h"
+#include "EvapotranspirationEngine.h"
+#include "modules/scheduling/IrrigationScheduler.h"
 #include <Wire.h>
 
+// Local weather in field units (°F, %, mph, inches), converted to SI for the FAO-56 ET engine.
 class WeatherIntegration {
 private:
-    float dailyET = 0;
-    float precipitationInches = 0;
+    float dailyET = 0;              // Reference ET0 of the last completed day, inches
+    float precipitationInches = 0;  // Rain since the start of the day
     float temperature = 0;
     float humidity = 0;
     float windSpeed = 0;
+
+    // Running statistics for the current day
+    float tMaxC = -100;
+    float tMinC = 100;
+    float rhMax = 0;
+    float rhMin = 100;
+    float windSumMs = 0;
+    uint16_t sampleCount = 0;
+    float rainAppliedMm = 0;        // Part of today's rain already booked into the balance
+
+    uint16_t dayOfYear = 182;
+    ET::Site site;
+    ET::WaterBalance balance;
+    IrrigationScheduler *scheduler = nullptr;
+
+    // Field stations measure wind at ~10 ft
+    static constexpr float ANEMOMETER_HEIGHT_M = 3.0f;
+    // Assumed diurnal range before a day has enough samples; typical for irrigated semi-arid sites
+    static constexpr float DEFAULT_RANGE_C = 12.0f;
+
+    static float toCelsius(float f) { return (f - 32.0f) * 5.0f / 9.0f; }
+    static float mphToMs(float mph) { return mph * 0.44704f; }
+
+    ET::DailyWeather today() const {
+        ET::DailyWeather w;
+        if (sampleCount == 0) {
+            float t = toCelsius(temperature);
+            w.tMaxC = t + DEFAULT_RANGE_C / 2;
+            w.tMinC = t - DEFAULT_RANGE_C / 2;
+            w.rhMean = humidity;
+            w.windMs = ET::windSpeedAt2m(mphToMs(windSpeed), ANEMOMETER_HEIGHT_M);
+            return w;
+        }
+        w.tMaxC = tMaxC;
+        w.tMinC = tMinC;
+        if (w.tMaxC - w.tMinC < 1.0f) {
+            w.tMaxC += DEFAULT_RANGE_C / 2;
+            w.tMinC -= DEFAULT_RANGE_C / 2;
+            w.rhMean = (rhMax + rhMin) / 2;
+        } else {
+            w.rhMax = rhMax;
+            w.rhMin = rhMin;
+        }
+        w.windMs = ET::windSpeedAt2m(windSumMs / sampleCount, ANEMOMETER_HEIGHT_M);
+        w.rainMm = precipitationInches * 25.4f;
+        return w;
+    }
+
 public:
+    void setLocation(float latitudeDeg, float elevationM) {
+        site.latitudeDeg = latitudeDeg;
+        site.elevationM = elevationM;
+    }
+    void setDayOfYear(uint16_t doy) { dayOfYear = doy; }
+    void attachScheduler(IrrigationScheduler *s) { scheduler = s; }
+    ET::WaterBalance &getWaterBalance() { return balance; }
+    ET::ZoneBalance *addZone(uint8_t zoneId, ET::CropType crop, uint16_t plantingDay) {
+        return balance.addZone(zoneId, crop, plantingDay);
+    }
+
     void updateLocalWeather(float temp, float humidity, float wind, float rain) {
         temperature = temp;
         this->humidity = humidity;
         windSpeed = wind;
-        precipitationInches = rain;
+        precipitationInches += rain;
+
+        float tC = toCelsius(temp);
+        if (tC > tMaxC) tMaxC = tC;
+        if (tC < tMinC) tMinC = tC;
+        if (humidity > rhMax) rhMax = humidity;
+        if (humidity < rhMin) rhMin = humidity;
+        windSumMs += mphToMs(wind);
+        sampleCount++;
         adjustIrrigationSchedule();
     }
-    float calculateET(float temp, float humidity, float wind) {
-        // Simplified ET calculation
-        return (0.0023 * temp * (100 - humidity) + 0.1 * wind);
+
+    // FAO-56 Penman-Monteith reference ET for today's readings so far, inches/day. Before the first
+    // reading of the day, the last one stands in with an assumed diurnal range.
+    float calculateET() const {
+        return ET::penmanMonteith(today(), site, dayOfYear) / 25.4f;
+    }
+
+    // Book one hour of crop water use into every zone. Call once per hour.
+    void advanceHour() {
+        float et0 = ET::penmanMonteith(today(), site, dayOfYear);
+        float rainMm = precipitationInches * 25.4f - rainAppliedMm;
+        rainAppliedMm += rainMm;
+        balance.advance(et0, rainMm, dayOfYear, 1.0f);
+    }
+
+    // Close out the day: keep ET0 for reporting, reset running statistics
+    void endOfDay() {
+        dailyET = ET::penmanMonteith(today(), site, dayOfYear) / 25.4f;
+        tMaxC = -100;
+        tMinC = 100;
+        rhMax = 0;
+        rhMin = 100;
+        windSumMs = 0;
+        sampleCount = 0;
+        precipitationInches = 0;
+        rainAppliedMm = 0;
+        dayOfYear = dayOfYear % 365 + 1;
+        adjustIrrigationSchedule();
     }
+
+    float getDailyET() const { return dailyET; }
+
     void adjustIrrigationSchedule() {
-        if (precipitationInches > 0.1) {
-            // TODO: reduce irrigation duration
+        // Run times follow each zone's root-zone deficit; rain shows up through the balance
+        if (scheduler) {
+            balance.applyToScheduler(*scheduler);
         }
     }
 };
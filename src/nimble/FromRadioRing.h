@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Single-producer, single-consumer ring of encoded FromRadio frames for the BLE transport.
+ *
+ * The PhoneAPI thread encodes frames ahead of time into free slots, and the NimBLE host task answers each FromRadio read
+ * straight from the oldest one, instead of waking the PhoneAPI thread and polling until it has produced a frame. Frames are
+ * encoded in place, so nothing is copied between the two sides and neither ever waits for the other.
+ *
+ * A read that finds the ring empty is counted as starved. The phone takes an empty read to mean there is nothing more for
+ * now and waits for a FromNum notify, so the producer must notify once it has published after a starved read.
+ *
+ * clear() is called by the producer, and only while the consumer is kept from reading, as NimbleBluetooth does after a
+ * disconnect.
+ */
+template <size_t Slots, size_t FrameBytes> class FromRadioRing
+{
+    static_assert(Slots >= 2 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+  public:
+    /// Buffer for the next frame, nullptr if the ring is full. Producer only.
+    uint8_t *claim()
+    {
+        uint32_t head = this->head.load(std::memory_order_relaxed);
+        if (head - tail.load(std::memory_order_acquire) >= Slots)
+            return nullptr;
+        return frames[head & (Slots - 1)].bytes;
+    }
+
+    /// Hand the claimed frame to the consumer. Producer only.
+    void publish(size_t length)
+    {
+        uint32_t head = this->head.load(std::memory_order_relaxed);
+        frames[head & (Slots - 1)].length = length;
+        this->head.store(head + 1, std::memory_order_release);
+    }
+
+    /// The oldest frame, nullptr if there is none (and the read is counted as starved). Consumer only.
+    const uint8_t *peek(size_t &length)
+    {
+        uint32_t tail = this->tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == tail) {
+            starved.store(true, std::memory_order_relaxed);
+            starvedReads++;
+            return nullptr;
+        }
+        length = frames[tail & (Slots - 1)].length;
+        return frames[tail & (Slots - 1)].bytes;
+    }
+
+    /// Done with the frame from peek(), its slot goes back to the producer. Consumer only.
+    void release()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        served.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    bool empty() const { return size() == 0; }
+
+    /// Whether a read came up empty since the last call. Producer only.
+    bool takeStarved() { return starved.exchange(false, std::memory_order_relaxed); }
+
+    /// Drop every frame. Producer only, see the class comment.
+    void clear()
+    {
+        tail.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        starved.store(false, std::memory_order_relaxed);
+    }
+
+    uint32_t getServed() const { return served.load(std::memory_order_relaxed); }
+    uint32_t getStarvedReads() const { return starvedReads; }
+
+  private:
+    struct Frame {
+        size_t length;
+        uint8_t bytes[FrameBytes];
+    };
+
+    Frame frames[Slots];
+    std::atomic<uint32_t> head{0}, tail{0};
+    std::atomic<bool> starved{false};
+    std::atomic<uint32_t> served{0}; // Read by the producer to see how far the phone has got
+    uint32_t starvedReads = 0;
+};
@@ -1,6 +1,7 @@
 #include "configuration.h"
 #if !MESHTASTIC_EXCLUDE_BLUETOOTH
 #include "BluetoothCommon.h"
+#include "FromRadioRing.h"
 #include "NimbleBluetooth.h"
 #include "PowerFSM.h"
 
@@ -9,6 +10,7 @@
 #include "mesh/mesh-pb-constants.h"
 #include "sleep.h"
 #include <NimBLEDevice.h>
+#include <atomic>
 #include <mutex>
 
 #ifdef NIMBLE_TWO
@@ -24,6 +26,9 @@ NimBLEServer *bleServer;
 
 static bool passkeyShowing;
 
+// Offered in the MTU exchange, a whole FromRadio then fits in one ATT read with no Read Blob follow-ups
+#define NIMBLE_PREFERRED_MTU 517
+
 class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
 {
   public:
@@ -31,16 +36,34 @@ class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
     std::vector<NimBLEAttValue> nimble_queue;
     std::mutex nimble_mutex;
     uint8_t queue_size = 0;
-    bool has_fromRadio = false;
-    uint8_t fromRadioBytes[meshtastic_FromRadio_size] = {0};
-    size_t numBytes = 0;
-    bool hasChecked = false;
-    bool phoneWants = false;
+
+    /// Encoded ahead by this thread, served by NimbleBluetoothFromRadioCallback::onRead
+    FromRadioRing<4, meshtastic_FromRadio_size> fromRadioRing;
+
+    /**
+     * Forget what was staged for the last connection. Called from the disconnect callback, so the ring is cleared by this
+     * thread, its producer, once it runs. Until then reads get nothing, the frames belong to the old connection.
+     */
+    void postResetFromRadio()
+    {
+        resetPending.store(true, std::memory_order_release);
+        setIntervalFromNow(0);
+    }
+
+    /// Whether reads must come up empty until the reset has been done
+    bool isResetPending() const { return resetPending.load(std::memory_order_acquire); }
 
   protected:
     virtual int32_t runOnce() override
     {
         std::lock_guard<std::mutex> guard(nimble_mutex);
+        if (resetPending.load(std::memory_order_acquire)) {
+            fromRadioRing.clear();
+            configStartedMs = 0;
+            configFrames = 0;
+            configLastFrame = 0;
+            resetPending.store(false, std::memory_order_release);
+        }
         if (queue_size > 0) {
             for (uint8_t i = 0; i < queue_size; i++) {
                 handleToRadio(nimble_queue.at(i).data(), nimble_queue.at(i).length());
@@ -48,12 +71,9 @@ class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
             LOG_DEBUG("Queue_size %u", queue_size);
             queue_size = 0;
         }
-        if (hasChecked == false && phoneWants == true) {
-            numBytes = getFromRadio(fromRadioBytes);
-            hasChecked = true;
-        }
+        fillFromRadio();
 
-        // the run is triggered via NimbleBluetoothToRadioCallback and NimbleBluetoothFromRadioCallback
+        // the run is triggered via NimbleBluetoothToRadioCallback, NimbleBluetoothFromRadioCallback and onNowHasData
         return INT32_MAX;
     }
     /**
@@ -62,7 +82,22 @@ class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
     virtual void onNowHasData(uint32_t fromRadioNum)
     {
         PhoneAPI::onNowHasData(fromRadioNum);
+        notifyFromNum(fromRadioNum);
+        // Have the frame encoded before the phone's read arrives
+        setIntervalFromNow(0);
+    }
+
+    /// Check the current underlying physical link to see if the client is currently connected
+    virtual bool checkIsConnected() { return bleServer && bleServer->getConnectedCount() > 0; }
 
+  private:
+    std::atomic<bool> resetPending{false};
+    uint32_t configStartedMs = 0; // When the first frame of a config download was encoded, 0 if none is being timed
+    uint32_t configFrames = 0;
+    uint32_t configLastFrame = 0; // Frames served once the phone has read the whole config, 0 while still encoding
+
+    void notifyFromNum(uint32_t fromRadioNum)
+    {
         uint8_t cc = bleServer->getConnectedCount();
         LOG_DEBUG("BLE notify fromNum: %d connections: %d", fromRadioNum, cc);
 
@@ -77,8 +112,47 @@ class BluetoothPhoneAPI : public PhoneAPI, public concurrency::OSThread
 #endif
     }
 
-    /// Check the current underlying physical link to see if the client is currently connected
-    virtual bool checkIsConnected() { return bleServer && bleServer->getConnectedCount() > 0; }
+    /**
+     * Encode FromRadio frames into the ring until it is full or PhoneAPI has nothing more.
+     *
+     * During the config download the phone reads back to back, so every slot is kept busy. Afterwards each frame is a mesh
+     * packet already taken off the phone queue, lost if the phone goes away before reading it, so only one is staged.
+     */
+    void fillFromRadio()
+    {
+        if (configLastFrame && fromRadioRing.getServed() >= configLastFrame) {
+            uint32_t ms = millis() - configStartedMs;
+            LOG_INFO("BLE config sync: %u frames in %u ms (%u frames/s), %u starved reads", configFrames, ms,
+                     ms ? configFrames * 1000 / ms : configFrames, fromRadioRing.getStarvedReads());
+            configStartedMs = 0;
+            configLastFrame = 0;
+        }
+
+        while (!(isSendingPackets() && !fromRadioRing.empty())) {
+            uint8_t *frame = fromRadioRing.claim();
+            if (!frame)
+                break;
+            bool configuring = isConnected() && !isSendingPackets();
+            size_t numBytes = getFromRadio(frame);
+            if (numBytes == 0)
+                break;
+            fromRadioRing.publish(numBytes);
+
+            if (configuring) {
+                if (!configStartedMs) {
+                    configStartedMs = millis();
+                    configFrames = 0;
+                }
+                configFrames++;
+                if (isSendingPackets()) // That was the config_complete_id
+                    configLastFrame = fromRadioRing.getServed() + fromRadioRing.size();
+            }
+        }
+        // The phone stops reading at an empty read and waits for FromNum, so tell it there is more now. onRead() runs us after
+        // every read, so a read that raced with the last publish is caught here too.
+        if (!fromRadioRing.empty() && fromRadioRing.takeStarved())
+            notifyFromNum(0);
+    }
 };
 
 static BluetoothPhoneAPI *bluetoothPhoneAPI;
@@ -120,21 +194,21 @@ class NimbleBluetoothFromRadioCallback : public NimBLECharacteristicCallbacks
     virtual void onRead(NimBLECharacteristic *pCharacteristic)
 #endif
     {
-        int tries = 0;
-        bluetoothPhoneAPI->phoneWants = true;
-        while (!bluetoothPhoneAPI->hasChecked && tries < 100) {
-            bluetoothPhoneAPI->setIntervalFromNow(0);
-            delay(20);
-            tries++;
+        // Never wait for the PhoneAPI thread here, this is the NimBLE host task. An empty read makes the phone wait for the
+        // FromNum notify fillFromRadio() sends once it has caught up.
+        size_t numBytes = 0;
+        const uint8_t *frame = nullptr;
+        if (!bluetoothPhoneAPI->isResetPending())
+            frame = bluetoothPhoneAPI->fromRadioRing.peek(numBytes);
+        if (frame) {
+            pCharacteristic->setValue(frame, numBytes); // Copied, so the slot can be reused right away
+            bluetoothPhoneAPI->fromRadioRing.release();
+        } else {
+            static const uint8_t none = 0;
+            pCharacteristic->setValue(&none, 0);
         }
-        std::lock_guard<std::mutex> guard(bluetoothPhoneAPI->nimble_mutex);
-        pCharacteristic->setValue(bluetoothPhoneAPI->fromRadioBytes, bluetoothPhoneAPI->numBytes);
-
-        if (bluetoothPhoneAPI->numBytes != 0) // if we did send something, queue it up right away to reload
-            bluetoothPhoneAPI->setIntervalFromNow(0);
-        bluetoothPhoneAPI->numBytes = 0;
-        bluetoothPhoneAPI->hasChecked = false;
-        bluetoothPhoneAPI->phoneWants = false;
+        // Refill the slot
+        bluetoothPhoneAPI->setIntervalFromNow(0);
     }
 };
 
@@ -243,9 +317,7 @@ class NimbleBluetoothServerCallback : public NimBLEServerCallbacks
         if (bluetoothPhoneAPI) {
             std::lock_guard<std::mutex> guard(bluetoothPhoneAPI->nimble_mutex);
             bluetoothPhoneAPI->close();
-            bluetoothPhoneAPI->hasChecked = false;
-            bluetoothPhoneAPI->phoneWants = false;
-            bluetoothPhoneAPI->numBytes = 0;
+            bluetoothPhoneAPI->postResetFromRadio();
             bluetoothPhoneAPI->queue_size = 0;
         }
 
@@ -327,6 +399,7 @@ void NimbleBluetooth::setup()
 
     NimBLEDevice::init(getDeviceName());
     NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+    NimBLEDevice::setMTU(NIMBLE_PREFERRED_MTU);
 
     if (config.bluetooth.mode != meshtastic_Config_BluetoothConfig_PairingMode_NO_PIN) {
         NimBLEDevice::setSecurityAuth(BLE_SM_PAIR_AUTHREQ_BOND | BLE_SM_PAIR_AUTHREQ_MITM | BLE_SM_PAIR_AUTHREQ_SC);
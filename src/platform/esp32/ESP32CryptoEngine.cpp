@@ -6,12 +6,21 @@
 class ESP32CryptoEngine : public CryptoEngine
 {
 
-    mbedtls_aes_context aes;
+    /// mbedtls contexts keyed with our channel keys, so packets don't redo mbedtls_aes_setkey_enc
+    KeyCache<mbedtls_aes_context, 4> schedules;
 
   public:
-    ESP32CryptoEngine() { mbedtls_aes_init(&aes); }
+    ESP32CryptoEngine()
+    {
+        for (size_t i = 0; i < schedules.size(); i++)
+            mbedtls_aes_init(&schedules.at(i));
+    }
 
-    ~ESP32CryptoEngine() { mbedtls_aes_free(&aes); }
+    ~ESP32CryptoEngine()
+    {
+        for (size_t i = 0; i < schedules.size(); i++)
+            mbedtls_aes_free(&schedules.at(i));
+    }
 
     /**
      * Encrypt a packet
@@ -23,14 +32,15 @@ class ESP32CryptoEngine : public CryptoEngine
     {
         if (_key.length > 0) {
             if (numBytes <= MAX_BLOCKSIZE) {
-                mbedtls_aes_setkey_enc(&aes, _key.bytes, _key.length * 8);
-                static uint8_t scratch[MAX_BLOCKSIZE];
+                mbedtls_aes_context *aes = schedules.find(_key.bytes, _key.length);
+                if (!aes) {
+                    aes = &schedules.insert(_key.bytes, _key.length);
+                    mbedtls_aes_setkey_enc(aes, _key.bytes, _key.length * 8);
+                }
                 uint8_t stream_block[16];
                 size_t nc_off = 0;
-                memcpy(scratch, bytes, numBytes);
-                memset(scratch + numBytes, 0,
-                       sizeof(scratch) - numBytes); // Fill rest of buffer with zero (in case cypher looks at it)
-                mbedtls_aes_crypt_ctr(&aes, numBytes, &nc_off, _nonce, stream_block, scratch, bytes);
+                // CTR only XORs the keystream in, mbedtls allows input and output to be the same buffer
+                mbedtls_aes_crypt_ctr(aes, numBytes, &nc_off, _nonce, stream_block, bytes, bytes);
             } else {
                 LOG_ERROR("Packet too large for crypto engine: %d. noop encryption!", numBytes);
             }
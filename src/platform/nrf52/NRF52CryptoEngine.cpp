@@ -4,6 +4,9 @@
 #include <Adafruit_nRFCrypto.h>
 class NRF52CryptoEngine : public CryptoEngine
 {
+    /// Expanded AES256 channel keys, the CryptoCell only does AES128
+    KeyCache<AES_ctx, 4> schedules;
+
   public:
     NRF52CryptoEngine() {}
 
@@ -12,9 +15,13 @@ class NRF52CryptoEngine : public CryptoEngine
     virtual void encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes) override
     {
         if (_key.length > 16) {
-            AES_ctx ctx;
-            AES_init_ctx_iv(&ctx, _key.bytes, _nonce);
-            AES_CTR_xcrypt_buffer(&ctx, bytes, numBytes);
+            AES_ctx *ctx = schedules.find(_key.bytes, _key.length);
+            if (!ctx) {
+                ctx = &schedules.insert(_key.bytes, _key.length);
+                AES_init_ctx(ctx, _key.bytes);
+            }
+            AES_ctx_set_iv(ctx, _nonce);
+            AES_CTR_xcrypt_buffer(ctx, bytes, numBytes);
         } else if (_key.length > 0) {
             nRFCrypto.begin();
             nRFCrypto_AES ctx;
@@ -0,0 +1,118 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // recvmmsg and sendmmsg
+#endif
+#include "MulticastSocket.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool MulticastSocket::listen(uint32_t group, uint16_t port, uint8_t ttl, uint32_t interface)
+{
+    close();
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    int on = 1;
+    unsigned char loop = 1, hops = ttl;
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    ip_mreq membership = {};
+    membership.imr_multiaddr.s_addr = htonl(group);
+    membership.imr_interface.s_addr = htonl(interface);
+    in_addr outgoing = {};
+    outgoing.s_addr = htonl(interface);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+        bind(fd, (const sockaddr *)&local, sizeof(local)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &outgoing, sizeof(outgoing)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops)) < 0) {
+        int error = errno;
+        close();
+        errno = error;
+        return false;
+    }
+
+    groupAddress.sin_family = AF_INET;
+    groupAddress.sin_port = htons(port);
+    groupAddress.sin_addr.s_addr = htonl(group);
+    if (!buffers)
+        buffers = new uint8_t[BATCH][DATAGRAM_BYTES];
+    return true;
+}
+
+void MulticastSocket::close()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    delete[] buffers;
+    buffers = nullptr;
+}
+
+size_t MulticastSocket::receive(const std::function<void(const uint8_t *bytes, size_t length)> &onDatagram)
+{
+    if (fd < 0)
+        return 0;
+    mmsghdr messages[BATCH];
+    iovec vectors[BATCH];
+    size_t total = 0;
+    for (;;) {
+        memset(messages, 0, sizeof(messages));
+        for (size_t i = 0; i < BATCH; i++) {
+            vectors[i].iov_base = buffers[i];
+            vectors[i].iov_len = DATAGRAM_BYTES;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(fd, messages, BATCH, MSG_DONTWAIT, nullptr);
+        calls++;
+        if (n <= 0)
+            return total;
+        for (int i = 0; i < n; i++) {
+            // A datagram cut short can't be parsed, and no node sends one this large
+            if (!(messages[i].msg_hdr.msg_flags & MSG_TRUNC))
+                onDatagram(buffers[i], messages[i].msg_len);
+        }
+        total += n;
+        if ((size_t)n < BATCH)
+            return total;
+    }
+}
+
+size_t MulticastSocket::send(const uint8_t *const *datagrams, const size_t *lengths, size_t count)
+{
+    if (fd < 0)
+        return 0;
+    mmsghdr messages[BATCH];
+    iovec vectors[BATCH];
+    size_t sent = 0;
+    while (sent < count) {
+        size_t n = count - sent < BATCH ? count - sent : BATCH;
+        memset(messages, 0, sizeof(messages[0]) * n);
+        for (size_t i = 0; i < n; i++) {
+            vectors[i].iov_base = const_cast<uint8_t *>(datagrams[sent + i]);
+            vectors[i].iov_len = lengths[sent + i];
+            messages[i].msg_hdr.msg_name = &groupAddress;
+            messages[i].msg_hdr.msg_namelen = sizeof(groupAddress);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int done = sendmmsg(fd, messages, n, MSG_DONTWAIT);
+        calls++;
+        if (done <= 0)
+            break;
+        sent += done;
+    }
+    return sent;
+}
+
+#endif // __linux__
@@ -0,0 +1,60 @@
+#pragma once
+#ifdef __linux__
+
+#include <functional>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A UDP multicast socket for Linux that moves many datagrams per system call, with recvmmsg and sendmmsg.
+ *
+ * The UDP bridge polls it from its own thread instead of being called back, so packets are decoded and handed to the router on
+ * the same thread that runs the router.
+ */
+class MulticastSocket
+{
+  public:
+    /// Datagrams per recvmmsg or sendmmsg call
+    static constexpr size_t BATCH = 16;
+    /// Large enough for any datagram on an Ethernet LAN
+    static constexpr size_t DATAGRAM_BYTES = 1472;
+
+    MulticastSocket() = default;
+    MulticastSocket(const MulticastSocket &) = delete;
+    MulticastSocket &operator=(const MulticastSocket &) = delete;
+    ~MulticastSocket() { close(); }
+
+    /**
+     * Join group (a.b.c.d as a << 24 | ...) on port, sending with ttl. Loopback stays on so that several instances on one host
+     * hear each other, as with AsyncUDP. interface picks the local address to join and send on, the routing table's choice by
+     * default.
+     * @return false with errno set if the socket could not be set up
+     */
+    bool listen(uint32_t group, uint16_t port, uint8_t ttl, uint32_t interface = 0);
+    void close();
+    explicit operator bool() const { return fd >= 0; }
+
+    /**
+     * Read whatever datagrams are waiting, without blocking, and call onDatagram for each.
+     * @return how many were read
+     */
+    size_t receive(const std::function<void(const uint8_t *bytes, size_t length)> &onDatagram);
+
+    /**
+     * Send count datagrams to the group, BATCH per system call.
+     * @return how many were sent, fewer if the socket buffer filled up or on an error
+     */
+    size_t send(const uint8_t *const *datagrams, const size_t *lengths, size_t count);
+
+    /// System calls made, for comparing against datagrams moved
+    uint32_t getCalls() const { return calls; }
+
+  private:
+    int fd = -1;
+    sockaddr_in groupAddress = {};
+    uint32_t calls = 0;
+    uint8_t (*buffers)[DATAGRAM_BYTES] = nullptr;
+};
+
+#endif // __linux__
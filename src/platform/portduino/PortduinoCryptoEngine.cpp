@@ -0,0 +1,94 @@
+#include "CryptoEngine.h"
+#include "configuration.h"
+
+#ifdef HAS_LIBCRYPTO
+#include <openssl/evp.h>
+
+/**
+ * AES through OpenSSL's libcrypto, which picks AES-NI on x86 gateways and the ARMv8 crypto extensions on a Pi 4/5 at runtime,
+ * instead of the portable table based AES from the Crypto library.
+ *
+ * Each channel and PKI key gets its own EVP context, keyed once. A packet only sets the IV, so nothing is expanded per packet.
+ */
+class PortduinoCryptoEngine : public CryptoEngine
+{
+    typedef KeyCache<EVP_CIPHER_CTX *, 8> Contexts;
+
+    Contexts ctrContexts; // Channel keys
+#if !(MESHTASTIC_EXCLUDE_PKI)
+    Contexts ecbContexts;          // PKI shared keys, aes-ccm encrypts one block at a time
+    EVP_CIPHER_CTX *ecb = nullptr; // Set by aesSetKey()
+#endif
+
+    /// The context keyed with this key, nullptr if OpenSSL failed
+    static EVP_CIPHER_CTX *keyed(Contexts &contexts, const EVP_CIPHER *cipher, const uint8_t *key, size_t length)
+    {
+        EVP_CIPHER_CTX **cached = contexts.find(key, length);
+        if (cached)
+            return *cached;
+        EVP_CIPHER_CTX *&ctx = contexts.insert(key, length);
+        if (!ctx)
+            ctx = EVP_CIPHER_CTX_new();
+        if (!ctx || EVP_EncryptInit_ex(ctx, cipher, nullptr, key, nullptr) != 1 || EVP_CIPHER_CTX_set_padding(ctx, 0) != 1) {
+            LOG_ERROR("OpenSSL could not set up AES%d", (int)length * 8);
+            contexts.remove(key, length);
+            return nullptr;
+        }
+        return ctx;
+    }
+
+    static void freeAll(Contexts &contexts)
+    {
+        for (size_t i = 0; i < contexts.size(); i++)
+            EVP_CIPHER_CTX_free(contexts.at(i));
+    }
+
+  public:
+    ~PortduinoCryptoEngine()
+    {
+        freeAll(ctrContexts);
+#if !(MESHTASTIC_EXCLUDE_PKI)
+        freeAll(ecbContexts);
+#endif
+    }
+
+    virtual void encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes) override
+    {
+        if (_key.length <= 0)
+            return;
+        EVP_CIPHER_CTX *ctx =
+            keyed(ctrContexts, _key.length == 16 ? EVP_aes_128_ctr() : EVP_aes_256_ctr(), _key.bytes, _key.length);
+        int outLength;
+        // Setting only the IV restarts the counter with the key schedule untouched. OpenSSL carries into the whole 128 bit
+        // counter where the Crypto library used 32 bits, which is the same for the 16 blocks of a LoRa packet.
+        if (!ctx || EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, _nonce) != 1 ||
+            EVP_EncryptUpdate(ctx, bytes, &outLength, bytes, numBytes) != 1) {
+            CryptoEngine::encryptAESCtr(_key, _nonce, numBytes, bytes);
+        }
+    }
+
+#if !(MESHTASTIC_EXCLUDE_PKI)
+    virtual void aesSetKey(const uint8_t *key_bytes, size_t key_len) override
+    {
+        ecb = nullptr;
+        if (key_len != 0)
+            ecb = keyed(ecbContexts, key_len == 16 ? EVP_aes_128_ecb() : EVP_aes_256_ecb(), key_bytes, key_len);
+        if (!ecb)
+            CryptoEngine::aesSetKey(key_bytes, key_len);
+    }
+
+    virtual void aesEncrypt(uint8_t *in, uint8_t *out) override
+    {
+        if (!ecb) {
+            CryptoEngine::aesEncrypt(in, out);
+            return;
+        }
+        int outLength;
+        if (EVP_EncryptUpdate(ecb, out, &outLength, in, 16) != 1)
+            LOG_ERROR("OpenSSL AES block encryption failed");
+    }
+#endif
+};
+
+CryptoEngine *crypto = new PortduinoCryptoEngine();
+#endif
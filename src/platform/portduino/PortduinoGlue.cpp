@@ -1,6 +1,7 @@
 #include "CryptoEngine.h"
 #include "PortduinoGPIO.h"
 #include "SPIChip.h"
+#include "mesh/PacketTrace.h"
 #include "mesh/RF95Interface.h"
 #include "sleep.h"
 #include "target_specific.h"
@@ -406,11 +407,17 @@ void portduinoSetup()
     }
     if (portduino_config.traceFilename != "") {
         try {
-            traceFile.open(portduino_config.traceFilename, std::ios::out | std::ios::app);
+            traceFile.open(portduino_config.traceFilename, std::ios::out | std::ios::app | std::ios::binary);
         } catch (std::ofstream::failure &e) {
             std::cout << "*** traceFile Exception " << e.what() << std::endl;
             exit(EXIT_FAILURE);
         }
+        packetTrace.begin([](const uint8_t *data, size_t len) {
+            traceFile.write(reinterpret_cast<const char *>(data), len);
+            traceFile.flush();
+        });
+        // Registered after traceFile was constructed, so this runs before it is destroyed
+        atexit([] { packetTrace.end(); });
     }
     if (verboseEnabled && portduino_config.logoutputlevel != level_trace) {
         portduino_config.logoutputlevel = level_debug;
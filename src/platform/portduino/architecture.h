@@ -8,6 +8,11 @@
 
 #define HW_VENDOR meshtastic_HardwareModel_PORTDUINO
 
+// Set by the build when pkg-config finds libcrypto, see PortduinoCryptoEngine.cpp
+#if defined(HAS_LIBCRYPTO) && !defined(HAS_CUSTOM_CRYPTO_ENGINE)
+#define HAS_CUSTOM_CRYPTO_ENGINE 1
+#endif
+
 #ifndef HAS_BUTTON
 #define HAS_BUTTON 1
 #endif
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Writes JSON straight to an output as it is produced, for responses too big to build as a tree of JSONValues first.
+ *
+ * Output is anything with write(const uint8_t *, size_t), e.g. an HTTPResponse. Text is gathered in a BufferBytes buffer
+ * and handed over in writes of that size, so the output sees a few large writes instead of one per token.
+ *
+ * The text is what JSONValue::Stringify() makes of the same values: same escaping, numbers with 15 significant digits.
+ * Objects are written in the order keys are given, so callers that want Stringify's byte for byte output give them sorted.
+ */
+template <typename Output, size_t BufferBytes = 512> class JSONWriter
+{
+    static_assert(BufferBytes >= 32, "Numbers are formatted in place");
+
+  public:
+    explicit JSONWriter(Output &out) : out(out) {}
+
+    ~JSONWriter() { flush(); }
+
+    JSONWriter &beginObject() { return open('{'); }
+    JSONWriter &endObject() { return close('}'); }
+    JSONWriter &beginArray() { return open('['); }
+    JSONWriter &endArray() { return close(']'); }
+
+    /// Name of the next member, followed by its value or a begin call
+    JSONWriter &key(const char *name)
+    {
+        separate();
+        quoted(name);
+        put(':');
+        needComma = false;
+        return *this;
+    }
+
+    JSONWriter &value(const char *s)
+    {
+        separate();
+        quoted(s);
+        needComma = true;
+        return *this;
+    }
+
+    JSONWriter &value(double d)
+    {
+        separate();
+        if (std::isinf(d) || std::isnan(d))
+            text("null");
+        else
+            format("%.15g", d);
+        needComma = true;
+        return *this;
+    }
+
+    JSONWriter &value(long n)
+    {
+        separate();
+        format("%ld", n);
+        needComma = true;
+        return *this;
+    }
+
+    JSONWriter &value(int n) { return value((long)n); }
+
+    JSONWriter &null()
+    {
+        separate();
+        text("null");
+        needComma = true;
+        return *this;
+    }
+
+    /// Hand everything buffered so far to the output
+    void flush()
+    {
+        if (used) {
+            out.write(buffer, used);
+            written += used;
+            used = 0;
+        }
+    }
+
+    /// Bytes handed to the output, and still buffered
+    size_t size() const { return written + used; }
+
+  private:
+    Output &out;
+    uint8_t buffer[BufferBytes];
+    size_t used = 0, written = 0;
+    bool needComma = false;
+
+    JSONWriter &open(char c)
+    {
+        separate();
+        put(c);
+        needComma = false;
+        return *this;
+    }
+
+    JSONWriter &close(char c)
+    {
+        put(c);
+        needComma = true;
+        return *this;
+    }
+
+    void separate()
+    {
+        if (needComma)
+            put(',');
+    }
+
+    void put(char c)
+    {
+        if (used == BufferBytes)
+            flush();
+        buffer[used++] = c;
+    }
+
+    void text(const char *s)
+    {
+        while (*s)
+            put(*s++);
+    }
+
+    template <typename T> void format(const char *fmt, T v)
+    {
+        char number[32];
+        snprintf(number, sizeof(number), fmt, v);
+        text(number);
+    }
+
+    /// JSONValue::StringifyString(), which also escapes '/'. UTF-8 passes through as is.
+    void quoted(const char *s)
+    {
+        put('"');
+        for (; *s; s++) {
+            uint8_t c = *s;
+            if (c == '"' || c == '\\' || c == '/') {
+                put('\\');
+                put(c);
+            } else if (c == '\b') {
+                text("\\b");
+            } else if (c == '\f') {
+                text("\\f");
+            } else if (c == '\n') {
+                text("\\n");
+            } else if (c == '\r') {
+                text("\\r");
+            } else if (c == '\t') {
+                text("\\t");
+            } else if (c < 0x20 || c == 0x7F) {
+                format("\\u%04x", (unsigned)c);
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+    }
+};
@@ -0,0 +1,136 @@
+#include "AnalogChannel.h"
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// Scripted ADC: each conversion returns the next value, wrapping around
+struct FakeAdc {
+    const int32_t *values;
+    size_t count;
+    size_t next;
+    int powerOn;
+    int powerCycles;
+};
+
+static int32_t fakeRead(void *ctx) {
+    FakeAdc *adc = (FakeAdc *)ctx;
+    assert(adc->powerOn >= 0);
+    return adc->values[adc->next++ % adc->count];
+}
+
+static void fakePower(void *ctx, bool on) {
+    FakeAdc *adc = (FakeAdc *)ctx;
+    adc->powerOn += on ? 1 : -1;
+    if (!on) {
+        adc->powerCycles++;
+    }
+}
+
+static AnalogChannel::Config makeConfig(FakeAdc &adc, uint8_t oversample, uint8_t medianWindow, float emaAlpha) {
+    AnalogChannel::Config config = {};
+    config.name = "test";
+    config.intervalMs = 1000;
+    config.oversample = oversample;
+    config.medianWindow = medianWindow;
+    config.emaAlpha = emaAlpha;
+    config.read = fakeRead;
+    config.power = fakePower;
+    config.ctx = &adc;
+    return config;
+}
+
+void testBurstAndSchedule() {
+    const int32_t values[] = {100, 200, -1, 300}; // One failed conversion per burst of 4
+    FakeAdc adc = {values, 4, 0, 0, 0};
+    AnalogChannel channel(makeConfig(adc, 4, 1, 1.0f));
+
+    assert(channel.due(5000) && !channel.wasSampled() && !channel.hasValue());
+    assert(channel.sample(5000));
+    assert(channel.filtered() == 200 && channel.latest() == 200 && channel.getSamples() == 1);
+    assert(adc.powerOn == 0 && adc.powerCycles == 1);
+
+    assert(!channel.due(5999) && channel.msUntilDue(5400) == 600);
+    assert(channel.due(6000) && channel.msUntilDue(6000) == 0);
+    assert(channel.due(4999)); // millis() wrapped
+
+    // A burst with no good conversion keeps the last value
+    const int32_t dead[] = {-1};
+    FakeAdc deadAdc = {dead, 1, 0, 0, 0};
+    AnalogChannel broken(makeConfig(deadAdc, 4, 1, 1.0f));
+    assert(!broken.sample(0) && broken.wasSampled() && !broken.hasValue() && broken.filtered() == 0);
+    std::cout << "Analog channel burst test passed\n";
+}
+
+void testFilter() {
+    // Median of 3 throws out a single spike, the EMA then moves halfway per sample
+    const int32_t values[] = {1000, 1000, 4000, 1000, 2000, 2000};
+    FakeAdc adc = {values, 6, 0, 0, 0};
+    AnalogChannel channel(makeConfig(adc, 1, 3, 0.5f));
+    channel.sample(0);
+    assert(channel.filtered() == 1000);
+    channel.sample(1000);
+    channel.sample(2000); // Spike
+    assert(channel.latest() == 4000 && channel.filtered() == 1000);
+    channel.sample(3000);
+    assert(channel.filtered() == 1000);
+    channel.sample(4000); // 2000 is now the median of 1000, 4000, 2000
+    assert(channel.filtered() == 1500);
+    channel.sample(5000);
+    assert(channel.filtered() == 1750);
+    std::cout << "Analog channel filter test passed\n";
+}
+
+static int32_t slowRead(void *) {
+    // Roughly one ESP32 adc1_get_raw() conversion
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::microseconds(20)) {
+    }
+    return 2048;
+}
+
+void benchmarkCallerCost() {
+    // getBattVoltage() is called from readPowerStatus() and the screen; before, one call in every five seconds ran the burst
+    static const int CALLS = 20000, SAMPLES = 15;
+    AnalogChannel::Config config = {};
+    config.name = "battery";
+    config.intervalMs = 5000;
+    config.oversample = SAMPLES;
+    config.medianWindow = 1;
+    config.emaAlpha = 0.5f;
+    config.read = slowRead;
+    AnalogChannel channel(config);
+    channel.sample(0);
+
+    volatile float sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    int32_t worst = 0;
+    for (int i = 0; i < 100; i++) {
+        auto callStart = std::chrono::steady_clock::now();
+        int32_t raw = 0;
+        for (int s = 0; s < SAMPLES; s++) {
+            raw += slowRead(nullptr);
+        }
+        sink += raw / SAMPLES;
+        int32_t us =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - callStart).count();
+        worst = us > worst ? us : worst;
+    }
+    auto inLine = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLS; i++) {
+        sink += channel.filtered();
+    }
+    auto filtered = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Battery read in the caller: " << inLine / 100.0 << " us per burst (worst " << worst << " us), "
+              << filtered / (double)CALLS << " ns from the background channel\n";
+}
+
+int main() {
+    testBurstAndSchedule();
+    testFilter();
+    benchmarkCallerCost();
+    return 0;
+}
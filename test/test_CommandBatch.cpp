@@ -0,0 +1,111 @@
+#include "modules/irrigation/CommandBatch.h"
+#include "modules/field/FieldHierarchy.h"
+#include <cassert>
+#include <iostream>
+
+using namespace Irrigation;
+using namespace GateMesh;
+
+static meshtastic_IrrigationCommand_Target closeValve(uint32_t node) {
+    meshtastic_IrrigationCommand_Target t = meshtastic_IrrigationCommand_Target_init_zero;
+    t.node_id = node;
+    t.action = meshtastic_IrrigationCommand_Action_CLOSE_VALVE;
+    return t;
+}
+
+static meshtastic_IrrigationAck ackFrom(uint32_t sequence, uint32_t node, meshtastic_IrrigationAck_Result result) {
+    meshtastic_IrrigationAck ack = meshtastic_IrrigationAck_init_zero;
+    ack.sequence = sequence;
+    ack.entries_count = 1;
+    ack.entries[0].node_id = node;
+    ack.entries[0].result = result;
+    return ack;
+}
+
+void testSequenceWindow() {
+    SequenceWindow window;
+    assert(window.accept(0x10, 100));
+    assert(!window.accept(0x10, 100)); // Retry of the same batch
+    assert(window.accept(0x10, 102));
+    assert(window.accept(0x10, 101)); // Late but inside the window
+    assert(!window.accept(0x10, 101));
+    assert(window.accept(0x20, 100)); // Other controllers have their own window
+    assert(window.accept(0x10, 200));
+    assert(!window.accept(0x10, 150)); // Older than 32 behind is stale
+    std::cout << "SequenceWindow test passed\n";
+}
+
+void testBatchRetriesOnlyMissingTargets() {
+    meshtastic_IrrigationCommand_Target targets[4] = {closeValve(1), closeValve(2), closeValve(3), closeValve(4)};
+    BatchTracker tracker;
+    tracker.track(500, targets, 4, 0);
+
+    meshtastic_IrrigationAck a1 = ackFrom(500, 1, meshtastic_IrrigationAck_Result_OK);
+    meshtastic_IrrigationAck a3 = ackFrom(500, 3, meshtastic_IrrigationAck_Result_NO_AUTHORITY);
+    BatchTracker::Pending *p = tracker.recordAck(a1);
+    assert(p && !p->complete());
+    tracker.recordAck(a3);
+    assert(p->ackedCount() == 2 && p->failedCount() == 1);
+
+    meshtastic_IrrigationCommand retry;
+    BatchTracker::Pending *expired = nullptr;
+    assert(!tracker.collectRetry(1000, 15000, 2, retry, &expired)); // Not timed out yet
+    assert(tracker.collectRetry(15000, 15000, 2, retry, &expired) == p);
+    assert(retry.sequence == 500 && retry.targets_count == 2);
+    assert(retry.targets[0].node_id == 2 && retry.targets[1].node_id == 4);
+
+    // Node 2 executed the first time but its ACK was lost: it answers DUPLICATE, which counts as done
+    tracker.recordAck(ackFrom(500, 2, meshtastic_IrrigationAck_Result_DUPLICATE));
+    tracker.recordAck(ackFrom(500, 4, meshtastic_IrrigationAck_Result_OK));
+    assert(p->complete() && p->failedCount() == 1);
+    tracker.close(p);
+    assert(!tracker.recordAck(a1));
+    std::cout << "BatchTracker retry test passed\n";
+}
+
+void testBatchGivesUp() {
+    meshtastic_IrrigationCommand_Target targets[2] = {closeValve(1), closeValve(2)};
+    BatchTracker tracker;
+    tracker.track(7, targets, 2, 0);
+    meshtastic_IrrigationCommand retry;
+    BatchTracker::Pending *expired = nullptr;
+    assert(tracker.collectRetry(100, 100, 1, retry, &expired));
+    assert(!tracker.collectRetry(200, 100, 1, retry, &expired));
+    assert(expired && expired->sequence == 7 && expired->ackedCount() == 0);
+    assert(!tracker.find(7));
+    std::cout << "BatchTracker give-up test passed\n";
+}
+
+void testAuthority() {
+    FieldHierarchy hierarchy;
+    FieldHierarchy::Field field;
+    field.id = "north_40";
+    field.controller_node = 0xF00;
+    hierarchy.addField(&field);
+    FieldHierarchy::Zone zone;
+    zone.id = "zone_01";
+    zone.parent_field = &field;
+    zone.controller_node = 0xC01;
+    hierarchy.addZone(field.id, &zone);
+    hierarchy.assignNodeToZone(0x1001, zone.id);
+    FieldHierarchy::Infrastructure headgate;
+    headgate.type = FieldHierarchy::Infrastructure::HEADGATE;
+    headgate.id = "main";
+    headgate.node_ids.push_back(0xA00);
+    hierarchy.addInfrastructure(&headgate);
+
+    assert(hierarchy.hasAuthority(0xC01, 0x1001)); // Zone controller
+    assert(hierarchy.hasAuthority(0xF00, 0x1001)); // Field controller
+    assert(hierarchy.hasAuthority(0xA00, 0x1001)); // Headgate
+    assert(!hierarchy.hasAuthority(0xBAD, 0x1001));
+    assert(!hierarchy.hasAuthority(0xC01, 0x2002)); // Not in any zone
+    std::cout << "Command authority test passed\n";
+}
+
+int main() {
+    testSequenceWindow();
+    testBatchRetriesOnlyMissingTargets();
+    testBatchGivesUp();
+    testAuthority();
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "graphics/DamageTracker.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using graphics::DamageTracker;
+
+static const uint16_t WIDTH = 320;
+static const uint16_t HEIGHT = 240;
+
+static void setPixel(std::vector<uint8_t> &buf, int x, int y) {
+    buf[x + (y / 8) * WIDTH] |= 1 << (y & 7);
+}
+
+void testDiffMarksChangedTiles() {
+    std::vector<uint8_t> frame(WIDTH * HEIGHT / 8), panel(WIDTH * HEIGHT / 8);
+    DamageTracker damage;
+    damage.begin(WIDTH, HEIGHT);
+    assert(damage.diff(frame.data(), panel.data()) == 0 && !damage.isDirty());
+
+    setPixel(frame, 0, 0);     // First tile
+    setPixel(frame, 100, 17);  // Page 2, tile 3
+    setPixel(frame, 319, 239); // Last tile of the last page, which is narrower than the others
+    assert(damage.diff(frame.data(), panel.data()) == 3);
+    assert(damage.pageTiles(0) == 1);
+    assert(damage.pageTiles(2) == 1UL << 3);
+    assert(damage.isTileDirty(29, 9));
+    assert(damage.tileStart(9) == 288 && damage.tileEnd(9) == 320);
+
+    // A second diff before clear() doesn't count the same tiles twice
+    assert(damage.diff(frame.data(), panel.data()) == 3);
+    assert(damage.forcedTiles(0) == 0);
+
+    // Invalidated tiles are kept through the next diff, counted once, and forced
+    damage.invalidate(96, 16, 20, 8);
+    assert(damage.diff(frame.data(), panel.data()) == 3 && damage.forcedTiles(2) == 1UL << 3);
+    damage.invalidate(-10, -10, 40, 12);
+    assert(damage.isTileDirty(0, 0) && !damage.isTileDirty(1, 0) && damage.forcedTiles(0) == 1);
+    damage.invalidate(310, 232, 100, 100); // Clipped
+    damage.invalidate(400, 0, 10, 10);     // Off screen
+    assert(damage.diff(frame.data(), panel.data()) == 3 && damage.forcedTiles(29) == 1UL << 9);
+
+    damage.clear();
+    assert(!damage.isDirty() && damage.pageTiles(2) == 0 && damage.forcedTiles(2) == 0);
+    panel = frame;
+    assert(damage.diff(frame.data(), panel.data()) == 0);
+
+    // After the panel lost its contents, everything goes even though the buffers match
+    damage.invalidateAll();
+    assert(damage.diff(frame.data(), panel.data()) == 10 * 30 && damage.forcedTiles(29) == (1UL << 10) - 1);
+    std::cout << "Damage tracker diff test passed\n";
+}
+
+void testSameBytes() {
+    uint8_t a[37], b[37];
+    for (int i = 0; i < 37; i++)
+        a[i] = b[i] = i;
+    for (int offset = 0; offset < 4; offset++) { // Unaligned starts
+        for (size_t len = 0; len + offset <= sizeof(a); len++) {
+            assert(DamageTracker::sameBytes(a + offset, b + offset, len));
+            if (len) {
+                b[offset + len - 1] ^= 0x80;
+                assert(!DamageTracker::sameBytes(a + offset, b + offset, len));
+                b[offset + len - 1] ^= 0x80;
+            }
+        }
+    }
+    std::cout << "Damage tracker word compare test passed\n";
+}
+
+// What TFTDisplay::display did before: scan each page byte by byte, then each of its 8 rows for the first changed pixel
+static uint32_t byteScan(const uint8_t *buffer, const uint8_t *buffer_back) {
+    uint32_t changedRows = 0;
+    for (uint32_t y = 0; y < HEIGHT; y++) {
+        uint32_t y_byteIndex = (y / 8) * WIDTH;
+        uint8_t y_byteMask = 1 << (y & 7);
+        uint32_t x;
+        if (y_byteMask == 1) {
+            for (x = 0; x < WIDTH; x++) {
+                if (buffer[x + y_byteIndex] != buffer_back[x + y_byteIndex])
+                    break;
+            }
+            if (x >= WIDTH) {
+                y += 7;
+                continue;
+            }
+        }
+        for (x = 0; x < WIDTH; x++) {
+            if ((buffer[x + y_byteIndex] ^ buffer_back[x + y_byteIndex]) & y_byteMask)
+                break;
+        }
+        if (x < WIDTH)
+            changedRows++;
+    }
+    return changedRows;
+}
+
+void benchmarkDiff() {
+    static const int ROUNDS = 5000;
+    std::vector<uint8_t> frame(WIDTH * HEIGHT / 8), panel(WIDTH * HEIGHT / 8);
+    for (size_t i = 0; i < frame.size(); i++)
+        frame[i] = panel[i] = (i * 131) & 0xff; // Busy screen full of text
+    // A clock in the bottom right corner ticked over
+    for (int y = 220; y < 236; y++)
+        setPixel(frame, 300, y);
+
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+        sink += byteScan(frame.data(), panel.data());
+    auto bytes = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    DamageTracker damage;
+    damage.begin(WIDTH, HEIGHT);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        sink += damage.diff(frame.data(), panel.data());
+        damage.clear();
+    }
+    auto words = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Unchanged-area scan of a " << WIDTH << "x" << HEIGHT << " frame: " << bytes / ROUNDS / 1000.0
+              << " us byte by byte, " << words / ROUNDS / 1000.0 << " us by word into tiles\n";
+}
+
+int main() {
+    testDiffMarksChangedTiles();
+    testSameBytes();
+    benchmarkDiff();
+    return 0;
+}
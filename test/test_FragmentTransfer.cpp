@@ -0,0 +1,380 @@
+#include "modules/fragment/FragmentTransfer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_FragmentTransfer.cpp
+
+using namespace Fragment;
+
+// Air times at LongFast for a full packet and for a SACK, with the 16 byte mesh header
+static constexpr uint32_t DATA_AIRTIME_MS = 1500, SACK_AIRTIME_MS = 330;
+// What FragmentModule paces at on a quiet channel
+static constexpr uint32_t PACE_MS = 2 * DATA_AIRTIME_MS;
+
+static std::vector<uint8_t> makeMessage(size_t length, uint8_t seed) {
+    std::vector<uint8_t> message(length);
+    for (size_t i = 0; i < length; i++) message[i] = seed + i * 7 + (i >> 8);
+    return message;
+}
+
+void testWireFormat() {
+    uint8_t bytes[FRAGMENT_BYTES], packet[PAYLOAD_BYTES];
+    for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = i;
+
+    Header h = {};
+    h.wantSack = true;
+    h.id = 0xbeef;
+    h.index = 2;
+    h.count = 3;
+    h.port = 260;
+    size_t length = writeData(packet, h, bytes, 40);
+    Header back;
+    assert(length == DATA_HEADER + 40 && parse(packet, length, back));
+    assert(back.type == DATA && back.wantSack && back.id == 0xbeef && back.index == 2 && back.count == 3 && back.port == 260);
+
+    // Only the last fragment may be short, and none may be longer than FRAGMENT_BYTES
+    h.index = 1;
+    length = writeData(packet, h, bytes, 40);
+    assert(!parse(packet, length, back));
+    length = writeData(packet, h, bytes, FRAGMENT_BYTES);
+    assert(length == PAYLOAD_BYTES && parse(packet, length, back));
+    h.index = 3;
+    length = writeData(packet, h, bytes, 10);
+    assert(!parse(packet, length, back));
+    h.index = 0;
+    h.count = MAX_FRAGMENTS + 1;
+    length = writeData(packet, h, bytes, 10);
+    assert(!parse(packet, length, back));
+
+    length = writeSack(packet, 0x1234, 64, 0x8000000000000001ull);
+    assert(parse(packet, length, back) && back.type == SACK && back.id == 0x1234 && back.count == 64);
+    assert(back.received == 0x8000000000000001ull);
+    assert(!parse(packet, length - 1, back));
+
+    length = writeRefuse(packet, 7);
+    assert(parse(packet, length, back) && back.type == REFUSE && back.id == 7);
+    packet[0] = 9;
+    assert(!parse(packet, length, back));
+    assert(!parse(packet, 2, back));
+
+    assert(fragmentCount(0) == 1 && fragmentCount(FRAGMENT_BYTES) == 1 && fragmentCount(FRAGMENT_BYTES + 1) == 2);
+    assert(fragmentCount(MAX_MESSAGE) == MAX_FRAGMENTS);
+    assert(allFragments(3) == 7 && allFragments(64) == ~0ull);
+    std::cout << "Fragment wire format test passed\n";
+}
+
+void testSenderWindow() {
+    Sender sender;
+    sender.start(1, 10 * FRAGMENT_BYTES);
+    uint8_t index;
+    bool wantSack;
+    uint32_t now = 0;
+    auto expect = [&](uint8_t expectIndex, bool expectSack) {
+        assert(sender.next(now, index, wantSack) == Sender::SEND && index == expectIndex && wantSack == expectSack);
+        sender.sent(index, wantSack, now);
+    };
+
+    // First window is two fragments, the second asks for a SACK; sending goes on meanwhile
+    expect(0, false);
+    expect(1, true);
+    expect(2, false);
+
+    // Clean SACK: the window grows to three, fragment 2 is still in flight
+    now = 2000;
+    sender.onSack(0x3, now);
+    assert(sender.getWindow() == 3);
+    expect(3, false);
+    expect(4, true);
+
+    // Fragment 2 lost: it goes again first
+    sender.onSack(0x1b, now);
+    expect(2, false);
+    expect(5, false);
+    expect(6, false);
+    expect(7, true);
+
+    // That SACK is lost, which costs nothing until everything has gone out
+    expect(8, false);
+    expect(9, true);
+    assert(sender.next(now + sender.timeoutMs() - 1, index, wantSack) == Sender::WAIT);
+
+    // Then the first missing fragment probes for it and the window halves
+    uint32_t firstTimeout = sender.timeoutMs();
+    now += sender.timeoutMs();
+    uint8_t window = sender.getWindow();
+    expect(2, true);
+    assert(sender.getWindow() == window / 2 && sender.timeoutMs() > firstTimeout);
+
+    // The probe's SACK shows everything but 6
+    sender.onSack(0x3bf, now);
+    expect(6, true);
+    sender.onSack(0x3ff, now);
+    assert(sender.isDone() && sender.next(now, index, wantSack) == Sender::DONE);
+
+    // A receiver that never answers
+    sender.start(2, 100);
+    assert(sender.getCount() == 1);
+    assert(sender.next(0, index, wantSack) == Sender::SEND && wantSack);
+    sender.sent(index, wantSack, 0);
+    now = 0;
+    int probes = 0;
+    for (;;) {
+        now += sender.waitLeftMs(now);
+        Sender::Step step = sender.next(now, index, wantSack);
+        if (step == Sender::FAILED) break;
+        assert(step == Sender::SEND);
+        sender.sent(index, wantSack, now);
+        probes++;
+    }
+    assert(probes == Sender::MAX_PROBES && now <= Reassembler::TIMEOUT_MS);
+    std::cout << "Fragment sender test passed, gave up on a silent receiver after " << now / 1000 << " s\n";
+}
+
+void testReassembler() {
+    Reassembler reassembler;
+    std::vector<uint8_t> message = makeMessage(2 * FRAGMENT_BYTES + 50, 3);
+    Header h = {};
+    h.type = DATA;
+    h.id = 10;
+    h.count = 3;
+    h.port = 256;
+    Reassembler::Slot *slot;
+
+    // Out of order, with a duplicate
+    uint8_t order[] = {2, 0, 0, 1};
+    Reassembler::Result results[] = {Reassembler::STORED, Reassembler::STORED, Reassembler::STORED, Reassembler::COMPLETE};
+    for (int i = 0; i < 4; i++) {
+        h.index = order[i];
+        size_t offset = h.index * FRAGMENT_BYTES, length = h.index == 2 ? 50 : FRAGMENT_BYTES;
+        assert(reassembler.onData(0xa, h, &message[offset], length, 1000, slot) == results[i]);
+    }
+    assert(slot->length == message.size() && memcmp(slot->buffer, message.data(), message.size()) == 0);
+    assert(slot->port == 256 && slot->received == 7);
+    reassembler.finish(*slot);
+    assert(!slot->buffer && reassembler.receiving() == 0);
+
+    // A fragment resent after a lost SACK is answered from the finished slot
+    h.index = 1;
+    assert(reassembler.onData(0xa, h, &message[FRAGMENT_BYTES], FRAGMENT_BYTES, 2000, slot) == Reassembler::DUPLICATE);
+    assert(slot->received == 7);
+
+    // Two messages in progress fill the slots, evicting the finished one; a third is refused
+    h.index = 0;
+    h.id = 11;
+    assert(reassembler.onData(0xb, h, message.data(), FRAGMENT_BYTES, 3000, slot) == Reassembler::STORED);
+    assert(reassembler.onData(0xc, h, message.data(), FRAGMENT_BYTES, 3000, slot) == Reassembler::STORED);
+    assert(reassembler.receiving() == 2);
+    assert(reassembler.onData(0xd, h, message.data(), FRAGMENT_BYTES, 3000, slot) == Reassembler::REFUSED);
+
+    // The sender rebooted and reused the id for a message of another size
+    h.count = 2;
+    assert(reassembler.onData(0xb, h, message.data(), FRAGMENT_BYTES, 4000, slot) == Reassembler::STORED);
+    assert(slot->count == 2 && slot->received == 1);
+
+    // Abandoned messages time out and free their slots
+    reassembler.expire(4000 + Reassembler::TIMEOUT_MS);
+    assert(reassembler.receiving() == 0);
+    assert(reassembler.onData(0xd, h, message.data(), FRAGMENT_BYTES, 4000 + Reassembler::TIMEOUT_MS, slot) ==
+           Reassembler::STORED);
+    std::cout << "Fragment reassembler test passed\n";
+}
+
+// Two nodes on a link that drops each packet with some probability, in either direction.
+// Events run in time order; the sender side behaves as FragmentModule::runOnce does.
+struct LossyLink {
+    struct Event {
+        uint32_t at;
+        uint32_t order;
+        std::function<void()> run;
+        bool operator>(const Event &other) const { return at != other.at ? at > other.at : order > other.order; }
+    };
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    uint32_t now = 0, order = 0, airtimeMs = 0;
+    uint64_t rng;
+    double loss;
+
+    LossyLink(double loss, uint64_t seed) : rng(seed), loss(loss) {}
+
+    bool delivered()
+    {
+        // splitmix64, so that neighbouring seeds give unrelated loss patterns
+        uint64_t z = (rng += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+        return (z >> 11) * (1.0 / 9007199254740992.0) >= loss;
+    }
+
+    void at(uint32_t when, std::function<void()> run) { events.push(Event{when, order++, run}); }
+
+    // Put a packet on the air, it arrives when done unless lost
+    void transmit(uint32_t airtime, std::function<void()> arrive)
+    {
+        airtimeMs += airtime;
+        if (delivered()) at(now + airtime, arrive);
+    }
+
+    void run()
+    {
+        while (!events.empty()) {
+            Event e = events.top();
+            events.pop();
+            now = e.at;
+            e.run();
+        }
+    }
+};
+
+struct Transfer {
+    bool delivered;
+    uint32_t elapsedMs, airtimeMs;
+};
+
+static Transfer sendWithSacks(const std::vector<uint8_t> &message, double loss, uint64_t seed) {
+    LossyLink link(loss, seed);
+    Sender sender;
+    Reassembler reassembler;
+    sender.start(1, message.size(), DATA_AIRTIME_MS + SACK_AIRTIME_MS);
+    bool finished = false, delivered = false;
+    uint32_t lastSent = 0, wakeToken = 0, doneAt = 0;
+    bool sentAny = false;
+
+    std::function<void()> wake;
+    auto wakeAt = [&](uint32_t when) {
+        uint32_t token = ++wakeToken;
+        link.at(when, [&, token]() {
+            if (token == wakeToken) wake();
+        });
+    };
+    wake = [&]() {
+        if (finished) return;
+        if (sentAny && link.now - lastSent < PACE_MS) return wakeAt(lastSent + PACE_MS);
+        uint8_t index;
+        bool wantSack;
+        switch (sender.next(link.now, index, wantSack)) {
+            case Sender::DONE:
+            case Sender::FAILED:
+                finished = true;
+                doneAt = link.now;
+                return;
+            case Sender::WAIT:
+                return wakeAt(link.now + sender.waitLeftMs(link.now));
+            case Sender::SEND:
+                break;
+        }
+        Header h = {};
+        h.type = DATA;
+        h.wantSack = wantSack;
+        h.id = sender.getId();
+        h.index = index;
+        h.count = sender.getCount();
+        size_t offset = (size_t)index * FRAGMENT_BYTES;
+        size_t length = std::min(FRAGMENT_BYTES, message.size() - offset);
+        link.transmit(DATA_AIRTIME_MS, [&, h, offset, length]() {
+            Reassembler::Slot *slot;
+            auto result = reassembler.onData(0xa, h, &message[offset], length, link.now, slot);
+            if (result == Reassembler::COMPLETE) {
+                delivered = slot->length == message.size() && memcmp(slot->buffer, message.data(), message.size()) == 0;
+                reassembler.finish(*slot);
+            }
+            if (h.wantSack || result != Reassembler::STORED) {
+                uint64_t received = slot->received;
+                link.transmit(SACK_AIRTIME_MS, [&, received]() {
+                    sender.onSack(received, link.now);
+                    wakeAt(link.now);
+                });
+            }
+        });
+        sender.sent(index, wantSack, link.now);
+        lastSent = link.now;
+        sentAny = true;
+        wakeAt(link.now + PACE_MS);
+    };
+    wakeAt(0);
+    link.run();
+    return Transfer{delivered && sender.isDone(), doneAt, link.airtimeMs};
+}
+
+// What modules do today: one packet at a time with want_ack, resent until the ack comes back (with no
+// retry limit, so it always delivers)
+static Transfer sendStopAndWait(const std::vector<uint8_t> &message, double loss, uint64_t seed) {
+    static constexpr uint32_t ACK_TIMEOUT_MS = Sender::MIN_TIMEOUT_MS;
+    LossyLink link(loss, seed);
+    uint8_t count = fragmentCount(message.size()), next = 0;
+    uint64_t received = 0;
+    uint32_t wakeToken = 0, doneAt = 0;
+
+    std::function<void()> sendNext;
+    auto wakeAt = [&](uint32_t when) {
+        uint32_t token = ++wakeToken;
+        link.at(when, [&, token]() {
+            if (token == wakeToken) sendNext();
+        });
+    };
+    sendNext = [&]() {
+        if (next == count) {
+            doneAt = link.now;
+            return;
+        }
+        uint8_t index = next;
+        uint32_t sentAt = link.now;
+        link.transmit(DATA_AIRTIME_MS, [&, index, sentAt]() {
+            received |= 1ull << index;
+            link.transmit(SACK_AIRTIME_MS, [&, index, sentAt]() {
+                if (next != index) return;
+                next++;
+                wakeAt(std::max(link.now, sentAt + PACE_MS));
+            });
+        });
+        wakeAt(link.now + std::max(ACK_TIMEOUT_MS, PACE_MS));
+    };
+    wakeAt(0);
+    link.run();
+    return Transfer{received == allFragments(count), doneAt, link.airtimeMs};
+}
+
+void benchmarkGoodput() {
+    static constexpr int MESSAGES = 200;
+    std::vector<uint8_t> message = makeMessage(4096, 1);
+    printf("Goodput for %d x %u byte messages (%d fragments), loss each way:\n", MESSAGES, (unsigned)message.size(),
+           fragmentCount(message.size()));
+    printf("  loss  windowed+SACK (B/s, air s/msg, failed)  stop-and-wait (B/s, air s/msg)\n");
+    double losses[] = {0, 0.1, 0.2, 0.3};
+    for (double loss : losses) {
+        uint64_t bytes = 0, elapsed = 0, air = 0, baseBytes = 0, baseElapsed = 0, baseAir = 0;
+        int failed = 0;
+        for (int i = 0; i < MESSAGES; i++) {
+            Transfer t = sendWithSacks(message, loss, i);
+            elapsed += t.elapsedMs;
+            air += t.airtimeMs;
+            if (t.delivered) {
+                bytes += message.size();
+            } else {
+                failed++;
+            }
+            Transfer b = sendStopAndWait(message, loss, i);
+            assert(b.delivered);
+            baseBytes += message.size();
+            baseElapsed += b.elapsedMs;
+            baseAir += b.airtimeMs;
+        }
+        if (loss == 0) assert(failed == 0 && air < baseAir);
+        printf("  %3.0f%%  %6.1f  %6.1f  %3d                      %6.1f  %6.1f\n", loss * 100,
+               bytes * 1000.0 / elapsed, air / 1000.0 / MESSAGES, failed, baseBytes * 1000.0 / baseElapsed,
+               baseAir / 1000.0 / MESSAGES);
+    }
+}
+
+int main() {
+    testWireFormat();
+    testSenderWindow();
+    testReassembler();
+    benchmarkGoodput();
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include "mesh/FrameBroadcast.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_FrameBroadcast.cpp -lpthread
+
+typedef FrameBroadcast<8, 64> Feed;
+
+static void publishNumber(Feed &feed, uint32_t n) {
+    uint8_t frame[16];
+    memset(frame, (uint8_t)n, sizeof(frame));
+    memcpy(frame, &n, sizeof(n));
+    feed.publish(frame, 4 + n % 12);
+}
+
+void testCursors() {
+    Feed feed;
+    uint8_t out[64];
+    uint32_t dropped, a = feed.oldest(), b = feed.next();
+    assert(feed.read(a, out, dropped) == 0 && dropped == 0 && a == 0);
+
+    // Two viewers both see every frame
+    for (uint32_t n = 0; n < 5; n++)
+        publishNumber(feed, n);
+    for (uint32_t n = 0; n < 5; n++) {
+        uint32_t got;
+        assert(feed.read(a, out, dropped) == 4 + n % 12 && dropped == 0);
+        memcpy(&got, out, sizeof(got));
+        assert(got == n);
+        assert(feed.read(b, out, dropped) == 4 + n % 12);
+    }
+    assert(a == 5 && b == 5 && feed.read(a, out, dropped) == 0);
+
+    // A viewer 12 behind an 8 frame feed skips the 4 that are gone
+    for (uint32_t n = 5; n < 17; n++)
+        publishNumber(feed, n);
+    assert(feed.oldest() == 9 && feed.next() == 17);
+    uint32_t got;
+    assert(feed.read(a, out, dropped) && dropped == 4 && a == 10);
+    memcpy(&got, out, sizeof(got));
+    assert(got == 9);
+    assert(feed.read(a, out, dropped) && dropped == 0 && a == 11);
+
+    // A cursor from the future (a previous boot) starts over from the oldest frame
+    uint32_t stale = 1000;
+    assert(feed.read(stale, out, dropped) && dropped == 0 && stale == 10);
+
+    // Too big for a slot, ignored
+    uint8_t big[65] = {0};
+    feed.publish(big, sizeof(big));
+    assert(feed.next() == 17);
+
+    // Nobody has looked yet, then one viewer looks at t=1000
+    assert(!feed.isViewed(0, 60000));
+    feed.markViewed(1000);
+    assert(feed.isViewed(61000, 60000) && !feed.isViewed(61001, 60000));
+
+    assert(!feed.wait(feed.next(), 1));
+    feed.close();
+    assert(feed.isClosed() && !feed.wait(0, 1000)); // Closed, so no wait even with frames behind the cursor
+    std::cout << "Frame broadcast cursor test passed\n";
+}
+
+void testWaitWakes() {
+    static Feed feed;
+    uint32_t cursor = feed.next();
+    auto started = std::chrono::steady_clock::now();
+    std::thread producer([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        publishNumber(feed, 1);
+    });
+    assert(feed.wait(cursor, 5000));
+    assert(std::chrono::steady_clock::now() - started < std::chrono::seconds(2));
+    producer.join();
+
+    std::thread closer([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        feed.close();
+    });
+    assert(!feed.wait(feed.next(), 5000));
+    closer.join();
+    std::cout << "Frame broadcast wait test passed\n";
+}
+
+/*
+ * Ten dashboards watching live traffic on native, a packet every 20 ms for three seconds. Each frame carries the time it
+ * was published, so a viewer can tell how long it took to reach it.
+ *
+ * Before: every browser polls once a second. After: every browser holds a long poll, or an event stream, open and is woken
+ * by the publish. The HTTP and TLS cost of each request is not in these numbers, only how many requests there were: a long
+ * poll is one request per wakeup, an event stream one request in all.
+ */
+typedef std::chrono::steady_clock Clock;
+typedef FrameBroadcast<64, 512> LiveFrames;
+
+static const int VIEWERS = 10, PACKETS = 150, PACKET_MS = 20, POLL_MS = 1000;
+
+struct Result {
+    std::vector<double> latencyMs;
+    uint32_t requests = 0, dropped = 0;
+};
+
+static void collect(LiveFrames &feed, uint32_t &cursor, Result &result, uint32_t &seen) {
+    uint8_t frame[512];
+    uint32_t dropped;
+    size_t length;
+    while ((length = feed.read(cursor, frame, dropped)) > 0) {
+        Clock::rep stamp;
+        memcpy(&stamp, frame, sizeof(stamp));
+        result.latencyMs.push_back(std::chrono::duration<double, std::milli>(Clock::now().time_since_epoch() -
+                                                                            Clock::duration(stamp))
+                                       .count());
+        seen++;
+    }
+    result.dropped += dropped;
+}
+
+enum Mode { POLL, LONG_POLL, EVENT_STREAM };
+
+static void run(Mode mode, Result *results, double &cpuMs) {
+    LiveFrames *f = new LiveFrames();
+    std::atomic<bool> done{false};
+    std::clock_t cpuStart = std::clock();
+
+    std::vector<std::thread> viewers;
+    for (int v = 0; v < VIEWERS; v++) {
+        viewers.emplace_back([&, v] {
+            uint32_t cursor = f->next(), seen = 0;
+            while (seen < (uint32_t)PACKETS && !done) {
+                if (mode != EVENT_STREAM || !results[v].requests)
+                    results[v].requests++;
+                if (mode == POLL)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+                else
+                    f->wait(cursor, 30000);
+                collect(*f, cursor, results[v], seen);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Everyone is watching
+    uint8_t frame[237];
+    memset(frame, 0x5a, sizeof(frame));
+    for (int p = 0; p < PACKETS; p++) {
+        Clock::rep stamp = Clock::now().time_since_epoch().count();
+        memcpy(frame, &stamp, sizeof(stamp));
+        f->publish(frame, sizeof(frame));
+        std::this_thread::sleep_for(std::chrono::milliseconds(PACKET_MS));
+    }
+    for (auto &viewer : viewers)
+        viewer.join();
+    done = true;
+    f->close();
+    cpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    delete f;
+}
+
+static void report(const char *name, Result *results, double cpuMs) {
+    std::vector<double> all;
+    uint32_t requests = 0, dropped = 0;
+    for (int v = 0; v < VIEWERS; v++) {
+        all.insert(all.end(), results[v].latencyMs.begin(), results[v].latencyMs.end());
+        requests += results[v].requests;
+        dropped += results[v].dropped;
+    }
+    std::sort(all.begin(), all.end());
+    double mean = 0;
+    for (double l : all)
+        mean += l;
+    mean /= all.size();
+    std::cout << name << ": " << all.size() << " deliveries, latency mean " << mean << " ms, p99 "
+              << all[all.size() * 99 / 100] << " ms, " << requests << " requests, " << dropped << " dropped, " << cpuMs
+              << " ms CPU\n";
+    assert(all.size() == (size_t)VIEWERS * PACKETS && dropped == 0);
+}
+
+void benchmarkTenViewers() {
+    Result polled[VIEWERS], longPolled[VIEWERS], pushed[VIEWERS];
+    double polledCpu, longPolledCpu, pushedCpu;
+    run(POLL, polled, polledCpu);
+    run(LONG_POLL, longPolled, longPolledCpu);
+    run(EVENT_STREAM, pushed, pushedCpu);
+    report("10 viewers polling every second", polled, polledCpu);
+    report("10 viewers on long poll", longPolled, longPolledCpu);
+    report("10 viewers on event streams", pushed, pushedCpu);
+
+    double polledMean = 0, pushedMean = 0;
+    for (int v = 0; v < VIEWERS; v++) {
+        for (double l : polled[v].latencyMs)
+            polledMean += l;
+        for (double l : pushed[v].latencyMs)
+            pushedMean += l;
+    }
+    assert(pushedMean * 10 < polledMean);
+}
+
+int main() {
+    testCursors();
+    testWaitWakes();
+    benchmarkTenViewers();
+    return 0;
+}
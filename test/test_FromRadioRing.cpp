@@ -0,0 +1,183 @@
+#include "nimble/FromRadioRing.h"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+typedef FromRadioRing<4, 512> Ring;
+
+void testRing() {
+    Ring ring;
+    size_t length = 0;
+    assert(ring.empty() && !ring.peek(length) && ring.getStarvedReads() == 1);
+    assert(ring.takeStarved() && !ring.takeStarved());
+
+    // Fill every slot, the fifth claim fails until the consumer lets one go
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t *frame = ring.claim();
+        assert(frame);
+        memset(frame, 'a' + i, 10 + i);
+        ring.publish(10 + i);
+    }
+    assert(!ring.claim() && ring.size() == 4);
+
+    const uint8_t *frame = ring.peek(length);
+    assert(frame && length == 10 && frame[0] == 'a');
+    ring.release();
+    assert(ring.claim() && ring.getServed() == 1 && !ring.takeStarved());
+
+    // Frames come out in order, and clear() drops the rest
+    frame = ring.peek(length);
+    assert(frame && length == 11 && frame[0] == 'b');
+    ring.release();
+    ring.clear();
+    assert(ring.empty() && !ring.peek(length));
+    assert(ring.claim());
+    std::cout << "FromRadio ring test passed\n";
+}
+
+void testThreads() {
+    // The PhoneAPI thread and the NimBLE host task on different cores
+    static Ring ring;
+    const uint32_t FRAMES = 200000;
+    std::thread producer([] {
+        for (uint32_t n = 0; n < FRAMES;) {
+            uint8_t *frame = ring.claim();
+            if (!frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            size_t length = 8 + n % 400;
+            memset(frame, (uint8_t)n, length);
+            memcpy(frame, &n, sizeof(n));
+            ring.publish(length);
+            n++;
+        }
+    });
+    for (uint32_t n = 0; n < FRAMES;) {
+        size_t length = 0;
+        const uint8_t *frame = ring.peek(length);
+        if (!frame) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t got;
+        memcpy(&got, frame, sizeof(got));
+        assert(got == n && length == 8 + n % 400 && frame[length - 1] == (uint8_t)n);
+        ring.release();
+        n++;
+    }
+    producer.join();
+    assert(ring.empty() && ring.getServed() == FRAMES);
+    std::cout << "FromRadio ring threads passed\n";
+}
+
+/*
+ * Config download of a node with a full NodeDB, one millisecond steps. The phone has one ATT read outstanding at a time: a
+ * request goes out at a connection event, the answer at the first event after onRead returns, and the next request at the
+ * event after that. Long frames need Read Blob follow-ups, one more round trip per MTU - 1 bytes. The PhoneAPI thread gets
+ * the CPU LOOP_MS after it is woken and takes ENCODE_MS per frame.
+ */
+struct Link {
+    uint32_t intervalMs; // Connection interval
+    uint32_t mtu;
+};
+
+static const uint32_t LOOP_MS = 3, ENCODE_MS = 1, POLL_MS = 20;
+
+static size_t frameLength(uint32_t frame) {
+    // my_info, metadata, 8 channels, config and module config sections, then node infos and the complete id
+    if (frame < 30)
+        return 60 + (frame * 37) % 120;
+    return 150 + (frame * 53) % 110;
+}
+
+static uint32_t roundTrips(size_t length, uint32_t mtu) {
+    uint32_t trips = 1;
+    for (size_t sent = mtu - 1; sent < length; sent += mtu - 1)
+        trips++;
+    return trips;
+}
+
+static uint32_t nextEvent(uint32_t t, uint32_t interval) { return (t / interval + 1) * interval; }
+
+// Before: onRead wakes the PhoneAPI thread and sleeps POLL_MS at a time until it has encoded the frame
+static double replayPolling(uint32_t frames, const Link &link) {
+    uint32_t t = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        uint32_t ready = t + LOOP_MS + ENCODE_MS;
+        uint32_t returned = t;
+        do
+            returned += POLL_MS;
+        while (returned < ready);
+        uint32_t answered = nextEvent(returned, link.intervalMs);
+        answered += (roundTrips(frameLength(frame), link.mtu) - 1) * 2 * link.intervalMs;
+        t = nextEvent(answered, link.intervalMs);
+    }
+    return frames * 1000.0 / t;
+}
+
+// After: onRead answers from the ring, the PhoneAPI thread refills behind it
+static double replayRing(uint32_t frames, const Link &link, uint32_t &starved) {
+    Ring ring;
+    uint32_t t = 0, encoded = 0, producerFree = 0;
+    starved = 0;
+    auto produce = [&](uint32_t until) {
+        // Everything the PhoneAPI thread gets done by then, woken at producerFree
+        uint32_t at = producerFree + LOOP_MS;
+        while (encoded < frames && at + ENCODE_MS <= until) {
+            uint8_t *frame = ring.claim();
+            if (!frame)
+                break;
+            ring.publish(frameLength(encoded++));
+            at += ENCODE_MS;
+        }
+    };
+    produce(0 + LOOP_MS + ENCODE_MS * 4); // want_config was just written
+    for (uint32_t served = 0; served < frames;) {
+        produce(t);
+        size_t length = 0;
+        if (!ring.peek(length)) {
+            // Empty read, the phone waits for the FromNum notify sent once the next frame is in
+            starved++;
+            producerFree = t;
+            produce(t + LOOP_MS + ENCODE_MS);
+            t = nextEvent(t + LOOP_MS + ENCODE_MS, link.intervalMs);
+            continue;
+        }
+        ring.release();
+        served++;
+        producerFree = t;
+        uint32_t answered = nextEvent(t, link.intervalMs);
+        answered += (roundTrips(length, link.mtu) - 1) * 2 * link.intervalMs;
+        t = nextEvent(answered, link.intervalMs);
+    }
+    return frames * 1000.0 / t;
+}
+
+void benchmarkConfigSync() {
+    const uint32_t FRAMES = 30 + 250 + 1; // 250 nodes
+    const struct {
+        const char *name;
+        Link before, after;
+        double gain; // The old poll finished inside one slow connection interval anyway
+    } links[] = {
+        {"Android, 7.5 ms interval", {8, 255}, {8, 517}, 1.8},
+        {"Android, 15 ms interval", {15, 255}, {15, 517}, 1.4},
+        {"iOS, 30 ms interval, MTU 185", {30, 185}, {30, 185}, 1.0},
+    };
+    for (auto &link : links) {
+        uint32_t starved;
+        double before = replayPolling(FRAMES, link.before), after = replayRing(FRAMES, link.after, starved);
+        std::cout << "Config sync of " << FRAMES << " frames, " << link.name << ": " << before << " frames/s before, " << after
+                  << " frames/s after (" << starved << " starved reads)\n";
+        assert(after >= before * link.gain);
+    }
+}
+
+int main() {
+    testRing();
+    testThreads();
+    benchmarkConfigSync();
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "modules/gate/GateAccessCache.h"
+#include "modules/gate/GateAuditRing.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <openssl/evp.h>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_GateAccessCache.cpp -lcrypto
+
+using namespace Gate;
+
+static void pinDigest(const uint8_t *pin, size_t pinLen, const uint8_t *salt, size_t saltLen, uint8_t *digest) {
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
+    EVP_DigestUpdate(ctx, pin, pinLen);
+    EVP_DigestUpdate(ctx, salt, saltLen);
+    EVP_DigestFinal_ex(ctx, digest, nullptr);
+    EVP_MD_CTX_free(ctx);
+}
+
+// Each user's PIN is "12" followed by the low byte of its node id, salted with the node id
+static meshtastic_AccessControl_User makeUser(uint32_t node, uint8_t level, uint64_t from, uint64_t until) {
+    meshtastic_AccessControl_User user = meshtastic_AccessControl_User_init_zero;
+    user.node_id = node;
+    user.access_level = level;
+    user.valid_from = from;
+    user.valid_until = until;
+    uint8_t pin[3] = {'1', '2', (uint8_t)(node & 0xff)};
+    user.pin_salt.size = 4;
+    memcpy(user.pin_salt.bytes, &node, 4);
+    pinDigest(pin, sizeof(pin), user.pin_salt.bytes, user.pin_salt.size, user.pin_hash.bytes);
+    user.pin_hash.size = 32;
+    return user;
+}
+
+void testEvaluate() {
+    AccessCache cache;
+    meshtastic_AccessControl_User op = makeUser(0x1001, LEVEL_OPERATE, 1000, 2000);
+    op.allowed_gates_count = 1;
+    op.allowed_gates[0] = 7;
+    assert(cache.upsert(op));
+    assert(cache.upsert(makeUser(0x1002, LEVEL_ADMIN, 0, 0)));
+
+    uint8_t goodPin[3] = {'1', '2', 0x01};
+    uint8_t badPin[3] = {'1', '2', 0x02};
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, goodPin, 3, true, 1500, pinDigest) == ALLOW);
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, badPin, 3, true, 1500, pinDigest) == DENY_AUTH);
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, goodPin, 2, true, 1500, pinDigest) == DENY_AUTH);
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, goodPin, 3, true, 1500) == DENY_AUTH); // Nothing to hash with
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, nullptr, 0, false, 1500) == ALLOW);
+    assert(cache.evaluate(0x1001, 8, LEVEL_OPERATE, goodPin, 3, true, 1500, pinDigest) == DENY_GATE);
+    assert(cache.evaluate(0x1001, 7, LEVEL_LOCK, goodPin, 3, true, 1500, pinDigest) == DENY_LEVEL);
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, goodPin, 3, true, 999, pinDigest) == DENY_NOT_YET_VALID);
+    assert(cache.evaluate(0x1001, 7, LEVEL_OPERATE, goodPin, 3, true, 2000, pinDigest) == DENY_EXPIRED);
+    assert(cache.evaluate(0x9999, 7, LEVEL_OPERATE, goodPin, 3, true, 1500, pinDigest) == DENY_UNKNOWN_USER);
+
+    // The salt is part of the hash: the same PIN under another user's salt does not match
+    meshtastic_AccessControl_User other = makeUser(0x2001, LEVEL_OPERATE, 0, 0);
+    other.pin_salt.bytes[0] ^= 1;
+    assert(cache.upsert(other));
+    assert(cache.evaluate(0x2001, 7, LEVEL_OPERATE, goodPin, 3, true, 1500, pinDigest) == DENY_AUTH);
+
+    // A pin hash that is not a whole SHA-256 never matches
+    meshtastic_AccessControl_User shortHash = makeUser(0x3001, LEVEL_OPERATE, 0, 0);
+    shortHash.pin_hash.size = 16;
+    assert(cache.upsert(shortHash));
+    assert(cache.evaluate(0x3001, 7, LEVEL_OPERATE, goodPin, 3, true, 1500, pinDigest) == DENY_AUTH);
+    assert(requiredLevel(meshtastic_GateControl_Command_UNLOCK) == LEVEL_LOCK);
+
+    // Revocation through an update with level 0
+    assert(cache.upsert(makeUser(0x1001, LEVEL_NONE, 0, 0)));
+    assert(!cache.find(0x1001));
+    assert(cache.size() == 3);
+    std::cout << "Gate access evaluation test passed\n";
+}
+
+void testExpirySweepKeepsProbeChains() {
+    AccessCache cache;
+    // Fill most of the table so probe chains overlap, half of the users expire at t=500
+    for (uint32_t i = 1; i <= 28; i++) {
+        assert(cache.upsert(makeUser(i * 97, LEVEL_OPERATE, 0, (i % 2) ? 500 : 0)));
+    }
+    assert(cache.size() == 28);
+    assert(cache.getNextExpiry() == 500);
+    assert(cache.expire(499) == 0);
+    assert(cache.expire(500) == 14);
+    assert(cache.getNextExpiry() == AccessCache::NEVER);
+    for (uint32_t i = 1; i <= 28; i++) {
+        assert((cache.find(i * 97) != nullptr) == (i % 2 == 0));
+    }
+
+    // Table keeps one slot free so lookups of absent keys terminate
+    AccessCache full;
+    uint32_t stored = 0;
+    for (uint32_t i = 1; i <= 40; i++) {
+        if (full.upsert(makeUser(i, LEVEL_OPERATE, 0, 0))) stored++;
+    }
+    assert(stored == AccessCache::CAPACITY - 1);
+    assert(!full.find(12345));
+    std::cout << "Gate access expiry test passed\n";
+}
+
+void testAuditRing() {
+    AuditRing ring;
+    for (uint32_t i = 0; i < 5; i++) {
+        AuditRecord r = {1000 + i, 0x1001, 7, 1, 0};
+        ring.append(r);
+    }
+    AuditRecord out[3];
+    assert(ring.peekUnsent(out, 3) == 3);
+    assert(out[0].timestamp == 1000 && out[2].timestamp == 1002);
+    ring.markSent(3);
+    assert(ring.pending() == 2);
+    assert(ring.peekUnsent(out, 3) == 2 && out[0].timestamp == 1003);
+    assert(ring.latest(0)->timestamp == 1004);
+
+    // Wrap: oldest records are overwritten, pending is capped by what is still held
+    for (uint32_t i = 0; i < AuditRing::CAPACITY + 10; i++) {
+        AuditRecord r = {2000 + i, 0x1002, 7, 2, 0};
+        ring.append(r);
+    }
+    assert(ring.size() == AuditRing::CAPACITY && ring.pending() == AuditRing::CAPACITY);
+    assert(ring.peekUnsent(out, 1) == 1 && out[0].timestamp == 2010);
+    assert(ring.overwrittenUnsent() == 12);
+
+    // Gate ids are 32-bit, as in GateConfig
+    AuditRecord wide = {3000, 0x1003, 0x12345678, 1, 0};
+    ring.append(wide);
+    assert(ring.latest(0)->gateId == 0x12345678);
+
+    // Round-trip through the flash image
+    AuditRing reloaded;
+    assert(reloaded.load(ring.raw()));
+    assert(reloaded.pending() == ring.pending() && reloaded.latest(0)->timestamp == ring.latest(0)->timestamp);
+    AuditRing::Image corrupt = ring.raw();
+    corrupt.unsent = AuditRing::CAPACITY + 1;
+    assert(!reloaded.load(corrupt));
+    std::cout << "Gate audit ring test passed, record size " << sizeof(AuditRecord) << " bytes\n";
+}
+
+void benchmarkLookup() {
+    AccessCache cache;
+    for (uint32_t i = 1; i < AccessCache::CAPACITY; i++) {
+        cache.upsert(makeUser(0x10000 + i * 13, LEVEL_OPERATE, 0, 0));
+    }
+    static constexpr int ROUNDS = 100000;
+    auto start = std::chrono::steady_clock::now();
+    int allowed = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+        uint32_t node = 0x10000 + (i % AccessCache::CAPACITY) * 13;
+        allowed += cache.evaluate(node, 1, LEVEL_OPERATE, nullptr, 0, false, 100) == ALLOW;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    assert(allowed > 0);
+    std::cout << "Gate access lookup: " << elapsed / (double)ROUNDS << " ns per decision on a full table\n";
+}
+
+int main() {
+    testEvaluate();
+    testExpirySweepKeepsProbeChains();
+    testAuditRing();
+    benchmarkLookup();
+    return 0;
+}
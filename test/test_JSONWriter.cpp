@@ -0,0 +1,227 @@
+#include "serialization/JSON.h"
+#include "serialization/JSONWriter.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_JSONWriter.cpp src/serialization/JSON.cpp src/serialization/JSONValue.cpp
+
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+// Stands in for the HTTPResponse
+struct Sink {
+    std::string body;
+    size_t writes = 0;
+    size_t write(const uint8_t *buf, size_t len)
+    {
+        body.append((const char *)buf, len);
+        writes++;
+        return len;
+    }
+};
+
+// The parts of NodeInfoLite that /json/nodes shows
+struct Node {
+    uint32_t num;
+    float snr;
+    bool via_mqtt;
+    uint32_t last_heard;
+    bool hasPosition;
+    int32_t latitude_i, longitude_i, altitude;
+    char long_name[40], short_name[5];
+    uint8_t macaddr[6];
+    int hw_model;
+};
+
+static Node makeNode(uint32_t i, bool utf8 = false) {
+    Node n = {};
+    n.num = 0x10000000 + i * 7919;
+    n.snr = -20.0f + (i % 80) * 0.25f;
+    n.via_mqtt = i % 5 == 0;
+    n.last_heard = 1760000000 + i * 60;
+    n.hasPosition = i % 3 != 0;
+    n.latitude_i = 450000000 + i * 1234;
+    n.longitude_i = -930000000 - i * 4321;
+    n.altitude = 200 + i % 50;
+    snprintf(n.long_name, sizeof(n.long_name), "Gate %u \"north\" / pump\t%s", i, utf8 ? "\xc3\xa9t\xc3\xa9" : "");
+    snprintf(n.short_name, sizeof(n.short_name), "G%03u", i % 1000);
+    for (int b = 0; b < 6; b++)
+        n.macaddr[b] = (i * 31 + b) & 0xff;
+    n.hw_model = i % 100;
+    return n;
+}
+
+// handleNodes() before, less its double delete of the nodes
+static std::string withJSONValues(const Node *nodes, size_t count) {
+    JSONArray nodesArray;
+    for (size_t i = 0; i < count; i++) {
+        const Node *tempNodeInfo = &nodes[i];
+        JSONObject node;
+
+        char id[16];
+        snprintf(id, sizeof(id), "!%08x", tempNodeInfo->num);
+
+        node["id"] = new JSONValue(id);
+        node["snr"] = new JSONValue(tempNodeInfo->snr);
+        node["via_mqtt"] = new JSONValue(tempNodeInfo->via_mqtt ? "true" : "false");
+        node["last_heard"] = new JSONValue((int)tempNodeInfo->last_heard);
+        if (tempNodeInfo->hasPosition) {
+            JSONObject position;
+            position["latitude"] = new JSONValue((float)tempNodeInfo->latitude_i * 1e-7);
+            position["longitude"] = new JSONValue((float)tempNodeInfo->longitude_i * 1e-7);
+            position["altitude"] = new JSONValue((int)tempNodeInfo->altitude);
+            node["position"] = new JSONValue(position);
+        } else {
+            node["position"] = new JSONValue();
+        }
+        node["long_name"] = new JSONValue(tempNodeInfo->long_name);
+        node["short_name"] = new JSONValue(tempNodeInfo->short_name);
+        char macStr[18];
+        snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X", tempNodeInfo->macaddr[0], tempNodeInfo->macaddr[1],
+                 tempNodeInfo->macaddr[2], tempNodeInfo->macaddr[3], tempNodeInfo->macaddr[4], tempNodeInfo->macaddr[5]);
+        node["mac_address"] = new JSONValue(macStr);
+        node["hw_model"] = new JSONValue(tempNodeInfo->hw_model);
+
+        nodesArray.push_back(new JSONValue(node));
+    }
+
+    JSONObject jsonObjInner;
+    jsonObjInner["nodes"] = new JSONValue(nodesArray);
+    JSONObject jsonObjOuter;
+    jsonObjOuter["data"] = new JSONValue(jsonObjInner);
+    jsonObjOuter["status"] = new JSONValue("ok");
+    JSONValue *value = new JSONValue(jsonObjOuter);
+    std::string jsonString = value->Stringify();
+    delete value; // Which also deletes every node, the handler deleted them a second time
+    return jsonString;
+}
+
+// handleNodes() now
+static void withWriter(const Node *nodes, size_t count, Sink &sink) {
+    JSONWriter<Sink> json(sink);
+    json.beginObject().key("data").beginObject().key("nodes").beginArray();
+    for (size_t i = 0; i < count; i++) {
+        const Node *tempNodeInfo = &nodes[i];
+        char id[16];
+        snprintf(id, sizeof(id), "!%08x", tempNodeInfo->num);
+        char macStr[18];
+        snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X", tempNodeInfo->macaddr[0], tempNodeInfo->macaddr[1],
+                 tempNodeInfo->macaddr[2], tempNodeInfo->macaddr[3], tempNodeInfo->macaddr[4], tempNodeInfo->macaddr[5]);
+
+        json.beginObject();
+        json.key("hw_model").value(tempNodeInfo->hw_model);
+        json.key("id").value(id);
+        json.key("last_heard").value((int)tempNodeInfo->last_heard);
+        json.key("long_name").value(tempNodeInfo->long_name);
+        json.key("mac_address").value(macStr);
+        json.key("position");
+        if (tempNodeInfo->hasPosition) {
+            json.beginObject();
+            json.key("altitude").value((int)tempNodeInfo->altitude);
+            json.key("latitude").value((float)tempNodeInfo->latitude_i * 1e-7);
+            json.key("longitude").value((float)tempNodeInfo->longitude_i * 1e-7);
+            json.endObject();
+        } else {
+            json.null();
+        }
+        json.key("short_name").value(tempNodeInfo->short_name);
+        json.key("snr").value(tempNodeInfo->snr);
+        json.key("via_mqtt").value(tempNodeInfo->via_mqtt ? "true" : "false");
+        json.endObject();
+    }
+    json.endArray().endObject().key("status").value("ok").endObject();
+    json.flush();
+}
+
+void testWriter() {
+    Sink sink;
+    {
+        JSONWriter<Sink, 32> json(sink);
+        json.beginArray().value(1).value(-2.5).null().beginObject().key("a/b").value("x\n\x01").endObject();
+        json.beginArray().endArray().value(1.0 / 0.0).endArray();
+    } // Flushed by the destructor
+    assert(sink.body == "[1,-2.5,null,{\"a\\/b\":\"x\\n\\u0001\"},[],null]");
+    assert(sink.writes == 2); // 32 bytes, then the rest
+
+    sink = Sink();
+    Node node = makeNode(4, true);
+    JSONWriter<Sink>(sink).value(node.long_name);
+    assert(sink.body == "\"Gate 4 \\\"north\\\" \\/ pump\\t\xc3\xa9t\xc3\xa9\"");
+    std::cout << "JSON writer test passed\n";
+}
+
+void testSameAsJSONValue() {
+    const size_t COUNT = 60;
+    Node nodes[COUNT];
+    for (size_t i = 0; i < COUNT; i++)
+        nodes[i] = makeNode(i);
+    nodes[7].long_name[0] = '\0';
+    nodes[8].snr = 0.1f; // Not exact as a double
+    // JSONValue only gets UTF-8 right where char is unsigned, so that is checked on its own below
+
+    for (size_t count : {(size_t)0, (size_t)1, COUNT}) {
+        Sink sink;
+        withWriter(nodes, count, sink);
+        assert(sink.body == withJSONValues(nodes, count));
+    }
+    std::cout << "JSON writer matches JSONValue::Stringify\n";
+}
+
+void benchmarkNodeList() {
+    const size_t COUNT = 250, ROUNDS = 200;
+    static Node nodes[COUNT];
+    for (size_t i = 0; i < COUNT; i++)
+        nodes[i] = makeNode(i);
+
+    size_t allocsBefore = allocations;
+    auto started = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (size_t r = 0; r < ROUNDS; r++)
+        bytes = withJSONValues(nodes, COUNT).size();
+    double before = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count() / ROUNDS;
+    size_t beforeAllocs = (allocations - allocsBefore) / ROUNDS;
+
+    Sink sink;
+    sink.body.reserve(bytes);
+    allocsBefore = allocations;
+    started = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < ROUNDS; r++) {
+        sink.body.clear();
+        sink.writes = 0;
+        withWriter(nodes, COUNT, sink);
+    }
+    double after = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count() / ROUNDS;
+    size_t afterAllocs = (allocations - allocsBefore) / ROUNDS;
+
+    std::cout << "/json/nodes with " << COUNT << " nodes (" << bytes << " bytes): JSONValue tree " << before << " ms, "
+              << beforeAllocs << " allocations, whole body held at once; JSONWriter " << after << " ms, " << afterAllocs
+              << " allocations, " << sink.writes << " writes of at most 512 bytes\n";
+    assert(after < before && afterAllocs == 0);
+}
+
+int main() {
+    testWriter();
+    testSameAsJSONValue();
+    benchmarkNodeList();
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "mesh/KeyCache.h"
+#include "platform/nrf52/aes-256/tiny-aes.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <openssl/evp.h>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_KeyCache.cpp src/platform/nrf52/aes-256/tiny-aes.cpp -lcrypto
+// Run with OPENSSL_ia32cap="~0x200000200000000" to see OpenSSL without AES-NI.
+
+struct Schedule {
+    int derivedFrom = 0;
+};
+
+void testKeyCache() {
+    KeyCache<Schedule, 3> cache;
+    uint8_t keys[4][32];
+    for (int i = 0; i < 4; i++)
+        memset(keys[i], i + 1, sizeof(keys[i]));
+
+    assert(!cache.find(keys[0], 32));
+    cache.insert(keys[0], 32).derivedFrom = 1;
+    cache.insert(keys[1], 16).derivedFrom = 2;
+    cache.insert(keys[2], 32).derivedFrom = 3;
+    assert(cache.find(keys[0], 32)->derivedFrom == 1);
+    assert(!cache.find(keys[1], 32) && cache.find(keys[1], 16)->derivedFrom == 2); // Same bytes, other key length
+
+    // keys[2] is now the least recently used, its slot goes to keys[3] with the old value for rekeying
+    Schedule &reused = cache.insert(keys[3], 32);
+    assert(reused.derivedFrom == 3);
+    reused.derivedFrom = 4;
+    assert(!cache.find(keys[2], 32) && cache.find(keys[3], 32)->derivedFrom == 4);
+    assert(cache.find(keys[0], 32) && cache.find(keys[1], 16));
+
+    cache.remove(keys[3], 32);
+    assert(!cache.find(keys[3], 32) && cache.find(keys[0], 32));
+    cache.clear();
+    assert(!cache.find(keys[0], 32) && !cache.find(keys[1], 16));
+    assert(cache.getHits() == 6 && cache.getMisses() == 6);
+    std::cout << "Key cache test passed\n";
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double microseconds(Clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - since).count();
+}
+
+// A gateway decrypting a busy mix of three AES256 channels
+struct Workload {
+    static const int CHANNELS = 3, PACKETS = 30000;
+    uint8_t keys[CHANNELS][32];
+    uint8_t packet[256];
+
+    Workload() {
+        for (int c = 0; c < CHANNELS; c++)
+            for (int i = 0; i < 32; i++)
+                keys[c][i] = c * 37 + i;
+    }
+
+    static void nonce(uint8_t *out, int packet) {
+        // initNonce(): packet id, sender, zero block counter
+        memset(out, 0, 16);
+        memcpy(out, &packet, sizeof(packet));
+        out[8] = 0x29;
+        out[9] = 0x09;
+    }
+};
+
+// Portable software AES expanded per packet, what portduino did through the Crypto library
+static double portable(Workload &w, size_t size, uint8_t *check) {
+    uint8_t iv[16];
+    auto started = Clock::now();
+    for (int p = 0; p < Workload::PACKETS; p++) {
+        AES_ctx ctx;
+        Workload::nonce(iv, p);
+        AES_init_ctx_iv(&ctx, w.keys[p % Workload::CHANNELS], iv);
+        AES_CTR_xcrypt_buffer(&ctx, w.packet, size);
+    }
+    memcpy(check, w.packet, size);
+    return microseconds(started) / Workload::PACKETS;
+}
+
+// OpenSSL keyed per packet, like ESP32CryptoEngine did with mbedtls_aes_setkey_enc
+static double rekeyed(Workload &w, size_t size, uint8_t *check) {
+    uint8_t iv[16];
+    int out;
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    auto started = Clock::now();
+    for (int p = 0; p < Workload::PACKETS; p++) {
+        Workload::nonce(iv, p);
+        EVP_EncryptInit_ex(ctx, EVP_aes_256_ctr(), nullptr, w.keys[p % Workload::CHANNELS], iv);
+        EVP_EncryptUpdate(ctx, w.packet, &out, w.packet, size);
+    }
+    double us = microseconds(started) / Workload::PACKETS;
+    EVP_CIPHER_CTX_free(ctx);
+    memcpy(check, w.packet, size);
+    return us;
+}
+
+// PortduinoCryptoEngine: one keyed context per channel, only the IV is set per packet
+static double cached(Workload &w, size_t size, uint8_t *check) {
+    KeyCache<EVP_CIPHER_CTX *, 8> contexts;
+    uint8_t iv[16];
+    int out;
+    auto started = Clock::now();
+    for (int p = 0; p < Workload::PACKETS; p++) {
+        const uint8_t *key = w.keys[p % Workload::CHANNELS];
+        EVP_CIPHER_CTX **ctx = contexts.find(key, 32);
+        if (!ctx) {
+            ctx = &contexts.insert(key, 32);
+            if (!*ctx)
+                *ctx = EVP_CIPHER_CTX_new();
+            EVP_EncryptInit_ex(*ctx, EVP_aes_256_ctr(), nullptr, key, nullptr);
+        }
+        Workload::nonce(iv, p);
+        EVP_EncryptInit_ex(*ctx, nullptr, nullptr, nullptr, iv);
+        EVP_EncryptUpdate(*ctx, w.packet, &out, w.packet, size);
+    }
+    double us = microseconds(started) / Workload::PACKETS;
+    for (size_t i = 0; i < contexts.size(); i++)
+        EVP_CIPHER_CTX_free(contexts.at(i));
+    memcpy(check, w.packet, size);
+    return us;
+}
+
+void benchmarkChannelDecrypt() {
+    const size_t sizes[] = {32, 128, 237};
+    for (size_t size : sizes) {
+        uint8_t a[256], b[256], c[256];
+        Workload w1, w2, w3;
+        memset(w1.packet, 0x5a, sizeof(w1.packet));
+        memcpy(w2.packet, w1.packet, sizeof(w1.packet));
+        memcpy(w3.packet, w1.packet, sizeof(w1.packet));
+        double before = portable(w1, size, a), rekey = rekeyed(w2, size, b), after = cached(w3, size, c);
+        // All three are the same cipher
+        assert(memcmp(a, b, size) == 0 && memcmp(b, c, size) == 0);
+        std::cout << size << " byte packets, 3 AES256 channels: portable AES " << before << " us/packet ("
+                  << size / before << " MB/s), OpenSSL rekeyed per packet " << rekey << " us (" << size / rekey
+                  << " MB/s), OpenSSL with cached keys " << after << " us (" << size / after << " MB/s)\n";
+        assert(after < before && after < rekey);
+    }
+}
+
+int main() {
+    testKeyCache();
+    benchmarkChannelDecrypt();
+    return 0;
+}
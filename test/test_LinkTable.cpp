@@ -0,0 +1,260 @@
+#include "mesh/LinkTable.h"
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_LinkTable.cpp src/mesh/LinkTable.cpp
+
+static uint64_t rngState = 0x2545f4914f6cdd1dULL;
+
+// splitmix64, so loss patterns don't correlate between neighbors
+static uint64_t nextRandom() {
+    uint64_t z = (rngState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static double uniform() {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double gaussian() {
+    return std::sqrt(-2 * std::log(uniform() + 1e-12)) * std::cos(2 * M_PI * uniform());
+}
+
+// A neighbor as we hear it: link loss and fading
+struct Neighbor {
+    uint32_t num;
+    double loss;
+    double snr;
+    double fading;
+
+    // Sends one packet, @return true if we heard it
+    bool send(LinkTable &table, uint32_t nowMs) {
+        if (uniform() < loss) return false;
+        float sample = snr + fading * gaussian();
+        table.heard(num, 0, true, sample, -100 + (int32_t)sample, nowMs);
+        return true;
+    }
+
+    // We hand it a packet as next hop and retransmit until we hear it relay, at most 3 tries
+    void relay(LinkTable &table) {
+        for (int tries = 0; tries < 3; tries++) {
+            bool ok = uniform() >= loss;
+            table.delivered(LinkTable::relayByte(num), ok);
+            if (ok) return;
+        }
+    }
+};
+
+void testSmoothing() {
+    LinkTable table;
+    Neighbor n = {0x1234abcd, 0.0, -6.0, 3.0};
+    double worstRaw = 0, worstSmoothed = 0;
+    for (uint32_t t = 0; t < 400; t++) {
+        n.send(table, t * 1000);
+        const LinkTable::Link *link = table.find(n.num);
+        if (t >= 40) worstSmoothed = std::max(worstSmoothed, std::fabs(link->snr - n.snr));
+    }
+    // A single frame is off by as much as the fading
+    for (int i = 0; i < 400; i++) worstRaw = std::max(worstRaw, std::fabs(n.fading * gaussian()));
+    assert(worstSmoothed < 3 && worstSmoothed < worstRaw / 2);
+    // Frames alone say nothing about delivery
+    const LinkTable::Link *link = table.find(n.num);
+    assert(link->frames == 400 && link->deliveries == 0 && link->pdr == 1.0f);
+    printf("Link table smoothing test passed, SNR off by up to %.1f dB against %.1f dB for one frame\n", worstSmoothed,
+           worstRaw);
+}
+
+void testDeliveryRatio() {
+    const double losses[] = {0.05, 0.3, 0.6, 0.85};
+    printf("Delivery ratio from implicit ACKs and retransmissions, 2000 packets handed on each:\n");
+    for (double loss : losses) {
+        LinkTable table;
+        Neighbor n = {0x42000001, loss, 0.0, 0.0};
+        table.heard(n.num, 0, true, 0, -100, 0);
+        double sum = 0;
+        int samples = 0;
+        for (uint32_t t = 0; t < 2000; t++) {
+            n.relay(table);
+            const LinkTable::Link *link = table.find(n.num);
+            if (t >= 100) {
+                sum += link->pdr;
+                samples++;
+            }
+        }
+        double mean = sum / samples;
+        printf("  %2.0f%% loss  pdr %.2f\n", loss * 100, mean);
+        assert(std::fabs(mean - (1 - loss)) < 0.05);
+    }
+
+    // A next hop whose packet ids skip, as a node's do when it numbers packets that never go on air (phone replies, local
+    // stats, admin), but which relays everything we hand it
+    LinkTable table;
+    for (uint32_t t = 0; t < 200; t++) {
+        table.heard(0x42000007, 0, true, 0, -90, t * 1000);
+        table.delivered(0x07, true);
+    }
+    const LinkTable::Link *link = table.find(0x42000007);
+    assert(link->frames == 200 && link->pdr == 1.0f && LinkTable::isUsable(*link, 200 * 1000));
+    std::cout << "Link table delivery ratio test passed\n";
+}
+
+void testRelays() {
+    LinkTable table;
+    // Frames relayed by a node we have not heard first hand can't be credited
+    assert(!table.heard(0x1111, 0xcd, false, 3, -80, 0));
+    table.heard(0xaabbcd, 0, true, 8, -70, 0);
+    const LinkTable::Link *link = table.heard(0x1111, 0xcd, false, 0, -70, 1);
+    assert(link && link->num == 0xaabbcd && link->frames == 2 && link->snr < 8);
+    assert(table.transmitter(0x1111, 0xcd, false) == link && table.find(0xaabbcd) == link);
+    // Old firmware sends no relay byte
+    assert(!table.heard(0x1111, 0, false, 3, -80, 2));
+
+    // Two neighbors ending in the same byte: the one heard last is the better guess
+    table.heard(0x5500cd, 0, true, -10, -110, 10);
+    assert(table.findByRelay(0xcd)->num == 0x5500cd);
+    table.heard(0xaabbcd, 0, true, 8, -70, 20);
+    assert(table.findByRelay(0xcd)->num == 0xaabbcd);
+
+    // A low byte of 0 is stamped as 0xff
+    table.heard(0x777700, 0, true, 1, -90, 30);
+    assert(table.findByRelay(0xff) && table.findByRelay(0xff)->num == 0x777700);
+
+    // NeighborInfo teaches us the number behind a relay byte
+    assert(!table.findByRelay(0x42));
+    table.noteNeighborInfo(0x99999942, 0, -3, -95, 40);
+    assert(table.findByRelay(0x42)->num == 0x99999942 && table.findByRelay(0x42)->frames == 1);
+    std::cout << "Link table relay test passed\n";
+}
+
+void testUsableAndCollect() {
+    LinkTable table;
+    table.heard(0x101, 0, true, 5, -80, 0);
+    const LinkTable::Link *link = table.find(0x101);
+    assert(LinkTable::isUsable(*link, 1000));
+    // A next hop that stops relaying what we hand it
+    for (int i = 0; i < 12; i++) table.delivered(0x01, false);
+    assert(!LinkTable::isUsable(*link, 1000));
+    // and comes back
+    for (int i = 0; i < 12; i++) table.delivered(0x01, true);
+    assert(LinkTable::isUsable(*link, 1000));
+    assert(!LinkTable::isUsable(*link, LinkTable::STALE_MS + 1));
+    // Across the millis() rollover
+    table.heard(0x200, 0, true, 5, -80, 0xfffff000u);
+    assert(LinkTable::isUsable(*table.find(0x200), 0x1000));
+
+    // collect(): heard within twice the interval, best ratio first
+    LinkTable many;
+    for (uint32_t i = 1; i <= 20; i++) {
+        Neighbor n = {i << 8 | i, 0.05 * (i % 10), (double)i, 0.0};
+        for (int k = 0; k < 200; k++) {
+            n.send(many, 1000);
+            n.relay(many);
+        }
+    }
+    many.noteNeighborInfo(0x300, 60, 0, -90, 1000); // Says it sends every minute, so gone after two
+    const LinkTable::Link *best[10];
+    size_t count = many.collect(best, 10, 900, 1000);
+    assert(count == 10);
+    for (size_t i = 1; i < count; i++) assert(best[i - 1]->pdr >= best[i]->pdr);
+    assert(best[0]->pdr > 0.95f && best[9]->pdr > 0.7f);
+    assert(many.collect(best, 10, 900, 1000 + 121 * 1000) == 10);
+    bool hasShort = false;
+    for (size_t i = 0; i < 10; i++) hasShort |= best[i]->num == 0x300;
+    assert(!hasShort);
+    assert(many.collect(best, 10, 900, 1000 + 1801 * 1000) == 0);
+    std::cout << "Link table usable/collect test passed\n";
+}
+
+void testCapacity() {
+    LinkTable table;
+    for (uint32_t i = 1; i <= 200; i++) table.heard(0x10000 + i * 7919, 0, true, 0, -90, i * 100);
+    assert(table.size() <= LinkTable::SLOTS && table.size() > LinkTable::SLOTS * 3 / 4);
+    assert(table.getEvictions() == 200 - table.size());
+    // Whoever was heard last is still there
+    assert(table.find(0x10000 + 200 * 7919) && table.find(0x10000 + 199 * 7919));
+    table.clear();
+    assert(table.size() == 0 && !table.find(0x10000 + 200 * 7919));
+    std::cout << "Link table capacity test passed\n";
+}
+
+// What NeighborInfoModule kept before: a vector searched front to back, the oldest dropped once it held 10
+struct VectorNeighbors {
+    struct Entry {
+        uint32_t num;
+        float snr;
+        uint32_t lastRx;
+    };
+    std::vector<Entry> entries;
+    const Entry *heard(uint32_t num, float snr, uint32_t now) {
+        for (Entry &e : entries) {
+            if (e.num == num) {
+                e.snr = snr;
+                e.lastRx = now;
+                return &e;
+            }
+        }
+        if (entries.size() >= 10) entries.erase(entries.begin());
+        entries.push_back({num, snr, now});
+        return &entries.back();
+    }
+};
+
+void benchmarkLookups() {
+    const int FRAMES = 2000000;
+    printf("Per frame heard / per next hop query, %d of each:\n", FRAMES);
+    const uint32_t counts[] = {8, 24};
+    for (uint32_t neighbors : counts) {
+        std::vector<uint32_t> nums;
+        for (uint32_t i = 0; i < neighbors; i++) nums.push_back(0x7a000000 + (uint32_t)(nextRandom() & 0xffffff));
+        std::vector<uint32_t> order;
+        for (int i = 0; i < 4096; i++) order.push_back(nums[nextRandom() % neighbors]);
+        float sink = 0;
+
+        VectorNeighbors old;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; i++) sink += old.heard(order[i & 4095], (float)(i & 15), i)->snr;
+        double oldHeard = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; i++) {
+            for (const VectorNeighbors::Entry &e : old.entries) {
+                if (e.num == order[i & 4095]) {
+                    sink += e.snr;
+                    break;
+                }
+            }
+        }
+        double oldQuery = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+        LinkTable table;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; i++) sink += table.heard(order[i & 4095], 0, true, (float)(i & 15), -90, i)->snr;
+        double tableHeard = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; i++) {
+            const LinkTable::Link *link = table.findByRelay(LinkTable::relayByte(order[i & 4095]));
+            sink += link && LinkTable::isUsable(*link, FRAMES) ? link->snr : 0;
+        }
+        double tableQuery = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+        printf("  %2u neighbors  vector %5.1f / %4.1f ns, %u kept, last SNR only\n", neighbors, oldHeard, oldQuery,
+               (unsigned)old.entries.size());
+        printf("                link table %5.1f / %4.1f ns, %u kept, EWMA SNR/RSSI and PDR, by relay byte%s\n", tableHeard,
+               tableQuery, (unsigned)table.size(), sink != 0 ? "" : " ");
+    }
+}
+
+int main() {
+    testSmoothing();
+    testDeliveryRatio();
+    testRelays();
+    testUsableAndCollect();
+    testCapacity();
+    benchmarkLookups();
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "LogQueue.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+typedef LogQueue<8, 96> Queue;
+
+static bool push(Queue &q, const char *format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    bool ok = q.push("DEBUG", format, "Router", 1234, arg);
+    va_end(arg);
+    return ok;
+}
+
+static std::string popText(Queue &q) {
+    Queue::Record r;
+    assert(q.pop(r));
+    char buf[160];
+    Queue::format(r, buf, sizeof(buf));
+    return buf;
+}
+
+void testFormatMatchesPrintf() {
+    Queue q;
+    char name[16];
+    strcpy(name, "stack string");
+    assert(push(q, "id=0x%08x fr=0x%x to=0x%x hop=%d/%d", 0xdeadbeef, 0x1234, 0xffffffffu, 3, 7));
+    assert(push(q, "%s: %.*s|%-6s|%5.2f%% %c", name, 3, "abcdef", "ab", 12.345, 'Z'));
+    strcpy(name, "overwritten"); // The queued copy must not change
+    assert(push(q, "%lu %lld %zu %ld %u", 4000000000UL, -5LL, (size_t)77, -9L, 10u));
+    assert(push(q, "null %s", (const char *)nullptr));
+
+    assert(popText(q) == "id=0xdeadbeef fr=0x1234 to=0xffffffff hop=3/7");
+    assert(popText(q) == "stack string: abc|ab    |12.35% Z");
+    assert(popText(q) == "4000000000 -5 77 -9 10");
+    assert(popText(q) == "null (null)");
+    Queue::Record r;
+    assert(!q.pop(r) && q.empty());
+
+    // Unsupported conversions are refused so the caller can log synchronously
+    assert(!push(q, "bad %n"));
+    assert(!q.pop(r)); // and the claimed slot is skipped
+
+    // Long strings are truncated to the space the format leaves
+    std::string longText(300, 'x');
+    assert(push(q, "%s!", longText.c_str()));
+    std::string text = popText(q);
+    assert(text.size() == 96 - sizeof("%s!") && text.back() == '!');
+
+    // The format is copied too, callers free or reuse their buffers straight after
+    char *format = new char[32];
+    strcpy(format, "built %d");
+    assert(push(q, format, 1));
+    strcpy(format, "reused %d %s");
+    delete[] format;
+    assert(popText(q) == "built 1");
+    // and one that does not fit is left to the caller
+    std::string longFormat(120, 'f');
+    assert(!push(q, longFormat.c_str()));
+    assert(!q.pop(r));
+    std::cout << "Log queue format test passed\n";
+}
+
+void testOverflowCountsDrops() {
+    Queue q;
+    for (int i = 0; i < 12; i++) {
+        assert(push(q, "msg %d", i));
+    }
+    assert(q.takeDropped() == 4);
+    assert(q.takeDropped() == 0);
+    assert(popText(q) == "msg 0");
+    assert(push(q, "msg %d", 99)); // Freed slot is reused
+    for (int i = 1; i < 8; i++) {
+        popText(q);
+    }
+    assert(popText(q) == "msg 99");
+    std::cout << "Log queue overflow test passed\n";
+}
+
+typedef LogQueue<64, 32> SmallQueue;
+
+static void pushFrom(SmallQueue &q, const char *format, ...) {
+    va_list arg;
+    va_start(arg, format);
+    q.push("DEBUG", format, nullptr, 0, arg);
+    va_end(arg);
+}
+
+void testConcurrentProducers() {
+    static SmallQueue q;
+    static constexpr int PER_THREAD = 20000;
+    std::atomic<int> running{2};
+    auto producer = [&running](int id) {
+        for (int i = 0; i < PER_THREAD; i++) {
+            pushFrom(q, "%d %d", id, i);
+        }
+        running--;
+    };
+    std::thread a(producer, 0), b(producer, 1);
+
+    uint32_t received = 0;
+    int lastSeen[2] = {-1, -1};
+    SmallQueue::Record r;
+    char buf[32];
+    while (true) {
+        bool finished = running == 0; // Checked before draining so nothing pushed before it is missed
+        while (q.pop(r)) {
+            SmallQueue::format(r, buf, sizeof(buf));
+            int id, i;
+            assert(sscanf(buf, "%d %d", &id, &i) == 2);
+            assert(i > lastSeen[id]); // Order per producer is kept
+            lastSeen[id] = i;
+            received++;
+        }
+        if (finished)
+            break;
+        std::this_thread::yield();
+    }
+    a.join();
+    b.join();
+    uint32_t dropped = q.takeDropped();
+    assert(received + dropped == 2 * PER_THREAD);
+    std::cout << "Log queue concurrency test passed, " << received << " received, " << dropped << " dropped\n";
+}
+
+void benchmarkHotPath() {
+    static constexpr int ROUNDS = 200000;
+    static Queue q;
+    Queue::Record r;
+    char buf[160];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        push(q, "Received routing from=0x%x, id=0x%x, portnum=%d, payloadlen=%d", 0x1234u, (unsigned)i, 5, 17);
+        q.pop(r); // Keep the queue from filling, not timed separately
+    }
+    auto queued = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        snprintf(buf, sizeof(buf), "Received routing from=0x%x, id=0x%x, portnum=%d, payloadlen=%d", 0x1234u, (unsigned)i, 5,
+                 17);
+        for (size_t f = 0; buf[f]; f++) {
+            if (!isprint((unsigned char)buf[f]))
+                buf[f] = '#';
+        }
+    }
+    auto formatted = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Log call cost: " << queued / (double)ROUNDS << " ns to queue (push + pop), " << formatted / (double)ROUNDS
+              << " ns to format in place (before any serial/BLE write)\n";
+}
+
+int main() {
+    testFormatMatchesPrintf();
+    testOverflowCountsDrops();
+    testConcurrentProducers();
+    benchmarkHotPath();
+    return 0;
+}
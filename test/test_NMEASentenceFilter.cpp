@@ -0,0 +1,239 @@
+#include "gps/NMEASentenceFilter.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Stands in for TinyGPSPlus: checks the checksum and splits terms on every character it is given, which is where its time
+// goes, and reports an update at the end of each RMC/GGA like encode() does
+struct TokenizingReader {
+    uint32_t updates = 0;
+    char term[16];
+    uint8_t termLength = 0, termNumber = 0, parity = 0;
+    bool inChecksum = false, isUpdate = false;
+    uint32_t terms = 0;
+    bool record = true; // Keep what was encoded, off for the benchmark
+    std::vector<std::string> sentences;
+    std::string current;
+
+    bool encode(char c) {
+        switch (c) {
+        case ',':
+            parity ^= (uint8_t)c;
+        // fallthrough
+        case '\r':
+        case '\n':
+        case '*': {
+            bool valid = false;
+            if (termLength < sizeof(term)) {
+                term[termLength] = 0;
+                if (termNumber == 0)
+                    isUpdate = !strcmp(term + 2, "RMC") || !strcmp(term + 2, "GGA");
+                terms++;
+                if (inChecksum && termLength == 2)
+                    valid = strtol(term, nullptr, 16) == parity && isUpdate;
+                updates += valid;
+            }
+            if (c == '*')
+                inChecksum = true;
+            termNumber++;
+            termLength = 0;
+            if (c == '\r' && record && !current.empty()) {
+                sentences.push_back(current);
+                current.clear();
+            }
+            return valid;
+        }
+        case '$':
+            termNumber = termLength = parity = 0;
+            inChecksum = isUpdate = false;
+            if (record)
+                current = "$";
+            return false;
+        default:
+            if (termLength < sizeof(term) - 1)
+                term[termLength++] = c;
+            if (!inChecksum)
+                parity ^= (uint8_t)c;
+            if (record && !current.empty())
+                current += c;
+            return false;
+        }
+    }
+
+    std::vector<std::string> seen;
+    void sentence(const char *s, size_t len) { seen.push_back(std::string(s, len)); }
+};
+
+static std::string withChecksum(const std::string &body) {
+    uint8_t sum = 0;
+    for (size_t i = 1; i < body.size(); i++)
+        sum ^= (uint8_t)body[i];
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+    return body + tail;
+}
+
+// One 10 Hz epoch from a u-blox M8N on a pivot: the three sentences we read and everything else it sends by default
+static std::string sampleEpoch(int tenth) {
+    char time[16];
+    snprintf(time, sizeof(time), "1532%02d.%d0", tenth / 10 % 60, tenth % 10);
+    std::string t(time), out;
+    out += withChecksum("$GNRMC," + t + ",A,4452.12345,N,09312.54321,W,0.012,,181026,,,D");
+    out += withChecksum("$GNVTG,,T,,M,0.012,N,0.022,K,D");
+    out += withChecksum("$GNGGA," + t + ",4452.12345,N,09312.54321,W,2,12,0.78,287.4,M,-31.2,M,,0000");
+    out += withChecksum("$GNGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.32,0.78,1.06");
+    out += withChecksum("$GNGSA,A,3,67,68,77,78,,,,,,,,,1.32,0.78,1.06");
+    out += withChecksum("$GPGSV,4,1,14,05,45,293,43,13,30,229,40,15,67,123,46,18,21,051,38");
+    out += withChecksum("$GPGSV,4,2,14,20,43,300,44,23,16,176,35,24,62,083,47,29,11,317,31");
+    out += withChecksum("$GPGSV,4,3,14,10,02,013,,26,01,247,,46,33,203,39,48,30,217,40");
+    out += withChecksum("$GPGSV,4,4,14,51,34,210,41,02,05,072,");
+    out += withChecksum("$GLGSV,2,1,07,67,52,052,43,68,58,270,41,77,35,117,39,78,69,348,40");
+    out += withChecksum("$GLGSV,2,2,07,79,23,309,,69,06,240,,88,01,031,");
+    out += withChecksum("$GNGLL,4452.12345,N,09312.54321,W," + t + ",A,D");
+    return out;
+}
+
+void testFiltering() {
+    NMEASentenceFilter filter;
+    filter.want("RMC");
+    filter.want("GGA");
+    filter.want("GSA");
+    filter.watch("TXT");
+    TokenizingReader reader;
+
+    std::string epoch = sampleEpoch(0);
+    std::string banner = withChecksum("$GPTXT,01,01,02,u-blox ag - www.u-blox.com");
+    const uint8_t ubxAck[] = {0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x01, 0x0F, 0x38};
+    std::string stream = banner + std::string((const char *)ubxAck, sizeof(ubxAck)) + epoch;
+
+    bool updated = filter.feed((const uint8_t *)stream.data(), stream.size(), reader);
+    assert(updated);
+    assert(filter.getPassed() == 4 && filter.getSkipped() == 9 && filter.getGarbled() == 0);
+    assert(reader.seen.size() == 1 && reader.seen[0] == banner.substr(0, banner.size() - 2));
+    assert(reader.sentences.size() == 4);
+    assert(reader.sentences[0].compare(0, 6, "$GNRMC") == 0 && reader.sentences[3].compare(0, 6, "$GNGSA") == 0);
+
+    // Byte at a time gives the same result as one big chunk
+    NMEASentenceFilter single;
+    single.want("RMC");
+    single.want("GGA");
+    single.want("GSA");
+    single.watch("TXT");
+    TokenizingReader singleReader;
+    for (char c : stream)
+        single.feed((const uint8_t *)&c, 1, singleReader);
+    assert(singleReader.sentences == reader.sentences && single.getSkipped() == filter.getSkipped());
+    assert(singleReader.seen == reader.seen && singleReader.updates == reader.updates);
+    std::cout << "NMEA filtering test passed\n";
+}
+
+void testGarbage() {
+    NMEASentenceFilter filter;
+    filter.want("RMC");
+    TokenizingReader reader;
+    std::string good = withChecksum("$GPRMC,153200.00,A,4452.12345,N,09312.54321,W,0.012,,181026,,,D");
+
+    std::string bad = good;
+    bad[20] = '7'; // Bit error on the wire
+    std::string noChecksum = "$GPRMC,153200.00,A,,,,,,,,,\r\n";
+    std::string cut = good.substr(0, 30); // Loop stalled, the UART overflowed and the next sentence follows
+    std::string longLine = "$" + std::string(200, 'X') + "\r\n";
+    std::string stream = bad + noChecksum + cut + good + longLine + good;
+
+    filter.feed((const uint8_t *)stream.data(), stream.size(), reader);
+    assert(filter.getGarbled() == 3 && filter.getOverruns() == 1 && filter.getPassed() == 2);
+    // The parser is given the complete bad ones too, and its own checksum check turns them down
+    assert(reader.sentences.size() == 4 && reader.updates == 2);
+
+    // A flush drops whatever was half received
+    filter.feed((const uint8_t *)good.data(), 20, reader);
+    filter.countDropped(1024);
+    filter.reset();
+    filter.feed((const uint8_t *)good.data(), good.size(), reader);
+    assert(filter.getGarbled() == 3 && filter.getPassed() == 3 && filter.getDropped() == 1024);
+    std::cout << "NMEA garbage test passed\n";
+}
+
+#ifdef TINYGPSPLUS
+#include <TinyGPS++.h>
+
+// The parser itself, built with -DTINYGPSPLUS -I<TinyGPSPlus>/src and an Arduino.h that declares millis()
+struct TinyGPSReader {
+    TinyGPSPlus gps;
+    bool record = false;
+    uint32_t terms = 0; // Not counted
+    bool encode(char c) { return gps.encode(c); }
+    void sentence(const char *, size_t) {}
+};
+#endif
+
+// Replays a recorded log (or ten minutes of the sample epoch at 10 Hz) both ways, in the UART-sized chunks whileActive reads.
+// Each way is timed as the best of a few runs.
+template <typename Reader> void benchmarkReplay(const char *name, const std::string &log) {
+    static const size_t CHUNK = 64;
+    static const int RUNS = 5;
+    volatile uint32_t sink = 0;
+    long perChar = 0, chunked = 0;
+    uint32_t directTerms = 0, filteredTerms = 0;
+    NMEASentenceFilter stats;
+
+    for (int run = 0; run < RUNS; run++) {
+        Reader direct;
+        direct.record = false;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < log.size(); i++)
+            sink += direct.encode(log[i]);
+        long us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        perChar = run && perChar < us ? perChar : us;
+        directTerms = direct.terms;
+
+        NMEASentenceFilter filter;
+        filter.want("RMC");
+        filter.want("GGA");
+        filter.want("GSA");
+        filter.watch("TXT");
+        Reader filtered;
+        filtered.record = false;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < log.size(); i += CHUNK)
+            sink += filter.feed((const uint8_t *)log.data() + i, std::min(CHUNK, log.size() - i), filtered);
+        us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        chunked = run && chunked < us ? chunked : us;
+        filteredTerms = filtered.terms;
+        stats = filter;
+    }
+
+    std::cout << name << ", " << log.size() / 1024 << " KiB of NMEA: " << perChar << " us parsing every character, "
+              << chunked << " us filtered (" << stats.getPassed() << " parsed, " << stats.getSkipped() << " skipped, "
+              << stats.getGarbled() << " garbled";
+    if (directTerms)
+        std::cout << ", " << directTerms << " vs " << filteredTerms << " terms tokenized";
+    std::cout << ")\n";
+}
+
+int main(int argc, char **argv) {
+    testFiltering();
+    testGarbage();
+
+    std::string log;
+    if (argc > 1) {
+        std::ifstream in(argv[1], std::ios::binary);
+        std::stringstream buf;
+        buf << in.rdbuf();
+        log = buf.str();
+    } else {
+        for (int tenth = 0; tenth < 6000; tenth++)
+            log += sampleEpoch(tenth);
+    }
+    benchmarkReplay<TokenizingReader>("Stand-in parser", log);
+#ifdef TINYGPSPLUS
+    benchmarkReplay<TinyGPSReader>("TinyGPSPlus", log);
+#endif
+    return 0;
+}
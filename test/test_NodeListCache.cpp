@@ -0,0 +1,153 @@
+#include "gps/GeoCoord.h"
+#include "graphics/draw/NodeListCache.h"
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using graphics::NodeListCache;
+
+// 1e-7 degrees, roughly a farm around 45N
+static const int32_t BASE_LAT = 450000000;
+static const int32_t BASE_LON = -930000000;
+
+static meshtastic_NodeInfoLite makeNode(uint32_t num, int32_t dLat, int32_t dLon) {
+    meshtastic_NodeInfoLite node = meshtastic_NodeInfoLite_init_zero;
+    node.num = num;
+    node.has_user = true;
+    snprintf(node.user.short_name, sizeof(node.user.short_name), "%04X", (unsigned)(num & 0xffff));
+    node.has_position = true;
+    node.position.latitude_i = BASE_LAT + dLat;
+    node.position.longitude_i = BASE_LON + dLon;
+    return node;
+}
+
+void testStringsAndInvalidation() {
+    NodeListCache cache;
+    cache.setOwnPosition(true, BASE_LAT, BASE_LON);
+    meshtastic_NodeInfoLite node = makeNode(0x1234abcd, 90000, 0); // ~1 km north
+
+    const NodeListCache::Entry &e = cache.get(node, 7200);
+    assert(strcmp(e.name, "ABCD") == 0);
+    assert(strcmp(e.lastHeard, "2h") == 0);
+    assert(strcmp(e.distance, "1k") == 0);
+    assert(e.hasGeometry && std::fabs(e.bearing) < 0.001);
+    assert(cache.getMisses() == 1 && cache.getHits() == 0);
+
+    cache.get(node, 7260);
+    assert(cache.getHits() == 1);
+
+    // Name changes are only picked up once NodeDB says so
+    strcpy(node.user.short_name, "PUMP");
+    assert(strcmp(cache.get(node, 7260).name, "ABCD") == 0);
+    cache.invalidate(node.num);
+    assert(strcmp(cache.get(node, 7260).name, "PUMP") == 0);
+    assert(cache.getMisses() == 2);
+    cache.invalidateAll();
+    cache.get(node, 7260);
+    assert(cache.getMisses() == 3);
+
+    // Last heard follows the clock without a miss
+    assert(strcmp(cache.get(node, 0).lastHeard, "?") == 0);
+    assert(strcmp(cache.get(node, 3 * 86400).lastHeard, "3d") == 0);
+
+    // Small own moves keep the cached geometry, large ones and units changes rebuild it
+    node.position.latitude_i = BASE_LAT + 45000; // ~500 m
+    assert(strcmp(cache.get(node, 60).distance, "500m") == 0);
+    cache.setOwnPosition(true, BASE_LAT + 100, BASE_LON); // ~11 m
+    assert(strcmp(cache.get(node, 60).distance, "500m") == 0);
+    cache.setOwnPosition(true, BASE_LAT + 9000, BASE_LON); // ~100 m closer
+    assert(strcmp(cache.get(node, 60).distance, "400m") == 0);
+    cache.setImperial(true);
+    assert(strcmp(cache.get(node, 60).distance, "0mi") == 0);
+    cache.setOwnPosition(false, 0, 0);
+    assert(!cache.get(node, 60).hasGeometry && cache.get(node, 60).distance[0] == '\0');
+
+    // Nodes hashing to the same slot all stay cached, up to PROBE of them, then the least recently used one goes
+    std::vector<meshtastic_NodeInfoLite> sameSlot;
+    for (uint32_t num = 1; sameSlot.size() < NodeListCache::PROBE + 1; num++) {
+        if ((uint32_t)(num * 2654435761u) >> (32 - NodeListCache::SLOT_BITS) ==
+            (uint32_t)(sameSlot.empty() ? num : sameSlot[0].num) * 2654435761u >> (32 - NodeListCache::SLOT_BITS))
+            sameSlot.push_back(makeNode(num, 0, 0));
+    }
+    sameSlot[1].has_user = false;
+    NodeListCache probing;
+    for (size_t i = 0; i < NodeListCache::PROBE; i++)
+        probing.get(sameSlot[i], 60);
+    for (size_t i = 0; i < NodeListCache::PROBE; i++)
+        probing.get(sameSlot[i], 60);
+    assert(probing.getHits() == NodeListCache::PROBE);
+    char expected[16];
+    snprintf(expected, sizeof(expected), "(%04X)", (unsigned)(sameSlot[1].num & 0xffff));
+    assert(strcmp(probing.get(sameSlot[1], 60).name, expected) == 0);
+    probing.get(sameSlot[NodeListCache::PROBE], 60); // Evicts sameSlot[0]
+    uint32_t misses = probing.getMisses();
+    probing.get(sameSlot[1], 60);
+    probing.get(sameSlot[0], 60);
+    assert(probing.getMisses() == misses + 1);
+    std::cout << "Node list cache test passed\n";
+}
+
+// What every visible row did on every frame before the cache
+static size_t uncachedRow(const meshtastic_NodeInfoLite &node, const meshtastic_NodeInfoLite &us, uint32_t seconds) {
+    char name[16], lastHeard[10], distance[10];
+    NodeListCache::formatName(node, name, sizeof(name));
+    NodeListCache::formatLastHeard(seconds, lastHeard, sizeof(lastHeard));
+    double lat1 = us.position.latitude_i * 1e-7, lon1 = us.position.longitude_i * 1e-7;
+    double lat2 = node.position.latitude_i * 1e-7, lon2 = node.position.longitude_i * 1e-7;
+    double dLat = GeoCoord::toRadians(lat2 - lat1), dLon = GeoCoord::toRadians(lon2 - lon1);
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(GeoCoord::toRadians(lat1)) * cos(GeoCoord::toRadians(lat2)) * sin(dLon / 2) * sin(dLon / 2);
+    NodeListCache::formatDistance(6371.0 * 2 * atan2(sqrt(a), sqrt(1 - a)), false, distance, sizeof(distance));
+    float bearing = GeoCoord::bearing(lat1, lon1, lat2, lon2);
+    return strlen(name) + strlen(lastHeard) + strlen(distance) + (bearing > 0);
+}
+
+void benchmarkPaging() {
+    // Synthetic NodeDB: 600 nodes scattered over ~20 km, a T-Deck shows 2 columns of 11 rows
+    static const int NODES = 600, ROWS_PER_PAGE = 22, FRAMES_PER_PAGE = 30; // One second of slide animation per page
+    std::vector<meshtastic_NodeInfoLite> nodes;
+    uint32_t seed = 12345;
+    for (int i = 0; i < NODES; i++) {
+        seed = seed * 1103515245 + 12345;
+        int32_t dLat = (int32_t)(seed % 200000) - 100000, dLon = (int32_t)(seed / 7 % 200000) - 100000;
+        nodes.push_back(makeNode(0x10000000 + seed % 0xfffffff, dLat, dLon));
+    }
+    meshtastic_NodeInfoLite us = makeNode(1, 0, 0);
+
+    volatile size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int page = 0; page * ROWS_PER_PAGE < NODES; page++) {
+        for (int frame = 0; frame < FRAMES_PER_PAGE; frame++) {
+            for (int i = page * ROWS_PER_PAGE; i < NODES && i < (page + 1) * ROWS_PER_PAGE; i++)
+                sink += uncachedRow(nodes[i], us, 600 + i);
+        }
+    }
+    auto uncached = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    NodeListCache cache;
+    start = std::chrono::steady_clock::now();
+    for (int page = 0; page * ROWS_PER_PAGE < NODES; page++) {
+        for (int frame = 0; frame < FRAMES_PER_PAGE; frame++) {
+            cache.setOwnPosition(true, us.position.latitude_i, us.position.longitude_i);
+            for (int i = page * ROWS_PER_PAGE; i < NODES && i < (page + 1) * ROWS_PER_PAGE; i++) {
+                const NodeListCache::Entry &e = cache.get(nodes[i], 600 + i);
+                sink += strlen(e.name) + strlen(e.lastHeard) + strlen(e.distance) + (e.bearing > 0);
+            }
+        }
+    }
+    auto cached = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    int pages = (NODES + ROWS_PER_PAGE - 1) / ROWS_PER_PAGE;
+    std::cout << "Paging " << NODES << " nodes: " << uncached / (double)(pages * FRAMES_PER_PAGE) << " us per frame uncached, "
+              << cached / (double)(pages * FRAMES_PER_PAGE) << " us cached (" << cache.getHits() << " hits, "
+              << cache.getMisses() << " misses)\n";
+}
+
+int main() {
+    testStringsAndInvalidation();
+    benchmarkPaging();
+    return 0;
+}
@@ -0,0 +1,455 @@
+#include "mesh/compression/PayloadCodec.h"
+#include "mesh/compression/unishox2.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_PayloadCodec.cpp src/mesh/compression/*.cpp
+// Run with "train" to print a new phrase table for PayloadCodec.cpp
+
+typedef std::vector<uint8_t> Bytes;
+
+enum Kind { REPORT, COMMAND, ACK, DEVICE_TELEMETRY, WEATHER_TELEMETRY, TEXT, KINDS };
+static const char *KIND_NAMES[KINDS] = {"irrigation reports", "irrigation commands", "irrigation acks", "device telemetry",
+                                        "weather telemetry", "operator texts"};
+
+struct Packet {
+    Kind kind;
+    Bytes payload;
+};
+
+// Small and repeatable, so a day of traffic is the same every run
+struct Random {
+    uint32_t state;
+    explicit Random(uint32_t seed) : state(seed) {}
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    uint32_t below(uint32_t n) { return next() % n; }
+    float between(float lo, float hi) { return lo + (hi - lo) * (next() / 4294967296.0f); }
+};
+
+// Just enough of a protobuf encoder to write the messages our nodes send
+struct Writer {
+    Bytes bytes;
+    void varint(uint64_t v)
+    {
+        while (v >= 0x80) {
+            bytes.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        bytes.push_back((uint8_t)v);
+    }
+    void tag(uint32_t field, uint8_t wireType) { varint(field << 3 | wireType); }
+    void uint(uint32_t field, uint32_t v, bool optional = false)
+    {
+        if (v || optional) {
+            tag(field, 0);
+            varint(v);
+        }
+    }
+    void fixed(uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            bytes.push_back((uint8_t)(v >> (8 * i)));
+    }
+    void real(uint32_t field, float f, bool optional = false)
+    {
+        if (f != 0 || optional) {
+            uint32_t v;
+            memcpy(&v, &f, sizeof(v));
+            tag(field, 5);
+            fixed(v);
+        }
+    }
+    void message(uint32_t field, const Writer &m)
+    {
+        tag(field, 2);
+        varint(m.bytes.size());
+        bytes.insert(bytes.end(), m.bytes.begin(), m.bytes.end());
+    }
+};
+
+// The nodes of a test field, with the types from IrrigationTypes.h
+struct Node {
+    uint32_t num, type, zone;
+    float level;
+};
+
+static std::vector<Node> makeField(Random &random) {
+    static const uint32_t TYPES[] = {1,  2,  3,  10, 10, 10, 10, 11, 11, 12, 12, 12, 12,
+                                     12, 12, 13, 14, 20, 20, 20, 21, 21, 22, 30, 41};
+    std::vector<Node> nodes;
+    for (uint32_t type : TYPES) {
+        Node n = {random.next() | 0x80000000, type, 1 + random.below(8), random.between(0.4f, 2.4f)};
+        nodes.push_back(n);
+    }
+    return nodes;
+}
+
+static Bytes irrigationReport(Random &random, Node &n, uint32_t minute) {
+    bool daytime = minute > 6 * 60 && minute < 20 * 60;
+    bool valve = n.type == 2 || n.type >= 20, pump = n.type == 3 || n.type == 22 || n.type == 31;
+    bool irrigating = daytime && (valve || pump) && (n.zone + minute / 120) % 3 == 0;
+    Writer r;
+    r.uint(1, n.type);
+    r.uint(2, n.zone);
+    r.uint(3, irrigating ? 4 : n.type == 41 ? 3 : 2);
+    if (valve)
+        r.uint(4, irrigating ? 25 * (1 + random.below(4)) : 0);
+    r.uint(5, pump && irrigating);
+    if (n.type == 11 || n.type == 30 || (irrigating && pump))
+        r.real(6, irrigating ? random.between(8, 40) : 0);
+    if (pump || n.type == 13)
+        r.real(7, irrigating ? random.between(30, 60) : random.between(0, 2));
+    if (n.type == 12)
+        r.real(8, random.between(12, 38));
+    if (n.type == 10) {
+        n.level += random.between(-0.005f, 0.005f) + (irrigating ? -0.003f : 0.001f);
+        r.real(9, n.level);
+        Writer history;
+        float sample = n.level;
+        for (uint32_t i = 0, count = 4 + random.below(5); i < count; i++) {
+            uint32_t v;
+            memcpy(&v, &sample, sizeof(v));
+            history.fixed(v);
+            sample -= random.between(-0.002f, 0.002f);
+        }
+        r.message(10, history);
+        r.uint(11, 1 + random.below(3));
+    }
+    Writer packet;
+    packet.message(3, r);
+    return packet.bytes;
+}
+
+static Bytes irrigationCommand(Random &random, const std::vector<Node> &nodes, uint32_t sequence,
+                               std::vector<uint32_t> &targets) {
+    Writer c;
+    c.uint(1, sequence);
+    targets.clear();
+    for (uint32_t i = 0, count = 1 + random.below(6); i < count; i++) {
+        const Node &n = nodes[random.below(nodes.size())];
+        Writer t;
+        t.uint(1, n.num);
+        bool open = random.below(2);
+        t.uint(2, open ? 1 : 2);
+        t.uint(3, open ? 25 * (1 + random.below(4)) : 0);
+        t.uint(4, open ? 900 * (1 + random.below(8)) : 0);
+        c.message(2, t);
+        targets.push_back(n.num);
+    }
+    Writer packet;
+    packet.message(1, c);
+    return packet.bytes;
+}
+
+static Bytes irrigationAck(Random &random, uint32_t sequence, uint32_t target) {
+    Writer a;
+    a.uint(1, sequence);
+    Writer e;
+    e.uint(1, target);
+    e.uint(2, random.below(20) ? 0 : 1 + random.below(4));
+    e.uint(3, 25 * random.below(5));
+    a.message(2, e);
+    Writer packet;
+    packet.message(2, a);
+    return packet.bytes;
+}
+
+static Bytes deviceTelemetry(Random &random, uint32_t time, uint32_t uptime) {
+    Writer m;
+    bool powered = random.below(4) == 0;
+    m.uint(1, powered ? 101 : 40 + random.below(61), true);
+    m.real(2, powered ? 0 : random.between(3.5f, 4.2f), true);
+    m.real(3, random.between(0, 25), true);
+    m.real(4, random.between(0, 3), true);
+    m.uint(5, uptime, true);
+    Writer t;
+    t.tag(1, 5);
+    t.fixed(time);
+    t.message(2, m);
+    return t.bytes;
+}
+
+static Bytes weatherTelemetry(Random &random, uint32_t time, uint32_t minute) {
+    Writer m;
+    m.real(1, random.between(8, 34), true);
+    m.real(2, random.between(20, 90), true);
+    m.real(3, random.between(990, 1030), true);
+    m.uint(13, random.below(360), true);
+    m.real(14, random.between(0, 12), true);
+    m.real(19, minute % 240 < 30 ? 0.2f * random.below(20) : 0, true);
+    Writer t;
+    t.tag(1, 5);
+    t.fixed(time);
+    t.message(3, m);
+    return t.bytes;
+}
+
+static Bytes operatorText(Random &random) {
+    static const char *TEMPLATES[] = {
+        "Zone %u valve open %u%%",
+        "Zone %u valve closed",
+        "Pump %u started, pressure %u psi",
+        "Pump %u stopped",
+        "Canal level %u.%02u m, rising",
+        "Canal level %u.%02u m, falling",
+        "Headgate %u closed for maintenance",
+        "North field done, moving to zone %u",
+        "Checking ditch %u, back in %u min",
+        "Low flow on lateral %u, %u L/s",
+        "Moisture zone %u at %u%%, skipping tonight",
+        "Shutting everything down at %u:00",
+    };
+    char text[120];
+    const char *t = TEMPLATES[random.below(sizeof(TEMPLATES) / sizeof(TEMPLATES[0]))];
+    snprintf(text, sizeof(text), t, 1 + random.below(24), random.below(100));
+    return Bytes(text, text + strlen(text));
+}
+
+/**
+ * A day on our test field: every node reports every five minutes and level sensors every two, each node sends device
+ * telemetry every half hour and the weather station every ten minutes, plus a controller's command batches and their acks
+ * and what operators type. Modeled on what the gateway logs, since no raw captures live in the tree.
+ */
+static std::vector<Packet> recordDay(uint32_t seed) {
+    Random random(seed);
+    std::vector<Node> nodes = makeField(random);
+    std::vector<Packet> day;
+    std::vector<uint32_t> targets;
+    uint32_t time = 1760000000 + seed * 97 * 86400, sequence = random.below(1000);
+
+    for (uint32_t minute = 0; minute < 24 * 60; minute++) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            Node &n = nodes[i];
+            if ((minute + i) % (n.type == 10 ? 2 : 5) == 0)
+                day.push_back({REPORT, irrigationReport(random, n, minute)});
+            if ((minute + 7 * i) % 30 == 0)
+                day.push_back({DEVICE_TELEMETRY, deviceTelemetry(random, time + minute * 60, minute * 60 + 7 * i)});
+            if (n.type == 14 && minute % 10 == 0)
+                day.push_back({WEATHER_TELEMETRY, weatherTelemetry(random, time + minute * 60, minute)});
+        }
+        if (minute % 20 == 0 && random.below(3) == 0) {
+            day.push_back({COMMAND, irrigationCommand(random, nodes, ++sequence, targets)});
+            for (uint32_t target : targets)
+                day.push_back({ACK, irrigationAck(random, sequence, target)});
+        }
+        if (random.below(10) == 0)
+            day.push_back({TEXT, operatorText(random)});
+    }
+    return day;
+}
+
+/// What Router does to a payload: unishox2 for text, the dictionary coder for protobufs, and only if that is smaller
+static size_t compressPayload(const Packet &p, uint8_t *out, size_t outSize) {
+    const size_t size = p.payload.size();
+    if (p.kind == TEXT) {
+        int n = unishox2_compress((const char *)p.payload.data(), size, (char *)out, size - 1, USX_PSET_DFLT);
+        return n > 0 && (size_t)n < size ? n : 0;
+    }
+    return PayloadCodec::compress(p.payload.data(), size, out, outSize);
+}
+
+static int decompressPayload(const Packet &p, const uint8_t *in, size_t length, uint8_t *out, size_t outSize) {
+    if (p.kind == TEXT) {
+        int n = unishox2_decompress((const char *)in, length, (char *)out, outSize, USX_PSET_DFLT);
+        return n > (int)outSize ? -1 : n;
+    }
+    return PayloadCodec::decompress(in, length, out, outSize);
+}
+
+static const size_t PAYLOAD_LEN = 233; // meshtastic_Constants_DATA_PAYLOAD_LEN
+
+void testRoundTrip() {
+    uint8_t out[PAYLOAD_LEN], back[PAYLOAD_LEN];
+
+    // Copies that overlap what they produce, and runs longer than a literal token holds
+    Bytes zeros(200, 0), counting;
+    for (int i = 0; i < 200; i++)
+        counting.push_back(i * 37);
+    for (const Bytes &in : {zeros, counting}) {
+        size_t n = PayloadCodec::compress(in.data(), in.size(), out, sizeof(out));
+        if (n) {
+            assert(n < in.size());
+            assert(PayloadCodec::decompress(out, n, back, sizeof(back)) == (int)in.size());
+            assert(memcmp(back, in.data(), in.size()) == 0);
+        }
+    }
+    assert(PayloadCodec::compress(zeros.data(), zeros.size(), out, sizeof(out)) <= 10);
+    assert(PayloadCodec::compress(counting.data(), counting.size(), out, sizeof(out)) == 0); // Nothing to gain
+
+    // Never longer than the input, nor than the room given
+    assert(PayloadCodec::compress(zeros.data(), 1, out, sizeof(out)) == 0);
+    assert(PayloadCodec::compress(zeros.data(), zeros.size(), out, 3) == 0);
+
+    std::vector<Packet> day = recordDay(7);
+    for (const Packet &p : day) {
+        size_t n = compressPayload(p, out, sizeof(out));
+        if (!n)
+            continue;
+        assert(n < p.payload.size());
+        assert(decompressPayload(p, out, n, back, sizeof(back)) == (int)p.payload.size());
+        assert(memcmp(back, p.payload.data(), p.payload.size()) == 0);
+        // Anything that would not fit is refused rather than written past the end
+        assert(decompressPayload(p, out, n, back, p.payload.size() - 1) == -1);
+    }
+    std::cout << "Payload codec round trip test passed\n";
+}
+
+void testCorruptInput() {
+    uint8_t in[40], out[PAYLOAD_LEN];
+    Random random(99);
+    size_t decoded = 0;
+    for (int round = 0; round < 200000; round++) {
+        size_t length = 1 + random.below(sizeof(in));
+        for (size_t i = 0; i < length; i++)
+            in[i] = random.next();
+        int n = PayloadCodec::decompress(in, length, out, sizeof(out));
+        assert(n >= -1 && n <= (int)sizeof(out));
+        decoded += n > 0;
+    }
+    // Truncated tokens and copies from before the start are refused
+    const uint8_t literal[] = {0x05, 1, 2}, copy[] = {0x00, 7, 0x80}, early[] = {0x00, 7, 0x80, 1};
+    assert(PayloadCodec::decompress(literal, sizeof(literal), out, sizeof(out)) == -1);
+    assert(PayloadCodec::decompress(copy, sizeof(copy), out, sizeof(out)) == -1);
+    assert(PayloadCodec::decompress(early, sizeof(early), out, sizeof(out)) == -1);
+    std::cout << "Payload codec corrupt input test passed (" << decoded << " of 200000 random inputs decoded)\n";
+}
+
+/**
+ * Finds the phrase table: repeatedly takes the substring that would save the most bytes over four days of protobuf traffic,
+ * months apart, and marks where it occurs as used. The benchmark runs on a fifth day.
+ */
+void train() {
+    std::vector<Bytes> corpus;
+    std::vector<std::vector<bool>> used;
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        for (const Packet &p : recordDay(seed)) {
+            if (p.kind != TEXT) {
+                corpus.push_back(p.payload);
+                used.push_back(std::vector<bool>(p.payload.size(), false));
+                // Whatever the clock reads today is no use in a table that has to last
+                if (p.kind == DEVICE_TELEMETRY || p.kind == WEATHER_TELEMETRY)
+                    std::fill(used.back().begin() + 1, used.back().begin() + 5, true);
+            }
+        }
+    }
+
+    printf("const Phrase PHRASES[] = {\n");
+    for (int phrase = 0; phrase < 64; phrase++) {
+        // Up to 7 bytes, and the length in the top one
+        std::unordered_map<uint64_t, size_t> counts;
+        for (size_t c = 0; c < corpus.size(); c++) {
+            const Bytes &b = corpus[c];
+            for (size_t start = 0; start < b.size(); start++) {
+                uint64_t key = 0;
+                for (size_t length = 1; length <= 7 && start + length <= b.size() && !used[c][start + length - 1]; length++) {
+                    key |= (uint64_t)b[start + length - 1] << (8 * (length - 1));
+                    if (length >= 2)
+                        counts[key | (uint64_t)length << 56]++;
+                }
+            }
+        }
+        Bytes best;
+        size_t bestSaving = 0;
+        for (const auto &entry : counts) {
+            size_t length = entry.first >> 56, saving = entry.second * (length - 1);
+            if (saving > bestSaving) {
+                bestSaving = saving;
+                best.clear();
+                for (size_t i = 0; i < length; i++)
+                    best.push_back(entry.first >> (8 * i));
+            }
+        }
+        if (bestSaving < 400)
+            break;
+        for (size_t c = 0; c < corpus.size(); c++) {
+            Bytes &b = corpus[c];
+            for (size_t start = 0; start + best.size() <= b.size(); start++) {
+                if (std::equal(best.begin(), best.end(), b.begin() + start) &&
+                    std::find(used[c].begin() + start, used[c].begin() + start + best.size(), true) ==
+                        used[c].begin() + start + best.size()) {
+                    std::fill(used[c].begin() + start, used[c].begin() + start + best.size(), true);
+                    start += best.size() - 1;
+                }
+            }
+        }
+        printf("    {%u, {", (unsigned)best.size());
+        for (size_t i = 0; i < best.size(); i++)
+            printf("%s0x%02x", i ? ", " : "", best[i]);
+        printf("}}, // saves %u\n", (unsigned)bestSaving);
+    }
+    printf("};\n");
+}
+
+/**
+ * Compression ratio and CPU per packet kind over a day of traffic, and what that is in airtime: each packet also carries the
+ * 16 byte header, about 6 bytes of Data around the payload, and on text the port change or on protobufs the flag is free.
+ */
+void benchmarkDay() {
+    std::vector<Packet> day = recordDay(5);
+    size_t before[KINDS] = {}, after[KINDS] = {}, count[KINDS] = {}, compressed[KINDS] = {};
+    double compressUs[KINDS] = {}, decompressUs[KINDS] = {};
+    uint8_t out[PAYLOAD_LEN], back[PAYLOAD_LEN];
+    const int ROUNDS = 20;
+
+    for (const Packet &p : day) {
+        size_t n = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; r++)
+            n = compressPayload(p, out, sizeof(out));
+        compressUs[p.kind] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+        if (n) {
+            started = std::chrono::steady_clock::now();
+            for (int r = 0; r < ROUNDS; r++)
+                assert(decompressPayload(p, out, n, back, sizeof(back)) == (int)p.payload.size());
+            decompressUs[p.kind] +=
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+            compressed[p.kind]++;
+        }
+        count[p.kind]++;
+        before[p.kind] += p.payload.size();
+        after[p.kind] += n ? n : p.payload.size();
+    }
+
+    size_t allBefore = 0, allAfter = 0, allCount = 0;
+    for (int k = 0; k < KINDS; k++) {
+        printf("%-20s %5u packets, %6u -> %6u payload bytes (%4.1f%% saved, %3u%% of packets smaller), compress %5.2f us, "
+               "decompress %5.2f us\n",
+               KIND_NAMES[k], (unsigned)count[k], (unsigned)before[k], (unsigned)after[k],
+               100.0 * (before[k] - after[k]) / before[k], (unsigned)(100 * compressed[k] / count[k]),
+               compressUs[k] / ROUNDS / count[k], compressed[k] ? decompressUs[k] / ROUNDS / compressed[k] : 0.0);
+        allBefore += before[k];
+        allAfter += after[k];
+        allCount += count[k];
+    }
+    const size_t OVERHEAD = 16 + 6;
+    printf("whole day: %u -> %u payload bytes (%.1f%% saved), %u -> %u bytes on air (%.1f%% less airtime)\n", (unsigned)allBefore,
+           (unsigned)allAfter, 100.0 * (allBefore - allAfter) / allBefore, (unsigned)(allBefore + allCount * OVERHEAD),
+           (unsigned)(allAfter + allCount * OVERHEAD),
+           100.0 * (allBefore - allAfter) / (allBefore + allCount * OVERHEAD));
+    assert(allAfter < allBefore);
+    assert(after[REPORT] < before[REPORT] && after[TEXT] < before[TEXT]);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "train") == 0) {
+        train();
+        return 0;
+    }
+    testRoundTrip();
+    testCorruptInput();
+    benchmarkDay();
+    return 0;
+}
@@ -0,0 +1,307 @@
+#include "modules/PositionReportPolicy.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+static const double BASE_LAT = 44.87, BASE_LON = -93.21;
+static const double M_PER_DEG = 111320.0;
+
+struct Point {
+    double east, north; // Metres from BASE_LAT/BASE_LON
+};
+
+static int32_t toLat(const Point &p) { return (int32_t)lround((BASE_LAT + p.north / M_PER_DEG) * 1e7); }
+static int32_t toLon(const Point &p) {
+    return (int32_t)lround((BASE_LON + p.east / (M_PER_DEG * cos(BASE_LAT * M_PI / 180))) * 1e7);
+}
+
+static Point fromLatLon(int32_t lat, int32_t lon) {
+    return {(lon * 1e-7 - BASE_LON) * M_PER_DEG * cos(BASE_LAT * M_PI / 180), (lat * 1e-7 - BASE_LAT) * M_PER_DEG};
+}
+
+// What a receiver gets for a fix sent with this many precision bits, truncated and centred as PositionModule does
+static Point truncate(const Point &p, uint8_t bits) {
+    int32_t lat = toLat(p), lon = toLon(p);
+    if (bits > 0 && bits < 32) {
+        lat = (lat & (UINT32_MAX << (32 - bits))) + (1 << (31 - bits));
+        lon = (lon & (UINT32_MAX << (32 - bits))) + (1 << (31 - bits));
+    }
+    return fromLatLon(lat, lon);
+}
+
+static double distance(const Point &a, const Point &b) { return hypot(a.east - b.east, a.north - b.north); }
+
+// Deterministic GPS noise, roughly what a patch antenna on a steel enclosure sees
+struct Jitter {
+    uint32_t seed = 1;
+    double uniform() {
+        seed = seed * 1103515245 + 12345;
+        return ((seed >> 8) + 1) / 16777217.0;
+    }
+    double gaussian(double sigma) { return sigma * sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform()); }
+};
+
+void testFilterAndPolicy() {
+    PositionReportPolicy policy;
+    policy.setConfig({50, 30000, true});
+    assert(!policy.isDue(0));
+
+    // Driving east at 10 m/s with a fix every second, the velocity settles and the first report goes out at once
+    uint32_t now = 0;
+    for (int i = 0; i <= 60; i++, now += 1000)
+        policy.addFix(toLat({i * 10.0, 0}), toLon({i * 10.0, 0}), now);
+    now -= 1000;
+    assert(std::fabs(policy.getSpeed() - 10) < 0.2);
+    assert(policy.isDue(now));
+    policy.reported(now, 32);
+    assert(policy.getError(now) < 1);
+
+    // Receivers extrapolate the reported speed, but only as far as the bound
+    assert(PositionReportPolicy::reckonSeconds(10, 0, 3, 50) == 3 && PositionReportPolicy::reckonSeconds(0, 10, 30, 50) == 5);
+    for (int i = 61; i <= 200; i++) {
+        now = i * 1000;
+        policy.addFix(toLat({i * 10.0, 0}), toLon({i * 10.0, 0}), now);
+        if (i == 65)
+            assert(!policy.isDue(now) && policy.getError(now) < 5);
+        if (i == 85)
+            assert(!policy.isDue(now) && std::fabs(policy.getError(now) - 200) < 5);
+    }
+    assert(policy.isDue(now));
+
+    // At road speed the minimum interval already holds receivers past the bound, coarser cells would only add to that
+    assert(policy.cellBudgetM(now) == 0 && policy.precisionBits(32, now) == 32);
+
+    // Stopping is a surprise to them
+    for (int i = 201; i <= 215; i++) {
+        now = i * 1000;
+        policy.addFix(toLat({2000, 0}), toLon({2000, 0}), now);
+    }
+    assert(policy.getSpeed() < 1 && policy.isDue(now));
+    policy.reported(now, 32);
+    assert(!policy.isDue(now + 40000));
+
+    assert(!policy.isStationary(now) && policy.heartbeatMs(900000, now) == 900000);
+    now += PositionReportPolicy::STATIONARY_HOLD_MS;
+    policy.addFix(toLat({2000, 0}), toLon({2000, 0}), now);
+    assert(policy.isStationary(now) && policy.precisionBits(32, now) == 32);
+    // The next heartbeat settles receivers on where it stopped, only after that does it go quiet
+    assert(policy.heartbeatMs(900000, now) == 900000);
+    policy.reported(now, 32);
+    assert(policy.heartbeatMs(900000, now) == 900000 * PositionReportPolicy::STATIONARY_FACTOR);
+
+    // At a walk, a report is 30 m stale by the next one, so lat/lon go coarser by up to a quarter of the bound, never finer
+    // than the channel allows. isDue() keeps what that costs inside the bound.
+    PositionReportPolicy walking;
+    walking.setConfig({100, 30000, false});
+    uint32_t t = 0;
+    for (int i = 0; i <= 120; i++, t += 1000)
+        walking.addFix(toLat({i * 1.0, 0}), toLon({i * 1.0, 0}), t);
+    t -= 1000;
+    assert(walking.cellBudgetM(t) == 25 && walking.precisionBits(32, t) == 21 && walking.precisionBits(13, t) == 13);
+    assert(PositionReportPolicy::cellError(21) <= 25 && PositionReportPolicy::cellError(20) > 25);
+    walking.reported(t, 21);
+    for (int i = 121; i <= 210; i++)
+        walking.addFix(toLat({i * 1.0, 0}), toLon({i * 1.0, 0}), i * 1000);
+    t = 210 * 1000;
+    assert(walking.getError(t) < 100 && walking.getError(t) + PositionReportPolicy::cellError(21) > 100 && walking.isDue(t));
+
+    // What the channel cut the report to counts, and cells wider than the bound aren't made any better by reporting often
+    walking.reported(t, 13);
+    for (int i = 211; i <= 510; i++)
+        walking.addFix(toLat({i * 1.0, 0}), toLon({i * 1.0, 0}), i * 1000);
+    t = 510 * 1000;
+    assert(PositionReportPolicy::cellError(13) > 100 && walking.getError(t) > 250 && !walking.isDue(t));
+
+    // A pivot creeping at 3 cm/s is too slow for the speed test, drifting away from the last report still counts as moving
+    PositionReportPolicy creeping;
+    creeping.setConfig({100, 30000, false});
+    t = 0;
+    for (int i = 0; i <= 30; i++, t += 120000) {
+        creeping.addFix(toLat({i * 3.6, 0}), toLon({i * 3.6, 0}), t);
+        if (i == 0)
+            creeping.reported(t, 32);
+    }
+    t -= 120000;
+    assert(creeping.getSpeed() < PositionReportPolicy::STATIONARY_SPEED_MPS && !creeping.isStationary(t));
+
+    // Driving off the local grid keeps what receivers were told
+    policy.reported(now, 32);
+    now += 1000000;
+    policy.addFix(toLat({2000, 12000}), toLon({2000, 12000}), now);
+    assert(std::fabs(policy.getError(now) - 12000) < 50 && std::fabs(policy.getSpeed() - 12) < 0.1);
+    std::cout << "Position report policy test passed\n";
+}
+
+struct Trace {
+    const char *name;
+    uint32_t seconds;
+    uint32_t fixIntervalS; // gps_update_interval the node is configured with
+    Point (*truth)(uint32_t second);
+};
+
+static Point headgate(uint32_t) { return {120, -40}; }
+
+// End tower of a quarter section pivot, one turn a day
+static Point pivot(uint32_t s) {
+    double angle = 2 * M_PI * s / 86400.0;
+    return {390 * cos(angle), 390 * sin(angle)};
+}
+
+// Parked, 4 km to the next field on gravel roads with two turns, parked, and back
+static Point trailer(uint32_t s) {
+    static const double SPEED = 12;
+    const Point legs[] = {{0, 0}, {1600, 0}, {1600, 1600}, {2400, 1600}};
+    double along;
+    if (s < 3600)
+        along = 0;
+    else if (s < 3600 + 4000 / SPEED)
+        along = (s - 3600) * SPEED;
+    else if (s < 3 * 3600)
+        along = 4000;
+    else
+        along = std::max(0.0, 4000 - (s - 3 * 3600) * SPEED);
+    for (int i = 1; i < 4; i++) {
+        double leg = distance(legs[i - 1], legs[i]);
+        if (along <= leg) {
+            double f = along / leg;
+            return {legs[i - 1].east + f * (legs[i].east - legs[i - 1].east),
+                    legs[i - 1].north + f * (legs[i].north - legs[i - 1].north)};
+        }
+        along -= leg;
+    }
+    return legs[3];
+}
+
+struct Result {
+    uint32_t packets = 0, fixes = 0;
+    double meanError = 0, maxError = 0;
+};
+
+// What PositionModule did before: report once 100 m from the last report, at most every 30 s, heartbeat every 15 min
+static Result replayLegacy(const Trace &trace, uint32_t seed) {
+    Result r;
+    Jitter jitter;
+    jitter.seed = seed;
+    Point reported = {0, 0}, fix = {0, 0};
+    bool hasFix = false;
+    uint32_t lastSend = 0;
+    for (uint32_t s = 0; s < trace.seconds; s++) {
+        Point truth = trace.truth(s);
+        bool newFix = s % trace.fixIntervalS == 0;
+        if (newFix) {
+            fix = {truth.east + jitter.gaussian(2.5), truth.north + jitter.gaussian(2.5)};
+            hasFix = true;
+            r.fixes++;
+        }
+        // PositionModule checks on every fix and every 5 s
+        if (hasFix && (newFix || s % 5 == 0) && (r.packets == 0 || s - lastSend >= 900 || (distance(fix, reported) >= 100 && s - lastSend >= 30))) {
+            reported = truncate(fix, 32);
+            lastSend = s;
+            r.packets++;
+        }
+        double error = r.packets ? distance(truth, reported) : 0;
+        r.meanError += error / trace.seconds;
+        r.maxError = std::max(r.maxError, error);
+    }
+    return r;
+}
+
+static Result replayAdaptive(const Trace &trace, bool deadReckoning, uint32_t seed) {
+    Result r;
+    Jitter jitter;
+    jitter.seed = seed;
+    PositionReportPolicy policy;
+    policy.setConfig({100, 30000, deadReckoning});
+    Point reported = {0, 0}, fix = {0, 0};
+    double reportedVe = 0, reportedVn = 0, fixVe = 0, fixVn = 0;
+    uint32_t lastSend = 0, reportedFix = 0, lastFix = 0, nextFix = 0;
+    for (uint32_t s = 0; s < trace.seconds; s++) {
+        uint32_t now = s * 1000;
+        Point truth = trace.truth(s);
+        bool newFix = s >= nextFix;
+        if (newFix) {
+            fix = {truth.east + jitter.gaussian(2.5), truth.north + jitter.gaussian(2.5)};
+            Point ahead = trace.truth(s + 1);
+            fixVe = ahead.east - truth.east;
+            fixVn = ahead.north - truth.north;
+            lastFix = s;
+            policy.addFix(toLat(fix), toLon(fix), now);
+            r.fixes++;
+            nextFix = s + trace.fixIntervalS;
+        }
+        // PositionModule checks on every fix and every 5 s
+        bool heartbeat = r.packets == 0 || now - lastSend * 1000 >= policy.heartbeatMs(900000, now);
+        if (policy.hasFix() && (newFix || s % 5 == 0) && (heartbeat || policy.isDue(now))) {
+            // Receivers get the last fix, cut to the precision bits, with its timestamp and the GPS speed and course
+            uint8_t bits = policy.precisionBits(32, now);
+            reported = truncate(fix, bits);
+            reportedVe = fixVe;
+            reportedVn = fixVn;
+            reportedFix = lastFix;
+            policy.reported(now, bits);
+            lastSend = s;
+            r.packets++;
+        }
+        Point believed = reported;
+        if (deadReckoning) {
+            // As far as the same bound the policy assumes
+            double reckonS = PositionReportPolicy::reckonSeconds(reportedVe, reportedVn, s - reportedFix, 100);
+            believed.east += reportedVe * reckonS;
+            believed.north += reportedVn * reckonS;
+        }
+        double error = r.packets ? distance(truth, believed) : 0;
+        r.meanError += error / trace.seconds;
+        r.maxError = std::max(r.maxError, error);
+    }
+    return r;
+}
+
+static const uint32_t RUNS = 20;
+
+// Packets and fixes over all runs, mean error averaged over them, the worst error of any
+static void accumulate(Result &total, const Result &run) {
+    total.packets += run.packets;
+    total.fixes += run.fixes;
+    total.meanError += run.meanError / RUNS;
+    total.maxError = std::max(total.maxError, run.maxError);
+}
+
+void replayTraces() {
+    const Trace traces[] = {
+        {"headgate", 12 * 3600, 120, headgate},
+        {"pivot", 12 * 3600, 120, pivot},
+        {"pump trailer", 5 * 3600, 30, trailer},
+        {"pump trailer, 5 s GPS", 5 * 3600, 5, trailer},
+    };
+    std::cout << "Packets and fixes over " << RUNS << " runs of each trace, mean error over them, max error of any\n";
+    for (const Trace &trace : traces) {
+        // Over the same runs of GPS noise each, so one lucky fix can't decide which is better
+        Result legacy, still, reckoned;
+        for (uint32_t seed = 1; seed <= RUNS; seed++) {
+            accumulate(legacy, replayLegacy(trace, seed));
+            accumulate(still, replayAdaptive(trace, false, seed));
+            accumulate(reckoned, replayAdaptive(trace, true, seed));
+        }
+        std::cout << trace.name << ": legacy " << legacy.packets << " packets, " << legacy.fixes << " fixes, error mean "
+                  << legacy.meanError << " m max " << legacy.maxError << " m; adaptive " << still.packets << " packets, "
+                  << still.fixes << " fixes, mean " << still.meanError << " m max " << still.maxError
+                  << " m; with dead reckoning " << reckoned.packets << " packets, mean " << reckoned.meanError << " m max "
+                  << reckoned.maxError << " m\n";
+        // Never more packets, and receivers that don't extrapolate, the apps, are no worse off than before. Which noisy fix
+        // happens to go out decides the last percent or metre either way.
+        assert(still.packets <= legacy.packets && reckoned.packets <= legacy.packets && still.fixes <= legacy.fixes);
+        assert(still.maxError <= legacy.maxError + PositionReportPolicy::GPS_NOISE_M);
+        assert(reckoned.maxError <= legacy.maxError + PositionReportPolicy::GPS_NOISE_M);
+        assert(still.meanError <= legacy.meanError * 1.02);
+        if (trace.truth != headgate) {
+            assert(reckoned.meanError < legacy.meanError);
+        }
+    }
+}
+
+int main() {
+    testFilterAndPolicy();
+    replayTraces();
+    return 0;
+}
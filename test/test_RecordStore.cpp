@@ -0,0 +1,264 @@
+#include "RecordStore.h"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Two segments in RAM, counting what a flash chip would be asked to do. powerBudget cuts an append short after that many
+// bytes, and nothing reaches flash after that, like pulling the battery mid-write.
+struct MemoryStorage : public RecordStore::Storage {
+    std::vector<uint8_t> segments[2];
+    uint32_t programmed = 0, erases = 0;
+    long powerBudget = -1;
+    bool reading = false; // Between a read and endReads(), when a file would be held open
+
+    size_t size(uint8_t segment) override { return segments[segment].size(); }
+
+    bool read(uint8_t segment, size_t offset, uint8_t *buf, size_t length) override {
+        if (offset + length > segments[segment].size())
+            return false;
+        memcpy(buf, segments[segment].data() + offset, length);
+        reading = true;
+        return true;
+    }
+
+    void endReads() override { reading = false; }
+
+    bool append(uint8_t segment, const uint8_t *const *pieces, const size_t *lengths, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j < lengths[i]; j++) {
+                if (powerBudget == 0)
+                    return false;
+                if (powerBudget > 0)
+                    powerBudget--;
+                segments[segment].push_back(pieces[i][j]);
+                programmed++;
+            }
+        }
+        return true;
+    }
+
+    bool erase(uint8_t segment) override {
+        if (powerBudget == 0)
+            return false;
+        segments[segment].clear();
+        erases++;
+        return true;
+    }
+};
+
+static bool put(RecordStore &store, const char *key, const std::string &value) {
+    return store.put(key, (const uint8_t *)value.data(), value.size());
+}
+
+static std::string get(RecordStore &store, const char *key) {
+    uint8_t buf[RecordStore::MAX_VALUE];
+    size_t length = 0;
+    if (!store.get(key, buf, sizeof(buf), &length))
+        return "<missing>";
+    return std::string((const char *)buf, length);
+}
+
+void testBasics() {
+    MemoryStorage flash;
+    RecordStore store(&flash);
+    assert(!store.mount() && !store.has("/prefs/config.proto"));
+
+    assert(put(store, "/prefs/config.proto", "lora=us915"));
+    assert(put(store, "/prefs/channels.proto", "primary"));
+    assert(get(store, "/prefs/config.proto") == "lora=us915" && store.length("/prefs/channels.proto") == 7);
+
+    // Saving the same bytes again writes nothing
+    uint32_t programmed = flash.programmed;
+    assert(put(store, "/prefs/config.proto", "lora=us915"));
+    assert(flash.programmed == programmed && store.getUnchanged() == 1);
+
+    assert(put(store, "/prefs/config.proto", "lora=eu868"));
+    assert(store.remove("/prefs/channels.proto") && !store.has("/prefs/channels.proto"));
+    assert(put(store, "/NicheGraphics/settings.data", std::string(300, 's')));
+    assert(put(store, "/NicheGraphics/latest.data", "hello"));
+    store.removePrefix("/NicheGraphics/");
+    assert(!store.has("/NicheGraphics/settings.data") && !store.has("/NicheGraphics/latest.data"));
+
+    // Limits
+    assert(!put(store, "/prefs/a-key-that-is-far-too-long-to-fit.proto", "x"));
+    assert(!put(store, "/prefs/big.proto", std::string(RecordStore::MAX_VALUE + 1, 'b')));
+    assert(!put(store, "", "x"));
+
+    // A remount sees the same thing
+    RecordStore again(&flash);
+    assert(again.mount());
+    assert(get(again, "/prefs/config.proto") == "lora=eu868" && !again.has("/prefs/channels.proto"));
+    assert(!again.has("/NicheGraphics/settings.data"));
+    // Nothing stays open once a replay, get or compaction is done
+    assert(!flash.reading && again.compact() && !flash.reading);
+    std::cout << "Record store basics passed\n";
+}
+
+// NodeDB::saveToDisk() formats the filesystem when a save fails, which deletes both segments under the store
+void testFormat() {
+    MemoryStorage flash;
+    RecordStore store(&flash);
+    store.mount();
+    assert(put(store, "/prefs/config.proto", "lora=us915"));
+    assert(put(store, "/prefs/channels.proto", "primary"));
+
+    flash.segments[0].clear();
+    flash.segments[1].clear();
+    store.clear();
+    assert(!store.has("/prefs/config.proto"));
+
+    assert(put(store, "/prefs/config.proto", "lora=eu868"));
+    RecordStore again(&flash);
+    assert(again.mount());
+    assert(get(again, "/prefs/config.proto") == "lora=eu868" && !again.has("/prefs/channels.proto"));
+    std::cout << "Record store format passed\n";
+}
+
+void testTornWrites() {
+    MemoryStorage flash;
+    RecordStore store(&flash);
+    store.mount();
+    assert(put(store, "/prefs/config.proto", "old config"));
+    assert(put(store, "/prefs/device.proto", "device"));
+
+    // Lose power at every possible byte of a save, the old value must survive and the store must stay usable
+    size_t recordBytes = 8 + strlen("/prefs/config.proto") + strlen("new config");
+    for (size_t cut = 0; cut < recordBytes; cut++) {
+        MemoryStorage torn = flash;
+        RecordStore writer(&torn);
+        assert(writer.mount());
+        torn.powerBudget = cut;
+        assert(!put(writer, "/prefs/config.proto", "new config"));
+        torn.powerBudget = -1;
+
+        RecordStore reader(&torn);
+        assert(reader.mount());
+        assert(get(reader, "/prefs/config.proto") == "old config" && get(reader, "/prefs/device.proto") == "device");
+        // The next save lands in a clean segment instead of behind the torn record
+        assert(put(reader, "/prefs/config.proto", "new config"));
+        RecordStore after(&torn);
+        assert(after.mount() && get(after, "/prefs/config.proto") == "new config");
+    }
+
+    // A complete save survives
+    MemoryStorage whole = flash;
+    RecordStore writer(&whole);
+    assert(writer.mount() && put(writer, "/prefs/config.proto", "new config"));
+    RecordStore reader(&whole);
+    assert(reader.mount() && get(reader, "/prefs/config.proto") == "new config");
+
+    // Bits flipping in a value after mount are caught on read, and the record is dropped by the next compaction
+    MemoryStorage rotten = whole;
+    RecordStore rottenStore(&rotten);
+    assert(rottenStore.mount());
+    std::vector<uint8_t> &segment = rotten.segments[rottenStore.getActiveSegment()];
+    size_t at = segment.size() - strlen("new config");
+    segment[at] ^= 0x10;
+    assert(get(rottenStore, "/prefs/config.proto") == "<missing>" && get(rottenStore, "/prefs/device.proto") == "device");
+    assert(rottenStore.compact() && !rottenStore.has("/prefs/config.proto"));
+    assert(get(rottenStore, "/prefs/device.proto") == "device");
+    std::cout << "Record store torn write test passed\n";
+}
+
+void testCompaction() {
+    MemoryStorage flash;
+    RecordStore store(&flash);
+    store.mount();
+    std::string channels(700, 'c');
+    assert(put(store, "/prefs/channels.proto", channels));
+
+    // Rewrite config until the active segment compacts a few times
+    std::string value;
+    for (int i = 0; store.getCompactions() < 4; i++) {
+        value = "config revision " + std::to_string(i) + std::string(300, 'x');
+        assert(put(store, "/prefs/config.proto", value));
+        assert(store.getActiveSize() <= RecordStore::COMPACT_BYTES + 400);
+    }
+    assert(get(store, "/prefs/channels.proto") == channels && get(store, "/prefs/config.proto") == value);
+    assert(flash.segments[store.getActiveSegment() ^ 1].empty());
+
+    // Power lost anywhere in a compaction leaves either the old or the new segment in charge, never less than both records
+    uint32_t generation = store.getGeneration();
+    for (long cut = 0; cut < (long)store.getLiveBytes() + 2; cut++) {
+        MemoryStorage torn = flash;
+        RecordStore writer(&torn);
+        assert(writer.mount());
+        torn.powerBudget = cut;
+        writer.compact();
+        torn.powerBudget = -1;
+
+        RecordStore reader(&torn);
+        assert(reader.mount());
+        assert(reader.getGeneration() == generation || reader.getGeneration() == generation + 1);
+        assert(get(reader, "/prefs/channels.proto") == channels && get(reader, "/prefs/config.proto") == value);
+    }
+    std::cout << "Record store compaction test passed\n";
+}
+
+// What SafeFile costs per save on LittleFS: the temp file's data and the commits creating, closing and renaming it, a full
+// read back to verify, and a freshly allocated data block since the new file cannot share the old one's
+struct SafeFileModel {
+    static const uint32_t COMMIT = 64; // Bytes programmed per metadata commit, roughly a LittleFS tag plus its CRC
+    uint32_t programmed = 0, readBack = 0, erases = 0, fileOps = 0;
+
+    void save(size_t length) {
+        programmed += length + 3 * COMMIT;
+        readBack += length;
+        erases += (length + 4095) / 4096;
+        fileOps += 3; // Open the temp file, open it again to read back, rename
+    }
+};
+
+void benchmarkSaveToDisk() {
+    // NodeDB::saveToDisk() writes each of these whenever any of them changed, sizes from a node on a private channel
+    const struct {
+        const char *key;
+        size_t length;
+    } segments[] = {
+        {"/prefs/config.proto", 420},  {"/prefs/module.proto", 390}, {"/prefs/channels.proto", 760},
+        {"/prefs/device.proto", 180},  {"/prefs/uiconfig.proto", 60},
+    };
+    const int SAVES = 2000;
+
+    MemoryStorage flash;
+    RecordStore store(&flash);
+    store.mount();
+    SafeFileModel safeFile;
+    std::vector<std::string> values;
+    for (auto &segment : segments)
+        values.push_back(std::string(segment.length, 'v'));
+
+    uint32_t seed = 7;
+    for (int save = 0; save < SAVES; save++) {
+        // One setting changes, e.g. a channel edit or the device state's reboot count
+        seed = seed * 1103515245 + 12345;
+        std::string &changed = values[(seed >> 16) % values.size()];
+        changed[(seed >> 8) % changed.size()] ^= 1;
+        for (size_t i = 0; i < values.size(); i++) {
+            assert(put(store, segments[i].key, values[i]));
+            safeFile.save(values[i].size());
+        }
+    }
+    RecordStore reader(&flash);
+    assert(reader.mount());
+    for (size_t i = 0; i < values.size(); i++)
+        assert(get(reader, segments[i].key) == values[i]);
+
+    std::cout << SAVES << " saveToDisk calls of " << values.size() << " segments: SafeFile " << safeFile.programmed
+              << " bytes programmed, " << safeFile.readBack << " read back, " << safeFile.erases << " block erases, "
+              << safeFile.fileOps << " file operations; record store " << flash.programmed << " bytes programmed, "
+              << store.getUnchanged() << " of " << store.getUnchanged() + store.getPuts() << " saves skipped, "
+              << store.getCompactions() << " compactions, " << flash.erases << " segment erases\n";
+    assert(flash.programmed * 4 < safeFile.programmed);
+}
+
+int main() {
+    testBasics();
+    testFormat();
+    testTornWrites();
+    testCompaction();
+    benchmarkSaveToDisk();
+    return 0;
+}
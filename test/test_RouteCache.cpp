@@ -0,0 +1,200 @@
+#include "mesh/RouteCache.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_RouteCache.cpp src/mesh/RouteCache.cpp src/mesh/LinkTable.cpp
+
+static const uint32_t US = 0xa0000001;
+
+struct StringOutput {
+    std::string text;
+    void write(const uint8_t *bytes, size_t length) { text.append((const char *)bytes, length); }
+};
+
+static RouteCache::Path makePath(std::initializer_list<uint32_t> nodes, std::initializer_list<int> snrs) {
+    RouteCache::Path path = {};
+    for (uint32_t num : nodes) path.nodes[path.count++] = num;
+    size_t i = 0;
+    for (int snr : snrs) path.snr[i++] = (int8_t)snr;
+    return path;
+}
+
+void testTraced() {
+    RouteCache cache;
+    RouteCache::Route route;
+    assert(!cache.lookup(US, 0xb0000004, 0, route));
+
+    // Us > 2 > 3 > 4, and back 4 > 5 > us. SNRs in quarter dB as RouteDiscovery has them.
+    RouteCache::Path towards = makePath({US, 0xb0000002, 0xb0000003, 0xb0000004}, {20, -8, 4});
+    RouteCache::Path back = makePath({0xb0000004, 0xb0000005, US}, {-30, 12});
+    cache.learnRoute(towards, back, 1000);
+    assert(cache.lookup(US, 0xb0000004, 5000, route));
+    assert(route.sources == RouteCache::FROM_TRACEROUTE && route.learnedMs == 1000);
+    assert(route.towards.count == 4 && route.towards.nodes[2] == 0xb0000003 && route.towards.snr[2] == 4);
+    assert(route.back.count == 3 && route.back.nodes[1] == 0xb0000005);
+    assert(cache.edgeCount() == 5);
+
+    // Once the trace is old its edges still piece the route together, the fewest hops each way
+    uint32_t later = 1000 + RouteCache::ROUTE_MAX_AGE_MS + 1;
+    assert(cache.lookup(US, 0xb0000004, later, route));
+    assert(route.sources == RouteCache::FROM_TRACEROUTE && route.towards.count == 3); // Back over 5, snr unknown one way
+    assert(route.towards.nodes[1] == 0xb0000005 && route.towards.snr[0] == RouteCache::UNKNOWN_SNR);
+    assert(route.back.count == 3 && route.back.snr[0] == -30);
+    // and not at all once they are
+    assert(!cache.lookup(US, 0xb0000004, 1000 + RouteCache::EDGE_MAX_AGE_MS + 1, route));
+
+    // A hop that could not add itself breaks the chain
+    RouteCache gaps;
+    gaps.learnPath(makePath({US, RouteCache::UNKNOWN_NODE, 0xb0000009}, {RouteCache::UNKNOWN_SNR, 8}), 0);
+    assert(gaps.edgeCount() == 0 && !gaps.lookup(US, 0xb0000009, 0, route));
+    std::cout << "Route cache traced route test passed\n";
+}
+
+void testPieced() {
+    RouteCache cache;
+    // A line 1 > 2 > 3 > 4 > 5 from NeighborInfo, and a shortcut 2 > 5 that hardly works
+    for (uint32_t i = 1; i < 5; i++) cache.learnEdge(0xc0000000 + i, 0xc0000001 + i, 10, 90, RouteCache::FROM_NEIGHBORINFO, 0);
+    cache.learnEdge(0xc0000002, 0xc0000005, -40, 10, RouteCache::FROM_NEIGHBORINFO, 0);
+    cache.learnEdge(US, 0xc0000001, 24, 0, RouteCache::FROM_NEXT_HOP, 0);
+
+    RouteCache::Route route;
+    assert(cache.lookup(US, 0xc0000005, 100, route));
+    assert(route.towards.count == 6 && route.towards.nodes[5] == 0xc0000005 && route.towards.nodes[2] == 0xc0000002);
+    assert(route.sources == (RouteCache::FROM_NEIGHBORINFO | RouteCache::FROM_NEXT_HOP));
+    assert(route.back.count == 6 && route.back.nodes[5] == US);
+
+    // The shortcut once it delivers
+    cache.learnEdge(0xc0000002, 0xc0000005, -40, 60, RouteCache::FROM_TRACEROUTE, 200);
+    assert(cache.lookup(US, 0xc0000005, 300, route) && route.towards.count == 4 && route.towards.snr[2] == -40);
+    RouteCache::Edge edge;
+    assert(cache.findEdge(0xc0000002, 0xc0000005, edge) && edge.pdr == 60 && edge.updatedMs == 200);
+    assert(edge.sources == (RouteCache::FROM_NEIGHBORINFO | RouteCache::FROM_TRACEROUTE));
+    // Older news does not wind it back
+    cache.learnEdge(0xc0000002, 0xc0000005, 0, 5, RouteCache::FROM_NEIGHBORINFO, 100);
+    assert(cache.findEdge(0xc0000002, 0xc0000005, edge) && edge.pdr == 60 && edge.snr == -40);
+
+    // Nothing past MAX_PATH nodes
+    RouteCache chain;
+    for (uint32_t i = 0; i < 12; i++) chain.learnEdge(i ? 0xd0000000 + i : US, 0xd0000001 + i, 0, 0, RouteCache::FROM_LINK, 0);
+    assert(chain.lookup(US, 0xd0000000 + RouteCache::MAX_PATH - 1, 0, route));
+    assert(!chain.lookup(US, 0xd0000000 + RouteCache::MAX_PATH, 0, route));
+    std::cout << "Route cache pieced route test passed\n";
+}
+
+void testLinksAndQueue() {
+    LinkTable links;
+    links.heard(0xe0000001, 0, true, 6, -80, 0);
+    links.heard(0xe0000002, 0, true, -7.5, -110, 0);
+    RouteCache cache;
+    cache.learnLinks(links, US, 10);
+    RouteCache::Edge edge;
+    assert(cache.edgeCount() == 2);
+    assert(cache.findEdge(0xe0000002, US, edge) && edge.snr == -30 && edge.pdr == 0 && edge.sources == RouteCache::FROM_LINK);
+    RouteCache::Route route;
+    assert(cache.lookup(US, 0xe0000001, 10, route) && route.towards.count == 2);
+    // Past our links, the next hop NodeDB has, with the hops beyond it unknown
+    RouteCache::NextHop hop = {0xe0000009, 0xe0000001, 10, 3};
+    cache.learnNextHops(&hop, 1);
+    assert(cache.lookup(US, 0xe0000009, 20, route) && route.sources == RouteCache::FROM_NEXT_HOP && route.towards.count == 5);
+    assert(route.towards.nodes[1] == 0xe0000001 && route.towards.nodes[3] == RouteCache::UNKNOWN_NODE && route.back.count == 0);
+    assert(!cache.lookup(US, 0xe0000009, 10 + RouteCache::EDGE_MAX_AGE_MS + 1, route));
+    cache.learnNextHops(nullptr, 0);
+    assert(!cache.lookup(US, 0xe0000009, 20, route));
+
+    assert(cache.request(0xe0000001) && !cache.request(0xe0000001) && cache.request(0xe0000002));
+    assert(!cache.request(0) && !cache.request(RouteCache::UNKNOWN_NODE));
+    uint32_t dest;
+    assert(cache.takeRequest(dest) && dest == 0xe0000001 && cache.request(0xe0000001));
+    assert(cache.takeRequest(dest) && dest == 0xe0000002 && cache.takeRequest(dest) && !cache.takeRequest(dest));
+    for (uint32_t i = 1; i <= RouteCache::MAX_QUEUED; i++) assert(cache.request(i));
+    assert(!cache.request(0x7777) && cache.queued() == RouteCache::MAX_QUEUED);
+    cache.clear();
+    assert(cache.queued() == 0 && cache.edgeCount() == 0);
+
+    uint32_t nums[4];
+    assert(RouteCache::parseNodes("!a1b2c3d4,0x10,42,!zz,7x,,!ffffffff,0,99", nums, 4) == 4);
+    assert(nums[0] == 0xa1b2c3d4 && nums[1] == 0x10 && nums[2] == 42 && nums[3] == 99);
+    assert(RouteCache::parseNodes("", nums, 4) == 0 && RouteCache::parseNodes("!1,!2,!3", nums, 2) == 2 && nums[1] == 2);
+    std::cout << "Route cache links and queue test passed\n";
+}
+
+void testJSON() {
+    RouteCache cache;
+    cache.learnRoute(makePath({US, 0xb0000002, 0xb0000004}, {20, -6}), makePath({}, {}), 1000);
+    cache.learnEdge(0xb0000004, 0xb0000007, RouteCache::UNKNOWN_SNR, 77, RouteCache::FROM_NEIGHBORINFO, 3000);
+    StringOutput out;
+    {
+        JSONWriter<StringOutput> json(out);
+        cache.writeTopology(json, 61000);
+    }
+    const char *expected =
+        "{\"edges\":["
+        "{\"from\":\"!a0000001\",\"to\":\"!b0000002\",\"snr\":5,\"pdr\":null,\"age\":60,\"sources\":[\"traceroute\"]},"
+        "{\"from\":\"!b0000002\",\"to\":\"!b0000004\",\"snr\":-1.5,\"pdr\":null,\"age\":60,\"sources\":[\"traceroute\"]},"
+        "{\"from\":\"!b0000004\",\"to\":\"!b0000007\",\"snr\":null,\"pdr\":77,\"age\":58,\"sources\":[\"neighborinfo\"]}],"
+        "\"routes\":[{\"to\":\"!b0000004\",\"age\":60,\"sources\":[\"traceroute\"],"
+        "\"towards\":[\"!a0000001\",\"!b0000002\",\"!b0000004\"],\"snr_towards\":[5,-1.5],\"back\":[],\"snr_back\":[]}],"
+        "\"queued\":0}";
+    if (out.text != expected) printf("%s\n", out.text.c_str());
+    assert(out.text == expected);
+    std::cout << "Route cache JSON test passed\n";
+}
+
+static double nsPer(std::chrono::steady_clock::time_point start, int n) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+}
+
+void benchmarkLookups() {
+    // A farm: 30 nodes along a ditch, each heard by the next two, NeighborInfo from all of them, 10 recent traces
+    RouteCache cache;
+    uint32_t nodes[30];
+    for (uint32_t i = 0; i < 30; i++) nodes[i] = i ? 0xf0000000 + i * 17 : US;
+    for (uint32_t i = 0; i < 30; i++) {
+        for (uint32_t j = i + 1; j < 30 && j <= i + 2; j++)
+            cache.learnEdge(nodes[i], nodes[j], 8, 90, RouteCache::FROM_NEIGHBORINFO, 0);
+    }
+    for (uint32_t i = 0; i < 10; i++) {
+        uint32_t dest = nodes[4 + i];
+        RouteCache::Path towards = makePath({US, nodes[2], dest}, {8, 8});
+        cache.learnRoute(towards, makePath({dest, nodes[2], US}, {6, 6}), 0);
+    }
+
+    const int LOOKUPS = 20000;
+    RouteCache::Route route;
+    int found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOKUPS; i++) found += cache.lookup(US, nodes[4 + i % 10], 1000, route);
+    double traced = nsPer(start, LOOKUPS);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOKUPS; i++) found += cache.lookup(US, nodes[18 + i % 10], 1000, route);
+    double pieced = nsPer(start, LOOKUPS);
+    StringOutput out;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+        out.text.clear();
+        JSONWriter<StringOutput> json(out);
+        cache.writeTopology(json, 1000);
+    }
+    double topology = nsPer(start, 1000);
+
+    assert(found == 2 * LOOKUPS);
+    printf("%u edges among 30 nodes, %d lookups each:\n", (unsigned)cache.edgeCount(), LOOKUPS);
+    printf("  traced in the last %u min   %8.2f us\n", (unsigned)(RouteCache::ROUTE_MAX_AGE_MS / 60000), traced / 1000);
+    printf("  pieced from edges, 5-9 hops    %8.2f us\n", pieced / 1000);
+    printf("  whole topology as JSON    %8.2f us, %u bytes\n", topology / 1000, (unsigned)out.text.size());
+    // A traceroute 3 hops out and back is 6 transmissions of ~50 bytes, ~0.4 s each at LongFast, plus relay delays
+    printf("  a traceroute round trip, 3 hops at LongFast: ~2.5 s of airtime and 3-10 s of waiting\n");
+}
+
+int main() {
+    testTraced();
+    testPieced();
+    testLinksAndQueue();
+    testJSON();
+    benchmarkLookups();
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "mesh/TxBudget.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_TxBudget.cpp src/mesh/TxBudget.cpp
+
+// Stands in for the real packet, the budget only ever holds pointers to it
+struct _meshtastic_MeshPacket {
+    uint16_t port;
+    uint32_t airtimeMs;
+};
+
+static const uint16_t TEXT = 1, TELEMETRY = 67, IRRIGATION = 68, SERIAL_PORT = 64;
+static const TxBudget::Share SHARES[] = {{TEXT, 20}, {TELEMETRY, 15}, {IRRIGATION, 15}};
+static const uint32_t MINUTE = 60 * 1000UL, HOUR = 60 * MINUTE;
+
+void testAdmit() {
+    TxBudget budget(SHARES, 3);
+    assert(budget.bucketCount() == 4 && budget.bucket(3).port == TxBudget::OTHER_PORT && budget.bucket(3).percent == 50);
+    // No duty cycle, nothing to police
+    assert(budget.admit(TELEMETRY, 100000, true, 99, 0) == TxBudget::SEND && budget.totalHeld() == 0);
+
+    // 10%: telemetry refills at 1.5% of the time and starts with 10 minutes of that, 9 s. 1% of the hour is 36 s.
+    budget.setDutyCycle(10, 0);
+    const TxBudget::Bucket &telemetry = budget.bucket(1);
+    assert(telemetry.tokensMs == 9000);
+    for (int i = 0; i < 9; i++) assert(budget.admit(TELEMETRY, 1000, true, 6, 0) == TxBudget::SEND);
+    // While the hour has room it borrows, leaving room for 2 minutes of the others' shares, 0.24 + 0.18 + 0.6 s
+    assert(budget.admit(TELEMETRY, 1000, true, 6, 0) == TxBudget::SEND && telemetry.borrowed == 1);
+    assert(budget.admit(TELEMETRY, 1000, true, 9.95f, 0) == TxBudget::HOLD); // 1.8 s left
+    // which a port that can pay still gets, until the hour is full
+    assert(budget.admit(TEXT, 1000, true, 9.95f, 0) == TxBudget::SEND);
+    assert(budget.admit(TEXT, 1000, true, 10, 0) == TxBudget::HOLD);
+    // Ports without a share of their own are not affected, and one that must go goes, into debt
+    assert(budget.admit(SERIAL_PORT, 1000, true, 9.5f, 0) == TxBudget::SEND);
+    assert(budget.admit(TELEMETRY, 1000, false, 10, 0) == TxBudget::SEND && telemetry.tokensMs == -2000);
+    assert(budget.admit(TELEMETRY, 1000, false, 10, 0) == TxBudget::SEND);
+    for (int i = 0; i < 20; i++) budget.admit(TELEMETRY, 1000, false, 10, 0);
+    assert(telemetry.tokensMs == -9000); // No deeper than a full bucket
+
+    // Refills: 1 s of airtime takes 66.7 s to earn back
+    TxBudget fresh(SHARES, 3);
+    fresh.setDutyCycle(10, 0);
+    for (int i = 0; i < 9; i++) fresh.admit(TELEMETRY, 1000, true, 6, 0);
+    assert(fresh.admit(TELEMETRY, 1000, true, 9.95f, 66000) == TxBudget::HOLD);
+    assert(fresh.admit(TELEMETRY, 1000, true, 9.95f, 67000) == TxBudget::SEND);
+    std::cout << "TX budget admit test passed\n";
+}
+
+void testHold() {
+    TxBudget budget(SHARES, 3);
+    budget.setDutyCycle(10, 0);
+    _meshtastic_MeshPacket packets[TxBudget::HOLD_PER_PORT + 2] = {};
+    bool expired;
+    for (int i = 0; i < 9; i++) budget.admit(TELEMETRY, 1000, true, 9.95f, 0);
+    // Held in order
+    assert(budget.admit(TELEMETRY, 1000, true, 9.95f, 0) == TxBudget::HOLD);
+    assert(!budget.hold(&packets[0], TELEMETRY, 1000, 0));
+    assert(budget.admit(TELEMETRY, 1000, true, 9.95f, 0) == TxBudget::HOLD);
+    assert(!budget.hold(&packets[1], TELEMETRY, 1000, 0));
+    assert(budget.admit(TEXT, 1000, true, 9.95f, 0) == TxBudget::SEND);
+    assert(!budget.takeReady(9.95f, 1000, expired));
+    // and later ones of the port queue behind them, even once there is room
+    assert(budget.admit(TELEMETRY, 1000, true, 1, 67000) == TxBudget::HOLD);
+    assert(!budget.hold(&packets[2], TELEMETRY, 1000, 67000) && budget.heldCount() == 3);
+
+    assert(budget.takeReady(9.95f, 67000, expired) == &packets[0] && !expired);
+    assert(!budget.takeReady(9.95f, 67000, expired));
+    assert(budget.takeReady(9.95f, 134000, expired) == &packets[1]);
+    assert(budget.takeReady(2, 134000, expired) == &packets[2]); // Borrowing once the hour has room
+    assert(budget.heldCount() == 0 && budget.bucket(1).borrowed == 1);
+
+    // A port that can pay goes ahead of one that would borrow, however long that has waited
+    TxBudget order(SHARES, 3);
+    order.setDutyCycle(10, 0);
+    for (int i = 0; i < 9; i++) order.admit(TELEMETRY, 1000, true, 6, 0);
+    assert(order.admit(TELEMETRY, 1000, true, 10, 0) == TxBudget::HOLD);
+    assert(!order.hold(&packets[0], TELEMETRY, 1000, 0));
+    assert(order.admit(IRRIGATION, 1000, true, 10, 10) == TxBudget::HOLD);
+    assert(!order.hold(&packets[1], IRRIGATION, 1000, 10));
+    // and a borrower of another port waits behind it even when the hour has room
+    order.admit(SERIAL_PORT, 30000, false, 6, 10);
+    assert(order.admit(SERIAL_PORT, 1000, true, 5, 20) == TxBudget::HOLD);
+    assert(order.takeReady(9.95f, 20, expired) == &packets[1]);
+    assert(!order.takeReady(9.95f, 20, expired));
+    assert(order.takeReady(5, 20, expired) == &packets[0]);
+
+    // A full queue: a newer one pushes out the oldest of its port, and other ports still have all of theirs
+    TxBudget full(SHARES, 3);
+    full.setDutyCycle(10, 0);
+    full.admit(TELEMETRY, 9000, true, 9.95f, 0);
+    assert(full.admit(TELEMETRY, 9000, true, 9.95f, 0) == TxBudget::HOLD);
+    for (size_t i = 0; i < TxBudget::HOLD_PER_PORT; i++) assert(!full.hold(&packets[i], TELEMETRY, 9000, i));
+    assert(full.hold(&packets[TxBudget::HOLD_PER_PORT], TELEMETRY, 9000, 20) == &packets[0]);
+    assert(!full.hold(&packets[TxBudget::HOLD_PER_PORT + 1], IRRIGATION, 9000, 20));
+    assert(full.totalDropped() == 1 && full.heldCount() == TxBudget::HOLD_PER_PORT + 1);
+    // and nothing is held forever
+    assert(full.takeReady(9.95f, 1 + TxBudget::MAX_HOLD_MS + 1, expired) == &packets[1] && expired);
+    assert(full.mostHeld()->port == TELEMETRY);
+    std::cout << "TX budget hold test passed\n";
+}
+
+/**
+ * Two hours of a node at 10% duty cycle. The router refuses everything once the last hour's transmissions are over it.
+ * Irrigation sends a packet a minute and someone sends a text every 5 minutes, both within their share. The sensors sweep
+ * every 10 minutes: 40 telemetry packets, 5 times their share but with the rest of the hour still under the duty cycle, or
+ * 60, which on their own are more than the duty cycle allows.
+ */
+struct Outcome {
+    uint32_t sent[3], refused[3], dropped[3];
+    size_t held; // Still waiting at the end
+};
+
+static Outcome simulate(bool withBudget, int sweep) {
+    TxBudget budget(SHARES, 3);
+    if (withBudget) budget.setDutyCycle(10, 0);
+    std::deque<std::pair<uint32_t, uint32_t>> log; // When, how long
+    uint32_t lastHourMs = 0;
+    Outcome outcome = {};
+    std::vector<_meshtastic_MeshPacket> store(4000);
+    size_t used = 0;
+    auto kind = [](uint16_t port) { return port == TEXT ? 0 : port == IRRIGATION ? 1 : 2; };
+    auto transmit = [&](_meshtastic_MeshPacket *p, uint32_t now) {
+        if (lastHourMs * 100 > 10 * HOUR) {
+            outcome.refused[kind(p->port)]++;
+            return;
+        }
+        log.push_back(std::make_pair(now, p->airtimeMs));
+        lastHourMs += p->airtimeMs;
+        outcome.sent[kind(p->port)]++;
+    };
+    auto offer = [&](uint16_t port, uint32_t airtimeMs, uint32_t now) {
+        _meshtastic_MeshPacket *p = &store[used++];
+        p->port = port;
+        p->airtimeMs = airtimeMs;
+        float txPercent = lastHourMs * 100.0f / HOUR;
+        if (budget.admit(port, airtimeMs, true, txPercent, now) == TxBudget::SEND) {
+            transmit(p, now);
+            return;
+        }
+        meshtastic_MeshPacket *dropped = budget.hold(p, port, airtimeMs, now);
+        if (dropped) outcome.dropped[kind(dropped->port)]++;
+    };
+    for (uint32_t now = 0; now < 2 * HOUR; now += 1000) {
+        while (!log.empty() && now - log.front().first >= HOUR) {
+            lastHourMs -= log.front().second;
+            log.pop_front();
+        }
+        if (now % (10 * MINUTE) == 0)
+            for (int i = 0; i < sweep; i++) offer(TELEMETRY, 1200, now);
+        if (now % MINUTE == 5000) offer(IRRIGATION, 800, now);
+        if (now % (5 * MINUTE) == 7000) offer(TEXT, 1000, now);
+        bool expired;
+        meshtastic_MeshPacket *p;
+        while ((p = budget.takeReady(lastHourMs * 100.0f / HOUR, now, expired)) != nullptr) {
+            if (expired)
+                outcome.dropped[kind(p->port)]++;
+            else
+                transmit(p, now);
+        }
+    }
+    outcome.held = budget.heldCount();
+    return outcome;
+}
+
+void benchmarkBudget() {
+    const char *names[] = {"text", "irrigation", "telemetry"};
+    for (int sweep = 40; sweep <= 60; sweep += 20) {
+        printf("Two hours at 10%% duty cycle, %d telemetry packets a sweep: sent / refused by the router / dropped by the "
+               "budget\n",
+               sweep);
+        for (int withBudget = 0; withBudget < 2; withBudget++) {
+            Outcome o = simulate(withBudget, sweep);
+            printf("  %-16s", withBudget ? "token buckets" : "first come");
+            for (int k = 0; k < 3; k++) printf("  %s %3u/%3u/%3u", names[k], o.sent[k], o.refused[k], o.dropped[k]);
+            printf("  (%u held)\n", (unsigned)o.held);
+            if (withBudget) {
+                for (int k = 0; k < 3; k++) assert(o.refused[k] == 0);
+                assert(o.dropped[0] == 0 && o.dropped[1] == 0);
+                if (sweep == 40) assert(o.dropped[2] == 0 && o.held == 0);
+            } else {
+                assert(o.refused[1] > 0 || sweep == 40);
+            }
+        }
+    }
+
+    TxBudget budget(SHARES, 3);
+    budget.setDutyCycle(10, 0);
+    const int N = 2000000;
+    uint32_t sends = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) sends += budget.admit(i & 1 ? TELEMETRY : SERIAL_PORT, 50, false, 6, i) == TxBudget::SEND;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+    printf("admit() %.1f ns per packet (%u sent)\n", ns, sends);
+}
+
+int main() {
+    testAdmit();
+    testHold();
+    benchmarkBudget();
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include "mesh/udp/UdpBatch.h"
+#include "platform/portduino/MulticastSocket.h"
+#include <arpa/inet.h>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// Build: g++ -std=c++11 -O2 -Isrc test/test_UdpBatch.cpp src/platform/portduino/MulticastSocket.cpp
+
+using namespace UdpBatch;
+
+// An encrypted MeshPacket as a relaying gateway encodes it, field by field
+static std::vector<uint8_t> encodePacket(uint32_t from, uint32_t id, uint8_t hopLimit, uint8_t hopStart, size_t payload) {
+    std::vector<uint8_t> out;
+    auto fixed32 = [&](uint8_t field, uint32_t v) {
+        out.push_back(field << 3 | 5);
+        for (int i = 0; i < 4; i++) out.push_back(v >> (8 * i));
+    };
+    auto raw = [&](uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(v | 0x80);
+            v >>= 7;
+        }
+        out.push_back(v);
+    };
+    auto varint = [&](uint32_t key, uint32_t v) {
+        raw(key);
+        raw(v);
+    };
+    fixed32(1, from);
+    fixed32(2, 0xffffffff);
+    varint(3 << 3, 8);
+    varint(5 << 3 | 2, payload);
+    for (size_t i = 0; i < payload; i++) out.push_back(i * 31 + id);
+    fixed32(6, id);
+    fixed32(7, 1760000000);
+    varint(9 << 3, hopLimit);
+    varint(11 << 3, 64);
+    varint(15 << 3, hopStart);
+    varint(18 << 3, 0x42);
+    varint(19 << 3, 0x17);
+    return out;
+}
+
+void testFraming() {
+    std::vector<std::vector<uint8_t>> packets;
+    Datagram d;
+    for (uint32_t i = 0;; i++) {
+        std::vector<uint8_t> p = encodePacket(0x1000 + i, 0x5000 + i, 3, 7, 40 + i * 10);
+        size_t room;
+        uint8_t *at = d.reserve(room);
+        if (p.size() > room) break;
+        memcpy(at, p.data(), p.size());
+        d.commit(p.size());
+        packets.push_back(p);
+    }
+    assert(d.count == packets.size() && d.count >= 3 && d.length <= MAX_DATAGRAM);
+    assert(isBatch(d.bytes, d.length));
+
+    size_t seen = 0;
+    size_t n = forEach(d.bytes, d.length, [&](const uint8_t *bytes, size_t length) {
+        assert(length == packets[seen].size() && memcmp(bytes, packets[seen].data(), length) == 0);
+        seen++;
+    });
+    assert(n == packets.size() && seen == n);
+
+    // A legacy datagram is one bare packet, which never starts with a zero byte
+    std::vector<uint8_t> bare = encodePacket(1, 2, 3, 3, 20);
+    assert(!isBatch(bare.data(), bare.size()));
+    assert(forEach(bare.data(), bare.size(), [](const uint8_t *, size_t) {}) == 1);
+
+    // Cut short, the last record is dropped; from a newer version, the whole batch
+    assert(forEach(d.bytes, d.length - 1, [](const uint8_t *, size_t) {}) == packets.size() - 1);
+    d.bytes[1] = VERSION + 1;
+    assert(forEach(d.bytes, d.length, [](const uint8_t *, size_t) {}) == 0);
+    std::cout << "UDP batch framing test passed, " << packets.size() << " packets in " << d.length << " bytes\n";
+}
+
+void testPeek() {
+    std::vector<uint8_t> p = encodePacket(0xdeadbeef, 0x12345678, 2, 5, 200);
+    Ids ids;
+    assert(peek(p.data(), p.size(), ids));
+    assert(ids.from == 0xdeadbeef && ids.to == 0xffffffff && ids.id == 0x12345678 && ids.encrypted);
+    assert(ids.hopLimit == 2 && ids.hopStart == 5 && ids.nextHop == 0x42 && ids.relayNode == 0x17);
+
+    // Lengths running past the end, and a wire type protobuf doesn't have
+    for (size_t cut = 1; cut < p.size(); cut++) {
+        Ids partial;
+        bool ok = peek(p.data(), cut, partial);
+        if (ok) assert(partial.from == 0xdeadbeef || cut < 5);
+    }
+    uint8_t bad[] = {0x0f, 1, 2, 3};
+    assert(!peek(bad, sizeof(bad), ids));
+
+    RecentRing<4> ring;
+    Ids copy = {1, 0xffffffff, 100, 2, 3, 0, 0x11, true};
+    assert(!ring.checkAndAdd(copy) && ring.checkAndAdd(copy));
+    Ids relayed = copy;
+    relayed.hopLimit = 1;
+    relayed.relayNode = 0x22;
+    assert(!ring.checkAndAdd(relayed)); // A relay is another transmission
+    Ids other = copy;
+    other.from = 2;
+    assert(!ring.checkAndAdd(other));
+    for (uint32_t i = 0; i < 4; i++) {
+        other.id = i + 1;
+        ring.checkAndAdd(other);
+    }
+    assert(!ring.checkAndAdd(copy)); // Pushed out
+    std::cout << "UDP batch peek test passed\n";
+}
+
+static double cpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct Result {
+    double packetsPerSecond, cpuMicrosPerPacket;
+    uint32_t delivered, syscalls;
+};
+
+// Every LoRa packet is bridged by each of the other gateways, so a gateway hears each one COPIES times
+static constexpr int PACKETS = 100000, COPIES = 5, ROUND = 16;
+static constexpr uint32_t GROUP = 0xe0000045;
+static constexpr uint16_t PORT = 44031;
+// On loopback, so the numbers are the bridge's and not the NIC's
+static constexpr uint32_t LOOPBACK = 0x7f000001;
+
+// Before: one datagram per packet, one sendto and one recvfrom each, every copy handed on
+static Result runLegacy(const std::vector<std::vector<uint8_t>> &packets) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    int on = 1;
+    unsigned char loop = 1;
+    sockaddr_in local = {}, group = {};
+    local.sin_family = group.sin_family = AF_INET;
+    local.sin_port = group.sin_port = htons(PORT);
+    group.sin_addr.s_addr = htonl(GROUP);
+    ip_mreq membership = {};
+    membership.imr_multiaddr.s_addr = htonl(GROUP);
+    membership.imr_interface.s_addr = htonl(LOOPBACK);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    bind(fd, (sockaddr *)&local, sizeof(local));
+    setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership));
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &membership.imr_interface, sizeof(membership.imr_interface));
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+    Result r = {};
+    uint8_t buffer[MulticastSocket::DATAGRAM_BYTES];
+    double cpu = cpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    for (int base = 0; base < PACKETS; base += ROUND) {
+        for (int copy = 0; copy < COPIES; copy++) {
+            for (int i = base; i < base + ROUND && i < PACKETS; i++) {
+                const std::vector<uint8_t> &p = packets[i];
+                sendto(fd, p.data(), p.size(), 0, (sockaddr *)&group, sizeof(group));
+                r.syscalls++;
+            }
+        }
+        for (;;) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            r.syscalls++;
+            if (n <= 0) break;
+            Ids ids;
+            if (peek(buffer, n, ids)) r.delivered++;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.packetsPerSecond = PACKETS * COPIES / elapsed;
+    r.cpuMicrosPerPacket = (cpuSeconds() - cpu) * 1e6 / (PACKETS * COPIES);
+    close(fd);
+    return r;
+}
+
+// After: packets packed into batches, moved BATCH datagrams per system call, copies dropped at the edge
+static Result runBatched(const std::vector<std::vector<uint8_t>> &packets) {
+    MulticastSocket socket;
+    bool listening = socket.listen(GROUP, PORT, 1, LOOPBACK);
+    assert(listening);
+    RecentRing<32> recent;
+
+    Result r = {};
+    std::vector<Datagram> datagrams(MulticastSocket::BATCH);
+    double cpu = cpuSeconds();
+    auto start = std::chrono::steady_clock::now();
+    for (int base = 0; base < PACKETS; base += ROUND) {
+        for (int copy = 0; copy < COPIES; copy++) {
+            size_t used = 0;
+            datagrams[0].clear();
+            auto flush = [&]() {
+                const uint8_t *bytes[MulticastSocket::BATCH];
+                size_t lengths[MulticastSocket::BATCH];
+                for (size_t d = 0; d <= used; d++) {
+                    bytes[d] = datagrams[d].bytes;
+                    lengths[d] = datagrams[d].length;
+                }
+                socket.send(bytes, lengths, used + 1);
+                used = 0;
+                datagrams[0].clear();
+            };
+            for (int i = base; i < base + ROUND && i < PACKETS; i++) {
+                const std::vector<uint8_t> &p = packets[i];
+                size_t room;
+                uint8_t *at = datagrams[used].reserve(room);
+                if (p.size() > room) {
+                    if (used + 1 == MulticastSocket::BATCH) flush();
+                    else datagrams[++used].clear();
+                    at = datagrams[used].reserve(room);
+                }
+                memcpy(at, p.data(), p.size());
+                datagrams[used].commit(p.size());
+            }
+            flush();
+        }
+        while (socket.receive([&](const uint8_t *bytes, size_t length) {
+            forEach(bytes, length, [&](const uint8_t *packet, size_t packetLength) {
+                Ids ids;
+                if (peek(packet, packetLength, ids) && !recent.checkAndAdd(ids)) r.delivered++;
+            });
+        })) {
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.packetsPerSecond = PACKETS * COPIES / elapsed;
+    r.cpuMicrosPerPacket = (cpuSeconds() - cpu) * 1e6 / (PACKETS * COPIES);
+    r.syscalls = socket.getCalls();
+    return r;
+}
+
+void benchmarkBridge() {
+    std::vector<std::vector<uint8_t>> packets;
+    size_t bytes = 0;
+    for (int i = 0; i < PACKETS; i++) {
+        // Mostly telemetry and irrigation reports, some texts and positions
+        packets.push_back(encodePacket(0x1000 + i % 40, 0x70000000 + i, 2, 3, 20 + (i * 37) % 90));
+        bytes += packets.back().size();
+    }
+    printf("UDP bridge, %d packets each heard from %d gateways, %zu bytes on average:\n", PACKETS, COPIES, bytes / PACKETS);
+    Result legacy = runLegacy(packets);
+    Result batched = runBatched(packets);
+    printf("  one per datagram  %8.0f packets/s  %5.2f us CPU/packet  %5.2f syscalls/packet  %6u handed on\n",
+           legacy.packetsPerSecond, legacy.cpuMicrosPerPacket, legacy.syscalls / (double)(PACKETS * COPIES), legacy.delivered);
+    printf("  batched + mmsg    %8.0f packets/s  %5.2f us CPU/packet  %5.2f syscalls/packet  %6u handed on\n",
+           batched.packetsPerSecond, batched.cpuMicrosPerPacket, batched.syscalls / (double)(PACKETS * COPIES),
+           batched.delivered);
+    assert(legacy.delivered == PACKETS * COPIES && batched.delivered == PACKETS);
+}
+
+int main() {
+    testFraming();
+    testPeek();
+    benchmarkBridge();
+    return 0;
+}
@@ -1,7 +1,50 @@
 #include "modules/sensors/WaterLevelSensor.h"
+#include "modules/sensors/SensorPipeline.h"
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
+using namespace SensorPipeline;
+
+// Canal level traces recorded at 10 s intervals (ft). Quiet overnight flow, then a headgate
+// opening upstream that raises the level ~0.8 ft over a few minutes, with one bad I2C spike.
+static const float QUIET_TRACE[] = {
+    2.41, 2.42, 2.41, 2.40, 2.41, 2.42, 2.41, 2.41, 2.42, 2.41, 2.40, 2.41, 2.41, 2.42, 2.41, 2.41,
+    2.40, 2.41, 2.42, 2.41, 2.41, 2.40, 2.41, 2.42, 2.41, 2.41, 2.42, 2.41, 2.40, 2.41, 2.41, 2.42,
+};
+static const float GATE_EVENT_TRACE[] = {
+    2.41, 2.41, 2.42, 2.41, 2.40, 2.41, 9.99, 2.41, 2.42, 2.41, // spike at index 6
+    2.45, 2.52, 2.61, 2.72, 2.83, 2.94, 3.03, 3.10, 3.15, 3.19,
+    3.21, 3.22, 3.22, 3.23, 3.22, 3.22, 3.23, 3.22, 3.22, 3.23,
+};
+static constexpr uint32_t SAMPLE_MS = 10000;
+
+struct ReplayResult {
+    int reports = 0;
+    int thresholdReports = 0;
+    int firstThresholdIndex = -1;
+    float maxFiltered = 0;
+};
+
+template <size_t N> static ReplayResult replay(const float (&trace)[N], const PipelineConfig &cfg) {
+    LevelPipeline<16> pipeline(cfg);
+    pipeline.configure(cfg);
+    ReplayResult r;
+    for (size_t i = 0; i < N; i++) {
+        uint32_t now = i * SAMPLE_MS;
+        pipeline.addSample(trace[i], now);
+        if (pipeline.value() > r.maxFiltered) r.maxFiltered = pipeline.value();
+        ReportReason reason = pipeline.takeReport(now);
+        if (reason == REPORT_NONE) continue;
+        r.reports++;
+        if (reason == REPORT_THRESHOLD) {
+            r.thresholdReports++;
+            if (r.firstThresholdIndex < 0) r.firstThresholdIndex = i;
+        }
+    }
+    return r;
+}
+
 void testWaterLevelSensor() {
     WaterLevelSensor sensor;
     assert(sensor.init());
@@ -10,7 +53,100 @@ void testWaterLevelSensor() {
     std::cout << "Water level test passed: " << level << " ft\n";
 }
 
+void testQuietTraceStaysQuiet() {
+    PipelineConfig cfg;
+    cfg.deadband = 0.05f;
+    cfg.heartbeatMs = 0;
+    ReplayResult r = replay(QUIET_TRACE, cfg);
+    // Only the initial report; +/-0.01 ft noise never leaves the deadband
+    assert(r.reports == 1);
+    // The old timer sent one report per sample
+    std::cout << "Quiet trace: " << r.reports << " report(s) for " << sizeof(QUIET_TRACE) / sizeof(float)
+              << " samples\n";
+}
+
+void testSpikeRejected() {
+    PipelineConfig cfg;
+    cfg.heartbeatMs = 0;
+    LevelPipeline<16> pipeline(cfg);
+    for (int i = 0; i < 10; i++) {
+        pipeline.addSample(GATE_EVENT_TRACE[i], i * SAMPLE_MS);
+    }
+    // Median filter removes the 9.99 ft glitch before it reaches the EMA
+    assert(std::fabs(pipeline.value() - 2.41f) < 0.02f);
+    std::cout << "Spike rejection test passed: " << pipeline.value() << " ft\n";
+}
+
+void testThresholdCrossingReportsImmediately() {
+    PipelineConfig cfg;
+    cfg.deadband = 1.0f; // Large deadband so only the threshold can trigger
+    cfg.alertLevel = 2.8f;
+    cfg.criticalLevel = 3.1f;
+    cfg.heartbeatMs = 0;
+    ReplayResult r = replay(GATE_EVENT_TRACE, cfg);
+    assert(r.thresholdReports == 2); // NORMAL -> ALERT -> CRITICAL, no flapping
+    assert(r.firstThresholdIndex > 10 && r.firstThresholdIndex < 20);
+    std::cout << "Threshold test passed: first crossing at sample " << r.firstThresholdIndex << "\n";
+}
+
+void testHysteresisPreventsFlapping() {
+    PipelineConfig cfg;
+    cfg.medianWindow = 1;
+    cfg.emaAlpha = 1.0f;
+    cfg.deadband = 10.0f;
+    cfg.alertLevel = 3.0f;
+    cfg.hysteresis = 0.05f;
+    cfg.heartbeatMs = 0;
+    LevelPipeline<16> pipeline(cfg);
+    const float hover[] = {2.90, 3.01, 2.98, 3.02, 2.97, 3.01, 2.99, 2.90};
+    int thresholdReports = 0;
+    for (size_t i = 0; i < sizeof(hover) / sizeof(float); i++) {
+        pipeline.addSample(hover[i], i * SAMPLE_MS);
+        if (pipeline.takeReport(i * SAMPLE_MS) == REPORT_THRESHOLD) thresholdReports++;
+    }
+    // Enter once at 3.01, leave once at 2.90
+    assert(thresholdReports == 2);
+    std::cout << "Hysteresis test passed\n";
+}
+
+void testRateOfChangeAndBatch() {
+    PipelineConfig cfg;
+    cfg.deadband = 5.0f;
+    cfg.maxRatePerMin = 0.1f;
+    cfg.heartbeatMs = 0;
+    LevelPipeline<16> pipeline(cfg);
+    int rateReports = 0;
+    for (size_t i = 0; i < sizeof(GATE_EVENT_TRACE) / sizeof(float); i++) {
+        pipeline.addSample(GATE_EVENT_TRACE[i], i * SAMPLE_MS);
+        if (pipeline.takeReport(i * SAMPLE_MS) == REPORT_RATE) rateReports++;
+    }
+    // One report for the whole rise, not one per sample
+    assert(rateReports == 1);
+    float batch[8];
+    assert(pipeline.copyBatch(batch, 8) <= 8);
+    std::cout << "Rate-of-change test passed\n";
+}
+
+void testDefaultThresholdsNeverAlert() {
+    WaterLevelSensor sensor;
+    for (uint32_t i = 0; i < 5; i++) {
+        sensor.addSample(4.0f, i * SAMPLE_MS);
+    }
+    // criticalLevel defaults to 0 which means "not configured"
+    assert(!sensor.checkAlerts());
+    sensor.setThresholds(3.0f, 3.5f);
+    sensor.addSample(4.0f, 5 * SAMPLE_MS);
+    assert(sensor.checkAlerts());
+    std::cout << "Default threshold test passed\n";
+}
+
 int main() {
     testWaterLevelSensor();
+    testQuietTraceStaysQuiet();
+    testSpikeRejected();
+    testThresholdCrossingReportsImmediately();
+    testHysteresisPreventsFlapping();
+    testRateOfChangeAndBatch();
+    testDefaultThresholdsNeverAlert();
     return 0;
 }
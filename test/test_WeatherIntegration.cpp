@@ -1,16 +1,172 @@
 #include "modules/weather/WeatherIntegration.h"
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
+// Build: g++ -std=c++11 -O2 -Isrc test/test_WeatherIntegration.cpp src/modules/weather/EvapotranspirationEngine.cpp
+
+static bool near(float actual, float expected, float tolerance) {
+    return std::fabs(actual - expected) <= tolerance;
+}
+
 void testWeatherIntegration() {
+    IrrigationScheduler scheduler;
+    scheduler.addSchedule(1, 6, 0, 60, true);
     WeatherIntegration weather;
+    weather.setLocation(43.6f, 820);
+    weather.setDayOfYear(190);
+    weather.attachScheduler(&scheduler);
+    ET::ZoneBalance *corn = weather.addZone(1, ET::CROP_CORN, 120);
+
     weather.updateLocalWeather(75.0, 50.0, 10.0, 0.2); // temp, humidity, wind, rain
-    float et = weather.calculateET(75.0, 50.0, 10.0);
+    float et = weather.calculateET();
     assert(et > 0);
-    std::cout << "Weather integration test passed, ET: " << et << "\n";
+
+    // A hot afternoon widens the range, so today's ET goes up
+    weather.updateLocalWeather(95.0, 20.0, 10.0, 0);
+    assert(weather.calculateET() > et);
+
+    // Booked hour by hour, a day depletes the zone, and a dry week and a half gives it a run time
+    for (int h = 0; h < 24; h++) {
+        weather.advanceHour();
+    }
+    weather.endOfDay();
+    assert(weather.getDailyET() > et && corn->depletionMm > 0 && scheduler.getZoneDuration(1) == 0);
+    for (int day = 0; day < 10; day++) {
+        weather.updateLocalWeather(70.0, 60.0, 8.0, 0);
+        weather.updateLocalWeather(95.0, 20.0, 12.0, 0);
+        for (int h = 0; h < 24; h++) {
+            weather.advanceHour();
+        }
+        weather.endOfDay();
+    }
+    assert(corn->needsIrrigation() && scheduler.getZoneDuration(1) > 0);
+    std::cout << "Weather integration test passed, ET: " << weather.getDailyET() << " in/day\n";
+}
+
+// Published values from FAO Irrigation and Drainage Paper 56 (Allen et al., 1998)
+void testFao56Examples() {
+    // Table 2.3: saturation vapour pressure
+    assert(near(ET::saturationVaporPressure(20.0f), 2.338f, 0.002f));
+    assert(near(ET::saturationVaporPressure(35.5f), 5.780f, 0.01f));
+    assert(near(ET::saturationVaporPressure(12.3f), 1.431f, 0.002f));
+
+    // Example 8: Ra at 20°S on 3 September = 32.2 MJ m-2 day-1
+    assert(near(ET::extraterrestrialRadiationExact(-20.0f, 246), 32.2f, 0.1f));
+    assert(near(ET::extraterrestrialRadiation(-20.0f, 246), 32.2f, 0.2f));
+
+    // Example 9: daylight hours at 20°S on 3 September = 11.7 h
+    assert(near(ET::daylightHours(-20.0f, 246), 11.7f, 0.1f));
+
+    // Example 18: Brussels, 6 July, 50°48'N, 100 m. ET0 = 3.9 mm/day
+    ET::Site brussels;
+    brussels.latitudeDeg = 50.8f;
+    brussels.elevationM = 100;
+    ET::DailyWeather july6;
+    july6.tMaxC = 21.5f;
+    july6.tMinC = 12.3f;
+    july6.rhMax = 84;
+    july6.rhMin = 63;
+    july6.windMs = ET::windSpeedAt2m(10.0f / 3.6f, 10.0f); // 10 km/h at 10 m
+    july6.sunshineHours = 9.25f;
+    assert(near(july6.windMs, 2.078f, 0.01f));
+    assert(near(ET::extraterrestrialRadiation(50.8f, 187), 41.09f, 0.3f));
+    float et0 = ET::penmanMonteith(july6, brussels, 187);
+    assert(near(et0, 3.9f, 0.1f));
+
+    // Table lookup stays within 1.5% of the exact Ra over the whole table range
+    float worst = 0;
+    for (int lat = -60; lat <= 60; lat += 3) {
+        for (int doy = 1; doy <= 365; doy += 5) {
+            float exact = ET::extraterrestrialRadiationExact(lat, doy);
+            if (exact < 5) continue;
+            float err = std::fabs(ET::extraterrestrialRadiation(lat, doy) - exact) / exact;
+            if (err > worst) worst = err;
+        }
+    }
+    assert(worst < 0.015f);
+    std::cout << "FAO-56 validation passed, Brussels ET0 " << et0 << " mm/day, worst Ra table error "
+              << worst * 100 << "%\n";
+}
+
+void testCropCoefficients() {
+    // Corn: 0.30 during the initial stage, 1.20 mid-season, 0.60 at harvest
+    assert(near(ET::cropCoefficient(ET::CROP_CORN, 10), 0.30f, 0.001f));
+    assert(near(ET::cropCoefficient(ET::CROP_CORN, 50), 0.75f, 0.001f)); // halfway through development
+    assert(near(ET::cropCoefficient(ET::CROP_CORN, 100), 1.20f, 0.001f));
+    assert(near(ET::cropCoefficient(ET::CROP_CORN, 200), 0.60f, 0.001f));
+    assert(ET::daysSince(350, 10) == 25);
+    std::cout << "Kc curve test passed\n";
+}
+
+void testWaterBalanceDrivesSchedule() {
+    IrrigationScheduler scheduler;
+    scheduler.addSchedule(1, 6, 0, 60, true);
+    scheduler.addSchedule(2, 7, 0, 60, true);
+
+    ET::WaterBalance balance;
+    ET::ZoneBalance *corn = balance.addZone(1, ET::CROP_CORN, 120);
+    ET::ZoneBalance *wheat = balance.addZone(2, ET::CROP_SPRING_WHEAT, 90);
+    corn->rootDepthM = 0.6f;
+    wheat->rootDepthM = 1.0f;
+
+    // Ten dry days at 7 mm/day in mid-July
+    for (uint16_t doy = 190; doy < 200; doy++) {
+        balance.advance(7.0f, 0, doy);
+    }
+    assert(corn->needsIrrigation());
+    balance.applyToScheduler(scheduler);
+    uint16_t cornMinutes = scheduler.getZoneDuration(1);
+    assert(cornMinutes > 0);
+    // Gross depth = Dr / efficiency, at 10 mm/h
+    assert(near(cornMinutes, corn->depletionMm / 0.75f / 10.0f * 60.0f, 1.0f));
+
+    // Water it and a big rain: both zones back to field capacity, schedule skips them
+    balance.recordIrrigation(1, cornMinutes / 60.0f * 10.0f);
+    balance.advance(0, 80.0f, 200);
+    balance.applyToScheduler(scheduler);
+    assert(scheduler.getZoneDuration(1) == 0);
+    assert(scheduler.getZoneDuration(2) == 0);
+    scheduler.checkSchedule(6, 0);
+    assert(!scheduler.isIrrigating());
+    std::cout << "Water balance test passed, corn run time " << cornMinutes << " min\n";
+}
+
+void benchmarkZoneUpdates() {
+    static constexpr int ZONES = ET::WaterBalance::MAX_ZONES;
+    static constexpr int HOURS = 24 * 30;
+    ET::WaterBalance balance;
+    for (int z = 0; z < ZONES; z++) {
+        balance.addZone(z, static_cast<ET::CropType>(z % ET::CROP_COUNT), 100 + z);
+    }
+    ET::Site site;
+    site.latitudeDeg = 43.6f;
+    site.elevationM = 820;
+    ET::DailyWeather w;
+    w.tMaxC = 31;
+    w.tMinC = 12;
+    w.rhMean = 40;
+
+    auto start = std::chrono::steady_clock::now();
+    float sink = 0;
+    for (int h = 0; h < HOURS; h++) {
+        uint16_t doy = 150 + h / 24;
+        float et0 = ET::penmanMonteith(w, site, doy);
+        balance.advance(et0, 0, doy, 1.0f);
+        sink += et0;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    assert(sink > 0);
+    std::cout << "ET benchmark: " << elapsed / 1000.0 / HOURS << " us per hourly step of " << ZONES << " zones ("
+              << elapsed / (double)(HOURS * ZONES) << " ns per zone)\n";
 }
 
 int main() {
     testWeatherIntegration();
+    testFao56Examples();
+    testCropCoefficients();
+    testWaterBalanceDrivesSchedule();
+    benchmarkZoneUpdates();
     return 0;
 }
@@ -178,6 +178,107 @@ void test_AES_CTR(void)
     TEST_ASSERT_EQUAL_MEMORY(expected, plain, 16);
 }
 
+void test_AES_CTR_key_switching(void)
+{
+    // Channel keys alternate packet by packet on a busy gateway, each must keep its own schedule
+    uint8_t expected[16];
+    uint8_t plain[16];
+    uint8_t nonce[16];
+    CryptoKey k256, k128;
+    k256.length = 32;
+    HexToBytes(k256.bytes, "776BEFF2851DB06F4C8A0542C8696F6C6A81AF1EEC96B4D37FC1D689E6C1C104");
+    k128.length = 16;
+    HexToBytes(k128.bytes, "AE6852F8121067CC4BF7A5765577F39E");
+
+    for (int round = 0; round < 3; round++) {
+        HexToBytes(nonce, "00000060DB5672C97AA8F0B200000001");
+        HexToBytes(expected, "145AD01DBF824EC7560863DC71E3E0C0");
+        memcpy(plain, "Single block msg", 16);
+        crypto->encryptAESCtr(k256, nonce, 16, plain);
+        TEST_ASSERT_EQUAL_MEMORY(expected, plain, 16);
+
+        HexToBytes(nonce, "00000030000000000000000000000001");
+        HexToBytes(expected, "E4095D4FB7A7B3792D6175A3261311B8");
+        memcpy(plain, "Single block msg", 16);
+        crypto->encryptAESCtr(k128, nonce, 16, plain);
+        TEST_ASSERT_EQUAL_MEMORY(expected, plain, 16);
+    }
+}
+
+void test_PKC_private_key_change(void)
+{
+    // A cached shared key must not outlive the private key it was derived from
+    uint8_t private_key[32];
+    meshtastic_UserLite_public_key_t public_key;
+    uint8_t radioBytes[128] __attribute__((__aligned__));
+    uint8_t decrypted[128] __attribute__((__aligned__));
+    uint8_t expected_shared[8];
+
+    HexToBytes(public_key.bytes, "db18fc50eea47f00251cb784819a3cf5fc361882597f589f0d7ff820e8064457");
+    public_key.size = 32;
+    HexToBytes(expected_shared, "777b1545c9d6f9a2");
+    HexToBytes(radioBytes, "8c646d7a2909000062d6b2136b00000040df24abfcc30a17a3d9046726099e796a1c036a792b");
+
+    HexToBytes(private_key, "a00330633e63522f8a4d81ec6d9d1e6617f6c8ffd3a4c698229537d44e522277");
+    crypto->setDHPrivateKey(private_key);
+    TEST_ASSERT(crypto->decryptCurve25519(0x0929, public_key, 0x13b2d662, 22, radioBytes + 16, decrypted));
+
+    HexToBytes(private_key, "d85d8c061a50804ac488ad774ac716c3f5ba714b2712e048491379a500211958");
+    crypto->setDHPrivateKey(private_key);
+    TEST_ASSERT_FALSE(crypto->decryptCurve25519(0x0929, public_key, 0x13b2d662, 22, radioBytes + 16, decrypted));
+    TEST_ASSERT(memcmp(expected_shared, crypto->shared_key, 8) != 0);
+
+    HexToBytes(private_key, "a00330633e63522f8a4d81ec6d9d1e6617f6c8ffd3a4c698229537d44e522277");
+    crypto->setDHPrivateKey(private_key);
+    TEST_ASSERT(crypto->decryptCurve25519(0x0929, public_key, 0x13b2d662, 22, radioBytes + 16, decrypted));
+    TEST_ASSERT_EQUAL_MEMORY(expected_shared, crypto->shared_key, 8);
+}
+
+// Not a pass/fail test, reports what this platform's engine does per packet
+void test_AES_throughput(void)
+{
+    static const size_t sizes[] = {32, 128, 237};
+    uint8_t bytes[MAX_BLOCKSIZE] = {0};
+    uint8_t nonce[16] = {0};
+    CryptoKey keys[3];
+    for (int i = 0; i < 3; i++) {
+        keys[i].length = i == 0 ? 16 : 32;
+        memset(keys[i].bytes, 0x11 * (i + 1), sizeof(keys[i].bytes));
+    }
+    char message[120];
+    for (size_t size : sizes) {
+        // Three channels in turn, like a gateway listening to busy ones
+        const int packets = 300;
+        uint32_t started = micros();
+        for (int i = 0; i < packets; i++) {
+            nonce[0] = i;
+            crypto->encryptAESCtr(keys[i % 3], nonce, size, bytes);
+        }
+        uint32_t us = micros() - started;
+        snprintf(message, sizeof(message), "AES-CTR %u byte packets: %.2f us/packet, %.2f MB/s", (unsigned)size,
+                 (double)us / packets, us ? (double)size * packets / us : 0.0);
+        TEST_MESSAGE(message);
+    }
+
+    // PKI, two peers in turn, with the shared key derivation cached
+    uint8_t private_key[32];
+    meshtastic_UserLite_public_key_t peers[2];
+    HexToBytes(private_key, "a00330633e63522f8a4d81ec6d9d1e6617f6c8ffd3a4c698229537d44e522277");
+    HexToBytes(peers[0].bytes, "db18fc50eea47f00251cb784819a3cf5fc361882597f589f0d7ff820e8064457");
+    HexToBytes(peers[1].bytes, "504a36999f489cd2fdbc08baff3d88fa00569ba986cba22548ffde80f9806829");
+    peers[0].size = peers[1].size = 32;
+    crypto->setDHPrivateKey(private_key);
+    uint8_t encrypted[MAX_BLOCKSIZE + 16] __attribute__((__aligned__));
+    const int packets = 100;
+    uint32_t started = micros();
+    for (int i = 0; i < packets; i++)
+        TEST_ASSERT(crypto->encryptCurve25519(0, 0x0929, peers[i % 2], i, 200, bytes, encrypted));
+    uint32_t us = micros() - started;
+    snprintf(message, sizeof(message), "AES-CCM 200 byte PKI packets: %.2f us/packet, %.2f MB/s", (double)us / packets,
+             us ? 200.0 * packets / us : 0.0);
+    TEST_MESSAGE(message);
+}
+
 void setup()
 {
     // NOTE!!! Wait for >2 secs
@@ -192,6 +293,9 @@ void setup()
     RUN_TEST(test_DH25519);
     RUN_TEST(test_AES_CTR);
     RUN_TEST(test_PKC);
+    RUN_TEST(test_AES_CTR_key_switching);
+    RUN_TEST(test_PKC_private_key_change);
+    RUN_TEST(test_AES_throughput);
     exit(UNITY_END()); // stop unit testing
 }
 